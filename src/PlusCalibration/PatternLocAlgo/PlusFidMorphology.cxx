@@ -0,0 +1,350 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+
+#include "PlusFidMorphology.h"
+
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
+
+// SSE2 is available on all x86-64 processors
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define PLUS_FID_MORPHOLOGY_SSE2
+  #include <emmintrin.h>
+#endif
+
+namespace
+{
+  typedef PlusFidMorphology::PixelType PixelType;
+
+  //-----------------------------------------------------------------------------
+  struct MinimumOperation
+  {
+    static PixelType Identity() { return UCHAR_MAX; }
+    static PixelType Apply(PixelType a, PixelType b) { return a < b ? a : b; }
+#ifdef PLUS_FID_MORPHOLOGY_SSE2
+    static __m128i Apply(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+#endif
+  };
+
+  //-----------------------------------------------------------------------------
+  struct MaximumOperation
+  {
+    static PixelType Identity() { return 0; }
+    static PixelType Apply(PixelType a, PixelType b) { return a > b ? a : b; }
+#ifdef PLUS_FID_MORPHOLOGY_SSE2
+    static __m128i Apply(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+#endif
+  };
+
+  //-----------------------------------------------------------------------------
+  /*! dest[i] = op(a[i], b[i]), dest may be the same as a or b */
+  template<class OperationT>
+  void CombineRows(PixelType* dest, const PixelType* a, const PixelType* b, int length)
+  {
+    int i = 0;
+#ifdef PLUS_FID_MORPHOLOGY_SSE2
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), OperationT::Apply(va, vb));
+    }
+#endif
+    for (; i < length; i++)
+    {
+      dest[i] = OperationT::Apply(a[i], b[i]);
+    }
+  }
+
+  //-----------------------------------------------------------------------------
+  /*! dest[i] = op(dest[i], op(a[i], b[i])) */
+  template<class OperationT>
+  void AccumulateRows(PixelType* dest, const PixelType* a, const PixelType* b, int length)
+  {
+    int i = 0;
+#ifdef PLUS_FID_MORPHOLOGY_SSE2
+    for (; i + 16 <= length; i += 16)
+    {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), OperationT::Apply(vd, OperationT::Apply(va, vb)));
+    }
+#endif
+    for (; i < length; i++)
+    {
+      dest[i] = OperationT::Apply(dest[i], OperationT::Apply(a[i], b[i]));
+    }
+  }
+
+  //-----------------------------------------------------------------------------
+  /*! Index of the largest power of two that is not larger than value (value > 0) */
+  int FloorLog2(int value)
+  {
+    int level = 0;
+    while ((2 << level) <= value)
+    {
+      level++;
+    }
+    return level;
+  }
+}
+
+//-----------------------------------------------------------------------------
+PlusFidMorphology::PlusFidMorphology()
+{
+  m_FrameSize[0] = 0;
+  m_FrameSize[1] = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    m_RegionOfInterest[i] = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+PlusFidMorphology::~PlusFidMorphology()
+{
+}
+
+//-----------------------------------------------------------------------------
+void PlusFidMorphology::SetImageGeometry(const unsigned int frameSize[2], const unsigned int regionOfInterest[4])
+{
+  m_FrameSize[0] = frameSize[0];
+  m_FrameSize[1] = frameSize[1];
+  for (int i = 0; i < 4; i++)
+  {
+    m_RegionOfInterest[i] = regionOfInterest[i];
+  }
+}
+
+//-----------------------------------------------------------------------------
+void PlusFidMorphology::Line(PixelType* dest, const PixelType* image, int rowStep, int columnStep, unsigned int halfLength, OperationType operation)
+{
+  if (rowStep == 0)
+  {
+    // Horizontal line is a single span
+    std::vector<RowSpan> spans(1);
+    spans[0].RowOffset = 0;
+    spans[0].ColumnOffsetMin = -static_cast<int>(halfLength);
+    spans[0].ColumnOffsetMax = static_cast<int>(halfLength);
+    Spans(dest, image, spans, operation);
+    return;
+  }
+
+  if (rowStep != 1 || columnStep < -1 || columnStep > 1)
+  {
+    LOG_ERROR("Unsupported line structuring element direction: (" << rowStep << ", " << columnStep << ")");
+    memset(dest, 0, m_FrameSize[0] * m_FrameSize[1] * sizeof(PixelType));
+    return;
+  }
+
+  if (operation == OPERATION_EROSION)
+  {
+    LineAcrossRows<MinimumOperation>(dest, image, columnStep, halfLength);
+  }
+  else
+  {
+    LineAcrossRows<MaximumOperation>(dest, image, columnStep, halfLength);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void PlusFidMorphology::Spans(PixelType* dest, const PixelType* image, const std::vector<RowSpan>& spans, OperationType operation)
+{
+  if (operation == OPERATION_EROSION)
+  {
+    SpansAlongRows<MinimumOperation>(dest, image, spans);
+  }
+  else
+  {
+    SpansAlongRows<MaximumOperation>(dest, image, spans);
+  }
+}
+
+//-----------------------------------------------------------------------------
+template<class OperationT>
+void PlusFidMorphology::LineAcrossRows(PixelType* dest, const PixelType* image, int columnStep, unsigned int halfLength)
+{
+  memset(dest, 0, m_FrameSize[0] * m_FrameSize[1] * sizeof(PixelType));
+
+  const int roiWidth = static_cast<int>(m_RegionOfInterest[2]) - static_cast<int>(m_RegionOfInterest[0]);
+  const int roiHeight = static_cast<int>(m_RegionOfInterest[3]) - static_cast<int>(m_RegionOfInterest[1]);
+  if (roiWidth <= 0 || roiHeight <= 0)
+  {
+    return;
+  }
+
+  // Running values are computed for the region of interest extended by the half line length
+  const int b = static_cast<int>(halfLength);
+  const int lineLength = 2 * b + 1;
+  const int firstRow = static_cast<int>(m_RegionOfInterest[1]) - b;
+  const int firstColumn = static_cast<int>(m_RegionOfInterest[0]) - b;
+  const int numberOfRows = roiHeight + 2 * b;
+  const int numberOfColumns = roiWidth + 2 * b;
+  const int width = static_cast<int>(m_FrameSize[0]);
+
+  m_ForwardBuffer.resize(numberOfRows * numberOfColumns);
+  m_BackwardBuffer.resize(numberOfRows * numberOfColumns);
+  PixelType* forward = &m_ForwardBuffer[0];
+  PixelType* backward = &m_BackwardBuffer[0];
+
+  // Forward running values: forward(i,j) = op(image(i,j), forward(i-1,j-columnStep)) within each block of lineLength rows.
+  // Values at the buffer border are only used for pixels whose line is outside of the buffer, so they may be truncated.
+  for (int i = 0; i < numberOfRows; i++)
+  {
+    const PixelType* imageRow = image + (firstRow + i) * width + firstColumn;
+    PixelType* forwardRow = forward + i * numberOfColumns;
+    if (i % lineLength == 0)
+    {
+      memcpy(forwardRow, imageRow, numberOfColumns * sizeof(PixelType));
+      continue;
+    }
+    const PixelType* previousRow = forwardRow - numberOfColumns;
+    if (columnStep == 0)
+    {
+      CombineRows<OperationT>(forwardRow, imageRow, previousRow, numberOfColumns);
+    }
+    else if (columnStep > 0)
+    {
+      forwardRow[0] = imageRow[0];
+      CombineRows<OperationT>(forwardRow + 1, imageRow + 1, previousRow, numberOfColumns - 1);
+    }
+    else
+    {
+      forwardRow[numberOfColumns - 1] = imageRow[numberOfColumns - 1];
+      CombineRows<OperationT>(forwardRow, imageRow, previousRow + 1, numberOfColumns - 1);
+    }
+  }
+
+  // Backward running values: backward(i,j) = op(image(i,j), backward(i+1,j+columnStep)) within each block
+  for (int i = numberOfRows - 1; i >= 0; i--)
+  {
+    const PixelType* imageRow = image + (firstRow + i) * width + firstColumn;
+    PixelType* backwardRow = backward + i * numberOfColumns;
+    if (i % lineLength == lineLength - 1 || i == numberOfRows - 1)
+    {
+      memcpy(backwardRow, imageRow, numberOfColumns * sizeof(PixelType));
+      continue;
+    }
+    const PixelType* nextRow = backwardRow + numberOfColumns;
+    if (columnStep == 0)
+    {
+      CombineRows<OperationT>(backwardRow, imageRow, nextRow, numberOfColumns);
+    }
+    else if (columnStep > 0)
+    {
+      backwardRow[numberOfColumns - 1] = imageRow[numberOfColumns - 1];
+      CombineRows<OperationT>(backwardRow, imageRow, nextRow + 1, numberOfColumns - 1);
+    }
+    else
+    {
+      backwardRow[0] = imageRow[0];
+      CombineRows<OperationT>(backwardRow + 1, imageRow + 1, nextRow, numberOfColumns - 1);
+    }
+  }
+
+  // The line of pixel (r,c) starts in the block of row r-b and ends in the block of row r+b (or they are in the same block)
+  for (int i = 0; i < roiHeight; i++)
+  {
+    PixelType* destRow = dest + (m_RegionOfInterest[1] + i) * width + m_RegionOfInterest[0];
+    const PixelType* lineStart = backward + i * numberOfColumns + b - b * columnStep;
+    const PixelType* lineEnd = forward + (i + 2 * b) * numberOfColumns + b + b * columnStep;
+    CombineRows<OperationT>(destRow, lineStart, lineEnd, roiWidth);
+  }
+}
+
+//-----------------------------------------------------------------------------
+template<class OperationT>
+void PlusFidMorphology::SpansAlongRows(PixelType* dest, const PixelType* image, const std::vector<RowSpan>& spans)
+{
+  memset(dest, 0, m_FrameSize[0] * m_FrameSize[1] * sizeof(PixelType));
+
+  const int roiWidth = static_cast<int>(m_RegionOfInterest[2]) - static_cast<int>(m_RegionOfInterest[0]);
+  const int roiHeight = static_cast<int>(m_RegionOfInterest[3]) - static_cast<int>(m_RegionOfInterest[1]);
+  if (roiWidth <= 0 || roiHeight <= 0)
+  {
+    return;
+  }
+
+  const int width = static_cast<int>(m_FrameSize[0]);
+  const int height = static_cast<int>(m_FrameSize[1]);
+  const int roiFirstRow = static_cast<int>(m_RegionOfInterest[1]);
+  const int roiFirstColumn = static_cast<int>(m_RegionOfInterest[0]);
+
+  // Output is the identity value where no span contributes
+  for (int r = roiFirstRow; r < roiFirstRow + roiHeight; r++)
+  {
+    memset(dest + r * width + roiFirstColumn, OperationT::Identity(), roiWidth * sizeof(PixelType));
+  }
+  if (spans.empty())
+  {
+    return;
+  }
+
+  // Bounding box of the structuring element
+  int rowOffsetMin = spans[0].RowOffset;
+  int rowOffsetMax = spans[0].RowOffset;
+  int columnOffsetMin = spans[0].ColumnOffsetMin;
+  int columnOffsetMax = spans[0].ColumnOffsetMax;
+  int maxSpanLength = 1;
+  for (std::vector<RowSpan>::const_iterator span = spans.begin(); span != spans.end(); ++span)
+  {
+    rowOffsetMin = std::min(rowOffsetMin, span->RowOffset);
+    rowOffsetMax = std::max(rowOffsetMax, span->RowOffset);
+    columnOffsetMin = std::min(columnOffsetMin, span->ColumnOffsetMin);
+    columnOffsetMax = std::max(columnOffsetMax, span->ColumnOffsetMax);
+    maxSpanLength = std::max(maxSpanLength, span->ColumnOffsetMax - span->ColumnOffsetMin + 1);
+  }
+
+  // Each row of the window buffer contains windows of 2^level length
+  const int numberOfColumns = roiWidth + columnOffsetMax - columnOffsetMin;
+  const int numberOfLevels = FloorLog2(maxSpanLength) + 1;
+  m_WindowBuffer.resize(numberOfLevels * numberOfColumns);
+  PixelType* windows = &m_WindowBuffer[0];
+
+  const int firstColumn = roiFirstColumn + columnOffsetMin;
+  for (int sourceRow = roiFirstRow + rowOffsetMin; sourceRow < roiFirstRow + roiHeight + rowOffsetMax; sourceRow++)
+  {
+    if (sourceRow < 0 || sourceRow >= height)
+    {
+      continue;
+    }
+
+    // Level 0: the image row, pixels outside of the image are replaced by the identity value
+    const int validColumnStart = std::max(0, -firstColumn);
+    const int validColumnEnd = std::min(numberOfColumns, width - firstColumn);
+    memset(windows, OperationT::Identity(), numberOfColumns * sizeof(PixelType));
+    if (validColumnEnd > validColumnStart)
+    {
+      memcpy(windows + validColumnStart, image + sourceRow * width + firstColumn + validColumnStart, (validColumnEnd - validColumnStart) * sizeof(PixelType));
+    }
+
+    // Window of 2^level length starting at j is the combination of two windows of 2^(level-1) length
+    for (int level = 1; level < numberOfLevels; level++)
+    {
+      const int halfWindow = 1 << (level - 1);
+      const PixelType* previousLevel = windows + (level - 1) * numberOfColumns;
+      CombineRows<OperationT>(windows + level * numberOfColumns, previousLevel, previousLevel + halfWindow, numberOfColumns - 2 * halfWindow + 1);
+    }
+
+    // Add the span of this source row to each output row whose structuring element contains it
+    for (std::vector<RowSpan>::const_iterator span = spans.begin(); span != spans.end(); ++span)
+    {
+      const int destRow = sourceRow - span->RowOffset;
+      if (destRow < roiFirstRow || destRow >= roiFirstRow + roiHeight)
+      {
+        continue;
+      }
+      const int spanLength = span->ColumnOffsetMax - span->ColumnOffsetMin + 1;
+      const int level = FloorLog2(spanLength);
+      const PixelType* levelWindows = windows + level * numberOfColumns + (span->ColumnOffsetMin - columnOffsetMin);
+      AccumulateRows<OperationT>(dest + destRow * width + roiFirstColumn, levelWindows, levelWindows + spanLength - (1 << level), roiWidth);
+    }
+  }
+}
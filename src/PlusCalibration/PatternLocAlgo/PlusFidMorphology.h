@@ -0,0 +1,92 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef _FIDUCIAL_MORPHOLOGY_H
+#define _FIDUCIAL_MORPHOLOGY_H
+
+#include "vtkPlusCalibrationExport.h"
+
+#include <vector>
+
+/*!
+\class PlusFidMorphology
+\brief Grayscale erosion and dilation of 8-bit images with line and disk shaped structuring elements.
+
+Only the pixels in the region of interest are computed, all other output pixels are set to 0.
+The structuring element of a region of interest pixel must be inside the image.
+
+Line structuring elements that go across rows (vertical and diagonal lines) are computed by the van Herk/Gil-Werman
+algorithm: the image rows are split to blocks of the line length, then running minimum (or maximum) values
+are accumulated forward and backward in each block, and the result is the minimum of one forward and one backward value.
+The accumulation step combines two full rows, therefore the cost per pixel does not depend on the line length
+and all operations are vectorized over the row.
+
+Horizontal lines and other structuring elements that consist of horizontal spans (such as the disk) are decomposed
+to spans: windows of power of two lengths are computed for each row by repeated doubling, any window length is the
+minimum of two overlapping power of two windows, and the spans of different rows are combined row by row.
+
+The results are exactly the same as computing the minimum (or maximum) of the structuring element for each pixel.
+
+\ingroup PlusLibPatternRecognition
+*/
+class vtkPlusCalibrationExport PlusFidMorphology
+{
+public:
+  typedef unsigned char PixelType;
+
+  enum OperationType
+  {
+    OPERATION_EROSION, // minimum of the structuring element
+    OPERATION_DILATION // maximum of the structuring element
+  };
+
+  /*! Pixels from (RowOffset, ColumnOffsetMin) to (RowOffset, ColumnOffsetMax) relative to the current pixel */
+  struct RowSpan
+  {
+    int RowOffset;
+    int ColumnOffsetMin;
+    int ColumnOffsetMax;
+  };
+
+  PlusFidMorphology();
+  virtual ~PlusFidMorphology();
+
+  /*!
+    Set the image size and the region of interest
+    \param frameSize image width and height
+    \param regionOfInterest xmin, ymin, xmax, ymax of the processed region (max values are exclusive)
+  */
+  void SetImageGeometry(const unsigned int frameSize[2], const unsigned int regionOfInterest[4]);
+
+  /*!
+    Erosion or dilation with a line of 2*halfLength+1 pixels.
+    The pixels of the line are at (rowStep*k, columnStep*k) offsets from the current pixel, k = -halfLength..halfLength.
+    Supported steps are (0,1), (1,0), (1,1) and (1,-1).
+  */
+  void Line(PixelType* dest, const PixelType* image, int rowStep, int columnStep, unsigned int halfLength, OperationType operation);
+
+  /*!
+    Erosion or dilation with a structuring element that is given as a list of horizontal spans.
+    Pixels of the structuring element that are outside of the image are ignored.
+  */
+  void Spans(PixelType* dest, const PixelType* image, const std::vector<RowSpan>& spans, OperationType operation);
+
+protected:
+  template<class OperationT> void LineAcrossRows(PixelType* dest, const PixelType* image, int columnStep, unsigned int halfLength);
+  template<class OperationT> void SpansAlongRows(PixelType* dest, const PixelType* image, const std::vector<RowSpan>& spans);
+
+  unsigned int m_FrameSize[2];
+  unsigned int m_RegionOfInterest[4];
+
+  /*! Forward and backward running values of the van Herk/Gil-Werman algorithm */
+  std::vector<PixelType> m_ForwardBuffer;
+  std::vector<PixelType> m_BackwardBuffer;
+
+  /*! Power of two length windows of one image row */
+  std::vector<PixelType> m_WindowBuffer;
+};
+
+#endif // _FIDUCIAL_MORPHOLOGY_H
@@ -13,12 +13,33 @@ See License.txt for details.
 #include "vtkPlusTrackedFrameList.h"
 #include "PlusTrackedFrame.h"
 
+#include <algorithm>
+
 static const double DOT_STEPS  = 4.0;
 static const double DOT_RADIUS = 6.0;
 
+namespace
+{
+  /*! Segmentation of one frame of a tracked frame list */
+  struct FrameRecognitionJob
+  {
+    PlusTrackedFrame* TrackedFrame;
+    unsigned int FrameIndex;
+    PlusFidPatternRecognition::PatternRecognitionError Error;
+    PlusStatus Status;
+  };
+
+  struct RecognizePatternThreadFunctionInfoStruct
+  {
+    std::vector<PlusFidPatternRecognition*>* Workers;
+    std::vector<FrameRecognitionJob>* Jobs;
+  };
+}
+
 //-----------------------------------------------------------------------------
 
 PlusFidPatternRecognition::PlusFidPatternRecognition()
+  : m_NumberOfThreads(1)
 {
 
 }
@@ -46,6 +67,12 @@ PlusStatus PlusFidPatternRecognition::ReadConfiguration(vtkXMLDataElement* rootC
   m_FidLineFinder.ReadConfiguration(rootConfigElement);
   m_FidLabeling.ReadConfiguration(rootConfigElement, m_FidLineFinder.GetMinThetaRad(), m_FidLineFinder.GetMaxThetaRad());
 
+  vtkXMLDataElement* segmentationParameters = rootConfigElement->FindNestedElementWithName("Segmentation");
+  if (segmentationParameters != NULL)
+  {
+    XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfThreads, segmentationParameters);
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -172,27 +199,72 @@ PlusStatus PlusFidPatternRecognition::RecognizePattern(vtkPlusTrackedFrameList*
     return PLUS_FAIL;
   }
 
-  PlusStatus status = PLUS_SUCCESS;
-  if (numberOfSuccessfullySegmentedImages)
-  {
-    *numberOfSuccessfullySegmentedImages = 0;
-  }
-
+  // Collect the frames that are not segmented yet
+  std::vector<FrameRecognitionJob> jobs;
   for (unsigned int currentFrameIndex = 0; currentFrameIndex < trackedFrameList->GetNumberOfTrackedFrames(); currentFrameIndex++)
   {
     PlusTrackedFrame* trackedFrame = trackedFrameList->GetTrackedFrame(currentFrameIndex);
-
-    // segment only non segmented frames
     if (trackedFrame->GetFiducialPointsCoordinatePx() != NULL)
     {
       continue;
     }
+    FrameRecognitionJob job;
+    job.TrackedFrame = trackedFrame;
+    job.FrameIndex = currentFrameIndex;
+    job.Error = PATTERN_RECOGNITION_ERROR_NO_ERROR;
+    job.Status = PLUS_SUCCESS;
+    jobs.push_back(job);
+  }
+
+  int numberOfThreads = (m_NumberOfThreads > 0 ? m_NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  numberOfThreads = std::min<int>(numberOfThreads, jobs.size());
+
+  if (numberOfThreads <= 1)
+  {
+    for (std::vector<FrameRecognitionJob>::iterator job = jobs.begin(); job != jobs.end(); ++job)
+    {
+      job->Status = RecognizePattern(job->TrackedFrame, job->Error, job->FrameIndex);
+    }
+  }
+  else
+  {
+    // The segmentation objects hold the working images and the intermediate results, so each thread gets its own copy
+    std::vector<PlusFidPatternRecognition*> workers;
+    for (int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++)
+    {
+      workers.push_back(new PlusFidPatternRecognition(*this));
+    }
+
+    RecognizePatternThreadFunctionInfoStruct str;
+    str.Workers = &workers;
+    str.Jobs = &jobs;
+
+    vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(RecognizePatternThreadFunction, &str);
+    threader->SingleMethodExecute();
+
+    for (std::vector<PlusFidPatternRecognition*>::iterator worker = workers.begin(); worker != workers.end(); ++worker)
+    {
+      delete (*worker);
+    }
+  }
+
+  // Merge the results in frame order
+  PlusStatus status = PLUS_SUCCESS;
+  if (numberOfSuccessfullySegmentedImages)
+  {
+    *numberOfSuccessfullySegmentedImages = 0;
+  }
 
-    if (RecognizePattern(trackedFrame, patternRecognitionError, currentFrameIndex) != PLUS_SUCCESS)
+  for (std::vector<FrameRecognitionJob>::iterator job = jobs.begin(); job != jobs.end(); ++job)
+  {
+    patternRecognitionError = job->Error;
+    if (job->Status != PLUS_SUCCESS)
     {
-      if (patternRecognitionError != PATTERN_RECOGNITION_ERROR_TOO_MANY_CANDIDATES)
+      if (job->Error != PATTERN_RECOGNITION_ERROR_TOO_MANY_CANDIDATES)
       {
-        LOG_ERROR("Recognizing pattern failed on frame " << currentFrameIndex);
+        LOG_ERROR("Recognizing pattern failed on frame " << job->FrameIndex);
         status = PLUS_FAIL;
       }
     }
@@ -200,13 +272,13 @@ PlusStatus PlusFidPatternRecognition::RecognizePattern(vtkPlusTrackedFrameList*
     if (numberOfSuccessfullySegmentedImages)
     {
       // compute the number of successfully segmented images
-      if (trackedFrame->GetFiducialPointsCoordinatePx()
-          && trackedFrame->GetFiducialPointsCoordinatePx()->GetNumberOfPoints() > 0)
+      if (job->TrackedFrame->GetFiducialPointsCoordinatePx()
+          && job->TrackedFrame->GetFiducialPointsCoordinatePx()->GetNumberOfPoints() > 0)
       {
         (*numberOfSuccessfullySegmentedImages)++;
         if (segmentedFramesIndices != NULL)
         {
-          segmentedFramesIndices->push_back(currentFrameIndex);
+          segmentedFramesIndices->push_back(job->FrameIndex);
         }
       }
     }
@@ -217,6 +289,21 @@ PlusStatus PlusFidPatternRecognition::RecognizePattern(vtkPlusTrackedFrameList*
 
 //-----------------------------------------------------------------------------
 
+VTK_THREAD_RETURN_TYPE PlusFidPatternRecognition::RecognizePatternThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  RecognizePatternThreadFunctionInfoStruct* str = static_cast<RecognizePatternThreadFunctionInfoStruct*>(threadInfo->UserData);
+  PlusFidPatternRecognition* worker = (*str->Workers)[threadInfo->ThreadID];
+  std::vector<FrameRecognitionJob>& jobs = *str->Jobs;
+  for (size_t jobIndex = threadInfo->ThreadID; jobIndex < jobs.size(); jobIndex += threadInfo->NumberOfThreads)
+  {
+    jobs[jobIndex].Status = worker->RecognizePattern(jobs[jobIndex].TrackedFrame, jobs[jobIndex].Error, jobs[jobIndex].FrameIndex);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+
 void PlusFidPatternRecognition::DrawDots(PlusFidSegmentation::PixelType* image)
 {
   LOG_TRACE("FidPatternRecognition::DrawDots");
@@ -12,6 +12,7 @@ See License.txt for details.
 #include "PlusFidLineFinder.h"
 #include "PlusFidLabeling.h"
 
+#include "vtkMultiThreader.h"
 #include "vtkXMLDataElement.h"
 
 class PlusTrackedFrame;
@@ -44,7 +45,10 @@ public:
 
   /*!
   Run pattern recognition on a tracked frame list.
-  It only segments the tracked frames which were not already segmented
+  It only segments the tracked frames which were not already segmented.
+  If more than one thread is used then each thread works on a copy of the segmentation, line finder and labeling
+  objects and the results are merged in frame order. The segmentation, line finder and labeling objects of this
+  class then do not hold the results of the last segmented frame.
   \param trackedFrameList Tracked frame list to segment
   \param numberOfSuccessfullySegmentedImages Out parameter holding the number of segmented images in this call (it is only equals the number of all segmented images in the tracked frame if it was not segmented at all)
   \param segmentedFramesIndices Indices of the frames that were properly segmented
@@ -95,7 +99,16 @@ public:
   /*! Reads the phantom definition and computes the NWires intersection if needed */
   PlusStatus ReadPhantomDefinition(vtkXMLDataElement* rootConfigElement);
 
+  /*! Set the number of threads used for segmenting tracked frame lists (0 = number of processors, 1 = no multithreading) */
+  void SetNumberOfThreads(int value) { m_NumberOfThreads = value; };
+
+  /*! Get the number of threads used for segmenting tracked frame lists */
+  int GetNumberOfThreads() { return m_NumberOfThreads; };
+
 protected:
+  /*! Segment the frames of a list that are assigned to one thread */
+  static VTK_THREAD_RETURN_TYPE RecognizePatternThreadFunction(void* arg);
+
 
   PlusFidSegmentation           m_FidSegmentation;
   PlusFidLineFinder             m_FidLineFinder;
@@ -103,6 +116,8 @@ protected:
   std::vector<PlusFidPattern*>  m_Patterns;
 
   double                        m_MaxLineLengthToleranceMm;
+
+  int                           m_NumberOfThreads;
 };
 
 //-----------------------------------------------------------------------------
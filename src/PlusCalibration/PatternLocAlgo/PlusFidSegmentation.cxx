@@ -76,6 +76,46 @@ PlusFidSegmentation::PlusFidSegmentation()
 
 //-----------------------------------------------------------------------------
 
+PlusFidSegmentation::PlusFidSegmentation(const PlusFidSegmentation& other)
+  : m_UseOriginalImageIntensityForDotIntensityScore(other.m_UseOriginalImageIntensityForDotIntensityScore)
+  , m_NumberOfMaximumFiducialPointCandidates(other.m_NumberOfMaximumFiducialPointCandidates)
+  , m_ThresholdImagePercent(other.m_ThresholdImagePercent)
+  , m_MorphologicalOpeningBarSizeMm(other.m_MorphologicalOpeningBarSizeMm)
+  , m_MorphologicalOpeningCircleRadiusMm(other.m_MorphologicalOpeningCircleRadiusMm)
+  , m_PossibleFiducialsImageFilename(other.m_PossibleFiducialsImageFilename)
+  , m_FiducialGeometry(other.m_FiducialGeometry)
+  , m_MorphologicalCircle(other.m_MorphologicalCircle)
+  , m_MorphologicalCircleRowSpans(other.m_MorphologicalCircleRowSpans)
+  , m_Morphology(other.m_Morphology)
+  , m_ApproximateSpacingMmPerPixel(other.m_ApproximateSpacingMmPerPixel)
+  , m_DotsFound(other.m_DotsFound)
+  , m_FoundDotsCoordinateValue(other.m_FoundDotsCoordinateValue)
+  , m_NumDots(other.m_NumDots)
+  , m_CandidateFidValues(other.m_CandidateFidValues)
+  , m_DotsVector(other.m_DotsVector)
+  , m_DebugOutput(other.m_DebugOutput)
+{
+  memcpy(m_FrameSize, other.m_FrameSize, sizeof(m_FrameSize));
+  memcpy(m_RegionOfInterest, other.m_RegionOfInterest, sizeof(m_RegionOfInterest));
+  memcpy(m_ImageScalingTolerancePercent, other.m_ImageScalingTolerancePercent, sizeof(m_ImageScalingTolerancePercent));
+  memcpy(m_ImageNormalVectorInPhantomFrameEstimation, other.m_ImageNormalVectorInPhantomFrameEstimation, sizeof(m_ImageNormalVectorInPhantomFrameEstimation));
+  memcpy(m_ImageNormalVectorInPhantomFrameMaximumRotationAngleDeg, other.m_ImageNormalVectorInPhantomFrameMaximumRotationAngleDeg, sizeof(m_ImageNormalVectorInPhantomFrameMaximumRotationAngleDeg));
+  memcpy(m_ImageToPhantomTransform, other.m_ImageToPhantomTransform, sizeof(m_ImageToPhantomTransform));
+
+  // The working images are never shared, each copy can be used from a different thread
+  long size = std::max<long>(m_FrameSize[0] * m_FrameSize[1], 1);
+  m_Working = new PlusFidSegmentation::PixelType[size];
+  m_Dilated = new PlusFidSegmentation::PixelType[size];
+  m_Eroded = new PlusFidSegmentation::PixelType[size];
+  m_UnalteredImage = new PlusFidSegmentation::PixelType[size];
+  memcpy(m_Working, other.m_Working, size * sizeof(PlusFidSegmentation::PixelType));
+  memcpy(m_Dilated, other.m_Dilated, size * sizeof(PlusFidSegmentation::PixelType));
+  memcpy(m_Eroded, other.m_Eroded, size * sizeof(PlusFidSegmentation::PixelType));
+  memcpy(m_UnalteredImage, other.m_UnalteredImage, size * sizeof(PlusFidSegmentation::PixelType));
+}
+
+//-----------------------------------------------------------------------------
+
 PlusFidSegmentation::~PlusFidSegmentation()
 {
   delete[] m_Dilated;
@@ -106,6 +146,28 @@ void PlusFidSegmentation::UpdateParameters()
       }
     }
   }
+
+  // Each row of the circle is contiguous, store it as a span
+  m_MorphologicalCircleRowSpans.clear();
+  for (int y = -radiuspx; y <= radiuspx; y++)
+  {
+    PlusFidMorphology::RowSpan span;
+    span.RowOffset = y;
+    span.ColumnOffsetMin = INT_MAX;
+    span.ColumnOffsetMax = INT_MIN;
+    for (std::vector<PlusCoordinate2D>::iterator dot = m_MorphologicalCircle.begin(); dot != m_MorphologicalCircle.end(); ++dot)
+    {
+      if (dot->Y == y)
+      {
+        span.ColumnOffsetMin = std::min(span.ColumnOffsetMin, dot->X);
+        span.ColumnOffsetMax = std::max(span.ColumnOffsetMax, dot->X);
+      }
+    }
+    if (span.ColumnOffsetMin <= span.ColumnOffsetMax)
+    {
+      m_MorphologicalCircleRowSpans.push_back(span);
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -277,87 +339,12 @@ unsigned int PlusFidSegmentation::GetMorphologicalOpeningBarSizePx()
 
 //-----------------------------------------------------------------------------
 
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::ErodePoint0(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::ErodePoint0");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = UCHAR_MAX;
-  unsigned int p = ir * m_FrameSize[0] + ic - barSize; // current pixel - bar size (position of the start of the bar)
-  unsigned int p_max = ir * m_FrameSize[0] + ic + barSize; // current pixel +  bar size (position of the end  of the bar)
-
-  //find lowest intensity in bar shaped area in image
-  for (; p <= p_max; p++)
-  {
-    if (image[p] < dval)
-    {
-      dval = image[p];
-    }
-    if (image[p] == 0)
-    {
-      break;
-    }
-  }
-
-  return dval;
-}
-
-//-----------------------------------------------------------------------------
-
 void PlusFidSegmentation::Erode0(PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image)
 {
   //LOG_TRACE("FidSegmentation::Erode0");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
-  {
-    unsigned int ic = m_RegionOfInterest[0];
-    unsigned int p_base = ir * m_FrameSize[0];
-
-    PlusFidSegmentation::PixelType dval = ErodePoint0(image, ir, ic);   // find lowest pixel intensity in surrounding region ( positions +/- 8 of current pixel position)
-    dest[p_base + ic] = dval; // p_base+ic = current pixel
-
-    for (ic++; ic < m_RegionOfInterest[2]; ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[p_base + ic + barSize];
-      PlusFidSegmentation::PixelType del_val = image[p_base + ic - 1 - barSize];
-
-      dval = new_val <= dval ? new_val  : // dval = new val if new val is less than or equal to dval
-             del_val > dval ? std::min(dval, new_val) :   // if del val is greater than dval, dval= min of dval and new val
-             ErodePoint0(image, ir, ic);   //else dval = result of erode function
-
-      dest[ir * m_FrameSize[0] + ic] = dval; // update new "eroded" picture
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::ErodePoint45(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::ErodePoint45");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  PlusFidSegmentation::PixelType dval = UCHAR_MAX;
-  unsigned int p = (ir + barSize) * m_FrameSize[0] + ic - barSize;
-  unsigned int p_max = (ir - barSize) * m_FrameSize[0] + ic + barSize;
-
-  for (; p >= p_max; p = p - m_FrameSize[0] + 1)
-  {
-    if (image[p] < dval)
-    {
-      dval = image[p];
-    }
-    if (image[p] == 0)
-    {
-      break;
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 0, 1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_EROSION);
 }
 
 //-----------------------------------------------------------------------------
@@ -366,77 +353,8 @@ void PlusFidSegmentation::Erode45(PlusFidSegmentation::PixelType* dest, PlusFidS
 {
   //LOG_TRACE("FidSegmentation::Erode45");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  /* Down the left side. */
-  for (unsigned int sr = m_RegionOfInterest[1]; sr < m_RegionOfInterest[3]; sr++)
-  {
-    unsigned int ir = sr;
-    unsigned int ic = m_RegionOfInterest[0];
-
-    PlusFidSegmentation::PixelType dval = ErodePoint45(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val <= dval ? new_val :
-             del_val > dval ? std::min(dval, new_val) :
-             ErodePoint45(image, ir, ic);
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-
-  /* Across the bottom */
-  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
-  {
-    unsigned int ic = sc;
-    unsigned int ir = m_RegionOfInterest[3] - 1;
-
-    PlusFidSegmentation::PixelType dval = ErodePoint45(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val <= dval ? new_val :
-             del_val > dval ? std::min(dval, new_val) :
-             ErodePoint45(image, ir, ic);
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::ErodePoint90(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::ErodePoint90");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = UCHAR_MAX;
-  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic;
-  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic;
-
-  for (; p <= p_max; p += m_FrameSize[0])
-  {
-    if (image[p] < dval)
-    {
-      dval = image[p];
-    }
-    if (image[p] == 0)
-    {
-      break;
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, -1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_EROSION);
 }
 
 //-----------------------------------------------------------------------------
@@ -445,54 +363,8 @@ void PlusFidSegmentation::Erode90(PlusFidSegmentation::PixelType* dest, PlusFidS
 {
   //LOG_TRACE("FidSegmentation::Erode90");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
-  {
-    unsigned int ir = m_RegionOfInterest[1];
-
-    PlusFidSegmentation::PixelType dval = ErodePoint90(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ir++; ir < m_RegionOfInterest[3]; ir++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + ic];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + ic];
-
-      dval = new_val <= dval ? new_val :
-             del_val > dval ? std::min(dval, new_val) :
-             ErodePoint90(image, ir, ic);
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::ErodePoint135(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::ErodePoint135");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = UCHAR_MAX;
-  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic - barSize;
-  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic + barSize;
-
-  for (; p <= p_max; p = p + m_FrameSize[0] + 1)
-  {
-    if (image[p] < dval)
-    {
-      dval = image[p];
-    }
-    if (image[p] == 0)
-    {
-      break;
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, 0, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_EROSION);
 }
 
 //-----------------------------------------------------------------------------
@@ -501,53 +373,8 @@ void PlusFidSegmentation::Erode135(PlusFidSegmentation::PixelType* dest, PlusFid
 {
   //LOG_TRACE("FidSegmentation::Erode135");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  /* Up the left side. */
-  for (unsigned int sr = m_RegionOfInterest[3] - 1; sr >= m_RegionOfInterest[1]; sr--)
-  {
-    unsigned int ir = sr;
-    unsigned int ic = m_RegionOfInterest[0];
-
-    PlusFidSegmentation::PixelType dval = ErodePoint135(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val <= dval ? new_val :
-             del_val > dval ? std::min(dval, new_val) :
-             ErodePoint135(image, ir, ic);
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-
-  /* Across the top. */
-  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
-  {
-    unsigned int ic = sc;
-    unsigned int ir = m_RegionOfInterest[1];
-
-    PlusFidSegmentation::PixelType dval = ErodePoint135(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val <= dval ? new_val :
-             del_val > dval ? std::min(dval, new_val) :
-             ErodePoint135(image, ir, ic);
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, 1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_EROSION);
 }
 
 //-----------------------------------------------------------------------------
@@ -556,57 +383,8 @@ void PlusFidSegmentation::ErodeCircle(PlusFidSegmentation::PixelType* dest, Plus
 {
   //LOG_TRACE("FidSegmentation::ErodeCircle");
 
-  unsigned int slen = m_MorphologicalCircle.size();
-
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-
-  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
-  {
-    for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
-    {
-      PlusFidSegmentation::PixelType dval = UCHAR_MAX;
-      for (unsigned int sp = 0; sp < slen; sp++)
-      {
-        int sr = ir + m_MorphologicalCircle[sp].X;
-        int sc = ic + m_MorphologicalCircle[sp].Y;
-        PlusFidSegmentation::PixelType pixSrc = image[sr * m_FrameSize[0] + sc];
-
-        if (pixSrc < dval)
-        {
-          dval = pixSrc;
-        }
-
-        if (pixSrc == 0)
-        {
-          break;
-        }
-      }
-
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::DilatePoint0(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::DilatePoint0");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = 0;
-  unsigned int p = ir * m_FrameSize[0] + ic - barSize;
-  unsigned int p_max = ir * m_FrameSize[0] + ic + barSize;
-
-  for (; p <= p_max; p++)
-  {
-    if (image[p] > dval)
-    {
-      dval = image[p];
-    }
-  }
-
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Spans(dest, image, m_MorphologicalCircleRowSpans, PlusFidMorphology::OPERATION_EROSION);
 }
 
 //-----------------------------------------------------------------------------
@@ -615,60 +393,8 @@ void PlusFidSegmentation::Dilate0(PlusFidSegmentation::PixelType* dest, PlusFidS
 {
   //LOG_TRACE("FidSegmentation::Dilate0");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
-  {
-    unsigned int ic = m_RegionOfInterest[0];
-    unsigned int p_base = ir * m_FrameSize[0];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint0(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ic++; ic < m_RegionOfInterest[2]; ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[p_base + ic + barSize];
-      PlusFidSegmentation::PixelType del_val = image[p_base + ic - 1 - barSize];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint0(image, ir, ic));
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::DilatePoint45(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::DilatePoint45");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = 0;
-  unsigned int p = (ir + barSize) * m_FrameSize[0] + ic - barSize;
-  unsigned int p_max = (ir - barSize) * m_FrameSize[0] + ic + barSize;
-
-  while (p >= p_max)
-  {
-    if (image[p] > dval)
-    {
-      dval = image[p];
-    }
-    if (p - m_FrameSize[0] + 1 > p)
-    {
-      // unsigned int underflow, adjust
-      p = 0;
-    }
-    else
-    {
-      p = p - m_FrameSize[0] + 1;
-    }
-  }
-
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 0, 1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_DILATION);
 }
 
 //-----------------------------------------------------------------------------
@@ -677,69 +403,8 @@ void PlusFidSegmentation::Dilate45(PlusFidSegmentation::PixelType* dest, PlusFid
 {
   //LOG_TRACE("FidSegmentation::Dilate45");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  /* Down the left side. */
-  for (unsigned int sr = m_RegionOfInterest[1]; sr < m_RegionOfInterest[3]; sr++)
-  {
-    unsigned int ir = sr;
-    unsigned int ic = m_RegionOfInterest[0];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint45(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval ;
-    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint45(image, ir, ic));
-      dest[ir * m_FrameSize[0] + ic] = dval ;
-    }
-  }
-
-  /* Across the bottom */
-  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
-  {
-    unsigned int ic = sc;
-    unsigned int ir = m_RegionOfInterest[3] - 1;
-
-    PlusFidSegmentation::PixelType dval = DilatePoint45(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval ;
-    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint45(image, ir, ic));
-      dest[ir * m_FrameSize[0] + ic] = dval ;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::DilatePoint90(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::DilatePoint90");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = 0;
-  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic;
-  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic;
-
-  for (; p <= p_max; p += m_FrameSize[0])
-  {
-    if (image[p] > dval)
-    {
-      dval = image[p];
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, -1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_DILATION);
 }
 
 //-----------------------------------------------------------------------------
@@ -748,48 +413,8 @@ void PlusFidSegmentation::Dilate90(PlusFidSegmentation::PixelType* dest, PlusFid
 {
   //LOG_TRACE("FidSegmentation::Dilate90");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
-  {
-    unsigned int ir = m_RegionOfInterest[1];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint90(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval ;
-    for (ir++; ir < m_RegionOfInterest[3]; ir++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + ic];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + ic];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint90(image, ir, ic));
-
-      dest[ir * m_FrameSize[0] + ic] = dval ;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::DilatePoint135(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic)
-{
-  //LOG_TRACE("FidSegmentation::DilatePoint135");
-
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-  PlusFidSegmentation::PixelType dval = 0;
-  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic - barSize;
-  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic + barSize;
-
-  for (; p <= p_max; p = p + m_FrameSize[0] + 1)
-  {
-    if (image[p] > dval)
-    {
-      dval = image[p];
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, 0, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_DILATION);
 }
 
 //-----------------------------------------------------------------------------
@@ -798,68 +423,8 @@ void PlusFidSegmentation::Dilate135(PlusFidSegmentation::PixelType* dest, PlusFi
 {
   //LOG_TRACE("FidSegmentation::Dilate135");
 
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
-
-  /* Up the left side. */
-  for (unsigned int sr = m_RegionOfInterest[3] - 1; sr >= m_RegionOfInterest[1]; sr--)
-  {
-    unsigned int ir = sr;
-    unsigned int ic = m_RegionOfInterest[0];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint135(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval ;
-    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint135(image, ir, ic));
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-
-  /* Across the top. */
-  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
-  {
-    unsigned int ic = sc;
-    unsigned int ir = m_RegionOfInterest[1];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint135(image, ir, ic);
-    dest[ir * m_FrameSize[0] + ic] = dval;
-    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
-    {
-      PlusFidSegmentation::PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
-      PlusFidSegmentation::PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
-
-      dval = new_val >= dval ? new_val :
-             (del_val < dval ? std::max(dval, new_val) :
-              DilatePoint135(image, ir, ic));
-      dest[ir * m_FrameSize[0] + ic] = dval;
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-
-inline PlusFidSegmentation::PixelType PlusFidSegmentation::DilatePoint(PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic, PlusCoordinate2D* shape, int slen)
-{
-  //LOG_TRACE("FidSegmentation::DilatePoint");
-
-  PlusFidSegmentation::PixelType dval = 0;
-  for (int sp = 0; sp < slen; sp++)
-  {
-    unsigned int sr = ir + shape[sp].Y;
-    unsigned int sc = ic + shape[sp].X;
-
-    if (image[sr * m_FrameSize[0] + sc] > dval)
-    {
-      dval = image[sr * m_FrameSize[0] + sc];
-    }
-  }
-  return dval;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Line(dest, image, 1, 1, GetMorphologicalOpeningBarSizePx(), PlusFidMorphology::OPERATION_DILATION);
 }
 
 //-----------------------------------------------------------------------------
@@ -868,85 +433,8 @@ void PlusFidSegmentation::DilateCircle(PlusFidSegmentation::PixelType* dest, Plu
 {
   //LOG_TRACE("FidSegmentation::DilateCircle");
 
-  unsigned int slen = m_MorphologicalCircle.size();
-
-  PlusCoordinate2D* shape = new PlusCoordinate2D[slen];
-
-  for (unsigned int i = 0; i < slen; i++)
-  {
-    shape[i] = m_MorphologicalCircle[i];
-  }
-
-  /* Which elements stick around when you shift right? */
-  int n = 0;
-
-  bool* sr_exist = new bool[slen];
-
-  memset(sr_exist, 0, slen * sizeof(bool));
-  for (unsigned int si = 0; si < slen; si++)
-  {
-    PlusCoordinate2D dot;
-    dot.X = m_MorphologicalCircle[si].X + 1;
-    dot.Y = m_MorphologicalCircle[si].Y;
-
-    if (ShapeContains(m_MorphologicalCircle, dot))
-    {
-      sr_exist[si] = true, n++;
-    }
-  }
-  //cout << "shift_exist: " << n << endl;
-
-  PlusCoordinate2D* newDots = new PlusCoordinate2D[slen];
-  PlusCoordinate2D* oldDots = new PlusCoordinate2D[slen];
-
-  int nNewDots = 0, nOldDots = 0;
-  for (unsigned int si = 0; si < slen; si++)
-  {
-    if (sr_exist[si])
-    {
-      oldDots[nOldDots++] = shape[si];
-    }
-    else
-    {
-      newDots[nNewDots++] = shape[si];
-    }
-  }
-
-  delete [] sr_exist;
-
-  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PlusFidSegmentation::PixelType));
-  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
-  {
-    unsigned int ic = m_RegionOfInterest[0];
-
-    PlusFidSegmentation::PixelType dval = DilatePoint(image, ir, ic, shape, slen);
-    PlusFidSegmentation::PixelType last = dest[ir * m_FrameSize[0] + ic] = dval;
-
-    for (ic++; ic < m_RegionOfInterest[2]; ic++)
-    {
-      PlusFidSegmentation::PixelType dval = DilatePoint(image, ir, ic, newDots, nNewDots);
-
-      if (dval < last)
-      {
-        for (int sp = 0; sp < nOldDots; sp++)
-        {
-          unsigned int sr = ir + oldDots[sp].Y;
-          unsigned int sc = ic + oldDots[sp].X;
-          if (image[sr * m_FrameSize[0] + sc] > dval)
-          {
-            dval = image[sr * m_FrameSize[0] + sc];
-          }
-          if (image[sr * m_FrameSize[0] + sc] == last)
-          {
-            break;
-          }
-        }
-      }
-      last = dest[ir * m_FrameSize[0] + ic] = dval ;
-    }
-  }
-  delete [] newDots;
-  delete [] oldDots;
+  m_Morphology.SetImageGeometry(m_FrameSize, m_RegionOfInterest);
+  m_Morphology.Spans(dest, image, m_MorphologicalCircleRowSpans, PlusFidMorphology::OPERATION_DILATION);
 }
 
 //-----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #ifndef _FIDUCIAL_SEGMENTATION_H
 #define _FIDUCIAL_SEGMENTATION_H
 
+#include "PlusFidMorphology.h"
 #include "PlusFidPatternRecognitionCommon.h"
 #include "PlusConfigure.h"
 #include "vtkXMLDataElement.h"
@@ -56,6 +57,9 @@ public:
   PlusFidSegmentation();
   virtual ~PlusFidSegmentation();
 
+  /*! Copy all parameters and results, the copy allocates its own working images */
+  PlusFidSegmentation(const PlusFidSegmentation& other);
+
   /* Read the configuration file */
   PlusStatus ReadConfiguration( vtkXMLDataElement* rootConfigElement );
 
@@ -73,25 +77,19 @@ public:
   /*! Check and modify if necessary the region of interest */
   void ValidateRegionOfInterest();
 
-  /*! Morphological operations performed by the algorithm */
-  inline PlusFidSegmentation::PixelType ErodePoint0( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
+  /*!
+    Morphological operations performed by the algorithm, computed by PlusFidMorphology.
+    Only the region of interest is computed, all other pixels of dest are set to 0.
+  */
   void Erode0( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType ErodePoint45( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Erode45( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType ErodePoint90( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Erode90( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType ErodePoint135( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Erode135( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
   void ErodeCircle( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType DilatePoint0( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Dilate0( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType DilatePoint45( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Dilate45( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType DilatePoint90( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Dilate90( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType DilatePoint135( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic );
   void Dilate135( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
-  inline PlusFidSegmentation::PixelType DilatePoint( PlusFidSegmentation::PixelType* image, unsigned int ir, unsigned int ic, PlusCoordinate2D* shape, int slen );
   void DilateCircle( PlusFidSegmentation::PixelType* dest, PlusFidSegmentation::PixelType* image );
   void Subtract( PlusFidSegmentation::PixelType* image, PlusFidSegmentation::PixelType* vals );
 
@@ -219,6 +217,12 @@ protected:
 
   std::vector<PlusCoordinate2D> m_MorphologicalCircle;
 
+  /*! The morphological circle as horizontal spans (the circle is symmetric, so rows and columns are interchangeable) */
+  std::vector<PlusFidMorphology::RowSpan> m_MorphologicalCircleRowSpans;
+
+  /*! Computes the morphological operations */
+  PlusFidMorphology m_Morphology;
+
   double m_ApproximateSpacingMmPerPixel;
   double m_ImageScalingTolerancePercent[4];
   double m_ImageNormalVectorInPhantomFrameEstimation[3];
@@ -245,6 +249,9 @@ protected:
   std::vector<PlusFidDot> m_DotsVector;
 
   bool m_DebugOutput;
+
+private:
+  PlusFidSegmentation& operator=(const PlusFidSegmentation&); // Not implemented
 };
 
 #endif // _FIDUCIAL_SEGMENTATION_H
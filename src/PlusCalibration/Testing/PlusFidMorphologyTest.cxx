@@ -0,0 +1,910 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file PlusFidMorphologyTest.cxx
+  \brief Compares the morphological operations of PlusFidSegmentation with the previous scalar implementation
+
+  The reference is a copy of the ErodePoint*, DilatePoint* based implementation that was used before
+  PlusFidMorphology. All ten operations (erosion and dilation with 0, 45, 90 and 135 degree bars and with the circle)
+  are computed on random image sizes, regions of interest, bar sizes and circle radii, and the results must be identical.
+  The circle radius is not larger than the bar size, because the reference reads outside the image otherwise.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusFidSegmentation.h"
+#include "PlusTestingHelpers.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+#include <climits>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  const int NUMBER_OF_TEST_CASES = 100;
+  const unsigned int MAX_FRAME_SIZE = 200;
+  const unsigned int MAX_BAR_SIZE_PX = 16;
+
+  typedef PlusFidSegmentation::PixelType PixelType;
+
+  //----------------------------------------------------------------------------
+  /*! Morphological operations of PlusFidSegmentation as they were implemented before PlusFidMorphology */
+  class ReferenceMorphology
+  {
+  public:
+    ReferenceMorphology(const unsigned int frameSize[2], const unsigned int regionOfInterest[4], unsigned int barSizePx, int circleRadiusPx)
+      : m_BarSizePx(barSizePx)
+    {
+      m_FrameSize[0] = frameSize[0];
+      m_FrameSize[1] = frameSize[1];
+      for (int i = 0; i < 4; i++)
+      {
+        m_RegionOfInterest[i] = regionOfInterest[i];
+      }
+      // Same circle as in PlusFidSegmentation::UpdateParameters
+      for (int x = -circleRadiusPx; x <= circleRadiusPx; x++)
+      {
+        for (int y = -circleRadiusPx; y <= circleRadiusPx; y++)
+        {
+          if (sqrt(pow(x, 2.0) + pow(y, 2.0)) <= circleRadiusPx)
+          {
+            PlusCoordinate2D dot;
+            dot.X = y;
+            dot.Y = x;
+            m_MorphologicalCircle.push_back(dot);
+          }
+        }
+      }
+    }
+
+    void Erode0(PixelType* dest, PixelType* image);
+    void Erode45(PixelType* dest, PixelType* image);
+    void Erode90(PixelType* dest, PixelType* image);
+    void Erode135(PixelType* dest, PixelType* image);
+    void ErodeCircle(PixelType* dest, PixelType* image);
+    void Dilate0(PixelType* dest, PixelType* image);
+    void Dilate45(PixelType* dest, PixelType* image);
+    void Dilate90(PixelType* dest, PixelType* image);
+    void Dilate135(PixelType* dest, PixelType* image);
+    void DilateCircle(PixelType* dest, PixelType* image);
+
+  protected:
+    unsigned int GetMorphologicalOpeningBarSizePx() { return m_BarSizePx; }
+    PixelType ErodePoint0(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType ErodePoint45(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType ErodePoint90(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType ErodePoint135(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType DilatePoint0(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType DilatePoint45(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType DilatePoint90(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType DilatePoint135(PixelType* image, unsigned int ir, unsigned int ic);
+    PixelType DilatePoint(PixelType* image, unsigned int ir, unsigned int ic, PlusCoordinate2D* shape, int slen);
+    bool ShapeContains(std::vector<PlusCoordinate2D>& shape, PlusCoordinate2D point);
+
+    unsigned int m_FrameSize[2];
+    unsigned int m_RegionOfInterest[4];
+    unsigned int m_BarSizePx;
+    std::vector<PlusCoordinate2D> m_MorphologicalCircle;
+  };
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::ErodePoint0(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = UCHAR_MAX;
+  unsigned int p = ir * m_FrameSize[0] + ic - barSize; // current pixel - bar size (position of the start of the bar)
+  unsigned int p_max = ir * m_FrameSize[0] + ic + barSize; // current pixel +  bar size (position of the end  of the bar)
+
+  //find lowest intensity in bar shaped area in image
+  for (; p <= p_max; p++)
+  {
+    if (image[p] < dval)
+    {
+      dval = image[p];
+    }
+    if (image[p] == 0)
+    {
+      break;
+    }
+  }
+
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Erode0(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
+  {
+    unsigned int ic = m_RegionOfInterest[0];
+    unsigned int p_base = ir * m_FrameSize[0];
+
+    PixelType dval = ErodePoint0(image, ir, ic);   // find lowest pixel intensity in surrounding region ( positions +/- 8 of current pixel position)
+    dest[p_base + ic] = dval; // p_base+ic = current pixel
+
+    for (ic++; ic < m_RegionOfInterest[2]; ic++)
+    {
+      PixelType new_val = image[p_base + ic + barSize];
+      PixelType del_val = image[p_base + ic - 1 - barSize];
+
+      dval = new_val <= dval ? new_val  : // dval = new val if new val is less than or equal to dval
+             del_val > dval ? std::min(dval, new_val) :   // if del val is greater than dval, dval= min of dval and new val
+             ErodePoint0(image, ir, ic);   //else dval = result of erode function
+
+      dest[ir * m_FrameSize[0] + ic] = dval; // update new "eroded" picture
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::ErodePoint45(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  PixelType dval = UCHAR_MAX;
+  unsigned int p = (ir + barSize) * m_FrameSize[0] + ic - barSize;
+  unsigned int p_max = (ir - barSize) * m_FrameSize[0] + ic + barSize;
+
+  for (; p >= p_max; p = p - m_FrameSize[0] + 1)
+  {
+    if (image[p] < dval)
+    {
+      dval = image[p];
+    }
+    if (image[p] == 0)
+    {
+      break;
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Erode45(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  /* Down the left side. */
+  for (unsigned int sr = m_RegionOfInterest[1]; sr < m_RegionOfInterest[3]; sr++)
+  {
+    unsigned int ir = sr;
+    unsigned int ic = m_RegionOfInterest[0];
+
+    PixelType dval = ErodePoint45(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
+    {
+      PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val <= dval ? new_val :
+             del_val > dval ? std::min(dval, new_val) :
+             ErodePoint45(image, ir, ic);
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+
+  /* Across the bottom */
+  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
+  {
+    unsigned int ic = sc;
+    unsigned int ir = m_RegionOfInterest[3] - 1;
+
+    PixelType dval = ErodePoint45(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
+    {
+      PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val <= dval ? new_val :
+             del_val > dval ? std::min(dval, new_val) :
+             ErodePoint45(image, ir, ic);
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::ErodePoint90(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = UCHAR_MAX;
+  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic;
+  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic;
+
+  for (; p <= p_max; p += m_FrameSize[0])
+  {
+    if (image[p] < dval)
+    {
+      dval = image[p];
+    }
+    if (image[p] == 0)
+    {
+      break;
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Erode90(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
+  {
+    unsigned int ir = m_RegionOfInterest[1];
+
+    PixelType dval = ErodePoint90(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ir++; ir < m_RegionOfInterest[3]; ir++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + ic];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + ic];
+
+      dval = new_val <= dval ? new_val :
+             del_val > dval ? std::min(dval, new_val) :
+             ErodePoint90(image, ir, ic);
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::ErodePoint135(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = UCHAR_MAX;
+  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic - barSize;
+  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic + barSize;
+
+  for (; p <= p_max; p = p + m_FrameSize[0] + 1)
+  {
+    if (image[p] < dval)
+    {
+      dval = image[p];
+    }
+    if (image[p] == 0)
+    {
+      break;
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Erode135(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  /* Up the left side. */
+  for (unsigned int sr = m_RegionOfInterest[3] - 1; sr >= m_RegionOfInterest[1]; sr--)
+  {
+    unsigned int ir = sr;
+    unsigned int ic = m_RegionOfInterest[0];
+
+    PixelType dval = ErodePoint135(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val <= dval ? new_val :
+             del_val > dval ? std::min(dval, new_val) :
+             ErodePoint135(image, ir, ic);
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+
+  /* Across the top. */
+  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
+  {
+    unsigned int ic = sc;
+    unsigned int ir = m_RegionOfInterest[1];
+
+    PixelType dval = ErodePoint135(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val <= dval ? new_val :
+             del_val > dval ? std::min(dval, new_val) :
+             ErodePoint135(image, ir, ic);
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::ErodeCircle(PixelType* dest, PixelType* image)
+{
+  unsigned int slen = m_MorphologicalCircle.size();
+
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+
+  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
+  {
+    for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
+    {
+      PixelType dval = UCHAR_MAX;
+      for (unsigned int sp = 0; sp < slen; sp++)
+      {
+        int sr = ir + m_MorphologicalCircle[sp].X;
+        int sc = ic + m_MorphologicalCircle[sp].Y;
+        PixelType pixSrc = image[sr * m_FrameSize[0] + sc];
+
+        if (pixSrc < dval)
+        {
+          dval = pixSrc;
+        }
+
+        if (pixSrc == 0)
+        {
+          break;
+        }
+      }
+
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::DilatePoint0(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = 0;
+  unsigned int p = ir * m_FrameSize[0] + ic - barSize;
+  unsigned int p_max = ir * m_FrameSize[0] + ic + barSize;
+
+  for (; p <= p_max; p++)
+  {
+    if (image[p] > dval)
+    {
+      dval = image[p];
+    }
+  }
+
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Dilate0(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
+  {
+    unsigned int ic = m_RegionOfInterest[0];
+    unsigned int p_base = ir * m_FrameSize[0];
+
+    PixelType dval = DilatePoint0(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ic++; ic < m_RegionOfInterest[2]; ic++)
+    {
+      PixelType new_val = image[p_base + ic + barSize];
+      PixelType del_val = image[p_base + ic - 1 - barSize];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint0(image, ir, ic));
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::DilatePoint45(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = 0;
+  unsigned int p = (ir + barSize) * m_FrameSize[0] + ic - barSize;
+  unsigned int p_max = (ir - barSize) * m_FrameSize[0] + ic + barSize;
+
+  while (p >= p_max)
+  {
+    if (image[p] > dval)
+    {
+      dval = image[p];
+    }
+    if (p - m_FrameSize[0] + 1 > p)
+    {
+      // unsigned int underflow, adjust
+      p = 0;
+    }
+    else
+    {
+      p = p - m_FrameSize[0] + 1;
+    }
+  }
+
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Dilate45(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  /* Down the left side. */
+  for (unsigned int sr = m_RegionOfInterest[1]; sr < m_RegionOfInterest[3]; sr++)
+  {
+    unsigned int ir = sr;
+    unsigned int ic = m_RegionOfInterest[0];
+
+    PixelType dval = DilatePoint45(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval ;
+    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
+    {
+      PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint45(image, ir, ic));
+      dest[ir * m_FrameSize[0] + ic] = dval ;
+    }
+  }
+
+  /* Across the bottom */
+  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
+  {
+    unsigned int ic = sc;
+    unsigned int ir = m_RegionOfInterest[3] - 1;
+
+    PixelType dval = DilatePoint45(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval ;
+    for (ir--, ic++; ir >= m_RegionOfInterest[1] && ic < m_RegionOfInterest[2]; ir--, ic++)
+    {
+      PixelType new_val = image[(ir - barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir + 1 + barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint45(image, ir, ic));
+      dest[ir * m_FrameSize[0] + ic] = dval ;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::DilatePoint90(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = 0;
+  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic;
+  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic;
+
+  for (; p <= p_max; p += m_FrameSize[0])
+  {
+    if (image[p] > dval)
+    {
+      dval = image[p];
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Dilate90(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  for (unsigned int ic = m_RegionOfInterest[0]; ic < m_RegionOfInterest[2]; ic++)
+  {
+    unsigned int ir = m_RegionOfInterest[1];
+
+    PixelType dval = DilatePoint90(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval ;
+    for (ir++; ir < m_RegionOfInterest[3]; ir++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + ic];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + ic];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint90(image, ir, ic));
+
+      dest[ir * m_FrameSize[0] + ic] = dval ;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::DilatePoint135(PixelType* image, unsigned int ir, unsigned int ic)
+{
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+  PixelType dval = 0;
+  unsigned int p = (ir - barSize) * m_FrameSize[0] + ic - barSize;
+  unsigned int p_max = (ir + barSize) * m_FrameSize[0] + ic + barSize;
+
+  for (; p <= p_max; p = p + m_FrameSize[0] + 1)
+  {
+    if (image[p] > dval)
+    {
+      dval = image[p];
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::Dilate135(PixelType* dest, PixelType* image)
+{
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+  const unsigned int barSize = GetMorphologicalOpeningBarSizePx();
+
+  /* Up the left side. */
+  for (unsigned int sr = m_RegionOfInterest[3] - 1; sr >= m_RegionOfInterest[1]; sr--)
+  {
+    unsigned int ir = sr;
+    unsigned int ic = m_RegionOfInterest[0];
+
+    PixelType dval = DilatePoint135(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval ;
+    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint135(image, ir, ic));
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+
+  /* Across the top. */
+  for (unsigned int sc = m_RegionOfInterest[0]; sc < m_RegionOfInterest[2]; sc++)
+  {
+    unsigned int ic = sc;
+    unsigned int ir = m_RegionOfInterest[1];
+
+    PixelType dval = DilatePoint135(image, ir, ic);
+    dest[ir * m_FrameSize[0] + ic] = dval;
+    for (ir++, ic++; ir < m_RegionOfInterest[3] && ic < m_RegionOfInterest[2]; ir++, ic++)
+    {
+      PixelType new_val = image[(ir + barSize) * m_FrameSize[0] + (ic + barSize)];
+      PixelType del_val = image[(ir - 1 - barSize) * m_FrameSize[0] + (ic - 1 - barSize)];
+
+      dval = new_val >= dval ? new_val :
+             (del_val < dval ? std::max(dval, new_val) :
+              DilatePoint135(image, ir, ic));
+      dest[ir * m_FrameSize[0] + ic] = dval;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+PixelType ReferenceMorphology::DilatePoint(PixelType* image, unsigned int ir, unsigned int ic, PlusCoordinate2D* shape, int slen)
+{
+  PixelType dval = 0;
+  for (int sp = 0; sp < slen; sp++)
+  {
+    unsigned int sr = ir + shape[sp].Y;
+    unsigned int sc = ic + shape[sp].X;
+
+    if (image[sr * m_FrameSize[0] + sc] > dval)
+    {
+      dval = image[sr * m_FrameSize[0] + sc];
+    }
+  }
+  return dval;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReferenceMorphology::DilateCircle(PixelType* dest, PixelType* image)
+{
+  unsigned int slen = m_MorphologicalCircle.size();
+
+  PlusCoordinate2D* shape = new PlusCoordinate2D[slen];
+
+  for (unsigned int i = 0; i < slen; i++)
+  {
+    shape[i] = m_MorphologicalCircle[i];
+  }
+
+  /* Which elements stick around when you shift right? */
+  int n = 0;
+
+  bool* sr_exist = new bool[slen];
+
+  memset(sr_exist, 0, slen * sizeof(bool));
+  for (unsigned int si = 0; si < slen; si++)
+  {
+    PlusCoordinate2D dot;
+    dot.X = m_MorphologicalCircle[si].X + 1;
+    dot.Y = m_MorphologicalCircle[si].Y;
+
+    if (ShapeContains(m_MorphologicalCircle, dot))
+    {
+      sr_exist[si] = true, n++;
+    }
+  }
+  //cout << "shift_exist: " << n << endl;
+
+  PlusCoordinate2D* newDots = new PlusCoordinate2D[slen];
+  PlusCoordinate2D* oldDots = new PlusCoordinate2D[slen];
+
+  int nNewDots = 0, nOldDots = 0;
+  for (unsigned int si = 0; si < slen; si++)
+  {
+    if (sr_exist[si])
+    {
+      oldDots[nOldDots++] = shape[si];
+    }
+    else
+    {
+      newDots[nNewDots++] = shape[si];
+    }
+  }
+
+  delete [] sr_exist;
+
+  memset(dest, 0, m_FrameSize[1]*m_FrameSize[0]*sizeof(PixelType));
+  for (unsigned int ir = m_RegionOfInterest[1]; ir < m_RegionOfInterest[3]; ir++)
+  {
+    unsigned int ic = m_RegionOfInterest[0];
+
+    PixelType dval = DilatePoint(image, ir, ic, shape, slen);
+    PixelType last = dest[ir * m_FrameSize[0] + ic] = dval;
+
+    for (ic++; ic < m_RegionOfInterest[2]; ic++)
+    {
+      PixelType dval = DilatePoint(image, ir, ic, newDots, nNewDots);
+
+      if (dval < last)
+      {
+        for (int sp = 0; sp < nOldDots; sp++)
+        {
+          unsigned int sr = ir + oldDots[sp].Y;
+          unsigned int sc = ic + oldDots[sp].X;
+          if (image[sr * m_FrameSize[0] + sc] > dval)
+          {
+            dval = image[sr * m_FrameSize[0] + sc];
+          }
+          if (image[sr * m_FrameSize[0] + sc] == last)
+          {
+            break;
+          }
+        }
+      }
+      last = dest[ir * m_FrameSize[0] + ic] = dval ;
+    }
+  }
+  delete [] newDots;
+  delete [] oldDots;
+  delete [] shape; // was leaked by the original implementation
+}
+
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+
+bool ReferenceMorphology::ShapeContains(std::vector<PlusCoordinate2D>& shape, PlusCoordinate2D point)
+{
+  for (unsigned int si = 0; si < shape.size(); si++)
+  {
+    if (shape[si] == point)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+//-----------------------------------------------------------------------------
+/*!
+  Fill the image with random values. Depending on the test case the image contains many zero pixels (the reference
+  stops the erosion at zero pixels), only a few gray levels (many equal values in the structuring element)
+  or uniformly distributed values.
+*/
+void FillRandomImage(PixelType* image, unsigned int numberOfPixels, int testCaseIndex, PlusTesting::TestRandomGenerator& random)
+{
+  for (unsigned int i = 0; i < numberOfPixels; i++)
+  {
+    switch (testCaseIndex % 3)
+    {
+    case 0:
+      image[i] = (random.UniformInt(0, 9) < 3 ? 0 : random.UniformInt(1, 255));
+      break;
+    case 1:
+      image[i] = static_cast<PixelType>(random.UniformInt(0, 3) * 85);
+      break;
+    default:
+      image[i] = static_cast<PixelType>(random.UniformInt(0, 255));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+int CompareOperation(const char* operationName, const PixelType* result, const PixelType* referenceResult, unsigned int numberOfPixels, int testCaseIndex)
+{
+  for (unsigned int i = 0; i < numberOfPixels; i++)
+  {
+    if (result[i] != referenceResult[i])
+    {
+      LOG_ERROR(operationName << " mismatch in test case " << testCaseIndex << " at pixel " << i << ": "
+        << static_cast<int>(result[i]) << " (expected: " << static_cast<int>(referenceResult[i]) << ")");
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int TestMorphologicalOperations(int testCaseIndex, PlusTesting::TestRandomGenerator& random)
+{
+  unsigned int barSizePx = random.UniformInt(1, MAX_BAR_SIZE_PX);
+  int circleRadiusPx = random.UniformInt(0, barSizePx);
+
+  // The bar of the region of interest pixels has to be inside the image
+  unsigned int minFrameSize = 2 * barSizePx + 3;
+  unsigned int frameSize[3] = { random.UniformInt(minFrameSize, MAX_FRAME_SIZE), random.UniformInt(minFrameSize, MAX_FRAME_SIZE), 1 };
+  unsigned int regionOfInterest[4] = { 0, 0, 0, 0 };
+  for (int axis = 0; axis < 2; axis++)
+  {
+    unsigned int minPosition = barSizePx + 1;
+    unsigned int maxPosition = frameSize[axis] - barSizePx - 1;
+    regionOfInterest[axis] = random.UniformInt(minPosition, maxPosition - 1);
+    regionOfInterest[axis + 2] = random.UniformInt(regionOfInterest[axis] + 1, maxPosition);
+  }
+  LOG_DEBUG("Test case " << testCaseIndex << ": frame size " << frameSize[0] << "x" << frameSize[1]
+    << ", region of interest " << regionOfInterest[0] << ", " << regionOfInterest[1] << ", " << regionOfInterest[2] << ", " << regionOfInterest[3]
+    << ", bar size " << barSizePx << ", circle radius " << circleRadiusPx);
+
+  PlusFidSegmentation segmentation;
+  segmentation.SetApproximateSpacingMmPerPixel(1.0);
+  segmentation.SetMorphologicalOpeningBarSizeMm(barSizePx);
+  segmentation.SetMorphologicalOpeningCircleRadiusMm(circleRadiusPx);
+  segmentation.UpdateParameters();
+  segmentation.SetRegionOfInterest(regionOfInterest[0], regionOfInterest[1], regionOfInterest[2], regionOfInterest[3]);
+  segmentation.SetFrameSize(frameSize);
+
+  ReferenceMorphology reference(frameSize, regionOfInterest, barSizePx, circleRadiusPx);
+
+  unsigned int numberOfPixels = frameSize[0] * frameSize[1];
+  std::vector<PixelType> image(numberOfPixels);
+  FillRandomImage(&image[0], numberOfPixels, testCaseIndex, random);
+  // Output pixels outside of the region of interest must be cleared
+  std::vector<PixelType> result(numberOfPixels, 1);
+  std::vector<PixelType> referenceResult(numberOfPixels, 2);
+
+  int numberOfFailures = 0;
+
+  segmentation.Erode0(&result[0], &image[0]);
+  reference.Erode0(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Erode0", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Erode45(&result[0], &image[0]);
+  reference.Erode45(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Erode45", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Erode90(&result[0], &image[0]);
+  reference.Erode90(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Erode90", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Erode135(&result[0], &image[0]);
+  reference.Erode135(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Erode135", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.ErodeCircle(&result[0], &image[0]);
+  reference.ErodeCircle(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("ErodeCircle", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Dilate0(&result[0], &image[0]);
+  reference.Dilate0(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Dilate0", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Dilate45(&result[0], &image[0]);
+  reference.Dilate45(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Dilate45", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Dilate90(&result[0], &image[0]);
+  reference.Dilate90(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Dilate90", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.Dilate135(&result[0], &image[0]);
+  reference.Dilate135(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("Dilate135", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  segmentation.DilateCircle(&result[0], &image[0]);
+  reference.DilateCircle(&referenceResult[0], &image[0]);
+  numberOfFailures += CompareOperation("DilateCircle", &result[0], &referenceResult[0], numberOfPixels, testCaseIndex);
+
+  return numberOfFailures;
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp = false;
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  PlusTesting::TestRandomGenerator random;
+  int numberOfFailures = 0;
+  for (int testCaseIndex = 0; testCaseIndex < NUMBER_OF_TEST_CASES; testCaseIndex++)
+  {
+    numberOfFailures += TestMorphologicalOperations(testCaseIndex, random);
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Test failed: " << numberOfFailures << " mismatches");
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -42,12 +42,14 @@ int main(int argc, char **argv)
   std::vector<std::string> inputSequenceMetafiles; 
   std::string inputBaselineFileName(""); 
   std::string inputConfigFileName(""); 
+  int numberOfThreads(1);
 
   args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");  
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");  
   args.AddArgument("--source-seq-files", vtksys::CommandLineArguments::MULTI_ARGUMENT, &inputSequenceMetafiles, "Input sequence metafile(s) name with path");  
   args.AddArgument("--baseline-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputBaselineFileName, "Input xml baseline file name with path");  
   args.AddArgument("--config-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputConfigFileName, "Input xml config file name with path");  
+  args.AddArgument("--number-of-threads", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfThreads, "Number of threads used for segmenting the images (0 = number of processors)");  
   
   if ( !args.Parse() )
   {
@@ -83,6 +85,7 @@ int main(int argc, char **argv)
 
   PlusFidPatternRecognition patternRecognition; 
   patternRecognition.ReadConfiguration(configRootElement);
+  patternRecognition.SetNumberOfThreads(numberOfThreads);
 
   LOG_INFO("Reading metafiles:");
 
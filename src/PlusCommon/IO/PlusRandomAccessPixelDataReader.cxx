@@ -0,0 +1,553 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusRandomAccessPixelDataReader.h"
+#include "vtk_zlib.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+  #define FSEEK _fseeki64
+  #define FTELL _ftelli64
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define FSEEK fseek
+  #define FTELL ftell
+#endif
+
+namespace
+{
+  /*! Size of the deflate history window, the maximum distance that a back-reference can point to */
+  const unsigned int DEFLATE_WINDOW_SIZE = 32768;
+  /*! Number of compressed bytes read from the file at once */
+  const unsigned int COMPRESSED_CHUNK_SIZE = 16384;
+  /*! Window bits value for inflateInit2 that enables automatic zlib and gzip header detection */
+  const int WINDOW_BITS_AUTO_DETECT_HEADER = 47;
+  /*! Window bits value for inflateInit2 for decompressing a raw deflate stream (no header) */
+  const int WINDOW_BITS_RAW_DEFLATE = -15;
+}
+
+const vtkTypeUInt64 PlusRandomAccessPixelDataReader::ACCESS_POINT_SPACING = 32 * 1024 * 1024;
+
+//----------------------------------------------------------------------------
+struct PlusRandomAccessPixelDataReader::DecompressionState
+{
+  z_stream Stream;
+  /*! Position in the uncompressed data of the next byte that inflate produces */
+  vtkTypeUInt64 UncompressedPosition;
+  /*! Position in the compressed data (relative to the data offset) of the next byte to read from the file */
+  vtkTypeUInt64 CompressedPosition;
+  /*! Compressed bytes read from the file, Stream.next_in points into this buffer */
+  std::vector<unsigned char> Input;
+};
+
+//----------------------------------------------------------------------------
+PlusRandomAccessPixelDataReader::PlusRandomAccessPixelDataReader()
+  : DataOffset(0)
+  , DataSize(0)
+  , CompressedDataSize(0)
+  , Compressed(false)
+  , FileHandle(NULL)
+  , MappedFile(NULL)
+  , MappedFileSize(0)
+#ifdef _WIN32
+  , MappedFileHandle(INVALID_HANDLE_VALUE)
+  , MappingHandle(NULL)
+#endif
+  , Decompression(NULL)
+{
+}
+
+//----------------------------------------------------------------------------
+PlusRandomAccessPixelDataReader::~PlusRandomAccessPixelDataReader()
+{
+  this->Close();
+}
+
+//----------------------------------------------------------------------------
+void PlusRandomAccessPixelDataReader::Close()
+{
+  this->StopDecompression();
+  this->UnmapFile();
+  if (this->FileHandle != NULL)
+  {
+    fclose(this->FileHandle);
+    this->FileHandle = NULL;
+  }
+  this->AccessPoints.clear();
+  this->FileName.clear();
+  this->DataOffset = 0;
+  this->DataSize = 0;
+  this->CompressedDataSize = 0;
+  this->Compressed = false;
+}
+
+//----------------------------------------------------------------------------
+bool PlusRandomAccessPixelDataReader::IsOpen() const
+{
+  return this->MappedFile != NULL || this->FileHandle != NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::OpenUncompressed(const std::string& filename, vtkTypeUInt64 dataOffset, vtkTypeUInt64 dataSize)
+{
+  this->Close();
+  this->FileName = filename;
+  this->DataOffset = dataOffset;
+  this->DataSize = dataSize;
+  this->Compressed = false;
+
+  if (this->MapFile() == PLUS_SUCCESS)
+  {
+    if (this->MappedFileSize < this->DataOffset + this->DataSize)
+    {
+      LOG_ERROR("File " << filename << " is too short: expected at least " << this->DataOffset + this->DataSize << " bytes, found " << this->MappedFileSize);
+      this->Close();
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  LOG_DEBUG("File " << filename << " could not be memory-mapped, pixel data will be read on demand");
+  this->FileHandle = fopen(filename.c_str(), "rb");
+  if (this->FileHandle == NULL)
+  {
+    LOG_ERROR("The file " << filename << " could not be opened for reading");
+    this->Close();
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::OpenCompressed(const std::string& filename, vtkTypeUInt64 dataOffset, vtkTypeUInt64 compressedDataSize, vtkTypeUInt64 uncompressedDataSize)
+{
+  this->Close();
+  this->FileName = filename;
+  this->DataOffset = dataOffset;
+  this->DataSize = uncompressedDataSize;
+  this->CompressedDataSize = compressedDataSize;
+  this->Compressed = true;
+
+  this->FileHandle = fopen(filename.c_str(), "rb");
+  if (this->FileHandle == NULL)
+  {
+    LOG_ERROR("The file " << filename << " could not be opened for reading");
+    this->Close();
+    return PLUS_FAIL;
+  }
+
+  if (this->BuildAccessPointIndex() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to index compressed pixel data in file " << filename);
+    this->Close();
+    return PLUS_FAIL;
+  }
+
+  LOG_DEBUG("Indexed compressed pixel data in " << filename << ": " << this->AccessPoints.size() << " access points");
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::GetData(vtkTypeUInt64 position, size_t size, const unsigned char*& data, std::vector<unsigned char>& buffer)
+{
+  data = NULL;
+  if (!this->IsOpen())
+  {
+    LOG_ERROR("PlusRandomAccessPixelDataReader::GetData failed: no file is open");
+    return PLUS_FAIL;
+  }
+  if (position + size > this->DataSize)
+  {
+    LOG_ERROR("PlusRandomAccessPixelDataReader::GetData failed: requested range (" << position << ", " << size << " bytes) is outside the pixel data (" << this->DataSize << " bytes)");
+    return PLUS_FAIL;
+  }
+
+  if (this->MappedFile != NULL)
+  {
+    data = this->MappedFile + this->DataOffset + position;
+    return PLUS_SUCCESS;
+  }
+
+  if (buffer.size() < size)
+  {
+    buffer.resize(size);
+  }
+  if (size == 0)
+  {
+    return PLUS_SUCCESS;
+  }
+
+  PlusStatus status = this->Compressed ? this->ReadCompressed(position, size, &buffer[0]) : this->ReadUncompressed(position, size, &buffer[0]);
+  if (status != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  data = &buffer[0];
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::ReadUncompressed(vtkTypeUInt64 position, size_t size, unsigned char* outputBuffer)
+{
+  FSEEK(this->FileHandle, this->DataOffset + position, SEEK_SET);
+  if (fread(outputBuffer, 1, size, this->FileHandle) != size)
+  {
+    LOG_ERROR("Could not read " << size << " bytes from " << this->FileName);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::BuildAccessPointIndex()
+{
+  // Decompress the whole stream once and record the decompressor state at deflate block boundaries,
+  // at least ACCESS_POINT_SPACING bytes apart (same approach as zran.c in the zlib examples).
+  this->AccessPoints.clear();
+
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit2(&strm, WINDOW_BITS_AUTO_DETECT_HEADER) != Z_OK)
+  {
+    LOG_ERROR("Failed to initialize decompression");
+    return PLUS_FAIL;
+  }
+
+  FSEEK(this->FileHandle, this->DataOffset, SEEK_SET);
+
+  std::vector<unsigned char> input(COMPRESSED_CHUNK_SIZE);
+  std::vector<unsigned char> window(DEFLATE_WINDOW_SIZE);
+  vtkTypeUInt64 totalIn = 0;
+  vtkTypeUInt64 totalOut = 0;
+  vtkTypeUInt64 lastAccessPointOut = 0;
+  int ret = Z_OK;
+  do
+  {
+    size_t bytesToRead = COMPRESSED_CHUNK_SIZE;
+    if (this->CompressedDataSize > 0 && this->CompressedDataSize - totalIn < bytesToRead)
+    {
+      bytesToRead = static_cast<size_t>(this->CompressedDataSize - totalIn);
+    }
+    strm.avail_in = static_cast<uInt>(bytesToRead > 0 ? fread(&input[0], 1, bytesToRead, this->FileHandle) : 0);
+    if (strm.avail_in == 0)
+    {
+      LOG_ERROR("Unexpected end of compressed data in " << this->FileName << " after " << totalOut << " uncompressed bytes");
+      inflateEnd(&strm);
+      return PLUS_FAIL;
+    }
+    strm.next_in = &input[0];
+
+    do
+    {
+      // Output is only needed to keep the last 32KB as dictionary, so decompress into a circular window
+      if (strm.avail_out == 0)
+      {
+        strm.avail_out = DEFLATE_WINDOW_SIZE;
+        strm.next_out = &window[0];
+      }
+      totalIn += strm.avail_in;
+      totalOut += strm.avail_out;
+      ret = inflate(&strm, Z_BLOCK);
+      totalIn -= strm.avail_in;
+      totalOut -= strm.avail_out;
+      if (ret == Z_NEED_DICT || ret == Z_MEM_ERROR || ret == Z_DATA_ERROR)
+      {
+        LOG_ERROR("Compressed data in " << this->FileName << " is corrupted");
+        inflateEnd(&strm);
+        return PLUS_FAIL;
+      }
+      if (ret == Z_STREAM_END)
+      {
+        break;
+      }
+
+      // At the end of a deflate block (not the last one) the decompressor can be restarted
+      bool endOfBlock = (strm.data_type & 128) && !(strm.data_type & 64);
+      if (endOfBlock && (totalOut == 0 || totalOut - lastAccessPointOut > ACCESS_POINT_SPACING))
+      {
+        AccessPoint point;
+        point.Bits = strm.data_type & 7;
+        point.CompressedOffset = totalIn;
+        point.UncompressedOffset = totalOut;
+        point.Window.resize(DEFLATE_WINDOW_SIZE);
+        unsigned int bytesAfterWindowPos = strm.avail_out;
+        if (bytesAfterWindowPos > 0)
+        {
+          memcpy(&point.Window[0], &window[DEFLATE_WINDOW_SIZE - bytesAfterWindowPos], bytesAfterWindowPos);
+        }
+        if (bytesAfterWindowPos < DEFLATE_WINDOW_SIZE)
+        {
+          memcpy(&point.Window[bytesAfterWindowPos], &window[0], DEFLATE_WINDOW_SIZE - bytesAfterWindowPos);
+        }
+        this->AccessPoints.push_back(point);
+        lastAccessPointOut = totalOut;
+      }
+    }
+    while (strm.avail_in != 0);
+  }
+  while (ret != Z_STREAM_END);
+
+  inflateEnd(&strm);
+
+  if (totalOut != this->DataSize)
+  {
+    LOG_ERROR("Could not uncompress " << totalIn << " bytes to " << this->DataSize << " bytes from " << this->FileName << " (got " << totalOut << " bytes)");
+    return PLUS_FAIL;
+  }
+  if (this->AccessPoints.empty())
+  {
+    LOG_ERROR("No access point found in compressed data in " << this->FileName);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::StartDecompression(const AccessPoint& point)
+{
+  this->StopDecompression();
+
+  DecompressionState* state = new DecompressionState;
+  memset(&state->Stream, 0, sizeof(state->Stream));
+  if (inflateInit2(&state->Stream, WINDOW_BITS_RAW_DEFLATE) != Z_OK)
+  {
+    LOG_ERROR("Failed to initialize decompression");
+    delete state;
+    return PLUS_FAIL;
+  }
+  this->Decompression = state;
+
+  state->CompressedPosition = point.CompressedOffset - (point.Bits ? 1 : 0);
+  state->UncompressedPosition = point.UncompressedOffset;
+  if (point.Bits)
+  {
+    FSEEK(this->FileHandle, this->DataOffset + state->CompressedPosition, SEEK_SET);
+    int partialByte = getc(this->FileHandle);
+    if (partialByte == EOF)
+    {
+      LOG_ERROR("Failed to read compressed data from " << this->FileName);
+      this->StopDecompression();
+      return PLUS_FAIL;
+    }
+    inflatePrime(&state->Stream, point.Bits, partialByte >> (8 - point.Bits));
+    state->CompressedPosition++;
+  }
+  inflateSetDictionary(&state->Stream, &point.Window[0], DEFLATE_WINDOW_SIZE);
+  state->Input.resize(COMPRESSED_CHUNK_SIZE);
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void PlusRandomAccessPixelDataReader::StopDecompression()
+{
+  if (this->Decompression == NULL)
+  {
+    return;
+  }
+  inflateEnd(&this->Decompression->Stream);
+  delete this->Decompression;
+  this->Decompression = NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::ReadCompressed(vtkTypeUInt64 position, size_t size, unsigned char* outputBuffer)
+{
+  // Find the last access point before the requested position
+  std::vector<AccessPoint>::const_iterator pointIt = this->AccessPoints.begin();
+  for (std::vector<AccessPoint>::const_iterator it = this->AccessPoints.begin(); it != this->AccessPoints.end() && it->UncompressedOffset <= position; ++it)
+  {
+    pointIt = it;
+  }
+
+  // Continue with the open decompressor if it has not passed the requested position yet
+  // and it is not farther from it than the access point
+  if (this->Decompression == NULL
+      || this->Decompression->UncompressedPosition > position
+      || this->Decompression->UncompressedPosition < pointIt->UncompressedOffset)
+  {
+    if (this->StartDecompression(*pointIt) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+  }
+  DecompressionState* state = this->Decompression;
+  z_stream& strm = state->Stream;
+
+  std::vector<unsigned char> discard;
+  vtkTypeUInt64 bytesToSkip = position - state->UncompressedPosition;
+  size_t bytesWritten = 0;
+  while (bytesWritten < size)
+  {
+    if (bytesToSkip > 0)
+    {
+      // Decompress and throw away data until the requested position is reached
+      if (discard.empty())
+      {
+        discard.resize(DEFLATE_WINDOW_SIZE);
+      }
+      strm.next_out = &discard[0];
+      strm.avail_out = static_cast<uInt>(bytesToSkip < DEFLATE_WINDOW_SIZE ? bytesToSkip : DEFLATE_WINDOW_SIZE);
+    }
+    else
+    {
+      strm.next_out = outputBuffer + bytesWritten;
+      strm.avail_out = static_cast<uInt>(size - bytesWritten);
+    }
+    uInt requestedOutput = strm.avail_out;
+
+    if (strm.avail_in == 0)
+    {
+      size_t bytesToRead = COMPRESSED_CHUNK_SIZE;
+      if (this->CompressedDataSize > 0 && this->CompressedDataSize - state->CompressedPosition < bytesToRead)
+      {
+        bytesToRead = static_cast<size_t>(this->CompressedDataSize - state->CompressedPosition);
+      }
+      // Uncompressed reads may share the file handle, so always seek to the decompressor's position
+      FSEEK(this->FileHandle, this->DataOffset + state->CompressedPosition, SEEK_SET);
+      strm.avail_in = static_cast<uInt>(bytesToRead > 0 ? fread(&state->Input[0], 1, bytesToRead, this->FileHandle) : 0);
+      state->CompressedPosition += strm.avail_in;
+      strm.next_in = &state->Input[0];
+      if (strm.avail_in == 0)
+      {
+        LOG_ERROR("Unexpected end of compressed data in " << this->FileName);
+        this->StopDecompression();
+        return PLUS_FAIL;
+      }
+    }
+
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    if (ret == Z_NEED_DICT || ret == Z_MEM_ERROR || ret == Z_DATA_ERROR)
+    {
+      LOG_ERROR("Compressed data in " << this->FileName << " is corrupted");
+      this->StopDecompression();
+      return PLUS_FAIL;
+    }
+
+    unsigned int produced = requestedOutput - strm.avail_out;
+    state->UncompressedPosition += produced;
+    if (bytesToSkip > 0)
+    {
+      bytesToSkip -= produced;
+    }
+    else
+    {
+      bytesWritten += produced;
+    }
+
+    if (ret == Z_STREAM_END && (bytesToSkip > 0 || bytesWritten < size))
+    {
+      LOG_ERROR("Unexpected end of compressed data in " << this->FileName);
+      this->StopDecompression();
+      return PLUS_FAIL;
+    }
+  }
+
+  return PLUS_SUCCESS;
+}
+
+#ifdef _WIN32
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::MapFile()
+{
+  HANDLE fileHandle = CreateFileA(this->FileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+  {
+    return PLUS_FAIL;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle(fileHandle);
+    return PLUS_FAIL;
+  }
+  HANDLE mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mappingHandle == NULL)
+  {
+    CloseHandle(fileHandle);
+    return PLUS_FAIL;
+  }
+  void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  if (view == NULL)
+  {
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    return PLUS_FAIL;
+  }
+  this->MappedFileHandle = fileHandle;
+  this->MappingHandle = mappingHandle;
+  this->MappedFile = static_cast<unsigned char*>(view);
+  this->MappedFileSize = fileSize.QuadPart;
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void PlusRandomAccessPixelDataReader::UnmapFile()
+{
+  if (this->MappedFile != NULL)
+  {
+    UnmapViewOfFile(this->MappedFile);
+    this->MappedFile = NULL;
+  }
+  if (this->MappingHandle != NULL)
+  {
+    CloseHandle(this->MappingHandle);
+    this->MappingHandle = NULL;
+  }
+  if (this->MappedFileHandle != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(this->MappedFileHandle);
+    this->MappedFileHandle = INVALID_HANDLE_VALUE;
+  }
+  this->MappedFileSize = 0;
+}
+
+#else
+
+//----------------------------------------------------------------------------
+PlusStatus PlusRandomAccessPixelDataReader::MapFile()
+{
+  int fd = open(this->FileName.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return PLUS_FAIL;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+  {
+    close(fd);
+    return PLUS_FAIL;
+  }
+  void* view = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping remains valid after the file descriptor is closed
+  close(fd);
+  if (view == MAP_FAILED)
+  {
+    return PLUS_FAIL;
+  }
+  this->MappedFile = static_cast<unsigned char*>(view);
+  this->MappedFileSize = fileStat.st_size;
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void PlusRandomAccessPixelDataReader::UnmapFile()
+{
+  if (this->MappedFile != NULL)
+  {
+    munmap(this->MappedFile, this->MappedFileSize);
+    this->MappedFile = NULL;
+  }
+  this->MappedFileSize = 0;
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusRandomAccessPixelDataReader_h
+#define __PlusRandomAccessPixelDataReader_h
+
+#include "PlusCommon.h"
+#include "vtkPlusCommonExport.h"
+
+#include <string>
+#include <vector>
+
+/*!
+  \class PlusRandomAccessPixelDataReader
+  \brief Provides random access to the pixel data block of a sequence file without reading the whole block into memory
+
+  Uncompressed pixel data is memory-mapped (if mapping is not possible, e.g., because of limited address space,
+  then the requested bytes are read from the file). Compressed (zlib or gzip) pixel data is decompressed once
+  when the file is opened to build an index of access points; later any range can be decompressed by starting
+  from the closest access point. The decompressor is kept open between reads, so reading the data
+  sequentially (e.g., frame by frame) does not decompress the same bytes again.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport PlusRandomAccessPixelDataReader
+{
+public:
+  PlusRandomAccessPixelDataReader();
+  virtual ~PlusRandomAccessPixelDataReader();
+
+  /*!
+    Open uncompressed pixel data
+    \param filename File that contains the pixel data
+    \param dataOffset Position of the first pixel data byte in the file
+    \param dataSize Number of pixel data bytes
+  */
+  PlusStatus OpenUncompressed(const std::string& filename, vtkTypeUInt64 dataOffset, vtkTypeUInt64 dataSize);
+
+  /*!
+    Open zlib or gzip compressed pixel data and build the access point index
+    \param filename File that contains the pixel data
+    \param dataOffset Position of the first compressed byte in the file
+    \param compressedDataSize Number of compressed bytes. If 0 then compressed data lasts until the end of the file.
+    \param uncompressedDataSize Expected number of bytes after decompression
+  */
+  PlusStatus OpenCompressed(const std::string& filename, vtkTypeUInt64 dataOffset, vtkTypeUInt64 compressedDataSize, vtkTypeUInt64 uncompressedDataSize);
+
+  /*! Release the file and all the associated resources */
+  void Close();
+
+  /*! Returns true if pixel data is available */
+  bool IsOpen() const;
+
+  /*!
+    Get a range of the (uncompressed) pixel data.
+    If the data is memory-mapped then data points into the mapped memory, otherwise the requested bytes
+    are copied into buffer and data points to the beginning of buffer.
+    The returned pointer is valid until the next call or until Close().
+  */
+  PlusStatus GetData(vtkTypeUInt64 position, size_t size, const unsigned char*& data, std::vector<unsigned char>& buffer);
+
+  /*! Minimum number of uncompressed bytes between access points. Larger value means smaller index but slower access. */
+  static const vtkTypeUInt64 ACCESS_POINT_SPACING;
+
+protected:
+  /*! Decompressor state that is needed to restart decompression at a block boundary */
+  struct AccessPoint
+  {
+    /*! Position in the uncompressed data */
+    vtkTypeUInt64 UncompressedOffset;
+    /*! Position in the compressed data (relative to the data offset), of the first full byte */
+    vtkTypeUInt64 CompressedOffset;
+    /*! Number of bits (1-7) from the byte before CompressedOffset, or 0 */
+    int Bits;
+    /*! Preceding uncompressed data, used as dictionary when restarting decompression */
+    std::vector<unsigned char> Window;
+  };
+
+  PlusStatus MapFile();
+  void UnmapFile();
+  PlusStatus BuildAccessPointIndex();
+  /*! Set up the decompressor to continue from the access point */
+  PlusStatus StartDecompression(const AccessPoint& point);
+  /*! Release the decompressor, the next read will start from an access point */
+  void StopDecompression();
+  PlusStatus ReadCompressed(vtkTypeUInt64 position, size_t size, unsigned char* outputBuffer);
+  PlusStatus ReadUncompressed(vtkTypeUInt64 position, size_t size, unsigned char* outputBuffer);
+
+  std::string FileName;
+  vtkTypeUInt64 DataOffset;
+  vtkTypeUInt64 DataSize;
+  vtkTypeUInt64 CompressedDataSize;
+  bool Compressed;
+
+  /*! File handle for reading through the C file API (if the file is not mapped) */
+  FILE* FileHandle;
+
+  /*! Start of the mapped file, NULL if the file is not mapped */
+  unsigned char* MappedFile;
+  /*! Size of the mapped file */
+  vtkTypeUInt64 MappedFileSize;
+#ifdef _WIN32
+  void* MappedFileHandle;
+  void* MappingHandle;
+#endif
+
+  std::vector<AccessPoint> AccessPoints;
+
+  /*! Decompressor that is kept open between reads of compressed data, NULL if there is none */
+  struct DecompressionState;
+  DecompressionState* Decompression;
+
+private:
+  PlusRandomAccessPixelDataReader(const PlusRandomAccessPixelDataReader&);
+  void operator=(const PlusRandomAccessPixelDataReader&);
+};
+
+#endif // __PlusRandomAccessPixelDataReader_h
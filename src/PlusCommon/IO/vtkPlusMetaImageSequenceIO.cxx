@@ -8,6 +8,7 @@ See License.txt for details.
 #include "itksys/SystemTools.hxx"
 #include "vtkPlusMetaImageSequenceIO.h"
 #include <iomanip>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -20,6 +21,7 @@ See License.txt for details.
 #endif
 
 #include "vtksys/SystemTools.hxx"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "PlusTrackedFrame.h"
@@ -61,6 +63,149 @@ namespace
 
   static std::string SEQMETA_FIELD_FRAME_FIELD_PREFIX = "Seq_Frame";
   static std::string SEQMETA_FIELD_IMG_STATUS = "ImageStatus";
+  /*! Number of independently compressed chunks, the chunk table is stored after the compressed data */
+  static const char* SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT = "CompressedDataChunkCount";
+
+  /*! Uncompressed size of a compression chunk if the number of frames per chunk is not specified */
+  static const unsigned int DEFAULT_COMPRESSION_CHUNK_SIZE_BYTES = 1024 * 1024;
+  /*! Size of an entry in the chunk table: number of frames and compressed size, both as 64-bit little-endian integers */
+  static const unsigned int COMPRESSED_CHUNK_TABLE_ENTRY_SIZE = 16;
+  /*! zlib stream header (deflate, 32KB window, default compression), stored before the first chunk */
+  static const unsigned int ZLIB_HEADER_SIZE = 2;
+  static const unsigned char ZLIB_HEADER[ZLIB_HEADER_SIZE] = { 0x78, 0x9C };
+  /*! Size of the end of the zlib stream: final empty deflate block (2 bytes) and Adler-32 checksum (4 bytes) */
+  static const unsigned int ZLIB_TRAILER_SIZE = 6;
+
+  enum ChunkOperationType
+  {
+    COMPRESS_CHUNKS,
+    DECOMPRESS_CHUNKS
+  };
+
+  /*! Input and output of compressing or decompressing a chunk of frames */
+  struct CompressionChunkJob
+  {
+    unsigned int NumberOfFrames;
+    unsigned int FrameSizeInBytes;
+    /*! Pixel data of each frame (compression input) */
+    std::vector<const unsigned char*> Frames;
+    /*! Compressed data (compression output, decompression input) */
+    std::vector<unsigned char> CompressedData;
+    /*! Adler-32 checksum of the uncompressed data (compression output) */
+    uLong Checksum;
+    /*! Buffer for all the frames of the chunk (decompression output) */
+    unsigned char* UncompressedData;
+    PlusStatus Status;
+  };
+
+  struct ChunkThreadFunctionInfoStruct
+  {
+    std::vector<CompressionChunkJob>* Jobs;
+    ChunkOperationType Operation;
+    int CompressionLevel;
+  };
+
+  //----------------------------------------------------------------------------
+  // Compress the frames by a new raw deflate stream. The output ends with a sync flush (byte aligned, not final block)
+  // and does not refer to any preceding data, so chunks can be concatenated into one deflate stream.
+  PlusStatus CompressChunk(CompressionChunkJob& job, int compressionLevel)
+  {
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      return PLUS_FAIL;
+    }
+
+    // deflateBound does not include the sync flush marker, add some extra space for that
+    job.CompressedData.resize(deflateBound(&strm, job.NumberOfFrames * job.FrameSizeInBytes) + 16);
+    size_t compressedSize = 0;
+    job.Checksum = adler32(0L, Z_NULL, 0);
+    for (unsigned int frameIndex = 0; frameIndex < job.NumberOfFrames; frameIndex++)
+    {
+      job.Checksum = adler32(job.Checksum, job.Frames[frameIndex], job.FrameSizeInBytes);
+      strm.next_in = const_cast<Bytef*>(job.Frames[frameIndex]);
+      strm.avail_in = job.FrameSizeInBytes;
+      int flush = (frameIndex + 1 < job.NumberOfFrames) ? Z_NO_FLUSH : Z_SYNC_FLUSH;
+      do
+      {
+        if (compressedSize == job.CompressedData.size())
+        {
+          job.CompressedData.resize(job.CompressedData.size() * 2);
+        }
+        strm.next_out = &job.CompressedData[compressedSize];
+        strm.avail_out = static_cast<uInt>(job.CompressedData.size() - compressedSize);
+        if (deflate(&strm, flush) == Z_STREAM_ERROR)
+        {
+          deflateEnd(&strm);
+          return PLUS_FAIL;
+        }
+        compressedSize = job.CompressedData.size() - strm.avail_out;
+      }
+      while (strm.avail_out == 0);
+    }
+    deflateEnd(&strm);
+    job.CompressedData.resize(compressedSize);
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus DecompressChunk(CompressionChunkJob& job)
+  {
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+    {
+      return PLUS_FAIL;
+    }
+    strm.next_in = job.CompressedData.empty() ? Z_NULL : &job.CompressedData[0];
+    strm.avail_in = static_cast<uInt>(job.CompressedData.size());
+    strm.next_out = job.UncompressedData;
+    strm.avail_out = job.NumberOfFrames * job.FrameSizeInBytes;
+    int ret = inflate(&strm, Z_SYNC_FLUSH);
+    bool complete = (ret == Z_OK || ret == Z_STREAM_END || ret == Z_BUF_ERROR) && strm.avail_out == 0;
+    inflateEnd(&strm);
+    return complete ? PLUS_SUCCESS : PLUS_FAIL;
+  }
+
+  //----------------------------------------------------------------------------
+  VTK_THREAD_RETURN_TYPE ChunkThreadFunction(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    ChunkThreadFunctionInfoStruct* str = static_cast<ChunkThreadFunctionInfoStruct*>(threadInfo->UserData);
+    std::vector<CompressionChunkJob>& jobs = *str->Jobs;
+    for (size_t jobIndex = threadInfo->ThreadID; jobIndex < jobs.size(); jobIndex += threadInfo->NumberOfThreads)
+    {
+      jobs[jobIndex].Status = (str->Operation == COMPRESS_CHUNKS) ? CompressChunk(jobs[jobIndex], str->CompressionLevel) : DecompressChunk(jobs[jobIndex]);
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  //----------------------------------------------------------------------------
+  void ProcessChunkJobs(vtkMultiThreader* threader, int numberOfThreads, std::vector<CompressionChunkJob>& jobs, ChunkOperationType operation, int compressionLevel)
+  {
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+    {
+      jobs[jobIndex].Status = PLUS_FAIL;
+    }
+    ChunkThreadFunctionInfoStruct str;
+    str.Jobs = &jobs;
+    str.Operation = operation;
+    str.CompressionLevel = compressionLevel;
+    if (numberOfThreads <= 1 || jobs.size() <= 1)
+    {
+      // no need to start threads
+      vtkMultiThreader::ThreadInfo threadInfo;
+      threadInfo.ThreadID = 0;
+      threadInfo.NumberOfThreads = 1;
+      threadInfo.UserData = &str;
+      ChunkThreadFunction(&threadInfo);
+      return;
+    }
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(ChunkThreadFunction, &str);
+    threader->SingleMethodExecute();
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -72,12 +217,25 @@ vtkPlusMetaImageSequenceIO::vtkPlusMetaImageSequenceIO()
   : vtkPlusSequenceIOBase()
   , IsPixelDataBinary(true)
   , Output2DDataWithZDimensionIncluded(false)
+  , NumberOfThreads(0)
+  , NumberOfFramesPerCompressionChunk(0)
+  , CompressionLevel(Z_DEFAULT_COMPRESSION)
+  , WriteCompressionChunkTable(true)
+  , Threader(vtkMultiThreader::New())
+  , UncompressedDataChecksum(0)
+  , DecompressedChunksBegin(0)
+  , DecompressedChunksEnd(0)
 {
 }
 
 //----------------------------------------------------------------------------
 vtkPlusMetaImageSequenceIO::~vtkPlusMetaImageSequenceIO()
 {
+  if (this->Threader != NULL)
+  {
+    this->Threader->Delete();
+    this->Threader = NULL;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -85,7 +243,10 @@ void vtkPlusMetaImageSequenceIO::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
 
-  // TODO : anything specific to print
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << std::endl;
+  os << indent << "NumberOfFramesPerCompressionChunk: " << this->NumberOfFramesPerCompressionChunk << std::endl;
+  os << indent << "CompressionLevel: " << this->CompressionLevel << std::endl;
+  os << indent << "WriteCompressionChunkTable: " << (this->WriteCompressionChunkTable ? "true" : "false") << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -349,6 +510,16 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
     return PLUS_SUCCESS;
   }
 
+  if (this->LazyPixelDataLoading)
+  {
+    unsigned int allFramesCompressedPixelBufferSize = 0;
+    if (this->UseCompression)
+    {
+      PlusCommon::StringToInt(this->TrackedFrameList->GetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE), allFramesCompressedPixelBufferSize);
+    }
+    return this->PrepareLazyPixelDataLoading(frameSizeInBytes, SEQMETA_FIELD_IMG_STATUS, allFramesCompressedPixelBufferSize);
+  }
+
   int numberOfErrors = 0;
 
   FILE* stream = NULL;
@@ -359,8 +530,30 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
     return PLUS_FAIL;
   }
 
+  // Files that were written by chunked compression contain a chunk table, which allows decompressing
+  // the pixel data in parallel, a few chunks at a time (instead of the whole pixel data at once)
+  unsigned int numberOfCompressedChunks = 0;
+  if (this->UseCompression && this->TrackedFrameList->GetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT) != NULL)
+  {
+    PlusCommon::StringToInt(this->TrackedFrameList->GetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT), numberOfCompressedChunks);
+  }
+  bool isChunkedCompression = (numberOfCompressedChunks > 0);
+  this->CompressedChunks.clear();
+  this->DecompressedChunksBegin = 0;
+  this->DecompressedChunksEnd = 0;
+
   std::vector<unsigned char> allFramesPixelBuffer;
-  if (this->UseCompression)
+  if (isChunkedCompression)
+  {
+    unsigned int allFramesCompressedPixelBufferSize = 0;
+    PlusCommon::StringToInt(this->TrackedFrameList->GetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE), allFramesCompressedPixelBufferSize);
+    if (this->ReadCompressedChunkTable(stream, numberOfCompressedChunks, allFramesCompressedPixelBufferSize) != PLUS_SUCCESS)
+    {
+      fclose(stream);
+      return PLUS_FAIL;
+    }
+  }
+  else if (this->UseCompression)
   {
     unsigned int allFramesPixelBufferSize = frameCount * frameSizeInBytes;
 
@@ -466,6 +659,21 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
         continue;
       }
     }
+    else if (isChunkedCompression)
+    {
+      if (this->DecompressChunksContainingFrame(stream, frameNumber, frameSizeInBytes) != PLUS_SUCCESS)
+      {
+        numberOfErrors++;
+        continue;
+      }
+      unsigned char* framePixelData = &(this->DecompressedChunksPixelBuffer[0]) + static_cast<size_t>(frameNumber - this->CompressedChunks[this->DecompressedChunksBegin].FirstFrame) * frameSizeInBytes;
+      if (PlusVideoFrame::GetOrientedClippedImage(framePixelData, flipInfo, this->ImageType, this->PixelType, this->NumberOfScalarComponents, this->Dimensions, *trackedFrame->GetImageData(), clipRectOrigin, clipRectSize) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to get oriented image from sequence metafile (frame number: " << frameNumber << ")!");
+        numberOfErrors++;
+        continue;
+      }
+    }
     else
     {
       if (PlusVideoFrame::GetOrientedClippedImage(&(allFramesPixelBuffer[0]) + frameNumber * frameSizeInBytes, flipInfo, this->ImageType, this->PixelType, this->NumberOfScalarComponents, this->Dimensions, *trackedFrame->GetImageData(), clipRectOrigin, clipRectSize) != PLUS_SUCCESS)
@@ -479,6 +687,12 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
 
   fclose(stream);
 
+  // Release decompression buffers
+  std::vector<unsigned char>().swap(this->DecompressedChunksPixelBuffer);
+  this->CompressedChunks.clear();
+  this->DecompressedChunksBegin = 0;
+  this->DecompressedChunksEnd = 0;
+
   if (numberOfErrors > 0)
   {
     return PLUS_FAIL;
@@ -490,19 +704,8 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::PrepareImageFile()
 {
-  if (this->GetUseCompression())
-  {
-    // use the default memory allocation routines
-    this->CompressionStream.zalloc = Z_NULL;
-    this->CompressionStream.zfree = Z_NULL;
-    this->CompressionStream.opaque = Z_NULL;
-    int ret = deflateInit(&this->CompressionStream, Z_DEFAULT_COMPRESSION);
-    if (ret != Z_OK)
-    {
-      LOG_ERROR("Image compression initialization failed (errorCode=" << ret << ")");
-      return PLUS_FAIL;
-    }
-  }
+  this->CompressedChunks.clear();
+  this->UncompressedDataChecksum = adler32(0L, Z_NULL, 0);
   if (FileOpen(&this->OutputImageFileHandle, this->TempImageFileName.c_str(), "ab+") != PLUS_SUCCESS)
   {
     LOG_ERROR("Unable to open output stream for writing.");
@@ -617,11 +820,26 @@ PlusStatus vtkPlusMetaImageSequenceIO::WriteInitialImageHeader()
       compDataSize += " ";
     }
     SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE, compDataSize);   // add spaces so that later the field can be updated with larger values
+    if (this->WriteCompressionChunkTable)
+    {
+      paddingCharacters = SEQMETA_FIELD_PADDED_LINE_LENGTH - strlen(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT) - 4;
+      std::string chunkCount("0");
+      for (int i = 0; i < paddingCharacters; ++i)
+      {
+        chunkCount += " ";
+      }
+      SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT, chunkCount);
+    }
+    else
+    {
+      SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT, (const char*)(NULL));
+    }
   }
   else
   {
     SetCustomString("CompressedData", "False");
     SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE, (const char*)(NULL));
+    SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT, (const char*)(NULL));
   }
 
   unsigned int frameSize[3] = {0, 0, 0};
@@ -926,22 +1144,6 @@ PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedImagePixelsToFile(int& com
 
   compressedDataSize = 0;
 
-  const int outputBufferSize = 16384; // can be any number, just picked a value from a zlib example
-  unsigned char outputBuffer[outputBufferSize];
-
-  z_stream strm; // stream describing the compression state
-
-  // use the default memory allocation routines
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  int ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
-  if (ret != Z_OK)
-  {
-    LOG_ERROR("Image compression initialization failed (errorCode=" << ret << ")");
-    return PLUS_FAIL;
-  }
-
   // Create a blank frame if we have to write an invalid frame to metafile
   PlusVideoFrame blankFrame;
   if (blankFrame.AllocateFrame(this->Dimensions, this->PixelType, this->NumberOfScalarComponents) != PLUS_SUCCESS)
@@ -950,87 +1152,279 @@ PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedImagePixelsToFile(int& com
     return PLUS_FAIL;
   }
   blankFrame.FillBlank();
+  unsigned int frameSizeInBytes = blankFrame.GetFrameSizeInBytes();
 
-  for (unsigned int frameNumber = 0; frameNumber < this->TrackedFrameList->GetNumberOfTrackedFrames(); frameNumber++)
+  // All the frames that are written until the sequence is closed are stored in one zlib stream.
+  // The stream consists of independently compressed chunks: each chunk is compressed by a new deflate stream and ends with
+  // a byte-aligned sync flush, so chunks can be compressed and decompressed in parallel and they can be simply concatenated.
+  if (this->CompressedChunks.empty())
   {
-    PlusTrackedFrame* trackedFrame(NULL);
-
-    if (this->EnableImageDataWrite)
+    size_t numberOfBytesWritten = 0;
+    if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, const_cast<unsigned char*>(ZLIB_HEADER), ZLIB_HEADER_SIZE, numberOfBytesWritten) != PLUS_SUCCESS)
     {
-      trackedFrame = this->TrackedFrameList->GetTrackedFrame(frameNumber);
-      if (trackedFrame == NULL)
-      {
-        LOG_ERROR("Cannot access frame " << frameNumber << " while trying to writing compress data into file");
-        deflateEnd(&strm);
-        return PLUS_FAIL;
-      }
+      LOG_ERROR("Error writing compressed data into file");
+      return PLUS_FAIL;
     }
+    compressedDataSize += numberOfBytesWritten;
+    this->UncompressedDataChecksum = adler32(0L, Z_NULL, 0);
+  }
 
-    PlusVideoFrame* videoFrame = &blankFrame;
-    if (this->EnableImageDataWrite)
+  unsigned int numberOfFramesPerChunk = this->NumberOfFramesPerCompressionChunk;
+  if (numberOfFramesPerChunk == 0)
+  {
+    numberOfFramesPerChunk = std::max<unsigned int>(1, DEFAULT_COMPRESSION_CHUNK_SIZE_BYTES / std::max<unsigned int>(1, frameSizeInBytes));
+  }
+
+  unsigned int numberOfFrames = this->TrackedFrameList->GetNumberOfTrackedFrames();
+  unsigned int numberOfChunks = (numberOfFrames + numberOfFramesPerChunk - 1) / numberOfFramesPerChunk;
+  int numberOfThreads = this->GetNumberOfThreadsForChunks(numberOfChunks);
+
+  // Compress as many chunks at once as many threads are available, then write them in order
+  std::vector<CompressionChunkJob> jobs;
+  for (unsigned int firstChunkInRound = 0; firstChunkInRound < numberOfChunks; firstChunkInRound += numberOfThreads)
+  {
+    unsigned int numberOfChunksInRound = std::min<unsigned int>(numberOfThreads, numberOfChunks - firstChunkInRound);
+    jobs.resize(numberOfChunksInRound);
+    for (unsigned int jobIndex = 0; jobIndex < numberOfChunksInRound; jobIndex++)
     {
-      if (trackedFrame->GetImageData()->IsImageValid())
+      CompressionChunkJob& job = jobs[jobIndex];
+      unsigned int firstFrame = (firstChunkInRound + jobIndex) * numberOfFramesPerChunk;
+      job.NumberOfFrames = std::min(numberOfFramesPerChunk, numberOfFrames - firstFrame);
+      job.FrameSizeInBytes = frameSizeInBytes;
+      job.Frames.resize(job.NumberOfFrames);
+      for (unsigned int i = 0; i < job.NumberOfFrames; i++)
       {
-        videoFrame = trackedFrame->GetImageData();
+        PlusVideoFrame* videoFrame = &blankFrame;
+        if (this->EnableImageDataWrite)
+        {
+          PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame(firstFrame + i);
+          if (trackedFrame == NULL)
+          {
+            LOG_ERROR("Cannot access frame " << firstFrame + i << " while trying to writing compress data into file");
+            return PLUS_FAIL;
+          }
+          if (trackedFrame->GetImageData()->IsImageValid())
+          {
+            videoFrame = trackedFrame->GetImageData();
+          }
+        }
+        job.Frames[i] = static_cast<const unsigned char*>(videoFrame->GetScalarPointer());
       }
     }
 
-    strm.next_in = (Bytef*)videoFrame->GetScalarPointer();
-    strm.avail_in = videoFrame->GetFrameSizeInBytes();
+    ProcessChunkJobs(this->Threader, numberOfThreads, jobs, COMPRESS_CHUNKS, this->CompressionLevel);
 
-    // Note: it's possible to request to consume all inputs and delete all history after each frame writing to allow random access
-    int flush = (frameNumber < this->TrackedFrameList->GetNumberOfTrackedFrames() - 1) ? Z_NO_FLUSH : Z_FINISH;
-
-    // run deflate() on input until output buffer not full, finish
-    // compression if all of source has been read in
-    do
+    for (unsigned int jobIndex = 0; jobIndex < numberOfChunksInRound; jobIndex++)
     {
-      strm.avail_out = outputBufferSize;
-      strm.next_out = outputBuffer;
-
-      ret = deflate(&strm, flush);    /* no bad return value */
-      if (ret == Z_STREAM_ERROR)
+      CompressionChunkJob& job = jobs[jobIndex];
+      if (job.Status != PLUS_SUCCESS)
       {
-        // state clobbered
-        LOG_ERROR("Zlib state became invalid during the compression process (errorCode=" << ret << ")");
-        deflateEnd(&strm);   // clean up
+        LOG_ERROR("Error occurred during compressing image data into file");
         return PLUS_FAIL;
       }
-
-      size_t numberOfBytesReadyForWriting = outputBufferSize - strm.avail_out;
       size_t numberOfBytesWritten = 0;
-      if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, outputBuffer, numberOfBytesReadyForWriting, numberOfBytesWritten) != PLUS_SUCCESS)
+      if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, &job.CompressedData[0], job.CompressedData.size(), numberOfBytesWritten) != PLUS_SUCCESS)
       {
         LOG_ERROR("Error writing compressed data into file");
-        deflateEnd(&strm);   // clean up
         return PLUS_FAIL;
       }
       compressedDataSize += numberOfBytesWritten;
 
+      CompressedChunkInfo chunk;
+      chunk.FirstFrame = this->CurrentFrameOffset + (firstChunkInRound + jobIndex) * numberOfFramesPerChunk;
+      chunk.NumberOfFrames = job.NumberOfFrames;
+      chunk.CompressedOffset = this->CompressedChunks.empty() ? ZLIB_HEADER_SIZE : this->CompressedChunks.back().CompressedOffset + this->CompressedChunks.back().CompressedSize;
+      chunk.CompressedSize = job.CompressedData.size();
+      this->CompressedChunks.push_back(chunk);
+
+      this->UncompressedDataChecksum = adler32_combine(this->UncompressedDataChecksum, job.Checksum, static_cast<z_off_t>(job.NumberOfFrames) * frameSizeInBytes);
     }
-    while (strm.avail_out == 0);
+  }
 
-    if (strm.avail_in != 0)
+  LOG_DEBUG("Writing compressed pixel data into file completed");
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedDataTrailer()
+{
+  // Final (empty) deflate block and the checksum of the uncompressed data (big-endian), as required at the end of a zlib stream
+  unsigned char trailer[ZLIB_TRAILER_SIZE] = { 0x03, 0x00, 0, 0, 0, 0 };
+  for (int i = 0; i < 4; i++)
+  {
+    trailer[2 + i] = static_cast<unsigned char>((this->UncompressedDataChecksum >> (8 * (3 - i))) & 0xFF);
+  }
+  size_t numberOfBytesWritten = 0;
+  if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, trailer, ZLIB_TRAILER_SIZE, numberOfBytesWritten) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Error writing compressed data into file");
+    return PLUS_FAIL;
+  }
+  this->CompressedBytesWritten += numberOfBytesWritten;
+  this->TotalBytesWritten += numberOfBytesWritten;
+
+  if (!this->WriteCompressionChunkTable)
+  {
+    return PLUS_SUCCESS;
+  }
+
+  // Chunk table: number of frames and compressed size of each chunk (64-bit little-endian integers)
+  std::vector<unsigned char> chunkTable(this->CompressedChunks.size() * COMPRESSED_CHUNK_TABLE_ENTRY_SIZE);
+  for (size_t chunkIndex = 0; chunkIndex < this->CompressedChunks.size(); chunkIndex++)
+  {
+    unsigned char* entry = &chunkTable[chunkIndex * COMPRESSED_CHUNK_TABLE_ENTRY_SIZE];
+    vtkTypeUInt64 numberOfFrames = this->CompressedChunks[chunkIndex].NumberOfFrames;
+    vtkTypeUInt64 compressedSize = this->CompressedChunks[chunkIndex].CompressedSize;
+    for (int i = 0; i < 8; i++)
     {
-      // state clobbered (by now all input should have been consumed)
-      LOG_ERROR("Zlib state became invalid during the compression process");
-      deflateEnd(&strm);   // clean up
+      entry[i] = static_cast<unsigned char>((numberOfFrames >> (8 * i)) & 0xFF);
+      entry[8 + i] = static_cast<unsigned char>((compressedSize >> (8 * i)) & 0xFF);
+    }
+  }
+  if (!chunkTable.empty())
+  {
+    if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, &chunkTable[0], chunkTable.size(), numberOfBytesWritten) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Error writing compressed chunk table into file");
       return PLUS_FAIL;
     }
+    this->TotalBytesWritten += numberOfBytesWritten;
   }
 
-  deflateEnd(&strm);   // clean up
+  return PLUS_SUCCESS;
+}
 
-  LOG_DEBUG("Writing compressed pixel data into file completed");
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::ReadCompressedChunkTable(FILE* stream, unsigned int numberOfChunks, unsigned int compressedDataSize)
+{
+  std::vector<unsigned char> chunkTable(numberOfChunks * COMPRESSED_CHUNK_TABLE_ENTRY_SIZE);
+  FSEEK(stream, this->PixelDataFileOffset + compressedDataSize, SEEK_SET);
+  if (fread(&chunkTable[0], 1, chunkTable.size(), stream) != chunkTable.size())
+  {
+    LOG_ERROR("Could not read compressed chunk table from " << GetPixelDataFilePath());
+    return PLUS_FAIL;
+  }
+
+  this->CompressedChunks.resize(numberOfChunks);
+  unsigned int firstFrame = 0;
+  vtkTypeUInt64 compressedOffset = ZLIB_HEADER_SIZE;
+  for (unsigned int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+  {
+    const unsigned char* entry = &chunkTable[chunkIndex * COMPRESSED_CHUNK_TABLE_ENTRY_SIZE];
+    vtkTypeUInt64 numberOfFrames = 0;
+    vtkTypeUInt64 compressedSize = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+      numberOfFrames = (numberOfFrames << 8) | entry[i];
+      compressedSize = (compressedSize << 8) | entry[8 + i];
+    }
+    CompressedChunkInfo& chunk = this->CompressedChunks[chunkIndex];
+    chunk.FirstFrame = firstFrame;
+    chunk.NumberOfFrames = static_cast<unsigned int>(numberOfFrames);
+    chunk.CompressedOffset = compressedOffset;
+    chunk.CompressedSize = compressedSize;
+    firstFrame += chunk.NumberOfFrames;
+    compressedOffset += compressedSize;
+  }
+
+  if (firstFrame != this->Dimensions[3] || compressedOffset + ZLIB_TRAILER_SIZE != compressedDataSize)
+  {
+    LOG_ERROR("Compressed chunk table in " << GetPixelDataFilePath() << " is inconsistent with the image header");
+    this->CompressedChunks.clear();
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::DecompressChunksContainingFrame(FILE* stream, int frameNumber, unsigned int frameSizeInBytes)
+{
+  if (this->DecompressedChunksBegin < this->DecompressedChunksEnd
+      && this->CompressedChunks[this->DecompressedChunksBegin].FirstFrame <= static_cast<unsigned int>(frameNumber)
+      && static_cast<unsigned int>(frameNumber) < this->CompressedChunks[this->DecompressedChunksEnd - 1].FirstFrame + this->CompressedChunks[this->DecompressedChunksEnd - 1].NumberOfFrames)
+  {
+    // already decompressed
+    return PLUS_SUCCESS;
+  }
+
+  // Find the chunk that contains the frame (binary search, chunks are ordered by frame index)
+  unsigned int lowChunk = 0;
+  unsigned int highChunk = this->CompressedChunks.size();
+  while (highChunk - lowChunk > 1)
+  {
+    unsigned int midChunk = (lowChunk + highChunk) / 2;
+    if (this->CompressedChunks[midChunk].FirstFrame <= static_cast<unsigned int>(frameNumber))
+    {
+      lowChunk = midChunk;
+    }
+    else
+    {
+      highChunk = midChunk;
+    }
+  }
+
+  // Decompress as many chunks at once as many threads are available
+  unsigned int numberOfChunks = this->CompressedChunks.size();
+  int numberOfThreads = this->GetNumberOfThreadsForChunks(numberOfChunks - lowChunk);
+  unsigned int endChunk = lowChunk + numberOfThreads;
 
-  if (ret != Z_STREAM_END)
+  unsigned int numberOfFrames = this->CompressedChunks[endChunk - 1].FirstFrame + this->CompressedChunks[endChunk - 1].NumberOfFrames - this->CompressedChunks[lowChunk].FirstFrame;
+  this->DecompressedChunksBegin = 0;
+  this->DecompressedChunksEnd = 0;
+  try
   {
-    LOG_ERROR("Error occurred during compressing image data into file");
+    this->DecompressedChunksPixelBuffer.resize(static_cast<size_t>(numberOfFrames) * frameSizeInBytes);
+  }
+  catch (std::bad_alloc& e)
+  {
+    cerr << e.what() << endl;
+    LOG_ERROR("vtkPlusMetaImageSequenceIO::ReadImagePixels failed due to out of memory. Try to reduce image buffer sizes or use a 64-bit build of Plus.");
     return PLUS_FAIL;
   }
+
+  std::vector<CompressionChunkJob> jobs(endChunk - lowChunk);
+  size_t uncompressedOffset = 0;
+  for (unsigned int chunkIndex = lowChunk; chunkIndex < endChunk; chunkIndex++)
+  {
+    const CompressedChunkInfo& chunk = this->CompressedChunks[chunkIndex];
+    CompressionChunkJob& job = jobs[chunkIndex - lowChunk];
+    job.NumberOfFrames = chunk.NumberOfFrames;
+    job.FrameSizeInBytes = frameSizeInBytes;
+    job.UncompressedData = &this->DecompressedChunksPixelBuffer[0] + uncompressedOffset;
+    uncompressedOffset += static_cast<size_t>(chunk.NumberOfFrames) * frameSizeInBytes;
+    job.CompressedData.resize(chunk.CompressedSize);
+    FSEEK(stream, this->PixelDataFileOffset + chunk.CompressedOffset, SEEK_SET);
+    if (chunk.CompressedSize > 0 && fread(&job.CompressedData[0], 1, chunk.CompressedSize, stream) != chunk.CompressedSize)
+    {
+      LOG_ERROR("Could not read " << chunk.CompressedSize << " bytes from " << GetPixelDataFilePath());
+      return PLUS_FAIL;
+    }
+  }
+
+  ProcessChunkJobs(this->Threader, numberOfThreads, jobs, DECOMPRESS_CHUNKS, this->CompressionLevel);
+
+  for (unsigned int jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+  {
+    if (jobs[jobIndex].Status != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Cannot uncompress the pixel data of frames " << this->CompressedChunks[lowChunk + jobIndex].FirstFrame << "-"
+                << this->CompressedChunks[lowChunk + jobIndex].FirstFrame + this->CompressedChunks[lowChunk + jobIndex].NumberOfFrames - 1);
+      return PLUS_FAIL;
+    }
+  }
+
+  this->DecompressedChunksBegin = lowChunk;
+  this->DecompressedChunksEnd = endChunk;
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+int vtkPlusMetaImageSequenceIO::GetNumberOfThreadsForChunks(int numberOfChunks)
+{
+  int numberOfThreads = (this->NumberOfThreads > 0 ? this->NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  return std::max(1, std::min(numberOfThreads, numberOfChunks));
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::ConvertMetaElementTypeToVtkPixelType(const std::string& elementTypeStr, PlusCommon::VTKScalarPixelType& vtkPixelType)
 {
@@ -1304,6 +1698,10 @@ PlusStatus vtkPlusMetaImageSequenceIO::Close()
   // Update fields that are known only at the end of the processing
   if (this->GetUseCompression())
   {
+    if (!this->CompressedChunks.empty() && this->WriteCompressedDataTrailer() != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
     std::stringstream ss;
     ss << this->CompressedBytesWritten;
     this->SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE, ss.str().c_str());
@@ -1311,7 +1709,15 @@ PlusStatus vtkPlusMetaImageSequenceIO::Close()
     {
       return PLUS_FAIL;
     }
-    deflateEnd(&this->CompressionStream);   // clean up
+    if (this->WriteCompressionChunkTable)
+    {
+      this->SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT, static_cast<int>(this->CompressedChunks.size()));
+      if (UpdateFieldInImageHeader(SEQMETA_FIELD_COMPRESSED_DATA_CHUNK_COUNT) != PLUS_SUCCESS)
+      {
+        return PLUS_FAIL;
+      }
+    }
+    this->CompressedChunks.clear();
   }
 
   fclose(this->OutputImageFileHandle);
@@ -1322,6 +1728,9 @@ PlusStatus vtkPlusMetaImageSequenceIO::Close()
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::SetFileName(const std::string& aFilename)
 {
+  // Pixel data that is already being written into its final file keeps its name
+  std::string pixelDataFileNameInUse = this->PixelDataFileName;
+
   this->FileName.clear();
   this->PixelDataFileName.clear();
 
@@ -1372,9 +1781,29 @@ PlusStatus vtkPlusMetaImageSequenceIO::SetFileName(const std::string& aFilename)
     this->PixelDataFileName = "";
   }
 
+  if (this->PixelDataWrittenInPlace)
+  {
+    this->PixelDataFileName = pixelDataFileNameInUse;
+  }
+
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+std::string vtkPlusMetaImageSequenceIO::GetStreamingPixelDataFileName()
+{
+  std::string pixFileName = vtksys::SystemTools::GetFilenameWithoutExtension(this->FileName);
+  if (this->UseCompression)
+  {
+    pixFileName += ".zraw";
+  }
+  else
+  {
+    pixFileName += ".raw";
+  }
+  return pixFileName;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::UpdateDimensionsCustomStrings(int numberOfFrames, bool isData3D)
 {
@@ -16,6 +16,7 @@
 #include "vtkPlusSequenceIOBase.h"
 #include "itk_zlib.h"
 
+class vtkMultiThreader;
 class vtkPlusTrackedFrameList;
 
 /*!
@@ -34,6 +35,32 @@ public:
   vtkSetMacro(Output2DDataWithZDimensionIncluded, bool);
   vtkGetMacro(Output2DDataWithZDimensionIncluded, bool);
 
+  /*! Number of threads used for compressing and decompressing pixel data. If 0 then the default number of threads is used. */
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /*!
+    Number of frames in an independently compressed chunk of pixel data. Chunks are compressed and decompressed in parallel.
+    Smaller chunks allow more parallelism and faster access to individual frames, larger chunks give slightly better compression ratio.
+    If 0 then the number of frames is chosen so that a chunk contains about 1MB of uncompressed pixel data.
+  */
+  vtkSetMacro(NumberOfFramesPerCompressionChunk, int);
+  vtkGetMacro(NumberOfFramesPerCompressionChunk, int);
+
+  /*! zlib compression level: 1 gives the fastest compression, 9 gives the best compression ratio, -1 is the zlib default (6) */
+  vtkSetMacro(CompressionLevel, int);
+  vtkGetMacro(CompressionLevel, int);
+
+  /*!
+    If enabled (default) then a table of the compressed chunks is written after the compressed pixel data and the number of chunks
+    is stored in the CompressedDataChunkCount header field. The table allows Plus to decompress a few chunks at a time, in parallel,
+    when the file is read. The compressed pixel data is a standard zlib stream in both cases, the table is outside CompressedDataSize.
+    If disabled then the file has exactly the same layout as a MetaImage file that is written by other tools.
+  */
+  vtkSetMacro(WriteCompressionChunkTable, bool);
+  vtkGetMacro(WriteCompressionChunkTable, bool);
+  vtkBooleanMacro(WriteCompressionChunkTable, bool);
+
   /*! Update the number of frames in the header
       This is used primarily by vtkPlusVirtualCapture to update the final tally of frames, as it continually appends new frames to the file
       /param numberOfFrames the new number of frames to write
@@ -87,6 +114,9 @@ protected:
   /*! Prepare the image file for writing */
   virtual PlusStatus PrepareImageFile();
 
+  /*! Get the name of the separate pixel data file that is used in streaming mode */
+  virtual std::string GetStreamingPixelDataFileName();
+
   /*! Write all the fields to the metaimage file header */
   virtual PlusStatus WriteInitialImageHeader();
 
@@ -98,6 +128,25 @@ protected:
   */
   virtual PlusStatus WriteCompressedImagePixelsToFile(int& compressedDataSize);
 
+  /*!
+    Write the end of the compressed pixel data stream (final block and checksum), followed by the chunk table (if WriteCompressionChunkTable is enabled).
+    The chunk table is stored after the compressed data (outside CompressedDataSize), so that the pixel data remains
+    a standard zlib stream that any MetaImage reader can decompress.
+  */
+  PlusStatus WriteCompressedDataTrailer();
+
+  /*! Read the compressed chunk table that follows the compressed pixel data */
+  PlusStatus ReadCompressedChunkTable(FILE* stream, unsigned int numberOfChunks, unsigned int compressedDataSize);
+
+  /*!
+    Decompress the chunks that contain the requested frame (and the following chunks that can be decompressed in parallel)
+    into DecompressedChunksPixelBuffer
+  */
+  PlusStatus DecompressChunksContainingFrame(FILE* stream, int frameNumber, unsigned int frameSizeInBytes);
+
+  /*! Get the number of threads to use for processing the specified number of compression chunks */
+  int GetNumberOfThreadsForChunks(int numberOfChunks);
+
   /*! Conversion between ITK and METAIO pixel types */
   PlusStatus ConvertMetaElementTypeToVtkPixelType(const std::string& elementTypeStr, PlusCommon::VTKScalarPixelType& vtkPixelType);
   /*! Conversion between ITK and METAIO pixel types */
@@ -108,8 +157,37 @@ private:
   bool IsPixelDataBinary;
   /*! If 2D data, boolean to determine if we should write out in the form X Y Nfr (false) or X Y 1 Nfr (true) */
   bool Output2DDataWithZDimensionIncluded;
-  /*! compression stream handle for compression streaming */
-  z_stream CompressionStream;
+
+  /*! Number of threads used for compression and decompression (0 means the default number of threads) */
+  int NumberOfThreads;
+  /*! Number of frames in a compression chunk (0 means automatic) */
+  int NumberOfFramesPerCompressionChunk;
+  /*! zlib compression level */
+  int CompressionLevel;
+  /*! Write the compressed chunk table after the compressed pixel data */
+  bool WriteCompressionChunkTable;
+  vtkMultiThreader* Threader;
+
+  /*! Location of an independently compressed chunk of pixel data */
+  struct CompressedChunkInfo
+  {
+    /*! Index of the first frame in the chunk */
+    unsigned int FirstFrame;
+    /*! Number of frames in the chunk */
+    unsigned int NumberOfFrames;
+    /*! Position of the chunk relative to the beginning of the compressed data */
+    vtkTypeUInt64 CompressedOffset;
+    /*! Size of the compressed chunk in bytes */
+    vtkTypeUInt64 CompressedSize;
+  };
+  /*! Compressed chunks written so far (when writing) or read from the chunk table (when reading) */
+  std::vector<CompressedChunkInfo> CompressedChunks;
+  /*! Adler-32 checksum of all the uncompressed pixel data written so far */
+  uLong UncompressedDataChecksum;
+  /*! Decompressed pixel data of the chunks [DecompressedChunksBegin, DecompressedChunksEnd) */
+  std::vector<unsigned char> DecompressedChunksPixelBuffer;
+  unsigned int DecompressedChunksBegin;
+  unsigned int DecompressedChunksEnd;
 
 protected:
   vtkPlusMetaImageSequenceIO(const vtkPlusMetaImageSequenceIO&); //purposely not implemented
@@ -369,6 +369,17 @@ PlusStatus vtkPlusNrrdSequenceIO::ReadImagePixels()
     return PLUS_SUCCESS;
   }
 
+  if (this->LazyPixelDataLoading)
+  {
+    if (this->UseCompression && (this->Encoding < NRRD_ENCODING_GZ || this->Encoding >= NRRD_ENCODING_BZ2))
+    {
+      LOG_ERROR("Lazy pixel data loading is only supported for raw and gzip encoded pixel data: " << this->GetPixelDataFilePath());
+      return PLUS_FAIL;
+    }
+    // gzip compressed data lasts until the end of the file
+    return this->PrepareLazyPixelDataLoading(frameSizeInBytes, SEQUENCE_FIELD_IMG_STATUS, 0);
+  }
+
   int numberOfErrors = 0;
 
   FILE* stream = NULL;
@@ -1253,6 +1264,9 @@ const char* vtkPlusNrrdSequenceIO::GetDimensionKindsString()
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusNrrdSequenceIO::SetFileName(const std::string& aFilename)
 {
+  // Pixel data that is already being written into its final file keeps its name
+  std::string pixelDataFileNameInUse = this->PixelDataFileName;
+
   this->FileName.clear();
   this->PixelDataFileName.clear();
 
@@ -1293,9 +1307,29 @@ PlusStatus vtkPlusNrrdSequenceIO::SetFileName(const std::string& aFilename)
     this->PixelDataFileName = std::string("");   //empty string denotes local storage
   }
 
+  if (this->PixelDataWrittenInPlace)
+  {
+    this->PixelDataFileName = pixelDataFileNameInUse;
+  }
+
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+std::string vtkPlusNrrdSequenceIO::GetStreamingPixelDataFileName()
+{
+  std::string pixFileName = vtksys::SystemTools::GetFilenameWithoutExtension(this->FileName);
+  if (this->UseCompression)
+  {
+    pixFileName += ".raw.gz";
+  }
+  else
+  {
+    pixFileName += ".raw";
+  }
+  return pixFileName;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusNrrdSequenceIO::UpdateDimensionsCustomStrings(int numberOfFrames, bool isData3D)
 {
@@ -99,6 +99,9 @@ protected:
   /*! Prepare the image file for writing */
   virtual PlusStatus PrepareImageFile();
 
+  /*! Get the name of the separate pixel data file that is used in streaming mode */
+  virtual std::string GetStreamingPixelDataFileName();
+
   /*! Write all the fields to the image file header */
   virtual PlusStatus WriteInitialImageHeader();
 
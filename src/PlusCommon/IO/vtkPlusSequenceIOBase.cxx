@@ -5,12 +5,15 @@ See License.txt for details.
 =========================================================Plus=header=end*/
 
 #include "PlusConfigure.h"
+#include "PlusRandomAccessPixelDataReader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPlusSequenceIOBase.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtksys/SystemTools.hxx"
 #include "PlusTrackedFrame.h"
 
+#include <algorithm>
+
 #if _WIN32
 #include <errno.h>
 
@@ -23,8 +26,6 @@ See License.txt for details.
 
 //----------------------------------------------------------------------------
 
-vtkCxxSetObjectMacro( vtkPlusSequenceIOBase, TrackedFrameList, vtkPlusTrackedFrameList );
-
 //----------------------------------------------------------------------------
 vtkPlusSequenceIOBase::vtkPlusSequenceIOBase()
   : TrackedFrameList( vtkPlusTrackedFrameList::New() )
@@ -43,6 +44,12 @@ vtkPlusSequenceIOBase::vtkPlusSequenceIOBase()
   , PixelDataFileOffset( 0 )
   , PixelDataFileName( "" )
   , OutputImageFileHandle( NULL )
+  , StreamingWrite( false )
+  , PixelDataWrittenInPlace( false )
+  , LazyPixelDataLoading( false )
+  , MaximumNumberOfLoadedFrames( 0 )
+  , PixelDataReader( NULL )
+  , FrameSizeInBytes( 0 )
 {
   this->Dimensions[0] = 1;
   this->Dimensions[1] = 1;
@@ -57,6 +64,29 @@ vtkPlusSequenceIOBase::~vtkPlusSequenceIOBase()
   {
     this->SetTrackedFrameList( NULL );
   }
+  this->StopLazyPixelDataLoading();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSequenceIOBase::SetTrackedFrameList( vtkPlusTrackedFrameList* trackedFrameList )
+{
+  if ( this->TrackedFrameList == trackedFrameList )
+  {
+    return;
+  }
+  // Pixel data can only be loaded into the list that the file was read into
+  this->StopLazyPixelDataLoading();
+  vtkPlusTrackedFrameList* previousTrackedFrameList = this->TrackedFrameList;
+  this->TrackedFrameList = trackedFrameList;
+  if ( this->TrackedFrameList != NULL )
+  {
+    this->TrackedFrameList->Register( this );
+  }
+  if ( previousTrackedFrameList != NULL )
+  {
+    previousTrackedFrameList->UnRegister( this );
+  }
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -69,6 +99,7 @@ void vtkPlusSequenceIOBase::PrintSelf( ostream& os, vtkIndent indent )
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSequenceIOBase::Read()
 {
+  this->StopLazyPixelDataLoading();
   this->TrackedFrameList->Clear();
 
   if ( this->ReadImageHeader() != PLUS_SUCCESS )
@@ -227,6 +258,27 @@ PlusStatus vtkPlusSequenceIOBase::PrepareHeader()
     this->TempHeaderFileName = tempFilename;
   }
 
+  if ( this->StreamingWrite && this->PixelDataFileName.empty() )
+  {
+    // Pixel data would be appended to the header, which requires copying all the pixel data when the file is closed,
+    // so store the pixel data in a separate file instead
+    this->PixelDataFileName = this->GetStreamingPixelDataFileName();
+  }
+
+  if ( this->TempImageFileName.empty() && !this->PixelDataFileName.empty() )
+  {
+    // Pixel data is stored in a separate file, write it directly to its final location
+    // so that no data has to be moved or copied when the sequence is closed
+    this->TempImageFileName = this->GetOutputPixelDataFilePath();
+    if ( vtksys::SystemTools::FileExists( this->TempImageFileName.c_str(), true ) && !vtksys::SystemTools::RemoveFile( this->TempImageFileName.c_str() ) )
+    {
+      LOG_ERROR( "Unable to overwrite existing pixel data file " << this->TempImageFileName << ". Check write access." );
+      this->TempImageFileName.clear();
+      return PLUS_FAIL;
+    }
+    this->PixelDataWrittenInPlace = true;
+  }
+
   if( this->TempImageFileName.empty() )
   {
     std::string tempFilename;
@@ -293,20 +345,17 @@ PlusStatus vtkPlusSequenceIOBase::Close()
   else
   {
     // Rename image to final filename (header+data file)
-
-    // Use the same path as the header but replace the filename
-    std::vector<std::string> pathElements;
-    vtksys::SystemTools::SplitPath( headerFullPath.c_str(), pathElements );
-    pathElements.erase( pathElements.end() - 1 );
-    std::string pixelDataFileNameOnly = vtksys::SystemTools::GetFilenameName( this->PixelDataFileName );
-    pathElements.push_back( pixelDataFileNameOnly );
-    std::string pixFullPath = vtksys::SystemTools::JoinPath( pathElements );
-
-    MoveFileInternal( this->TempImageFileName.c_str(), pixFullPath.c_str() );
+    // If pixel data was written in place then it is already there, unless the file name has been changed since
+    std::string pixFullPath = this->GetOutputPixelDataFilePath();
+    if ( vtksys::SystemTools::CollapseFullPath( this->TempImageFileName.c_str() ) != vtksys::SystemTools::CollapseFullPath( pixFullPath.c_str() ) )
+    {
+      MoveFileInternal( this->TempImageFileName.c_str(), pixFullPath.c_str() );
+    }
   }
 
   this->TempHeaderFileName.clear();
   this->TempImageFileName.clear();
+  this->PixelDataWrittenInPlace = false;
 
   this->CurrentFrameOffset = 0;
   this->TotalBytesWritten = 0;
@@ -441,11 +490,17 @@ PlusStatus vtkPlusSequenceIOBase::MoveFileInternal( const char* oldname, const c
     success = ( MoveFile( oldname, newname ) != 0 );
   }
 #else
+  // Renaming is instantaneous if the source and destination are on the same file system
+  if ( rename( oldname, newname ) == 0 )
+  {
+    return PLUS_SUCCESS;
+  }
   if( !vtksys::SystemTools::CopyFileAlways( oldname, newname ) )
   {
     return PLUS_FAIL;
   }
   vtksys::SystemTools::RemoveFile( oldname );
+  success = true;
 #endif
   return success ? PLUS_SUCCESS : PLUS_FAIL;
 }
@@ -458,6 +513,7 @@ PlusStatus vtkPlusSequenceIOBase::Discard()
 
   this->TempHeaderFileName.clear();
   this->TempImageFileName.clear();
+  this->PixelDataWrittenInPlace = false;
 
   this->CurrentFrameOffset = 0;
   this->TotalBytesWritten = 0;
@@ -468,8 +524,242 @@ PlusStatus vtkPlusSequenceIOBase::Discard()
 //----------------------------------------------------------------------------
 PlusTrackedFrame* vtkPlusSequenceIOBase::GetTrackedFrame( int frameNumber )
 {
-  PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame( frameNumber );
-  return trackedFrame;
+  // The tracked frame list loads the pixel data of the frame if needed
+  return this->TrackedFrameList->GetTrackedFrame( frameNumber );
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIOBase::ReleaseFramePixelData( int frameNumber )
+{
+  if ( this->PixelDataReader == NULL || frameNumber < 0 || frameNumber >= static_cast<int>( this->FramePixelData.size() ) )
+  {
+    LOG_ERROR( "Cannot release pixel data of frame " << frameNumber << ": pixel data was not loaded on demand" );
+    return PLUS_FAIL;
+  }
+  if ( this->FramePixelData[frameNumber].State != FRAME_PIXEL_DATA_LOADED )
+  {
+    return PLUS_SUCCESS;
+  }
+  std::deque<unsigned int>::iterator loadedFrameIt = std::find( this->LoadedFrames.begin(), this->LoadedFrames.end(), static_cast<unsigned int>( frameNumber ) );
+  if ( loadedFrameIt != this->LoadedFrames.end() )
+  {
+    this->LoadedFrames.erase( loadedFrameIt );
+  }
+  this->UnloadFramePixelData( frameNumber );
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusSequenceIOBase::IsFramePixelDataLoaded( int frameNumber )
+{
+  if ( frameNumber < 0 || frameNumber >= static_cast<int>( this->FramePixelData.size() ) )
+  {
+    // Frames that are not loaded on demand are always in memory
+    return true;
+  }
+  return this->FramePixelData[frameNumber].State != FRAME_PIXEL_DATA_NOT_LOADED;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIOBase::PrepareLazyPixelDataLoading( unsigned int frameSizeInBytes, const std::string& imageStatusFieldName, unsigned long long compressedDataSize )
+{
+  PlusVideoFrame::FlipInfoType flipInfo;
+  if ( PlusVideoFrame::GetFlipAxes( this->ImageOrientationInFile, this->ImageType, this->ImageOrientationInMemory, flipInfo ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to convert image data to the requested orientation, from " << PlusVideoFrame::GetStringFromUsImageOrientation( this->ImageOrientationInFile ) <<
+               " to " << PlusVideoFrame::GetStringFromUsImageOrientation( this->ImageOrientationInMemory ) );
+    return PLUS_FAIL;
+  }
+
+  int frameCount = this->Dimensions[3];
+  unsigned long long allFramesPixelDataSize = static_cast<unsigned long long>( frameCount ) * frameSizeInBytes;
+
+  this->PixelDataReader = new PlusRandomAccessPixelDataReader;
+  PlusStatus openStatus = PLUS_FAIL;
+  if ( this->UseCompression )
+  {
+    openStatus = this->PixelDataReader->OpenCompressed( this->GetPixelDataFilePath(), this->PixelDataFileOffset, compressedDataSize, allFramesPixelDataSize );
+  }
+  else
+  {
+    openStatus = this->PixelDataReader->OpenUncompressed( this->GetPixelDataFilePath(), this->PixelDataFileOffset, allFramesPixelDataSize );
+  }
+  if ( openStatus != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to open pixel data file " << this->GetPixelDataFilePath() << " for on-demand loading" );
+    delete this->PixelDataReader;
+    this->PixelDataReader = NULL;
+    return PLUS_FAIL;
+  }
+
+  this->FrameSizeInBytes = frameSizeInBytes;
+  this->FramePixelData.resize( frameCount );
+  for ( int frameNumber = 0; frameNumber < frameCount; frameNumber++ )
+  {
+    this->FramePixelData[frameNumber].State = FRAME_PIXEL_DATA_NOT_LOADED;
+    this->FramePixelData[frameNumber].FileFrameIndex = frameNumber;
+
+    this->CreateTrackedFrameIfNonExisting( frameNumber );
+    PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame( frameNumber );
+
+    const char* imgStatus = trackedFrame->GetCustomFrameField( imageStatusFieldName.c_str() );
+    if ( imgStatus != NULL )
+    {
+      // Image status can be determined by trackedFrame->GetImageData()->IsImageValid()
+      std::string strImgStatus( imgStatus );
+      trackedFrame->DeleteCustomFrameField( imageStatusFieldName.c_str() );
+      if ( !PlusCommon::IsEqualInsensitive( strImgStatus, "OK" ) )
+      {
+        this->FramePixelData[frameNumber].State = FRAME_PIXEL_DATA_INVALID;
+        continue;
+      }
+    }
+
+    trackedFrame->GetImageData()->SetImageOrientation( this->ImageOrientationInMemory );
+    trackedFrame->GetImageData()->SetImageType( this->ImageType );
+  }
+
+  // From now on the frames are loaded when they are retrieved from the list
+  this->TrackedFrameList->SetPixelDataLoader( this );
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSequenceIOBase::StopLazyPixelDataLoading()
+{
+  if ( this->TrackedFrameList != NULL && this->TrackedFrameList->GetPixelDataLoader() == this )
+  {
+    // Frames that have not been loaded yet remain without pixel data
+    this->TrackedFrameList->SetPixelDataLoader( NULL );
+  }
+  delete this->PixelDataReader;
+  this->PixelDataReader = NULL;
+  this->FramePixelData.clear();
+  this->LoadedFrames.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSequenceIOBase::OnTrackedFrameAccessed( unsigned int frameNumber )
+{
+  if ( this->PixelDataReader == NULL || frameNumber >= this->FramePixelData.size()
+       || this->FramePixelData[frameNumber].State != FRAME_PIXEL_DATA_NOT_LOADED )
+  {
+    return;
+  }
+
+  if ( this->LoadFramePixelData( frameNumber ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to load pixel data of frame " << frameNumber << " from " << this->GetPixelDataFilePath() );
+    // Do not try again at each access, the frame is reported as not having valid image data
+    this->FramePixelData[frameNumber].State = FRAME_PIXEL_DATA_INVALID;
+    return;
+  }
+
+  this->LoadedFrames.push_back( frameNumber );
+  if ( this->MaximumNumberOfLoadedFrames > 0 )
+  {
+    while ( this->LoadedFrames.size() > static_cast<unsigned int>( this->MaximumNumberOfLoadedFrames ) )
+    {
+      this->UnloadFramePixelData( this->LoadedFrames.front() );
+      this->LoadedFrames.pop_front();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSequenceIOBase::OnTrackedFramesRemoved( unsigned int frameNumberFrom, unsigned int frameNumberTo )
+{
+  if ( frameNumberFrom >= this->FramePixelData.size() )
+  {
+    // Only frames that were added after reading are removed
+    return;
+  }
+  unsigned int lastRemovedFrameNumber = std::min<unsigned int>( frameNumberTo, this->FramePixelData.size() - 1 );
+  unsigned int numberOfRemovedFrames = frameNumberTo - frameNumberFrom + 1;
+  this->FramePixelData.erase( this->FramePixelData.begin() + frameNumberFrom, this->FramePixelData.begin() + lastRemovedFrameNumber + 1 );
+
+  // Keep the list positions of the loaded frames in sync with the tracked frame list
+  std::deque<unsigned int> loadedFrames;
+  for ( std::deque<unsigned int>::iterator loadedFrameIt = this->LoadedFrames.begin(); loadedFrameIt != this->LoadedFrames.end(); ++loadedFrameIt )
+  {
+    if ( *loadedFrameIt < frameNumberFrom )
+    {
+      loadedFrames.push_back( *loadedFrameIt );
+    }
+    else if ( *loadedFrameIt > frameNumberTo )
+    {
+      loadedFrames.push_back( *loadedFrameIt - numberOfRemovedFrames );
+    }
+  }
+  this->LoadedFrames.swap( loadedFrames );
+}
+
+//----------------------------------------------------------------------------
+PlusTrackedFrame* vtkPlusSequenceIOBase::GetTrackedFrameWithoutLoading( unsigned int frameNumber )
+{
+  if ( frameNumber >= this->TrackedFrameList->GetNumberOfTrackedFrames() )
+  {
+    return NULL;
+  }
+  // Iterators give access to the frame without triggering the pixel data loader
+  return *( this->TrackedFrameList->begin() + frameNumber );
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSequenceIOBase::UnloadFramePixelData( unsigned int frameNumber )
+{
+  PlusTrackedFrame* trackedFrame = this->GetTrackedFrameWithoutLoading( frameNumber );
+  if ( trackedFrame == NULL || frameNumber >= this->FramePixelData.size() )
+  {
+    return;
+  }
+  // Drop the reference to the image, keep only the image orientation and type
+  PlusVideoFrame emptyFrame;
+  emptyFrame.SetImageOrientation( this->ImageOrientationInMemory );
+  emptyFrame.SetImageType( this->ImageType );
+  trackedFrame->GetImageData()->ShallowCopy( emptyFrame );
+  this->FramePixelData[frameNumber].State = FRAME_PIXEL_DATA_NOT_LOADED;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIOBase::LoadFramePixelData( unsigned int frameNumber )
+{
+  PlusTrackedFrame* trackedFrame = this->GetTrackedFrameWithoutLoading( frameNumber );
+  if ( trackedFrame == NULL )
+  {
+    LOG_ERROR( "Cannot access frame " << frameNumber );
+    return PLUS_FAIL;
+  }
+
+  unsigned long long fileFrameIndex = this->FramePixelData[frameNumber].FileFrameIndex;
+  const unsigned char* framePixelData = NULL;
+  if ( this->PixelDataReader->GetData( fileFrameIndex * this->FrameSizeInBytes, this->FrameSizeInBytes, framePixelData, this->FramePixelBuffer ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Could not read " << this->FrameSizeInBytes << " bytes of frame " << fileFrameIndex << " from " << this->GetPixelDataFilePath() );
+    return PLUS_FAIL;
+  }
+
+  if ( trackedFrame->GetImageData()->AllocateFrame( this->Dimensions, this->PixelType, this->NumberOfScalarComponents ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Cannot allocate memory for frame " << fileFrameIndex );
+    return PLUS_FAIL;
+  }
+
+  PlusVideoFrame::FlipInfoType flipInfo;
+  PlusVideoFrame::GetFlipAxes( this->ImageOrientationInFile, this->ImageType, this->ImageOrientationInMemory, flipInfo );
+  int clipRectOrigin[3] = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+  int clipRectSize[3] = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+  // GetOrientedClippedImage does not modify the input pixel data (mapped file memory is read-only)
+  if ( PlusVideoFrame::GetOrientedClippedImage( const_cast<unsigned char*>( framePixelData ), flipInfo, this->ImageType, this->PixelType, this->NumberOfScalarComponents,
+       this->Dimensions, *trackedFrame->GetImageData(), clipRectOrigin, clipRectSize ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to get oriented image from sequence file (frame number: " << fileFrameIndex << ")!" );
+    return PLUS_FAIL;
+  }
+
+  this->FramePixelData[frameNumber].State = FRAME_PIXEL_DATA_LOADED;
+  return PLUS_SUCCESS;
 }
 
 //----------------------------------------------------------------------------
@@ -517,6 +807,19 @@ std::string vtkPlusSequenceIOBase::GetPixelDataFilePath()
   return path;
 }
 
+//----------------------------------------------------------------------------
+std::string vtkPlusSequenceIOBase::GetOutputPixelDataFilePath()
+{
+  // Use the same path as the header but replace the filename
+  std::string headerFullPath = vtkPlusConfig::GetInstance()->GetOutputPath( this->FileName );
+  std::vector<std::string> pathElements;
+  vtksys::SystemTools::SplitPath( headerFullPath.c_str(), pathElements );
+  pathElements.erase( pathElements.end() - 1 );
+  std::string pixelDataFileNameOnly = vtksys::SystemTools::GetFilenameName( this->PixelDataFileName );
+  pathElements.push_back( pixelDataFileNameOnly );
+  return vtksys::SystemTools::JoinPath( pathElements );
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSequenceIOBase::FileOpen( FILE** stream, const char* filename, const char* flags )
 {
@@ -569,13 +872,12 @@ PlusStatus vtkPlusSequenceIOBase::AppendFile( const std::string& sourceFilename,
   }
   else
   {
-    const int BUFFER_SIZE = 32000;
+    const int BUFFER_SIZE = 1024 * 1024;
     char* buffer = new char[BUFFER_SIZE];
     size_t len = 0 ;
     while( ( len = fread( buffer, 1, BUFFER_SIZE, in ) ) > 0 )
     {
       fwrite( buffer, 1, len, out ) ;
-      memset( buffer, 0, BUFFER_SIZE );
     }
     fclose( in );
     fclose( out );
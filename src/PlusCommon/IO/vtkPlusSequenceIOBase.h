@@ -12,8 +12,12 @@
 #include "PlusVideoFrame.h"
 #include "vtkObject.h"
 
+#include <deque>
+#include <vector>
+
 class vtkPlusTrackedFrameList;
 class PlusTrackedFrame;
+class PlusRandomAccessPixelDataReader;
 
 #ifndef Z_BUFSIZE
 #  ifdef MAXSEG_64K
@@ -92,9 +96,24 @@ public:
   /*! Finalize the header */
   virtual PlusStatus FinalizeHeader() = 0;
 
-  /*! Returns a pointer to a single frame */
+  /*!
+    Returns a pointer to a single frame.
+    If lazy pixel data loading is enabled then pixel data of the frame is loaded from file at the first access.
+  */
   virtual PlusTrackedFrame* GetTrackedFrame( int frameNumber );
 
+  /*!
+    Release the pixel data of a frame that was loaded on demand (see LazyPixelDataLoading).
+    The pixel data is loaded again from the file when the frame is accessed next time.
+  */
+  virtual PlusStatus ReleaseFramePixelData( int frameNumber );
+
+  /*!
+    Returns false if the frame is loaded on demand and its pixel data is not in memory currently
+    (see LazyPixelDataLoading). Frames that have no valid image data in the file are reported as loaded.
+  */
+  bool IsFramePixelDataLoaded( int frameNumber );
+
   /*! Close the sequence */
   virtual PlusStatus Close();
 
@@ -136,6 +155,49 @@ public:
   /*! Flag to enable/disable writing of image data */
   vtkBooleanMacro( EnableImageDataWrite, bool );
 
+  /*!
+    If enabled then pixel data is always written directly into its final file, so closing the sequence
+    only requires finalizing the (small) header, regardless of the length of the recording.
+    Single-file formats (MHA, NRRD) store the pixel data right after the header, which is only complete when the
+    sequence is closed, therefore in streaming mode the pixel data of these formats is stored in a separate
+    file next to the header (referenced by the header, as in MHD and NHDR files).
+    Formats with separate header and pixel data files are always written this way.
+  */
+  vtkGetMacro( StreamingWrite, bool );
+  /*! Flag to enable/disable streaming write. See GetStreamingWrite. */
+  vtkSetMacro( StreamingWrite, bool );
+  /*! Flag to enable/disable streaming write. See GetStreamingWrite. */
+  vtkBooleanMacro( StreamingWrite, bool );
+
+  /*!
+    If enabled then Read() only reads the header and the per-frame fields, pixel data of a frame is only
+    read from the file when the frame is accessed by GetTrackedFrame(int). Uncompressed pixel data is memory-mapped,
+    compressed pixel data is indexed when the file is read, so that any frame can be decompressed without
+    decompressing all the preceding frames. The file must not be modified while frames are being loaded.
+
+    The frames of GetTrackedFrameList() are created without pixel data. The list loads the pixel data of a frame
+    when the frame is retrieved by vtkPlusTrackedFrameList::GetTrackedFrame(), so frames obtained that way always
+    have their pixel data. Frames obtained from the list without GetTrackedFrame() (iterators,
+    vtkPlusTrackedFrameList::GetTrackedFrameList()) may not have pixel data yet.
+    Loading stops when this object is deleted, Read() is called again or another tracked frame list is set.
+    After that, frames that have not been loaded remain without pixel data (their image is not valid), which
+    can be used to read only the frame fields of a sequence file.
+  */
+  vtkGetMacro( LazyPixelDataLoading, bool );
+  /*! Flag to enable/disable lazy pixel data loading. See GetLazyPixelDataLoading. */
+  vtkSetMacro( LazyPixelDataLoading, bool );
+  /*! Flag to enable/disable lazy pixel data loading. See GetLazyPixelDataLoading. */
+  vtkBooleanMacro( LazyPixelDataLoading, bool );
+
+  /*!
+    Maximum number of frames that have their pixel data in memory at the same time in lazy pixel data loading mode.
+    When more frames are loaded then the pixel data of the frame that was loaded first is released, therefore a frame
+    pointer that was retrieved earlier may lose its pixel data. 0 (default) means no limit.
+  */
+  vtkGetMacro( MaximumNumberOfLoadedFrames, int );
+  /*! Set the maximum number of frames loaded at the same time. See GetMaximumNumberOfLoadedFrames. */
+  vtkSetMacro( MaximumNumberOfLoadedFrames, int );
+
 protected:
   /*! Read all the fields in the image file header */
   virtual PlusStatus ReadImageHeader() = 0;
@@ -168,6 +230,12 @@ protected:
   /*! Get full path to the file for storing the pixel data */
   std::string GetPixelDataFilePath();
 
+  /*! Get full path of the pixel data file that is written next to the output header file */
+  std::string GetOutputPixelDataFilePath();
+
+  /*! Get the name of the separate pixel data file that is used in streaming mode for single-file formats */
+  virtual std::string GetStreamingPixelDataFileName() = 0;
+
   /*! Get the largest possible image size in the tracked frame list */
   virtual void GetMaximumImageDimensions( unsigned int maxFrameSize[3] );
 
@@ -192,6 +260,35 @@ protected:
   */
   virtual void CreateTrackedFrameIfNonExisting( unsigned int frameNumber );
 
+  /*!
+    Prepare on-demand loading of pixel data from the pixel data file (see LazyPixelDataLoading).
+    Creates all the tracked frames but does not allocate their pixel data.
+    \param frameSizeInBytes Size of one frame in the pixel data file
+    \param imageStatusFieldName Name of the per-frame field that stores the image status
+    \param compressedDataSize Size of the compressed pixel data, 0 if it lasts until the end of the file (only used if compression is enabled)
+  */
+  PlusStatus PrepareLazyPixelDataLoading( unsigned int frameSizeInBytes, const std::string& imageStatusFieldName, unsigned long long compressedDataSize );
+
+  /*! Read the pixel data of a frame from the pixel data file (see LazyPixelDataLoading) */
+  PlusStatus LoadFramePixelData( unsigned int frameNumber );
+
+  /*! Release the pixel data of a loaded frame, without updating the list of loaded frames */
+  void UnloadFramePixelData( unsigned int frameNumber );
+
+  /*! Stop loading pixel data on demand, frames that have not been loaded remain without pixel data */
+  void StopLazyPixelDataLoading();
+
+  /*! Get a frame of the tracked frame list without loading its pixel data */
+  PlusTrackedFrame* GetTrackedFrameWithoutLoading( unsigned int frameNumber );
+
+  /*! Called by the tracked frame list when a frame is retrieved, loads the pixel data of the frame if needed */
+  void OnTrackedFrameAccessed( unsigned int frameNumber );
+
+  /*! Called by the tracked frame list when frames are removed, to keep the frame positions in sync with the list */
+  void OnTrackedFramesRemoved( unsigned int frameNumberFrom, unsigned int frameNumberTo );
+
+  friend class vtkPlusTrackedFrameList;
+
 protected:
 #ifdef _WIN32
   typedef __int64 FilePositionOffsetType;
@@ -253,6 +350,43 @@ protected:
   std::string PixelDataFileName;
   /*! file handle for image output */
   FILE* OutputImageFileHandle;
+  /*! Enable writing of pixel data directly into its final file (see GetStreamingWrite) */
+  bool StreamingWrite;
+  /*!
+    True if pixel data is being written directly into its final file (TempImageFileName points to the final pixel data file).
+    While it is true the pixel data file name is not changed, even if the file name is changed.
+  */
+  bool PixelDataWrittenInPlace;
+
+  enum FramePixelDataStateType
+  {
+    FRAME_PIXEL_DATA_NOT_LOADED,
+    FRAME_PIXEL_DATA_LOADED,
+    FRAME_PIXEL_DATA_INVALID
+  };
+
+  struct FramePixelDataInfo
+  {
+    /*! Pixel data loading state of the frame (value of FramePixelDataStateType) */
+    char State;
+    /*! Index of the frame in the pixel data file */
+    unsigned int FileFrameIndex;
+  };
+
+  /*! Enable loading pixel data of each frame only when it is accessed (see GetLazyPixelDataLoading) */
+  bool LazyPixelDataLoading;
+  /*! Maximum number of frames that are loaded at the same time in lazy pixel data loading mode, 0 if there is no limit */
+  int MaximumNumberOfLoadedFrames;
+  /*! Provides access to the pixel data file in lazy pixel data loading mode, NULL otherwise */
+  PlusRandomAccessPixelDataReader* PixelDataReader;
+  /*! Loading state of each frame of the tracked frame list in lazy pixel data loading mode */
+  std::vector<FramePixelDataInfo> FramePixelData;
+  /*! Positions of the loaded frames in the tracked frame list, in the order they were loaded */
+  std::deque<unsigned int> LoadedFrames;
+  /*! Size of one frame in the pixel data file in lazy pixel data loading mode */
+  unsigned int FrameSizeInBytes;
+  /*! Buffer for pixel data that cannot be accessed directly in the pixel data file */
+  std::vector<unsigned char> FramePixelBuffer;
 
 protected:
   vtkPlusSequenceIOBase();
@@ -17,10 +17,75 @@ See License.txt for details.
 
 // STL includes
 #include <algorithm>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
+
+namespace
+{
+  //-------------------------------------------------------
+  /*! Process-wide table of transform names that have been assigned an id */
+  class PlusTransformNameRegistry
+  {
+  public:
+    static PlusTransformNameRegistry& GetInstance()
+    {
+      static PlusTransformNameRegistry instance;
+      return instance;
+    }
+
+    int GetId(const std::string& name)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      std::map<std::string, int>::iterator it = this->NameToId.find(name);
+      if (it != this->NameToId.end())
+      {
+        return it->second;
+      }
+      int id = static_cast<int>(this->IdToName.size());
+      this->IdToName.push_back(name);
+      this->NameToId[name] = id;
+      return id;
+    }
+
+    PlusStatus GetName(int id, std::string& name)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      if (id < 0 || id >= static_cast<int>(this->IdToName.size()))
+      {
+        return PLUS_FAIL;
+      }
+      name = this->IdToName[id];
+      return PLUS_SUCCESS;
+    }
+
+  private:
+    std::mutex Mutex;
+    std::map<std::string, int> NameToId;
+    std::vector<std::string> IdToName;
+  };
+
+  //-------------------------------------------------------
+  /*! Remove the Transform or TransformStatus postfix (case insensitive) from the end of a transform name */
+  std::string StripTransformPostfix(const std::string& name)
+  {
+    const std::string postfixes[2] = { "TransformStatus", "Transform" };
+    for (int i = 0; i < 2; ++i)
+    {
+      if (name.length() > postfixes[i].length()
+          && PlusCommon::IsEqualInsensitive(name.substr(name.length() - postfixes[i].length()), postfixes[i]))
+      {
+        return name.substr(0, name.length() - postfixes[i].length());
+      }
+    }
+    return name;
+  }
+}
 
 //-------------------------------------------------------
 PlusTransformName::PlusTransformName()
+  : m_Id(-1)
 {
 }
 
@@ -31,6 +96,7 @@ PlusTransformName::~PlusTransformName()
 
 //-------------------------------------------------------
 PlusTransformName::PlusTransformName(std::string aFrom, std::string aTo)
+  : m_Id(-1)
 {
   this->Capitalize(aFrom);
   this->m_From = aFrom;
@@ -41,10 +107,57 @@ PlusTransformName::PlusTransformName(std::string aFrom, std::string aTo)
 
 //-------------------------------------------------------
 PlusTransformName::PlusTransformName(const std::string& transformName)
+  : m_Id(-1)
 {
   this->SetTransformName(transformName.c_str());
 }
 
+//-------------------------------------------------------
+PlusTransformName::PlusTransformName(const PlusTransformName& transformName)
+  : m_From(transformName.m_From)
+  , m_To(transformName.m_To)
+  , m_Id(transformName.m_Id.load(std::memory_order_relaxed))
+{
+}
+
+//-------------------------------------------------------
+PlusTransformName& PlusTransformName::operator=(const PlusTransformName& transformName)
+{
+  this->m_From = transformName.m_From;
+  this->m_To = transformName.m_To;
+  this->m_Id.store(transformName.m_Id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  return *this;
+}
+
+//-------------------------------------------------------
+int PlusTransformName::GetId() const
+{
+  int id = this->m_Id.load(std::memory_order_relaxed);
+  if (id < 0 && this->IsValid())
+  {
+    id = PlusTransformName::GetTransformNameId(this->GetTransformName());
+    this->m_Id.store(id, std::memory_order_relaxed);
+  }
+  return id;
+}
+
+//-------------------------------------------------------
+int PlusTransformName::GetTransformNameId(const std::string& aTransformName)
+{
+  std::string name = StripTransformPostfix(aTransformName);
+  if (name.empty())
+  {
+    return -1;
+  }
+  return PlusTransformNameRegistry::GetInstance().GetId(name);
+}
+
+//-------------------------------------------------------
+PlusStatus PlusTransformName::GetTransformNameFromId(int id, std::string& aTransformName)
+{
+  return PlusTransformNameRegistry::GetInstance().GetName(id, aTransformName);
+}
+
 //-------------------------------------------------------
 bool PlusTransformName::IsValid() const
 {
@@ -84,6 +197,7 @@ PlusStatus PlusTransformName::SetTransformName(const std::string& aTransformName
 
   this->m_From.clear();
   this->m_To.clear();
+  this->m_Id.store(-1, std::memory_order_relaxed);
 
   size_t posTo = std::string::npos;
 
@@ -199,6 +313,7 @@ void PlusTransformName::Clear()
 {
   this->m_From = "";
   this->m_To = "";
+  this->m_Id.store(-1, std::memory_order_relaxed);
 }
 
 //----------------------------------------------------------------------------
@@ -23,6 +23,7 @@
 
 // STL includes
 #include <array>
+#include <atomic>
 #include <list>
 #include <locale>
 #include <sstream>
@@ -82,9 +83,12 @@ enum PlusImagingMode
 
 #define LOG_DEBUG(msg) \
   { \
-  std::ostringstream msgStream; \
-  msgStream << msg << std::ends; \
-  vtkPlusLogger::Instance()->LogMessage(vtkPlusLogger::LOG_LEVEL_DEBUG, msgStream.str().c_str(), __FILE__, __LINE__); \
+    if (vtkPlusLogger::Instance()->GetLogLevel()>=vtkPlusLogger::LOG_LEVEL_DEBUG) \
+    { \
+      std::ostringstream msgStream; \
+      msgStream << msg << std::ends; \
+      vtkPlusLogger::Instance()->LogMessage(vtkPlusLogger::LOG_LEVEL_DEBUG, msgStream.str().c_str(), __FILE__, __LINE__); \
+    } \
   }
 
 #define LOG_TRACE(msg) \
@@ -127,9 +131,12 @@ enum PlusImagingMode
 
 #define LOG_DEBUG_W(msg) \
   { \
-  std::wostringstream msgStream; \
-  msgStream << msg << std::ends; \
-  vtkPlusLogger::Instance()->LogMessage(vtkPlusLogger::LOG_LEVEL_DEBUG, msgStream.str(), __FILE__, __LINE__); \
+    if (vtkPlusLogger::Instance()->GetLogLevel()>=vtkPlusLogger::LOG_LEVEL_DEBUG) \
+    { \
+      std::wostringstream msgStream; \
+      msgStream << msg << std::ends; \
+      vtkPlusLogger::Instance()->LogMessage(vtkPlusLogger::LOG_LEVEL_DEBUG, msgStream.str(), __FILE__, __LINE__); \
+    } \
   }
 
 #define LOG_TRACE_W(msg) \
@@ -499,6 +506,8 @@ public:
   ~PlusTransformName();
   PlusTransformName(std::string aFrom, std::string aTo);
   PlusTransformName(const std::string& transformName);
+  PlusTransformName(const PlusTransformName& transformName);
+  PlusTransformName& operator=(const PlusTransformName& transformName);
 
   /*!
     Set 'From' and 'To' coordinate frame names from a combined transform name with the following format [FrameFrom]To[FrameTo].
@@ -524,6 +533,22 @@ public:
   /*! Check if the current transform name is valid */
   bool IsValid() const;
 
+  /*!
+    Return a small integer that uniquely identifies the transform name within the process.
+    Names that only differ in the Transform or TransformStatus postfix get the same id.
+    The id is computed on first use and cached, returns -1 if the transform name is not valid.
+  */
+  int GetId() const;
+
+  /*!
+    Return the id of a combined transform name ([From]To[To]), registering the name if it has not been seen before.
+    The Transform or TransformStatus postfix is ignored. Returns -1 if the name is empty.
+  */
+  static int GetTransformNameId(const std::string& aTransformName);
+
+  /*! Return the combined transform name (without postfix) that was registered with the given id */
+  static PlusStatus GetTransformNameFromId(int id, std::string& aTransformName);
+
   inline bool operator== (const PlusTransformName& in) const
   {
     return (in.m_From == m_From && in.m_To == m_To);
@@ -545,6 +570,7 @@ private:
   void Capitalize(std::string& aString);
   std::string m_From; /*! From coordinate frame name */
   std::string m_To; /*! To coordinate frame name */
+  mutable std::atomic<int> m_Id; /*! Cached transform name id, -1 if not yet computed */
 };
 
 
@@ -24,10 +24,131 @@ const std::string PlusTrackedFrame::TransformPostfix = "Transform";
 const std::string PlusTrackedFrame::TransformStatusPostfix = "TransformStatus";
 const int FLOATING_POINT_PRECISION = 16; // Number of digits used when writing transforms and timestamps
 
+namespace
+{
+  /*! First bytes of the binary tracked frame data. XML data always starts with '<' so the two can be distinguished. */
+  const char BINARY_DATA_SIGNATURE[4] = { 'P', 'T', 'F', 'B' };
+  /*! Binary data format version. New versions may only append data, so that older readers can still read the first part. */
+  const unsigned int BINARY_DATA_VERSION = 1;
+
+  const unsigned int BINARY_TRANSFORM_MATRIX_DEFINED = 0x01;
+  const unsigned int BINARY_TRANSFORM_STATUS_DEFINED = 0x02;
+
+  //----------------------------------------------------------------------------
+  // All values are stored in little endian byte order, independently from the platform
+  void AppendUInt(std::string& data, unsigned int value, int numberOfBytes)
+  {
+    for (int i = 0; i < numberOfBytes; ++i)
+    {
+      data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void AppendDouble(std::string& data, double value)
+  {
+    vtkTypeUInt64 bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+    {
+      data.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void AppendString(std::string& data, const std::string& value)
+  {
+    AppendUInt(data, static_cast<unsigned int>(value.size()), 4);
+    data.append(value);
+  }
+
+  //----------------------------------------------------------------------------
+  /*! Read values from binary tracked frame data. Each method returns false if there is not enough data left. */
+  class BinaryDataReader
+  {
+  public:
+    BinaryDataReader(const unsigned char* data, size_t dataSize)
+      : Data(data)
+      , Remaining(dataSize)
+    {
+    }
+
+    size_t GetRemainingSize() const { return this->Remaining; }
+
+    bool ReadUInt(unsigned int& value, int numberOfBytes)
+    {
+      if (this->Remaining < static_cast<size_t>(numberOfBytes))
+      {
+        return false;
+      }
+      value = 0;
+      for (int i = 0; i < numberOfBytes; ++i)
+      {
+        value |= static_cast<unsigned int>(this->Data[i]) << (8 * i);
+      }
+      this->Data += numberOfBytes;
+      this->Remaining -= numberOfBytes;
+      return true;
+    }
+
+    bool ReadDouble(double& value)
+    {
+      if (this->Remaining < 8)
+      {
+        return false;
+      }
+      vtkTypeUInt64 bits = 0;
+      for (int i = 0; i < 8; ++i)
+      {
+        bits |= static_cast<vtkTypeUInt64>(this->Data[i]) << (8 * i);
+      }
+      memcpy(&value, &bits, sizeof(value));
+      this->Data += 8;
+      this->Remaining -= 8;
+      return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+      unsigned int length = 0;
+      if (!this->ReadUInt(length, 4) || this->Remaining < length)
+      {
+        return false;
+      }
+      value.assign(reinterpret_cast<const char*>(this->Data), length);
+      this->Data += length;
+      this->Remaining -= length;
+      return true;
+    }
+
+  private:
+    const unsigned char* Data;
+    size_t Remaining;
+  };
+
+  //----------------------------------------------------------------------------
+  /*!
+    Parse the matrix elements of a transform field value. Elements that cannot be read keep the identity
+    matrix value and anything after the 16th element is ignored (same as the string field based implementation).
+  */
+  void ParseTransformString(const std::string& value, double transform[16])
+  {
+    const double identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    std::copy(identity, identity + 16, transform);
+    std::istringstream transformFieldValue(value);
+    double item = 0;
+    for (int i = 0; i < 16 && transformFieldValue >> item; ++i)
+    {
+      transform[i] = item;
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusTrackedFrame::PlusTrackedFrame()
 {
   this->Timestamp = 0;
+  this->SerializedFrameFieldsValid = false;
   this->FrameSize[0] = 0;
   this->FrameSize[1] = 0;
   this->FrameSize[2] = 1; // single-slice frame by default
@@ -44,6 +165,7 @@ PlusTrackedFrame::~PlusTrackedFrame()
 PlusTrackedFrame::PlusTrackedFrame(const PlusTrackedFrame& frame)
 {
   this->Timestamp = 0;
+  this->SerializedFrameFieldsValid = false;
   this->FrameSize[0] = 0;
   this->FrameSize[1] = 0;
   this->FrameSize[2] = 1; // single-slice frame by default
@@ -62,6 +184,8 @@ PlusTrackedFrame& PlusTrackedFrame::operator=(PlusTrackedFrame const& trackedFra
   }
 
   this->CustomFrameFields = trackedFrame.CustomFrameFields;
+  this->FrameTransforms = trackedFrame.FrameTransforms;
+  this->SerializedFrameFieldsValid = false;
   this->ImageData = trackedFrame.ImageData;
   this->Timestamp = trackedFrame.Timestamp;
   this->FrameSize[0] = trackedFrame.FrameSize[0];
@@ -114,7 +238,8 @@ PlusStatus PlusTrackedFrame::PrintToXML(vtkXMLDataElement* trackedFrame, const s
     trackedFrame->SetVectorAttribute("FrameSize", 3, frameSizeSigned);
   }
 
-  for (auto fieldIter = CustomFrameFields.begin(); fieldIter != CustomFrameFields.end(); ++fieldIter)
+  this->UpdateSerializedFrameFields();
+  for (auto fieldIter = this->SerializedFrameFields.begin(); fieldIter != this->SerializedFrameFields.end(); ++fieldIter)
   {
     // Only use requested transforms mechanism if the vector is not empty
     if (!requestedTransforms.empty() && (IsTransform(fieldIter->first) || IsTransformStatus(fieldIter->first)))
@@ -133,7 +258,8 @@ PlusStatus PlusTrackedFrame::PrintToXML(vtkXMLDataElement* trackedFrame, const s
       vtkSmartPointer<vtkXMLDataElement> customField = vtkSmartPointer<vtkXMLDataElement>::New();
       customField->SetName("CustomFrameField");
       customField->SetAttribute("Name", statusName.c_str());
-      customField->SetAttribute("Value", CustomFrameFields[statusName].c_str());
+      auto statusIter = this->SerializedFrameFields.find(statusName);
+      customField->SetAttribute("Value", statusIter != this->SerializedFrameFields.end() ? statusIter->second.c_str() : "");
       trackedFrame->AddNestedElement(customField);
     }
     vtkSmartPointer<vtkXMLDataElement> customField = vtkSmartPointer<vtkXMLDataElement>::New();
@@ -261,6 +387,212 @@ PlusStatus PlusTrackedFrame::SetTrackedFrameFromXmlData(const char* strXmlData)
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus PlusTrackedFrame::GetTrackedFrameInBinaryData(std::string& binaryData, const std::vector<PlusTransformName>& requestedTransforms)
+{
+  binaryData.clear();
+  binaryData.append(BINARY_DATA_SIGNATURE, sizeof(BINARY_DATA_SIGNATURE));
+  AppendUInt(binaryData, BINARY_DATA_VERSION, 2);
+  AppendDouble(binaryData, this->Timestamp);
+
+  AppendUInt(binaryData, static_cast<unsigned int>(this->CustomFrameFields.size()), 4);
+  for (FieldMapType::const_iterator fieldIter = this->CustomFrameFields.begin(); fieldIter != this->CustomFrameFields.end(); ++fieldIter)
+  {
+    AppendString(binaryData, fieldIter->first);
+    AppendString(binaryData, fieldIter->second);
+  }
+
+  // Same selection as in PrintToXML: if transforms are requested then only those are sent, always with a status
+  std::vector<const FrameTransformItem*> transforms;
+  for (FrameTransformListType::const_iterator it = this->FrameTransforms.begin(); it != this->FrameTransforms.end(); ++it)
+  {
+    if (!requestedTransforms.empty())
+    {
+      if (!it->MatrixDefined)
+      {
+        continue;
+      }
+      bool requested = false;
+      for (std::vector<PlusTransformName>::const_iterator requestedIt = requestedTransforms.begin(); requestedIt != requestedTransforms.end(); ++requestedIt)
+      {
+        if (requestedIt->GetId() == it->TransformNameId)
+        {
+          requested = true;
+          break;
+        }
+      }
+      if (!requested)
+      {
+        continue;
+      }
+    }
+    transforms.push_back(&(*it));
+  }
+
+  AppendUInt(binaryData, static_cast<unsigned int>(transforms.size()), 4);
+  for (std::vector<const FrameTransformItem*>::const_iterator it = transforms.begin(); it != transforms.end(); ++it)
+  {
+    std::string transformName;
+    if (PlusTransformName::GetTransformNameFromId((*it)->TransformNameId, transformName) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to get transform name from id " << (*it)->TransformNameId);
+      return PLUS_FAIL;
+    }
+    bool statusDefined = (*it)->StatusDefined || !requestedTransforms.empty();
+    unsigned int flags = ((*it)->MatrixDefined ? BINARY_TRANSFORM_MATRIX_DEFINED : 0) | (statusDefined ? BINARY_TRANSFORM_STATUS_DEFINED : 0);
+    TrackedFrameFieldStatus status = (*it)->StatusDefined ? (*it)->Status : FIELD_INVALID;
+
+    AppendString(binaryData, transformName);
+    AppendUInt(binaryData, flags, 1);
+    AppendUInt(binaryData, (status == FIELD_OK ? 0 : 1), 1);
+    if ((*it)->MatrixDefined)
+    {
+      for (int i = 0; i < 16; ++i)
+      {
+        AppendDouble(binaryData, (*it)->Matrix[i]);
+      }
+    }
+  }
+
+  AppendUInt(binaryData, (this->FiducialPointsCoordinatePx != NULL ? 1 : 0), 1);
+  if (this->FiducialPointsCoordinatePx != NULL)
+  {
+    AppendUInt(binaryData, static_cast<unsigned int>(this->FiducialPointsCoordinatePx->GetNumberOfPoints()), 4);
+    for (vtkIdType i = 0; i < this->FiducialPointsCoordinatePx->GetNumberOfPoints(); i++)
+    {
+      double point[3] = {0};
+      this->FiducialPointsCoordinatePx->GetPoint(i, point);
+      AppendDouble(binaryData, point[0]);
+      AppendDouble(binaryData, point[1]);
+      AppendDouble(binaryData, point[2]);
+    }
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusTrackedFrame::SetTrackedFrameFromBinaryData(const char* binaryData, size_t binaryDataSize)
+{
+  if (!PlusTrackedFrame::IsBinaryData(binaryData, binaryDataSize))
+  {
+    LOG_ERROR("Failed to set TrackedFrame from binary data - signature is not found!");
+    return PLUS_FAIL;
+  }
+
+  BinaryDataReader reader(reinterpret_cast<const unsigned char*>(binaryData) + sizeof(BINARY_DATA_SIGNATURE), binaryDataSize - sizeof(BINARY_DATA_SIGNATURE));
+  unsigned int version = 0;
+  if (!reader.ReadUInt(version, 2) || version < 1)
+  {
+    LOG_ERROR("Failed to set TrackedFrame from binary data - unsupported version: " << version);
+    return PLUS_FAIL;
+  }
+
+  double timestamp = 0;
+  unsigned int numberOfFields = 0;
+  if (!reader.ReadDouble(timestamp) || !reader.ReadUInt(numberOfFields, 4))
+  {
+    LOG_ERROR("Failed to set TrackedFrame from binary data - data is truncated!");
+    return PLUS_FAIL;
+  }
+  for (unsigned int fieldIndex = 0; fieldIndex < numberOfFields; ++fieldIndex)
+  {
+    std::string fieldName;
+    std::string fieldValue;
+    if (!reader.ReadString(fieldName) || !reader.ReadString(fieldValue))
+    {
+      LOG_ERROR("Failed to set TrackedFrame from binary data - custom frame fields are truncated!");
+      return PLUS_FAIL;
+    }
+    this->SetCustomFrameField(fieldName, fieldValue);
+  }
+  this->Timestamp = timestamp;
+  this->SerializedFrameFieldsValid = false;
+
+  unsigned int numberOfTransforms = 0;
+  if (!reader.ReadUInt(numberOfTransforms, 4))
+  {
+    LOG_ERROR("Failed to set TrackedFrame from binary data - data is truncated!");
+    return PLUS_FAIL;
+  }
+  for (unsigned int transformIndex = 0; transformIndex < numberOfTransforms; ++transformIndex)
+  {
+    std::string transformName;
+    unsigned int flags = 0;
+    unsigned int status = 0;
+    if (!reader.ReadString(transformName) || !reader.ReadUInt(flags, 1) || !reader.ReadUInt(status, 1))
+    {
+      LOG_ERROR("Failed to set TrackedFrame from binary data - frame transforms are truncated!");
+      return PLUS_FAIL;
+    }
+    int transformNameId = PlusTransformName::GetTransformNameId(transformName);
+    if (transformNameId < 0)
+    {
+      LOG_ERROR("Failed to set TrackedFrame from binary data - invalid transform name: " << transformName);
+      return PLUS_FAIL;
+    }
+    FrameTransformItem* item = this->FindOrAddFrameTransform(transformNameId);
+    if (flags & BINARY_TRANSFORM_MATRIX_DEFINED)
+    {
+      for (int i = 0; i < 16; ++i)
+      {
+        if (!reader.ReadDouble(item->Matrix[i]))
+        {
+          LOG_ERROR("Failed to set TrackedFrame from binary data - transform " << transformName << " is truncated!");
+          return PLUS_FAIL;
+        }
+      }
+      item->MatrixDefined = true;
+      item->MatrixString.clear();
+    }
+    if (flags & BINARY_TRANSFORM_STATUS_DEFINED)
+    {
+      item->Status = (status == 0 ? FIELD_OK : FIELD_INVALID);
+      item->StatusDefined = true;
+      item->StatusString.clear();
+    }
+  }
+
+  unsigned int segmentationDefined = 0;
+  if (!reader.ReadUInt(segmentationDefined, 1))
+  {
+    LOG_ERROR("Failed to set TrackedFrame from binary data - data is truncated!");
+    return PLUS_FAIL;
+  }
+  if (segmentationDefined)
+  {
+    unsigned int numberOfPoints = 0;
+    if (!reader.ReadUInt(numberOfPoints, 4) || reader.GetRemainingSize() / (3 * 8) < numberOfPoints)
+    {
+      LOG_ERROR("Failed to set TrackedFrame from binary data - segmented points are truncated!");
+      return PLUS_FAIL;
+    }
+    vtkSmartPointer<vtkPoints> fiducialPoints = vtkSmartPointer<vtkPoints>::New();
+    fiducialPoints->SetNumberOfPoints(numberOfPoints);
+    for (unsigned int i = 0; i < numberOfPoints; ++i)
+    {
+      double point[3] = {0};
+      reader.ReadDouble(point[0]);
+      reader.ReadDouble(point[1]);
+      reader.ReadDouble(point[2]);
+      fiducialPoints->SetPoint(i, point);
+    }
+    this->SetFiducialPointsCoordinatePx(fiducialPoints);
+  }
+
+  // Data appended by later versions of the format is ignored
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool PlusTrackedFrame::IsBinaryData(const char* data, size_t dataSize)
+{
+  return data != NULL
+         && dataSize >= sizeof(BINARY_DATA_SIGNATURE)
+         && memcmp(data, BINARY_DATA_SIGNATURE, sizeof(BINARY_DATA_SIGNATURE)) == 0;
+}
+
 //----------------------------------------------------------------------------
 unsigned int* PlusTrackedFrame::GetFrameSize()
 {
@@ -286,6 +618,15 @@ void PlusTrackedFrame::SetImageData(const PlusVideoFrame& value)
   this->ImageData.GetFrameSize(this->FrameSize);
 }
 
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::ShallowCopyImageData(const PlusVideoFrame& value)
+{
+  this->ImageData.ShallowCopy(value);
+
+  // Update our cached frame size
+  this->ImageData.GetFrameSize(this->FrameSize);
+}
+
 //----------------------------------------------------------------------------
 void PlusTrackedFrame::SetTimestamp(double value)
 {
@@ -293,6 +634,7 @@ void PlusTrackedFrame::SetTimestamp(double value)
   std::ostringstream strTimestamp;
   strTimestamp << std::setprecision(FLOATING_POINT_PRECISION) << this->Timestamp;
   this->CustomFrameFields["Timestamp"] = strTimestamp.str();
+  this->SerializedFrameFieldsValid = false;
 }
 
 //----------------------------------------------------------------------------
@@ -353,6 +695,29 @@ void PlusTrackedFrame::SetCustomFrameField(std::string name, std::string value)
     }
   }
 
+  this->SerializedFrameFieldsValid = false;
+
+  bool isStatusField = false;
+  int transformNameId = GetFrameTransformFieldId(name, isStatusField);
+  if (transformNameId >= 0)
+  {
+    // The value is kept as is, so that the field is written back unchanged
+    FrameTransformItem* item = this->FindOrAddFrameTransform(transformNameId);
+    if (isStatusField)
+    {
+      item->Status = PlusTrackedFrame::ConvertFieldStatusFromString(value.c_str());
+      item->StatusDefined = true;
+      item->StatusString = value;
+    }
+    else
+    {
+      ParseTransformString(value, item->Matrix);
+      item->MatrixDefined = true;
+      item->MatrixString = value;
+    }
+    return;
+  }
+
   this->CustomFrameFields[name] = value;
 }
 
@@ -365,6 +730,19 @@ const char* PlusTrackedFrame::GetCustomFrameField(const char* fieldName)
     return NULL;
   }
 
+  const std::string* transformFieldString = GetFrameTransformFieldString(this->FrameTransforms, fieldName);
+  if (transformFieldString != NULL)
+  {
+    // The value is stored in a map node that is only modified when the value changes,
+    // so the returned pointer remains valid until the field is modified
+    std::string& fieldValue = this->FrameTransformFieldValues[fieldName];
+    if (fieldValue != *transformFieldString)
+    {
+      fieldValue = *transformFieldString;
+    }
+    return fieldValue.c_str();
+  }
+
   FieldMapType::iterator fieldIterator;
   fieldIterator = this->CustomFrameFields.find(fieldName);
   if (fieldIterator != this->CustomFrameFields.end())
@@ -389,10 +767,34 @@ PlusStatus PlusTrackedFrame::DeleteCustomFrameField(const char* fieldName)
     return PLUS_FAIL;
   }
 
+  bool isStatusField = false;
+  int transformNameId = GetFrameTransformFieldId(fieldName, isStatusField);
+  if (transformNameId >= 0)
+  {
+    FrameTransformItem* item = this->FindFrameTransform(transformNameId);
+    if (item != NULL && isStatusField && item->StatusDefined)
+    {
+      item->StatusDefined = false;
+      item->StatusString.clear();
+      if (!item->MatrixDefined)
+      {
+        this->FrameTransforms.erase(this->FrameTransforms.begin() + (item - &this->FrameTransforms[0]));
+      }
+      this->SerializedFrameFieldsValid = false;
+      return PLUS_SUCCESS;
+    }
+    if (item != NULL && !isStatusField && item->MatrixDefined)
+    {
+      this->DeleteFrameTransformMatrix(item);
+      return PLUS_SUCCESS;
+    }
+  }
+
   FieldMapType::iterator field = this->CustomFrameFields.find(fieldName);
   if (field != this->CustomFrameFields.end())
   {
     this->CustomFrameFields.erase(field);
+    this->SerializedFrameFieldsValid = false;
     return PLUS_SUCCESS;
   }
   LOG_DEBUG("Failed to delete custom frame field - could find field " << fieldName);
@@ -403,18 +805,8 @@ PlusStatus PlusTrackedFrame::DeleteCustomFrameField(const char* fieldName)
 //----------------------------------------------------------------------------
 bool PlusTrackedFrame::IsCustomFrameTransformNameDefined(const PlusTransformName& transformName)
 {
-  std::string toolTransformName;
-  if (transformName.GetTransformName(toolTransformName) != PLUS_SUCCESS)
-  {
-    return false;
-  }
-  // Append Transform to the end of the transform name
-  if (!IsTransform(toolTransformName))
-  {
-    toolTransformName.append(TransformPostfix);
-  }
-
-  return this->IsCustomFrameFieldDefined(toolTransformName.c_str());
+  FrameTransformItem* item = this->FindFrameTransform(transformName.GetId());
+  return (item != NULL && item->MatrixDefined);
 }
 
 //----------------------------------------------------------------------------
@@ -426,6 +818,17 @@ bool PlusTrackedFrame::IsCustomFrameFieldDefined(const char* fieldName)
     return false;
   }
 
+  bool isStatusField = false;
+  int transformNameId = GetFrameTransformFieldId(fieldName, isStatusField);
+  if (transformNameId >= 0)
+  {
+    FrameTransformItem* item = this->FindFrameTransform(transformNameId);
+    if (item != NULL && (isStatusField ? item->StatusDefined : item->MatrixDefined))
+    {
+      return true;
+    }
+  }
+
   FieldMapType::iterator fieldIterator;
   fieldIterator = this->CustomFrameFields.find(fieldName);
   if (fieldIterator != this->CustomFrameFields.end())
@@ -440,34 +843,21 @@ bool PlusTrackedFrame::IsCustomFrameFieldDefined(const char* fieldName)
 //----------------------------------------------------------------------------
 PlusStatus PlusTrackedFrame::GetCustomFrameTransform(const PlusTransformName& frameTransformName, double transform[16])
 {
-  std::string transformName;
-  if (frameTransformName.GetTransformName(transformName) != PLUS_SUCCESS)
+  int transformNameId = frameTransformName.GetId();
+  if (transformNameId < 0)
   {
     LOG_ERROR("Unable to get custom transform, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append Transform to the end of the transform name
-  if (!IsTransform(transformName))
+  FrameTransformItem* item = this->FindFrameTransform(transformNameId);
+  if (item == NULL || !item->MatrixDefined)
   {
-    transformName.append(TransformPostfix);
-  }
-
-  const char* frameTransformStr = GetCustomFrameField(transformName.c_str());
-  if (frameTransformStr == NULL)
-  {
-    LOG_ERROR("Unable to get custom transform from name: " << transformName);
+    LOG_ERROR("Unable to get custom transform from name: " << frameTransformName << TransformPostfix);
     return PLUS_FAIL;
   }
 
-  // Find default frame transform
-  std::istringstream transformFieldValue(frameTransformStr);
-  double item;
-  int i = 0;
-  while (transformFieldValue >> item && i < 16)
-  {
-    transform[i++] = item;
-  }
+  std::copy(item->Matrix, item->Matrix + 16, transform);
   return PLUS_SUCCESS;
 }
 
@@ -485,31 +875,21 @@ PlusStatus PlusTrackedFrame::GetCustomFrameTransform(const PlusTransformName& fr
 PlusStatus PlusTrackedFrame::GetCustomFrameTransformStatus(const PlusTransformName& frameTransformName, TrackedFrameFieldStatus& status)
 {
   status = FIELD_INVALID;
-  std::string transformStatusName;
-  if (frameTransformName.GetTransformName(transformStatusName) != PLUS_SUCCESS)
+  int transformNameId = frameTransformName.GetId();
+  if (transformNameId < 0)
   {
     LOG_ERROR("Unable to get custom transform status, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append TransformStatus to the end of the transform name
-  if (IsTransform(transformStatusName))
+  FrameTransformItem* item = this->FindFrameTransform(transformNameId);
+  if (item == NULL || !item->StatusDefined)
   {
-    transformStatusName.append("Status");
-  }
-  else if (!IsTransformStatus(transformStatusName))
-  {
-    transformStatusName.append(TransformStatusPostfix);
-  }
-
-  const char* strStatus = this->GetCustomFrameField(transformStatusName.c_str());
-  if (strStatus == NULL)
-  {
-    LOG_ERROR("Unable to get custom transform status from name: " << transformStatusName);
+    LOG_ERROR("Unable to get custom transform status from name: " << frameTransformName << TransformStatusPostfix);
     return PLUS_FAIL;
   }
 
-  status = PlusTrackedFrame::ConvertFieldStatusFromString(strStatus);
+  status = item->Status;
 
   return PLUS_SUCCESS;
 }
@@ -517,26 +897,17 @@ PlusStatus PlusTrackedFrame::GetCustomFrameTransformStatus(const PlusTransformNa
 //----------------------------------------------------------------------------
 PlusStatus PlusTrackedFrame::SetCustomFrameTransformStatus(const PlusTransformName& frameTransformName, TrackedFrameFieldStatus status)
 {
-  std::string transformStatusName;
-  if (frameTransformName.GetTransformName(transformStatusName) != PLUS_SUCCESS)
+  int transformNameId = frameTransformName.GetId();
+  if (transformNameId < 0)
   {
     LOG_ERROR("Unable to set custom transform status, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append TransformStatus to the end of the transform name
-  if (IsTransform(transformStatusName))
-  {
-    transformStatusName.append("Status");
-  }
-  else if (!IsTransformStatus(transformStatusName))
-  {
-    transformStatusName.append(TransformStatusPostfix);
-  }
-
-  std::string strStatus = PlusTrackedFrame::ConvertFieldStatusToString(status);
-
-  this->SetCustomFrameField(transformStatusName, strStatus);
+  FrameTransformItem* item = this->FindOrAddFrameTransform(transformNameId);
+  item->Status = status;
+  item->StatusDefined = true;
+  item->StatusString.clear();
 
   return PLUS_SUCCESS;
 }
@@ -544,26 +915,17 @@ PlusStatus PlusTrackedFrame::SetCustomFrameTransformStatus(const PlusTransformNa
 //----------------------------------------------------------------------------
 PlusStatus PlusTrackedFrame::SetCustomFrameTransform(const PlusTransformName& frameTransformName, double transform[16])
 {
-  std::ostringstream strTransform;
-  for (int i = 0; i < 16; ++i)
+  int transformNameId = frameTransformName.GetId();
+  if (transformNameId < 0)
   {
-    strTransform << std::setprecision(FLOATING_POINT_PRECISION) << transform[ i ] << " ";
-  }
-
-  std::string transformName;
-  if (frameTransformName.GetTransformName(transformName) != PLUS_SUCCESS)
-  {
-    LOG_ERROR("Unable to get custom transform, transform name is wrong!");
+    LOG_ERROR("Unable to set custom transform, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append Transform to the end of the transform name
-  if (!IsTransform(transformName))
-  {
-    transformName.append(TransformPostfix);
-  }
-
-  SetCustomFrameField(transformName, strTransform.str());
+  FrameTransformItem* item = this->FindOrAddFrameTransform(transformNameId);
+  std::copy(transform, transform + 16, item->Matrix);
+  item->MatrixDefined = true;
+  item->MatrixString.clear();
 
   return PLUS_SUCCESS;
 }
@@ -661,7 +1023,8 @@ PlusStatus PlusTrackedFrame::WriteToFile(const std::string& filename, vtkMatrix4
 void PlusTrackedFrame::GetCustomFrameFieldNameList(std::vector<std::string>& fieldNames)
 {
   fieldNames.clear();
-  for (FieldMapType::const_iterator it = this->CustomFrameFields.begin(); it != this->CustomFrameFields.end(); it++)
+  this->UpdateSerializedFrameFields();
+  for (FieldMapType::const_iterator it = this->SerializedFrameFields.begin(); it != this->SerializedFrameFields.end(); it++)
   {
     fieldNames.push_back(it->first);
   }
@@ -671,15 +1034,186 @@ void PlusTrackedFrame::GetCustomFrameFieldNameList(std::vector<std::string>& fie
 void PlusTrackedFrame::GetCustomFrameTransformNameList(std::vector<PlusTransformName>& transformNames)
 {
   transformNames.clear();
-  for (FieldMapType::const_iterator it = this->CustomFrameFields.begin(); it != this->CustomFrameFields.end(); it++)
+  for (FrameTransformListType::const_iterator it = this->FrameTransforms.begin(); it != this->FrameTransforms.end(); ++it)
   {
-    if (IsTransform(it->first))
+    if (!it->MatrixDefined)
+    {
+      continue;
+    }
+    std::string transformName;
+    if (PlusTransformName::GetTransformNameFromId(it->TransformNameId, transformName) != PLUS_SUCCESS)
     {
-      PlusTransformName trName;
-      trName.SetTransformName(it->first.substr(0, it->first.length() - TransformPostfix.length()).c_str());
-      transformNames.push_back(trName);
+      LOG_ERROR("Unable to get transform name from id " << it->TransformNameId);
+      continue;
     }
+    PlusTransformName trName;
+    trName.SetTransformName(transformName);
+    transformNames.push_back(trName);
+  }
+}
+
+//----------------------------------------------------------------------------
+const PlusTrackedFrame::FieldMapType& PlusTrackedFrame::GetCustomFields()
+{
+  this->UpdateSerializedFrameFields();
+  return this->SerializedFrameFields;
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::SetFrameTransformItems(const FrameTransformListType& frameTransforms)
+{
+  for (FrameTransformListType::const_iterator it = frameTransforms.begin(); it != frameTransforms.end(); ++it)
+  {
+    FrameTransformItem* item = this->FindOrAddFrameTransform(it->TransformNameId);
+    if (it->MatrixDefined)
+    {
+      std::copy(it->Matrix, it->Matrix + 16, item->Matrix);
+      item->MatrixDefined = true;
+      item->MatrixString = it->MatrixString;
+    }
+    if (it->StatusDefined)
+    {
+      item->Status = it->Status;
+      item->StatusDefined = true;
+      item->StatusString = it->StatusString;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::AddFrameTransformFields(const FrameTransformListType& frameTransforms, FieldMapType& fields)
+{
+  for (FrameTransformListType::const_iterator it = frameTransforms.begin(); it != frameTransforms.end(); ++it)
+  {
+    std::string transformName;
+    if (PlusTransformName::GetTransformNameFromId(it->TransformNameId, transformName) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to get transform name from id " << it->TransformNameId);
+      continue;
+    }
+    if (it->MatrixDefined)
+    {
+      fields[transformName + TransformPostfix] = (it->MatrixString.empty() ? ConvertTransformToString(it->Matrix) : it->MatrixString);
+    }
+    if (it->StatusDefined)
+    {
+      fields[transformName + TransformStatusPostfix] = (it->StatusString.empty() ? PlusTrackedFrame::ConvertFieldStatusToString(it->Status) : it->StatusString);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+const std::string* PlusTrackedFrame::GetFrameTransformFieldString(FrameTransformListType& frameTransforms, const std::string& fieldName)
+{
+  bool isStatusField = false;
+  int transformNameId = GetFrameTransformFieldId(fieldName, isStatusField);
+  if (transformNameId < 0)
+  {
+    return NULL;
+  }
+  for (FrameTransformListType::iterator it = frameTransforms.begin(); it != frameTransforms.end(); ++it)
+  {
+    if (it->TransformNameId != transformNameId)
+    {
+      continue;
+    }
+    if (!(isStatusField ? it->StatusDefined : it->MatrixDefined))
+    {
+      return NULL;
+    }
+    // Only the requested field is converted, the result is kept until the transform is modified
+    std::string& itemString = (isStatusField ? it->StatusString : it->MatrixString);
+    if (itemString.empty())
+    {
+      itemString = (isStatusField ? ConvertFieldStatusToString(it->Status) : ConvertTransformToString(it->Matrix));
+    }
+    return &itemString;
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusTrackedFrame::FrameTransformItem* PlusTrackedFrame::FindFrameTransform(int transformNameId)
+{
+  if (transformNameId < 0)
+  {
+    return NULL;
+  }
+  for (FrameTransformListType::iterator it = this->FrameTransforms.begin(); it != this->FrameTransforms.end(); ++it)
+  {
+    if (it->TransformNameId == transformNameId)
+    {
+      return &(*it);
+    }
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusTrackedFrame::FrameTransformItem* PlusTrackedFrame::FindOrAddFrameTransform(int transformNameId)
+{
+  // The caller modifies the item, so the string representation has to be updated
+  this->SerializedFrameFieldsValid = false;
+  FrameTransformItem* item = this->FindFrameTransform(transformNameId);
+  if (item != NULL)
+  {
+    return item;
+  }
+  FrameTransformItem newItem;
+  newItem.TransformNameId = transformNameId;
+  const double identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+  std::copy(identity, identity + 16, newItem.Matrix);
+  newItem.MatrixDefined = false;
+  newItem.Status = FIELD_INVALID;
+  newItem.StatusDefined = false;
+  this->FrameTransforms.push_back(newItem);
+  return &this->FrameTransforms.back();
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::DeleteFrameTransformMatrix(FrameTransformItem* item)
+{
+  item->MatrixDefined = false;
+  item->MatrixString.clear();
+  if (!item->StatusDefined)
+  {
+    this->FrameTransforms.erase(this->FrameTransforms.begin() + (item - &this->FrameTransforms[0]));
+  }
+  this->SerializedFrameFieldsValid = false;
+}
+
+//----------------------------------------------------------------------------
+int PlusTrackedFrame::GetFrameTransformFieldId(const std::string& fieldName, bool& isStatusField)
+{
+  isStatusField = IsTransformStatus(fieldName);
+  if (!isStatusField && !IsTransform(fieldName))
+  {
+    return -1;
+  }
+  return PlusTransformName::GetTransformNameId(fieldName);
+}
+
+//----------------------------------------------------------------------------
+std::string PlusTrackedFrame::ConvertTransformToString(const double transform[16])
+{
+  std::ostringstream strTransform;
+  for (int i = 0; i < 16; ++i)
+  {
+    strTransform << std::setprecision(FLOATING_POINT_PRECISION) << transform[ i ] << " ";
+  }
+  return strTransform.str();
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::UpdateSerializedFrameFields()
+{
+  if (this->SerializedFrameFieldsValid)
+  {
+    return;
   }
+  this->SerializedFrameFields = this->CustomFrameFields;
+  AddFrameTransformFields(this->FrameTransforms, this->SerializedFrameFields);
+  this->SerializedFrameFieldsValid = true;
 }
 
 //----------------------------------------------------------------------------
@@ -30,6 +30,13 @@ enum TrackedFrameFieldStatus
 /*!
   \class TrackedFrame
   \brief Stores tracked frame (image + pose information)
+
+  Transforms and transform statuses are stored in binary form, indexed by the transform name id
+  (see PlusTransformName::GetId). They are converted to string custom frame fields only when
+  the string representation is requested (GetCustomFields, GetCustomFrameField, PrintToXML, etc.).
+  The string representation is cached until the frame fields are modified.
+  If a transform or transform status is set from a string then the string is kept and returned unchanged.
+
   \ingroup PlusLibCommon
 */
 class vtkPlusCommonExport PlusTrackedFrame
@@ -52,8 +59,16 @@ public:
   /*! Set image data */
   void SetImageData(const PlusVideoFrame& value);
 
+  /*!
+    Set image data without copying the pixels. The tracked frame shares the image with the input frame
+    (see PlusVideoFrame::ShallowCopy), therefore the pixels must not be modified directly.
+    Copying the tracked frame (copy constructor, operator=) still creates a full copy of the image.
+  */
+  void ShallowCopyImageData(const PlusVideoFrame& value);
+
   /*! Get image data */
   PlusVideoFrame* GetImageData() { return &(this->ImageData); };
+  const PlusVideoFrame* GetImageData() const { return &(this->ImageData); };
 
   /*! Set timestamp */
   void SetTimestamp(double value);
@@ -61,10 +76,16 @@ public:
   /*! Get timestamp */
   double GetTimestamp() { return this->Timestamp; };
 
-  /*! Set custom frame field */
+  /*!
+    Set custom frame field.
+    Transform fields are parsed into a binary matrix (up to 16 elements are read, missing elements are taken from the identity matrix).
+  */
   void SetCustomFrameField(std::string name, std::string value);
 
-  /*! Get custom frame field value */
+  /*!
+    Get custom frame field value.
+    The returned string is valid until the field is modified or deleted.
+  */
   const char* GetCustomFrameField(const char* fieldName);
   const char* GetCustomFrameField(const std::string& fieldName);
 
@@ -142,14 +163,64 @@ public:
   /*! Deserialize TrackedFrame human readable data from xml data string */
   PlusStatus SetTrackedFrameFromXmlData(const std::string& xmlData);
 
+  /*!
+    Serialize tracked frame custom fields, transforms, transform statuses and segmentation data (not the image)
+    to a compact binary block. Transforms are stored as raw doubles, so no string conversion is needed.
+    If requestedTransforms is empty, all frame transforms are stored.
+  */
+  PlusStatus GetTrackedFrameInBinaryData(std::string& binaryData, const std::vector<PlusTransformName>& requestedTransforms);
+
+  /*! Deserialize tracked frame data from a binary block created by GetTrackedFrameInBinaryData */
+  PlusStatus SetTrackedFrameFromBinaryData(const char* binaryData, size_t binaryDataSize);
+
+  /*! Returns true if the data starts with the signature of a binary block created by GetTrackedFrameInBinaryData */
+  static bool IsBinaryData(const char* data, size_t dataSize);
+
   /*! Convert from field status string to field status enum */
   static TrackedFrameFieldStatus ConvertFieldStatusFromString(const char* statusStr);
 
   /*! Convert from field status enum to field status string */
   static std::string ConvertFieldStatusToString(TrackedFrameFieldStatus status);
 
-  /*! Return all custom fields in a map */
-  const FieldMapType& GetCustomFields() { return this->CustomFrameFields; }
+  /*! Return all custom fields in a map, including the frame transforms and transform statuses converted to string */
+  const FieldMapType& GetCustomFields();
+
+public:
+  /*! Binary representation of a frame transform and its status */
+  struct FrameTransformItem
+  {
+    int TransformNameId;
+    double Matrix[16];
+    bool MatrixDefined;
+    TrackedFrameFieldStatus Status;
+    bool StatusDefined;
+    /*! String representation of the matrix, empty if it has not been set from or converted to a string yet */
+    std::string MatrixString;
+    /*! String representation of the status, empty if it has not been set from or converted to a string yet */
+    std::string StatusString;
+  };
+  typedef std::vector<FrameTransformItem> FrameTransformListType;
+
+  /*!
+    Return custom fields that are stored as strings, i.e., all custom fields except the frame transforms and transform statuses.
+    Together with GetFrameTransformItems it allows copying all fields of the frame without converting transforms to strings.
+  */
+  const FieldMapType& GetStringCustomFields() const { return this->CustomFrameFields; }
+
+  /*! Return the frame transforms and transform statuses in binary form */
+  const FrameTransformListType& GetFrameTransformItems() const { return this->FrameTransforms; }
+
+  /*! Set frame transforms and transform statuses from binary form. Transforms that are not in the list are kept. */
+  void SetFrameTransformItems(const FrameTransformListType& frameTransforms);
+
+  /*! Add the frame transforms and transform statuses to a custom field map, converted to string */
+  static void AddFrameTransformFields(const FrameTransformListType& frameTransforms, FieldMapType& fields);
+
+  /*!
+    Return the string value of a single transform or transform status field, without converting the other transforms.
+    Returns NULL if the field is not a transform or transform status field or it is not defined in the list.
+  */
+  static const std::string* GetFrameTransformFieldString(FrameTransformListType& frameTransforms, const std::string& fieldName);
 
   /*! Returns true if the input string ends with "Transform", else false */
   static bool IsTransform(std::string str);
@@ -164,12 +235,47 @@ public:
     return (Timestamp == data.Timestamp);
   }
 
+protected:
+  /*! Return the stored item of a transform, NULL if the transform is not defined in the frame */
+  FrameTransformItem* FindFrameTransform(int transformNameId);
+
+  /*! Return the stored item of a transform, a new item is added if the transform is not defined in the frame yet */
+  FrameTransformItem* FindOrAddFrameTransform(int transformNameId);
+
+  /*!
+    Return the transform name id if the field name is a transform or transform status field name, otherwise -1.
+    isStatusField is set to true if the field is a transform status field.
+  */
+  static int GetFrameTransformFieldId(const std::string& fieldName, bool& isStatusField);
+
+  /*! Remove the matrix of a transform item, the item is removed if the status is not defined either */
+  void DeleteFrameTransformMatrix(FrameTransformItem* item);
+
+  /*! Convert transform matrix elements to a string custom field value */
+  static std::string ConvertTransformToString(const double transform[16]);
+
+  /*! Update SerializedFrameFields from the custom fields and binary frame transforms */
+  void UpdateSerializedFrameFields();
+
 protected:
   PlusVideoFrame ImageData;
   double Timestamp;
 
+  /*! Custom fields that are not transforms or transform statuses */
   FieldMapType CustomFrameFields;
 
+  /*! Frame transforms and statuses, stored in a contiguous array (a frame typically contains only a few transforms) */
+  FrameTransformListType FrameTransforms;
+
+  /*! All custom fields with transforms and transform statuses converted to strings, updated on demand */
+  FieldMapType SerializedFrameFields;
+
+  /*! True if SerializedFrameFields is up-to-date */
+  bool SerializedFrameFieldsValid;
+
+  /*! Transform and transform status field values returned by GetCustomFrameField, indexed by the requested field name */
+  FieldMapType FrameTransformFieldValues;
+
   unsigned int FrameSize[3];
 
   /*! Stores segmented fiducial point pixel coordinates */
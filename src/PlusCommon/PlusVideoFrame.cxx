@@ -341,6 +341,7 @@ PlusVideoFrame::PlusVideoFrame()
   : Image(NULL)
   , ImageType(US_IMG_BRIGHTNESS)
   , ImageOrientation(US_IMG_ORIENT_MF)
+  , ImageIsView(false)
 {
 }
 
@@ -349,6 +350,7 @@ PlusVideoFrame::PlusVideoFrame(const PlusVideoFrame& videoItem)
   : Image(NULL)
   , ImageType(US_IMG_BRIGHTNESS)
   , ImageOrientation(US_IMG_ORIENT_MF)
+  , ImageIsView(false)
 {
   *this = videoItem;
 }
@@ -356,7 +358,7 @@ PlusVideoFrame::PlusVideoFrame(const PlusVideoFrame& videoItem)
 //----------------------------------------------------------------------------
 PlusVideoFrame::~PlusVideoFrame()
 {
-  DELETE_IF_NOT_NULL(this->Image);
+  this->ReleaseImage();
 }
 
 //----------------------------------------------------------------------------
@@ -371,6 +373,12 @@ PlusVideoFrame& PlusVideoFrame::operator=(PlusVideoFrame const& videoItem)
   this->ImageType = videoItem.ImageType;
   this->ImageOrientation = videoItem.ImageOrientation;
 
+  if (this->IsImageShared())
+  {
+    // The current image is shared with other frames, it must not be overwritten
+    this->ReleaseImage();
+  }
+
   // Copy the pixels. Don't use image duplicator, because that wouldn't reuse the existing buffer
   if (videoItem.GetFrameSizeInBytes() > 0)
   {
@@ -481,6 +489,11 @@ PlusStatus PlusVideoFrame::AllocateFrame(vtkImageData* image, const unsigned int
 //----------------------------------------------------------------------------
 PlusStatus PlusVideoFrame::AllocateFrame(const int imageSize[3], PlusCommon::VTKScalarPixelType pixType, int numberOfScalarComponents)
 {
+  if (this->IsImageShared())
+  {
+    // Reallocation would change the image of other frames, so create a new image instead
+    this->ReleaseImage();
+  }
   if (this->GetImage() == NULL)
   {
     this->SetImageData(vtkImageData::New());
@@ -492,6 +505,11 @@ PlusStatus PlusVideoFrame::AllocateFrame(const int imageSize[3], PlusCommon::VTK
 //----------------------------------------------------------------------------
 PlusStatus PlusVideoFrame::AllocateFrame(const unsigned int imageSize[3], PlusCommon::VTKScalarPixelType pixType, unsigned int numberOfScalarComponents)
 {
+  if (this->IsImageShared())
+  {
+    // Reallocation would change the image of other frames, so create a new image instead
+    this->ReleaseImage();
+  }
   if (this->GetImage() == NULL)
   {
     this->SetImageData(vtkImageData::New());
@@ -550,10 +568,122 @@ PlusStatus PlusVideoFrame::ShallowCopyFrom(vtkImageData* frame)
     LOG_ERROR("Failed to shallow copy from vtk image data - input frame is NULL!");
     return PLUS_FAIL;
   }
+  if (this->IsImageShared())
+  {
+    this->ReleaseImage();
+  }
+  if (this->Image == NULL)
+  {
+    this->SetImageData(vtkImageData::New());
+  }
   this->Image->ShallowCopy(frame);
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus PlusVideoFrame::ShallowCopy(const PlusVideoFrame& videoItem)
+{
+  this->ImageType = videoItem.ImageType;
+  this->ImageOrientation = videoItem.ImageOrientation;
+
+  if (this == &videoItem || this->Image == videoItem.Image)
+  {
+    // already shared
+    return PLUS_SUCCESS;
+  }
+
+  this->ReleaseImage();
+  if (videoItem.Image != NULL)
+  {
+    if (!videoItem.ImageViewCount)
+    {
+      videoItem.ImageViewCount = std::make_shared< std::atomic<int> >(0);
+    }
+    videoItem.Image->Register(NULL);
+    this->SetImageData(videoItem.Image);
+    this->ImageViewCount = videoItem.ImageViewCount;
+    ++(*this->ImageViewCount);
+    this->ImageIsView = true;
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool PlusVideoFrame::IsImageShared() const
+{
+  if (this->Image == NULL)
+  {
+    return false;
+  }
+  return this->ImageIsView || this->GetNumberOfImageViews() > 0;
+}
+
+//----------------------------------------------------------------------------
+int PlusVideoFrame::GetNumberOfImageViews() const
+{
+  if (!this->ImageViewCount)
+  {
+    return 0;
+  }
+  return this->ImageViewCount->load();
+}
+
+//----------------------------------------------------------------------------
+void PlusVideoFrame::ReleaseImage()
+{
+  if (this->ImageIsView)
+  {
+    --(*this->ImageViewCount);
+    this->ImageIsView = false;
+  }
+  // The owner of the image drops the counter as well, views keep it alive while they refer to the image
+  this->ImageViewCount.reset();
+  DELETE_IF_NOT_NULL(this->Image);
+}
+
+//----------------------------------------------------------------------------
+void PlusVideoFrame::SwapImage(PlusVideoFrame& otherFrame)
+{
+  std::swap(this->Image, otherFrame.Image);
+  std::swap(this->ImageType, otherFrame.ImageType);
+  std::swap(this->ImageOrientation, otherFrame.ImageOrientation);
+  std::swap(this->ImageViewCount, otherFrame.ImageViewCount);
+  std::swap(this->ImageIsView, otherFrame.ImageIsView);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusVideoFrame::DetachSharedImage()
+{
+  if (!this->IsImageShared())
+  {
+    // the image is owned by this frame only, nothing to do
+    return PLUS_SUCCESS;
+  }
+
+  vtkImageData* sharedImage = this->Image;
+  sharedImage->Register(NULL);
+  this->ReleaseImage();
+  this->SetImageData(vtkImageData::New());
+  PlusStatus allocStatus = PLUS_SUCCESS;
+  int* extent = sharedImage->GetExtent();
+  if (extent[0] <= extent[1] && extent[2] <= extent[3] && extent[4] <= extent[5])
+  {
+    this->Image->SetExtent(extent);
+    this->Image->SetSpacing(sharedImage->GetSpacing());
+    this->Image->SetOrigin(sharedImage->GetOrigin());
+    this->Image->AllocateScalars(sharedImage->GetScalarType(), sharedImage->GetNumberOfScalarComponents());
+    if (this->Image->GetScalarPointer() == NULL)
+    {
+      LOG_ERROR("Failed to allocate memory for the detached image!");
+      allocStatus = PLUS_FAIL;
+    }
+  }
+  sharedImage->UnRegister(NULL);
+
+  return allocStatus;
+}
+
 //----------------------------------------------------------------------------
 int PlusVideoFrame::GetNumberOfBytesPerScalar() const
 {
@@ -13,6 +13,8 @@ See License.txt for details.
 #include "itkImage.h"
 #include "vtkImageExport.h"
 #include "vtkImageData.h"
+#include <atomic>
+#include <memory>
 
 /*!
 \enum US_IMAGE_ORIENTATION
@@ -182,6 +184,38 @@ public:
   /*! Sets the pixel buffer content by copying pixel data from a vtkImageData object.*/
   PlusStatus ShallowCopyFrom(vtkImageData* frame);
 
+  /*!
+    Make this frame a view of the image of another PlusVideoFrame object, without copying the pixel data.
+    The image is reference counted, so it remains valid as long as any frame refers to it.
+    The frame that owns the image counts its views. While the image has views, it is never modified by
+    AllocateFrame, DeepCopy, DeepCopyFrom, ShallowCopyFrom or operator= (neither in the owner nor in a view):
+    these methods allocate a new image for the frame instead (copy on write).
+    Pixels of a view must not be modified directly (through GetScalarPointer or GetImage).
+  */
+  PlusStatus ShallowCopy(const PlusVideoFrame& videoItem);
+
+  /*!
+    Returns true if this frame is a view of another frame's image or other frames are views of this frame's image (see ShallowCopy).
+    References to the image that are not created by ShallowCopy (e.g., a VTK pipeline connection or a smart pointer
+    to the result of GetImage()) do not make the image shared.
+  */
+  bool IsImageShared() const;
+
+  /*! Returns the number of views that refer to the image of this frame (see ShallowCopy) */
+  int GetNumberOfImageViews() const;
+
+  /*!
+    If the image is shared then replace it with a newly allocated image of the same size and pixel type.
+    Pixel values are not preserved. After this call the pixels can be modified without affecting other frames.
+  */
+  PlusStatus DetachSharedImage();
+
+  /*!
+    Exchange the image, image type and orientation of this frame with another frame, without copying the pixel data.
+    It allows filling a frame (e.g., by receiving pixels from the network) and then moving it into a buffer item.
+  */
+  void SwapImage(PlusVideoFrame& otherFrame);
+
   /*! Get US_IMAGE_ORIENTATION enum value from string */
   static US_IMAGE_ORIENTATION GetUsImageOrientationFromString(const char* imgOrientationStr);
   static US_IMAGE_ORIENTATION GetUsImageOrientationFromString(const std::string& imgOrientationStr);
@@ -319,9 +353,20 @@ public:
 protected:
   void SetImageData(vtkImageData* imageData);
 
+  /*! Release the image and, if this frame is a view, unregister the view from the image owner */
+  void ReleaseImage();
+
   vtkImageData* Image;
   US_IMAGE_TYPE ImageType;
   US_IMAGE_ORIENTATION ImageOrientation;
+
+  /*!
+    Number of views of the image (see ShallowCopy). The counter is shared by the frame that owns the image and
+    all its views, because views may outlive the owner. It is created when the first view is made.
+  */
+  mutable std::shared_ptr< std::atomic<int> > ImageViewCount;
+  /*! True if this frame is a view of the image of another frame */
+  bool ImageIsView;
 };
 
 #include "PlusVideoFrame.txx"
@@ -6,12 +6,20 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusNewDataNotifier.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 
 // VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkPoints.h>
 #include <vtkSmartPointer.h>
 #include <vtksys/CommandLineArguments.hxx>
 
+// STL includes
+#include <algorithm>
+
 namespace
 {
   static const double DOUBLE_THRESHOLD = 0.0001;
@@ -116,6 +124,276 @@ namespace
     return PLUS_SUCCESS;
   }
 
+  PlusStatus TestTrackedFrameBinaryData()
+  {
+    PlusTrackedFrame frame;
+    frame.SetTimestamp(12.5);
+    frame.SetCustomFrameField("FrameNumber", "17");
+    double probeToTracker[16] = { 1, 0, 0, 10.25, 0, 0, -1, 20.5, 0, 1, 0, -30.75, 0, 0, 0, 1 };
+    double imageToProbe[16] = { 0.5, 0, 0, 1, 0, 0.5, 0, 2, 0, 0, 0.5, 3, 0, 0, 0, 1 };
+    frame.SetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), probeToTracker);
+    frame.SetCustomFrameTransformStatus(PlusTransformName("Probe", "Tracker"), FIELD_OK);
+    frame.SetCustomFrameTransform(PlusTransformName("Image", "Probe"), imageToProbe);
+    frame.SetCustomFrameTransformStatus(PlusTransformName("Stylus", "Tracker"), FIELD_INVALID);
+    vtkSmartPointer<vtkPoints> fiducialPoints = vtkSmartPointer<vtkPoints>::New();
+    fiducialPoints->InsertNextPoint(1.5, 2.5, 0);
+    fiducialPoints->InsertNextPoint(100.125, 200.25, 0);
+    frame.SetFiducialPointsCoordinatePx(fiducialPoints);
+
+    // All fields must be restored exactly
+    std::string binaryData;
+    if (frame.GetTrackedFrameInBinaryData(binaryData, std::vector<PlusTransformName>()) != PLUS_SUCCESS
+        || !PlusTrackedFrame::IsBinaryData(binaryData.data(), binaryData.size()))
+    {
+      LOG_ERROR("Failed to write tracked frame binary data");
+      return PLUS_FAIL;
+    }
+    PlusTrackedFrame binaryFrame;
+    if (binaryFrame.SetTrackedFrameFromBinaryData(binaryData.data(), binaryData.size()) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to read tracked frame binary data");
+      return PLUS_FAIL;
+    }
+    if (binaryFrame.GetCustomFields() != frame.GetCustomFields() || binaryFrame.GetTimestamp() != frame.GetTimestamp())
+    {
+      LOG_ERROR("Custom fields restored from tracked frame binary data differ from the original");
+      return PLUS_FAIL;
+    }
+    if (binaryFrame.GetFiducialPointsCoordinatePx() == NULL || binaryFrame.GetFiducialPointsCoordinatePx()->GetNumberOfPoints() != 2
+        || binaryFrame.GetFiducialPointsCoordinatePx()->GetPoint(1)[1] != 200.25)
+    {
+      LOG_ERROR("Segmented points restored from tracked frame binary data differ from the original");
+      return PLUS_FAIL;
+    }
+
+    // Selecting transforms must give the same fields as the XML serialization
+    frame.SetFiducialPointsCoordinatePx(NULL);
+    std::vector<PlusTransformName> requestedTransforms;
+    requestedTransforms.push_back(PlusTransformName("Image", "Probe"));
+    requestedTransforms.push_back(PlusTransformName("Stylus", "Tracker"));
+    std::string xmlData;
+    if (frame.GetTrackedFrameInBinaryData(binaryData, requestedTransforms) != PLUS_SUCCESS
+        || frame.GetTrackedFrameInXmlData(xmlData, requestedTransforms) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to write tracked frame data with requested transforms");
+      return PLUS_FAIL;
+    }
+    PlusTrackedFrame requestedBinaryFrame;
+    PlusTrackedFrame requestedXmlFrame;
+    if (requestedBinaryFrame.SetTrackedFrameFromBinaryData(binaryData.data(), binaryData.size()) != PLUS_SUCCESS
+        || requestedXmlFrame.SetTrackedFrameFromXmlData(xmlData) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to read tracked frame data with requested transforms");
+      return PLUS_FAIL;
+    }
+    if (requestedBinaryFrame.GetCustomFields() != requestedXmlFrame.GetCustomFields())
+    {
+      LOG_ERROR("Custom fields restored from tracked frame binary data differ from the ones restored from XML");
+      return PLUS_FAIL;
+    }
+
+    // Truncated data must be rejected
+    if (binaryFrame.SetTrackedFrameFromBinaryData(binaryData.data(), binaryData.size() / 2) != PLUS_FAIL)
+    {
+      LOG_ERROR("Error expected when reading truncated tracked frame binary data");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
+  PlusStatus TestTrackedFrameTransformFields()
+  {
+    PlusTrackedFrame frame;
+    frame.SetTimestamp(3.5);
+    frame.SetCustomFrameField("FrameNumber", "5");
+    double probeToTracker[16] = { 1, 0, 0, 10.25, 0, 0, -1, 20.5, 0, 1, 0, -30.75, 0, 0, 0, 1 };
+    frame.SetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), probeToTracker);
+    frame.SetCustomFrameTransformStatus(PlusTransformName("Probe", "Tracker"), FIELD_OK);
+
+    // String round trip: transforms written as string fields must be parsed back into the same matrix
+    PlusTrackedFrame stringFrame;
+    const PlusTrackedFrame::FieldMapType& fields = frame.GetCustomFields();
+    for (PlusTrackedFrame::FieldMapType::const_iterator it = fields.begin(); it != fields.end(); ++it)
+    {
+      stringFrame.SetCustomFrameField(it->first, it->second);
+    }
+    double transform[16] = { 0 };
+    TrackedFrameFieldStatus status = FIELD_INVALID;
+    if (!stringFrame.IsCustomFrameTransformNameDefined(PlusTransformName("Probe", "Tracker"))
+        || stringFrame.GetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), transform) != PLUS_SUCCESS
+        || stringFrame.GetCustomFrameTransformStatus(PlusTransformName("Probe", "Tracker"), status) != PLUS_SUCCESS
+        || !std::equal(probeToTracker, probeToTracker + 16, transform) || status != FIELD_OK)
+    {
+      LOG_ERROR("Transform restored from the string custom fields differs from the original");
+      return PLUS_FAIL;
+    }
+    if (stringFrame.GetCustomFields() != frame.GetCustomFields())
+    {
+      LOG_ERROR("Custom fields of the frame restored from string fields differ from the original");
+      return PLUS_FAIL;
+    }
+
+    // Binary round trip: string fields and binary transforms together give all the custom fields
+    PlusTrackedFrame binaryFrame;
+    const PlusTrackedFrame::FieldMapType& stringFields = frame.GetStringCustomFields();
+    for (PlusTrackedFrame::FieldMapType::const_iterator it = stringFields.begin(); it != stringFields.end(); ++it)
+    {
+      binaryFrame.SetCustomFrameField(it->first, it->second);
+    }
+    binaryFrame.SetFrameTransformItems(frame.GetFrameTransformItems());
+    if (binaryFrame.GetCustomFields() != frame.GetCustomFields())
+    {
+      LOG_ERROR("Custom fields of the frame restored from binary transforms differ from the original");
+      return PLUS_FAIL;
+    }
+
+    // The string representation must follow changes of the transforms
+    probeToTracker[3] = 11.5;
+    binaryFrame.SetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), probeToTracker);
+    frame.SetCustomFrameField("ProbeToTrackerTransform", binaryFrame.GetCustomFrameField("ProbeToTrackerTransform"));
+    if (binaryFrame.GetCustomFields() != frame.GetCustomFields()
+        || frame.GetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), transform) != PLUS_SUCCESS
+        || transform[3] != 11.5)
+    {
+      LOG_ERROR("Custom fields are not updated after the transform is changed");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
+  PlusStatus TestTrackedFrameTransformFieldStrings()
+  {
+    PlusTrackedFrame frame;
+    const std::string fieldName = "NeedleToTrackerTransform";
+    const std::string values[4] = { "1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1", " 1.0  0 0 2.50\t0 1 0 0 0 0 1 0 0 0 0 1 ", "1 0 0 3 0 1 0 0 0 0 1 0", "not a matrix" };
+    const double expectedTranslation[4] = { 0, 2.5, 3, 0 };
+    for (int i = 0; i < 4; ++i)
+    {
+      // Transform field values must be returned and written back unchanged
+      frame.SetCustomFrameField(fieldName, values[i]);
+      const char* value = frame.GetCustomFrameField(fieldName);
+      PlusTrackedFrame::FieldMapType::const_iterator field = frame.GetCustomFields().find(fieldName);
+      if (value == NULL || values[i] != value || field == frame.GetCustomFields().end() || field->second != values[i])
+      {
+        LOG_ERROR("Transform field value '" << values[i] << "' is not preserved, got: " << (value ? value : "NULL"));
+        return PLUS_FAIL;
+      }
+
+      // Up to 16 elements are parsed, missing elements are taken from the identity matrix
+      double transform[16] = { 0 };
+      if (frame.GetCustomFrameTransform(PlusTransformName("Needle", "Tracker"), transform) != PLUS_SUCCESS
+          || transform[0] != 1 || transform[3] != expectedTranslation[i] || transform[15] != 1)
+      {
+        LOG_ERROR("Transform field value '" << values[i] << "' is not parsed correctly");
+        return PLUS_FAIL;
+      }
+    }
+
+    // Returned field values must remain valid while other fields are set and read
+    double probeToTracker[16] = { 1, 0, 0, 10.25, 0, 0, -1, 20.5, 0, 1, 0, -30.75, 0, 0, 0, 1 };
+    frame.SetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), probeToTracker);
+    frame.SetCustomFrameTransformStatus(PlusTransformName("Probe", "Tracker"), FIELD_OK);
+    const char* probeToTrackerValue = frame.GetCustomFrameField("ProbeToTrackerTransform");
+    const char* probeToTrackerStatusValue = frame.GetCustomFrameField("ProbeToTrackerTransformStatus");
+    const std::string expectedProbeToTrackerValue = (probeToTrackerValue ? probeToTrackerValue : "");
+    for (int i = 0; i < 10; ++i)
+    {
+      double stylusToTracker[16] = { 1, 0, 0, static_cast<double>(i), 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+      frame.SetCustomFrameTransform(PlusTransformName("Stylus", "Tracker"), stylusToTracker);
+      frame.SetCustomFrameField("FrameNumber", "5");
+      frame.GetCustomFrameField("StylusToTrackerTransform");
+      frame.GetCustomFields();
+    }
+    if (probeToTrackerValue != frame.GetCustomFrameField("ProbeToTrackerTransform") || expectedProbeToTrackerValue != probeToTrackerValue
+        || probeToTrackerStatusValue != frame.GetCustomFrameField("ProbeToTrackerTransformStatus") || std::string("OK") != probeToTrackerStatusValue)
+    {
+      LOG_ERROR("Transform field value is changed by modifying other fields");
+      return PLUS_FAIL;
+    }
+
+    // Setting a matrix replaces the string value
+    double needleToTracker[16] = { 1, 0, 0, 4, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    frame.SetCustomFrameTransform(PlusTransformName("Needle", "Tracker"), needleToTracker);
+    const char* value = frame.GetCustomFrameField(fieldName);
+    frame.SetCustomFrameField("CopiedToTrackerTransform", value ? value : "");
+    double transform[16] = { 0 };
+    if (value == NULL || values[3] == value
+        || frame.GetCustomFrameTransform(PlusTransformName("Copied", "Tracker"), transform) != PLUS_SUCCESS
+        || !std::equal(needleToTracker, needleToTracker + 16, transform))
+    {
+      LOG_ERROR("Matrix does not replace the transform field string value");
+      return PLUS_FAIL;
+    }
+
+    // Deleting the field removes the value
+    if (frame.DeleteCustomFrameField(fieldName.c_str()) != PLUS_SUCCESS || frame.IsCustomFrameFieldDefined(fieldName.c_str())
+        || frame.GetCustomFrameField(fieldName) != NULL || frame.GetCustomFields().find(fieldName) != frame.GetCustomFields().end())
+    {
+      LOG_ERROR("Failed to delete transform field");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
+  void* NotifyNewDataThread(vtkMultiThreader::ThreadInfo* data)
+  {
+    vtkPlusNewDataNotifier* notifier = static_cast<vtkPlusNewDataNotifier*>(data->UserData);
+    vtkPlusAccurateTimer::Delay(0.1);
+    notifier->NotifyNewData();
+    return NULL;
+  }
+
+  PlusStatus TestNewDataNotifier()
+  {
+    const double shortTimeoutSec = 0.05;
+    const double longTimeoutSec = 5.0;
+    vtkSmartPointer<vtkPlusNewDataNotifier> notifier = vtkSmartPointer<vtkPlusNewDataNotifier>::New();
+    unsigned long lastNotificationCount = notifier->GetNotificationCount();
+
+    // Without a notification the wait times out
+    double startTime = vtkPlusAccurateTimer::GetSystemTime();
+    if (notifier->WaitForNewData(lastNotificationCount, shortTimeoutSec))
+    {
+      LOG_ERROR("New data is reported although there was no notification");
+      return PLUS_FAIL;
+    }
+    if (vtkPlusAccurateTimer::GetSystemTime() - startTime < shortTimeoutSec * 0.5)
+    {
+      LOG_ERROR("Waiting for new data returned before the timeout");
+      return PLUS_FAIL;
+    }
+
+    // A notification from another thread wakes up the waiting thread before the timeout
+    vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+    startTime = vtkPlusAccurateTimer::GetSystemTime();
+    int threadId = threader->SpawnThread((vtkThreadFunctionType)&NotifyNewDataThread, notifier.GetPointer());
+    bool notified = notifier->WaitForNewData(lastNotificationCount, longTimeoutSec);
+    double waitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - startTime;
+    threader->TerminateThread(threadId);
+    if (!notified || waitTimeSec >= longTimeoutSec)
+    {
+      LOG_ERROR("The waiting thread is not woken up by the notification");
+      return PLUS_FAIL;
+    }
+    if (lastNotificationCount != notifier->GetNotificationCount())
+    {
+      LOG_ERROR("The notification count is not updated by waiting for new data");
+      return PLUS_FAIL;
+    }
+
+    // The notification has been consumed
+    if (notifier->WaitForNewData(lastNotificationCount, 0))
+    {
+      LOG_ERROR("The same notification is reported twice");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
   PlusStatus TestValidTransformName(std::string from, std::string to)
   {
     PlusTransformName transformName;
@@ -286,6 +564,14 @@ int main(int argc, char** argv)
 
   if (TestXMLFunctions() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
 
+  if (TestTrackedFrameBinaryData() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
+  if (TestTrackedFrameTransformFields() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
+  if (TestTrackedFrameTransformFieldStrings() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
+  if (TestNewDataNotifier() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
   LOG_INFO("Test finished successfully!");
   return EXIT_SUCCESS;
 }
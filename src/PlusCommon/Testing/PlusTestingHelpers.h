@@ -0,0 +1,125 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PLUSTESTINGHELPERS_H
+#define __PLUSTESTINGHELPERS_H
+
+#include "PlusConfigure.h"
+#include "vtkPlusAccurateTimer.h"
+
+#include <vtkImageData.h>
+
+#include <string.h>
+
+/*!
+  \file PlusTestingHelpers.h
+  \brief Test data generation and result checking functions that are shared by the tests of several modules
+  \ingroup PlusLibCommon
+*/
+namespace PlusTesting
+{
+  /*! Maximum time to wait for a thread to reach an expected state */
+  const double CONDITION_TIMEOUT_SEC = 5.0;
+
+  //----------------------------------------------------------------------------
+  /*! Simple deterministic pseudo-random number generator, so that the test input is the same on all platforms */
+  class TestRandomGenerator
+  {
+  public:
+    TestRandomGenerator() : State(12345) {}
+    unsigned int Next()
+    {
+      this->State = this->State * 1103515245 + 12345;
+      return (this->State >> 16) & 0x7fff;
+    }
+    double Uniform(double min, double max)
+    {
+      return min + (max - min) * Next() / 32767.0;
+    }
+    /*! Random integer in [min, max] */
+    unsigned int UniformInt(unsigned int min, unsigned int max)
+    {
+      return min + Next() % (max - min + 1);
+    }
+  private:
+    unsigned int State;
+  };
+
+  //----------------------------------------------------------------------------
+  /*! Returns true if the condition becomes true within CONDITION_TIMEOUT_SEC */
+  template<class Condition>
+  bool WaitForCondition(Condition condition)
+  {
+    double startTime = vtkPlusAccurateTimer::GetSystemTime();
+    while (!condition())
+    {
+      if (vtkPlusAccurateTimer::GetSystemTime() - startTime > CONDITION_TIMEOUT_SEC)
+      {
+        return false;
+      }
+      vtkPlusAccurateTimer::Delay(0.001);
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  /*! Returns true if the two volumes have the same geometry and exactly the same voxel values */
+  inline bool AreVolumesEqual(vtkImageData* expectedVolume, vtkImageData* actualVolume)
+  {
+    int* expectedExtent = expectedVolume->GetExtent();
+    int* actualExtent = actualVolume->GetExtent();
+    for (int i = 0; i < 6; i++)
+    {
+      if (expectedExtent[i] != actualExtent[i])
+      {
+        LOG_ERROR("Volume extent mismatch");
+        return false;
+      }
+    }
+    if (expectedVolume->GetScalarType() != actualVolume->GetScalarType()
+        || expectedVolume->GetNumberOfScalarComponents() != actualVolume->GetNumberOfScalarComponents())
+    {
+      LOG_ERROR("Volume scalar type mismatch");
+      return false;
+    }
+    size_t volumeSizeInBytes = static_cast<size_t>(expectedVolume->GetNumberOfPoints()) * expectedVolume->GetNumberOfScalarComponents() * expectedVolume->GetScalarSize();
+    if (memcmp(expectedVolume->GetScalarPointer(), actualVolume->GetScalarPointer(), volumeSizeInBytes) != 0)
+    {
+      int numberOfDifferentVoxels = 0;
+      const unsigned char* expectedPtr = static_cast<const unsigned char*>(expectedVolume->GetScalarPointer());
+      const unsigned char* actualPtr = static_cast<const unsigned char*>(actualVolume->GetScalarPointer());
+      size_t voxelSizeInBytes = expectedVolume->GetNumberOfScalarComponents() * expectedVolume->GetScalarSize();
+      for (vtkIdType voxelIndex = 0; voxelIndex < expectedVolume->GetNumberOfPoints(); voxelIndex++)
+      {
+        if (memcmp(expectedPtr + voxelIndex * voxelSizeInBytes, actualPtr + voxelIndex * voxelSizeInBytes, voxelSizeInBytes) != 0)
+        {
+          numberOfDifferentVoxels++;
+        }
+      }
+      LOG_ERROR(numberOfDifferentVoxels << " voxels are different");
+      return false;
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  /*! Returns true if all the voxels of the volume are zero */
+  inline bool IsVolumeEmpty(vtkImageData* volume)
+  {
+    size_t volumeSizeInBytes = static_cast<size_t>(volume->GetNumberOfPoints()) * volume->GetNumberOfScalarComponents() * volume->GetScalarSize();
+    const unsigned char* voxelPtr = static_cast<const unsigned char*>(volume->GetScalarPointer());
+    for (size_t i = 0; i < volumeSizeInBytes; i++)
+    {
+      if (voxelPtr[i] != 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+#endif
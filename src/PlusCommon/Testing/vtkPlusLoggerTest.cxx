@@ -7,7 +7,10 @@
 #include "PlusConfigure.h"
 
 #include "vtksys/CommandLineArguments.hxx"
+#include "vtkCallbackCommand.h"
+#include "vtkMultiThreader.h"
 #include "vtkSmartPointer.h"
+#include <string>
 
 class vtkLogTestObject : public vtkObject
 {
@@ -28,6 +31,86 @@ protected:
   virtual ~vtkLogTestObject() {}; 
 };
 
+static const char ASYNC_TEST_MESSAGE[] = "Asynchronous logging test message";
+static const int ASYNC_TEST_NUMBER_OF_THREADS = 4;
+static const int ASYNC_TEST_NUMBER_OF_MESSAGES_PER_THREAD = 500;
+
+//----------------------------------------------------------------------------
+// Counts the messages logged by the asynchronous logging test. Observers are called with the logger locked.
+void CountAsyncTestMessages(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+  std::string message = static_cast<const char*>(callData);
+  if (message.find(ASYNC_TEST_MESSAGE) != std::string::npos)
+  {
+    (*static_cast<int*>(clientData))++;
+  }
+}
+
+//----------------------------------------------------------------------------
+void* LogAsyncTestMessages(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusLogger::LogLevelType level = *static_cast<vtkPlusLogger::LogLevelType*>(data->UserData);
+  for (int i = 0; i < ASYNC_TEST_NUMBER_OF_MESSAGES_PER_THREAD; i++)
+  {
+    std::ostringstream msg;
+    msg << ASYNC_TEST_MESSAGE << " " << i << " from thread " << data->ThreadID;
+    vtkPlusLogger::Instance()->LogMessage(level, msg.str().c_str(), __FILE__, __LINE__);
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+// Logs messages from multiple threads with asynchronous logging enabled
+int TestAsynchronousLogging()
+{
+  vtkPlusLogger* logger = vtkPlusLogger::Instance();
+  if (logger->GetLogLevel() < vtkPlusLogger::LOG_LEVEL_INFO)
+  {
+    // test messages would not be logged
+    return EXIT_SUCCESS;
+  }
+
+  int numberOfReceivedMessages = 0;
+  vtkSmartPointer<vtkCallbackCommand> messageCounter = vtkSmartPointer<vtkCallbackCommand>::New();
+  messageCounter->SetCallback(CountAsyncTestMessages);
+  messageCounter->SetClientData(&numberOfReceivedMessages);
+  unsigned long observerTag = logger->AddObserver(vtkCommand::UserEvent, messageCounter);
+
+  // With blocking overflow policy no messages may be lost, even if the queue is much smaller than the number of messages
+  logger->SetAsynchronousLoggingOverflowPolicy(vtkPlusLogger::OVERFLOW_POLICY_BLOCK);
+  logger->SetAsynchronousLoggingQueueSize(64);
+  logger->SetAsynchronousLogging(true);
+  vtkPlusLogger::LogLevelType level = vtkPlusLogger::LOG_LEVEL_INFO;
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(ASYNC_TEST_NUMBER_OF_THREADS);
+  threader->SetSingleMethod((vtkThreadFunctionType)&LogAsyncTestMessages, &level);
+  threader->SingleMethodExecute();
+  logger->SetAsynchronousLogging(false);
+
+  unsigned long numberOfDroppedMessages = logger->GetNumberOfDroppedMessages();
+  logger->RemoveObserver(observerTag);
+
+  int expectedNumberOfMessages = ASYNC_TEST_NUMBER_OF_THREADS * ASYNC_TEST_NUMBER_OF_MESSAGES_PER_THREAD;
+  if (numberOfReceivedMessages != expectedNumberOfMessages || numberOfDroppedMessages != 0)
+  {
+    LOG_ERROR("Asynchronous logging test failed: received " << numberOfReceivedMessages << " messages (expected " << expectedNumberOfMessages
+              << "), dropped " << numberOfDroppedMessages << " messages (expected 0)");
+    return EXIT_FAILURE;
+  }
+
+  // With drop overflow policy trace messages may be dropped, just make sure that it works
+  logger->SetAsynchronousLoggingOverflowPolicy(vtkPlusLogger::OVERFLOW_POLICY_DROP);
+  logger->SetAsynchronousLoggingQueueSize(4);
+  logger->SetAsynchronousLogging(true);
+  level = vtkPlusLogger::LOG_LEVEL_TRACE;
+  threader->SingleMethodExecute();
+  logger->SetAsynchronousLogging(false);
+  LOG_INFO("Number of dropped messages with a small asynchronous logging queue: " << logger->GetNumberOfDroppedMessages());
+
+  logger->SetAsynchronousLoggingQueueSize(4096);
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 {
   bool printHelp(false);
@@ -74,5 +157,10 @@ int main(int argc, char **argv)
   logTester->DebugOn();
   logTester->LogMessages();
 
+  if (TestAsynchronousLogging() != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS; 
  }
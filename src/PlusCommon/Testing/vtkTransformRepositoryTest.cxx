@@ -16,6 +16,181 @@
 #include "PlusTrackedFrame.h"
 #include "vtkXMLUtilities.h"
 
+#include <vector>
+
+//----------------------------------------------------------------------------
+static bool IsMatrixEqual(vtkMatrix4x4* actual, vtkMatrix4x4* expected)
+{
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int col = 0; col < 4; ++col)
+    {
+      if (fabs(actual->GetElement(row, col) - expected->GetElement(row, col)) > 1e-9)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+static vtkSmartPointer<vtkMatrix4x4> CreateTestMatrix(double translationX, double scale)
+{
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  matrix->SetElement(0, 3, translationX);
+  matrix->SetElement(1, 3, -2 * translationX);
+  matrix->SetElement(0, 0, scale);
+  matrix->SetElement(0, 1, 0.25);
+  matrix->SetElement(2, 2, -1);
+  return matrix;
+}
+
+//----------------------------------------------------------------------------
+// Check that stored transform paths give up-to-date results after the transforms are changed
+static PlusStatus TestTransformPathCache()
+{
+  vtkSmartPointer<vtkPlusTransformRepository> repository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  vtkSmartPointer<vtkMatrix4x4> mxAToB = CreateTestMatrix(1, 2);
+  vtkSmartPointer<vtkMatrix4x4> mxBToC = CreateTestMatrix(3, 0.5);
+  vtkSmartPointer<vtkMatrix4x4> mxDToC = CreateTestMatrix(-5, 1.5);
+  repository->SetTransform(PlusTransformName("A", "B"), mxAToB);
+  repository->SetTransform(PlusTransformName("B", "C"), mxBToC);
+  repository->SetTransform(PlusTransformName("D", "C"), mxDToC);
+
+  vtkSmartPointer<vtkMatrix4x4> mxAToC = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkSmartPointer<vtkMatrix4x4> mxAToCExpected = vtkSmartPointer<vtkMatrix4x4>::New();
+  bool isValid(false);
+
+  // Query the same transform repeatedly, the second query uses the stored path
+  vtkMatrix4x4::Multiply4x4(mxBToC, mxAToB, mxAToCExpected);
+  for (int i = 0; i < 2; ++i)
+  {
+    if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) != PLUS_SUCCESS || !isValid || !IsMatrixEqual(mxAToC, mxAToCExpected))
+    {
+      LOG_ERROR("AToC transform is incorrect (query " << i << ")");
+      return PLUS_FAIL;
+    }
+  }
+
+  // Updating a matrix must change the result of the stored path, also in the inverse direction
+  mxAToB = CreateTestMatrix(7, -3);
+  repository->SetTransform(PlusTransformName("A", "B"), mxAToB);
+  vtkMatrix4x4::Multiply4x4(mxBToC, mxAToB, mxAToCExpected);
+  if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) != PLUS_SUCCESS || !isValid || !IsMatrixEqual(mxAToC, mxAToCExpected))
+  {
+    LOG_ERROR("AToC transform is not updated after AToB is changed");
+    return PLUS_FAIL;
+  }
+  vtkSmartPointer<vtkMatrix4x4> mxCToA = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkSmartPointer<vtkMatrix4x4> mxCToAExpected = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Invert(mxAToCExpected, mxCToAExpected);
+  if (repository->GetTransform(PlusTransformName("C", "A"), mxCToA, &isValid) != PLUS_SUCCESS || !isValid || !IsMatrixEqual(mxCToA, mxCToAExpected))
+  {
+    LOG_ERROR("CToA transform is not updated after AToB is changed");
+    return PLUS_FAIL;
+  }
+
+  // Changing the validity of a transform must change the validity of the stored path
+  repository->SetTransformValid(PlusTransformName("B", "C"), false);
+  if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) != PLUS_SUCCESS || isValid)
+  {
+    LOG_ERROR("AToC transform should be invalid after BToC is set to invalid");
+    return PLUS_FAIL;
+  }
+  repository->SetTransformValid(PlusTransformName("B", "C"), true);
+  if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) != PLUS_SUCCESS || !isValid)
+  {
+    LOG_ERROR("AToC transform should be valid after BToC is set to valid");
+    return PLUS_FAIL;
+  }
+
+  // GetTransforms must give the same results as individual GetTransform calls,
+  // including the paths that share their beginning (AToC and AToD)
+  repository->SetTransformValid(PlusTransformName("D", "C"), false);
+  std::vector<PlusTransformName> transformNames;
+  transformNames.push_back(PlusTransformName("A", "C"));
+  transformNames.push_back(PlusTransformName("A", "D"));
+  transformNames.push_back(PlusTransformName("A", "A"));
+  transformNames.push_back(PlusTransformName("C", "A"));
+  transformNames.push_back(PlusTransformName("D", "B"));
+  std::vector< vtkSmartPointer<vtkMatrix4x4> > matrices;
+  std::vector<vtkMatrix4x4*> matrixPointers;
+  for (std::size_t i = 0; i < transformNames.size(); ++i)
+  {
+    matrices.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+    matrixPointers.push_back(matrices.back().GetPointer());
+  }
+  std::vector<bool> transformsValid;
+  if (repository->GetTransforms(transformNames, matrixPointers, &transformsValid) != PLUS_SUCCESS || transformsValid.size() != transformNames.size())
+  {
+    LOG_ERROR("GetTransforms failed");
+    return PLUS_FAIL;
+  }
+  for (std::size_t i = 0; i < transformNames.size(); ++i)
+  {
+    vtkSmartPointer<vtkMatrix4x4> mxExpected = vtkSmartPointer<vtkMatrix4x4>::New();
+    bool isExpectedValid(false);
+    repository->GetTransform(transformNames[i], mxExpected, &isExpectedValid);
+    if (!IsMatrixEqual(matrices[i], mxExpected) || transformsValid[i] != isExpectedValid)
+    {
+      LOG_ERROR("GetTransforms result differs from GetTransform for " << transformNames[i].GetTransformName());
+      return PLUS_FAIL;
+    }
+  }
+  if (transformsValid[1] || transformsValid[4] || !transformsValid[0] || !transformsValid[2] || !transformsValid[3])
+  {
+    LOG_ERROR("GetTransforms returned incorrect validity");
+    return PLUS_FAIL;
+  }
+
+  // A missing transform must not prevent computing the others
+  transformNames.push_back(PlusTransformName("E", "A"));
+  matrices.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+  matrixPointers.push_back(matrices.back().GetPointer());
+  matrixPointers[0] = NULL;
+  if (repository->GetTransforms(transformNames, matrixPointers, &transformsValid) != PLUS_FAIL || transformsValid.back() || !transformsValid[3]
+      || !IsMatrixEqual(matrices[3], mxCToAExpected))
+  {
+    LOG_ERROR("GetTransforms should fail only for the missing transform");
+    return PLUS_FAIL;
+  }
+
+  // Adding a transform must make the new path available
+  vtkSmartPointer<vtkMatrix4x4> mxEToC = CreateTestMatrix(4, 1);
+  repository->SetTransform(PlusTransformName("E", "C"), mxEToC);
+  vtkSmartPointer<vtkMatrix4x4> mxEToA = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkSmartPointer<vtkMatrix4x4> mxEToAExpected = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(mxCToAExpected, mxEToC, mxEToAExpected);
+  if (repository->GetTransform(PlusTransformName("E", "A"), mxEToA, &isValid) != PLUS_SUCCESS || !IsMatrixEqual(mxEToA, mxEToAExpected))
+  {
+    LOG_ERROR("EToA transform is incorrect after EToC is added");
+    return PLUS_FAIL;
+  }
+
+  // Deleting a transform must remove the stored paths that contain it
+  if (repository->DeleteTransform(PlusTransformName("B", "C")) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to delete BToC transform");
+    return PLUS_FAIL;
+  }
+  if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) == PLUS_SUCCESS || isValid)
+  {
+    LOG_ERROR("AToC transform should not be available after BToC is deleted");
+    return PLUS_FAIL;
+  }
+  vtkSmartPointer<vtkMatrix4x4> mxAToCDirect = CreateTestMatrix(9, 4);
+  repository->SetTransform(PlusTransformName("A", "C"), mxAToCDirect);
+  if (repository->GetTransform(PlusTransformName("A", "C"), mxAToC, &isValid) != PLUS_SUCCESS || !isValid || !IsMatrixEqual(mxAToC, mxAToCDirect))
+  {
+    LOG_ERROR("AToC transform is incorrect after it is set directly");
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
 int main(int argc, char **argv)
 {
   // Parse command-line arguments
@@ -382,6 +557,13 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Check stored transform paths
+  if (TestTransformPathCache() != PLUS_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
   LOG_INFO("Test successfully completed");
   return EXIT_SUCCESS; 
  }
@@ -9,6 +9,7 @@ See License.txt for details.
 #include "PlusMath.h"
 #include "PlusTrackedFrame.h"
 #include "vtkPlusSequenceIO.h"
+#include "vtkPlusSequenceIOBase.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtkPlusTransformRepository.h"
 
@@ -21,6 +22,7 @@ See License.txt for details.
 #include <vtkXMLUtilities.h>
 #include <vtksys/CommandLineArguments.hxx>
 #include <vtksys/RegularExpression.hxx>
+#include <vtksys/SystemTools.hxx>
 
 enum OperationType
 {
@@ -162,6 +164,31 @@ PlusStatus MixTrackedFrameLists(vtkPlusTrackedFrameList* trackedFrameList, std::
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+// Read the frame fields of a sequence file, pixel data of a frame is only read from the file when the frame is accessed
+PlusStatus ReadSequenceFileWithLazyPixelDataLoading(const std::string& inputFileName, vtkSmartPointer<vtkPlusSequenceIOBase>& reader)
+{
+  LOG_INFO("Read input sequence file: " << inputFileName);
+  if (!vtksys::SystemTools::FileExists(inputFileName.c_str()))
+  {
+    LOG_ERROR("File: " << inputFileName << " does not exist.");
+    return PLUS_FAIL;
+  }
+  reader = vtkSmartPointer<vtkPlusSequenceIOBase>::Take(vtkPlusSequenceIO::CreateSequenceHandlerForFile(inputFileName));
+  if (reader.GetPointer() == NULL)
+  {
+    return PLUS_FAIL;
+  }
+  reader->SetFileName(inputFileName);
+  reader->LazyPixelDataLoadingOn();
+  if (reader->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read sequence file: " << inputFileName);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 // Append tracked frame list (one after the other)
 PlusStatus AppendTrackedFrameLists(vtkPlusTrackedFrameList* trackedFrameList, std::vector<std::string> inputFileNames, bool incrementTimestamps)
@@ -464,10 +491,31 @@ int main(int argc, char** argv)
 
   // Multiple input files are appended unless sequences are mixed
   PlusStatus status = PLUS_SUCCESS;
+  // Keeps loading pixel data of a single input file until the output is written
+  vtkSmartPointer<vtkPlusSequenceIOBase> inputReader;
   if (operation == MIX)
   {
     status = MixTrackedFrameLists(trackedFrameList, inputFileNames);
   }
+  else if (inputFileNames.size() == 1)
+  {
+    // Pixel data of frames that are removed (e.g., by TRIM or DECIMATE) is never read from the file
+    status = ReadSequenceFileWithLazyPixelDataLoading(inputFileNames[0], inputReader);
+    if (status == PLUS_SUCCESS)
+    {
+      trackedFrameList = inputReader->GetTrackedFrameList();
+      if (operation == REMOVE_IMAGE_DATA)
+      {
+        // Image data is not written, so it does not have to be read either, except for the first frame
+        // that the image dimensions in the output header are determined from
+        if (trackedFrameList->GetNumberOfTrackedFrames() > 0)
+        {
+          trackedFrameList->GetTrackedFrame(0);
+        }
+        inputReader = NULL;
+      }
+    }
+  }
   else
   {
     status = AppendTrackedFrameLists(trackedFrameList, inputFileNames, incrementTimestamps);
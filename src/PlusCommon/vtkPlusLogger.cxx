@@ -16,13 +16,23 @@ See License.txt for details.
 #include "vtkPlusLogger.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtksys/SystemTools.hxx"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 
 //-----------------------------------------------------------------------------
 
 vtkPlusLogger* vtkPlusLogger::m_pInstance = NULL;
 
+static const unsigned int DEFAULT_ASYNCHRONOUS_LOGGING_QUEUE_SIZE = 4096;
+static const int ASYNCHRONOUS_LOGGING_WRITE_INTERVAL_MS = 50; // queued messages are written at least this often
+
 //-----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkPlusLoggerOutputWindow);
@@ -31,8 +41,280 @@ vtkStandardNewMacro(vtkPlusLoggerOutputWindow);
 namespace
 {
   vtkPlusSimpleRecursiveCriticalSection LoggerCreationCriticalSection;
+
+  //-----------------------------------------------------------------------------
+  const char* GetLogLevelPrefix(int level)
+  {
+    switch (level)
+    {
+      case vtkPlusLogger::LOG_LEVEL_ERROR:
+        return "|ERROR";
+      case vtkPlusLogger::LOG_LEVEL_WARNING:
+        return "|WARNING";
+      case vtkPlusLogger::LOG_LEVEL_INFO:
+        return "|INFO";
+      case vtkPlusLogger::LOG_LEVEL_DEBUG:
+        return "|DEBUG";
+      case vtkPlusLogger::LOG_LEVEL_TRACE:
+        return "|TRACE";
+      default:
+        return "|UNKNOWN";
+    }
+  }
+
+  //-----------------------------------------------------------------------------
+  // Same format as std::fixed << std::setw(10) << std::setfill('0'), without the cost of a string stream
+  std::string FormatLogTime(double currentTime)
+  {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "|%010.6f|", currentTime);
+    return std::string(buffer);
+  }
+
+  //-----------------------------------------------------------------------------
+  std::string FormatLineNumber(int lineNumber)
+  {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "(%d)", lineNumber);
+    return std::string(buffer);
+  }
+
+  //-----------------------------------------------------------------------------
+  void AppendNarrowString(std::wstring& str, const char* narrowStr)
+  {
+    for (const char* c = narrowStr; *c != '\0'; ++c)
+    {
+      str += static_cast<wchar_t>(static_cast<unsigned char>(*c));
+    }
+  }
 }
 
+//-----------------------------------------------------------------------------
+struct vtkPlusLogger::LogRecord
+{
+  LogRecord()
+    : Level(LOG_LEVEL_UNDEFINED)
+    , OnlyShowMessage(false)
+    , WideCharacters(false)
+  {
+  }
+
+  LogLevelType Level;
+  bool OnlyShowMessage;
+  bool WideCharacters;
+  std::string Timestamp;
+  /*! Message without decoration, only set if OnlyShowMessage is true */
+  std::string Message;
+  /*! Message decorated with level, time, prefix and location */
+  std::string Line;
+  std::wstring WideMessage;
+  std::wstring WideLine;
+};
+
+//-----------------------------------------------------------------------------
+/*!
+  Bounded multi-producer single-consumer queue (based on the array based queue of Dmitry Vyukov).
+  Each slot has a sequence number that tells if the slot is free to be written at the current enqueue
+  position or it contains a record ready to be read at the current dequeue position. Producers reserve
+  a slot by atomically incrementing the enqueue position, so no locks are needed for adding a record.
+*/
+struct vtkPlusLogger::AsynchronousLoggingState
+{
+  struct Slot
+  {
+    std::atomic<size_t> Sequence;
+    LogRecord Record;
+  };
+
+  AsynchronousLoggingState()
+    : Enabled(false)
+    , ActiveProducers(0)
+    , OverflowPolicy(OVERFLOW_POLICY_DROP)
+    , NumberOfDroppedMessages(0)
+    , NumberOfReportedDroppedMessages(0)
+    , QueueSize(DEFAULT_ASYNCHRONOUS_LOGGING_QUEUE_SIZE)
+    , Slots(NULL)
+    , Capacity(0)
+    , EnqueuePosition(0)
+    , DequeuePosition(0)
+    , WakeUpRequested(false)
+    , StopRequested(false)
+    , Threader(vtkSmartPointer<vtkMultiThreader>::New())
+    , WriterThreadIndex(-1)
+  {
+  }
+
+  ~AsynchronousLoggingState()
+  {
+    delete[] this->Slots;
+  }
+
+  static size_t GetQueueCapacity(unsigned int queueSize)
+  {
+    // the capacity must be a power of two so that positions can be mapped to slots by masking
+    size_t capacity = 2;
+    while (capacity < queueSize)
+    {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  /*! Must only be called while the writer thread is not running */
+  void AllocateQueue(unsigned int queueSize)
+  {
+    size_t capacity = GetQueueCapacity(queueSize);
+    if (capacity != this->Capacity)
+    {
+      delete[] this->Slots;
+      this->Slots = new Slot[capacity];
+      this->Capacity = capacity;
+    }
+    for (size_t i = 0; i < capacity; i++)
+    {
+      this->Slots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+    this->EnqueuePosition.store(0, std::memory_order_relaxed);
+    this->DequeuePosition.store(0, std::memory_order_relaxed);
+  }
+
+  /*! Add a record to the queue. Returns false if the queue is full. The content of the record is swapped into the queue. */
+  bool TryEnqueue(LogRecord& record)
+  {
+    size_t position = this->EnqueuePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Slot& slot = this->Slots[position & (this->Capacity - 1)];
+      size_t sequence = slot.Sequence.load(std::memory_order_acquire);
+      if (sequence == position)
+      {
+        // slot is free, try to reserve it
+        if (this->EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          std::swap(slot.Record, record);
+          slot.Sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+        // another producer reserved the slot, position has been updated by compare_exchange_weak
+      }
+      else if (sequence < position)
+      {
+        // slot still contains a record from the previous round, the queue is full
+        return false;
+      }
+      else
+      {
+        // another producer has already filled this slot
+        position = this->EnqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /*! Remove the oldest record from the queue. Returns false if the queue is empty. Must only be called by the writer thread. */
+  bool TryDequeue(LogRecord& record)
+  {
+    size_t position = this->DequeuePosition.load(std::memory_order_relaxed);
+    Slot& slot = this->Slots[position & (this->Capacity - 1)];
+    if (slot.Sequence.load(std::memory_order_acquire) != position + 1)
+    {
+      // empty or the producer has not finished writing the record yet
+      return false;
+    }
+    std::swap(record, slot.Record);
+    slot.Sequence.store(position + this->Capacity, std::memory_order_release);
+    this->DequeuePosition.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /*! Approximate number of records in the queue */
+  size_t GetNumberOfQueuedRecords()
+  {
+    size_t enqueuePosition = this->EnqueuePosition.load(std::memory_order_relaxed);
+    size_t dequeuePosition = this->DequeuePosition.load(std::memory_order_relaxed);
+    return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+  }
+
+  void WakeUpWriter()
+  {
+    {
+      std::lock_guard<std::mutex> wakeUpLock(this->WakeUpMutex);
+      this->WakeUpRequested = true;
+    }
+    this->WakeUp.notify_one();
+  }
+
+  /*! Wait until there is space in the queue. Called by a producer after the queue was found to be full. */
+  void WaitForSpace()
+  {
+    this->WakeUpWriter();
+    std::unique_lock<std::mutex> producerLock(this->ProducerMutex);
+    this->SpaceAvailable.wait(producerLock, [this] { return this->GetNumberOfQueuedRecords() < this->Capacity; });
+  }
+
+  /*! Notify the producers that wait for space in the queue. Called by the writer thread after records were removed from the queue. */
+  void NotifySpaceAvailable()
+  {
+    {
+      // Locking the mutex makes sure that a producer that has just found the queue full is already waiting
+      std::lock_guard<std::mutex> producerLock(this->ProducerMutex);
+    }
+    this->SpaceAvailable.notify_all();
+  }
+
+  /*! Called by a producer when it is done with the queue */
+  void LeaveQueue()
+  {
+    if (--this->ActiveProducers == 0 && !this->Enabled)
+    {
+      // SetAsynchronousLogging(false) may be waiting for the producers to leave
+      {
+        std::lock_guard<std::mutex> producerLock(this->ProducerMutex);
+      }
+      this->ProducersLeft.notify_all();
+    }
+  }
+
+  /*! Wait until all producers have left the queue. Enabled must be set to false before calling this method. */
+  void WaitForProducersToLeave()
+  {
+    std::unique_lock<std::mutex> producerLock(this->ProducerMutex);
+    this->ProducersLeft.wait(producerLock, [this] { return this->ActiveProducers == 0; });
+  }
+
+  /*! Producers only add records to the queue if enabled */
+  std::atomic<bool> Enabled;
+  /*! Number of threads that are currently adding a record to the queue */
+  std::atomic<int> ActiveProducers;
+  std::atomic<OverflowPolicyType> OverflowPolicy;
+  std::atomic<unsigned long> NumberOfDroppedMessages;
+  /*! Number of dropped messages that has already been reported in the log, only accessed by the writer thread */
+  unsigned long NumberOfReportedDroppedMessages;
+
+  /*! Serializes changes of the configuration, protects QueueSize */
+  std::mutex ConfigurationMutex;
+  unsigned int QueueSize;
+
+  Slot* Slots;
+  size_t Capacity;
+  std::atomic<size_t> EnqueuePosition;
+  /*! Only modified by the writer thread */
+  std::atomic<size_t> DequeuePosition;
+
+  /*! Used by producers for waiting for space in the queue and by SetAsynchronousLogging(false) for waiting for the producers to leave */
+  std::mutex ProducerMutex;
+  std::condition_variable SpaceAvailable;
+  std::condition_variable ProducersLeft;
+
+  std::mutex WakeUpMutex;
+  std::condition_variable WakeUp;
+  bool WakeUpRequested;
+  bool StopRequested;
+
+  vtkSmartPointer<vtkMultiThreader> Threader;
+  int WriterThreadIndex;
+  std::atomic<std::thread::id> WriterThreadId;
+};
+
 //-----------------------------------------------------------------------------
 
 void vtkPlusLoggerOutputWindow::ReplaceNewlineBySeparator(std::string& str)
@@ -132,6 +414,7 @@ void vtkPlusLoggerOutputWindow::PrintSelf(ostream& os, vtkIndent indent)
 vtkPlusLogger::vtkPlusLogger()
 {
   m_CriticalSection = vtkPlusRecursiveCriticalSection::New();
+  m_AsynchronousLogging = new AsynchronousLoggingState;
 
   m_LogLevel = LOG_LEVEL_INFO;
 
@@ -145,6 +428,11 @@ vtkPlusLogger::vtkPlusLogger()
 //-------------------------------------------------------
 vtkPlusLogger::~vtkPlusLogger()
 {
+  // Write all queued messages and stop the writer thread
+  this->SetAsynchronousLogging(false);
+  delete this->m_AsynchronousLogging;
+  this->m_AsynchronousLogging = NULL;
+
   // Disconnect VTK error logging from the Plus logger (restore default VTK logging)
   vtkOutputWindow::SetInstance(NULL);
 
@@ -299,277 +587,408 @@ void vtkPlusLogger::LogMessage(LogLevelType level, const char* msg, const char*
     return;
   }
 
-  // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
-  bool onlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
+  LogRecord record;
+  this->FormatLogRecord(level, msg, fileName, lineNumber, optionalPrefix, record);
+  this->OutputLogRecord(record);
+}
 
-  std::string timestamp = vtkPlusAccurateTimer::GetInstance()->GetDateAndTimeMSecString();
+//----------------------------------------------------------------------------
+void vtkPlusLogger::LogMessage(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix /*= NULL*/)
+{
+  if (m_LogLevel < level)
+  {
+    // no need to log
+    return;
+  }
 
-  std::ostringstream log;
-  switch (level)
+  LogRecord record;
+  this->FormatLogRecord(level, msg, fileName, lineNumber, optionalPrefix, record);
+  this->OutputLogRecord(record);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::FormatLogRecord(LogLevelType level, const char* msg, const char* fileName, int lineNumber, const char* optionalPrefix, LogRecord& record)
+{
+  record.Level = level;
+  record.WideCharacters = false;
+  // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
+  record.OnlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
+  record.Timestamp = vtkPlusAccurateTimer::GetInstance()->GetDateAndTimeMSecString();
+  if (record.OnlyShowMessage)
   {
-    case LOG_LEVEL_ERROR:
-      log << "|ERROR";
-      break;
-    case LOG_LEVEL_WARNING:
-      log << "|WARNING";
-      break;
-    case LOG_LEVEL_INFO:
-      log << "|INFO";
-      break;
-    case LOG_LEVEL_DEBUG:
-      log << "|DEBUG";
-      break;
-    case LOG_LEVEL_TRACE:
-      log << "|TRACE";
-      break;
-    default:
-      log << "|UNKNOWN";
-      break;
+    record.Message = msg;
   }
 
-  // Add timestamp to the log message
-  double currentTime = vtkPlusAccurateTimer::GetSystemTime();
-  log << "|" << std::fixed << std::setw(10) << std::right << std::setfill('0') << currentTime << "|";
+  // The message is assembled by appending to a string, which is much faster than using a string stream
+  std::string& log = record.Line;
+  log.clear();
+  log += GetLogLevelPrefix(level);
+  log += FormatLogTime(vtkPlusAccurateTimer::GetSystemTime());
 
   // Either pad out the log or add the optional prefix and pad
   if (optionalPrefix != NULL)
   {
-    log << optionalPrefix << "> ";
+    log += optionalPrefix;
+    log += "> ";
   }
   else
   {
-    log << " ";
+    log += " ";
   }
 
-  log << msg;
+  log += msg;
 
   // Add the message to the log
   if (fileName != NULL)
   {
-    log << "| in " << fileName << "(" << lineNumber << ")"; // add filename and line number
+    // add filename and line number
+    log += "| in ";
+    log += fileName;
+    log += FormatLineNumber(lineNumber);
   }
+}
 
+//----------------------------------------------------------------------------
+void vtkPlusLogger::FormatLogRecord(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix, LogRecord& record)
+{
+  record.Level = level;
+  record.WideCharacters = true;
+  // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
+  record.OnlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
+  record.Timestamp = vtkPlusAccurateTimer::GetInstance()->GetDateAndTimeMSecString();
+  if (record.OnlyShowMessage)
   {
-    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
-
-    if (m_LogLevel >= level)
-    {
-
-#ifdef _WIN32
+    record.WideMessage = msg;
+  }
 
-      // Set the text color to highlight error and warning messages (supported only on windows)
-      switch (level)
-      {
-        case LOG_LEVEL_ERROR:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
-        }
-        break;
-        case LOG_LEVEL_WARNING:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-        }
-        break;
-        default:
-        {
-          HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-        }
-        break;
-      }
-#endif
+  std::wstring& log = record.WideLine;
+  log.clear();
+  AppendNarrowString(log, GetLogLevelPrefix(level));
+  AppendNarrowString(log, FormatLogTime(vtkPlusAccurateTimer::GetSystemTime()).c_str());
 
-      if (level > LOG_LEVEL_WARNING)
-      {
-        if (onlyShowMessage)
-        {
-          std::cout << msg << std::endl;
-        }
-        else
-        {
-          std::cout << log.str() << std::endl;
-        }
-      }
-      else
-      {
-        if (onlyShowMessage)
-        {
-          std::cerr << msg << std::endl;
-        }
-        else
-        {
-          std::cerr << log.str() << std::endl;
-        }
-      }
+  // Either pad out the log or add the optional prefix and pad
+  if (optionalPrefix != NULL)
+  {
+    log += optionalPrefix;
+    log += L"> ";
+  }
+  else
+  {
+    log += L" ";
+  }
 
-#ifdef _WIN32
-      // Revert the text color (supported only on windows)
-      if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
-      {
-        HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-        SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-      }
-#endif
+  log += msg;
 
-      // Call display message callbacks if higher priority than trace
-      if (level < LOG_LEVEL_TRACE)
-      {
-        std::ostringstream callDataStream;
-        callDataStream << level << "|" << log.str();
+  // Add the message to the log
+  if (fileName != NULL)
+  {
+    // add filename and line number
+    log += L"| in ";
+    AppendNarrowString(log, fileName);
+    AppendNarrowString(log, FormatLineNumber(lineNumber).c_str());
+  }
+}
 
-        InvokeEvent(vtkCommand::UserEvent, (void*)(callDataStream.str().c_str()));
-      }
+//----------------------------------------------------------------------------
+void vtkPlusLogger::OutputLogRecord(LogRecord& record)
+{
+  if (this->QueueLogRecord(record))
+  {
+    // the writer thread will take care of the message
+    return;
+  }
 
-      // Add to log stream (file)
-      std::string logStr(log.str());
-      std::wstring logWStr(logStr.begin(), logStr.end());
-      this->m_LogStream << std::setw(17) << std::left << std::wstring(timestamp.begin(), timestamp.end()) << logWStr;
-      this->m_LogStream << std::endl;
-    }
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
+    this->WriteLogRecord(record);
   }
 
   this->Flush();
 }
 
 //----------------------------------------------------------------------------
-void vtkPlusLogger::LogMessage(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix /*= NULL*/)
+void vtkPlusLogger::WriteLogRecord(const LogRecord& record)
 {
+  LogLevelType level = record.Level;
   if (m_LogLevel < level)
   {
-    // no need to log
+    // log level has been changed since the message was logged
     return;
   }
 
-  // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
-  bool onlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
-
-  std::string timestamp = vtkPlusAccurateTimer::GetInstance()->GetDateAndTimeMSecString();
-
-  std::wostringstream log;
+#ifdef _WIN32
+  // Set the text color to highlight error and warning messages (supported only on windows)
   switch (level)
   {
     case LOG_LEVEL_ERROR:
-      log << L"|ERROR";
-      break;
+    {
+      HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
+    }
+    break;
     case LOG_LEVEL_WARNING:
-      log << L"|WARNING";
-      break;
-    case LOG_LEVEL_INFO:
-      log << L"|INFO";
-      break;
-    case LOG_LEVEL_DEBUG:
-      log << L"|DEBUG";
-      break;
-    case LOG_LEVEL_TRACE:
-      log << L"|TRACE";
-      break;
+    {
+      HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    }
+    break;
     default:
-      log << L"|UNKNOWN";
-      break;
+    {
+      HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+    }
+    break;
   }
+#endif
 
-  // Add timestamp to the log message
-  double currentTime = vtkPlusAccurateTimer::GetSystemTime();
-  log << L"|" << std::fixed << std::setw(10) << std::right << std::setfill(L'0') << currentTime << L"|";
+  if (record.WideCharacters)
+  {
+    std::wostream& console = (level > LOG_LEVEL_WARNING) ? std::wcout : std::wcerr;
+    console << (record.OnlyShowMessage ? record.WideMessage : record.WideLine) << std::endl;
+  }
+  else
+  {
+    std::ostream& console = (level > LOG_LEVEL_WARNING) ? std::cout : std::cerr;
+    console << (record.OnlyShowMessage ? record.Message : record.Line) << std::endl;
+  }
 
-  // Either pad out the log or add the optional prefix and pad
-  if (optionalPrefix != NULL)
+#ifdef _WIN32
+  // Revert the text color (supported only on windows)
+  if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
+  {
+    HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+    SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+  }
+#endif
+
+  // Call display message callbacks if higher priority than trace
+  if (level < LOG_LEVEL_TRACE)
+  {
+    if (record.WideCharacters)
+    {
+      std::wostringstream callDataStream;
+      callDataStream << level << L"|" << record.WideLine;
+      InvokeEvent(vtkCommand::UserEvent, (void*)(callDataStream.str().c_str()));
+    }
+    else
+    {
+      std::ostringstream callDataStream;
+      callDataStream << level << "|" << record.Line;
+      InvokeEvent(vtkCommand::UserEvent, (void*)(callDataStream.str().c_str()));
+    }
+  }
+
+  // Add to log stream (file), this may introduce conversion issues going from wstring to string
+  this->m_LogStream << std::setw(17) << std::left << std::wstring(record.Timestamp.begin(), record.Timestamp.end());
+  if (record.WideCharacters)
   {
-    log << optionalPrefix << L"> ";
+    this->m_LogStream << record.WideLine;
   }
   else
   {
-    log << L" ";
+    this->m_LogStream << std::wstring(record.Line.begin(), record.Line.end());
+  }
+  this->m_LogStream << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusLogger::QueueLogRecord(LogRecord& record)
+{
+  AsynchronousLoggingState* state = this->m_AsynchronousLogging;
+  if (!state->Enabled)
+  {
+    return false;
   }
 
-  log << msg;
+  // Register this thread as a producer before checking again if asynchronous logging is enabled,
+  // so that SetAsynchronousLogging(false) can wait until all producers have left the queue
+  state->ActiveProducers++;
+  if (!state->Enabled || std::this_thread::get_id() == state->WriterThreadId.load())
+  {
+    // Messages that are logged while the queue is being disabled or by the writer thread itself
+    // (e.g., by an observer of the log messages) are written immediately
+    state->LeaveQueue();
+    return false;
+  }
 
-  // Add the message to the log
-  if (fileName != NULL)
+  LogLevelType level = record.Level;
+  while (!state->TryEnqueue(record))
+  {
+    if (state->OverflowPolicy == OVERFLOW_POLICY_DROP && level > LOG_LEVEL_WARNING)
+    {
+      state->NumberOfDroppedMessages++;
+      state->LeaveQueue();
+      return true;
+    }
+    state->WaitForSpace();
+  }
+
+  // Errors and warnings are written without waiting for the end of the write interval.
+  // Also wake up the writer if the queue is getting full to reduce the chance of overflow.
+  if (level <= LOG_LEVEL_WARNING || state->GetNumberOfQueuedRecords() >= state->Capacity / 2)
   {
-    log << L"| in " << fileName << L"(" << lineNumber << L")"; // add filename and line number
+    state->WakeUpWriter();
   }
 
+  state->LeaveQueue();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusLogger::WriteQueuedLogRecords()
+{
+  AsynchronousLoggingState* state = this->m_AsynchronousLogging;
+
+  // Write at most one queue worth of messages per batch to make sure that the file is flushed
+  // regularly even if the queue is continuously refilled
+  size_t numberOfWrittenRecords = 0;
   {
     PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
 
-    if (m_LogLevel >= level)
+    LogRecord record;
+    while (numberOfWrittenRecords < state->Capacity && state->TryDequeue(record))
     {
-#ifdef _WIN32
-      // Set the text color to highlight error and warning messages (supported only on windows)
-      switch (level)
-      {
-        case LOG_LEVEL_ERROR:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
-        }
-        break;
-        case LOG_LEVEL_WARNING:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-        }
-        break;
-        default:
-        {
-          HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-        }
-        break;
-      }
-#endif
+      this->WriteLogRecord(record);
+      numberOfWrittenRecords++;
+    }
 
-      if (level > LOG_LEVEL_WARNING)
-      {
-        if (onlyShowMessage)
-        {
-          std::wcout << msg << std::endl;
-        }
-        else
-        {
-          std::wcout << log.str() << std::endl;
-        }
-      }
-      else
-      {
-        if (onlyShowMessage)
-        {
-          std::wcerr << msg << std::endl;
-        }
-        else
-        {
-          std::wcerr << log.str() << std::endl;
-        }
-      }
+    unsigned long numberOfDroppedMessages = state->NumberOfDroppedMessages;
+    if (numberOfDroppedMessages != state->NumberOfReportedDroppedMessages)
+    {
+      std::ostringstream msg;
+      msg << (numberOfDroppedMessages - state->NumberOfReportedDroppedMessages)
+          << " log messages were dropped because the asynchronous logging queue was full";
+      this->FormatLogRecord(LOG_LEVEL_WARNING, msg.str().c_str(), "vtkPlusLogger", __LINE__, NULL, record);
+      this->WriteLogRecord(record);
+      state->NumberOfReportedDroppedMessages = numberOfDroppedMessages;
+      numberOfWrittenRecords++;
+    }
+  }
 
-#ifdef _WIN32
-      // Revert the text color (supported only on windows)
-      if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
+  if (numberOfWrittenRecords > 0)
+  {
+    state->NotifySpaceAvailable();
+    this->Flush();
+  }
+
+  return numberOfWrittenRecords >= state->Capacity;
+}
+
+//----------------------------------------------------------------------------
+void* vtkPlusLogger::AsynchronousLoggingThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusLogger* self = (vtkPlusLogger*)(data->UserData);
+  AsynchronousLoggingState* state = self->m_AsynchronousLogging;
+  state->WriterThreadId = std::this_thread::get_id();
+
+  bool moreRecordsQueued = false;
+  while (true)
+  {
+    // Stop is only requested after all producers have left the queue, so if stop has been requested
+    // before writing the records then no more records can be added to the queue after this batch
+    bool stopRequested = false;
+    {
+      std::unique_lock<std::mutex> wakeUpLock(state->WakeUpMutex);
+      if (!moreRecordsQueued)
       {
-        HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-        SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+        state->WakeUp.wait_for(wakeUpLock, std::chrono::milliseconds(ASYNCHRONOUS_LOGGING_WRITE_INTERVAL_MS),
+                               [state] { return state->WakeUpRequested || state->StopRequested; });
       }
-#endif
+      state->WakeUpRequested = false;
+      stopRequested = state->StopRequested;
+    }
 
-      // Call display message callbacks if higher priority than trace
-      if (level < LOG_LEVEL_TRACE)
-      {
-        std::wostringstream callDataStream;
-        callDataStream << level << L"|" << log.str();
+    moreRecordsQueued = self->WriteQueuedLogRecords();
+    if (stopRequested && !moreRecordsQueued)
+    {
+      break;
+    }
+  }
 
-        InvokeEvent(vtkCommand::UserEvent, (void*)(callDataStream.str().c_str()));
-      }
+  state->WriterThreadId = std::thread::id();
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousLogging(bool enable)
+{
+  AsynchronousLoggingState* state = this->m_AsynchronousLogging;
+  std::lock_guard<std::mutex> configurationLock(state->ConfigurationMutex);
+
+  if (enable == (state->WriterThreadIndex >= 0))
+  {
+    // no change
+    return;
+  }
 
-      // Add to log stream (file), this may introduce conversion issues going from wstring to string
-      this->m_LogStream << std::setw(17) << std::left << std::wstring(timestamp.begin(), timestamp.end()) << log.str();
-      this->m_LogStream << std::endl;
+  if (enable)
+  {
+    state->AllocateQueue(state->QueueSize);
+    state->StopRequested = false;
+    state->WakeUpRequested = false;
+    state->NumberOfReportedDroppedMessages = state->NumberOfDroppedMessages;
+    state->WriterThreadIndex = state->Threader->SpawnThread((vtkThreadFunctionType)&AsynchronousLoggingThread, this);
+    if (state->WriterThreadIndex < 0)
+    {
+      LOG_ERROR("Failed to start asynchronous logging thread, messages are written synchronously");
+      return;
+    }
+    state->Enabled = true;
+  }
+  else
+  {
+    // New messages are written synchronously from now on. Wait until the messages that are being queued
+    // right now are in the queue, then let the writer thread write all the remaining messages and exit.
+    state->Enabled = false;
+    state->WaitForProducersToLeave();
+    {
+      std::lock_guard<std::mutex> wakeUpLock(state->WakeUpMutex);
+      state->StopRequested = true;
     }
+    state->WakeUp.notify_one();
+    state->Threader->TerminateThread(state->WriterThreadIndex);
+    state->WriterThreadIndex = -1;
   }
+}
 
-  this->Flush();
+//----------------------------------------------------------------------------
+bool vtkPlusLogger::GetAsynchronousLogging()
+{
+  return this->m_AsynchronousLogging->Enabled;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousLoggingQueueSize(unsigned int queueSize)
+{
+  AsynchronousLoggingState* state = this->m_AsynchronousLogging;
+  std::lock_guard<std::mutex> configurationLock(state->ConfigurationMutex);
+  state->QueueSize = queueSize;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkPlusLogger::GetAsynchronousLoggingQueueSize()
+{
+  AsynchronousLoggingState* state = this->m_AsynchronousLogging;
+  std::lock_guard<std::mutex> configurationLock(state->ConfigurationMutex);
+  return static_cast<unsigned int>(AsynchronousLoggingState::GetQueueCapacity(state->QueueSize));
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousLoggingOverflowPolicy(OverflowPolicyType policy)
+{
+  this->m_AsynchronousLogging->OverflowPolicy = policy;
+}
+
+//----------------------------------------------------------------------------
+vtkPlusLogger::OverflowPolicyType vtkPlusLogger::GetAsynchronousLoggingOverflowPolicy()
+{
+  return this->m_AsynchronousLogging->OverflowPolicy;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusLogger::GetNumberOfDroppedMessages()
+{
+  return this->m_AsynchronousLogging->NumberOfDroppedMessages;
 }
 
 //-------------------------------------------------------
@@ -9,6 +9,7 @@
 
 #include "vtkPlusCommonExport.h"
 
+#include "vtkMultiThreader.h"
 #include "vtkObject.h"
 #include "vtkOutputWindow.h"
 #include <fstream>
@@ -78,6 +79,11 @@ private:
   \class vtkPlusLogger
   \brief This singleton class provides logging into file and/or the console
   with adjustable verbosity.
+
+  By default messages are written to the console and the log file by the thread that logs the message.
+  If asynchronous logging is enabled then LogMessage only formats the message and adds it to a lock-free
+  queue, which is emptied by a background thread that writes the messages in batches. This way threads
+  that log messages (e.g., data acquisition threads) never wait for console or disk output.
   \ingroup PlusLibCommon
 */
 class vtkPlusCommonExport vtkPlusLogger : public vtkObject
@@ -116,6 +122,18 @@ public:
     LOG_LEVEL_UNDEFINED = 100
   };
 
+  /*! Policy for messages that are logged while the asynchronous logging queue is full */
+  enum OverflowPolicyType
+  {
+    /*! The thread that logs the message waits until there is space in the queue, no messages are lost */
+    OVERFLOW_POLICY_BLOCK,
+    /*!
+      Info, debug and trace messages are dropped, errors and warnings wait until there is space in the queue.
+      The number of dropped messages is written to the log.
+    */
+    OVERFLOW_POLICY_DROP
+  };
+
   static int UnlimitedLogMessages() { return -1; };
 
   /*!  Get a pointer to the single existing object instance */
@@ -169,6 +187,32 @@ public:
   /*! Get the name of the file where the messages are logged to */
   std::string GetLogFileName();
 
+  /*!
+    Enable/disable asynchronous logging (see class description). Disabled by default.
+    Disabling asynchronous logging writes all queued messages before it returns.
+    Applications that enable asynchronous logging must disable it before exiting, otherwise
+    the last queued messages may be lost.
+  */
+  void SetAsynchronousLogging(bool enable);
+  /*! Returns true if asynchronous logging is enabled */
+  bool GetAsynchronousLogging();
+
+  /*!
+    Set the maximum number of messages in the asynchronous logging queue (rounded up to a power of two).
+    The new size is used when asynchronous logging is enabled next time. Default is 4096.
+  */
+  void SetAsynchronousLoggingQueueSize(unsigned int queueSize);
+  /*! Get the maximum number of messages in the asynchronous logging queue */
+  unsigned int GetAsynchronousLoggingQueueSize();
+
+  /*! Set what happens to a message that is logged while the asynchronous logging queue is full. Default is OVERFLOW_POLICY_DROP. */
+  void SetAsynchronousLoggingOverflowPolicy(OverflowPolicyType policy);
+  /*! Get what happens to a message that is logged while the asynchronous logging queue is full */
+  OverflowPolicyType GetAsynchronousLoggingOverflowPolicy();
+
+  /*! Get the number of messages that were dropped because the asynchronous logging queue was full */
+  unsigned long GetNumberOfDroppedMessages();
+
 protected:
   vtkPlusLogger();
   ~vtkPlusLogger();
@@ -180,6 +224,36 @@ private:
   vtkPlusLogger(vtkPlusLogger const&);
   vtkPlusLogger& operator=(vtkPlusLogger const&);
 
+  /*! Formatted log message, defined in the implementation file */
+  struct LogRecord;
+  /*! Queue and writer thread of asynchronous logging, defined in the implementation file */
+  struct AsynchronousLoggingState;
+
+  /*! Format a message into a log record. Called by the thread that logs the message. */
+  void FormatLogRecord(LogLevelType level, const char* msg, const char* fileName, int lineNumber, const char* optionalPrefix, LogRecord& record);
+  void FormatLogRecord(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix, LogRecord& record);
+
+  /*! Add the record to the asynchronous logging queue or write it immediately if asynchronous logging is disabled */
+  void OutputLogRecord(LogRecord& record);
+
+  /*!
+    Add the record to the asynchronous logging queue.
+    Returns false if the record has to be written by the caller (asynchronous logging is disabled or the caller is the writer thread).
+  */
+  bool QueueLogRecord(LogRecord& record);
+
+  /*! Write a record to the console and to the log stream and notify observers. The caller must lock m_CriticalSection. */
+  void WriteLogRecord(const LogRecord& record);
+
+  /*!
+    Write the records from the asynchronous logging queue. Called by the writer thread.
+    Returns true if the batch size limit was reached and there may be more records in the queue.
+  */
+  bool WriteQueuedLogRecords();
+
+  /*! Thread that writes the queued messages when asynchronous logging is enabled */
+  static void* AsynchronousLoggingThread(vtkMultiThreader::ThreadInfo* data);
+
   /*! Pointer to the singleton instance */
   static vtkPlusLogger*   m_pInstance;
   /*! Log level used for controlling the verbosity of the logging */
@@ -197,6 +271,9 @@ private:
     threads simultaneously.
   */
   vtkPlusRecursiveCriticalSection* m_CriticalSection;
+
+  /*! State of asynchronous logging */
+  AsynchronousLoggingState* m_AsynchronousLogging;
 };
 
 #endif
\ No newline at end of file
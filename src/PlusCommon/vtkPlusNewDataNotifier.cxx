@@ -0,0 +1,63 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+
+#include "vtkPlusNewDataNotifier.h"
+#include "vtkObjectFactory.h"
+
+#include <chrono>
+
+vtkStandardNewMacro(vtkPlusNewDataNotifier);
+
+//----------------------------------------------------------------------------
+vtkPlusNewDataNotifier::vtkPlusNewDataNotifier()
+  : NotificationCount(0)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkPlusNewDataNotifier::~vtkPlusNewDataNotifier()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusNewDataNotifier::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NotificationCount: " << this->GetNotificationCount() << std::endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusNewDataNotifier::NotifyNewData()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->NotificationCount++;
+  }
+  this->NewDataAvailable.notify_all();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusNewDataNotifier::GetNotificationCount()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->NotificationCount;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusNewDataNotifier::WaitForNewData(unsigned long& lastNotificationCount, double timeoutSec)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  bool notified = true;
+  if (this->NotificationCount == lastNotificationCount)
+  {
+    std::chrono::microseconds timeout(static_cast<long long>(timeoutSec > 0 ? timeoutSec * 1e6 : 0));
+    notified = this->NewDataAvailable.wait_for(lock, timeout, [this, &lastNotificationCount]() { return this->NotificationCount != lastNotificationCount; });
+  }
+  lastNotificationCount = this->NotificationCount;
+  return notified;
+}
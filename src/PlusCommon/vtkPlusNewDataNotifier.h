@@ -0,0 +1,60 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusNewDataNotifier_h
+#define __vtkPlusNewDataNotifier_h
+
+#include "vtkPlusCommonExport.h"
+
+#include <vtkObject.h>
+
+#include <condition_variable>
+#include <mutex>
+
+/*!
+  \class vtkPlusNewDataNotifier
+  \brief Allows a thread to sleep until new data is available instead of polling at a fixed rate
+
+  Data producers (e.g., vtkPlusBuffer when an item is added) call NotifyNewData. Consumers remember the
+  notification count and call WaitForNewData, which returns as soon as a newer notification arrives
+  or the timeout elapses, whichever comes first.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport vtkPlusNewDataNotifier : public vtkObject
+{
+public:
+  static vtkPlusNewDataNotifier* New();
+  vtkTypeMacro(vtkPlusNewDataNotifier, vtkObject);
+  virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /*! Signal that new data is available. Wakes up all threads that are waiting in WaitForNewData. */
+  void NotifyNewData();
+
+  /*! Get the number of notifications so far */
+  unsigned long GetNotificationCount();
+
+  /*!
+    Wait until a notification arrives that is newer than lastNotificationCount or timeoutSec elapses.
+    lastNotificationCount is updated to the current notification count.
+    \return true if new data was notified, false on timeout
+  */
+  bool WaitForNewData(unsigned long& lastNotificationCount, double timeoutSec);
+
+protected:
+  vtkPlusNewDataNotifier();
+  virtual ~vtkPlusNewDataNotifier();
+
+  std::mutex Mutex;
+  std::condition_variable NewDataAvailable;
+  unsigned long NotificationCount;
+
+private:
+  vtkPlusNewDataNotifier(const vtkPlusNewDataNotifier&);  // Not implemented.
+  void operator=(const vtkPlusNewDataNotifier&);  // Not implemented.
+};
+
+#endif
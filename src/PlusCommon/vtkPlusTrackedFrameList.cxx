@@ -26,6 +26,7 @@ vtkStandardNewMacro(vtkPlusTrackedFrameList);
 
 //----------------------------------------------------------------------------
 vtkPlusTrackedFrameList::vtkPlusTrackedFrameList()
+  : PixelDataLoader(NULL)
 {
   this->SetNumberOfUniqueFrames(5);
 
@@ -52,6 +53,10 @@ PlusStatus vtkPlusTrackedFrameList::RemoveTrackedFrame(int frameNumber)
     return PLUS_FAIL;
   }
 
+  if (this->PixelDataLoader != NULL)
+  {
+    this->PixelDataLoader->OnTrackedFramesRemoved(frameNumber, frameNumber);
+  }
   delete this->TrackedFrameList[frameNumber];
   this->TrackedFrameList.erase(this->TrackedFrameList.begin() + frameNumber);
 
@@ -67,6 +72,11 @@ PlusStatus vtkPlusTrackedFrameList::RemoveTrackedFrameRange(unsigned int frameNu
     return PLUS_FAIL;
   }
 
+  if (this->PixelDataLoader != NULL)
+  {
+    this->PixelDataLoader->OnTrackedFramesRemoved(frameNumberFrom, frameNumberTo);
+  }
+
   for (unsigned int i = frameNumberFrom; i <= frameNumberTo; ++i)
   {
     delete this->TrackedFrameList[i];
@@ -80,6 +90,10 @@ PlusStatus vtkPlusTrackedFrameList::RemoveTrackedFrameRange(unsigned int frameNu
 //----------------------------------------------------------------------------
 void vtkPlusTrackedFrameList::Clear()
 {
+  if (this->PixelDataLoader != NULL && !this->TrackedFrameList.empty())
+  {
+    this->PixelDataLoader->OnTrackedFramesRemoved(0, this->TrackedFrameList.size() - 1);
+  }
   for (unsigned int i = 0; i < this->TrackedFrameList.size(); i++)
   {
     if (this->TrackedFrameList[i] != NULL)
@@ -111,6 +125,10 @@ PlusTrackedFrame* vtkPlusTrackedFrameList::GetTrackedFrame(int frameNumber)
     LOG_ERROR("vtkPlusTrackedFrameList::GetTrackedFrame requested a non-existing frame (framenumber=" << frameNumber);
     return NULL;
   }
+  if (this->PixelDataLoader != NULL)
+  {
+    this->PixelDataLoader->OnTrackedFrameAccessed(frameNumber);
+  }
   return this->TrackedFrameList[frameNumber];
 }
 
@@ -123,9 +141,25 @@ PlusTrackedFrame* vtkPlusTrackedFrameList::GetTrackedFrame(unsigned int frameNum
     LOG_ERROR("vtkPlusTrackedFrameList::GetTrackedFrame requested a non-existing frame (framenumber=" << frameNumber);
     return NULL;
   }
+  if (this->PixelDataLoader != NULL)
+  {
+    this->PixelDataLoader->OnTrackedFrameAccessed(frameNumber);
+  }
   return this->TrackedFrameList[frameNumber];
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusTrackedFrameList::SetPixelDataLoader(vtkPlusSequenceIOBase* loader)
+{
+  this->PixelDataLoader = loader;
+}
+
+//----------------------------------------------------------------------------
+vtkPlusSequenceIOBase* vtkPlusTrackedFrameList::GetPixelDataLoader() const
+{
+  return this->PixelDataLoader;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTrackedFrameList::AddTrackedFrameList(vtkPlusTrackedFrameList* inTrackedFrameList, InvalidFrameAction action /*=ADD_INVALID_FRAME_AND_REPORT_ERROR*/)
 {
@@ -899,11 +933,12 @@ double vtkPlusTrackedFrameList::GetMostRecentTimestamp()
 {
   double mostRecentTimestamp = 0.0;
 
-  for (unsigned int i = 0; i < this->GetNumberOfTrackedFrames(); ++i)
+  // Only the timestamps are needed, so pixel data is not loaded
+  for (TrackedFrameListType::iterator it = this->TrackedFrameList.begin(); it != this->TrackedFrameList.end(); ++it)
   {
-    if (this->GetTrackedFrame(i)->GetTimestamp() > mostRecentTimestamp)
+    if ((*it)->GetTimestamp() > mostRecentTimestamp)
     {
-      mostRecentTimestamp = this->GetTrackedFrame(i)->GetTimestamp();
+      mostRecentTimestamp = (*it)->GetTimestamp();
     }
   }
 
@@ -18,6 +18,7 @@
 class vtkXMLDataElement;
 class PlusTrackedFrame;
 class vtkMatrix4x4;
+class vtkPlusSequenceIOBase;
 
 
 /*!
@@ -65,7 +66,11 @@ public:
   /*! Add all frames from a tracked frame list to the container. It adds all invalid frames as well, but an error is reported. */
   virtual PlusStatus AddTrackedFrameList(vtkPlusTrackedFrameList* inTrackedFrameList, InvalidFrameAction action = ADD_INVALID_FRAME_AND_REPORT_ERROR);
 
-  /*! Get tracked frame from container */
+  /*!
+    Get tracked frame from container.
+    If the list was read from a sequence file with lazy pixel data loading then the pixel data of the frame is loaded before it is returned
+    (see vtkPlusSequenceIOBase::SetLazyPixelDataLoading).
+  */
   virtual PlusTrackedFrame* GetTrackedFrame(int frameNumber);
   virtual PlusTrackedFrame* GetTrackedFrame(unsigned int frameNumber);
 
@@ -88,7 +93,11 @@ public:
   /*! Read the tracked data from Nrrd file */
   virtual PlusStatus ReadFromNrrdFile(const std::string& trackedSequenceDataFileName);
 
-  /*! Get the tracked frame list */
+  /*!
+    Get the tracked frame list.
+    Frames are returned as they are stored: if pixel data is loaded lazily then frames that have not been accessed
+    through GetTrackedFrame() have no pixel data yet.
+  */
   TrackedFrameListType GetTrackedFrameList()
   {
     return this->TrackedFrameList;
@@ -229,7 +238,17 @@ public:
   /*! Return true if the list contains at least one valid image frame */
   bool IsContainingValidImageData();
 
-  /*! Implement support for C++11 ranged for loops */
+  /*!
+    Set the sequence file reader that loads the pixel data of the frames when they are accessed by GetTrackedFrame().
+    It is set by vtkPlusSequenceIOBase in lazy pixel data loading mode and it is not reference counted (the reader holds a reference to this list).
+  */
+  void SetPixelDataLoader(vtkPlusSequenceIOBase* loader);
+  vtkPlusSequenceIOBase* GetPixelDataLoader() const;
+
+  /*!
+    Implement support for C++11 ranged for loops.
+    Iterators do not load pixel data, see GetTrackedFrameList().
+  */
   TrackedFrameListType::iterator begin();
   TrackedFrameListType::iterator end();
   TrackedFrameListType::const_iterator begin() const;
@@ -275,6 +294,9 @@ protected:
   long ValidationRequirements;
   PlusTransformName FrameTransformNameForValidation;
 
+  /*! Loads pixel data of frames on access, NULL if all frames are in memory (see SetPixelDataLoader) */
+  vtkPlusSequenceIOBase* PixelDataLoader;
+
 private:
   vtkPlusTrackedFrameList(const vtkPlusTrackedFrameList&);
   void operator=(const vtkPlusTrackedFrameList&);
@@ -16,6 +16,18 @@
 
 vtkStandardNewMacro(vtkPlusTransformRepository);
 
+namespace
+{
+  const double IDENTITY_MATRIX_ELEMENTS[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+  //----------------------------------------------------------------------------
+  /*! Compute accumulated * transform (same order as vtkTransform::Concatenate in PreMultiply mode) */
+  void ConcatenateMatrixElements(const double accumulated[16], vtkTransform* transform, double result[16])
+  {
+    vtkMatrix4x4::Multiply4x4(accumulated, &(transform->GetMatrix()->Element[0][0]), result);
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkPlusTransformRepository::TransformInfo::TransformInfo()
   : m_Transform(vtkTransform::New())
@@ -243,6 +255,9 @@ PlusStatus vtkPlusTransformRepository::SetTransform(const PlusTransformName& aTr
     return PLUS_FAIL;
   }
 
+  // The transform graph topology changes, discard the stored paths
+  this->InvalidateTransformPathCache();
+
   // Create the from->to transform
   CoordFrameToTransformMapType& fromCoordFrame = this->CoordinateFrames[aTransformName.From()];
   fromCoordFrame[aTransformName.To()].m_IsComputed = false;
@@ -298,21 +313,26 @@ PlusStatus vtkPlusTransformRepository::GetTransform(const PlusTransformName& aTr
   PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
 
   // Check if we can find the transform by combining the input transforms
-  // To improve performance the already found paths could be stored in a map of transform name -> transformInfoList
-  TransformInfoListType transformInfoList;
-  if (FindPath(aTransformName, transformInfoList) != PLUS_SUCCESS)
+  const TransformInfoPathType* transformInfoPath = NULL;
+  if (this->GetTransformPath(aTransformName, transformInfoPath) != PLUS_SUCCESS)
   {
     // the transform cannot be computed, error has been already logged by FindPath
-    *isValid = false;
+    if (isValid != NULL)
+    {
+      (*isValid) = false;
+    }
     return PLUS_FAIL;
   }
 
-  // Create transform chain and compute transform status
-  vtkSmartPointer<vtkTransform> combinedTransform = vtkSmartPointer<vtkTransform>::New();
+  // Concatenate the transforms and compute transform status
+  double combinedMatrixElements[16];
+  std::copy(IDENTITY_MATRIX_ELEMENTS, IDENTITY_MATRIX_ELEMENTS + 16, combinedMatrixElements);
   bool combinedTransformValid(true);
-  for (TransformInfoListType::iterator transformInfo = transformInfoList.begin(); transformInfo != transformInfoList.end(); ++transformInfo)
+  for (TransformInfoPathType::const_iterator transformInfo = transformInfoPath->begin(); transformInfo != transformInfoPath->end(); ++transformInfo)
   {
-    combinedTransform->Concatenate((*transformInfo)->m_Transform);
+    double concatenatedMatrixElements[16];
+    ConcatenateMatrixElements(combinedMatrixElements, (*transformInfo)->m_Transform, concatenatedMatrixElements);
+    std::copy(concatenatedMatrixElements, concatenatedMatrixElements + 16, combinedMatrixElements);
     if (!(*transformInfo)->m_IsValid)
     {
       combinedTransformValid = false;
@@ -321,7 +341,7 @@ PlusStatus vtkPlusTransformRepository::GetTransform(const PlusTransformName& aTr
   // Save the results
   if (matrix != NULL)
   {
-    matrix->DeepCopy(combinedTransform->GetMatrix());
+    matrix->DeepCopy(combinedMatrixElements);
   }
 
   if (isValid != NULL)
@@ -332,6 +352,116 @@ PlusStatus vtkPlusTransformRepository::GetTransform(const PlusTransformName& aTr
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusTransformRepository::GetTransforms(const std::vector<PlusTransformName>& transformNames, const std::vector<vtkMatrix4x4*>& matrices, std::vector<bool>* isValid /*=NULL*/)
+{
+  if (transformNames.size() != matrices.size())
+  {
+    LOG_ERROR("Unable to get transforms: number of transform names (" << transformNames.size() << ") and matrices (" << matrices.size() << ") differ");
+    return PLUS_FAIL;
+  }
+  if (isValid != NULL)
+  {
+    isValid->assign(transformNames.size(), false);
+  }
+
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
+
+  // For each already evaluated path store the product and validity of all its prefixes,
+  // so that the common beginning of the following paths does not have to be concatenated again
+  struct EvaluatedPath
+  {
+    const TransformInfoPathType* Path;
+    std::vector<double> PrefixMatrixElements; // 16 elements for each prefix length
+    std::vector<bool> PrefixValid;
+  };
+  std::vector<EvaluatedPath> evaluatedPaths;
+  evaluatedPaths.reserve(transformNames.size());
+
+  int numberOfErrors(0);
+  for (std::vector<PlusTransformName>::size_type transformIndex = 0; transformIndex < transformNames.size(); ++transformIndex)
+  {
+    const PlusTransformName& transformName = transformNames[transformIndex];
+    vtkMatrix4x4* matrix = matrices[transformIndex];
+    if (!transformName.IsValid())
+    {
+      LOG_ERROR("Transform name is invalid");
+      numberOfErrors++;
+      continue;
+    }
+    if (transformName.From() == transformName.To())
+    {
+      if (matrix != NULL)
+      {
+        matrix->Identity();
+      }
+      if (isValid != NULL)
+      {
+        (*isValid)[transformIndex] = true;
+      }
+      continue;
+    }
+
+    const TransformInfoPathType* transformInfoPath = NULL;
+    if (this->GetTransformPath(transformName, transformInfoPath) != PLUS_SUCCESS || transformInfoPath->empty())
+    {
+      // error has been already logged by FindPath
+      numberOfErrors++;
+      continue;
+    }
+
+    // Find the already evaluated path that has the longest common prefix with this path
+    const EvaluatedPath* bestMatchingPath = NULL;
+    std::size_t commonPrefixLength = 0;
+    for (std::vector<EvaluatedPath>::const_iterator evaluatedPath = evaluatedPaths.begin(); evaluatedPath != evaluatedPaths.end(); ++evaluatedPath)
+    {
+      std::size_t maxLength = std::min(evaluatedPath->Path->size(), transformInfoPath->size());
+      std::size_t length = 0;
+      while (length < maxLength && (*evaluatedPath->Path)[length] == (*transformInfoPath)[length])
+      {
+        ++length;
+      }
+      if (length > commonPrefixLength)
+      {
+        commonPrefixLength = length;
+        bestMatchingPath = &(*evaluatedPath);
+      }
+    }
+
+    EvaluatedPath currentPath;
+    currentPath.Path = transformInfoPath;
+    currentPath.PrefixMatrixElements.resize(16 * transformInfoPath->size());
+    currentPath.PrefixValid.resize(transformInfoPath->size());
+    for (std::size_t i = 0; i < transformInfoPath->size(); ++i)
+    {
+      double* prefixMatrixElements = &currentPath.PrefixMatrixElements[16 * i];
+      if (i < commonPrefixLength)
+      {
+        std::copy(&bestMatchingPath->PrefixMatrixElements[16 * i], &bestMatchingPath->PrefixMatrixElements[16 * i] + 16, prefixMatrixElements);
+        currentPath.PrefixValid[i] = bestMatchingPath->PrefixValid[i];
+        continue;
+      }
+      TransformInfo* transformInfo = (*transformInfoPath)[i];
+      const double* previousMatrixElements = (i == 0 ? IDENTITY_MATRIX_ELEMENTS : &currentPath.PrefixMatrixElements[16 * (i - 1)]);
+      ConcatenateMatrixElements(previousMatrixElements, transformInfo->m_Transform, prefixMatrixElements);
+      currentPath.PrefixValid[i] = (i == 0 ? true : currentPath.PrefixValid[i - 1]) && transformInfo->m_IsValid;
+    }
+
+    // Save the results
+    if (matrix != NULL)
+    {
+      matrix->DeepCopy(&currentPath.PrefixMatrixElements[16 * (transformInfoPath->size() - 1)]);
+    }
+    if (isValid != NULL)
+    {
+      (*isValid)[transformIndex] = currentPath.PrefixValid.back();
+    }
+    evaluatedPaths.push_back(currentPath);
+  }
+
+  return (numberOfErrors == 0 ? PLUS_SUCCESS : PLUS_FAIL);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTransformRepository::GetTransformValid(const PlusTransformName& aTransformName, bool& isValid)
 {
@@ -552,8 +682,8 @@ PlusStatus vtkPlusTransformRepository::IsExistingTransform(PlusTransformName aTr
     return PLUS_SUCCESS;
   }
   PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
-  TransformInfoListType transformInfoList;
-  return FindPath(aTransformName, transformInfoList, NULL, aSilent);
+  const TransformInfoPathType* transformInfoPath = NULL;
+  return this->GetTransformPath(aTransformName, transformInfoPath, aSilent);
 }
 
 //----------------------------------------------------------------------------
@@ -570,6 +700,12 @@ PlusStatus vtkPlusTransformRepository::DeleteTransform(const PlusTransformName&
   CoordFrameToTransformMapType& fromCoordFrame = this->CoordinateFrames[aTransformName.From()];
   CoordFrameToTransformMapType::iterator fromToTransformInfoIt = fromCoordFrame.find(aTransformName.To());
 
+  if (fromToTransformInfoIt != fromCoordFrame.end() && !fromToTransformInfoIt->second.m_IsComputed)
+  {
+    // Stored paths may refer to the transforms that are deleted now
+    this->InvalidateTransformPathCache();
+  }
+
   if (fromToTransformInfoIt != fromCoordFrame.end())
   {
     // from->to transform is found
@@ -608,9 +744,50 @@ PlusStatus vtkPlusTransformRepository::DeleteTransform(const PlusTransformName&
 //----------------------------------------------------------------------------
 void vtkPlusTransformRepository::Clear()
 {
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
+  this->InvalidateTransformPathCache();
   this->CoordinateFrames.clear();
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusTransformRepository::GetTransformPath(const PlusTransformName& aTransformName, const TransformInfoPathType*& transformInfoPath, bool silent /*=false*/)
+{
+  int transformNameId = aTransformName.GetId();
+  if (transformNameId < 0)
+  {
+    if (!silent)
+    {
+      LOG_ERROR("Transform name is invalid");
+    }
+    return PLUS_FAIL;
+  }
+
+  TransformPathCacheType::iterator cachedPath = this->TransformPathCache.find(transformNameId);
+  if (cachedPath != this->TransformPathCache.end())
+  {
+    transformInfoPath = &(cachedPath->second);
+    return PLUS_SUCCESS;
+  }
+
+  TransformInfoListType transformInfoList;
+  if (FindPath(aTransformName, transformInfoList, NULL, silent) != PLUS_SUCCESS)
+  {
+    // only existing paths are stored, so that a missing transform is found as soon as it is added
+    return PLUS_FAIL;
+  }
+
+  TransformInfoPathType& newPath = this->TransformPathCache[transformNameId];
+  newPath.assign(transformInfoList.begin(), transformInfoList.end());
+  transformInfoPath = &newPath;
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTransformRepository::InvalidateTransformPathCache()
+{
+  this->TransformPathCache.clear();
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTransformRepository::ReadConfiguration(vtkXMLDataElement* configRootElement)
 {
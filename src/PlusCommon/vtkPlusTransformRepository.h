@@ -12,6 +12,7 @@ See License.txt for details.
 #include "vtkObject.h"
 #include <list>
 #include <map>
+#include <vector>
 
 class PlusTrackedFrame;
 class vtkMatrix4x4;
@@ -122,6 +123,16 @@ public:
   */
   virtual PlusStatus GetTransform(const PlusTransformName& aTransformName, vtkMatrix4x4* matrix, bool* isValid = NULL);
 
+  /*!
+    Get multiple transform matrices at once. Transform paths that start with the same transforms
+    (e.g., transforms of several tools to the same reference coordinate frame) are only concatenated once.
+    \param transformNames names of the transforms to retrieve from the repository
+    \param matrices the retrieved transforms are copied into these matrices (NULL elements are skipped), size must match transformNames
+    \param isValid if this parameter is not NULL then the transforms' validity statuses are returned in this vector
+    \return PLUS_FAIL if any of the transforms could not be computed
+  */
+  virtual PlusStatus GetTransforms(const std::vector<PlusTransformName>& transformNames, const std::vector<vtkMatrix4x4*>& matrices, std::vector<bool>* isValid = NULL);
+
   /*!
     Get the valid status of a transform matrix between two coordinate frames.
     The status is typically invalid when a tracked tool is out of view.
@@ -189,6 +200,11 @@ protected:
   /*! List of transforms */
   typedef std::list<TransformInfo*> TransformInfoListType;
 
+  /*! Transforms that have to be concatenated to compute a transform, in concatenation order */
+  typedef std::vector<TransformInfo*> TransformInfoPathType;
+  /*! For each transform name id (see PlusTransformName::GetId) stores the transform path that was found by FindPath */
+  typedef std::map<int, TransformInfoPathType> TransformPathCacheType;
+
   /*! Get a user-defined original input transform (or its inverse). Does not combine user-defined input transforms. */
   TransformInfo* GetOriginalTransform(const PlusTransformName& aTransformName);
 
@@ -202,8 +218,21 @@ protected:
   */
   PlusStatus FindPath(const PlusTransformName& aTransformName, TransformInfoListType& transformInfoList, const char* skipCoordFrameName = NULL, bool silent = false);
 
+  /*!
+    Get the transform path between the specified coordinate frames. The path is computed by FindPath
+    on the first request and then it is reused until the transform graph topology changes.
+    The returned pointer remains valid until InvalidateTransformPathCache is called.
+  */
+  PlusStatus GetTransformPath(const PlusTransformName& aTransformName, const TransformInfoPathType*& transformInfoPath, bool silent = false);
+
+  /*! Remove all stored transform paths. Must be called whenever a transform is added or removed. */
+  void InvalidateTransformPathCache();
+
   CoordFrameToCoordFrameToTransformMapType CoordinateFrames;
 
+  /*! Transform paths that have been already found. Changing transform matrices or statuses does not invalidate the paths. */
+  TransformPathCacheType TransformPathCache;
+
   vtkPlusRecursiveCriticalSection* CriticalSection;
 
   TransformInfo TransformToSelf;
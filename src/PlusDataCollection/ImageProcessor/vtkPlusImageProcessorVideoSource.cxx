@@ -9,18 +9,40 @@ See License.txt for details.
 #include "PlusTrackedFrame.h"
 #include "vtkPlusBoneEnhancer.h"
 #include "vtkPlusTransverseProcessEnhancer.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPlusChannel.h"
 #include "vtkPlusDataSource.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtkPlusTrackedFrameProcessor.h"
 #include "vtkPlusTransformRepository.h"
+#include "vtkXMLDataElement.h"
 #include "vtksys/SystemTools.hxx"
 
+// STL includes
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkPlusImageProcessorVideoSource);
 
+namespace
+{
+  /*! Input frame processed by one of the processing threads. The job with index i is processed by the i-th processor instance. */
+  struct ProcessingJob
+  {
+    vtkSmartPointer<vtkPlusTrackedFrameList> InputFrames;
+    double Timestamp;
+    PlusStatus Status;
+  };
+
+  struct ProcessingThreadFunctionInfoStruct
+  {
+    std::vector<vtkPlusTrackedFrameProcessor*>* Processors;
+    std::vector<ProcessingJob>* Jobs;
+  };
+}
+
 //----------------------------------------------------------------------------
 vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
 : vtkPlusDevice()
@@ -29,6 +51,9 @@ vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
 , ProcessingAlgorithmAccessMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
 , GracePeriodLogLevel(vtkPlusLogger::LOG_LEVEL_DEBUG)
 , ProcessorAlgorithm(NULL)
+, EnableParallelProcessing(false)
+, NumberOfProcessingThreads(0)
+, DroppedFrameCount(0)
 {
   this->MissingInputGracePeriodSec=2.0;
 
@@ -42,6 +67,7 @@ vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
 //----------------------------------------------------------------------------
 vtkPlusImageProcessorVideoSource::~vtkPlusImageProcessorVideoSource()
 {
+  this->DeleteProcessorPool();
   if (this->TransformRepository)
   {
     this->TransformRepository->Delete();
@@ -58,6 +84,9 @@ vtkPlusImageProcessorVideoSource::~vtkPlusImageProcessorVideoSource()
 void vtkPlusImageProcessorVideoSource::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "EnableParallelProcessing: " << (this->EnableParallelProcessing ? "TRUE" : "FALSE") << std::endl;
+  os << indent << "NumberOfProcessingThreads: " << this->NumberOfProcessingThreads << std::endl;
+  os << indent << "DroppedFrameCount: " << this->DroppedFrameCount << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -65,6 +94,8 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration( vtkXMLDataElemen
 {
   XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_READING(deviceConfig, rootConfigElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableProcessing, deviceConfig);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableParallelProcessing, deviceConfig);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfProcessingThreads, deviceConfig);
 
   // Read transform repository configuration
   if (this->TransformRepository->ReadConfiguration(rootConfigElement) != PLUS_SUCCESS )
@@ -79,6 +110,7 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration( vtkXMLDataElemen
     this->ProcessorAlgorithm->Delete();
     this->ProcessorAlgorithm = NULL;
   }
+  this->ProcessorConfiguration = NULL;
   int numberOfNestedElements = deviceConfig->GetNumberOfNestedElements();
   for (int nestedElemIndex=0; nestedElemIndex<numberOfNestedElements; ++nestedElemIndex) 
   {
@@ -104,6 +136,10 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration( vtkXMLDataElemen
       return PLUS_FAIL;
     }
 
+    // Keep a copy of the configuration for the processor instances of the processing threads
+    this->ProcessorConfiguration = vtkSmartPointer<vtkXMLDataElement>::New();
+    this->ProcessorConfiguration->DeepCopy(processorElement);
+
     // Instantiate processor corresponding to the specified type
     vtkSmartPointer<vtkPlusBoneEnhancer> boneEnhancer = vtkSmartPointer<vtkPlusBoneEnhancer>::New();
     vtkSmartPointer<vtkPlusTransverseProcessEnhancer> TransverseProcessEnhancer = vtkSmartPointer<vtkPlusTransverseProcessEnhancer>::New();
@@ -138,6 +174,8 @@ PlusStatus vtkPlusImageProcessorVideoSource::WriteConfiguration( vtkXMLDataEleme
 {
   XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_WRITING(deviceElement, rootConfig);
   deviceElement->SetAttribute("EnableCapturing", this->EnableProcessing ? "TRUE" : "FALSE" );
+  deviceElement->SetAttribute("EnableParallelProcessing", this->EnableParallelProcessing ? "TRUE" : "FALSE" );
+  deviceElement->SetIntAttribute("NumberOfProcessingThreads", this->NumberOfProcessingThreads);
   
   // Write processor elements
   if (this->ProcessorAlgorithm!=NULL)
@@ -187,6 +225,12 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalConnect()
   }
 
   this->LastProcessedInputDataTimestamp = 0;
+  this->DroppedFrameCount = 0;
+
+  if (this->EnableParallelProcessing)
+  {
+    return this->CreateProcessorPool();
+  }
 
   return PLUS_SUCCESS;
 }
@@ -225,6 +269,12 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
     LOG_DYNAMIC("Processed data is not generated, as no video data is available yet. Device ID: " << this->GetDeviceId(), this->GracePeriodLogLevel ); 
     return PLUS_SUCCESS;
   }
+
+  if (this->EnableParallelProcessing)
+  {
+    return this->InternalUpdateParallel();
+  }
+
   double oldestTrackingTimestamp(0);
   if (this->InputChannels[0]->GetOldestTimestamp(oldestTrackingTimestamp) == PLUS_SUCCESS)
   {
@@ -269,23 +319,29 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
     return PLUS_FAIL;
   }
 
-  vtkPlusDataSource* aSource(NULL);
-  if( outputChannel->GetVideoSource(aSource) != PLUS_SUCCESS )
+  vtkPlusTrackedFrameList* processedFrames = this->ProcessorAlgorithm->GetOutputFrames();
+  if (processedFrames==NULL || processedFrames->GetNumberOfTrackedFrames()<1)
   {
-    LOG_ERROR("Unable to retrieve the video source in the image processor device.");
+    LOG_ERROR("Failed to retrieve processed frame");
     return PLUS_FAIL;
   }
 
-  PlusStatus status = PLUS_SUCCESS;
+  PlusStatus status = this->AddProcessedFrame(processedFrames->GetTrackedFrame(0), frameTimestamp);
 
-  vtkPlusTrackedFrameList* processedFrames = this->ProcessorAlgorithm->GetOutputFrames();
-  if (processedFrames==NULL || processedFrames->GetNumberOfTrackedFrames()<1)
+  this->Modified();
+  return status;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::AddProcessedFrame(PlusTrackedFrame* processedTrackedFrame, double frameTimestamp)
+{
+  vtkPlusDataSource* aSource(NULL);
+  if( this->OutputChannels[0]->GetVideoSource(aSource) != PLUS_SUCCESS )
   {
-    LOG_ERROR("Failed to retrieve processed frame");
+    LOG_ERROR("Unable to retrieve the video source in the image processor device.");
     return PLUS_FAIL;
   }
 
-  PlusTrackedFrame* processedTrackedFrame = processedFrames->GetTrackedFrame(0);
   // Generate unique frame number (not used for filtering, so the actual increment value does not matter)
   this->FrameNumber++;
 
@@ -304,16 +360,218 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
     aSource->SetInputFrameSize( processedTrackedFrame->GetFrameSize() );
   }
 
-  PlusTrackedFrame::FieldMapType customFields=processedTrackedFrame->GetCustomFields();
-  if (aSource->AddItem(processedTrackedFrame->GetImageData(), this->FrameNumber, frameTimestamp, frameTimestamp, &customFields)!=PLUS_SUCCESS)
+  // Frame transforms are passed in binary form, without converting them to strings
+  return aSource->AddItem(*processedTrackedFrame, this->FrameNumber, frameTimestamp, frameTimestamp);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdateParallel()
+{
+  if (this->ProcessorPool.empty())
+  {
+    LOG_ERROR("Processor instances for parallel processing are not available. Device ID: " << this->GetDeviceId());
+    return PLUS_FAIL;
+  }
+  if( this->OutputChannels.empty() )
+  {
+    LOG_ERROR("No output channels defined" );
+    return PLUS_FAIL;
+  }
+
+  vtkPlusChannel* inputChannel = this->InputChannels[0];
+  vtkPlusDataSource* inputSource(NULL);
+  if (inputChannel->GetVideoSource(inputSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to retrieve the input video source in the image processor device.");
+    return PLUS_FAIL;
+  }
+
+  // The most recent timestamp of the channel takes into account the tracking data as well
+  double mostRecentTimestamp(0);
+  BufferItemUidType mostRecentUid(0);
+  if (inputChannel->GetMostRecentTimestamp(mostRecentTimestamp) != PLUS_SUCCESS
+    || inputSource->GetItemUidFromTime(mostRecentTimestamp, mostRecentUid) != ITEM_OK)
+  {
+    LOG_DYNAMIC("Processed data is not generated, as the most recent input frame is not available. Device ID: " << this->GetDeviceId(), this->GracePeriodLogLevel);
+    return PLUS_SUCCESS;
+  }
+  // The closest frame may be newer than the most recent tracking data. Such frames are processed in a later update,
+  // when their tracking data is available (processing them now would fail and they would not be retried).
+  double mostRecentFrameTimestamp(0);
+  while (inputSource->GetTimeStamp(mostRecentUid, mostRecentFrameTimestamp) == ITEM_OK && mostRecentFrameTimestamp > mostRecentTimestamp)
+  {
+    if (mostRecentUid <= inputSource->GetOldestItemUidInBuffer())
+    {
+      // none of the input frames have tracking data yet
+      return PLUS_SUCCESS;
+    }
+    --mostRecentUid;
+  }
+
+  // Process the frames acquired since the last processed frame. When processing starts only the most recent frame is processed.
+  BufferItemUidType firstUidToProcess = mostRecentUid;
+  if (this->LastProcessedInputDataTimestamp > 0)
+  {
+    BufferItemUidType lastProcessedUid(0);
+    if (inputSource->GetItemUidFromTime(this->LastProcessedInputDataTimestamp, lastProcessedUid) == ITEM_OK)
+    {
+      firstUidToProcess = lastProcessedUid + 1;
+    }
+    else
+    {
+      LOG_WARNING("Input frames acquired after " << std::fixed << this->LastProcessedInputDataTimestamp << " are not available anymore, processing continues from the most recent frame. Device ID: " << this->GetDeviceId());
+    }
+  }
+  if (firstUidToProcess > mostRecentUid)
+  {
+    // no new input frames
+    return PLUS_SUCCESS;
+  }
+
+  // Each processor instance processes one frame in an update. If more frames arrived then the oldest ones are dropped.
+  BufferItemUidType numberOfProcessors = this->ProcessorPool.size();
+  if (mostRecentUid - firstUidToProcess + 1 > numberOfProcessors)
+  {
+    unsigned long numberOfDroppedFrames = static_cast<unsigned long>(mostRecentUid - firstUidToProcess + 1 - numberOfProcessors);
+    this->DroppedFrameCount += numberOfDroppedFrames;
+    LOG_DEBUG("All processing threads are busy, " << numberOfDroppedFrames << " input frames are dropped (" << this->DroppedFrameCount << " in total). Device ID: " << this->GetDeviceId());
+    firstUidToProcess = mostRecentUid - numberOfProcessors + 1;
+  }
+
+  PlusStatus status = PLUS_SUCCESS;
+  std::vector<ProcessingJob> jobs;
+  for (BufferItemUidType uid = firstUidToProcess; uid <= mostRecentUid; ++uid)
+  {
+    double timestamp(0);
+    if (inputSource->GetTimeStamp(uid, timestamp) != ITEM_OK)
+    {
+      LOG_ERROR("Unable to get timestamp from input video buffer by UID: " << uid);
+      status = PLUS_FAIL;
+      continue;
+    }
+    PlusTrackedFrame* trackedFrame = new PlusTrackedFrame;
+    if (inputChannel->GetTrackedFrame(timestamp, *trackedFrame) != PLUS_SUCCESS)
+    {
+      delete trackedFrame;
+      LOG_ERROR("Unable to get input tracked frame by time: " << std::fixed << timestamp << ". Device ID: " << this->GetDeviceId());
+      status = PLUS_FAIL;
+      continue;
+    }
+    ProcessingJob job;
+    job.InputFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+    job.InputFrames->TakeTrackedFrame(trackedFrame);
+    job.Timestamp = timestamp;
+    job.Status = PLUS_SUCCESS;
+    jobs.push_back(job);
+  }
+  // Failed frames are not retried
+  inputSource->GetTimeStamp(mostRecentUid, this->LastProcessedInputDataTimestamp);
+
+  if (jobs.empty())
+  {
+    return status;
+  }
+
+  ProcessingThreadFunctionInfoStruct str;
+  str.Processors = &this->ProcessorPool;
+  str.Jobs = &jobs;
+
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(static_cast<int>(jobs.size()));
+  threader->SetSingleMethod(ProcessingThreadFunction, &str);
+  threader->SingleMethodExecute();
+
+  // Add the processed frames to the output in timestamp order
+  for (unsigned int jobIndex = 0; jobIndex < jobs.size(); ++jobIndex)
   {
-    status = PLUS_FAIL;
+    if (jobs[jobIndex].Status != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to process input frame at " << std::fixed << jobs[jobIndex].Timestamp << ". Device ID: " << this->GetDeviceId());
+      status = PLUS_FAIL;
+      continue;
+    }
+    vtkPlusTrackedFrameList* processedFrames = this->ProcessorPool[jobIndex]->GetOutputFrames();
+    if (processedFrames == NULL || processedFrames->GetNumberOfTrackedFrames() < 1)
+    {
+      LOG_ERROR("Failed to retrieve processed frame");
+      status = PLUS_FAIL;
+      continue;
+    }
+    if (this->AddProcessedFrame(processedFrames->GetTrackedFrame(0), jobs[jobIndex].Timestamp) != PLUS_SUCCESS)
+    {
+      status = PLUS_FAIL;
+    }
   }
 
   this->Modified();
   return status;
 }
 
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusImageProcessorVideoSource::ProcessingThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  ProcessingThreadFunctionInfoStruct* str = static_cast<ProcessingThreadFunctionInfoStruct*>(threadInfo->UserData);
+
+  // The output of a processor is kept until its next update, so each processor processes only one job
+  ProcessingJob& job = (*str->Jobs)[threadInfo->ThreadID];
+  vtkPlusTrackedFrameProcessor* processor = (*str->Processors)[threadInfo->ThreadID];
+  processor->SetInputFrames(job.InputFrames);
+  job.Status = processor->Update();
+  processor->SetInputFrames(NULL);
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::CreateProcessorPool()
+{
+  this->DeleteProcessorPool();
+
+  if (this->ProcessorAlgorithm == NULL || this->ProcessorConfiguration == NULL)
+  {
+    LOG_ERROR("Parallel processing requires a " << vtkPlusTrackedFrameProcessor::GetTagName() << " element in the ImageProcessor configuration");
+    return PLUS_FAIL;
+  }
+
+  int numberOfThreads = (this->NumberOfProcessingThreads > 0 ? this->NumberOfProcessingThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  numberOfThreads = std::min<int>(numberOfThreads, VTK_MAX_THREADS);
+
+  for (int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++)
+  {
+    // The processor updates its transform repository with the transforms of each processed frame, so it needs its own copy
+    vtkSmartPointer<vtkPlusTransformRepository> transformRepository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+    if (transformRepository->DeepCopy(this->TransformRepository, true) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to copy the transform repository of the image processor");
+      this->DeleteProcessorPool();
+      return PLUS_FAIL;
+    }
+    vtkPlusTrackedFrameProcessor* processor = this->ProcessorAlgorithm->NewInstance();
+    this->ProcessorPool.push_back(processor);
+    processor->SetTransformRepository(transformRepository);
+    if (processor->ReadConfiguration(this->ProcessorConfiguration) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to configure " << processor->GetProcessorTypeName() << " processor for parallel processing");
+      this->DeleteProcessorPool();
+      return PLUS_FAIL;
+    }
+  }
+
+  LOG_DEBUG("Image processor uses " << this->ProcessorPool.size() << " processing threads");
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusImageProcessorVideoSource::DeleteProcessorPool()
+{
+  for (std::vector<vtkPlusTrackedFrameProcessor*>::iterator processor = this->ProcessorPool.begin(); processor != this->ProcessorPool.end(); ++processor)
+  {
+    (*processor)->Delete();
+  }
+  this->ProcessorPool.clear();
+}
+
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusImageProcessorVideoSource::NotifyConfigured()
 {
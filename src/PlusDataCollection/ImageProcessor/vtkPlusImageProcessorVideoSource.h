@@ -11,6 +11,7 @@ See License.txt for details.
 
 #include "vtkPlusDevice.h"
 #include <string>
+#include <vector>
 
 class vtkPlusTransformRepository;
 class vtkPlusTrackedFrameProcessor;
@@ -19,6 +20,14 @@ class vtkPlusTrackedFrameProcessor;
 \class vtkPlusImageProcessorVideoSource 
 \brief Virtual device that performs real-time image processing on the input channel
 
+By default only the latest input frame is processed in each update, so frames that arrive while the processing
+is running are skipped.
+
+If EnableParallelProcessing is set then every input frame is processed. Each processing thread has its own
+instance of the processor, configured from the same Processor element, and the processed frames are added
+to the output channel in timestamp order. Each update processes at most one frame per processing thread;
+if more new frames are available then the oldest ones are dropped and counted in DroppedFrameCount.
+
 \ingroup PlusLibDataCollection
 */
 class vtkPlusDataCollectionExport vtkPlusImageProcessorVideoSource : public vtkPlusDevice
@@ -42,6 +51,25 @@ public:
   vtkGetMacro(EnableProcessing, bool);
   void SetEnableProcessing(bool aValue);
 
+  /*!
+    Enables processing all the input frames on multiple threads.
+    It has to be set before the device is connected.
+  */
+  vtkGetMacro(EnableParallelProcessing, bool);
+  vtkSetMacro(EnableParallelProcessing, bool);
+  vtkBooleanMacro(EnableParallelProcessing, bool);
+
+  /*!
+    Number of threads (and processor instances) used in parallel processing mode.
+    If 0 then the number of threads is set to the number of processors.
+    It has to be set before the device is connected.
+  */
+  vtkGetMacro(NumberOfProcessingThreads, int);
+  vtkSetMacro(NumberOfProcessingThreads, int);
+
+  /*! Number of input frames that were not processed in parallel processing mode because all the processing threads were busy */
+  vtkGetMacro(DroppedFrameCount, unsigned long);
+
   virtual bool IsTracker() const { return false; }
   virtual bool IsVirtual() const { return true; }
 
@@ -52,6 +80,19 @@ protected:
   vtkPlusImageProcessorVideoSource();
   virtual ~vtkPlusImageProcessorVideoSource();
 
+  /*! Process the new input frames on multiple threads (parallel processing mode) */
+  PlusStatus InternalUpdateParallel();
+
+  /*! Add a processed frame to the output channel */
+  PlusStatus AddProcessedFrame(PlusTrackedFrame* processedTrackedFrame, double frameTimestamp);
+
+  /*! Create the processor instances used by the processing threads */
+  PlusStatus CreateProcessorPool();
+  void DeleteProcessorPool();
+
+  /*! Thread function that processes the jobs assigned to one processor instance */
+  static VTK_THREAD_RETURN_TYPE ProcessingThreadFunction(void* arg);
+
   double LastProcessedInputDataTimestamp;
 
   bool EnableProcessing;
@@ -69,6 +110,21 @@ protected:
 
   vtkPlusTrackedFrameProcessor* ProcessorAlgorithm;
 
+  /*! Copy of the Processor configuration element, used for configuring the processor instances of the processing threads */
+  vtkSmartPointer<vtkXMLDataElement> ProcessorConfiguration;
+
+  /*! If true then all the input frames are processed by the processing threads */
+  bool EnableParallelProcessing;
+
+  /*! Number of processing threads, 0 means the number of processors */
+  int NumberOfProcessingThreads;
+
+  /*! Processor instances of the processing threads. Each instance has its own transform repository. */
+  std::vector<vtkPlusTrackedFrameProcessor*> ProcessorPool;
+
+  /*! Number of input frames skipped in parallel processing mode */
+  unsigned long DroppedFrameCount;
+
 private:
   vtkPlusImageProcessorVideoSource(const vtkPlusImageProcessorVideoSource&);  // Not implemented.
   void operator=(const vtkPlusImageProcessorVideoSource&);  // Not implemented. 
@@ -179,6 +179,10 @@ PlusStatus vtkPlusOpenIGTLinkDevice::SendRequestedMessageTypes()
   // Set message type
   clientInfo.IgtlMessageTypes.push_back(this->MessageType);
 
+  // Received TRACKEDFRAME messages are decoded with either metadata encoding, so the compact one can be requested.
+  // Servers that do not know this attribute ignore it and keep sending XML metadata.
+  clientInfo.TrackedFrameBinaryMetadataSupported = true;
+
   // Set any requested image streams
   if (this->ImageMessageEmbeddedTransformName.IsValid())
   {
@@ -248,6 +252,34 @@ void vtkPlusOpenIGTLinkDevice::ReceiveMessageHeaderWithErrorHandling(igtl::Messa
   }
 }
 
+//----------------------------------------------------------------------------
+igtl::MessageBase::Pointer vtkPlusOpenIGTLinkDevice::GetReceiveMessage(igtl::MessageHeader::Pointer headerMsg)
+{
+  if (headerMsg.IsNull())
+  {
+    LOG_ERROR("Unable to get receive message - header message is NULL");
+    return NULL;
+  }
+
+  std::map<std::string, igtl::MessageBase::Pointer>::iterator receiveMessageIt = this->ReceiveMessages.find(headerMsg->GetMessageType());
+  if (receiveMessageIt == this->ReceiveMessages.end())
+  {
+    igtl::MessageBase::Pointer bodyMsg = this->MessageFactory->CreateReceiveMessage(headerMsg);
+    if (bodyMsg.IsNotNull())
+    {
+      this->ReceiveMessages[headerMsg->GetMessageType()] = bodyMsg;
+    }
+    return bodyMsg;
+  }
+
+  // Prepare the message for receiving the new body, the message buffer
+  // is only reallocated if the size is different from the previously received message
+  igtl::MessageBase::Pointer bodyMsg = receiveMessageIt->second;
+  bodyMsg->SetMessageHeader(headerMsg);
+  bodyMsg->AllocateBuffer();
+  return bodyMsg;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusOpenIGTLinkDevice::ReceiveMessageHeader(igtl::MessageHeader::Pointer& headerMsg)
 {
@@ -15,6 +15,9 @@
 #include <igtlClientSocket.h>
 #include <igtlMessageBase.h>
 
+#include <map>
+#include <string>
+
 class vtkPlusIgtlMessageFactory;
 
 /*!
@@ -118,6 +121,14 @@ protected:
   */
   virtual PlusStatus ReceiveMessageHeader(igtl::MessageHeader::Pointer& headerMsg);
 
+  /*!
+    Get a message object for receiving the body of the message described by headerMsg.
+    One message object is kept for each message type and it is reused for all received messages of that type,
+    so the message buffer is not reallocated for each message (only when the message size changes).
+    Returns NULL if the message type is unknown. Must be called from the data acquisition thread only.
+  */
+  igtl::MessageBase::Pointer GetReceiveMessage(igtl::MessageHeader::Pointer headerMsg);
+
   /*! Set the ReconnectOnReceiveTimeout flag */
   vtkSetMacro(ReconnectOnReceiveTimeout, bool);
 
@@ -157,6 +168,9 @@ protected:
   /*! OpenIGTLink client socket */
   igtl::ClientSocket::Pointer ClientSocket;
 
+  /*! Reused message objects for receiving message bodies, by message type (see GetReceiveMessage) */
+  std::map<std::string, igtl::MessageBase::Pointer> ReceiveMessages;
+
   /*! Attempt a reconnection if no data is received */
   bool ReconnectOnReceiveTimeout;
 
@@ -127,8 +127,8 @@ PlusStatus vtkPlusOpenIGTLinkTracker::InternalUpdateTData()
     // We've received valid header data
     headerMsg->Unpack(this->IgtlMessageCrcCheckEnabled);
 
-    bodyMsg = this->IgtlMessageFactory->CreateReceiveMessage(headerMsg);
-    if (typeid(*bodyMsg) == typeid(igtl::TrackingDataMessage))
+    bodyMsg = this->GetReceiveMessage(headerMsg);
+    if (bodyMsg.IsNotNull() && typeid(*bodyMsg) == typeid(igtl::TrackingDataMessage))
     {
       // received a TDATA message
       break;
@@ -143,6 +143,8 @@ PlusStatus vtkPlusOpenIGTLinkTracker::InternalUpdateTData()
   igtl::TrackingDataMessage::Pointer tdataMsg = dynamic_cast<igtl::TrackingDataMessage*>(bodyMsg.GetPointer());
   tdataMsg->SetMessageHeader(headerMsg);
   tdataMsg->AllocateBuffer();
+  // The message object is reused, remove the elements of the previously received message
+  tdataMsg->ClearTrackingDataElements();
 
   {
     PlusLockGuard<vtkPlusRecursiveCriticalSection> socketGuard(this->SocketMutex);
@@ -301,7 +303,14 @@ PlusStatus vtkPlusOpenIGTLinkTracker::ProcessTransformMessageGeneral(bool& moreM
   vtkSmartPointer<vtkMatrix4x4> toolMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   std::string igtlTransformName;
 
-  igtl::MessageBase::Pointer bodyMsg = IgtlMessageFactory->CreateReceiveMessage(headerMsg);
+  igtl::MessageBase::Pointer bodyMsg = this->GetReceiveMessage(headerMsg);
+  if (bodyMsg.IsNull())
+  {
+    // if the data type is unknown, skip reading.
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> socketGuard(this->SocketMutex);
+    this->ClientSocket->Skip(headerMsg->GetBodySizeToRead(), 0);
+    return PLUS_SUCCESS;
+  }
   if (typeid(*bodyMsg) == typeid(igtl::TransformMessage))
   {
     if (vtkPlusIgtlMessageCommon::UnpackTransformMessage(bodyMsg, this->ClientSocket.GetPointer(), toolMatrix, igtlTransformName, unfilteredTimestampUtc, this->IgtlMessageCrcCheckEnabled) != PLUS_SUCCESS)
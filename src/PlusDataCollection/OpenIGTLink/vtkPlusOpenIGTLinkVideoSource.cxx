@@ -8,6 +8,7 @@ See License.txt for details.
 #include "vtkPlusOpenIGTLinkVideoSource.h"
 
 #include "igtlImageMessage.h"
+#include "igtl_image.h"
 #include "PlusVideoFrame.h"
 #include "PlusTrackedFrame.h"
 #include "vtkImageData.h"
@@ -69,10 +70,33 @@ PlusStatus vtkPlusOpenIGTLinkVideoSource::InternalUpdate()
   // Set unfiltered and filtered timestamp by converting UTC to system timestamp
   double unfilteredTimestamp = vtkPlusAccurateTimer::GetSystemTime();
 
+  vtkPlusDataSource* aSource = NULL;
+  if (this->GetFirstActiveOutputVideoSource(aSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to retrieve the video source in the OpenIGTLinkVideo device.");
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> socketGuard(this->SocketMutex);
+    this->ClientSocket->Skip(headerMsg->GetBodySizeToRead(), 0);
+    return PLUS_FAIL;
+  }
+
+  if (this->CanReceiveImageIntoBuffer(headerMsg, aSource))
+  {
+    return this->ReceiveImageIntoBuffer(headerMsg, aSource, unfilteredTimestamp);
+  }
+
   PlusTrackedFrame trackedFrame;
-  igtl::MessageBase::Pointer bodyMsg = this->MessageFactory->CreateReceiveMessage(headerMsg);
+  igtl::MessageBase::Pointer bodyMsg;
+  if (headerMsg->GetMessageType() == "TRACKEDFRAME")
+  {
+    // A TRACKEDFRAME message would keep the custom fields of the previously received frame, so it is not reused
+    bodyMsg = this->MessageFactory->CreateReceiveMessage(headerMsg);
+  }
+  else
+  {
+    bodyMsg = this->GetReceiveMessage(headerMsg);
+  }
 
-  if (typeid(*bodyMsg) == typeid(igtl::ImageMessage))
+  if (bodyMsg.IsNotNull() && typeid(*bodyMsg) == typeid(igtl::ImageMessage))
   {
     if (vtkPlusIgtlMessageCommon::UnpackImageMessage(bodyMsg, this->ClientSocket, trackedFrame, this->ImageMessageEmbeddedTransformName, this->IgtlMessageCrcCheckEnabled) != PLUS_SUCCESS)
     {
@@ -80,7 +104,7 @@ PlusStatus vtkPlusOpenIGTLinkVideoSource::InternalUpdate()
       return PLUS_FAIL;
     }
   }
-  else if (typeid(*bodyMsg) == typeid(igtl::PlusTrackedFrameMessage))
+  else if (bodyMsg.IsNotNull() && typeid(*bodyMsg) == typeid(igtl::PlusTrackedFrameMessage))
   {
     if (vtkPlusIgtlMessageCommon::UnpackTrackedFrameMessage(bodyMsg, this->ClientSocket, trackedFrame, this->ImageMessageEmbeddedTransformName, this->IgtlMessageCrcCheckEnabled) != PLUS_SUCCESS)
     {
@@ -103,6 +127,12 @@ PlusStatus vtkPlusOpenIGTLinkVideoSource::InternalUpdate()
     return PLUS_SUCCESS;
   }
 
+  return this->AddReceivedFrame(trackedFrame, aSource, unfilteredTimestamp);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusOpenIGTLinkVideoSource::AddReceivedFrame(PlusTrackedFrame& trackedFrame, vtkPlusDataSource* aSource, double unfilteredTimestamp)
+{
   // No need to filter already filtered timestamped items received over OpenIGTLink
   // If the original timestamps are not used it's still safer not to use filtering, as filtering assumes uniform frame rate, which is not guaranteed
   double filteredTimestamp = unfilteredTimestamp;
@@ -111,13 +141,6 @@ PlusStatus vtkPlusOpenIGTLinkVideoSource::InternalUpdate()
   // for simplicity, we increase frame number always by 1.
   this->FrameNumber++;
 
-  vtkPlusDataSource* aSource = NULL;
-  if (this->GetFirstActiveOutputVideoSource(aSource) != PLUS_SUCCESS)
-  {
-    LOG_ERROR("Unable to retrieve the video source in the OpenIGTLinkVideo device.");
-    return PLUS_FAIL;
-  }
-
   // If the buffer is empty, set the pixel type and frame size to the first received properties
   if (aSource->GetNumberOfItems() == 0)
   {
@@ -132,8 +155,117 @@ PlusStatus vtkPlusOpenIGTLinkVideoSource::InternalUpdate()
     aSource->SetImageType(videoFrame->GetImageType());
     aSource->SetInputFrameSize(trackedFrame.GetFrameSize());
   }
-  PlusTrackedFrame::FieldMapType customFields = trackedFrame.GetCustomFields();
-  PlusStatus status = aSource->AddItem(trackedFrame.GetImageData(), this->FrameNumber, unfilteredTimestamp, filteredTimestamp, &customFields);
+  // Frame transforms are passed in binary form, without converting them to strings
+  PlusStatus status = aSource->AddItem(trackedFrame, this->FrameNumber, unfilteredTimestamp, filteredTimestamp);
+  this->Modified();
+
+  return status;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusOpenIGTLinkVideoSource::CanReceiveImageIntoBuffer(igtl::MessageHeader::Pointer headerMsg, vtkPlusDataSource* aSource)
+{
+  // The image is received without an igtl::ImageMessage, so only the basic message format is supported:
+  // no extended header, CRC check or embedded transform. The buffer format is set from the first frame,
+  // which is received the usual way.
+  return headerMsg->GetMessageType() == "IMAGE"
+         && headerMsg->GetHeaderVersion() == IGTL_HEADER_VERSION_1
+         && !this->IgtlMessageCrcCheckEnabled
+         && !this->ImageMessageEmbeddedTransformName.IsValid()
+         && headerMsg->GetBodySizeToRead() > IGTL_IMAGE_HEADER_SIZE
+         && aSource->GetNumberOfItems() > 0;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusOpenIGTLinkVideoSource::ReceiveImageIntoBuffer(igtl::MessageHeader::Pointer headerMsg, vtkPlusDataSource* aSource, double unfilteredTimestamp)
+{
+  igtlUint64 imageDataSizeInBytes = headerMsg->GetBodySizeToRead() - IGTL_IMAGE_HEADER_SIZE;
+  igtl::ImageMessage::Pointer imgMsg;
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> socketGuard(this->SocketMutex);
+
+    // The header is kept in network byte order as well, in case the message has to be unpacked by igtl::ImageMessage
+    igtl_image_header receivedImageHeader;
+    if (static_cast<igtlUint64>(this->ClientSocket->Receive(&receivedImageHeader, IGTL_IMAGE_HEADER_SIZE)) != IGTL_IMAGE_HEADER_SIZE)
+    {
+      LOG_ERROR("Couldn't receive image header from OpenIGTLink server!");
+      return PLUS_FAIL;
+    }
+    igtl_image_header imageHeader = receivedImageHeader;
+    igtl_image_convert_byte_order(&imageHeader);
+
+    bool subVolume = false;
+    unsigned int frameSizeInPx[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; ++i)
+    {
+      frameSizeInPx[i] = imageHeader.size[i];
+      if (imageHeader.subvol_offset[i] != 0 || imageHeader.subvol_size[i] != imageHeader.size[i])
+      {
+        subVolume = true;
+      }
+    }
+
+    // Pixels are received into the frame that will be swapped into the buffer, no need to keep the previous content
+    PlusCommon::VTKScalarPixelType pixelType = PlusVideoFrame::GetVTKScalarPixelTypeFromIGTL(imageHeader.scalar_type);
+    if (subVolume
+        || this->ReceivedFrame.AllocateFrame(frameSizeInPx, pixelType, imageHeader.num_components) != PLUS_SUCCESS
+        || this->ReceivedFrame.GetFrameSizeInBytes() != imageDataSizeInBytes)
+    {
+      // Sub-volumes (and images with unexpected data size) are received into an igtl::ImageMessage
+      // and unpacked the same way as when the image cannot be received into the buffer directly
+      imgMsg = igtl::ImageMessage::New();
+      imgMsg->SetMessageHeader(headerMsg);
+      imgMsg->AllocateBuffer();
+      unsigned char* body = static_cast<unsigned char*>(imgMsg->GetBufferBodyPointer());
+      memcpy(body, &receivedImageHeader, IGTL_IMAGE_HEADER_SIZE);
+      igtlUint64 remainingBodySizeInBytes = imgMsg->GetBufferBodySize() - IGTL_IMAGE_HEADER_SIZE;
+      if (static_cast<igtlUint64>(this->ClientSocket->Receive(body + IGTL_IMAGE_HEADER_SIZE, remainingBodySizeInBytes)) != remainingBodySizeInBytes)
+      {
+        LOG_ERROR("Couldn't receive image data from OpenIGTLink server!");
+        return PLUS_FAIL;
+      }
+    }
+    else
+    {
+      // Set the image type to support color images
+      this->ReceivedFrame.SetImageType((imageHeader.scalar_type == igtl::ImageMessage::TYPE_INT8 && imageHeader.num_components == igtl::ImageMessage::DTYPE_VECTOR)
+                                       ? US_IMG_RGB_COLOR : US_IMG_BRIGHTNESS);
+      this->ReceivedFrame.SetImageOrientation(US_IMG_ORIENT_MF);
+
+      if (static_cast<igtlUint64>(this->ClientSocket->Receive(this->ReceivedFrame.GetScalarPointer(), imageDataSizeInBytes)) != imageDataSizeInBytes)
+      {
+        LOG_ERROR("Couldn't receive image data from OpenIGTLink server!");
+        return PLUS_FAIL;
+      }
+      this->ReceivedFrame.GetImage()->Modified();
+    }
+  }
+
+  if (imgMsg.IsNotNull())
+  {
+    PlusTrackedFrame trackedFrame;
+    if (vtkPlusIgtlMessageCommon::UnpackImageMessage(imgMsg, trackedFrame, this->ImageMessageEmbeddedTransformName, this->IgtlMessageCrcCheckEnabled) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Couldn't get image from OpenIGTLink server!");
+      return PLUS_FAIL;
+    }
+    return this->AddReceivedFrame(trackedFrame, aSource, unfilteredTimestamp);
+  }
+
+  // Store the message timestamp in the frame fields, the same way as for frames received through igtl::ImageMessage
+  igtl::TimeStamp::Pointer igtlTimestamp = igtl::TimeStamp::New();
+  headerMsg->GetTimeStamp(igtlTimestamp);
+  PlusTrackedFrame trackedFrame;
+  trackedFrame.SetTimestamp(igtlTimestamp->GetTimeStamp());
+  // The frame has no transforms, so the string fields are all the custom fields
+  const PlusTrackedFrame::FieldMapType& customFields = trackedFrame.GetStringCustomFields();
+
+  // No need to filter already filtered timestamped items received over OpenIGTLink
+  double filteredTimestamp = unfilteredTimestamp;
+  this->FrameNumber++;
+
+  // The received image is moved into the buffer, the frame gets the image of the buffer item that is overwritten
+  PlusStatus status = aSource->SwapItem(this->ReceivedFrame, this->FrameNumber, unfilteredTimestamp, filteredTimestamp, &customFields);
   this->Modified();
 
   return status;
@@ -11,6 +11,7 @@
 #include "vtkPlusDataCollectionExport.h"
 #include "vtkPlusOpenIGTLinkDevice.h"
 #include "vtkPlusIgtlMessageFactory.h"
+#include "PlusVideoFrame.h"
 
 /*!
   \class vtkPlusOpenIGTLinkVideoSource
@@ -18,6 +19,11 @@
 
   vtkPlusOpenIGTLinkVideoSource is a class for providing video input interfaces between VTK and OpenIGTLink ready video device.
 
+  Message bodies are received into reused message objects. Pixels of IMAGE messages (without CRC check,
+  extended header or embedded transform) are received directly into a frame that is then swapped into
+  the video buffer, so the image data is not copied after it is received from the socket.
+  Sub-volume IMAGE messages are unpacked into a frame of the full image size, pixels outside of the sub-volume are set to zero.
+
   \ingroup PlusLibDataCollection
 */
 class vtkPlusDataCollectionExport vtkPlusOpenIGTLinkVideoSource : public vtkPlusOpenIGTLinkDevice
@@ -48,9 +54,24 @@ protected:
   vtkPlusOpenIGTLinkVideoSource();
   virtual ~vtkPlusOpenIGTLinkVideoSource();
 
+  /*! Returns true if the body of the message can be received by ReceiveImageIntoBuffer */
+  bool CanReceiveImageIntoBuffer(igtl::MessageHeader::Pointer headerMsg, vtkPlusDataSource* aSource);
+
+  /*!
+    Receive the body of an IMAGE message into ReceivedFrame and then swap the frame into the buffer of the source.
+    Sub-volumes and images that do not match the received header are unpacked from an igtl::ImageMessage instead.
+  */
+  PlusStatus ReceiveImageIntoBuffer(igtl::MessageHeader::Pointer headerMsg, vtkPlusDataSource* aSource, double unfilteredTimestamp);
+
+  /*! Add a frame received from an igtl message to the buffer of the source */
+  PlusStatus AddReceivedFrame(PlusTrackedFrame& trackedFrame, vtkPlusDataSource* aSource, double unfilteredTimestamp);
+
   /*! igtl Factory for message handling */
   vtkSmartPointer<vtkPlusIgtlMessageFactory> IgtlMessageFactory;
 
+  /*! Frame that the pixels of the next IMAGE message are received into. Holds an image previously owned by a buffer item. */
+  PlusVideoFrame ReceivedFrame;
+
 private:
   vtkPlusOpenIGTLinkVideoSource(const vtkPlusOpenIGTLinkVideoSource&);   // Not implemented.
   void operator=(const vtkPlusOpenIGTLinkVideoSource&);   // Not implemented.
@@ -50,6 +50,7 @@ StreamBufferItem& StreamBufferItem::operator=( StreamBufferItem const& dataItem
   this->Index = dataItem.Index;
   this->Uid = dataItem.Uid;
   this->CustomFrameFields = dataItem.CustomFrameFields;
+  this->FrameTransforms = dataItem.FrameTransforms;
   this->Status = dataItem.Status;
   this->Matrix->DeepCopy( dataItem.Matrix );
   this->ValidTransformData = dataItem.ValidTransformData;
@@ -63,6 +64,24 @@ void StreamBufferItem::SetCustomFrameField( std::string fieldName, std::string f
   this->CustomFrameFields[fieldName] = fieldValue;
 }
 
+//----------------------------------------------------------------------------
+StreamBufferItem::FieldMapType& StreamBufferItem::GetCustomFrameFieldMap()
+{
+  if ( this->FrameTransforms.empty() )
+  {
+    return this->CustomFrameFields;
+  }
+  this->SerializedFrameFields = this->CustomFrameFields;
+  PlusTrackedFrame::AddFrameTransformFields( this->FrameTransforms, this->SerializedFrameFields );
+  return this->SerializedFrameFields;
+}
+
+//----------------------------------------------------------------------------
+void StreamBufferItem::SetFrameTransformItems( const PlusTrackedFrame::FrameTransformListType& frameTransforms )
+{
+  this->FrameTransforms = frameTransforms;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus StreamBufferItem::DeepCopy( StreamBufferItem* dataItem )
 {
@@ -77,6 +96,33 @@ PlusStatus StreamBufferItem::DeepCopy( StreamBufferItem* dataItem )
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus StreamBufferItem::ShallowCopy( StreamBufferItem* dataItem )
+{
+  if ( dataItem == NULL )
+  {
+    LOG_ERROR( "Failed to shallow copy data buffer item - buffer item NULL!" );
+    return PLUS_FAIL;
+  }
+  if ( this == dataItem )
+  {
+    return PLUS_SUCCESS;
+  }
+
+  this->Frame.ShallowCopy( dataItem->Frame );
+  this->FilteredTimeStamp = dataItem->FilteredTimeStamp;
+  this->UnfilteredTimeStamp = dataItem->UnfilteredTimeStamp;
+  this->Index = dataItem->Index;
+  this->Uid = dataItem->Uid;
+  this->CustomFrameFields = dataItem->CustomFrameFields;
+  this->FrameTransforms = dataItem->FrameTransforms;
+  this->Status = dataItem->Status;
+  this->Matrix->DeepCopy( dataItem->Matrix );
+  this->ValidTransformData = dataItem->ValidTransformData;
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus StreamBufferItem::SetMatrix( vtkMatrix4x4* matrix )
 {
@@ -122,5 +168,5 @@ ToolStatus StreamBufferItem::GetStatus() const
 //----------------------------------------------------------------------------
 bool StreamBufferItem::HasValidFieldData() const
 {
-  return this->CustomFrameFields.size() > 0;
+  return this->CustomFrameFields.size() > 0 || !this->FrameTransforms.empty();
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ See License.txt for details.
 #include "vtkPlusDataCollectionExport.h"
 
 #include "PlusCommon.h"
+#include "PlusTrackedFrame.h"
 #include "PlusVideoFrame.h"
 
 #include "vtkSmartPointer.h"
@@ -104,13 +105,42 @@ public:
     {
       return fieldIterator->second.c_str();
     }
+    const std::string* transformFieldString = PlusTrackedFrame::GetFrameTransformFieldString( this->FrameTransforms, fieldName );
+    if ( transformFieldString != NULL )
+    {
+      // Returned pointer remains valid until the field is modified (see PlusTrackedFrame::GetCustomFrameField)
+      std::string& fieldValue = this->FrameTransformFieldValues[fieldName];
+      if ( fieldValue != *transformFieldString )
+      {
+        fieldValue = *transformFieldString;
+      }
+      return fieldValue.c_str();
+    }
     return NULL;
   }
-  /*! Get custom frame field map */
-  FieldMapType& GetCustomFrameFieldMap()
+  /*!
+    Get custom frame field map.
+    If the item has frame transforms in binary form then they are included in the map, converted to string.
+  */
+  FieldMapType& GetCustomFrameFieldMap();
+  /*! Get custom frame fields that are stored as strings (frame transforms in binary form are not included) */
+  const FieldMapType& GetStringCustomFrameFieldMap() const
   {
     return this->CustomFrameFields;
   }
+
+  /*! Set frame transforms and transform statuses in binary form, replaces the previously set frame transforms */
+  void SetFrameTransformItems( const PlusTrackedFrame::FrameTransformListType& frameTransforms );
+  /*! Remove all frame transforms and transform statuses that are stored in binary form */
+  void ClearFrameTransformItems()
+  {
+    this->FrameTransforms.clear();
+  }
+  /*! Get frame transforms and transform statuses in binary form */
+  const PlusTrackedFrame::FrameTransformListType& GetFrameTransformItems() const
+  {
+    return this->FrameTransforms;
+  }
   /*! Delete custom frame field */
   PlusStatus DeleteCustomFrameField( const char* fieldName )
   {
@@ -133,6 +163,12 @@ public:
   /*! Copy stream buffer item */
   PlusStatus DeepCopy( StreamBufferItem* dataItem );
 
+  /*!
+    Copy stream buffer item, but share the video frame with the source item instead of copying the pixels.
+    See PlusVideoFrame::ShallowCopy for the rules of using a shared frame.
+  */
+  PlusStatus ShallowCopy( StreamBufferItem* dataItem );
+
   PlusVideoFrame& GetFrame() { return this->Frame; };
 
   /*! Set tracker matrix */
@@ -166,6 +202,15 @@ protected:
   /*! Custom frame fields */
   FieldMapType CustomFrameFields;
 
+  /*! Frame transforms in binary form (see PlusTrackedFrame::GetFrameTransformItems) */
+  PlusTrackedFrame::FrameTransformListType FrameTransforms;
+
+  /*! Custom frame fields with the binary frame transforms converted to string, updated on demand */
+  FieldMapType SerializedFrameFields;
+
+  /*! Transform and transform status field values returned by GetCustomFrameField, indexed by the requested field name */
+  FieldMapType FrameTransformFieldValues;
+
   bool ValidTransformData;
   PlusVideoFrame Frame;
   vtkSmartPointer<vtkMatrix4x4> Matrix;
@@ -13,6 +13,7 @@ See License.txt for details.
 #include "vtkPlusChannel.h"
 #include "vtkPlusDataSource.h"
 #include "vtkPlusSavedDataSource.h"
+#include "vtkPlusSequenceIOBase.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtksys/SystemTools.hxx"
 
@@ -379,10 +380,24 @@ PlusStatus vtkPlusSavedDataSource::InternalConnect()
     return PLUS_FAIL;
   }
 
-  vtkSmartPointer<vtkPlusTrackedFrameList> savedDataBuffer = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  vtkSmartPointer<vtkPlusSequenceIOBase> reader = vtkSmartPointer<vtkPlusSequenceIOBase>::Take(vtkPlusSequenceIO::CreateSequenceHandlerForFile(foundAbsoluteImagePath));
+  if (reader.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to connect to saved data video source: No reader is available for sequence file: " << foundAbsoluteImagePath);
+    return PLUS_FAIL;
+  }
 
-  // Read sequence file into tracked frame list
-  vtkPlusSequenceIO::Read(foundAbsoluteImagePath, savedDataBuffer);
+  // Read sequence file into tracked frame list. Pixel data is read from the file while the frames
+  // are copied into the local buffer, so the whole sequence does not have to fit into memory twice.
+  reader->SetFileName(foundAbsoluteImagePath.c_str());
+  reader->LazyPixelDataLoadingOn();
+  reader->SetMaximumNumberOfLoadedFrames(1);
+  if (reader->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to connect to saved data video source: Failed to read sequence file: " << foundAbsoluteImagePath);
+    return PLUS_FAIL;
+  }
+  vtkSmartPointer<vtkPlusTrackedFrameList> savedDataBuffer = reader->GetTrackedFrameList();
 
   if (savedDataBuffer->GetNumberOfTrackedFrames() < 1)
   {
@@ -390,6 +405,12 @@ PlusStatus vtkPlusSavedDataSource::InternalConnect()
     return PLUS_FAIL;
   }
 
+  if (this->SimulatedStream != VIDEO_STREAM)
+  {
+    // Only the transforms are needed, frames that are not loaded yet remain without pixel data
+    reader = NULL;
+  }
+
   PlusStatus status = PLUS_FAIL;
   switch (this->SimulatedStream)
   {
@@ -10,13 +10,599 @@ See License.txt for details.
 
 #include "vtkSmartPointer.h"
 #include "vtkMatrix4x4.h"
+#include "vtkObjectFactory.h"
+#include "vtksys/SystemTools.hxx"
 
 #include "vtkPlusMetaImageSequenceIO.h"
 #include "itkImage.h"
 
 #include "vtkPlusTrackedFrameList.h"
 #include "PlusTrackedFrame.h"
+#include "vtk_zlib.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+/*! Gives access to the file moving method of the sequence writer */
+class vtkPlusMetaImageSequenceIOMoveFileTester : public vtkPlusMetaImageSequenceIO
+{
+public:
+  static vtkPlusMetaImageSequenceIOMoveFileTester* New();
+  vtkTypeMacro(vtkPlusMetaImageSequenceIOMoveFileTester, vtkPlusMetaImageSequenceIO);
+
+  PlusStatus MoveFileForTesting(const std::string& oldname, const std::string& newname)
+  {
+    return this->MoveFileInternal(oldname.c_str(), newname.c_str());
+  }
+
+protected:
+  vtkPlusMetaImageSequenceIOMoveFileTester() {}
+  virtual ~vtkPlusMetaImageSequenceIOMoveFileTester() {}
+};
+vtkStandardNewMacro(vtkPlusMetaImageSequenceIOMoveFileTester);
+
+//----------------------------------------------------------------------------
+/*! Create frames with a different, predictable image content in each frame */
+void CreateTestFrames(vtkPlusTrackedFrameList* frames, int numberOfFrames, int width, int height)
+{
+  vtkSmartPointer<vtkMatrix4x4> imageToProbe = vtkSmartPointer<vtkMatrix4x4>::New();
+  int frameSize[3] = {width, height, 1};
+  for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex++)
+  {
+    PlusTrackedFrame frame;
+    frame.GetImageData()->AllocateFrame(frameSize, VTK_UNSIGNED_CHAR, 1);
+    unsigned char* pixel = static_cast<unsigned char*>(frame.GetImageData()->GetScalarPointer());
+    for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < width; x++)
+      {
+        // Smooth gradients compress well, the frame index makes every frame unique
+        *(pixel++) = static_cast<unsigned char>((x / 4 + y / 8 + frameIndex * 3) % 256);
+      }
+    }
+    imageToProbe->SetElement(0, 3, frameIndex);
+    frame.SetCustomFrameTransform(PlusTransformName("Image", "Probe"), imageToProbe);
+    std::ostringstream frameNumber;
+    frameNumber << frameIndex;
+    frame.SetCustomFrameField("FrameNumber", frameNumber.str());
+    frame.SetTimestamp(1.0 + frameIndex * 0.1);
+    frames->AddTrackedFrame(&frame);
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Compare timestamps, frame fields and pixel data of two frame lists. Returns the number of differences. */
+int CompareTrackedFrameLists(vtkPlusTrackedFrameList* expectedFrames, vtkPlusTrackedFrameList* actualFrames, const std::string& testName)
+{
+  if (expectedFrames->GetNumberOfTrackedFrames() != actualFrames->GetNumberOfTrackedFrames())
+  {
+    LOG_ERROR(testName << ": expected " << expectedFrames->GetNumberOfTrackedFrames() << " frames, read " << actualFrames->GetNumberOfTrackedFrames());
+    return 1;
+  }
+  int numberOfFailures = 0;
+  for (unsigned int frameIndex = 0; frameIndex < expectedFrames->GetNumberOfTrackedFrames(); frameIndex++)
+  {
+    PlusTrackedFrame* expectedFrame = expectedFrames->GetTrackedFrame(frameIndex);
+    PlusTrackedFrame* actualFrame = actualFrames->GetTrackedFrame(frameIndex);
+    if (fabs(expectedFrame->GetTimestamp() - actualFrame->GetTimestamp()) > 1e-6)
+    {
+      LOG_ERROR(testName << ": timestamp mismatch at frame " << frameIndex);
+      numberOfFailures++;
+    }
+    const char* expectedFrameNumber = expectedFrame->GetCustomFrameField("FrameNumber");
+    const char* actualFrameNumber = actualFrame->GetCustomFrameField("FrameNumber");
+    if (expectedFrameNumber == NULL || actualFrameNumber == NULL || strcmp(expectedFrameNumber, actualFrameNumber) != 0)
+    {
+      LOG_ERROR(testName << ": FrameNumber field mismatch at frame " << frameIndex);
+      numberOfFailures++;
+    }
+    unsigned long expectedSize = expectedFrame->GetImageData()->GetFrameSizeInBytes();
+    if (actualFrame->GetImageData()->GetFrameSizeInBytes() != expectedSize
+        || memcmp(expectedFrame->GetImageData()->GetScalarPointer(), actualFrame->GetImageData()->GetScalarPointer(), expectedSize) != 0)
+    {
+      LOG_ERROR(testName << ": pixel data mismatch at frame " << frameIndex);
+      numberOfFailures++;
+    }
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Write frames in batches, the same way as vtkPlusVirtualCapture records a sequence */
+PlusStatus WriteSequenceInBatches(vtkPlusSequenceIOBase* writer, vtkPlusTrackedFrameList* frames, unsigned int framesPerBatch)
+{
+  vtkSmartPointer<vtkPlusTrackedFrameList> batch = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  writer->SetTrackedFrameList(batch);
+  bool headerPrepared = false;
+  for (unsigned int firstFrameIndex = 0; firstFrameIndex < frames->GetNumberOfTrackedFrames(); firstFrameIndex += framesPerBatch)
+  {
+    batch->Clear();
+    for (unsigned int frameIndex = firstFrameIndex; frameIndex < firstFrameIndex + framesPerBatch && frameIndex < frames->GetNumberOfTrackedFrames(); frameIndex++)
+    {
+      batch->AddTrackedFrame(frames->GetTrackedFrame(frameIndex));
+    }
+    if (!headerPrepared)
+    {
+      if (writer->PrepareHeader() != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Unable to prepare header");
+        return PLUS_FAIL;
+      }
+      headerPrepared = true;
+    }
+    if (writer->AppendImagesToHeader() != PLUS_SUCCESS || writer->WriteImages() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to write frames starting at frame " << firstFrameIndex);
+      return PLUS_FAIL;
+    }
+  }
+  batch->Clear();
+  writer->UpdateDimensionsCustomStrings(frames->GetNumberOfTrackedFrames(), false);
+  writer->UpdateFieldInImageHeader(writer->GetDimensionSizeString());
+  writer->UpdateFieldInImageHeader(writer->GetDimensionKindsString());
+  writer->FinalizeHeader();
+  return writer->Close();
+}
+
+//----------------------------------------------------------------------------
+/*! Read a sequence file written by the test. Returns NULL on failure. */
+vtkSmartPointer<vtkPlusTrackedFrameList> ReadTestSequence(const std::string& fileName)
+{
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> reader = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  reader->SetFileName(fileName);
+  if (reader->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read sequence metafile: " << fileName);
+    return NULL;
+  }
+  vtkSmartPointer<vtkPlusTrackedFrameList> frames = reader->GetTrackedFrameList();
+  return frames;
+}
+
+//----------------------------------------------------------------------------
+/*! Streaming write stores the pixel data of a single-file format in a separate file and must be readable */
+int TestStreamingWrite()
+{
+  LOG_INFO("Test streaming write ...");
+  int numberOfFailures = 0;
+
+  vtkSmartPointer<vtkPlusTrackedFrameList> frames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  CreateTestFrames(frames, 12, 64, 48);
+
+  for (int compressed = 0; compressed <= 1; compressed++)
+  {
+    for (int batched = 0; batched <= 1; batched++)
+    {
+      std::string testName = std::string("StreamingWrite") + (compressed ? "Compressed" : "") + (batched ? "Batched" : "");
+      std::string fileName = vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIO" + testName + ".mha");
+      std::string pixelDataFileName = vtksys::SystemTools::GetFilenamePath(fileName) + "/"
+                                      + vtksys::SystemTools::GetFilenameWithoutExtension(fileName) + (compressed ? ".zraw" : ".raw");
+      vtksys::SystemTools::RemoveFile(pixelDataFileName.c_str());
+
+      vtkSmartPointer<vtkPlusMetaImageSequenceIO> writer = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+      writer->SetUseCompression(compressed != 0);
+      writer->StreamingWriteOn();
+      writer->SetFileName(fileName);
+      PlusStatus writeStatus = PLUS_FAIL;
+      if (batched)
+      {
+        writeStatus = WriteSequenceInBatches(writer, frames, 5);
+      }
+      else
+      {
+        writer->SetTrackedFrameList(frames);
+        writeStatus = writer->Write();
+      }
+      if (writeStatus != PLUS_SUCCESS)
+      {
+        LOG_ERROR(testName << ": couldn't write sequence metafile: " << fileName);
+        numberOfFailures++;
+        continue;
+      }
+
+      if (!vtksys::SystemTools::FileExists(pixelDataFileName.c_str(), true))
+      {
+        LOG_ERROR(testName << ": pixel data was not written into a separate file: " << pixelDataFileName);
+        numberOfFailures++;
+      }
+
+      vtkSmartPointer<vtkPlusTrackedFrameList> readFrames = ReadTestSequence(fileName);
+      if (readFrames.GetPointer() == NULL)
+      {
+        numberOfFailures++;
+        continue;
+      }
+      numberOfFailures += CompareTrackedFrameLists(frames, readFrames, testName);
+    }
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Returns true if both frames have valid images with identical pixel data */
+bool IsPixelDataEqual(PlusTrackedFrame* expectedFrame, PlusTrackedFrame* actualFrame)
+{
+  if (!expectedFrame->GetImageData()->IsImageValid() || !actualFrame->GetImageData()->IsImageValid())
+  {
+    return false;
+  }
+  unsigned long expectedSize = expectedFrame->GetImageData()->GetFrameSizeInBytes();
+  return actualFrame->GetImageData()->GetFrameSizeInBytes() == expectedSize
+         && memcmp(expectedFrame->GetImageData()->GetScalarPointer(), actualFrame->GetImageData()->GetScalarPointer(), expectedSize) == 0;
+}
+
+//----------------------------------------------------------------------------
+/*! Frames are read without pixel data, pixel data is loaded on access and can be released */
+int TestLazyPixelDataLoading()
+{
+  LOG_INFO("Test lazy pixel data loading ...");
+  int numberOfFailures = 0;
+
+  const int numberOfFrames = 20;
+  vtkSmartPointer<vtkPlusTrackedFrameList> frames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  CreateTestFrames(frames, numberOfFrames, 64, 48);
+
+  for (int compressed = 0; compressed <= 1; compressed++)
+  {
+    std::string testName = std::string("LazyPixelDataLoading") + (compressed ? "Compressed" : "");
+    std::string fileName = vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIO" + testName + ".mha");
+
+    vtkSmartPointer<vtkPlusMetaImageSequenceIO> writer = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+    writer->SetUseCompression(compressed != 0);
+    writer->SetFileName(fileName);
+    writer->SetTrackedFrameList(frames);
+    if (writer->Write() != PLUS_SUCCESS)
+    {
+      LOG_ERROR(testName << ": couldn't write sequence metafile: " << fileName);
+      numberOfFailures++;
+      continue;
+    }
+
+    vtkSmartPointer<vtkPlusMetaImageSequenceIO> reader = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+    reader->SetFileName(fileName);
+    reader->LazyPixelDataLoadingOn();
+    if (reader->Read() != PLUS_SUCCESS)
+    {
+      LOG_ERROR(testName << ": couldn't read sequence metafile: " << fileName);
+      numberOfFailures++;
+      continue;
+    }
+    vtkSmartPointer<vtkPlusTrackedFrameList> readFrames = reader->GetTrackedFrameList();
+    if (readFrames->GetNumberOfTrackedFrames() != static_cast<unsigned int>(numberOfFrames))
+    {
+      LOG_ERROR(testName << ": expected " << numberOfFrames << " frames, read " << readFrames->GetNumberOfTrackedFrames());
+      numberOfFailures++;
+      continue;
+    }
+
+    // Iterators do not load pixel data
+    int frameIndex = 0;
+    for (vtkPlusTrackedFrameList::TrackedFrameListType::iterator it = readFrames->begin(); it != readFrames->end(); ++it, ++frameIndex)
+    {
+      if ((*it)->GetImageData()->IsImageValid() || reader->IsFramePixelDataLoaded(frameIndex))
+      {
+        LOG_ERROR(testName << ": pixel data of frame " << frameIndex << " is loaded before the frame is accessed");
+        numberOfFailures++;
+      }
+    }
+
+    // Random access, each frame is loaded at the first access
+    for (int i = 0; i < numberOfFrames; i++)
+    {
+      int randomFrameIndex = (i * 7 + 3) % numberOfFrames;
+      PlusTrackedFrame* frame = readFrames->GetTrackedFrame(randomFrameIndex);
+      if (!reader->IsFramePixelDataLoaded(randomFrameIndex) || !IsPixelDataEqual(frames->GetTrackedFrame(randomFrameIndex), frame))
+      {
+        LOG_ERROR(testName << ": pixel data mismatch at frame " << randomFrameIndex << " after random access");
+        numberOfFailures++;
+      }
+    }
+
+    // Released pixel data is loaded again at the next access
+    if (reader->ReleaseFramePixelData(3) != PLUS_SUCCESS || reader->IsFramePixelDataLoaded(3) || (*(readFrames->begin() + 3))->GetImageData()->IsImageValid())
+    {
+      LOG_ERROR(testName << ": pixel data of frame 3 is not released");
+      numberOfFailures++;
+    }
+    if (!IsPixelDataEqual(frames->GetTrackedFrame(3), readFrames->GetTrackedFrame(3)) || !reader->IsFramePixelDataLoaded(3))
+    {
+      LOG_ERROR(testName << ": pixel data mismatch at frame 3 after reloading");
+      numberOfFailures++;
+    }
+
+    // Pixel data of the frame that was loaded first is released if too many frames are loaded
+    if (reader->Read() != PLUS_SUCCESS)
+    {
+      LOG_ERROR(testName << ": couldn't read sequence metafile again: " << fileName);
+      numberOfFailures++;
+      continue;
+    }
+    readFrames = reader->GetTrackedFrameList();
+    reader->SetMaximumNumberOfLoadedFrames(2);
+    readFrames->GetTrackedFrame(5);
+    readFrames->GetTrackedFrame(6);
+    readFrames->GetTrackedFrame(7);
+    if (reader->IsFramePixelDataLoaded(5) || !reader->IsFramePixelDataLoaded(6) || !reader->IsFramePixelDataLoaded(7))
+    {
+      LOG_ERROR(testName << ": frame 5 is expected to be released after loading frames 6 and 7");
+      numberOfFailures++;
+    }
+    if (!IsPixelDataEqual(frames->GetTrackedFrame(5), readFrames->GetTrackedFrame(5)) || reader->IsFramePixelDataLoaded(6))
+    {
+      LOG_ERROR(testName << ": frame 6 is expected to be released after reloading frame 5");
+      numberOfFailures++;
+    }
+
+    // Frames that follow removed frames are loaded from their original position in the file
+    readFrames->RemoveTrackedFrameRange(2, 4);
+    if (!reader->IsFramePixelDataLoaded(2) || !reader->IsFramePixelDataLoaded(4))
+    {
+      LOG_ERROR(testName << ": loaded frames 5 and 7 are expected at positions 2 and 4 after removing frames");
+      numberOfFailures++;
+    }
+    reader->SetMaximumNumberOfLoadedFrames(0);
+    for (unsigned int i = 0; i < readFrames->GetNumberOfTrackedFrames(); i++)
+    {
+      int originalFrameIndex = (i < 2 ? i : i + 3);
+      if (!IsPixelDataEqual(frames->GetTrackedFrame(originalFrameIndex), readFrames->GetTrackedFrame(i)))
+      {
+        LOG_ERROR(testName << ": pixel data mismatch at frame " << i << " (frame " << originalFrameIndex << " in the file) after removing frames");
+        numberOfFailures++;
+      }
+    }
+
+    // Frames that are not loaded when the reader is deleted remain without pixel data
+    if (reader->Read() != PLUS_SUCCESS)
+    {
+      LOG_ERROR(testName << ": couldn't read sequence metafile again: " << fileName);
+      numberOfFailures++;
+      continue;
+    }
+    readFrames = reader->GetTrackedFrameList();
+    readFrames->GetTrackedFrame(1);
+    reader = NULL;
+    if (readFrames->GetTrackedFrame(0)->GetImageData()->IsImageValid() || !IsPixelDataEqual(frames->GetTrackedFrame(1), readFrames->GetTrackedFrame(1)))
+    {
+      LOG_ERROR(testName << ": only frame 1 is expected to have pixel data after the reader is deleted");
+      numberOfFailures++;
+    }
+  }
 
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Split a single-file (.mha) sequence file into the header and the data that follows the header. Returns false on failure. */
+bool ReadMetaImageFile(const std::string& fileName, std::string& header, std::string& data)
+{
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  size_t elementDataFilePos = content.find("ElementDataFile = LOCAL");
+  size_t dataPos = (elementDataFilePos == std::string::npos ? std::string::npos : content.find('\n', elementDataFilePos));
+  if (dataPos == std::string::npos)
+  {
+    LOG_ERROR("No pixel data found in " << fileName);
+    return false;
+  }
+  header = content.substr(0, dataPos + 1);
+  data = content.substr(dataPos + 1);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/*! Get an integer field value from a sequence file header. Returns -1 if the field is not found. */
+long GetHeaderFieldValue(const std::string& header, const std::string& fieldName)
+{
+  size_t fieldPos = header.find("\n" + fieldName + " = ");
+  if (fieldPos == std::string::npos)
+  {
+    return -1;
+  }
+  return atol(header.c_str() + fieldPos + fieldName.size() + 4);
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Compressed pixel data must be readable by Plus and by standard MetaImage readers (one zlib stream of CompressedDataSize bytes),
+  with and without chunk table, when the frames are written at once or in batches that are not aligned with the compression chunks
+*/
+int TestCompressionRoundTrip()
+{
+  LOG_INFO("Test compression round trip ...");
+  int numberOfFailures = 0;
+
+  vtkSmartPointer<vtkPlusTrackedFrameList> frames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  CreateTestFrames(frames, 25, 64, 48);
+
+  // Uncompressed pixel data block, as standard readers should get it after decompression
+  std::string uncompressedFileName = vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIOCompressionReference.mha");
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> referenceWriter = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  referenceWriter->SetUseCompression(false);
+  referenceWriter->SetFileName(uncompressedFileName);
+  referenceWriter->SetTrackedFrameList(frames);
+  std::string referenceHeader;
+  std::string referencePixelData;
+  if (referenceWriter->Write() != PLUS_SUCCESS || !ReadMetaImageFile(uncompressedFileName, referenceHeader, referencePixelData))
+  {
+    LOG_ERROR("Couldn't write uncompressed reference sequence metafile: " << uncompressedFileName);
+    return 1;
+  }
+
+  const unsigned int framesPerChunkValues[2] = {0, 4};
+  const unsigned int framesPerBatchValues[2] = {0, 7};
+  for (int chunkTable = 0; chunkTable <= 1; chunkTable++)
+  {
+    for (int chunkSizeIndex = 0; chunkSizeIndex < 2; chunkSizeIndex++)
+    {
+      for (int batchSizeIndex = 0; batchSizeIndex < 2; batchSizeIndex++)
+      {
+        unsigned int framesPerChunk = framesPerChunkValues[chunkSizeIndex];
+        unsigned int framesPerBatch = framesPerBatchValues[batchSizeIndex];
+        std::ostringstream testNameStream;
+        testNameStream << "CompressionRoundTrip" << (chunkTable ? "ChunkTable" : "NoChunkTable") << "Chunk" << framesPerChunk << "Batch" << framesPerBatch;
+        std::string testName = testNameStream.str();
+        std::string fileName = vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIO" + testName + ".mha");
+
+        vtkSmartPointer<vtkPlusMetaImageSequenceIO> writer = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+        writer->SetUseCompression(true);
+        writer->SetWriteCompressionChunkTable(chunkTable != 0);
+        writer->SetNumberOfFramesPerCompressionChunk(framesPerChunk);
+        writer->SetNumberOfThreads(3);
+        writer->SetFileName(fileName);
+        PlusStatus writeStatus = PLUS_FAIL;
+        if (framesPerBatch > 0)
+        {
+          writeStatus = WriteSequenceInBatches(writer, frames, framesPerBatch);
+        }
+        else
+        {
+          writer->SetTrackedFrameList(frames);
+          writeStatus = writer->Write();
+        }
+        if (writeStatus != PLUS_SUCCESS)
+        {
+          LOG_ERROR(testName << ": couldn't write sequence metafile: " << fileName);
+          numberOfFailures++;
+          continue;
+        }
+
+        // Read by Plus
+        vtkSmartPointer<vtkPlusTrackedFrameList> readFrames = ReadTestSequence(fileName);
+        if (readFrames.GetPointer() == NULL)
+        {
+          numberOfFailures++;
+          continue;
+        }
+        numberOfFailures += CompareTrackedFrameLists(frames, readFrames, testName);
+
+        // Read as a standard zlib stream
+        std::string header;
+        std::string data;
+        if (!ReadMetaImageFile(fileName, header, data))
+        {
+          numberOfFailures++;
+          continue;
+        }
+        long compressedDataSize = GetHeaderFieldValue(header, "CompressedDataSize");
+        long chunkCount = GetHeaderFieldValue(header, "CompressedDataChunkCount");
+        if (compressedDataSize <= 0 || compressedDataSize > static_cast<long>(data.size()))
+        {
+          LOG_ERROR(testName << ": invalid CompressedDataSize: " << compressedDataSize);
+          numberOfFailures++;
+          continue;
+        }
+        if ((chunkTable && chunkCount <= 0) || (!chunkTable && chunkCount != -1))
+        {
+          LOG_ERROR(testName << ": unexpected CompressedDataChunkCount: " << chunkCount);
+          numberOfFailures++;
+        }
+        // Only the chunk table may follow the compressed data
+        const long chunkTableEntrySize = 16;
+        long expectedDataSize = compressedDataSize + (chunkTable ? chunkCount * chunkTableEntrySize : 0);
+        if (static_cast<long>(data.size()) != expectedDataSize)
+        {
+          LOG_ERROR(testName << ": expected " << expectedDataSize << " bytes after the header, found " << data.size());
+          numberOfFailures++;
+        }
+        std::vector<unsigned char> uncompressedData(referencePixelData.size() + 1);
+        uLongf uncompressedSize = uncompressedData.size();
+        if (uncompress(&uncompressedData[0], &uncompressedSize, reinterpret_cast<const Bytef*>(data.data()), compressedDataSize) != Z_OK
+            || uncompressedSize != referencePixelData.size()
+            || memcmp(&uncompressedData[0], referencePixelData.data(), referencePixelData.size()) != 0)
+        {
+          LOG_ERROR(testName << ": compressed pixel data is not a standard zlib stream of the pixel data");
+          numberOfFailures++;
+        }
+      }
+    }
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Moving a file must succeed even if rename() fails because the destination is on a different file system */
+int TestMoveFile()
+{
+  LOG_INFO("Test moving files ...");
+  int numberOfFailures = 0;
+
+  const std::string content = "MetaImageSequenceIO move file test content";
+  std::string destinationFileName = vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIOMoveFileTest.txt");
+
+  std::vector<std::string> sourceFileNames;
+  // Same file system, the file is renamed
+  sourceFileNames.push_back(vtkPlusConfig::GetInstance()->GetOutputPath("MetaImageSequenceIOMoveFileTestSource.txt"));
+#ifndef _WIN32
+  // Different file system, rename() fails and the file is copied instead
+  struct stat destinationDirStat;
+  if (stat(vtksys::SystemTools::GetFilenamePath(destinationFileName).c_str(), &destinationDirStat) == 0)
+  {
+    std::vector<std::string> candidateDirs;
+    candidateDirs.push_back("/dev/shm");
+    candidateDirs.push_back("/tmp");
+    bool foundOtherFileSystem = false;
+    for (std::vector<std::string>::iterator dirIt = candidateDirs.begin(); dirIt != candidateDirs.end(); ++dirIt)
+    {
+      struct stat candidateDirStat;
+      if (stat(dirIt->c_str(), &candidateDirStat) == 0 && candidateDirStat.st_dev != destinationDirStat.st_dev)
+      {
+        sourceFileNames.push_back(*dirIt + "/MetaImageSequenceIOMoveFileTestSource.txt");
+        foundOtherFileSystem = true;
+        break;
+      }
+    }
+    if (!foundOtherFileSystem)
+    {
+      LOG_INFO("No writable directory found on a different file system, moving between file systems is not tested");
+    }
+  }
+#endif
+
+  vtkSmartPointer<vtkPlusMetaImageSequenceIOMoveFileTester> mover = vtkSmartPointer<vtkPlusMetaImageSequenceIOMoveFileTester>::New();
+  for (std::vector<std::string>::iterator sourceIt = sourceFileNames.begin(); sourceIt != sourceFileNames.end(); ++sourceIt)
+  {
+    {
+      std::ofstream sourceFile(sourceIt->c_str(), std::ios::binary);
+      sourceFile << content;
+      if (!sourceFile)
+      {
+        LOG_INFO("Unable to create " << *sourceIt << ", moving from this location is not tested");
+        continue;
+      }
+    }
+    vtksys::SystemTools::RemoveFile(destinationFileName.c_str());
+
+    if (mover->MoveFileForTesting(*sourceIt, destinationFileName) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to move " << *sourceIt << " to " << destinationFileName);
+      numberOfFailures++;
+      continue;
+    }
+    if (vtksys::SystemTools::FileExists(sourceIt->c_str(), true))
+    {
+      LOG_ERROR("Source file still exists after moving: " << *sourceIt);
+      numberOfFailures++;
+      vtksys::SystemTools::RemoveFile(sourceIt->c_str());
+    }
+    std::ifstream destinationFile(destinationFileName.c_str(), std::ios::binary);
+    std::string movedContent((std::istreambuf_iterator<char>(destinationFile)), std::istreambuf_iterator<char>());
+    if (movedContent != content)
+    {
+      LOG_ERROR("Moved file content is incorrect after moving " << *sourceIt);
+      numberOfFailures++;
+    }
+  }
+  vtksys::SystemTools::RemoveFile(destinationFileName.c_str());
+
+  return numberOfFailures;
+}
 
 ///////////////////////////////////////////////////////////////////
 
@@ -297,6 +883,11 @@ int main(int argc, char **argv)
   }
   vtkPlusLogger::Instance()->SetLogLevel(oldVerboseLevel);  
 
+  numberOfFailures += TestStreamingWrite();
+  numberOfFailures += TestMoveFile();
+  numberOfFailures += TestLazyPixelDataLoading();
+  numberOfFailures += TestCompressionRoundTrip();
+
   if ( numberOfFailures > 0 )
   {
     LOG_ERROR("Total number of failures: " << numberOfFailures ); 
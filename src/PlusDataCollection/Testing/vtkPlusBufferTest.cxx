@@ -0,0 +1,732 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusBufferTest.cxx
+  \brief This program tests sharing video frames between vtkPlusBuffer items and readers,
+  swapping frames into buffer items, reusing buffer items, new data notifications and concurrent reading and writing of the buffer.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusVideoFrame.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusBuffer.h"
+#include "vtkPlusNewDataNotifier.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <atomic>
+#include <vector>
+
+namespace
+{
+  const int FRAME_SIZE[3] = { 8, 6, 1 };
+  const int NO_CLIP_RECTANGLE[3] = { PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP };
+
+  //----------------------------------------------------------------------------
+  vtkSmartPointer<vtkPlusBuffer> CreateVideoBuffer(int bufferSize)
+  {
+    vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+    buffer->SetBufferSize(bufferSize);
+    buffer->SetImageType(US_IMG_BRIGHTNESS);
+    buffer->SetImageOrientation(US_IMG_ORIENT_MF);
+    buffer->SetPixelType(VTK_UNSIGNED_CHAR);
+    buffer->SetNumberOfScalarComponents(1);
+    buffer->SetFrameSize(FRAME_SIZE[0], FRAME_SIZE[1], FRAME_SIZE[2]);
+    return buffer;
+  }
+
+  //----------------------------------------------------------------------------
+  // Add a frame to the buffer, all pixels are set to the frame number
+  PlusStatus AddFrame(vtkPlusBuffer* buffer, long frameNumber)
+  {
+    std::vector<unsigned char> pixels(FRAME_SIZE[0] * FRAME_SIZE[1] * FRAME_SIZE[2], static_cast<unsigned char>(frameNumber));
+    double timestamp = 10.0 + frameNumber * 0.1;
+    return buffer->AddItem(&pixels[0], US_IMG_ORIENT_MF, FRAME_SIZE, VTK_UNSIGNED_CHAR, 1, US_IMG_BRIGHTNESS, 0, frameNumber,
+                           NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp);
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns true if all pixels of the frame are equal to the expected value
+  bool CheckPixels(const PlusVideoFrame& frame, unsigned char expectedValue)
+  {
+    const unsigned char* pixels = static_cast<const unsigned char*>(frame.GetScalarPointer());
+    if (pixels == NULL)
+    {
+      return false;
+    }
+    for (unsigned long i = 0; i < frame.GetFrameSizeInBytes(); i++)
+    {
+      if (pixels[i] != expectedValue)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // A view must keep its pixels while its buffer slot is overwritten, and the slot must get a new image
+  int TestViewLifetime()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(2);
+    AddFrame(buffer, 1);
+    AddFrame(buffer, 2);
+
+    StreamBufferItem view;
+    BufferItemUidType firstUid = buffer->GetOldestItemUidInBuffer();
+    if (buffer->GetStreamBufferItemView(firstUid, &view) != ITEM_OK)
+    {
+      LOG_ERROR("Failed to get a view of buffer item " << firstUid);
+      return 1;
+    }
+    if (!view.GetFrame().IsImageShared())
+    {
+      LOG_ERROR("The frame of a buffer item view is expected to be shared");
+      numberOfErrors++;
+    }
+
+    // A view of the view must keep the image alive as well, even after the first view is released
+    PlusVideoFrame viewOfView;
+    viewOfView.ShallowCopy(view.GetFrame());
+    vtkImageData* viewImage = view.GetFrame().GetImage();
+    if (viewOfView.GetImage() != viewImage)
+    {
+      LOG_ERROR("ShallowCopy of a view is expected to share the image");
+      numberOfErrors++;
+    }
+
+    // Overwrite the slot of the viewed item (buffer size is 2)
+    AddFrame(buffer, 3);
+    if (!CheckPixels(view.GetFrame(), 1) || !CheckPixels(viewOfView, 1))
+    {
+      LOG_ERROR("Pixels of a view changed when its buffer slot was overwritten");
+      numberOfErrors++;
+    }
+
+    StreamBufferItem latestView;
+    buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &latestView);
+    if (latestView.GetFrame().GetImage() == viewImage)
+    {
+      LOG_ERROR("The overwritten buffer slot is expected to get a new image while a view refers to the old one");
+      numberOfErrors++;
+    }
+    if (!CheckPixels(latestView.GetFrame(), 3))
+    {
+      LOG_ERROR("Unexpected pixel values in the latest buffer item");
+      numberOfErrors++;
+    }
+
+    // Release the first view, the view of the view must still be valid
+    view.GetFrame().AllocateFrame(FRAME_SIZE, VTK_UNSIGNED_CHAR, 1);
+    AddFrame(buffer, 4);
+    if (!CheckPixels(viewOfView, 1))
+    {
+      LOG_ERROR("Pixels of a view changed after another view of the same image was released");
+      numberOfErrors++;
+    }
+
+    // Views remain valid after the buffer is deleted
+    buffer = NULL;
+    if (!CheckPixels(viewOfView, 1) || !CheckPixels(latestView.GetFrame(), 3))
+    {
+      LOG_ERROR("Pixels of a view changed after the buffer was deleted");
+      numberOfErrors++;
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  // References to the slot image that are not views (e.g., a smart pointer to GetImage()) must not make the slot allocate a new image
+  int TestNonViewReference()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(2);
+    AddFrame(buffer, 1);
+    AddFrame(buffer, 2);
+
+    vtkSmartPointer<vtkImageData> heldImage;
+    {
+      StreamBufferItem view;
+      buffer->GetStreamBufferItemView(buffer->GetOldestItemUidInBuffer(), &view);
+      heldImage = view.GetFrame().GetImage();
+      if (view.GetFrame().GetNumberOfImageViews() != 1)
+      {
+        LOG_ERROR("Expected exactly one view of the buffer item image, found " << view.GetFrame().GetNumberOfImageViews());
+        numberOfErrors++;
+      }
+    }
+
+    // The view is released, the image is only referenced by the slot and heldImage
+    AddFrame(buffer, 3);
+
+    StreamBufferItem latestView;
+    buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &latestView);
+    if (latestView.GetFrame().GetImage() != heldImage.GetPointer())
+    {
+      LOG_ERROR("The buffer slot is expected to reuse its image when no view refers to it");
+      numberOfErrors++;
+    }
+    if (!CheckPixels(latestView.GetFrame(), 3))
+    {
+      LOG_ERROR("Unexpected pixel values in the latest buffer item");
+      numberOfErrors++;
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  // Prepare a frame for SwapItem the same way as devices fill their receive frame, all pixels are set to the given value
+  void FillFrame(PlusVideoFrame& frame, US_IMAGE_ORIENTATION orientation, unsigned char value)
+  {
+    frame.AllocateFrame(FRAME_SIZE, VTK_UNSIGNED_CHAR, 1);
+    frame.SetImageType(US_IMG_BRIGHTNESS);
+    frame.SetImageOrientation(orientation);
+    unsigned char* pixels = static_cast<unsigned char*>(frame.GetScalarPointer());
+    for (unsigned long i = 0; i < frame.GetFrameSizeInBytes(); i++)
+    {
+      pixels[i] = value;
+    }
+    frame.GetImage()->Modified();
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns the value of the pixel at (x, y) in a single-slice, single-component frame
+  unsigned char GetPixel(const PlusVideoFrame& frame, int x, int y)
+  {
+    unsigned int frameSize[3] = { 0, 0, 0 };
+    frame.GetFrameSize(frameSize);
+    return static_cast<const unsigned char*>(frame.GetScalarPointer())[y * frameSize[0] + x];
+  }
+
+  //----------------------------------------------------------------------------
+  // The swapped image must be moved into the buffer slot and the caller must get the previous image of the slot
+  int TestSwapItem()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(2);
+
+    PlusVideoFrame frame;
+    std::vector<vtkImageData*> swappedImages(1, static_cast<vtkImageData*>(NULL));
+    for (long frameNumber = 1; frameNumber <= 5; frameNumber++)
+    {
+      FillFrame(frame, US_IMG_ORIENT_MF, static_cast<unsigned char>(frameNumber));
+      swappedImages.push_back(frame.GetImage());
+      double timestamp = 10.0 + frameNumber * 0.1;
+      if (buffer->SwapItem(frame, frameNumber, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to swap frame " << frameNumber << " into the buffer");
+        numberOfErrors++;
+        continue;
+      }
+
+      {
+        StreamBufferItem latestView;
+        if (buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &latestView) != ITEM_OK)
+        {
+          LOG_ERROR("Failed to get a view of the latest buffer item after swapping frame " << frameNumber);
+          numberOfErrors++;
+          continue;
+        }
+        if (latestView.GetFrame().GetImage() != swappedImages[frameNumber])
+        {
+          LOG_ERROR("The image of frame " << frameNumber << " is expected to be moved into the buffer slot, without copying");
+          numberOfErrors++;
+        }
+        if (!CheckPixels(latestView.GetFrame(), static_cast<unsigned char>(frameNumber)) || latestView.GetIndex() != static_cast<unsigned long>(frameNumber))
+        {
+          LOG_ERROR("Unexpected content of the latest buffer item after swapping frame " << frameNumber);
+          numberOfErrors++;
+        }
+      }
+
+      if (frame.GetImage() == NULL || frame.GetImage() == swappedImages[frameNumber] || frame.IsImageShared())
+      {
+        LOG_ERROR("After swapping frame " << frameNumber << " the caller is expected to get an image that is not in the buffer and not shared");
+        numberOfErrors++;
+      }
+      // Buffer size is 2, so the slot that received the frame held the image of the frame that was swapped two frames earlier
+      if (frameNumber > 2 && frame.GetImage() != swappedImages[frameNumber - 2])
+      {
+        LOG_ERROR("After swapping frame " << frameNumber << " the caller is expected to get the image of frame " << frameNumber - 2 << " back");
+        numberOfErrors++;
+      }
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  // If a reader holds a view of the image that is swapped out of the buffer slot, then the caller must get a new image,
+  // so that filling the next frame does not overwrite the pixels that the reader uses
+  int TestSwapItemWithView()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(2);
+
+    PlusVideoFrame frame;
+    for (long frameNumber = 1; frameNumber <= 2; frameNumber++)
+    {
+      FillFrame(frame, US_IMG_ORIENT_MF, static_cast<unsigned char>(frameNumber));
+      double timestamp = 10.0 + frameNumber * 0.1;
+      buffer->SwapItem(frame, frameNumber, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp);
+    }
+
+    StreamBufferItem view;
+    if (buffer->GetStreamBufferItemView(buffer->GetOldestItemUidInBuffer(), &view) != ITEM_OK)
+    {
+      LOG_ERROR("Failed to get a view of the oldest buffer item");
+      return 1;
+    }
+    vtkImageData* viewedImage = view.GetFrame().GetImage();
+
+    // Swap into the slot of the viewed item (buffer size is 2)
+    FillFrame(frame, US_IMG_ORIENT_MF, 3);
+    buffer->SwapItem(frame, 3, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, 10.3, 10.3);
+    if (frame.GetImage() == viewedImage || frame.IsImageShared())
+    {
+      LOG_ERROR("The caller is expected to get a new image when the image swapped out of the buffer slot is viewed by a reader");
+      numberOfErrors++;
+    }
+    if (frame.GetImage() == NULL || frame.GetFrameSizeInBytes() != view.GetFrame().GetFrameSizeInBytes())
+    {
+      LOG_ERROR("The new image of the caller is expected to have the same size as the image swapped out of the buffer slot");
+      numberOfErrors++;
+    }
+
+    FillFrame(frame, US_IMG_ORIENT_MF, 4);
+    buffer->SwapItem(frame, 4, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, 10.4, 10.4);
+    if (!CheckPixels(view.GetFrame(), 1))
+    {
+      LOG_ERROR("Pixels of a view changed when the caller filled and swapped the next frame");
+      numberOfErrors++;
+    }
+
+    StreamBufferItem oldestView;
+    StreamBufferItem latestView;
+    buffer->GetStreamBufferItemView(buffer->GetOldestItemUidInBuffer(), &oldestView);
+    buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &latestView);
+    if (!CheckPixels(oldestView.GetFrame(), 3) || !CheckPixels(latestView.GetFrame(), 4))
+    {
+      LOG_ERROR("Unexpected pixel values in the buffer items after swapping frames while a view was held");
+      numberOfErrors++;
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  // Frames that have to be reoriented or clipped are copied into the buffer slot and the caller keeps its image
+  int TestSwapItemFallback()
+  {
+    int numberOfErrors = 0;
+
+    // Pixel (x, y) of the input frame is x + y * FRAME_SIZE[0]
+    PlusVideoFrame frame;
+    FillFrame(frame, US_IMG_ORIENT_UF, 0);
+    unsigned char* framePixels = static_cast<unsigned char*>(frame.GetScalarPointer());
+    for (int y = 0; y < FRAME_SIZE[1]; y++)
+    {
+      for (int x = 0; x < FRAME_SIZE[0]; x++)
+      {
+        framePixels[y * FRAME_SIZE[0] + x] = static_cast<unsigned char>(x + y * FRAME_SIZE[0]);
+      }
+    }
+    vtkImageData* frameImage = frame.GetImage();
+
+    // Reorient: UF to MF is a horizontal flip
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(2);
+    if (buffer->SwapItem(frame, 1, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, 10.1, 10.1) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to add a frame that has to be reoriented");
+      return 1;
+    }
+    if (frame.GetImage() != frameImage || frame.GetImageOrientation() != US_IMG_ORIENT_UF)
+    {
+      LOG_ERROR("The caller is expected to keep its image when the frame has to be reoriented");
+      numberOfErrors++;
+    }
+    StreamBufferItem reorientedView;
+    buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &reorientedView);
+    if (reorientedView.GetFrame().GetImage() == frameImage)
+    {
+      LOG_ERROR("The image of a frame that has to be reoriented must not be moved into the buffer slot");
+      numberOfErrors++;
+    }
+    int numberOfWrongPixels = 0;
+    for (int y = 0; y < FRAME_SIZE[1]; y++)
+    {
+      for (int x = 0; x < FRAME_SIZE[0]; x++)
+      {
+        if (GetPixel(reorientedView.GetFrame(), x, y) != GetPixel(frame, FRAME_SIZE[0] - 1 - x, y))
+        {
+          numberOfWrongPixels++;
+        }
+      }
+    }
+    if (numberOfWrongPixels > 0)
+    {
+      LOG_ERROR("The reoriented buffer item has " << numberOfWrongPixels << " wrong pixels");
+      numberOfErrors++;
+    }
+
+    // Clip: the buffer stores the clipped frame size
+    const int clipOrigin[3] = { 2, 1, 0 };
+    const int clipSize[3] = { 4, 3, 1 };
+    frame.SetImageOrientation(US_IMG_ORIENT_MF);
+    vtkSmartPointer<vtkPlusBuffer> clippedBuffer = CreateVideoBuffer(2);
+    clippedBuffer->SetFrameSize(clipSize[0], clipSize[1], clipSize[2]);
+    if (clippedBuffer->SwapItem(frame, 1, clipOrigin, clipSize, 10.1, 10.1) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to add a frame that has to be clipped");
+      return numberOfErrors + 1;
+    }
+    if (frame.GetImage() != frameImage)
+    {
+      LOG_ERROR("The caller is expected to keep its image when the frame has to be clipped");
+      numberOfErrors++;
+    }
+    StreamBufferItem clippedView;
+    clippedBuffer->GetStreamBufferItemView(clippedBuffer->GetLatestItemUidInBuffer(), &clippedView);
+    numberOfWrongPixels = 0;
+    for (int y = 0; y < clipSize[1]; y++)
+    {
+      for (int x = 0; x < clipSize[0]; x++)
+      {
+        if (GetPixel(clippedView.GetFrame(), x, y) != GetPixel(frame, clipOrigin[0] + x, clipOrigin[1] + y))
+        {
+          numberOfWrongPixels++;
+        }
+      }
+    }
+    if (numberOfWrongPixels > 0)
+    {
+      LOG_ERROR("The clipped buffer item has " << numberOfWrongPixels << " wrong pixels");
+      numberOfErrors++;
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  // Items that are added without frame transforms must not keep the frame transforms of the previous item in the same slot
+  int TestReusedItemFrameTransforms()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(1);
+
+    PlusTrackedFrame trackedFrame;
+    PlusVideoFrame frame;
+    FillFrame(frame, US_IMG_ORIENT_MF, 1);
+    trackedFrame.SetImageData(frame);
+    double probeToTracker[16] = { 1, 0, 0, 10, 0, 1, 0, 20, 0, 0, 1, 30, 0, 0, 0, 1 };
+    trackedFrame.SetCustomFrameTransform(PlusTransformName("Probe", "Tracker"), probeToTracker);
+    trackedFrame.SetCustomFrameTransformStatus(PlusTransformName("Probe", "Tracker"), FIELD_OK);
+
+    PlusTrackedFrame::FieldMapType fields;
+    fields["FrameNumber"] = "1";
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+
+    const char* addMethodNames[3] = { "SwapItem", "AddItem with custom fields", "AddTimeStampedItem" };
+    long frameNumber = 1;
+    for (int addMethod = 0; addMethod < 3; addMethod++)
+    {
+      // The only slot of the buffer receives an item with frame transforms first
+      double timestamp = 10.0 + (frameNumber++) * 0.1;
+      if (buffer->AddItem(trackedFrame, frameNumber, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to add a tracked frame with frame transforms to the buffer");
+        return numberOfErrors + 1;
+      }
+
+      // Then the slot is reused for an item without frame transforms
+      timestamp = 10.0 + (frameNumber++) * 0.1;
+      PlusStatus result = PLUS_FAIL;
+      switch (addMethod)
+      {
+      case 0:
+        FillFrame(frame, US_IMG_ORIENT_MF, 2);
+        result = buffer->SwapItem(frame, frameNumber, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp);
+        break;
+      case 1:
+        result = buffer->AddItem(fields, frameNumber, timestamp, timestamp);
+        break;
+      default:
+        result = buffer->AddTimeStampedItem(matrix, TOOL_OK, frameNumber, timestamp, timestamp);
+      }
+      if (result != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to add an item to the buffer with " << addMethodNames[addMethod]);
+        numberOfErrors++;
+        continue;
+      }
+
+      StreamBufferItem latestView;
+      if (buffer->GetStreamBufferItemView(buffer->GetLatestItemUidInBuffer(), &latestView) != ITEM_OK)
+      {
+        LOG_ERROR("Failed to get a view of the latest buffer item");
+        numberOfErrors++;
+        continue;
+      }
+      if (!latestView.GetFrameTransformItems().empty() || latestView.GetCustomFrameField("ProbeToTrackerTransform") != NULL)
+      {
+        LOG_ERROR("The item added with " << addMethodNames[addMethod] << " kept the frame transforms of the previous item");
+        numberOfErrors++;
+      }
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  struct NewDataWaiterData
+  {
+    vtkPlusNewDataNotifier* Notifier;
+    unsigned long LastNotificationCount;
+    double TimeoutSec;
+    bool Notified;
+  };
+
+  //----------------------------------------------------------------------------
+  void* NewDataWaiterThread(vtkMultiThreader::ThreadInfo* data)
+  {
+    NewDataWaiterData* waiterData = static_cast<NewDataWaiterData*>(data->UserData);
+    waiterData->Notified = waiterData->Notifier->WaitForNewData(waiterData->LastNotificationCount, waiterData->TimeoutSec);
+    return NULL;
+  }
+
+  //----------------------------------------------------------------------------
+  // A thread that waits for new data is woken up by adding an item to the buffer, and times out if no item is added
+  int TestNewDataNotifier()
+  {
+    int numberOfErrors = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = CreateVideoBuffer(5);
+    vtkSmartPointer<vtkPlusNewDataNotifier> notifier = vtkSmartPointer<vtkPlusNewDataNotifier>::New();
+    buffer->AddNewDataNotifier(notifier);
+
+    NewDataWaiterData waiterData;
+    waiterData.Notifier = notifier;
+    waiterData.LastNotificationCount = notifier->GetNotificationCount();
+    waiterData.TimeoutSec = 5.0;
+    waiterData.Notified = false;
+    vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+    double startTime = vtkPlusAccurateTimer::GetSystemTime();
+    int threadId = threader->SpawnThread((vtkThreadFunctionType)&NewDataWaiterThread, &waiterData);
+    vtkPlusAccurateTimer::Delay(0.1);
+    AddFrame(buffer, 1);
+    threader->TerminateThread(threadId);
+    if (!waiterData.Notified || vtkPlusAccurateTimer::GetSystemTime() - startTime >= waiterData.TimeoutSec)
+    {
+      LOG_ERROR("The waiting thread is not woken up by adding an item to the buffer");
+      numberOfErrors++;
+    }
+
+    // No item is added, so the wait times out
+    if (notifier->WaitForNewData(waiterData.LastNotificationCount, 0.05))
+    {
+      LOG_ERROR("New data is reported although no item was added to the buffer");
+      numberOfErrors++;
+    }
+
+    // A removed notifier is not notified anymore
+    buffer->RemoveNewDataNotifier(notifier);
+    AddFrame(buffer, 2);
+    if (notifier->WaitForNewData(waiterData.LastNotificationCount, 0))
+    {
+      LOG_ERROR("New data is reported to a notifier that was removed from the buffer");
+      numberOfErrors++;
+    }
+
+    return numberOfErrors;
+  }
+
+  //----------------------------------------------------------------------------
+  const int CONCURRENCY_TEST_NUMBER_OF_ITEMS = 20000;
+  const int CONCURRENCY_TEST_NUMBER_OF_READERS = 3;
+
+  struct ConcurrencyTestData
+  {
+    vtkPlusBuffer* Buffer;
+    std::atomic<bool> WritingCompleted;
+    std::atomic<int> NumberOfInconsistentReads;
+    std::atomic<int> NumberOfSuccessfulReads;
+  };
+
+  //----------------------------------------------------------------------------
+  // The timestamp of each item is computed from its index, so readers can check that the two are consistent
+  double GetConcurrencyTestTimestamp(unsigned long index)
+  {
+    return 1.0 + index * 0.01;
+  }
+
+  //----------------------------------------------------------------------------
+  void* ConcurrencyTestWriterThread(vtkMultiThreader::ThreadInfo* data)
+  {
+    ConcurrencyTestData* testData = static_cast<ConcurrencyTestData*>(data->UserData);
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (unsigned long index = 1; index <= CONCURRENCY_TEST_NUMBER_OF_ITEMS; index++)
+    {
+      double timestamp = GetConcurrencyTestTimestamp(index);
+      testData->Buffer->AddTimeStampedItem(matrix, TOOL_OK, index, timestamp, timestamp);
+      if (index % 100 == 0)
+      {
+        // Toggle the reading mode while readers are active
+        testData->Buffer->SetLockFreeReading(!testData->Buffer->GetLockFreeReading());
+      }
+      if (index % 1000 == 0)
+      {
+        // Resize the buffer while readers are active (the timing slots of lock-free readers are replaced)
+        testData->Buffer->SetBufferSize(testData->Buffer->GetBufferSize() == 50 ? 70 : 50);
+      }
+    }
+    testData->WritingCompleted = true;
+    return NULL;
+  }
+
+  //----------------------------------------------------------------------------
+  void* ConcurrencyTestReaderThread(vtkMultiThreader::ThreadInfo* data)
+  {
+    ConcurrencyTestData* testData = static_cast<ConcurrencyTestData*>(data->UserData);
+    vtkPlusBuffer* buffer = testData->Buffer;
+    while (!testData->WritingCompleted)
+    {
+      BufferItemUidType latestUid = buffer->GetLatestItemUidInBuffer();
+      BufferItemUidType oldestUid = buffer->GetOldestItemUidInBuffer();
+      if (latestUid < 1 || oldestUid > latestUid)
+      {
+        continue;
+      }
+
+      // Timestamp and index of the same item must belong together.
+      // The item may be overwritten between the two queries, then one of them reports that the item is not available anymore.
+      BufferItemUidType uid = (oldestUid + latestUid) / 2;
+      double timestamp(0);
+      unsigned long index(0);
+      if (buffer->GetTimeStamp(uid, timestamp) == ITEM_OK && buffer->GetIndex(uid, index) == ITEM_OK)
+      {
+        if (timestamp != GetConcurrencyTestTimestamp(index))
+        {
+          testData->NumberOfInconsistentReads++;
+        }
+        testData->NumberOfSuccessfulReads++;
+
+        // Timestamps are exact, so searching by the timestamp must find the same item
+        BufferItemUidType uidFromTime(0);
+        unsigned long indexFromTime(0);
+        if (buffer->GetItemUidFromTime(timestamp, uidFromTime) == ITEM_OK
+            && buffer->GetIndex(uidFromTime, indexFromTime) == ITEM_OK
+            && indexFromTime != index)
+        {
+          testData->NumberOfInconsistentReads++;
+        }
+      }
+
+      double oldestTimestamp(0);
+      if (buffer->GetOldestTimeStamp(oldestTimestamp) == ITEM_OK && oldestTimestamp < GetConcurrencyTestTimestamp(1))
+      {
+        testData->NumberOfInconsistentReads++;
+      }
+    }
+    return NULL;
+  }
+
+  //----------------------------------------------------------------------------
+  // Read item UIDs, timestamps and indices while items are added, the buffer is resized and the lock-free reading mode is toggled
+  int TestConcurrentReadWrite()
+  {
+    vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+    buffer->SetBufferSize(50);
+
+    ConcurrencyTestData testData;
+    testData.Buffer = buffer;
+    testData.WritingCompleted = false;
+    testData.NumberOfInconsistentReads = 0;
+    testData.NumberOfSuccessfulReads = 0;
+
+    vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+    std::vector<int> threadIds;
+    for (int i = 0; i < CONCURRENCY_TEST_NUMBER_OF_READERS; i++)
+    {
+      threadIds.push_back(threader->SpawnThread((vtkThreadFunctionType)&ConcurrencyTestReaderThread, &testData));
+    }
+    threadIds.push_back(threader->SpawnThread((vtkThreadFunctionType)&ConcurrencyTestWriterThread, &testData));
+    for (std::vector<int>::iterator it = threadIds.begin(); it != threadIds.end(); ++it)
+    {
+      threader->TerminateThread(*it);
+    }
+
+    LOG_INFO("Concurrent read/write test: " << testData.NumberOfSuccessfulReads << " successful reads, "
+             << testData.NumberOfInconsistentReads << " inconsistent reads");
+    if (testData.NumberOfInconsistentReads > 0)
+    {
+      LOG_ERROR("Inconsistent item data was read while the buffer was written");
+      return 1;
+    }
+    if (buffer->GetLatestItemUidInBuffer() != static_cast<BufferItemUidType>(CONCURRENCY_TEST_NUMBER_OF_ITEMS))
+    {
+      LOG_ERROR("Not all items were added to the buffer");
+      return 1;
+    }
+    return 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfErrors = 0;
+  numberOfErrors += TestViewLifetime();
+  numberOfErrors += TestNonViewReference();
+  numberOfErrors += TestSwapItem();
+  numberOfErrors += TestSwapItemWithView();
+  numberOfErrors += TestSwapItemFallback();
+  numberOfErrors += TestReusedItemFrameTransforms();
+  numberOfErrors += TestNewDataNotifier();
+  numberOfErrors += TestConcurrentReadWrite();
+
+  if (numberOfErrors > 0)
+  {
+    LOG_ERROR("Test failed with " << numberOfErrors << " errors");
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("Test completed successfully!");
+  return EXIT_SUCCESS;
+}
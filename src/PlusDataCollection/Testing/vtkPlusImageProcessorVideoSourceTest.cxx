@@ -0,0 +1,519 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusImageProcessorVideoSourceTest.cxx
+  \brief Tests the parallel processing mode of vtkPlusImageProcessorVideoSource
+
+  - The frames processed in parallel mode are added to the output in timestamp order and they are exactly the same
+    as the frames processed in serial mode.
+  - If more new input frames are available than processing threads then the oldest ones are dropped and counted.
+  - An input frame that is acquired before its tracking data is available is processed in a later update, it is not lost.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusImageProcessorVideoSource.h"
+#include "vtkPlusTrackedFrameProcessor.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  const int FRAME_SIZE_X = 32;
+  const int FRAME_SIZE_Y = 24;
+  const int NUMBER_OF_PROCESSING_THREADS = 4;
+  const int INPUT_BUFFER_SIZE = 100;
+  /*! Timestamp of the first input frame. It is not zero, as zero means that no frame has been processed yet. */
+  const double FIRST_FRAME_TIMESTAMP = 1.0;
+  const double FRAME_PERIOD_SEC = 0.1;
+  const char* PROBE_TO_TRACKER_TRANSFORM_NAME = "ProbeToTracker";
+
+  double GetFrameTimestamp(int frameIndex)
+  {
+    return FIRST_FRAME_TIMESTAMP + frameIndex * FRAME_PERIOD_SEC;
+  }
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Processor that inverts the image and adds the probe translation to the pixel values,
+  so that the output depends on both the image and the tracking data of the input frame.
+*/
+class vtkPlusTestFrameProcessor : public vtkPlusTrackedFrameProcessor
+{
+public:
+  static vtkPlusTestFrameProcessor* New();
+  vtkTypeMacro(vtkPlusTestFrameProcessor, vtkPlusTrackedFrameProcessor);
+
+  virtual const char* GetProcessorTypeName() { return "TestFrameProcessor"; }
+
+protected:
+  vtkPlusTestFrameProcessor() {}
+
+  virtual PlusStatus ProcessFrame(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame)
+  {
+    vtkSmartPointer<vtkMatrix4x4> probeToTracker = vtkSmartPointer<vtkMatrix4x4>::New();
+    if (inputFrame->GetCustomFrameTransform(PlusTransformName(PROBE_TO_TRACKER_TRANSFORM_NAME), probeToTracker) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Probe transform is missing from the input frame");
+      return PLUS_FAIL;
+    }
+    int offset = static_cast<int>(probeToTracker->GetElement(0, 3));
+    // all output pixels are overwritten, so it does not matter that a detached image is not initialized
+    if (outputFrame->GetImageData()->DetachSharedImage() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to detach the output image");
+      return PLUS_FAIL;
+    }
+    const unsigned char* inputPixelPtr = static_cast<const unsigned char*>(inputFrame->GetImageData()->GetScalarPointer());
+    unsigned char* outputPixelPtr = static_cast<unsigned char*>(outputFrame->GetImageData()->GetScalarPointer());
+    for (int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++)
+    {
+      outputPixelPtr[i] = static_cast<unsigned char>(255 - inputPixelPtr[i] + offset);
+    }
+    return PLUS_SUCCESS;
+  }
+};
+
+vtkStandardNewMacro(vtkPlusTestFrameProcessor);
+
+//----------------------------------------------------------------------------
+/*! Gives access to the processing of the image processor device, so that it can be tested without a data collector */
+class vtkPlusImageProcessorVideoSourceTester : public vtkPlusImageProcessorVideoSource
+{
+public:
+  static vtkPlusImageProcessorVideoSourceTester* New();
+  vtkTypeMacro(vtkPlusImageProcessorVideoSourceTester, vtkPlusImageProcessorVideoSource);
+
+  /*! Process the input channel with a test processor in serial or parallel mode */
+  PlusStatus SetUp(vtkPlusChannel* inputChannel, bool parallel)
+  {
+    this->ProcessorAlgorithm = vtkPlusTestFrameProcessor::New();
+    this->ProcessorAlgorithm->SetTransformRepository(this->TransformRepository);
+    this->ProcessorConfiguration = vtkSmartPointer<vtkXMLDataElement>::New();
+    this->ProcessorConfiguration->SetName(vtkPlusTrackedFrameProcessor::GetTagName());
+    this->ProcessorConfiguration->SetAttribute("Type", this->ProcessorAlgorithm->GetProcessorTypeName());
+
+    this->SetDeviceId("ImageProcessor");
+    vtkPlusDataSource* outputSource(NULL);
+    if (this->CreateDefaultOutputChannel("ProcessedChannel") != PLUS_SUCCESS
+        || this->GetFirstActiveOutputVideoSource(outputSource) != PLUS_SUCCESS
+        || outputSource->SetBufferSize(INPUT_BUFFER_SIZE) != PLUS_SUCCESS
+        || this->AddInputChannel(inputChannel) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to set up the channels of the image processor");
+      return PLUS_FAIL;
+    }
+
+    this->SetEnableParallelProcessing(parallel);
+    this->SetNumberOfProcessingThreads(NUMBER_OF_PROCESSING_THREADS);
+    return this->InternalConnect();
+  }
+
+  /*! Get the timestamps and the images of all the processed frames */
+  PlusStatus GetProcessedFrames(std::vector<double>& timestamps, std::vector< std::vector<unsigned char> >& images)
+  {
+    timestamps.clear();
+    images.clear();
+    vtkPlusDataSource* outputSource(NULL);
+    if (this->GetFirstActiveOutputVideoSource(outputSource) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Output video source is not available");
+      return PLUS_FAIL;
+    }
+    if (outputSource->GetNumberOfItems() == 0)
+    {
+      return PLUS_SUCCESS;
+    }
+    for (BufferItemUidType uid = outputSource->GetOldestItemUidInBuffer(); uid <= outputSource->GetLatestItemUidInBuffer(); ++uid)
+    {
+      StreamBufferItem item;
+      double timestamp(0);
+      if (outputSource->GetStreamBufferItem(uid, &item) != ITEM_OK || outputSource->GetTimeStamp(uid, timestamp) != ITEM_OK)
+      {
+        LOG_ERROR("Failed to get processed frame " << uid);
+        return PLUS_FAIL;
+      }
+      const unsigned char* pixelPtr = static_cast<const unsigned char*>(item.GetFrame().GetScalarPointer());
+      timestamps.push_back(timestamp);
+      images.push_back(std::vector<unsigned char>(pixelPtr, pixelPtr + item.GetFrame().GetFrameSizeInBytes()));
+    }
+    return PLUS_SUCCESS;
+  }
+
+protected:
+  vtkPlusImageProcessorVideoSourceTester() {}
+};
+
+vtkStandardNewMacro(vtkPlusImageProcessorVideoSourceTester);
+
+//----------------------------------------------------------------------------
+/*! Input device with a channel that contains video and probe tracking data */
+class TestInput
+{
+public:
+  TestInput()
+    : Device(vtkSmartPointer<vtkPlusDevice>::New())
+    , Channel(vtkSmartPointer<vtkPlusChannel>::New())
+    , VideoSource(vtkSmartPointer<vtkPlusDataSource>::New())
+    , ProbeTool(vtkSmartPointer<vtkPlusDataSource>::New())
+    , Image(vtkSmartPointer<vtkImageData>::New())
+    , NumberOfTrackingItems(0)
+  {
+  }
+
+  PlusStatus SetUp()
+  {
+    this->Device->SetDeviceId("InputDevice");
+
+    this->VideoSource->SetId("Video");
+    this->VideoSource->SetBufferSize(INPUT_BUFFER_SIZE);
+    this->VideoSource->SetInputImageOrientation(US_IMG_ORIENT_MF);
+    this->VideoSource->SetImageType(US_IMG_BRIGHTNESS);
+    this->VideoSource->SetPixelType(VTK_UNSIGNED_CHAR);
+    this->VideoSource->SetNumberOfScalarComponents(1);
+    this->VideoSource->SetInputFrameSize(FRAME_SIZE_X, FRAME_SIZE_Y, 1);
+
+    this->ProbeTool->SetId(PROBE_TO_TRACKER_TRANSFORM_NAME);
+    this->ProbeTool->SetReferenceCoordinateFrameName("Tracker");
+    this->ProbeTool->SetBufferSize(INPUT_BUFFER_SIZE);
+
+    this->Channel->SetOwnerDevice(this->Device);
+    this->Channel->SetChannelId("InputChannel");
+    this->Channel->SetVideoSource(this->VideoSource);
+    if (this->Device->AddVideoSource(this->VideoSource) != PLUS_SUCCESS
+        || this->Device->AddTool(this->ProbeTool) != PLUS_SUCCESS
+        || this->Channel->AddTool(this->ProbeTool) != PLUS_SUCCESS
+        || this->Device->AddOutputChannel(this->Channel) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to set up the input channel");
+      return PLUS_FAIL;
+    }
+
+    this->Image->SetExtent(0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0);
+    this->Image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    return PLUS_SUCCESS;
+  }
+
+  /*! Add the image of the specified frame to the video buffer */
+  PlusStatus AddVideoFrame(int frameIndex)
+  {
+    unsigned char* pixelPtr = static_cast<unsigned char*>(this->Image->GetScalarPointer());
+    for (int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++)
+    {
+      pixelPtr[i] = static_cast<unsigned char>(this->Random.Next() % 256);
+    }
+    this->Image->Modified();
+    double timestamp = GetFrameTimestamp(frameIndex);
+    return this->VideoSource->AddItem(this->Image, US_IMG_ORIENT_MF, US_IMG_BRIGHTNESS, frameIndex, timestamp, timestamp);
+  }
+
+  /*! Add a probe pose to the tracking buffer. The translation is different for each frame, so the processed image depends on it. */
+  PlusStatus AddTrackingData(double timestamp, double translationX)
+  {
+    vtkSmartPointer<vtkMatrix4x4> probeToTracker = vtkSmartPointer<vtkMatrix4x4>::New();
+    probeToTracker->SetElement(0, 3, translationX);
+    return this->ProbeTool->AddTimeStampedItem(probeToTracker, TOOL_OK, this->NumberOfTrackingItems++, timestamp, timestamp);
+  }
+
+  /*! Add a frame with its tracking data, acquired at the same time */
+  PlusStatus AddTrackedFrame(int frameIndex)
+  {
+    if (this->AddTrackingData(GetFrameTimestamp(frameIndex), GetFrameTranslationX(frameIndex)) != PLUS_SUCCESS
+        || this->AddVideoFrame(frameIndex) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to add input frame " << frameIndex);
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  static double GetFrameTranslationX(int frameIndex)
+  {
+    return 10.0 * (frameIndex + 1);
+  }
+
+  vtkSmartPointer<vtkPlusDevice> Device;
+  vtkSmartPointer<vtkPlusChannel> Channel;
+  vtkSmartPointer<vtkPlusDataSource> VideoSource;
+  vtkSmartPointer<vtkPlusDataSource> ProbeTool;
+
+private:
+  vtkSmartPointer<vtkImageData> Image;
+  PlusTesting::TestRandomGenerator Random;
+  unsigned long NumberOfTrackingItems;
+};
+
+//----------------------------------------------------------------------------
+/*! Returns the number of differences between the processed frame timestamps and the expected input frames */
+int CompareProcessedFrameTimestamps(const std::vector<double>& timestamps, const std::vector<int>& expectedFrameIndices, const std::string& testName)
+{
+  if (timestamps.size() != expectedFrameIndices.size())
+  {
+    LOG_ERROR(testName << ": " << timestamps.size() << " frames are processed, expected " << expectedFrameIndices.size());
+    return 1;
+  }
+  int numberOfFailures = 0;
+  for (unsigned int i = 0; i < timestamps.size(); i++)
+  {
+    double expectedTimestamp = GetFrameTimestamp(expectedFrameIndices[i]);
+    if (fabs(timestamps[i] - expectedTimestamp) > 1e-6)
+    {
+      LOG_ERROR(testName << ": processed frame " << i << " timestamp is " << std::fixed << timestamps[i] << ", expected " << expectedTimestamp);
+      numberOfFailures++;
+    }
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Input frames arrive in bursts that are processed in parallel, while the serial processor processes each frame
+  right after it arrives. Both have to produce the same frames in the same order.
+*/
+int TestParallelProcessingOrder()
+{
+  LOG_INFO("Test frame order in parallel processing mode");
+  TestInput input;
+  vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester> serialProcessor = vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester>::New();
+  vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester> parallelProcessor = vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester>::New();
+  if (input.SetUp() != PLUS_SUCCESS
+      || serialProcessor->SetUp(input.Channel, false) != PLUS_SUCCESS
+      || parallelProcessor->SetUp(input.Channel, true) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set up the image processors");
+    return 1;
+  }
+
+  int numberOfFailures = 0;
+  // When processing starts only the most recent frame is processed, so the first burst contains one frame
+  const int burstSizes[] = { 1, 2, NUMBER_OF_PROCESSING_THREADS, 3, 1, NUMBER_OF_PROCESSING_THREADS, 2 };
+  int numberOfFrames = 0;
+  for (unsigned int burstIndex = 0; burstIndex < sizeof(burstSizes) / sizeof(burstSizes[0]); burstIndex++)
+  {
+    for (int i = 0; i < burstSizes[burstIndex]; i++)
+    {
+      if (input.AddTrackedFrame(numberOfFrames) != PLUS_SUCCESS || serialProcessor->InternalUpdate() != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Serial processing of frame " << numberOfFrames << " failed");
+        numberOfFailures++;
+      }
+      numberOfFrames++;
+    }
+    if (parallelProcessor->InternalUpdate() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Parallel processing of burst " << burstIndex << " failed");
+      numberOfFailures++;
+    }
+  }
+
+  std::vector<int> expectedFrameIndices;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex++)
+  {
+    expectedFrameIndices.push_back(frameIndex);
+  }
+  std::vector<double> serialTimestamps;
+  std::vector<double> parallelTimestamps;
+  std::vector< std::vector<unsigned char> > serialImages;
+  std::vector< std::vector<unsigned char> > parallelImages;
+  if (serialProcessor->GetProcessedFrames(serialTimestamps, serialImages) != PLUS_SUCCESS
+      || parallelProcessor->GetProcessedFrames(parallelTimestamps, parallelImages) != PLUS_SUCCESS)
+  {
+    return numberOfFailures + 1;
+  }
+  numberOfFailures += CompareProcessedFrameTimestamps(serialTimestamps, expectedFrameIndices, "Serial processing");
+  numberOfFailures += CompareProcessedFrameTimestamps(parallelTimestamps, expectedFrameIndices, "Parallel processing");
+  for (unsigned int i = 0; i < serialImages.size() && i < parallelImages.size(); i++)
+  {
+    if (serialImages[i] != parallelImages[i])
+    {
+      LOG_ERROR("Frame " << i << " processed in parallel mode differs from the frame processed in serial mode");
+      numberOfFailures++;
+    }
+  }
+  if (parallelProcessor->GetDroppedFrameCount() != 0)
+  {
+    LOG_ERROR("Frames are dropped although there were enough processing threads: " << parallelProcessor->GetDroppedFrameCount());
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! If more new frames are available than processing threads then the oldest new frames are dropped */
+int TestDroppedFrames()
+{
+  LOG_INFO("Test dropped frames in parallel processing mode");
+  TestInput input;
+  vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester> parallelProcessor = vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester>::New();
+  if (input.SetUp() != PLUS_SUCCESS || parallelProcessor->SetUp(input.Channel, true) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set up the image processor");
+    return 1;
+  }
+
+  int numberOfFailures = 0;
+  const int numberOfDroppedFrames = 3;
+  const int burstSizes[] = { 1, NUMBER_OF_PROCESSING_THREADS + numberOfDroppedFrames, 2 };
+  std::vector<int> expectedFrameIndices;
+  int numberOfFrames = 0;
+  for (unsigned int burstIndex = 0; burstIndex < sizeof(burstSizes) / sizeof(burstSizes[0]); burstIndex++)
+  {
+    int firstFrameIndexInBurst = numberOfFrames;
+    for (int i = 0; i < burstSizes[burstIndex]; i++)
+    {
+      input.AddTrackedFrame(numberOfFrames++);
+    }
+    if (parallelProcessor->InternalUpdate() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Parallel processing of burst " << burstIndex << " failed");
+      numberOfFailures++;
+    }
+    // Only the most recent frames are processed, one by each processing thread
+    for (int frameIndex = std::max(firstFrameIndexInBurst, numberOfFrames - NUMBER_OF_PROCESSING_THREADS); frameIndex < numberOfFrames; frameIndex++)
+    {
+      expectedFrameIndices.push_back(frameIndex);
+    }
+  }
+
+  std::vector<double> timestamps;
+  std::vector< std::vector<unsigned char> > images;
+  if (parallelProcessor->GetProcessedFrames(timestamps, images) != PLUS_SUCCESS)
+  {
+    return numberOfFailures + 1;
+  }
+  numberOfFailures += CompareProcessedFrameTimestamps(timestamps, expectedFrameIndices, "Dropped frames");
+  if (parallelProcessor->GetDroppedFrameCount() != static_cast<unsigned long>(numberOfDroppedFrames))
+  {
+    LOG_ERROR("Dropped frame count is " << parallelProcessor->GetDroppedFrameCount() << ", expected " << numberOfDroppedFrames);
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! A frame that is acquired before its tracking data is available has to be processed when the tracking data arrives */
+int TestFrameWithoutTrackingData()
+{
+  LOG_INFO("Test input frame without tracking data in parallel processing mode");
+  TestInput input;
+  vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester> serialProcessor = vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester>::New();
+  vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester> parallelProcessor = vtkSmartPointer<vtkPlusImageProcessorVideoSourceTester>::New();
+  if (input.SetUp() != PLUS_SUCCESS
+      || serialProcessor->SetUp(input.Channel, false) != PLUS_SUCCESS
+      || parallelProcessor->SetUp(input.Channel, true) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set up the image processors");
+    return 1;
+  }
+
+  int numberOfFailures = 0;
+  input.AddTrackedFrame(0);
+  parallelProcessor->InternalUpdate();
+  serialProcessor->InternalUpdate();
+  input.AddTrackedFrame(1);
+  input.AddTrackedFrame(2);
+  serialProcessor->InternalUpdate();
+
+  // The last frame is acquired, but the most recent tracking data is older than the frame
+  // (it is closer to the last frame than to the previous one)
+  const int lastFrameIndex = 3;
+  double lastFrameTimestamp = GetFrameTimestamp(lastFrameIndex);
+  input.AddVideoFrame(lastFrameIndex);
+  input.AddTrackingData(lastFrameTimestamp - 0.2 * FRAME_PERIOD_SEC, TestInput::GetFrameTranslationX(lastFrameIndex - 1));
+  if (parallelProcessor->InternalUpdate() != PLUS_SUCCESS || serialProcessor->InternalUpdate() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Processing failed while tracking data of the last frame was not available");
+    numberOfFailures++;
+  }
+  std::vector<double> timestamps;
+  std::vector< std::vector<unsigned char> > images;
+  std::vector<int> expectedFrameIndices;
+  expectedFrameIndices.push_back(0);
+  expectedFrameIndices.push_back(1);
+  expectedFrameIndices.push_back(2);
+  parallelProcessor->GetProcessedFrames(timestamps, images);
+  numberOfFailures += CompareProcessedFrameTimestamps(timestamps, expectedFrameIndices, "Before tracking data is available");
+
+  // The tracking data of the last frame arrives
+  input.AddTrackingData(lastFrameTimestamp, TestInput::GetFrameTranslationX(lastFrameIndex));
+  if (parallelProcessor->InternalUpdate() != PLUS_SUCCESS || serialProcessor->InternalUpdate() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Processing failed after tracking data of the last frame became available");
+    numberOfFailures++;
+  }
+  expectedFrameIndices.push_back(lastFrameIndex);
+  parallelProcessor->GetProcessedFrames(timestamps, images);
+  numberOfFailures += CompareProcessedFrameTimestamps(timestamps, expectedFrameIndices, "After tracking data is available");
+
+  std::vector<double> serialTimestamps;
+  std::vector< std::vector<unsigned char> > serialImages;
+  serialProcessor->GetProcessedFrames(serialTimestamps, serialImages);
+  if (serialTimestamps.empty() || images.empty() || serialImages.back() != images.back())
+  {
+    LOG_ERROR("Last frame processed in parallel mode differs from the frame processed in serial mode");
+    numberOfFailures++;
+  }
+  if (parallelProcessor->GetDroppedFrameCount() != 0)
+  {
+    LOG_ERROR("Frames are dropped although there were enough processing threads: " << parallelProcessor->GetDroppedFrameCount());
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = 0;
+  numberOfFailures += TestParallelProcessingOrder();
+  numberOfFailures += TestDroppedFrames();
+  numberOfFailures += TestFrameWithoutTrackingData();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("vtkPlusImageProcessorVideoSourceTest failed with " << numberOfFailures << " failures");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("vtkPlusImageProcessorVideoSourceTest completed successfully");
+  return EXIT_SUCCESS;
+}
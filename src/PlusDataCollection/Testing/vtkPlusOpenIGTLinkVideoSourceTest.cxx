@@ -0,0 +1,268 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusOpenIGTLinkVideoSourceTest.cxx
+  \brief Tests receiving IMAGE messages into the buffer of vtkPlusOpenIGTLinkVideoSource
+
+  IMAGE messages are sent to the video source through a local server socket:
+  - The first image initializes the buffer, the following ones are received directly into the buffer.
+  - A sub-volume image is added as a full frame, with the pixels outside of the sub-volume set to zero.
+  - Images received after the sub-volume are still received correctly.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusVideoFrame.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusOpenIGTLinkVideoSource.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// OpenIGTLink includes
+#include <igtlImageMessage.h>
+#include <igtlServerSocket.h>
+
+namespace
+{
+  const int FRAME_SIZE_X = 16;
+  const int FRAME_SIZE_Y = 12;
+  const int SUB_VOLUME_OFFSET[3] = { 3, 2, 0 };
+  const int SUB_VOLUME_SIZE[3] = { 5, 4, 1 };
+  const int BUFFER_SIZE = 10;
+
+  /*! Pixel value of the frame at the given position, distinct for each frame and position */
+  unsigned char GetPixelValue(int frameIndex, int x, int y)
+  {
+    return static_cast<unsigned char>(frameIndex * 50 + x + y * FRAME_SIZE_X);
+  }
+
+  //----------------------------------------------------------------------------
+  /*! Send an IMAGE message with the whole frame or only the sub-volume of the frame */
+  PlusStatus SendImage(igtl::Socket* socket, int frameIndex, bool subVolume)
+  {
+    igtl::ImageMessage::Pointer imageMessage = igtl::ImageMessage::New();
+    imageMessage->SetDeviceName("Image");
+    imageMessage->SetDimensions(FRAME_SIZE_X, FRAME_SIZE_Y, 1);
+    imageMessage->SetSpacing(1.0, 1.0, 1.0);
+    imageMessage->SetScalarType(igtl::ImageMessage::TYPE_UINT8);
+    imageMessage->SetNumComponents(1);
+    int offset[3] = { 0, 0, 0 };
+    int size[3] = { FRAME_SIZE_X, FRAME_SIZE_Y, 1 };
+    if (subVolume)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        offset[i] = SUB_VOLUME_OFFSET[i];
+        size[i] = SUB_VOLUME_SIZE[i];
+      }
+      imageMessage->SetSubVolume(size, offset);
+    }
+    imageMessage->AllocateScalars();
+
+    unsigned char* pixelPtr = static_cast<unsigned char*>(imageMessage->GetScalarPointer());
+    for (int y = offset[1]; y < offset[1] + size[1]; ++y)
+    {
+      for (int x = offset[0]; x < offset[0] + size[0]; ++x)
+      {
+        *(pixelPtr++) = GetPixelValue(frameIndex, x, y);
+      }
+    }
+
+    igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+    timestamp->GetTime();
+    imageMessage->SetTimeStamp(timestamp);
+    imageMessage->Pack();
+    if (socket->Send(imageMessage->GetPackPointer(), imageMessage->GetPackSize()) == 0)
+    {
+      LOG_ERROR("Failed to send image " << frameIndex);
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Gives access to the receiving of the video source, so that it can be tested without a data collector */
+class vtkPlusOpenIGTLinkVideoSourceTester : public vtkPlusOpenIGTLinkVideoSource
+{
+public:
+  static vtkPlusOpenIGTLinkVideoSourceTester* New();
+  vtkTypeMacro(vtkPlusOpenIGTLinkVideoSourceTester, vtkPlusOpenIGTLinkVideoSource);
+
+  /*! Create the output video source and connect to the server */
+  PlusStatus SetUp(int serverPort)
+  {
+    this->SetDeviceId("VideoDevice");
+    vtkPlusDataSource* videoSource(NULL);
+    if (this->CreateDefaultOutputChannel("VideoStream") != PLUS_SUCCESS
+        || this->GetFirstActiveOutputVideoSource(videoSource) != PLUS_SUCCESS
+        || videoSource->SetInputImageOrientation(US_IMG_ORIENT_MF) != PLUS_SUCCESS
+        || videoSource->SetBufferSize(BUFFER_SIZE) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to set up the output channel of the video source");
+      return PLUS_FAIL;
+    }
+    this->SetServerAddress("127.0.0.1");
+    this->SetServerPort(serverPort);
+    this->SetReceiveTimeoutSec(1.0);
+    if (this->InternalConnect() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to connect the video source to the server");
+      return PLUS_FAIL;
+    }
+    // Updates are called directly, without the data capture thread
+    this->Connected = 1;
+    this->Recording = 1;
+    return PLUS_SUCCESS;
+  }
+
+  vtkPlusDataSource* GetVideoSource()
+  {
+    vtkPlusDataSource* videoSource(NULL);
+    this->GetFirstActiveOutputVideoSource(videoSource);
+    return videoSource;
+  }
+
+  void TearDown()
+  {
+    this->Connected = 0;
+    this->Recording = 0;
+    this->InternalDisconnect();
+  }
+
+protected:
+  vtkPlusOpenIGTLinkVideoSourceTester() {}
+};
+
+vtkStandardNewMacro(vtkPlusOpenIGTLinkVideoSourceTester);
+
+//----------------------------------------------------------------------------
+/*! Compare the latest frame in the buffer to the sent frame, returns the number of failures */
+int CheckLatestFrame(vtkPlusDataSource* videoSource, int frameIndex, bool subVolume)
+{
+  StreamBufferItem bufferItem;
+  if (videoSource->GetNumberOfItems() != frameIndex + 1)
+  {
+    LOG_ERROR("Unexpected number of frames in the buffer after receiving image " << frameIndex << ": " << videoSource->GetNumberOfItems());
+    return 1;
+  }
+  if (videoSource->GetLatestStreamBufferItem(&bufferItem) != ITEM_OK)
+  {
+    LOG_ERROR("Failed to get the frame of image " << frameIndex << " from the buffer");
+    return 1;
+  }
+  PlusVideoFrame& frame = bufferItem.GetFrame();
+  int frameSize[3] = { 0, 0, 0 };
+  frame.GetFrameSize(frameSize);
+  if (frameSize[0] != FRAME_SIZE_X || frameSize[1] != FRAME_SIZE_Y || frameSize[2] != 1)
+  {
+    LOG_ERROR("Unexpected frame size of image " << frameIndex << ": " << frameSize[0] << "x" << frameSize[1] << "x" << frameSize[2]);
+    return 1;
+  }
+
+  const unsigned char* pixelPtr = static_cast<const unsigned char*>(frame.GetScalarPointer());
+  for (int y = 0; y < FRAME_SIZE_Y; ++y)
+  {
+    for (int x = 0; x < FRAME_SIZE_X; ++x)
+    {
+      bool pixelSent = !subVolume
+                       || (x >= SUB_VOLUME_OFFSET[0] && x < SUB_VOLUME_OFFSET[0] + SUB_VOLUME_SIZE[0]
+                           && y >= SUB_VOLUME_OFFSET[1] && y < SUB_VOLUME_OFFSET[1] + SUB_VOLUME_SIZE[1]);
+      unsigned char expectedValue = pixelSent ? GetPixelValue(frameIndex, x, y) : 0;
+      if (pixelPtr[x + y * FRAME_SIZE_X] != expectedValue)
+      {
+        LOG_ERROR("Pixel (" << x << ", " << y << ") of image " << frameIndex << " is " << static_cast<int>(pixelPtr[x + y * FRAME_SIZE_X])
+                  << ", expected " << static_cast<int>(expectedValue));
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+  int serverPort = 18999;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+  args.AddArgument("--server-port", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &serverPort, "Port of the local server that sends the images (default: 18999)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  igtl::ServerSocket::Pointer serverSocket = igtl::ServerSocket::New();
+  if (serverSocket->CreateServer(serverPort) != 0)
+  {
+    LOG_ERROR("Failed to create the server on port " << serverPort);
+    return EXIT_FAILURE;
+  }
+
+  // The connection is accepted after the client has connected, the pending connection is kept by the server socket until then
+  vtkSmartPointer<vtkPlusOpenIGTLinkVideoSourceTester> videoDevice = vtkSmartPointer<vtkPlusOpenIGTLinkVideoSourceTester>::New();
+  if (videoDevice->SetUp(serverPort) != PLUS_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+  igtl::ClientSocket::Pointer socket = serverSocket->WaitForConnection(1000);
+  if (socket.IsNull())
+  {
+    LOG_ERROR("The video source did not connect to the server");
+    return EXIT_FAILURE;
+  }
+
+  // The first image is received the usual way, the second one directly into the buffer,
+  // the third one is a sub-volume, and the last one is received directly into the buffer again
+  const bool subVolumeImages[] = { false, false, true, false };
+  int numberOfFailures = 0;
+  for (int frameIndex = 0; frameIndex < static_cast<int>(sizeof(subVolumeImages) / sizeof(subVolumeImages[0])); ++frameIndex)
+  {
+    LOG_INFO("Test receiving " << (subVolumeImages[frameIndex] ? "sub-volume " : "") << "image " << frameIndex);
+    if (SendImage(socket, frameIndex, subVolumeImages[frameIndex]) != PLUS_SUCCESS)
+    {
+      numberOfFailures++;
+      break;
+    }
+    if (videoDevice->InternalUpdate() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to receive image " << frameIndex);
+      numberOfFailures++;
+      continue;
+    }
+    numberOfFailures += CheckLatestFrame(videoDevice->GetVideoSource(), frameIndex, subVolumeImages[frameIndex]);
+  }
+
+  videoDevice->TearDown();
+  socket->CloseSocket();
+  serverSocket->CloseSocket();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("vtkPlusOpenIGTLinkVideoSourceTest failed with " << numberOfFailures << " failures");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("vtkPlusOpenIGTLinkVideoSourceTest completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,627 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusVirtualVolumeReconstructorTest.cxx
+  \brief Tests the pipelined reconstruction mode of vtkPlusVirtualVolumeReconstructor
+
+  - The volume reconstructed in pipelined mode has to be exactly the same as the volume reconstructed
+    in the non-pipelined mode (from synthetic frames or, if specified, from a saved sequence file).
+    The volume is requested right after the last frame is queued, so the request has to wait for the queued frames.
+  - Queueing frames is blocked while the insertion queue is full, and is released when the insertion thread stops.
+  - Reset discards the queued frames and also the remaining frames of the batch that is being inserted.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusSequenceIO.h"
+#include "vtkPlusTrackedFrameList.h"
+#include "vtkPlusVirtualVolumeReconstructor.h"
+#include "vtkPlusVolumeReconstructor.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+#include <vtkXMLDataElement.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <atomic>
+#include <sstream>
+#include <string.h>
+
+namespace
+{
+  const int FRAME_SIZE_X = 64;
+  const int FRAME_SIZE_Y = 48;
+  const int NUMBER_OF_FRAMES = 30;
+  const int NUMBER_OF_FRAMES_PER_BATCH = 5;
+  const int PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES = 8;
+  /*! Slow down the insertion in pipelined mode, so that the queue fills up */
+  const double PIPELINED_INSERTION_DELAY_SEC = 0.01;
+  /*! Time after which a thread is considered blocked */
+  const double BLOCKING_DETECTION_TIME_SEC = 0.5;
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Volume reconstructor that counts the inserted frames. The insertion can be delayed or blocked,
+  to keep frames in the insertion queue of the virtual volume reconstructor.
+*/
+class vtkPlusTestVolumeReconstructor : public vtkPlusVolumeReconstructor
+{
+public:
+  static vtkPlusTestVolumeReconstructor* New();
+  vtkTypeMacro(vtkPlusTestVolumeReconstructor, vtkPlusVolumeReconstructor);
+
+  virtual PlusStatus InsertTrackedFrame(PlusTrackedFrame* frame, vtkMatrix4x4* imageToReferenceTransformMatrix)
+  {
+    this->NumberOfInsertionRequests++;
+    while (this->InsertionBlocked)
+    {
+      vtkPlusAccurateTimer::Delay(0.001);
+    }
+    if (this->InsertionDelaySec > 0)
+    {
+      vtkPlusAccurateTimer::Delay(this->InsertionDelaySec);
+    }
+    PlusStatus status = this->Superclass::InsertTrackedFrame(frame, imageToReferenceTransformMatrix);
+    this->NumberOfInsertedFrames++;
+    return status;
+  }
+
+  /*! If true then InsertTrackedFrame waits until it is set to false */
+  std::atomic<bool> InsertionBlocked;
+  /*! Number of InsertTrackedFrame calls (including the ones that are still blocked) */
+  std::atomic<int> NumberOfInsertionRequests;
+  /*! Number of frames that are completely inserted */
+  std::atomic<int> NumberOfInsertedFrames;
+  double InsertionDelaySec;
+
+protected:
+  vtkPlusTestVolumeReconstructor()
+    : InsertionBlocked(false)
+    , NumberOfInsertionRequests(0)
+    , NumberOfInsertedFrames(0)
+    , InsertionDelaySec(0.0)
+  {
+  }
+};
+
+vtkStandardNewMacro(vtkPlusTestVolumeReconstructor);
+
+//----------------------------------------------------------------------------
+/*! Gives access to the insertion queue of the virtual volume reconstructor, so that it can be tested without a data collector */
+class vtkPlusVirtualVolumeReconstructorTester : public vtkPlusVirtualVolumeReconstructor
+{
+public:
+  static vtkPlusVirtualVolumeReconstructorTester* New();
+  vtkTypeMacro(vtkPlusVirtualVolumeReconstructorTester, vtkPlusVirtualVolumeReconstructor);
+
+  using vtkPlusVirtualVolumeReconstructor::AddFrames;
+  using vtkPlusVirtualVolumeReconstructor::QueueFrames;
+  using vtkPlusVirtualVolumeReconstructor::StartInsertionThread;
+  using vtkPlusVirtualVolumeReconstructor::StopInsertionThread;
+  using vtkPlusVirtualVolumeReconstructor::WaitForQueuedFrames;
+
+  /*!
+    Use the specified volume reconstructor. If frames are specified then the output extent is set to contain all the frames,
+    otherwise a fixed extent is used that contains the synthetic frames.
+  */
+  PlusStatus SetUp(vtkPlusTestVolumeReconstructor* reconstructor, const PlusTransformName& imageToReferenceTransformName,
+                   vtkPlusTrackedFrameList* framesForOutputExtent, bool pipelined, int maxNumberOfQueuedFrames)
+  {
+    std::ostringstream configStr;
+    configStr << "<PlusConfiguration>"
+              << "  <VolumeReconstruction ImageCoordinateFrame=\"" << imageToReferenceTransformName.From() << "\""
+              << "    ReferenceCoordinateFrame=\"" << imageToReferenceTransformName.To() << "\""
+              << "    OutputSpacing=\"0.5 0.5 0.5\" OutputOrigin=\"0 0 0\" OutputExtent=\"0 59 0 49 0 59\""
+              << "    Interpolation=\"LINEAR\" CompoundingMode=\"MEAN\" Optimization=\"FULL\""
+              // the result depends on the order of pixel insertion, so it is only reproducible with one thread
+              << "    NumberOfThreads=\"1\" FillHoles=\"OFF\" />"
+              << "</PlusConfiguration>";
+    vtkSmartPointer<vtkXMLDataElement> config = vtkSmartPointer<vtkXMLDataElement>::Take(vtkXMLUtilities::ReadElementFromString(configStr.str().c_str()));
+    if (config.GetPointer() == NULL || reconstructor->ReadConfiguration(config) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to read volume reconstruction configuration");
+      return PLUS_FAIL;
+    }
+    if (framesForOutputExtent != NULL)
+    {
+      std::string errorDetail;
+      if (reconstructor->SetOutputExtentFromFrameList(framesForOutputExtent, this->TransformRepository, errorDetail) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to set output extent from the frames: " << errorDetail);
+        return PLUS_FAIL;
+      }
+    }
+    reconstructor->Reset();
+    this->VolumeReconstructor = reconstructor;
+    this->SetEnablePipelinedReconstruction(pipelined);
+    this->SetMaxNumberOfQueuedFrames(maxNumberOfQueuedFrames);
+    return PLUS_SUCCESS;
+  }
+
+  int GetPeakNumberOfQueuedFrames()
+  {
+    std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+    return this->PeakNumberOfQueuedFrames;
+  }
+
+  unsigned int GetResetCounter()
+  {
+    std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+    return this->ResetCounter;
+  }
+
+  /*!
+    Make the queue behave as if the insertion thread was running but could not insert any frames.
+    The queued frames can be inserted by InsertNextQueuedBatch.
+  */
+  void SetInsertionThreadStalled(bool stalled)
+  {
+    {
+      std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+      this->InsertionThreadActive = std::make_pair(stalled, stalled);
+    }
+    this->InsertionQueueChanged.notify_all();
+  }
+
+  /*! Insert the next queued batch the same way as the insertion thread does. Returns the number of frames in the batch. */
+  int InsertNextQueuedBatch()
+  {
+    QueuedFrameBatch batch;
+    {
+      std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+      if (this->InsertionQueue.empty())
+      {
+        return 0;
+      }
+      batch = this->InsertionQueue.front();
+      this->InsertionQueue.pop_front();
+    }
+    this->InsertQueuedFrames(batch);
+    {
+      std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+      this->NumberOfQueuedFrames -= static_cast<int>(batch.Frames.size());
+    }
+    this->InsertionQueueChanged.notify_all();
+    return static_cast<int>(batch.Frames.size());
+  }
+
+protected:
+  vtkPlusVirtualVolumeReconstructorTester() {}
+};
+
+vtkStandardNewMacro(vtkPlusVirtualVolumeReconstructorTester);
+
+//----------------------------------------------------------------------------
+struct TestThreadData
+{
+  vtkPlusVirtualVolumeReconstructorTester* Tester;
+  vtkSmartPointer<vtkPlusTrackedFrameList> Frames;
+  std::atomic<bool> Completed;
+  PlusStatus Status;
+};
+
+//----------------------------------------------------------------------------
+void* QueueFramesThread(vtkMultiThreader::ThreadInfo* data)
+{
+  TestThreadData* threadData = static_cast<TestThreadData*>(data->UserData);
+  threadData->Status = threadData->Tester->QueueFrames(threadData->Frames);
+  threadData->Completed = true;
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void* ResetThread(vtkMultiThreader::ThreadInfo* data)
+{
+  TestThreadData* threadData = static_cast<TestThreadData*>(data->UserData);
+  threadData->Status = threadData->Tester->Reset();
+  threadData->Completed = true;
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void CreateTestData(vtkPlusTrackedFrameList* frames, const PlusTransformName& imageToReferenceTransformName)
+{
+  PlusTesting::TestRandomGenerator random;
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  for (int frameIndex = 0; frameIndex < NUMBER_OF_FRAMES; frameIndex++)
+  {
+    unsigned char* pixelPtr = static_cast<unsigned char*>(image->GetScalarPointer());
+    for (int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++)
+    {
+      // avoid 0 so that all inserted pixels are distinguishable from empty voxels
+      pixelPtr[i] = static_cast<unsigned char>(1 + random.Next() % 255);
+    }
+
+    // Dense sweep with overlapping slices, so that the compounded voxel values depend on the insertion order
+    vtkSmartPointer<vtkTransform> imageToReference = vtkSmartPointer<vtkTransform>::New();
+    imageToReference->Translate(1.0 + random.Uniform(-0.3, 0.3), 1.0 + random.Uniform(-0.3, 0.3), 1.0 + frameIndex * 0.8 + random.Uniform(-0.2, 0.2));
+    imageToReference->RotateX(random.Uniform(-10.0, 10.0));
+    imageToReference->RotateY(random.Uniform(-10.0, 10.0));
+    imageToReference->Scale(0.4, 0.4, 0.4);
+    vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    imageToReference->GetMatrix(imageToReferenceMatrix);
+
+    PlusTrackedFrame frame;
+    frame.GetImageData()->DeepCopyFrom(image);
+    frame.SetTimestamp(frameIndex * 0.1);
+    frame.SetCustomFrameTransform(imageToReferenceTransformName, imageToReferenceMatrix);
+    frame.SetCustomFrameTransformStatus(imageToReferenceTransformName, FIELD_OK);
+    frames->AddTrackedFrame(&frame);
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Copy frames into a new list. Each list can be queued or added only once, as the frames are released after insertion. */
+vtkSmartPointer<vtkPlusTrackedFrameList> CopyFrames(vtkPlusTrackedFrameList* frames, int firstFrameIndex, int numberOfFrames)
+{
+  vtkSmartPointer<vtkPlusTrackedFrameList> copiedFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  for (int frameIndex = firstFrameIndex; frameIndex < firstFrameIndex + numberOfFrames && frameIndex < static_cast<int>(frames->GetNumberOfTrackedFrames()); frameIndex++)
+  {
+    copiedFrames->AddTrackedFrame(frames->GetTrackedFrame(frameIndex));
+  }
+  return copiedFrames;
+}
+
+//----------------------------------------------------------------------------
+/*! Reconstruct a volume in non-pipelined mode, as a reference */
+PlusStatus ReconstructReferenceVolume(vtkPlusTrackedFrameList* frames, int firstFrameIndex, int numberOfFrames, const PlusTransformName& imageToReferenceTransformName,
+                                      bool outputExtentFromFrames, vtkImageData* referenceVolume, int& numberOfInsertedFrames)
+{
+  vtkSmartPointer<vtkPlusTestVolumeReconstructor> reconstructor = vtkSmartPointer<vtkPlusTestVolumeReconstructor>::New();
+  vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester> tester = vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester>::New();
+  std::string errorMessage;
+  if (tester->SetUp(reconstructor, imageToReferenceTransformName, outputExtentFromFrames ? frames : NULL, false, PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES) != PLUS_SUCCESS
+      || tester->AddFrames(CopyFrames(frames, firstFrameIndex, numberOfFrames)) != PLUS_SUCCESS
+      || tester->GetReconstructedVolume(referenceVolume, errorMessage, false) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to reconstruct reference volume " << errorMessage);
+    return PLUS_FAIL;
+  }
+  numberOfInsertedFrames = reconstructor->NumberOfInsertedFrames;
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+/*! Compare the volume reconstructed in pipelined mode to the volume reconstructed in non-pipelined mode */
+int TestPipelinedReconstruction(vtkPlusTrackedFrameList* frames, const PlusTransformName& imageToReferenceTransformName, bool outputExtentFromFrames)
+{
+  LOG_INFO("Test pipelined reconstruction of " << frames->GetNumberOfTrackedFrames() << " frames");
+  int numberOfFailures = 0;
+  int numberOfFrames = frames->GetNumberOfTrackedFrames();
+
+  vtkSmartPointer<vtkImageData> referenceVolume = vtkSmartPointer<vtkImageData>::New();
+  int expectedNumberOfInsertedFrames = 0;
+  if (ReconstructReferenceVolume(frames, 0, numberOfFrames, imageToReferenceTransformName, outputExtentFromFrames, referenceVolume, expectedNumberOfInsertedFrames) != PLUS_SUCCESS)
+  {
+    return 1;
+  }
+
+  vtkSmartPointer<vtkPlusTestVolumeReconstructor> reconstructor = vtkSmartPointer<vtkPlusTestVolumeReconstructor>::New();
+  reconstructor->InsertionDelaySec = PIPELINED_INSERTION_DELAY_SEC;
+  vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester> tester = vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester>::New();
+  if (tester->SetUp(reconstructor, imageToReferenceTransformName, outputExtentFromFrames ? frames : NULL, true, PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES) != PLUS_SUCCESS
+      || tester->StartInsertionThread() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set up pipelined reconstruction");
+    return numberOfFailures + 1;
+  }
+
+  for (int firstFrameIndex = 0; firstFrameIndex < numberOfFrames; firstFrameIndex += NUMBER_OF_FRAMES_PER_BATCH)
+  {
+    if (tester->QueueFrames(CopyFrames(frames, firstFrameIndex, NUMBER_OF_FRAMES_PER_BATCH)) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to queue frames starting at frame " << firstFrameIndex);
+      numberOfFailures++;
+    }
+  }
+
+  // Reconstruction is not enabled (as after stopping it), so the request has to wait for the queued frames
+  LOG_INFO("Number of queued frames when the volume is requested: " << tester->GetNumberOfQueuedFrames());
+  vtkSmartPointer<vtkImageData> pipelinedVolume = vtkSmartPointer<vtkImageData>::New();
+  std::string errorMessage;
+  if (tester->GetReconstructedVolume(pipelinedVolume, errorMessage, false) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to get pipelined volume: " << errorMessage);
+    return numberOfFailures + 1;
+  }
+  if (reconstructor->NumberOfInsertedFrames != expectedNumberOfInsertedFrames)
+  {
+    LOG_ERROR("Volume is returned before all queued frames are inserted: " << reconstructor->NumberOfInsertedFrames << " frames are inserted, expected " << expectedNumberOfInsertedFrames);
+    numberOfFailures++;
+  }
+  if (!PlusTesting::AreVolumesEqual(referenceVolume, pipelinedVolume))
+  {
+    LOG_ERROR("Volume reconstructed in pipelined mode differs from the non-pipelined reconstruction");
+    numberOfFailures++;
+  }
+  if (tester->GetPeakNumberOfQueuedFrames() > PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES)
+  {
+    LOG_ERROR("Number of queued frames exceeded the limit: " << tester->GetPeakNumberOfQueuedFrames() << " > " << PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES);
+    numberOfFailures++;
+  }
+
+  if (tester->StopInsertionThread() != PLUS_SUCCESS || tester->GetNumberOfQueuedFrames() != 0)
+  {
+    LOG_ERROR("Failed to stop insertion thread");
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Queueing has to block while the queue is full, and has to be released when the insertion thread stops */
+int TestQueueThrottling(vtkPlusTrackedFrameList* frames, const PlusTransformName& imageToReferenceTransformName)
+{
+  LOG_INFO("Test insertion queue throttling");
+  int numberOfFailures = 0;
+  const int maxNumberOfQueuedFrames = 4;
+  const int numberOfFramesPerBatch = 3;
+
+  vtkSmartPointer<vtkPlusTestVolumeReconstructor> reconstructor = vtkSmartPointer<vtkPlusTestVolumeReconstructor>::New();
+  vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester> tester = vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester>::New();
+  if (tester->SetUp(reconstructor, imageToReferenceTransformName, NULL, true, maxNumberOfQueuedFrames) != PLUS_SUCCESS)
+  {
+    return 1;
+  }
+  tester->SetInsertionThreadStalled(true);
+
+  // The first batch fits into the queue
+  if (tester->QueueFrames(CopyFrames(frames, 0, numberOfFramesPerBatch)) != PLUS_SUCCESS || tester->GetNumberOfQueuedFrames() != numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Failed to queue the first batch");
+    numberOfFailures++;
+  }
+
+  // The second batch does not fit, it has to wait until the first batch is inserted
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  TestThreadData producer;
+  producer.Tester = tester;
+  producer.Frames = CopyFrames(frames, numberOfFramesPerBatch, numberOfFramesPerBatch);
+  producer.Completed = false;
+  producer.Status = PLUS_FAIL;
+  int producerThreadId = threader->SpawnThread((vtkThreadFunctionType)&QueueFramesThread, &producer);
+  vtkPlusAccurateTimer::Delay(BLOCKING_DETECTION_TIME_SEC);
+  if (producer.Completed || tester->GetNumberOfQueuedFrames() != numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Frames were queued while the queue was full");
+    numberOfFailures++;
+  }
+  if (tester->InsertNextQueuedBatch() != numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Failed to insert the first batch");
+    numberOfFailures++;
+  }
+  if (!PlusTesting::WaitForCondition([&producer]() { return producer.Completed.load(); }))
+  {
+    LOG_ERROR("Queueing frames is still blocked after the queue has been emptied");
+    tester->SetInsertionThreadStalled(false); // release the producer thread
+    threader->TerminateThread(producerThreadId);
+    return numberOfFailures + 1;
+  }
+  threader->TerminateThread(producerThreadId);
+  if (producer.Status != PLUS_SUCCESS || tester->GetNumberOfQueuedFrames() != numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Failed to queue the second batch");
+    numberOfFailures++;
+  }
+  tester->InsertNextQueuedBatch();
+
+  // A batch that is larger than the queue is accepted into an empty queue
+  const int largeBatchSize = 2 * maxNumberOfQueuedFrames;
+  if (tester->QueueFrames(CopyFrames(frames, 2 * numberOfFramesPerBatch, largeBatchSize)) != PLUS_SUCCESS
+      || tester->GetNumberOfQueuedFrames() != largeBatchSize)
+  {
+    LOG_ERROR("Failed to queue a batch that is larger than the queue");
+    numberOfFailures++;
+  }
+
+  // Stopping the insertion thread releases the blocked producer, its frames are not queued
+  producer.Frames = CopyFrames(frames, 2 * numberOfFramesPerBatch + largeBatchSize, numberOfFramesPerBatch);
+  producer.Completed = false;
+  producer.Status = PLUS_SUCCESS;
+  producerThreadId = threader->SpawnThread((vtkThreadFunctionType)&QueueFramesThread, &producer);
+  vtkPlusAccurateTimer::Delay(BLOCKING_DETECTION_TIME_SEC);
+  if (producer.Completed)
+  {
+    LOG_ERROR("Frames were queued while the queue was full");
+    numberOfFailures++;
+  }
+  int oldVerboseLevel = vtkPlusLogger::Instance()->GetLogLevel();
+  vtkPlusLogger::Instance()->SetLogLevel(vtkPlusLogger::LOG_LEVEL_ERROR - 1); // the producer reports that the frames are not queued
+  tester->SetInsertionThreadStalled(false);
+  bool producerReleased = PlusTesting::WaitForCondition([&producer]() { return producer.Completed.load(); });
+  vtkPlusLogger::Instance()->SetLogLevel(oldVerboseLevel);
+  if (!producerReleased || producer.Status == PLUS_SUCCESS)
+  {
+    LOG_ERROR("Queueing frames is not released when the insertion thread stops");
+    numberOfFailures++;
+  }
+  threader->TerminateThread(producerThreadId);
+
+  if (reconstructor->NumberOfInsertedFrames != 2 * numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Unexpected number of inserted frames: " << reconstructor->NumberOfInsertedFrames);
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Reset has to discard the queued frames and the remaining frames of the batch that is being inserted */
+int TestResetDiscardsQueuedFrames(vtkPlusTrackedFrameList* frames, const PlusTransformName& imageToReferenceTransformName)
+{
+  LOG_INFO("Test reset in pipelined mode");
+  int numberOfFailures = 0;
+  const int numberOfFramesPerBatch = 3;
+
+  vtkSmartPointer<vtkPlusTestVolumeReconstructor> reconstructor = vtkSmartPointer<vtkPlusTestVolumeReconstructor>::New();
+  vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester> tester = vtkSmartPointer<vtkPlusVirtualVolumeReconstructorTester>::New();
+  if (tester->SetUp(reconstructor, imageToReferenceTransformName, NULL, true, PIPELINED_MAX_NUMBER_OF_QUEUED_FRAMES) != PLUS_SUCCESS)
+  {
+    return 1;
+  }
+
+  // Frames in the queue
+  tester->SetInsertionThreadStalled(true);
+  tester->QueueFrames(CopyFrames(frames, 0, numberOfFramesPerBatch));
+  tester->QueueFrames(CopyFrames(frames, numberOfFramesPerBatch, numberOfFramesPerBatch));
+  if (tester->GetNumberOfQueuedFrames() != 2 * numberOfFramesPerBatch)
+  {
+    LOG_ERROR("Failed to queue frames");
+    numberOfFailures++;
+  }
+  tester->Reset();
+  if (tester->GetNumberOfQueuedFrames() != 0 || tester->InsertNextQueuedBatch() != 0)
+  {
+    LOG_ERROR("Queued frames are not discarded by reset");
+    numberOfFailures++;
+  }
+  tester->SetInsertionThreadStalled(false);
+
+  // Frames of the batch that is being inserted
+  reconstructor->InsertionBlocked = true;
+  if (tester->StartInsertionThread() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start insertion thread");
+    return numberOfFailures + 1;
+  }
+  tester->QueueFrames(CopyFrames(frames, 0, numberOfFramesPerBatch));
+  vtkPlusTestVolumeReconstructor* reconstructorPtr = reconstructor;
+  if (!PlusTesting::WaitForCondition([reconstructorPtr]() { return reconstructorPtr->NumberOfInsertionRequests > 0; }))
+  {
+    LOG_ERROR("Insertion thread did not start inserting the queued frames");
+    reconstructor->InsertionBlocked = false;
+    tester->StopInsertionThread();
+    return numberOfFailures + 1;
+  }
+  // The first frame of the batch is being inserted, reset the volume meanwhile
+  unsigned int resetCounterBeforeReset = tester->GetResetCounter();
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  TestThreadData resetter;
+  resetter.Tester = tester;
+  resetter.Completed = false;
+  resetter.Status = PLUS_FAIL;
+  int resetThreadId = threader->SpawnThread((vtkThreadFunctionType)&ResetThread, &resetter);
+  vtkPlusVirtualVolumeReconstructorTester* testerPtr = tester;
+  bool resetRequested = PlusTesting::WaitForCondition([testerPtr, resetCounterBeforeReset]() { return testerPtr->GetResetCounter() != resetCounterBeforeReset; });
+  reconstructor->InsertionBlocked = false;
+  threader->TerminateThread(resetThreadId);
+  tester->WaitForQueuedFrames();
+  if (!resetRequested || resetter.Status != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to reset the volume while frames were inserted");
+    numberOfFailures++;
+  }
+  if (reconstructor->NumberOfInsertedFrames != 1)
+  {
+    LOG_ERROR("Frames of the batch are inserted after reset: " << reconstructor->NumberOfInsertedFrames << " frames are inserted, expected 1");
+    numberOfFailures++;
+  }
+  vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+  std::string errorMessage;
+  if (tester->GetReconstructedVolume(volume, errorMessage, false) != PLUS_SUCCESS || !PlusTesting::IsVolumeEmpty(volume))
+  {
+    LOG_ERROR("Volume is not empty after reset");
+    numberOfFailures++;
+  }
+
+  // Frames that are queued after the reset are inserted
+  tester->QueueFrames(CopyFrames(frames, numberOfFramesPerBatch, numberOfFramesPerBatch));
+  vtkSmartPointer<vtkImageData> referenceVolume = vtkSmartPointer<vtkImageData>::New();
+  int expectedNumberOfInsertedFrames = 0;
+  if (ReconstructReferenceVolume(frames, numberOfFramesPerBatch, numberOfFramesPerBatch, imageToReferenceTransformName, false, referenceVolume, expectedNumberOfInsertedFrames) != PLUS_SUCCESS
+      || tester->GetReconstructedVolume(volume, errorMessage, false) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to get volume after reset");
+    numberOfFailures++;
+  }
+  else if (!PlusTesting::AreVolumesEqual(referenceVolume, volume))
+  {
+    LOG_ERROR("Volume reconstructed after reset differs from the reference");
+    numberOfFailures++;
+  }
+
+  tester->StopInsertionThread();
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+  std::string inputSeqFilename;
+  std::string imageToReferenceTransformNameStr = "ImageToReference";
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputSeqFilename, "Sequence file that is reconstructed in pipelined and non-pipelined mode. If not specified then synthetic frames are used.");
+  args.AddArgument("--image-to-reference-transform", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &imageToReferenceTransformNameStr, "ImageToReference transform name in the sequence file (default: ImageToReference)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  PlusTransformName imageToReferenceTransformName;
+  if (imageToReferenceTransformName.SetTransformName(imageToReferenceTransformNameStr.c_str()) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Invalid ImageToReference transform name: " << imageToReferenceTransformNameStr);
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkPlusTrackedFrameList> syntheticFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  CreateTestData(syntheticFrames, imageToReferenceTransformName);
+
+  int numberOfFailures = 0;
+  if (inputSeqFilename.empty())
+  {
+    numberOfFailures += TestPipelinedReconstruction(syntheticFrames, imageToReferenceTransformName, false);
+  }
+  else
+  {
+    vtkSmartPointer<vtkPlusTrackedFrameList> savedFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+    if (vtkPlusSequenceIO::Read(inputSeqFilename, savedFrames) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to read sequence file: " << inputSeqFilename);
+      exit(EXIT_FAILURE);
+    }
+    numberOfFailures += TestPipelinedReconstruction(savedFrames, imageToReferenceTransformName, true);
+  }
+  numberOfFailures += TestQueueThrottling(syntheticFrames, imageToReferenceTransformName);
+  numberOfFailures += TestResetDiscardsQueuedFrames(syntheticFrames, imageToReferenceTransformName);
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("vtkPlusVirtualVolumeReconstructorTest failed with " << numberOfFailures << " failures");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("vtkPlusVirtualVolumeReconstructorTest completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -43,6 +43,7 @@ vtkPlusVirtualCapture::vtkPlusVirtualCapture()
   , BaseFilename("TrackedImageSequence.nrrd")
   , Writer(NULL)
   , EnableFileCompression(false)
+  , EnableStreamingWrite(false)
   , IsHeaderPrepared(false)
   , TotalFramesRecorded(0)
   , EnableCapturingOnStart(false)
@@ -100,6 +101,7 @@ PlusStatus vtkPlusVirtualCapture::ReadConfiguration(vtkXMLDataElement* rootConfi
 
   XML_READ_CSTRING_ATTRIBUTE_OPTIONAL(BaseFilename, deviceConfig);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableFileCompression, deviceConfig);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableStreamingWrite, deviceConfig);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableCapturingOnStart, deviceConfig);
 
   this->SetRequestedFrameRate(15.0);   // default
@@ -116,6 +118,7 @@ PlusStatus vtkPlusVirtualCapture::WriteConfiguration(vtkXMLDataElement* rootConf
   XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_WRITING(deviceElement, rootConfig);
   deviceElement->SetAttribute("EnableCapturing", this->EnableCapturing ? "TRUE" : "FALSE");
   deviceElement->SetAttribute("EnableFileCompression", this->EnableFileCompression ? "TRUE" : "FALSE");
+  deviceElement->SetAttribute("EnableStreamingWrite", this->EnableStreamingWrite ? "TRUE" : "FALSE");
   deviceElement->SetAttribute("EnableCaptureOnStart", this->EnableCapturingOnStart ? "TRUE" : "FALSE");
   deviceElement->SetDoubleAttribute("RequestedFrameRate", this->GetRequestedFrameRate());
 
@@ -205,6 +208,7 @@ PlusStatus vtkPlusVirtualCapture::OpenFile(const char* aFilename)
 
   this->Writer = vtkPlusSequenceIO::CreateSequenceHandlerForFile(aFilename);
   this->Writer->SetUseCompression(this->EnableFileCompression);
+  this->Writer->SetStreamingWrite(this->EnableStreamingWrite);
   this->Writer->SetTrackedFrameList(this->RecordedFrames);
   // Need to set the filename before finalizing header, because the pixel data file name depends on the file extension
   this->Writer->SetFileName(vtkPlusConfig::GetInstance()->GetOutputPath(aFilename));
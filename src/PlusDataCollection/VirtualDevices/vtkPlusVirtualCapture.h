@@ -76,6 +76,10 @@ public:
   vtkGetMacro(EnableFileCompression, bool);
   void SetEnableFileCompression(bool aFileCompression);
 
+  /*! If enabled then pixel data is written directly to its final location (see vtkPlusSequenceIOBase::GetStreamingWrite), so closing a long recording is instantaneous */
+  vtkGetMacro(EnableStreamingWrite, bool);
+  vtkSetMacro(EnableStreamingWrite, bool);
+
   vtkSetMacro(EnableCapturingOnStart, bool);
   vtkGetMacro(EnableCapturingOnStart, bool);
 
@@ -152,6 +156,9 @@ protected:
   /*! When closing the file, re-read the data from file, and write it compressed */
   bool EnableFileCompression;
 
+  /*! Write pixel data directly to its final location. For single-file formats the pixel data is stored in a separate file. */
+  bool EnableStreamingWrite;
+
   /*! Preparing the header requires image data already collected, this flag makes the header preparation wait until valid data is collected */
   bool IsHeaderPrepared;
 
@@ -16,11 +16,20 @@ See License.txt for details.
 #include "vtkPlusVolumeReconstructor.h"
 #include "vtksys/SystemTools.hxx"
 
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+// STL includes
+#include <chrono>
+
 //----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkPlusVirtualVolumeReconstructor);
 
 static const int MAX_ALLOWED_RECONSTRUCTION_LAG_SEC = 3.0; // if the reconstruction lags more than this then it'll skip frames to catch up
+static const int DEFAULT_MAX_NUMBER_OF_QUEUED_FRAMES = 100;
+static const int INSERTION_QUEUE_WAIT_TIMEOUT_MS = 200; // the waiting threads check this often whether they have to stop
 
 //----------------------------------------------------------------------------
 vtkPlusVirtualVolumeReconstructor::vtkPlusVirtualVolumeReconstructor()
@@ -34,23 +43,43 @@ vtkPlusVirtualVolumeReconstructor::vtkPlusVirtualVolumeReconstructor()
   , TotalFramesRecorded(0)
   , EnableReconstruction(false)
   , VolumeReconstructorAccessMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
+  , EnablePipelinedReconstruction(false)
+  , MaxNumberOfQueuedFrames(DEFAULT_MAX_NUMBER_OF_QUEUED_FRAMES)
+  , InsertionThreadId(-1)
+  , InsertionThreadActive(std::make_pair(false, false))
+  , NumberOfQueuedFrames(0)
+  , PeakNumberOfQueuedFrames(0)
+  , ResetCounter(0)
+  , SnapshotFrontIndex(0)
+  , SnapshotValid(false)
+  , SnapshotHoleFilled(false)
+  , SnapshotModifiedTime(0)
 {
   // The data capture thread will be used to regularly read the frames and write to disk
   this->StartThreadForInternalUpdates = true;
 
   this->VolumeReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
   this->TransformRepository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+
+  this->SnapshotVolumes[0] = vtkSmartPointer<vtkImageData>::New();
+  this->SnapshotVolumes[1] = vtkSmartPointer<vtkImageData>::New();
 }
 
 //----------------------------------------------------------------------------
 vtkPlusVirtualVolumeReconstructor::~vtkPlusVirtualVolumeReconstructor()
 {
+  this->StopInsertionThread();
 }
 
 //----------------------------------------------------------------------------
 void vtkPlusVirtualVolumeReconstructor::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "EnablePipelinedReconstruction: " << (this->EnablePipelinedReconstruction ? "TRUE" : "FALSE") << std::endl;
+  os << indent << "MaxNumberOfQueuedFrames: " << this->MaxNumberOfQueuedFrames << std::endl;
+  std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+  os << indent << "NumberOfQueuedFrames: " << this->NumberOfQueuedFrames << std::endl;
+  os << indent << "PeakNumberOfQueuedFrames: " << this->PeakNumberOfQueuedFrames << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -61,6 +90,13 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::ReadConfiguration(vtkXMLDataElemen
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableReconstruction, deviceConfig);
   XML_READ_CSTRING_ATTRIBUTE_OPTIONAL(OutputVolFilename, deviceConfig);
   XML_READ_CSTRING_ATTRIBUTE_OPTIONAL(OutputVolDeviceName, deviceConfig);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnablePipelinedReconstruction, deviceConfig);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, MaxNumberOfQueuedFrames, deviceConfig);
+  if (this->MaxNumberOfQueuedFrames < 1)
+  {
+    LOG_WARNING("MaxNumberOfQueuedFrames must be positive, use default: " << DEFAULT_MAX_NUMBER_OF_QUEUED_FRAMES);
+    this->MaxNumberOfQueuedFrames = DEFAULT_MAX_NUMBER_OF_QUEUED_FRAMES;
+  }
 
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
   this->VolumeReconstructor->ReadConfiguration(deviceConfig);
@@ -77,6 +113,16 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::WriteConfiguration(vtkXMLDataEleme
 
   deviceElement->SetAttribute("OutputVolFilename", this->OutputVolFilename.c_str());
   deviceElement->SetAttribute("OutputVolDeviceName", this->OutputVolDeviceName.c_str());
+  if (this->EnablePipelinedReconstruction)
+  {
+    deviceElement->SetAttribute("EnablePipelinedReconstruction", "TRUE");
+    deviceElement->SetIntAttribute("MaxNumberOfQueuedFrames", this->MaxNumberOfQueuedFrames);
+  }
+  else
+  {
+    XML_REMOVE_ATTRIBUTE(deviceElement, "EnablePipelinedReconstruction");
+    XML_REMOVE_ATTRIBUTE(deviceElement, "MaxNumberOfQueuedFrames");
+  }
 
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
   this->VolumeReconstructor->WriteConfiguration(deviceElement);
@@ -109,6 +155,11 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::InternalConnect()
 
   m_LastUpdateTime = vtkPlusAccurateTimer::GetSystemTime();
 
+  if (this->EnablePipelinedReconstruction)
+  {
+    return this->StartInsertionThread();
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -116,7 +167,9 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::InternalConnect()
 PlusStatus vtkPlusVirtualVolumeReconstructor::InternalDisconnect()
 {
   SetEnableReconstruction(false);
-  return PLUS_SUCCESS;
+  // Frames that have been already acquired are inserted before the insertion thread is stopped
+  this->WaitForQueuedFrames();
+  return this->StopInsertionThread();
 }
 
 //----------------------------------------------------------------------------
@@ -165,6 +218,11 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::InternalUpdate()
     LOG_WARNING("RequestedFrameRate is invalid, use default: " << 1 / requestedFramePeriodSec);
   }
 
+  if (this->EnablePipelinedReconstruction)
+  {
+    return this->InternalUpdatePipelined(requestedFramePeriodSec, maxProcessingTimeSec);
+  }
+
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
   if (!this->EnableReconstruction)
   {
@@ -213,6 +271,260 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::InternalUpdate()
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::InternalUpdatePipelined(double requestedFramePeriodSec, double maxProcessingTimeSec)
+{
+  if (this->OutputChannels.empty())
+  {
+    LOG_ERROR("No output channels defined");
+    return PLUS_FAIL;
+  }
+  vtkPlusChannel* outputChannel = this->OutputChannels[0];
+
+  // The volume reconstructor is not locked while the frames are retrieved, so the insertion thread can keep inserting the previous frames
+  vtkSmartPointer<vtkPlusTrackedFrameList> recordedFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (outputChannel->GetTrackedFrameListSampled(m_LastAlreadyRecordedFrameTimestamp, m_NextFrameToBeRecordedTimestamp, recordedFrames, requestedFramePeriodSec, maxProcessingTimeSec) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Error while getting tracked frame list from data collector during volume reconstruction. Last recorded timestamp: " << std::fixed << m_NextFrameToBeRecordedTimestamp);
+  }
+  int nbFramesRecorded = recordedFrames->GetNumberOfTrackedFrames();
+
+  // Frames are not skipped if the reconstruction lags behind: the acquisition is throttled by the bounded insertion queue instead
+  PlusStatus status = this->QueueFrames(recordedFrames);
+  if (status != PLUS_SUCCESS)
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Unable to queue " << nbFramesRecorded << " frames for volume reconstruction");
+  }
+
+  this->TotalFramesRecorded += nbFramesRecorded;
+  m_LastUpdateTime = vtkPlusAccurateTimer::GetSystemTime();
+
+  return status;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::QueueFrames(vtkPlusTrackedFrameList* trackedFrameList)
+{
+  QueuedFrameBatch batch;
+  batch.TrackedFrameList = trackedFrameList;
+  {
+    // If the volume is reset while the transforms are resolved then the frames are discarded
+    std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+    batch.ResetCounter = this->ResetCounter;
+  }
+
+  PlusStatus status = PLUS_SUCCESS;
+  {
+    // The transform repository and the reconstruction parameters are protected by the volume reconstructor mutex.
+    // Resolving the transforms is fast, so the insertion thread is only blocked for a short time.
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
+
+    PlusTransformName imageToReferenceTransformName;
+    if (this->VolumeReconstructor->GetImageToReferenceTransformName(imageToReferenceTransformName) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Invalid ImageToReference transform name");
+      return PLUS_FAIL;
+    }
+
+    const int numberOfFrames = trackedFrameList->GetNumberOfTrackedFrames();
+    for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex += this->VolumeReconstructor->GetSkipInterval())
+    {
+      PlusTrackedFrame* frame = trackedFrameList->GetTrackedFrame(frameIndex);
+      if (this->TransformRepository->SetTransforms(*frame) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to update transform repository with frame #" << frameIndex);
+        status = PLUS_FAIL;
+        continue;
+      }
+      QueuedFrame queuedFrame;
+      queuedFrame.Frame = frame;
+      queuedFrame.ImageToReferenceTransform = vtkSmartPointer<vtkMatrix4x4>::New();
+      bool isMatrixValid(false);
+      if (this->TransformRepository->GetTransform(imageToReferenceTransformName, queuedFrame.ImageToReferenceTransform, &isMatrixValid) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to get ImageToReference transform for frame #" << frameIndex);
+        status = PLUS_FAIL;
+        continue;
+      }
+      if (!isMatrixValid)
+      {
+        // Insert only valid frame into volume
+        LOG_DEBUG("ImageToReference transform is invalid for frame #" << frameIndex << ", therefore this frame is not inserted into the volume");
+        continue;
+      }
+      batch.Frames.push_back(queuedFrame);
+    }
+  }
+
+  if (batch.Frames.empty())
+  {
+    return status;
+  }
+
+  int numberOfFramesInBatch = static_cast<int>(batch.Frames.size());
+  {
+    std::unique_lock<std::mutex> queueLock(this->InsertionQueueMutex);
+    // Wait for free space in the queue. A batch is always accepted into an empty queue, so a batch that is larger
+    // than the queue cannot block the acquisition forever.
+    while (this->NumberOfQueuedFrames > 0 && this->NumberOfQueuedFrames + numberOfFramesInBatch > this->MaxNumberOfQueuedFrames
+           && this->InsertionThreadActive.first)
+    {
+      this->InsertionQueueChanged.wait_for(queueLock, std::chrono::milliseconds(INSERTION_QUEUE_WAIT_TIMEOUT_MS));
+    }
+    if (!this->InsertionThreadActive.first)
+    {
+      LOG_ERROR("Volume reconstruction insertion thread is not running, " << numberOfFramesInBatch << " frames are not inserted into the volume");
+      return PLUS_FAIL;
+    }
+    this->InsertionQueue.push_back(batch);
+    this->NumberOfQueuedFrames += numberOfFramesInBatch;
+    if (this->NumberOfQueuedFrames > this->PeakNumberOfQueuedFrames)
+    {
+      this->PeakNumberOfQueuedFrames = this->NumberOfQueuedFrames;
+    }
+  }
+  this->InsertionQueueChanged.notify_all();
+
+  return status;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::InsertQueuedFrames(QueuedFrameBatch& batch)
+{
+  PlusStatus status = PLUS_SUCCESS;
+  for (std::vector<QueuedFrame>::iterator frameIt = batch.Frames.begin(); frameIt != batch.Frames.end(); ++frameIt)
+  {
+    // Lock only for a single frame, so that configuration changes and volume requests do not wait for the whole batch
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
+    {
+      // Reset increments the counter before it locks the volume reconstructor, so a reset that is waiting for this frame is detected here
+      std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+      if (batch.ResetCounter != this->ResetCounter)
+      {
+        LOG_DEBUG("Volume is reset, " << (batch.Frames.end() - frameIt) << " frames of the batch are not inserted into the volume");
+        break;
+      }
+    }
+    if (this->VolumeReconstructor->InsertTrackedFrame(frameIt->Frame, frameIt->ImageToReferenceTransform) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to insert tracked frame into the volume");
+      status = PLUS_FAIL;
+    }
+  }
+  return status;
+}
+
+//----------------------------------------------------------------------------
+void* vtkPlusVirtualVolumeReconstructor::InsertionThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusVirtualVolumeReconstructor* self = (vtkPlusVirtualVolumeReconstructor*)(data->UserData);
+
+  while (self->InsertionThreadActive.first)
+  {
+    QueuedFrameBatch batch;
+    {
+      std::unique_lock<std::mutex> queueLock(self->InsertionQueueMutex);
+      if (!self->InsertionQueueChanged.wait_for(queueLock, std::chrono::milliseconds(INSERTION_QUEUE_WAIT_TIMEOUT_MS),
+                                                [self]() { return !self->InsertionQueue.empty(); }))
+      {
+        // Timeout, check if the thread has to be stopped
+        continue;
+      }
+      batch = self->InsertionQueue.front();
+      self->InsertionQueue.pop_front();
+    }
+
+    if (self->InsertQueuedFrames(batch) != PLUS_SUCCESS)
+    {
+      LOG_ERROR(self->GetDeviceId() << ": Unable to add " << batch.Frames.size() << " frames for volume reconstruction");
+    }
+
+    {
+      std::lock_guard<std::mutex> queueLock(self->InsertionQueueMutex);
+      self->NumberOfQueuedFrames -= static_cast<int>(batch.Frames.size());
+    }
+    self->InsertionQueueChanged.notify_all();
+  }
+
+  // Close thread
+  std::lock_guard<std::mutex> queueLock(self->InsertionQueueMutex);
+  self->InsertionThreadActive.second = false;
+  self->InsertionQueueChanged.notify_all();
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::StartInsertionThread()
+{
+  if (this->InsertionThreadId >= 0)
+  {
+    // already running
+    return PLUS_SUCCESS;
+  }
+  {
+    std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+    this->InsertionQueue.clear();
+    this->NumberOfQueuedFrames = 0;
+    this->PeakNumberOfQueuedFrames = 0;
+    // The thread is marked as running before it is spawned, so that a stop request cannot miss it
+    this->InsertionThreadActive = std::make_pair(true, true);
+  }
+  this->InsertionThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&InsertionThread, this);
+  if (this->InsertionThreadId < 0)
+  {
+    LOG_ERROR("Failed to start volume reconstruction insertion thread");
+    this->InsertionThreadActive = std::make_pair(false, false);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::StopInsertionThread()
+{
+  if (this->InsertionThreadId < 0)
+  {
+    // not running
+    return PLUS_SUCCESS;
+  }
+
+  {
+    std::unique_lock<std::mutex> queueLock(this->InsertionQueueMutex);
+    this->InsertionThreadActive.first = false;
+    this->InsertionQueueChanged.notify_all();
+    while (this->InsertionThreadActive.second)
+    {
+      // Wait until the thread stops
+      this->InsertionQueueChanged.wait_for(queueLock, std::chrono::milliseconds(INSERTION_QUEUE_WAIT_TIMEOUT_MS));
+    }
+    if (!this->InsertionQueue.empty())
+    {
+      LOG_WARNING(this->NumberOfQueuedFrames << " queued frames are discarded, they were not inserted into the reconstructed volume");
+    }
+    this->InsertionQueue.clear();
+    this->NumberOfQueuedFrames = 0;
+  }
+
+  this->InsertionThreadId = -1;
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusVirtualVolumeReconstructor::WaitForQueuedFrames()
+{
+  std::unique_lock<std::mutex> queueLock(this->InsertionQueueMutex);
+  while (this->NumberOfQueuedFrames > 0 && this->InsertionThreadActive.first)
+  {
+    this->InsertionQueueChanged.wait_for(queueLock, std::chrono::milliseconds(INSERTION_QUEUE_WAIT_TIMEOUT_MS));
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusVirtualVolumeReconstructor::GetNumberOfQueuedFrames()
+{
+  std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+  return this->NumberOfQueuedFrames;
+}
 
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusVirtualVolumeReconstructor::NotifyConfigured()
@@ -267,6 +579,19 @@ void vtkPlusVirtualVolumeReconstructor::SetEnableReconstruction(bool aValue)
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusVirtualVolumeReconstructor::Reset()
 {
+  {
+    // Frames that are acquired before the reset must not appear in the cleared volume
+    std::lock_guard<std::mutex> queueLock(this->InsertionQueueMutex);
+    for (std::deque<QueuedFrameBatch>::iterator batchIt = this->InsertionQueue.begin(); batchIt != this->InsertionQueue.end(); ++batchIt)
+    {
+      this->NumberOfQueuedFrames -= static_cast<int>(batchIt->Frames.size());
+    }
+    this->InsertionQueue.clear();
+    // The batch that is being inserted is discarded, too
+    this->ResetCounter++;
+  }
+  this->InsertionQueueChanged.notify_all();
+
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
   this->VolumeReconstructor->Reset();
   return PLUS_SUCCESS;
@@ -347,6 +672,69 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::GetReconstructedVolumeFromFile(con
 PlusStatus vtkPlusVirtualVolumeReconstructor::GetReconstructedVolume(vtkImageData* reconstructedVolume, std::string& outErrorMessage, bool applyHoleFilling/*=true*/)
 {
   outErrorMessage.clear();
+  if (this->EnablePipelinedReconstruction && this->InsertionThreadId >= 0)
+  {
+    return this->GetReconstructedVolumeSnapshot(reconstructedVolume, outErrorMessage, applyHoleFilling);
+  }
+  return this->ExtractReconstructedVolume(reconstructedVolume, outErrorMessage, applyHoleFilling);
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::GetReconstructedVolumeSnapshot(vtkImageData* reconstructedVolume, std::string& outErrorMessage, bool applyHoleFilling)
+{
+  if (!this->EnableReconstruction)
+  {
+    // Reconstruction is stopped, the caller expects all the acquired frames to be in the volume
+    this->WaitForQueuedFrames();
+  }
+
+  std::unique_lock<std::mutex> snapshotUpdateLock(this->SnapshotUpdateMutex, std::try_to_lock);
+  if (!snapshotUpdateLock.owns_lock())
+  {
+    // Another thread is updating the snapshot, return the current one instead of waiting for the update
+    {
+      std::lock_guard<std::mutex> snapshotLock(this->SnapshotMutex);
+      if (this->SnapshotValid && this->SnapshotHoleFilled == applyHoleFilling)
+      {
+        reconstructedVolume->DeepCopy(this->SnapshotVolumes[this->SnapshotFrontIndex]);
+        return PLUS_SUCCESS;
+      }
+    }
+    snapshotUpdateLock.lock();
+  }
+
+  // Only the thread that owns the snapshot update lock accesses the back buffer and modifies the snapshot properties,
+  // therefore they can be read here without locking the snapshot mutex
+  bool snapshotUpToDate = false;
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
+    snapshotUpToDate = this->SnapshotValid && this->SnapshotHoleFilled == applyHoleFilling
+                       && this->SnapshotModifiedTime == this->VolumeReconstructor->GetMTime();
+  }
+
+  if (!snapshotUpToDate)
+  {
+    int backIndex = 1 - this->SnapshotFrontIndex;
+    vtkMTimeType volumeModifiedTime = 0;
+    if (this->ExtractReconstructedVolume(this->SnapshotVolumes[backIndex], outErrorMessage, applyHoleFilling, &volumeModifiedTime) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    std::lock_guard<std::mutex> snapshotLock(this->SnapshotMutex);
+    this->SnapshotFrontIndex = backIndex;
+    this->SnapshotValid = true;
+    this->SnapshotHoleFilled = applyHoleFilling;
+    this->SnapshotModifiedTime = volumeModifiedTime;
+  }
+
+  std::lock_guard<std::mutex> snapshotLock(this->SnapshotMutex);
+  reconstructedVolume->DeepCopy(this->SnapshotVolumes[this->SnapshotFrontIndex]);
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualVolumeReconstructor::ExtractReconstructedVolume(vtkImageData* reconstructedVolume, std::string& outErrorMessage, bool applyHoleFilling, vtkMTimeType* volumeModifiedTime/*=NULL*/)
+{
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->VolumeReconstructorAccessMutex);
   bool oldFillHoles = this->VolumeReconstructor->GetFillHoles();
   if (!applyHoleFilling)
@@ -358,6 +746,11 @@ PlusStatus vtkPlusVirtualVolumeReconstructor::GetReconstructedVolume(vtkImageDat
   {
     this->VolumeReconstructor->SetFillHoles(oldFillHoles);
   }
+  if (volumeModifiedTime != NULL)
+  {
+    // Changing the hole filling setting modifies the reconstructor, so the time is queried after restoring it
+    *volumeModifiedTime = this->VolumeReconstructor->GetMTime();
+  }
 
   if (status != PLUS_SUCCESS)
   {
@@ -10,15 +10,31 @@ See License.txt for details.
 #include "vtkPlusDataCollectionExport.h"
 
 #include "vtkPlusDevice.h"
+
+// STL includes
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <vector>
 
+class vtkMatrix4x4;
 class vtkPlusTrackedFrameList;
 class vtkPlusVolumeReconstructor;
 class vtkPlusTransformRepository;
 
 /*!
 \class vtkPlusVirtualVolumeReconstructor
-\brief
+\brief Reconstructs a volume from the frames of its input channel while they are acquired
+
+By default the frames are inserted into the volume in the internal update thread. If the insertion cannot keep up
+with the acquisition then parts of the data stream are skipped.
+
+If EnablePipelinedReconstruction is set then the internal update thread only retrieves the frames and resolves their
+ImageToReference transforms. The frames are handed over through a bounded queue to an insertion thread.
+When the queue is full then the retrieval of new frames is throttled instead of skipping data.
+Reconstructed volume requests are served from a double-buffered snapshot of the volume, so requests that
+arrive while the snapshot is being updated do not wait for the reconstruction.
 
 \ingroup PlusLibDataCollection
 */
@@ -83,6 +99,24 @@ public:
 
   vtkGetMacro(TotalFramesRecorded, long int);
 
+  /*!
+    Enables inserting the frames into the volume in a separate insertion thread.
+    It has to be set before the device is connected.
+  */
+  vtkGetMacro(EnablePipelinedReconstruction, bool);
+  vtkSetMacro(EnablePipelinedReconstruction, bool);
+  vtkBooleanMacro(EnablePipelinedReconstruction, bool);
+
+  /*! Maximum number of frames that may wait for insertion into the volume in pipelined mode */
+  vtkGetMacro(MaxNumberOfQueuedFrames, int);
+  vtkSetMacro(MaxNumberOfQueuedFrames, int);
+
+  /*!
+    Number of frames that wait for insertion into the volume in pipelined mode.
+    This method is safe to be called from any thread.
+  */
+  int GetNumberOfQueuedFrames();
+
 protected:
 
   /*! Read main configuration from xml data */
@@ -117,6 +151,51 @@ protected:
 
   PlusStatus AddFrames(vtkPlusTrackedFrameList* trackedFrameList);
 
+  /*! Frame waiting for insertion into the volume */
+  struct QueuedFrame
+  {
+    /*! Frame to insert, owned by the frame list of the batch */
+    PlusTrackedFrame* Frame;
+    /*! ImageToReference transform of the frame, resolved when the frame was queued */
+    vtkSmartPointer<vtkMatrix4x4> ImageToReferenceTransform;
+  };
+
+  /*! Frames retrieved in one update of the pipelined reconstruction */
+  struct QueuedFrameBatch
+  {
+    vtkSmartPointer<vtkPlusTrackedFrameList> TrackedFrameList;
+    std::vector<QueuedFrame> Frames;
+    /*! Value of ResetCounter when the frames were queued */
+    unsigned int ResetCounter;
+  };
+
+  /*! Retrieve the new frames and queue them for insertion (pipelined mode) */
+  PlusStatus InternalUpdatePipelined(double requestedFramePeriodSec, double maxProcessingTimeSec);
+
+  /*!
+    Resolve the ImageToReference transforms of the frames and add them to the insertion queue.
+    Blocks while the queue is full.
+  */
+  PlusStatus QueueFrames(vtkPlusTrackedFrameList* trackedFrameList);
+
+  /*! Insert the frames of a batch into the volume. The volume reconstructor is only locked while a single frame is inserted. */
+  PlusStatus InsertQueuedFrames(QueuedFrameBatch& batch);
+
+  /*! Wait until all the queued frames are inserted into the volume */
+  void WaitForQueuedFrames();
+
+  PlusStatus StartInsertionThread();
+  PlusStatus StopInsertionThread();
+
+  /*! Thread that inserts the queued frames into the volume */
+  static void* InsertionThread(vtkMultiThreader::ThreadInfo* data);
+
+  /*! Get the reconstructed volume from the snapshot, update the snapshot if the volume has changed */
+  PlusStatus GetReconstructedVolumeSnapshot(vtkImageData* reconstructedVolume, std::string& outErrorMessage, bool applyHoleFilling);
+
+  /*! Extract the reconstructed volume from the volume reconstructor */
+  PlusStatus ExtractReconstructedVolume(vtkImageData* reconstructedVolume, std::string& outErrorMessage, bool applyHoleFilling, vtkMTimeType* volumeModifiedTime = NULL);
+
   /*! Get the sampling period length (in seconds). Frames are copied from the devices to the data collection buffer once in every sampling period. */
   double GetSamplingPeriodSec();
 
@@ -157,6 +236,41 @@ protected:
   /*! Mutex instance simultaneous access of writer (writer may be accessed from command processing thread and also the internal update thread) */
   vtkSmartPointer<vtkPlusRecursiveCriticalSection> VolumeReconstructorAccessMutex;
 
+  /*! If true then frames are inserted into the volume by the insertion thread */
+  bool EnablePipelinedReconstruction;
+
+  /*! Maximum number of frames in the insertion queue */
+  int MaxNumberOfQueuedFrames;
+
+  /*! Insertion thread id, negative if the thread is not running */
+  int InsertionThreadId;
+  /*! First: the insertion thread is requested to run, second: the insertion thread is running */
+  std::pair<bool, bool> InsertionThreadActive;
+
+  /*! Protects the insertion queue and the frame counters */
+  std::mutex InsertionQueueMutex;
+  /*! Signaled when frames are added to the queue or inserted into the volume */
+  std::condition_variable InsertionQueueChanged;
+  std::deque<QueuedFrameBatch> InsertionQueue;
+  /*! Number of queued frames, including the frames of the batch that is being inserted */
+  int NumberOfQueuedFrames;
+  /*! Largest number of queued frames since connect, for diagnostics */
+  int PeakNumberOfQueuedFrames;
+  /*! Incremented by Reset. Frames that were queued before the last reset are not inserted, even if their batch is already being inserted. */
+  unsigned int ResetCounter;
+
+  /*! Only one thread may update the snapshot volume at a time */
+  std::mutex SnapshotUpdateMutex;
+  /*! Protects the front snapshot volume and its properties */
+  std::mutex SnapshotMutex;
+  /*! Double-buffered snapshot: the front is served to the callers while the back is updated */
+  vtkSmartPointer<vtkImageData> SnapshotVolumes[2];
+  int SnapshotFrontIndex;
+  bool SnapshotValid;
+  bool SnapshotHoleFilled;
+  /*! Modification time of the volume reconstructor when the front snapshot was extracted */
+  vtkMTimeType SnapshotModifiedTime;
+
 private:
   vtkPlusVirtualVolumeReconstructor(const vtkPlusVirtualVolumeReconstructor&);   // Not implemented.
   void operator=(const vtkPlusVirtualVolumeReconstructor&);   // Not implemented.
@@ -278,6 +278,29 @@ PlusStatus vtkPlusBuffer::AddItem(const PlusVideoFrame* frame,
   return this->AddItem(frame->GetImage(), frame->GetImageOrientation(), frame->GetImageType(), frameNumber, clipRectangleOrigin, clipRectangleSize, unfilteredTimestamp, filteredTimestamp, customFields);
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame& trackedFrame,
+                                  long frameNumber,
+                                  const int clipRectangleOrigin[3],
+                                  const int clipRectangleSize[3],
+                                  double unfilteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
+                                  double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/)
+{
+  const PlusVideoFrame* frame = trackedFrame.GetImageData();
+  vtkImageData* image = frame->GetImage();
+  if (image == NULL)
+  {
+    LOCAL_LOG_ERROR("vtkPlusBuffer: Unable to add NULL frame to video buffer!");
+    return PLUS_FAIL;
+  }
+
+  unsigned int frameSizeInPx[3] = { 0, 0, 0 };
+  frame->GetFrameSize(frameSizeInPx);
+  return this->AddImageItem(image->GetScalarPointer(), frame->GetImageOrientation(), frameSizeInPx, image->GetScalarType(), image->GetNumberOfScalarComponents(),
+                            frame->GetImageType(), 0, frameNumber, clipRectangleOrigin, clipRectangleSize, unfilteredTimestamp, filteredTimestamp,
+                            &trackedFrame.GetStringCustomFields(), &trackedFrame.GetFrameTransformItems());
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame::FieldMapType& fields,
                                   long frameNumber,
@@ -316,7 +339,7 @@ PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame::FieldMapType& fields,
   BufferItemUidType itemUid;
 
   PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
-  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, itemUid, bufferIndex) != PLUS_SUCCESS)
+  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, unfilteredTimestamp, frameNumber, itemUid, bufferIndex) != PLUS_SUCCESS)
   {
     // Just a debug message, because we want to avoid unnecessary warning messages if the timestamp is the same as last one
     LOCAL_LOG_DEBUG("vtkPlusBuffer: Failed to prepare for adding new frame to tracker buffer!");
@@ -336,6 +359,9 @@ PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame::FieldMapType& fields,
   newObjectInBuffer->SetIndex(frameNumber);
   newObjectInBuffer->SetUid(itemUid);
 
+  // The buffer item may still contain the frame transforms of the previous item in this slot
+  newObjectInBuffer->ClearFrameTransformItems();
+
   // Add custom fields
   for (PlusTrackedFrame::FieldMapType::const_iterator it = fields.begin(); it != fields.end(); ++it)
   {
@@ -343,6 +369,117 @@ PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame::FieldMapType& fields,
     std::string name(it->first);
   }
 
+  this->NotifyNewItem();
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusBuffer::SwapItem(PlusVideoFrame& frame,
+                                   long frameNumber,
+                                   const int clipRectangleOrigin[3],
+                                   const int clipRectangleSize[3],
+                                   double unfilteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
+                                   double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
+                                   const PlusTrackedFrame::FieldMapType* customFields /*=NULL*/)
+{
+  if (frame.GetImageOrientation() != this->ImageOrientation || PlusCommon::IsClippingRequested(clipRectangleOrigin, clipRectangleSize))
+  {
+    // The image has to be reoriented or clipped, which requires copying of the pixels
+    return this->AddItem(&frame, frameNumber, clipRectangleOrigin, clipRectangleSize, unfilteredTimestamp, filteredTimestamp, customFields);
+  }
+
+  if (!frame.IsImageValid())
+  {
+    LOCAL_LOG_ERROR("vtkPlusBuffer: Unable to add invalid frame to video buffer!");
+    return PLUS_FAIL;
+  }
+
+  if (unfilteredTimestamp == UNDEFINED_TIMESTAMP)
+  {
+    unfilteredTimestamp = vtkPlusAccurateTimer::GetSystemTime();
+  }
+  if (filteredTimestamp == UNDEFINED_TIMESTAMP)
+  {
+    bool filteredTimestampProbablyValid = true;
+    if (this->StreamBuffer->CreateFilteredTimeStampForItem(frameNumber, unfilteredTimestamp, filteredTimestamp, filteredTimestampProbablyValid) != PLUS_SUCCESS)
+    {
+      LOCAL_LOG_WARNING("Failed to create filtered timestamp for video buffer item with item index: " << frameNumber);
+      return PLUS_FAIL;
+    }
+    if (!filteredTimestampProbablyValid)
+    {
+      LOG_INFO("Filtered timestamp is probably invalid for video buffer item with item index=" << frameNumber << ", time=" <<
+               unfilteredTimestamp << ". The item may have been tagged with an inaccurate timestamp, therefore it will not be recorded.");
+      return PLUS_SUCCESS;
+    }
+  }
+  else
+  {
+    this->StreamBuffer->AddToTimeStampReport(frameNumber, unfilteredTimestamp, filteredTimestamp);
+  }
+
+  unsigned int frameSizeInPx[3] = { 0, 0, 0 };
+  frame.GetFrameSize(frameSizeInPx);
+  if (!this->CheckFrameFormat(frameSizeInPx, frame.GetVTKScalarPixelType(), frame.GetImageType(), frame.GetNumberOfScalarComponents()))
+  {
+    LOG_ERROR("vtkPlusBuffer: Unable to add frame to video buffer - frame format doesn't match!");
+    return PLUS_FAIL;
+  }
+
+  {
+    int bufferIndex(0);
+    BufferItemUidType itemUid;
+    PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
+    if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, unfilteredTimestamp, frameNumber, itemUid, bufferIndex) != PLUS_SUCCESS)
+    {
+      // Just a debug message, because we want to avoid unnecessary warning messages if the timestamp is the same as last one
+      LOCAL_LOG_DEBUG("vtkPlusBuffer: Failed to prepare for adding new frame to video buffer!");
+      return PLUS_FAIL;
+    }
+
+    StreamBufferItem* newObjectInBuffer = this->StreamBuffer->GetBufferItemPointerFromBufferIndex(bufferIndex);
+    if (newObjectInBuffer == NULL)
+    {
+      LOCAL_LOG_ERROR("vtkPlusBuffer: Failed to get pointer to video buffer object from the video buffer for the new frame!");
+      return PLUS_FAIL;
+    }
+
+    // Move the new image into the buffer item, the frame gets the image that was stored in the item
+    newObjectInBuffer->GetFrame().SwapImage(frame);
+
+    newObjectInBuffer->SetFilteredTimestamp(filteredTimestamp);
+    newObjectInBuffer->SetUnfilteredTimestamp(unfilteredTimestamp);
+    newObjectInBuffer->SetIndex(frameNumber);
+    newObjectInBuffer->SetUid(itemUid);
+
+    // The buffer item may still contain the frame transforms of the previous item in this slot
+    newObjectInBuffer->ClearFrameTransformItems();
+
+    // Add custom fields
+    if (customFields != NULL)
+    {
+      for (PlusTrackedFrame::FieldMapType::const_iterator it = customFields->begin(); it != customFields->end(); ++it)
+      {
+        newObjectInBuffer->SetCustomFrameField(it->first, it->second);
+        std::string name(it->first);
+        if (name.find("Transform") != std::string::npos)
+        {
+          newObjectInBuffer->SetValidTransformData(true);
+        }
+      }
+    }
+
+    this->NotifyNewItem();
+  }
+
+  // A reader may still hold a view of the image that was moved out of the buffer item,
+  // make sure that the caller does not overwrite it when filling the next frame
+  if (frame.DetachSharedImage() != PLUS_SUCCESS)
+  {
+    LOCAL_LOG_ERROR("vtkPlusBuffer: Failed to allocate a new image for the next video frame!");
+    return PLUS_FAIL;
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -360,6 +497,26 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
                                   double unfilteredTimestamp /*= UNDEFINED_TIMESTAMP*/,
                                   double filteredTimestamp /*= UNDEFINED_TIMESTAMP*/,
                                   const PlusTrackedFrame::FieldMapType* customFields /*= NULL */)
+{
+  return this->AddImageItem(imageDataPtr, usImageOrientation, inputFrameSizeInPx, pixelType, numberOfScalarComponents, imageType, numberOfBytesToSkip, frameNumber,
+                            clipRectangleOrigin, clipRectangleSize, unfilteredTimestamp, filteredTimestamp, customFields, NULL);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusBuffer::AddImageItem(void* imageDataPtr,
+                                       US_IMAGE_ORIENTATION usImageOrientation,
+                                       const unsigned int inputFrameSizeInPx[3],
+                                       PlusCommon::VTKScalarPixelType pixelType,
+                                       unsigned int numberOfScalarComponents,
+                                       US_IMAGE_TYPE imageType,
+                                       int numberOfBytesToSkip,
+                                       long frameNumber,
+                                       const int clipRectangleOrigin[3],
+                                       const int clipRectangleSize[3],
+                                       double unfilteredTimestamp,
+                                       double filteredTimestamp,
+                                       const PlusTrackedFrame::FieldMapType* customFields,
+                                       const PlusTrackedFrame::FrameTransformListType* frameTransforms)
 {
   if (unfilteredTimestamp == UNDEFINED_TIMESTAMP)
   {
@@ -427,7 +584,7 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
   int bufferIndex(0);
   BufferItemUidType itemUid;
   PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
-  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, itemUid, bufferIndex) != PLUS_SUCCESS)
+  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, unfilteredTimestamp, frameNumber, itemUid, bufferIndex) != PLUS_SUCCESS)
   {
     // Just a debug message, because we want to avoid unnecessary warning messages if the timestamp is the same as last one
     LOCAL_LOG_DEBUG("vtkPlusBuffer: Failed to prepare for adding new frame to video buffer!");
@@ -442,6 +599,14 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
     return PLUS_FAIL;
   }
 
+  // If a reader still holds a view of the image in this slot (see GetStreamBufferItemView) then
+  // the slot gets a new image, so that the pixels that are in use are not overwritten
+  if (newObjectInBuffer->GetFrame().DetachSharedImage() != PLUS_SUCCESS)
+  {
+    LOCAL_LOG_ERROR("vtkPlusBuffer: Failed to allocate a new image for a video buffer item that is in use!");
+    return PLUS_FAIL;
+  }
+
   unsigned int receivedFrameSize[3] = { 0, 0, 0 };
   newObjectInBuffer->GetFrame().GetFrameSize(receivedFrameSize);
 
@@ -486,6 +651,21 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
     }
   }
 
+  // Add frame transforms in binary form, the transforms of the previous item in this slot are replaced
+  if (frameTransforms != NULL)
+  {
+    newObjectInBuffer->SetFrameTransformItems(*frameTransforms);
+    if (!frameTransforms->empty())
+    {
+      newObjectInBuffer->SetValidTransformData(true);
+    }
+  }
+  else
+  {
+    newObjectInBuffer->ClearFrameTransformItems();
+  }
+
+  this->NotifyNewItem();
   return PLUS_SUCCESS;
 }
 
@@ -524,7 +704,7 @@ PlusStatus vtkPlusBuffer::AddTimeStampedItem(vtkMatrix4x4* matrix, ToolStatus st
   BufferItemUidType itemUid;
 
   PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
-  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, itemUid, bufferIndex) != PLUS_SUCCESS)
+  if (this->StreamBuffer->PrepareForNewItem(filteredTimestamp, unfilteredTimestamp, frameNumber, itemUid, bufferIndex) != PLUS_SUCCESS)
   {
     // Just a debug message, because we want to avoid unnecessary warning messages if the timestamp is the same as last one
     LOCAL_LOG_DEBUG("vtkPlusBuffer: Failed to prepare for adding new frame to tracker buffer!");
@@ -546,6 +726,9 @@ PlusStatus vtkPlusBuffer::AddTimeStampedItem(vtkMatrix4x4* matrix, ToolStatus st
   newObjectInBuffer->SetIndex(frameNumber);
   newObjectInBuffer->SetUid(itemUid);
 
+  // The buffer item may still contain the frame transforms of the previous item in this slot
+  newObjectInBuffer->ClearFrameTransformItems();
+
   // Add custom fields
   if (customFields != NULL)
   {
@@ -560,6 +743,7 @@ PlusStatus vtkPlusBuffer::AddTimeStampedItem(vtkMatrix4x4* matrix, ToolStatus st
     }
   }
 
+  this->NotifyNewItem();
   return itemStatus;
 }
 
@@ -606,6 +790,18 @@ int vtkPlusBuffer::GetAveragedItemsForFiltering()
   return this->StreamBuffer->GetAveragedItemsForFiltering();
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::SetLockFreeReading(bool enable)
+{
+  this->StreamBuffer->SetLockFreeReading(enable);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusBuffer::GetLockFreeReading()
+{
+  return this->StreamBuffer->GetLockFreeReading();
+}
+
 //----------------------------------------------------------------------------
 void vtkPlusBuffer::SetStartTime(double startTime)
 {
@@ -626,6 +822,35 @@ PlusStatus vtkPlusBuffer::GetTimeStampReportTable(vtkTable* timeStampReportTable
 
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusBuffer::GetStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem)
+{
+  return this->CopyStreamBufferItem(uid, bufferItem, false);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusBuffer::GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem)
+{
+  return this->CopyStreamBufferItem(uid, bufferItem, true);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusBuffer::GetStreamBufferItemViewFromTime(double time, StreamBufferItem* bufferItem)
+{
+  // The UID lookup and the copy must happen within the same lock, otherwise the item may be overwritten in between
+  PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
+
+  BufferItemUidType itemUid(0);
+  ItemStatus status = this->StreamBuffer->GetItemUidFromTime(time, itemUid);
+  if (status != ITEM_OK)
+  {
+    LOCAL_LOG_WARNING("vtkPlusBuffer: Cannot get any item from the buffer for time: " << std::fixed << time << ".");
+    return status;
+  }
+
+  return this->CopyStreamBufferItem(itemUid, bufferItem, true);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusBuffer::CopyStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem, bool shareFrame)
 {
   if (bufferItem == NULL)
   {
@@ -643,7 +868,9 @@ ItemStatus vtkPlusBuffer::GetStreamBufferItem(BufferItemUidType uid, StreamBuffe
     return itemStatus;
   }
 
-  if (bufferItem->DeepCopy(dataItem) != PLUS_SUCCESS)
+  // The frame is shared while the buffer is locked, so the writer sees the reference before it could reuse the slot
+  PlusStatus copyStatus = shareFrame ? bufferItem->ShallowCopy(dataItem) : bufferItem->DeepCopy(dataItem);
+  if (copyStatus != PLUS_SUCCESS)
   {
     LOCAL_LOG_WARNING("Failed to copy data item");
     return ITEM_UNKNOWN_ERROR;
@@ -1516,6 +1743,49 @@ bool vtkPlusBuffer::GetLatestItemHasValidFieldData()
   return this->StreamBuffer->GetLatestItemHasValidFieldData();
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::AddNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  if (notifier == NULL)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(this->NewDataNotifiersMutex);
+  for (std::vector< vtkSmartPointer<vtkPlusNewDataNotifier> >::iterator it = this->NewDataNotifiers.begin(); it != this->NewDataNotifiers.end(); ++it)
+  {
+    if (*it == notifier)
+    {
+      // already registered
+      return;
+    }
+  }
+  this->NewDataNotifiers.push_back(notifier);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  std::lock_guard<std::mutex> lock(this->NewDataNotifiersMutex);
+  for (std::vector< vtkSmartPointer<vtkPlusNewDataNotifier> >::iterator it = this->NewDataNotifiers.begin(); it != this->NewDataNotifiers.end(); ++it)
+  {
+    if (*it == notifier)
+    {
+      this->NewDataNotifiers.erase(it);
+      return;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::NotifyNewItem()
+{
+  std::lock_guard<std::mutex> lock(this->NewDataNotifiersMutex);
+  for (std::vector< vtkSmartPointer<vtkPlusNewDataNotifier> >::iterator it = this->NewDataNotifiers.begin(); it != this->NewDataNotifiers.end(); ++it)
+  {
+    (*it)->NotifyNewData();
+  }
+}
+
 #undef LOCAL_LOG_ERROR
 #undef LOCAL_LOG_WARNING
 #undef LOCAL_LOG_DEBUG
\ No newline at end of file
@@ -20,7 +20,12 @@ See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
 #include "PlusStreamBufferItem.h"
 #include "PlusTrackedFrame.h"
 #include "vtkObject.h"
+#include "vtkPlusNewDataNotifier.h"
 #include "vtkPlusTimestampedCircularBuffer.h"
+#include "vtkSmartPointer.h"
+
+#include <mutex>
+#include <vector>
 
 class vtkPlusDevice;
 enum ToolStatus;
@@ -123,6 +128,21 @@ public:
                              double filteredTimestamp = UNDEFINED_TIMESTAMP,
                              const PlusTrackedFrame::FieldMapType* customFields = NULL);
 
+  /*!
+    Add the image and the custom fields of a tracked frame to the buffer.
+    Frame transforms are stored in binary form, without converting them to strings.
+    If the timestamp is less than or equal to the previous timestamp,
+    or if the frame's format doesn't match the buffer's frame format,
+    then the frame is not added to the buffer. If a clip rectangle is defined
+    then only that portion of the image is extracted.
+  */
+  virtual PlusStatus AddItem(const PlusTrackedFrame& trackedFrame,
+                             long frameNumber,
+                             const int clipRectangleOrigin[3],
+                             const int clipRectangleSize[3],
+                             double unfilteredTimestamp = UNDEFINED_TIMESTAMP,
+                             double filteredTimestamp = UNDEFINED_TIMESTAMP);
+
   /*!
     Add custom fields to the new item
     If the timestamp is less than or equal to the previous timestamp,
@@ -134,6 +154,23 @@ public:
                              double unfilteredTimestamp = UNDEFINED_TIMESTAMP,
                              double filteredTimestamp = UNDEFINED_TIMESTAMP);
 
+  /*!
+    Add a frame plus a timestamp to the buffer by exchanging the frame's image with the image of the
+    next buffer item, without copying the pixel data.
+    On success the frame receives the image that was previously stored in the buffer item, so it can be filled
+    with the next frame (pixel values are undefined). If that image is still in use (see GetStreamBufferItemView)
+    then a new image is allocated for the frame instead.
+    If the frame orientation is different from the buffer orientation or a clip rectangle is defined
+    then the pixels are copied, the same way as in AddItem(const PlusVideoFrame*, ...).
+  */
+  virtual PlusStatus SwapItem(PlusVideoFrame& frame,
+                              long frameNumber,
+                              const int clipRectangleOrigin[3],
+                              const int clipRectangleSize[3],
+                              double unfilteredTimestamp = UNDEFINED_TIMESTAMP,
+                              double filteredTimestamp = UNDEFINED_TIMESTAMP,
+                              const PlusTrackedFrame::FieldMapType* customFields = NULL);
+
   /*!
     Add a matrix plus status to the list, with an exactly known timestamp value (e.g., provided by a high-precision hardware timer).
     If the timestamp is less than or equal to the previous timestamp, then nothing  will be done.
@@ -155,6 +192,17 @@ public:
   };
   /*! Get a frame that was acquired at the specified time from buffer */
   virtual ItemStatus GetStreamBufferItemFromTime(double time, StreamBufferItem* bufferItem, DataItemTemporalInterpolationType interpolation);
+
+  /*!
+    Get a frame with the specified frame uid from the buffer without copying the pixel data.
+    The video frame of the returned item shares its image with the buffer slot (see PlusVideoFrame::ShallowCopy).
+    The shared image is not overwritten while the returned item (or any copy of its frame made by ShallowCopy) refers to it:
+    if new data is added to the slot in the meantime then the buffer allocates a new image for the slot.
+    Pixels of the returned frame must not be modified.
+  */
+  virtual ItemStatus GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*! Get a frame that was acquired closest to the specified time without copying the pixel data. See GetStreamBufferItemView. */
+  virtual ItemStatus GetStreamBufferItemViewFromTime(double time, StreamBufferItem* bufferItem);
   virtual PlusStatus ModifyBufferItemFrameField(BufferItemUidType uid, const std::string& key, const std::string& value);
 
   /*! Get latest timestamp in the buffer */
@@ -248,6 +296,13 @@ public:
 
   virtual int GetAveragedItemsForFiltering();
 
+  /*!
+    If enabled then item UID, timestamp and index queries do not lock the buffer, so they never block the
+    acquisition thread (see vtkPlusTimestampedCircularBuffer). Item contents are still copied under lock.
+  */
+  virtual void SetLockFreeReading(bool enable);
+  virtual bool GetLockFreeReading();
+
   /*! Set recording start time */
   virtual void SetStartTime(double startTime);
   /*! Get recording start time */
@@ -308,6 +363,12 @@ public:
   vtkGetStringMacro(DescriptiveName);
   vtkSetStringMacro(DescriptiveName);
 
+  /*! Register a notifier that is signaled each time a new item is added to the buffer */
+  void AddNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+
+  /*! Unregister a notifier that was added by AddNewDataNotifier */
+  void RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+
 protected:
   vtkPlusBuffer();
   ~vtkPlusBuffer();
@@ -337,6 +398,31 @@ protected:
   /*! Get tracker buffer item from the closest timestamp */
   virtual ItemStatus GetStreamBufferItemFromClosestTime(double time, StreamBufferItem* bufferItem);
 
+  /*! Copy a buffer item into bufferItem. If shareFrame is true then the video frame is shared with the buffer slot instead of copied. */
+  ItemStatus CopyStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem, bool shareFrame);
+
+  /*!
+    Add an image to the buffer, see AddItem(void*, ...).
+    If frameTransforms is not NULL then the frame transforms are stored in binary form in the new item.
+  */
+  PlusStatus AddImageItem(void* imageDataPtr,
+                          US_IMAGE_ORIENTATION  usImageOrientation,
+                          const unsigned int inputFrameSizeInPx[3],
+                          PlusCommon::VTKScalarPixelType pixelType,
+                          unsigned int numberOfScalarComponents,
+                          US_IMAGE_TYPE imageType,
+                          int  numberOfBytesToSkip,
+                          long frameNumber,
+                          const int clipRectangleOrigin[3],
+                          const int clipRectangleSize[3],
+                          double unfilteredTimestamp,
+                          double filteredTimestamp,
+                          const PlusTrackedFrame::FieldMapType* customFields,
+                          const PlusTrackedFrame::FrameTransformListType* frameTransforms);
+
+  /*! Signal all registered notifiers that a new item has been added */
+  void NotifyNewItem();
+
 protected:
   /*! Image frame size in pixel */
   unsigned int FrameSize[3];
@@ -362,6 +448,10 @@ protected:
 
   char* DescriptiveName;
 
+  /*! Notifiers that are signaled when a new item is added */
+  std::vector< vtkSmartPointer<vtkPlusNewDataNotifier> > NewDataNotifiers;
+  std::mutex NewDataNotifiersMutex;
+
 private:
   vtkPlusBuffer(const vtkPlusBuffer&);
   void operator=(const vtkPlusBuffer&);
@@ -409,6 +409,40 @@ PlusStatus vtkPlusChannel::Clear()
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusChannel::AddNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  if (this->VideoSource != NULL)
+  {
+    this->VideoSource->AddNewDataNotifier(notifier);
+  }
+  for (DataSourceContainerIterator it = this->Tools.begin(); it != this->Tools.end(); ++it)
+  {
+    it->second->AddNewDataNotifier(notifier);
+  }
+  for (DataSourceContainerIterator it = this->FieldDataSources.begin(); it != this->FieldDataSources.end(); ++it)
+  {
+    it->second->AddNewDataNotifier(notifier);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusChannel::RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  if (this->VideoSource != NULL)
+  {
+    this->VideoSource->RemoveNewDataNotifier(notifier);
+  }
+  for (DataSourceContainerIterator it = this->Tools.begin(); it != this->Tools.end(); ++it)
+  {
+    it->second->RemoveNewDataNotifier(notifier);
+  }
+  for (DataSourceContainerIterator it = this->FieldDataSources.begin(); it != this->FieldDataSources.end(); ++it)
+  {
+    it->second->RemoveNewDataNotifier(notifier);
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusChannel::GetLatestTimestamp(double& aTimestamp) const
 {
@@ -539,24 +573,25 @@ PlusStatus vtkPlusChannel::GetTrackedFrame(double timestamp, PlusTrackedFrame& a
       return PLUS_FAIL;
     }
 
+    // Get a view of the buffer item, the pixels are not copied
     StreamBufferItem CurrentStreamBufferItem;
-    if (this->VideoSource->GetStreamBufferItem(frameUID, &CurrentStreamBufferItem) != ITEM_OK)
+    if (this->VideoSource->GetStreamBufferItemView(frameUID, &CurrentStreamBufferItem) != ITEM_OK)
     {
       LOG_ERROR("Couldn't get video buffer item by frame UID: " << frameUID);
       return PLUS_FAIL;
     }
 
-    // Copy frame
-    PlusVideoFrame frame = CurrentStreamBufferItem.GetFrame();
-    aTrackedFrame.SetImageData(frame);
+    // Share frame, the buffer keeps the image intact while the tracked frame refers to it
+    aTrackedFrame.ShallowCopyImageData(CurrentStreamBufferItem.GetFrame());
 
-    // Copy all custom fields
-    StreamBufferItem::FieldMapType fieldMap = CurrentStreamBufferItem.GetCustomFrameFieldMap();
-    StreamBufferItem::FieldMapType::iterator fieldIterator;
+    // Copy all custom fields, frame transforms are copied in binary form
+    const StreamBufferItem::FieldMapType& fieldMap = CurrentStreamBufferItem.GetStringCustomFrameFieldMap();
+    StreamBufferItem::FieldMapType::const_iterator fieldIterator;
     for (fieldIterator = fieldMap.begin(); fieldIterator != fieldMap.end(); fieldIterator++)
     {
       aTrackedFrame.SetCustomFrameField((*fieldIterator).first, (*fieldIterator).second);
     }
+    aTrackedFrame.SetFrameTransformItems(CurrentStreamBufferItem.GetFrameTransformItems());
 
     synchronizedTimestamp = CurrentStreamBufferItem.GetTimestamp(this->VideoSource->GetLocalTimeOffsetSec());
   }
@@ -625,13 +660,14 @@ PlusStatus vtkPlusChannel::GetTrackedFrame(double timestamp, PlusTrackedFrame& a
       continue;
     }
 
-    // Copy all custom fields
-    StreamBufferItem::FieldMapType fieldMap = bufferItem.GetCustomFrameFieldMap();
-    StreamBufferItem::FieldMapType::iterator fieldIterator;
+    // Copy all custom fields, frame transforms are copied in binary form
+    const StreamBufferItem::FieldMapType& fieldMap = bufferItem.GetStringCustomFrameFieldMap();
+    StreamBufferItem::FieldMapType::const_iterator fieldIterator;
     for (fieldIterator = fieldMap.begin(); fieldIterator != fieldMap.end(); fieldIterator++)
     {
       aTrackedFrame.SetCustomFrameField((*fieldIterator).first, (*fieldIterator).second);
     }
+    aTrackedFrame.SetFrameTransformItems(bufferItem.GetFrameTransformItems());
 
     synchronizedTimestamp = bufferItem.GetTimestamp(aTool->GetLocalTimeOffsetSec());
   }
@@ -663,13 +699,14 @@ PlusStatus vtkPlusChannel::GetTrackedFrame(double timestamp, PlusTrackedFrame& a
       continue;
     }
 
-    // Copy all custom fields
-    StreamBufferItem::FieldMapType fieldMap = bufferItem.GetCustomFrameFieldMap();
-    StreamBufferItem::FieldMapType::iterator fieldIterator;
+    // Copy all custom fields, frame transforms are copied in binary form
+    const StreamBufferItem::FieldMapType& fieldMap = bufferItem.GetStringCustomFrameFieldMap();
+    StreamBufferItem::FieldMapType::const_iterator fieldIterator;
     for (fieldIterator = fieldMap.begin(); fieldIterator != fieldMap.end(); fieldIterator++)
     {
       aTrackedFrame.SetCustomFrameField((*fieldIterator).first, (*fieldIterator).second);
     }
+    aTrackedFrame.SetFrameTransformItems(bufferItem.GetFrameTransformItems());
 
     synchronizedTimestamp = bufferItem.GetTimestamp(aSource->GetLocalTimeOffsetSec());
   }
@@ -18,6 +18,7 @@ class PlusTrackedFrame;
 class vtkPlusHTMLGenerator;
 class vtkPlusDataSource;
 class vtkPlusDevice;
+class vtkPlusNewDataNotifier;
 class vtkPlusTrackedFrameList;
 
 typedef std::map<std::string, vtkPlusDataSource*> DataSourceContainer;
@@ -143,6 +144,11 @@ public:
 
   virtual PlusStatus Clear();
 
+  /*! Register a notifier that is signaled each time a new item is added to any data source of the channel */
+  virtual void AddNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+  /*! Unregister a notifier from all data sources of the channel */
+  virtual void RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+
   virtual void ShallowCopy(vtkDataObject*);
   virtual void ShallowCopy(const vtkPlusChannel& aChannel);
 
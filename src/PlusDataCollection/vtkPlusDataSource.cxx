@@ -378,6 +378,10 @@ PlusStatus vtkPlusDataSource::ReadConfiguration(vtkXMLDataElement* sourceElement
     LOG_DEBUG("AveragedItemsForFiltering is not defined in source element \"" << this->GetId() << "\". Using default value: " << this->GetBuffer()->GetAveragedItemsForFiltering());
   }
 
+  bool lockFreeBufferReading = false;
+  XML_READ_BOOL_ATTRIBUTE_NONMEMBER_OPTIONAL(LockFreeBufferReading, lockFreeBufferReading, sourceElement);
+  this->GetBuffer()->SetLockFreeReading(lockFreeBufferReading);
+
   std::string descName;
   if (!aDescriptiveNameForBuffer.empty())
   {
@@ -439,6 +443,11 @@ PlusStatus vtkPlusDataSource::WriteConfiguration(vtkXMLDataElement* aSourceEleme
     aSourceElement->SetIntAttribute("AveragedItemsForFiltering", this->GetBuffer()->GetAveragedItemsForFiltering());
   }
 
+  if (this->GetBuffer()->GetLockFreeReading())
+  {
+    aSourceElement->SetAttribute("LockFreeBufferReading", "TRUE");
+  }
+
   // Write custom properties
   if (this->CustomProperties.size() > 0)
   {
@@ -544,6 +553,13 @@ PlusStatus vtkPlusDataSource::AddItem(void* imageDataPtr, US_IMAGE_ORIENTATION u
                        numberOfBytesToSkip, frameNumber, unfilteredTimestamp, filteredTimestamp, customFields);
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusDataSource::AddItem(const PlusTrackedFrame& trackedFrame, long frameNumber, double unfilteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
+                                      double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/)
+{
+  return this->GetBuffer()->AddItem(trackedFrame, frameNumber, this->ClipRectangleOrigin, this->ClipRectangleSize, unfilteredTimestamp, filteredTimestamp);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusDataSource::AddItem(const PlusTrackedFrame::FieldMapType& customFields, long frameNumber, double unfilteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
                                       double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/)
@@ -551,6 +567,13 @@ PlusStatus vtkPlusDataSource::AddItem(const PlusTrackedFrame::FieldMapType& cust
   return this->GetBuffer()->AddItem(customFields, frameNumber, unfilteredTimestamp, filteredTimestamp);
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusDataSource::SwapItem(PlusVideoFrame& frame, long frameNumber, double unfilteredTimestamp/*=UNDEFINED_TIMESTAMP*/,
+                                       double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/, const PlusTrackedFrame::FieldMapType* customFields /*= NULL*/)
+{
+  return this->GetBuffer()->SwapItem(frame, frameNumber, this->ClipRectangleOrigin, this->ClipRectangleSize, unfilteredTimestamp, filteredTimestamp, customFields);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusDataSource::AddItem(void* imageDataPtr, US_IMAGE_ORIENTATION usImageOrientation, const unsigned int frameSizeInPx[3], PlusCommon::VTKScalarPixelType pixelType,
                                       unsigned int numberOfScalarComponents, US_IMAGE_TYPE imageType, int numberOfBytesToSkip, long frameNumber, double unfilteredTimestamp /*= UNDEFINED_TIMESTAMP*/,
@@ -812,6 +835,18 @@ bool vtkPlusDataSource::GetLatestItemHasValidFieldData()
   return this->GetBuffer()->GetLatestItemHasValidFieldData();
 }
 
+//-----------------------------------------------------------------------------
+void vtkPlusDataSource::AddNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  this->GetBuffer()->AddNewDataNotifier(notifier);
+}
+
+//-----------------------------------------------------------------------------
+void vtkPlusDataSource::RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier)
+{
+  this->GetBuffer()->RemoveNewDataNotifier(notifier);
+}
+
 //-----------------------------------------------------------------------------
 ItemStatus vtkPlusDataSource::GetStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem)
 {
@@ -836,6 +871,18 @@ ItemStatus vtkPlusDataSource::GetStreamBufferItemFromTime(double time, StreamBuf
   return this->GetBuffer()->GetStreamBufferItemFromTime(time, bufferItem, interpolation);
 }
 
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusDataSource::GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem)
+{
+  return this->GetBuffer()->GetStreamBufferItemView(uid, bufferItem);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusDataSource::GetStreamBufferItemViewFromTime(double time, StreamBufferItem* bufferItem)
+{
+  return this->GetBuffer()->GetStreamBufferItemViewFromTime(time, bufferItem);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusDataSource::ModifyBufferItemFrameField(BufferItemUidType uid, const std::string& key, const std::string& value)
 {
@@ -132,6 +132,11 @@ public:
   /*! Returns true if the latest item contains valid field data */
   virtual bool GetLatestItemHasValidFieldData();
 
+  /*! Register a notifier that is signaled each time a new item is added to the buffer of the data source */
+  virtual void AddNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+  /*! Unregister a notifier that was added by AddNewDataNotifier */
+  virtual void RemoveNewDataNotifier(vtkPlusNewDataNotifier* notifier);
+
   /*! Get a frame with the specified frame uid from the buffer */
   virtual ItemStatus GetStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem);
   /*! Get the most recent frame from the buffer */
@@ -140,6 +145,10 @@ public:
   virtual ItemStatus GetOldestStreamBufferItem(StreamBufferItem* bufferItem);
   /*! Get a frame that was acquired at the specified time from buffer */
   virtual ItemStatus GetStreamBufferItemFromTime(double time, StreamBufferItem* bufferItem, vtkPlusBuffer::DataItemTemporalInterpolationType interpolation);
+  /*! Get a frame with the specified frame uid from the buffer without copying the pixel data (see vtkPlusBuffer::GetStreamBufferItemView) */
+  virtual ItemStatus GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*! Get the frame closest to the specified time from the buffer without copying the pixel data (see vtkPlusBuffer::GetStreamBufferItemView) */
+  virtual ItemStatus GetStreamBufferItemViewFromTime(double time, StreamBufferItem* bufferItem);
   /*! Update a field in the specified stream buffer item */
   virtual PlusStatus ModifyBufferItemFrameField(BufferItemUidType uid, const std::string& key, const std::string& value);
 
@@ -215,6 +224,15 @@ public:
                              unsigned int numberOfScalarComponents, US_IMAGE_TYPE imageType, int  numberOfBytesToSkip, long frameNumber, double unfilteredTimestamp = UNDEFINED_TIMESTAMP,
                              double filteredTimestamp = UNDEFINED_TIMESTAMP, const PlusTrackedFrame::FieldMapType* customFields = NULL);
 
+  /*!
+    Add the image and the custom fields of a tracked frame to the buffer.
+    Frame transforms are stored in binary form, without converting them to strings.
+    If the timestamp is  less than or equal to the previous timestamp,
+    or if the frame's format doesn't match the buffer's frame format,
+    then the frame is not added to the buffer.
+  */
+  virtual PlusStatus AddItem(const PlusTrackedFrame& trackedFrame, long frameNumber, double unfilteredTimestamp = UNDEFINED_TIMESTAMP, double filteredTimestamp = UNDEFINED_TIMESTAMP);
+
   /*!
     Add custom fields to the new item
     If the timestamp is  less than or equal to the previous timestamp,
@@ -223,6 +241,14 @@ public:
   */
   virtual PlusStatus AddItem(const PlusTrackedFrame::FieldMapType& customFields, long frameNumber, double unfilteredTimestamp = UNDEFINED_TIMESTAMP, double filteredTimestamp = UNDEFINED_TIMESTAMP);
 
+  /*!
+    Add a frame plus a timestamp to the buffer by exchanging the frame's image with the image of the next buffer item,
+    without copying the pixel data. On success the frame holds an image that can be filled with the next frame.
+    See vtkPlusBuffer::SwapItem.
+  */
+  virtual PlusStatus SwapItem(PlusVideoFrame& frame, long frameNumber, double unfilteredTimestamp = UNDEFINED_TIMESTAMP,
+                              double filteredTimestamp = UNDEFINED_TIMESTAMP, const PlusTrackedFrame::FieldMapType* customFields = NULL);
+
   /*!
   Add a matrix plus status to the list, with an exactly known timestamp value (e.g., provided by a high-precision hardware timer).
   If the timestamp is less than or equal to the previous timestamp, then nothing  will be done.
@@ -10,6 +10,7 @@ See License.txt for details.
 #include "vtkPlusChannel.h"
 #include "vtkPlusDataSource.h"
 #include "vtkPlusDevice.h"
+#include "vtkPlusNewDataNotifier.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtkPlusSequenceIO.h"
 #include "vtkPlusTrackedFrameList.h"
@@ -134,6 +135,8 @@ vtkPlusDevice::vtkPlusDevice()
   , OutputNeedsInitialization(1)
   , CorrectlyConfigured(true)
   , StartThreadForInternalUpdates(false)
+  , UpdateOnNewInputData(false)
+  , InputDataNotifier(vtkPlusNewDataNotifier::New())
   , LocalTimeOffsetSec(0.0)
   , MissingInputGracePeriodSec(0.0)
   , RequireImageOrientationInConfiguration(false)
@@ -183,6 +186,8 @@ vtkPlusDevice::~vtkPlusDevice()
 
   DELETE_IF_NOT_NULL(this->UpdateMutex);
 
+  DELETE_IF_NOT_NULL(this->InputDataNotifier);
+
   LOCAL_LOG_TRACE("vtkPlusDevice::~vtkPlusDevice() completed");
 }
 
@@ -1098,6 +1103,8 @@ PlusStatus vtkPlusDevice::ReadConfiguration(vtkXMLDataElement* rootXMLElement)
     }
   }
 
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(UpdateOnNewInputData, deviceXMLElement);
+
   double localTimeOffsetSec = 0;
   if (deviceXMLElement->GetScalarAttribute("LocalTimeOffsetSec", localTimeOffsetSec))
   {
@@ -1182,6 +1189,16 @@ PlusStatus vtkPlusDevice::WriteConfiguration(vtkXMLDataElement* config)
     deviceDataElement->SetDoubleAttribute("LocalTimeOffsetSec", this->GetLocalTimeOffsetSec());
   }
 
+  // Disabled by default, so the attribute is only written if it is enabled
+  if (this->UpdateOnNewInputData)
+  {
+    deviceDataElement->SetAttribute("UpdateOnNewInputData", "TRUE");
+  }
+  else
+  {
+    XML_REMOVE_ATTRIBUTE(deviceDataElement, "UpdateOnNewInputData");
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -1265,6 +1282,14 @@ PlusStatus vtkPlusDevice::StartRecording()
 
   if (this->StartThreadForInternalUpdates)
   {
+    if (this->UpdateOnNewInputData)
+    {
+      // Get notified when any of the input devices adds new data
+      for (ChannelContainerIterator it = this->InputChannels.begin(); it != this->InputChannels.end(); ++it)
+      {
+        (*it)->AddNewDataNotifier(this->InputDataNotifier);
+      }
+    }
     this->ThreadId =
       this->Threader->SpawnThread((vtkThreadFunctionType)\
                                   &vtkDataCaptureThread, this);
@@ -1301,6 +1326,11 @@ PlusStatus vtkPlusDevice::StopRecording()
     }
     this->ThreadId = -1;
     LOCAL_LOG_DEBUG("Internal update thread terminated");
+
+    for (ChannelContainerIterator it = this->InputChannels.begin(); it != this->InputChannels.end(); ++it)
+    {
+      (*it)->RemoveNewDataNotifier(this->InputDataNotifier);
+    }
   }
 
   if (this->InternalStopRecording() != PLUS_SUCCESS)
@@ -1325,6 +1355,10 @@ void* vtkPlusDevice::vtkDataCaptureThread(vtkMultiThreader::ThreadInfo* data)
   unsigned long updatecount = 0;
   self->ThreadAlive = true;
 
+  // If requested, devices with inputs are updated as soon as new input data arrives (but at least at the acquisition rate)
+  bool waitForInputData = self->UpdateOnNewInputData && !self->InputChannels.empty();
+  unsigned long lastInputDataNotificationCount = self->InputDataNotifier->GetNotificationCount();
+
   while (self->IsRecording() && self->GetCorrectlyConfigured())
   {
     double newtime = vtkPlusAccurateTimer::GetSystemTime();
@@ -1351,7 +1385,15 @@ void* vtkPlusDevice::vtkDataCaptureThread(vtkMultiThreader::ThreadInfo* data)
     double delay = (newtime + 1.0 / rate - vtkPlusAccurateTimer::GetSystemTime());
     if (delay > 0)
     {
-      vtkPlusAccurateTimer::Delay(delay);
+      if (waitForInputData)
+      {
+        // Returns immediately if data was added during the update
+        self->InputDataNotifier->WaitForNewData(lastInputDataNotificationCount, delay);
+      }
+      else
+      {
+        vtkPlusAccurateTimer::Delay(delay);
+      }
     }
 
     updatecount++;
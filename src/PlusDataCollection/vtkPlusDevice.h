@@ -24,6 +24,7 @@ class vtkPlusDataCollector;
 class vtkPlusDataSource;
 class vtkPlusDevice;
 class vtkPlusHTMLGenerator;
+class vtkPlusNewDataNotifier;
 class vtkXMLDataElement;
 
 typedef std::vector<vtkPlusChannel*> ChannelContainer;
@@ -291,6 +292,16 @@ public:
   virtual double GetAcquisitionRate() const;
   PlusStatus SetAcquisitionRate(double aRate);
 
+  /*!
+    If enabled then the internal update thread of a device that has input channels is woken up
+    as soon as new data is added to any of its inputs, instead of only at the next acquisition period.
+    The acquisition rate then defines the minimum update rate, not the maximum.
+    Disabled by default, can be enabled by the UpdateOnNewInputData="TRUE" device attribute.
+  */
+  vtkSetMacro(UpdateOnNewInputData, bool);
+  vtkGetMacro(UpdateOnNewInputData, bool);
+  vtkBooleanMacro(UpdateOnNewInputData, bool);
+
   /*! Get whether recording is underway */
   virtual bool IsRecording() const;
 
@@ -596,6 +607,12 @@ protected:
   */
   bool StartThreadForInternalUpdates;
 
+  /*! Wake up the internal update thread when new input data is available, see SetUpdateOnNewInputData */
+  bool UpdateOnNewInputData;
+
+  /*! Signaled by the buffers of the input channels when new data is added, used if UpdateOnNewInputData is enabled */
+  vtkPlusNewDataNotifier* InputDataNotifier;
+
   /*! Value to use when mixing data with another temporally calibrated device*/
   double LocalTimeOffsetSec;
 
@@ -17,6 +17,13 @@ vtkStandardNewMacro(vtkPlusTimestampedCircularBuffer);
 //----------------------------------------------------------------------------
 vtkPlusTimestampedCircularBuffer::vtkPlusTimestampedCircularBuffer()
   : Mutex(vtkPlusRecursiveCriticalSection::New())
+  , LockFreeReading(false)
+  , ItemTimingPublished(false)
+  , ItemTimingSlots(NULL)
+  , PublishedStateSequence(0)
+  , PublishedLatestItemUid(0)
+  , PublishedNumberOfItems(0)
+  , NumberOfItems(0)
   , WritePointer(0)
   , CurrentTimeStamp(0.0)
   , LocalTimeOffsetSec(0.0)
@@ -40,6 +47,13 @@ vtkPlusTimestampedCircularBuffer::vtkPlusTimestampedCircularBuffer()
 vtkPlusTimestampedCircularBuffer::~vtkPlusTimestampedCircularBuffer()
 {
   this->BufferItemContainer.clear();
+  delete this->ItemTimingSlots.load();
+  this->ItemTimingSlots = NULL;
+  for (std::vector<ItemTimingSlotArray*>::iterator it = this->RetiredItemTimingSlots.begin(); it != this->RetiredItemTimingSlots.end(); ++it)
+  {
+    delete *it;
+  }
+  this->RetiredItemTimingSlots.clear();
 
   this->NumberOfItems = 0;
   if (this->Mutex != NULL)
@@ -66,10 +80,177 @@ void vtkPlusTimestampedCircularBuffer::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "CurrentTimeStamp: " << this->CurrentTimeStamp << "\n";
   os << indent << "Local time offset: " << this->LocalTimeOffsetSec << "\n";
   os << indent << "Latest Item Uid: " << this->LatestItemUid << "\n";
+  os << indent << "Lock-free reading: " << (this->LockFreeReading.load() ? "enabled" : "disabled") << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::SetLockFreeReading(bool enable)
+{
+  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+  if (enable == this->LockFreeReading.load())
+  {
+    return;
+  }
+  if (enable && !this->IsItemTimingPublished())
+  {
+    // Readers may start using the slots as soon as the flag is set, so fill them first.
+    // If lock-free reading has been enabled before then the slots are already up to date.
+    this->RebuildItemTimingSlots();
+    this->ItemTimingPublished = true;
+  }
+  // When disabled, the slots are not released and are still updated: a reader may have read the flag
+  // just before it was cleared and may still be using the slots
+  this->LockFreeReading = enable;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::PublishState()
+{
+  // the caller must have locked the buffer, so there is only one writer at a time
+  unsigned int sequence = this->PublishedStateSequence.load(std::memory_order_relaxed);
+  this->PublishedStateSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  this->PublishedLatestItemUid.store(this->LatestItemUid, std::memory_order_relaxed);
+  this->PublishedNumberOfItems.store(this->NumberOfItems, std::memory_order_relaxed);
+  this->PublishedStateSequence.store(sequence + 2, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::ReadPublishedState(BufferItemUidType& latestUid, int& numberOfItems)
+{
+  for (;;)
+  {
+    unsigned int sequenceBefore = this->PublishedStateSequence.load(std::memory_order_acquire);
+    if (sequenceBefore & 1)
+    {
+      // writer is in the middle of updating the state (a few stores only), try again
+      continue;
+    }
+    latestUid = this->PublishedLatestItemUid.load(std::memory_order_relaxed);
+    numberOfItems = this->PublishedNumberOfItems.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->PublishedStateSequence.load(std::memory_order_relaxed) == sequenceBefore)
+    {
+      return;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::PublishItemTiming(ItemTimingSlotArray* slots, const ItemTiming& timing)
+{
+  // the caller must have locked the buffer
+  if (slots == NULL)
+  {
+    return;
+  }
+  ItemTimingSlot& slot = slots->Slots[timing.Uid % slots->NumberOfSlots];
+  unsigned int sequence = slot.Sequence.load(std::memory_order_relaxed);
+  slot.Sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.Uid.store(timing.Uid, std::memory_order_relaxed);
+  slot.BufferIndex.store(timing.BufferIndex, std::memory_order_relaxed);
+  slot.FilteredTimeStamp.store(timing.FilteredTimeStamp, std::memory_order_relaxed);
+  slot.UnfilteredTimeStamp.store(timing.UnfilteredTimeStamp, std::memory_order_relaxed);
+  slot.Index.store(timing.Index, std::memory_order_relaxed);
+  slot.Sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::ReadItemTiming(const BufferItemUidType uid, ItemTiming& timing)
+{
+  BufferItemUidType latestUid(0);
+  int numberOfItems(0);
+  this->ReadPublishedState(latestUid, numberOfItems);
+  if (numberOfItems < 1 || uid > latestUid)
+  {
+    return ITEM_NOT_AVAILABLE_YET;
+  }
+  // The slot array is published before the state, so it is at least as new as the state that has been read
+  const ItemTimingSlotArray* slots = this->ItemTimingSlots.load(std::memory_order_acquire);
+  if (uid < latestUid - (numberOfItems - 1) || slots == NULL)
+  {
+    return ITEM_NOT_AVAILABLE_ANYMORE;
+  }
+
+  const ItemTimingSlot& slot = slots->Slots[uid % slots->NumberOfSlots];
+  for (;;)
+  {
+    unsigned int sequenceBefore = slot.Sequence.load(std::memory_order_acquire);
+    if (sequenceBefore & 1)
+    {
+      continue;
+    }
+    timing.Uid = slot.Uid.load(std::memory_order_relaxed);
+    timing.BufferIndex = slot.BufferIndex.load(std::memory_order_relaxed);
+    timing.FilteredTimeStamp = slot.FilteredTimeStamp.load(std::memory_order_relaxed);
+    timing.UnfilteredTimeStamp = slot.UnfilteredTimeStamp.load(std::memory_order_relaxed);
+    timing.Index = slot.Index.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.Sequence.load(std::memory_order_relaxed) == sequenceBefore)
+    {
+      break;
+    }
+  }
+
+  if (timing.Uid != uid)
+  {
+    // the slot has been reused by a newer item since the state was read
+    return (timing.Uid > uid) ? ITEM_NOT_AVAILABLE_ANYMORE : ITEM_NOT_AVAILABLE_YET;
+  }
+  return ITEM_OK;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::RebuildItemTimingSlots()
+{
+  // the caller must have locked the buffer
+  const int bufferSize = this->GetBufferSize();
+  ItemTimingSlotArray* currentSlots = this->ItemTimingSlots.load(std::memory_order_relaxed);
+  ItemTimingSlotArray* slots = currentSlots;
+  if ((currentSlots != NULL ? currentSlots->NumberOfSlots : 0) != bufferSize)
+  {
+    // Lock-free readers may still be reading the current slots, so they are not deleted here.
+    // The new slots are filled before they are published, so readers never see empty slots.
+    slots = (bufferSize > 0) ? new ItemTimingSlotArray(bufferSize) : NULL;
+  }
+  for (int i = 0; i < this->NumberOfItems; ++i)
+  {
+    BufferItemUidType uid = this->LatestItemUid - i;
+    int bufferIndex = (this->WritePointer - 1) - i;
+    if (bufferIndex < 0)
+    {
+      bufferIndex += this->BufferItemContainer.size();
+    }
+    StreamBufferItem* item = &this->BufferItemContainer[bufferIndex];
+    ItemTiming timing;
+    timing.Uid = uid;
+    timing.BufferIndex = bufferIndex;
+    timing.FilteredTimeStamp = item->GetFilteredTimestamp(0);
+    timing.UnfilteredTimeStamp = item->GetUnfilteredTimestamp(0);
+    timing.Index = item->GetIndex();
+    this->PublishItemTiming(slots, timing);
+  }
+  if (slots != currentSlots)
+  {
+    this->ItemTimingSlots.store(slots, std::memory_order_release);
+    if (currentSlots != NULL)
+    {
+      this->RetiredItemTimingSlots.push_back(currentSlots);
+    }
+  }
+  this->PublishState();
 }
 
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTimestampedCircularBuffer::PrepareForNewItem(const double timestamp, BufferItemUidType& newFrameUid, int& bufferIndex)
+{
+  return this->PrepareForNewItem(timestamp, timestamp, 0, newFrameUid, bufferIndex);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusTimestampedCircularBuffer::PrepareForNewItem(const double timestamp, const double unfilteredTimestamp, unsigned long itemIndex, BufferItemUidType& newFrameUid, int& bufferIndex)
 {
   PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
 
@@ -95,6 +276,19 @@ PlusStatus vtkPlusTimestampedCircularBuffer::PrepareForNewItem(const double time
     this->WritePointer = 0;
   }
 
+  if (this->IsItemTimingPublished())
+  {
+    // The timing slot is written before the new latest UID is published, so readers never see an incomplete item
+    ItemTiming timing;
+    timing.Uid = newFrameUid;
+    timing.BufferIndex = bufferIndex;
+    timing.FilteredTimeStamp = timestamp;
+    timing.UnfilteredTimeStamp = unfilteredTimestamp;
+    timing.Index = itemIndex;
+    this->PublishItemTiming(this->ItemTimingSlots.load(std::memory_order_relaxed), timing);
+    this->PublishState();
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -160,6 +354,11 @@ PlusStatus vtkPlusTimestampedCircularBuffer::SetBufferSize(int newBufferSize)
     this->NumberOfItems = this->GetBufferSize();
   }
 
+  if (this->IsItemTimingPublished())
+  {
+    this->RebuildItemTimingSlots();
+  }
+
   this->Modified();
 
   return PLUS_SUCCESS;
@@ -208,6 +407,14 @@ StreamBufferItem* vtkPlusTimestampedCircularBuffer::GetBufferItemPointerFromBuff
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetFilteredTimeStamp(const BufferItemUidType uid, double& filteredTimestamp)
 {
+  if (this->LockFreeReading)
+  {
+    ItemTiming timing;
+    ItemStatus status = this->ReadItemTiming(uid, timing);
+    filteredTimestamp = (status == ITEM_OK) ? timing.FilteredTimeStamp + this->LocalTimeOffsetSec : 0;
+    return status;
+  }
+
   PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
   StreamBufferItem* itemPtr = NULL;
   ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
@@ -223,6 +430,14 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetFilteredTimeStamp(const BufferIt
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetUnfilteredTimeStamp(const BufferItemUidType uid, double& unfilteredTimestamp)
 {
+  if (this->LockFreeReading)
+  {
+    ItemTiming timing;
+    ItemStatus status = this->ReadItemTiming(uid, timing);
+    unfilteredTimestamp = (status == ITEM_OK) ? timing.UnfilteredTimeStamp + this->LocalTimeOffsetSec : 0;
+    return status;
+  }
+
   PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
   StreamBufferItem* itemPtr = NULL;
   ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
@@ -274,6 +489,14 @@ bool vtkPlusTimestampedCircularBuffer::GetLatestItemHasValidFieldData()
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetIndex(const BufferItemUidType uid, unsigned long& index)
 {
+  if (this->LockFreeReading)
+  {
+    ItemTiming timing;
+    ItemStatus status = this->ReadItemTiming(uid, timing);
+    index = (status == ITEM_OK) ? timing.Index : 0;
+    return status;
+  }
+
   PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
   StreamBufferItem* itemPtr = NULL;
   ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
@@ -289,8 +512,26 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetIndex(const BufferItemUidType ui
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetBufferIndexFromTime(const double time, int& bufferIndex)
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
   bufferIndex = -1;
+  if (this->LockFreeReading)
+  {
+    BufferItemUidType itemUid = 0;
+    ItemStatus itemStatus = this->GetItemUidFromTimeLockFree(time, itemUid);
+    ItemTiming timing;
+    if (itemStatus == ITEM_OK)
+    {
+      itemStatus = this->ReadItemTiming(itemUid, timing);
+    }
+    if (itemStatus != ITEM_OK)
+    {
+      LOG_WARNING("Buffer item is not in the buffer (time: " << std::fixed << time << ")!");
+      return itemStatus;
+    }
+    bufferIndex = timing.BufferIndex;
+    return ITEM_OK;
+  }
+
+  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
 
   BufferItemUidType itemUid = 0;
   ItemStatus itemStatus = this->GetItemUidFromTime(time, itemUid);
@@ -313,6 +554,11 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetBufferIndexFromTime(const double
 // that best matches the given timestamp
 ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTime(const double time, BufferItemUidType& uid)
 {
+  if (this->LockFreeReading)
+  {
+    return this->GetItemUidFromTimeLockFree(time, uid);
+  }
+
   PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
 
   if (this->NumberOfItems == 1)
@@ -393,6 +639,110 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTime(const double tim
 
 }
 
+//----------------------------------------------------------------------------
+// Same search as GetItemUidFromTime, but using the timing slots. If an item is overwritten
+// during the search (the writer wrapped around) then the search is restarted.
+ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTimeLockFree(const double time, BufferItemUidType& uid)
+{
+  const int maxNumberOfAttempts = 3;
+  ItemStatus status = ITEM_NOT_AVAILABLE_ANYMORE;
+  for (int attempt = 0; attempt < maxNumberOfAttempts; ++attempt)
+  {
+    BufferItemUidType latestUid(0);
+    int numberOfItems(0);
+    this->ReadPublishedState(latestUid, numberOfItems);
+    if (numberOfItems < 1)
+    {
+      return ITEM_NOT_AVAILABLE_YET;
+    }
+    if (numberOfItems == 1)
+    {
+      // There is only one item, it's the closest one to any timestamp
+      uid = latestUid;
+      return ITEM_OK;
+    }
+
+    BufferItemUidType lo = latestUid - (numberOfItems - 1);   // oldest item UID
+    BufferItemUidType hi = latestUid; // latest item UID
+    ItemTiming timing;
+    if ((status = this->ReadItemTiming(lo, timing)) != ITEM_OK)
+    {
+      continue;
+    }
+    double tlo = timing.FilteredTimeStamp + this->LocalTimeOffsetSec;
+    if ((status = this->ReadItemTiming(hi, timing)) != ITEM_OK)
+    {
+      continue;
+    }
+    double thi = timing.FilteredTimeStamp + this->LocalTimeOffsetSec;
+
+    // If the timestamp is slightly out of range then still accept it
+    // (due to errors in conversions there could be slight differences)
+    if (time < tlo - this->NegligibleTimeDifferenceSec)
+    {
+      return ITEM_NOT_AVAILABLE_ANYMORE;
+    }
+    else if (time > thi + this->NegligibleTimeDifferenceSec)
+    {
+      return ITEM_NOT_AVAILABLE_YET;
+    }
+
+    while (hi - lo > 1)
+    {
+      BufferItemUidType mid = (lo + hi) / 2;
+      if ((status = this->ReadItemTiming(mid, timing)) != ITEM_OK)
+      {
+        break;
+      }
+      double tmid = timing.FilteredTimeStamp + this->LocalTimeOffsetSec;
+      if (time < tmid)
+      {
+        hi = mid;
+        thi = tmid;
+      }
+      else
+      {
+        lo = mid;
+        tlo = tmid;
+      }
+    }
+    if (status != ITEM_OK)
+    {
+      continue;
+    }
+
+    uid = (time - tlo > thi - time) ? hi : lo;
+    return ITEM_OK;
+  }
+
+  // The writer kept overwriting the items that we were looking at
+  return status;
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::GetOldestTimeStampLockFree(double& timestamp)
+{
+  timestamp = 0;
+  ItemStatus status = ITEM_NOT_AVAILABLE_YET;
+  // The oldest item may be overwritten while it is being read, in this case try again with the new oldest item
+  for (int attempt = 0; attempt < 3; ++attempt)
+  {
+    BufferItemUidType latestUid(0);
+    int numberOfItems(0);
+    this->ReadPublishedState(latestUid, numberOfItems);
+    if (numberOfItems < 1)
+    {
+      return ITEM_NOT_AVAILABLE_YET;
+    }
+    status = this->GetFilteredTimeStamp(latestUid - (numberOfItems - 1), timestamp);
+    if (status != ITEM_NOT_AVAILABLE_ANYMORE)
+    {
+      break;
+    }
+  }
+  return status;
+}
+
 //----------------------------------------------------------------------------
 void vtkPlusTimestampedCircularBuffer::DeepCopy(vtkPlusTimestampedCircularBuffer* buffer)
 {
@@ -411,6 +761,10 @@ void vtkPlusTimestampedCircularBuffer::DeepCopy(vtkPlusTimestampedCircularBuffer
   this->FilterContainerIndexVector = buffer->FilterContainerIndexVector;
 
   this->BufferItemContainer = buffer->BufferItemContainer;
+  if (this->IsItemTimingPublished())
+  {
+    this->RebuildItemTimingSlots();
+  }
   this->Unlock();
   buffer->Unlock();
 }
@@ -423,6 +777,10 @@ void vtkPlusTimestampedCircularBuffer::Clear()
   this->NumberOfItems = 0;
   this->CurrentTimeStamp = 0;
   this->LatestItemUid = 0;
+  if (this->IsItemTimingPublished())
+  {
+    this->PublishState();
+  }
   this->Unlock();
 }
 
@@ -11,7 +11,9 @@
 #include "PlusStreamBufferItem.h"
 #include "vtkObject.h"
 #include "vtkTypeTemplate.h"
+#include <atomic>
 #include <deque>
+#include <vector>
 
 #include "vnl/vnl_matrix.h"
 #include "vnl/vnl_vector.h"
@@ -33,6 +35,11 @@ enum ItemStatus { ITEM_OK, ITEM_NOT_AVAILABLE_YET, ITEM_NOT_AVAILABLE_ANYMORE, I
   \class vtkPlusTimestampedCircularBuffer
   \brief This class stores an fixed number of timestamped items.
   It provides element retrieval based on timestamp, temporal filtering and interpolation, etc.
+
+  If LockFreeReading is enabled then the UID, timestamp and index of each item is also published in
+  sequence-numbered timing slots (seqlock). Item UID and timestamp queries read these slots and validate
+  the sequence number instead of locking the buffer, so readers never block the thread that adds items.
+  Access to the item contents (GetBufferItemPointerFromUid, etc.) still requires locking the buffer.
   \ingroup PlusLibCommon
 */
 class vtkPlusTimestampedCircularBuffer: public vtkObject
@@ -65,6 +72,13 @@ public:
   /*! Get the most recent frame UID that is already in the buffer */
   virtual BufferItemUidType GetLatestItemUidInBuffer()
   {
+    if ( this->LockFreeReading )
+    {
+      BufferItemUidType latestUid( 0 );
+      int numberOfItems( 0 );
+      this->ReadPublishedState( latestUid, numberOfItems );
+      return latestUid;
+    }
     this->Lock();
     BufferItemUidType latestUid = this->LatestItemUid;
     this->Unlock();
@@ -74,6 +88,13 @@ public:
   /*! Get the oldest frame UID in the buffer  */
   virtual BufferItemUidType GetOldestItemUidInBuffer()
   {
+    if ( this->LockFreeReading )
+    {
+      BufferItemUidType latestUid( 0 );
+      int numberOfItems( 0 );
+      this->ReadPublishedState( latestUid, numberOfItems );
+      return latestUid - ( numberOfItems - 1 );
+    }
     this->Lock();
     // LatestItemUid - ( NumberOfItems - 1 ) is the oldest element in the buffer
     BufferItemUidType oldestUid = this->LatestItemUid - ( this->NumberOfItems - 1 );
@@ -89,6 +110,10 @@ public:
 
   virtual ItemStatus GetOldestTimeStamp( double& timestamp )
   {
+    if ( this->LockFreeReading )
+    {
+      return this->GetOldestTimeStampLockFree( timestamp );
+    }
     // The oldest item may be removed from the buffer at any moment
     // therefore we need to retrieve its UID and timestamp within a single lock
     this->Lock();
@@ -142,6 +167,18 @@ public:
   /*! Clear buffer (set the buffer pointer to the first element) */
   virtual void Clear();
 
+  /*!
+    Enable/disable lock-free reading of item UIDs, timestamps and indices (see class description).
+    It can be changed while other threads are reading the buffer: once lock-free reading has been enabled,
+    the timing slots are kept up to date even after it is disabled, so a query that has already chosen the
+    lock-free path still sees consistent data.
+    The buffer size can be changed in this mode as well, but the replaced timing slots are only released
+    when the buffer is deleted (readers may still be using them), so the buffer size should not be changed frequently.
+  */
+  virtual void SetLockFreeReading( bool enable );
+  virtual bool GetLockFreeReading() { return this->LockFreeReading; };
+  vtkBooleanMacro( LockFreeReading, bool );
+
   /*!
     Lock the buffer: this should be done before changing or accessing
     the data in the buffer if the buffer is being used from multiple
@@ -169,6 +206,13 @@ public:
 
   virtual PlusStatus PrepareForNewItem( const double timestamp, BufferItemUidType& newFrameUid, int& bufferIndex );
 
+  /*!
+    Reserve the next buffer item for writing. The item timing information (filtered and unfiltered timestamp, index)
+    is published for lock-free readers. The caller must keep the buffer locked until the item content is written.
+    INTERNAL USE ONLY!
+  */
+  virtual PlusStatus PrepareForNewItem( const double timestamp, const double unfilteredTimestamp, unsigned long itemIndex, BufferItemUidType& newFrameUid, int& bufferIndex );
+
   /*!
     Create filtered and unfiltered timestamp for accurate timing of the buffer item.
     The timing may be inaccurate because the timestamp is attached to the item when Plus receives it
@@ -211,9 +255,75 @@ protected:
   vtkPlusTimestampedCircularBuffer();
   ~vtkPlusTimestampedCircularBuffer();
 
+  /*! Timing information of a buffer item that can be read without locking the buffer */
+  struct ItemTiming
+  {
+    ItemTiming() : Uid( 0 ), BufferIndex( 0 ), FilteredTimeStamp( 0 ), UnfilteredTimeStamp( 0 ), Index( 0 ) {}
+    BufferItemUidType Uid;
+    int BufferIndex;
+    double FilteredTimeStamp;
+    double UnfilteredTimeStamp;
+    unsigned long Index;
+  };
+
+  /*! Timing slot, written only while the buffer is locked. Sequence is odd while the slot is being written. */
+  struct ItemTimingSlot
+  {
+    ItemTimingSlot() : Sequence( 0 ), Uid( 0 ), BufferIndex( 0 ), FilteredTimeStamp( 0 ), UnfilteredTimeStamp( 0 ), Index( 0 ) {}
+    std::atomic<unsigned int> Sequence;
+    std::atomic<BufferItemUidType> Uid;
+    std::atomic<int> BufferIndex;
+    std::atomic<double> FilteredTimeStamp;
+    std::atomic<double> UnfilteredTimeStamp;
+    std::atomic<unsigned long> Index;
+  };
+
+  /*! Array of timing slots. Once it has been published to readers it is not deleted until the buffer is deleted. */
+  struct ItemTimingSlotArray
+  {
+    explicit ItemTimingSlotArray( int numberOfSlots ) : NumberOfSlots( numberOfSlots ), Slots( new ItemTimingSlot[numberOfSlots] ) {}
+    ~ItemTimingSlotArray() { delete[] this->Slots; }
+    const int NumberOfSlots;
+    ItemTimingSlot* const Slots;
+  };
+
+  /*! Get the latest item UID and number of items as a consistent pair, without locking the buffer */
+  void ReadPublishedState( BufferItemUidType& latestUid, int& numberOfItems );
+  /*! Publish the latest item UID and number of items for lock-free readers. The caller must have locked the buffer. */
+  void PublishState();
+  /*! Read the timing information of an item without locking the buffer */
+  ItemStatus ReadItemTiming( const BufferItemUidType uid, ItemTiming& timing );
+  /*! Write the timing information of an item to its slot in the specified slot array. The caller must have locked the buffer. */
+  void PublishItemTiming( ItemTimingSlotArray* slots, const ItemTiming& timing );
+  /*!
+    Fill the timing slots from the buffer items. If the buffer size has changed then a new slot array is filled and published
+    and the previous array is retired (kept until the buffer is deleted). The caller must have locked the buffer.
+  */
+  void RebuildItemTimingSlots();
+  /*! Returns true if the timing slots have to be updated when items are added (lock-free reading has been enabled at least once) */
+  bool IsItemTimingPublished() const { return this->ItemTimingPublished; };
+
+  ItemStatus GetItemUidFromTimeLockFree( const double time, BufferItemUidType& uid );
+  ItemStatus GetOldestTimeStampLockFree( double& timestamp );
+
 protected:
   vtkPlusRecursiveCriticalSection* Mutex;
 
+  /*! If enabled then item UIDs, timestamps and indices can be retrieved without locking the buffer. Read by reader threads without locking. */
+  std::atomic<bool> LockFreeReading;
+  /*! Set when lock-free reading is enabled first, from then on the timing slots are always updated. Only accessed while the buffer is locked. */
+  bool ItemTimingPublished;
+
+  /*! Timing slots for lock-free reading, the slot of an item is at index (uid % NumberOfSlots). NULL if there are no slots. */
+  std::atomic<ItemTimingSlotArray*> ItemTimingSlots;
+  /*! Timing slot arrays that have been replaced because of a buffer size change. Lock-free readers may still use them. */
+  std::vector<ItemTimingSlotArray*> RetiredItemTimingSlots;
+
+  /*! Latest item UID and number of items, as seen by lock-free readers. PublishedStateSequence is odd while they are being written. */
+  std::atomic<unsigned int> PublishedStateSequence;
+  std::atomic<BufferItemUidType> PublishedLatestItemUid;
+  std::atomic<int> PublishedNumberOfItems;
+
   int NumberOfItems;
 
   /*! Next image will be written here */
@@ -0,0 +1,166 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusHilbertTransformFft.h"
+
+#include "vtkMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------
+PlusHilbertTransformFft::PlusHilbertTransformFft()
+  : NumberOfSamples(0)
+  , FftSize(0)
+{
+}
+
+//----------------------------------------------------------------------------
+void PlusHilbertTransformFft::Initialize(int numberOfSamples)
+{
+  this->NumberOfSamples = numberOfSamples;
+
+  int fftSize = 2;
+  int log2FftSize = 1;
+  while (fftSize < numberOfSamples)
+  {
+    fftSize *= 2;
+    log2FftSize++;
+  }
+  if (fftSize == this->FftSize)
+  {
+    // tables are already computed
+    return;
+  }
+  this->FftSize = fftSize;
+
+  this->BitReversedIndices.resize(fftSize);
+  for (int i = 0; i < fftSize; i++)
+  {
+    int reversed = 0;
+    for (int bit = 0; bit < log2FftSize; bit++)
+    {
+      reversed |= ((i >> bit) & 1) << (log2FftSize - 1 - bit);
+    }
+    this->BitReversedIndices[i] = reversed;
+  }
+
+  this->TwiddleReal.resize(fftSize - 1);
+  this->TwiddleImag.resize(fftSize - 1);
+  for (int halfBlockSize = 1; halfBlockSize < fftSize; halfBlockSize *= 2)
+  {
+    for (int j = 0; j < halfBlockSize; j++)
+    {
+      double angle = -vtkMath::Pi() * j / halfBlockSize;
+      this->TwiddleReal[halfBlockSize - 1 + j] = cos(angle);
+      this->TwiddleImag[halfBlockSize - 1 + j] = sin(angle);
+    }
+  }
+
+  this->Real.resize(fftSize);
+  this->Imag.resize(fftSize);
+}
+
+//----------------------------------------------------------------------------
+void PlusHilbertTransformFft::Fft(double* real, double* imag) const
+{
+  const int fftSize = this->FftSize;
+  for (int i = 0; i < fftSize; i++)
+  {
+    int j = this->BitReversedIndices[i];
+    if (i < j)
+    {
+      std::swap(real[i], real[j]);
+      std::swap(imag[i], imag[j]);
+    }
+  }
+
+  for (int halfBlockSize = 1; halfBlockSize < fftSize; halfBlockSize *= 2)
+  {
+    const double* twiddleReal = &this->TwiddleReal[halfBlockSize - 1];
+    const double* twiddleImag = &this->TwiddleImag[halfBlockSize - 1];
+    for (int blockStart = 0; blockStart < fftSize; blockStart += 2 * halfBlockSize)
+    {
+      double* aReal = real + blockStart;
+      double* aImag = imag + blockStart;
+      double* bReal = aReal + halfBlockSize;
+      double* bImag = aImag + halfBlockSize;
+      for (int j = 0; j < halfBlockSize; j++)
+      {
+        double tReal = bReal[j] * twiddleReal[j] - bImag[j] * twiddleImag[j];
+        double tImag = bReal[j] * twiddleImag[j] + bImag[j] * twiddleReal[j];
+        bReal[j] = aReal[j] - tReal;
+        bImag[j] = aImag[j] - tImag;
+        aReal[j] += tReal;
+        aImag[j] += tImag;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void PlusHilbertTransformFft::ComputeHilbertTransform(const short* signal1, const short* signal2, double* hilbertTransform1, double* hilbertTransform2)
+{
+  const int fftSize = this->FftSize;
+  const int numberOfSamples = this->NumberOfSamples;
+  double* real = &this->Real[0];
+  double* imag = &this->Imag[0];
+
+  for (int i = 0; i < numberOfSamples; i++)
+  {
+    real[i] = signal1[i];
+  }
+  if (signal2 != NULL)
+  {
+    for (int i = 0; i < numberOfSamples; i++)
+    {
+      imag[i] = signal2[i];
+    }
+  }
+  else
+  {
+    std::fill(imag, imag + numberOfSamples, 0.0);
+  }
+  std::fill(real + numberOfSamples, real + fftSize, 0.0);
+  std::fill(imag + numberOfSamples, imag + fftSize, 0.0);
+
+  this->Fft(real, imag);
+
+  // Multiply by -i*sign(frequency): positive frequencies (a+ib)*(-i) = b-ia, negative frequencies (a+ib)*i = -b+ia.
+  // The DC and Nyquist components are removed.
+  const int nyquistIndex = fftSize / 2;
+  real[0] = imag[0] = 0.0;
+  real[nyquistIndex] = imag[nyquistIndex] = 0.0;
+  for (int k = 1; k < nyquistIndex; k++)
+  {
+    double a = real[k];
+    real[k] = imag[k];
+    imag[k] = -a;
+  }
+  for (int k = nyquistIndex + 1; k < fftSize; k++)
+  {
+    double a = real[k];
+    real[k] = -imag[k];
+    imag[k] = a;
+  }
+
+  // Inverse FFT: swapping the real and imaginary parts of the input and output computes the conjugate transform
+  this->Fft(imag, real);
+
+  const double scale = 1.0 / fftSize;
+  for (int i = 0; i < numberOfSamples; i++)
+  {
+    hilbertTransform1[i] = real[i] * scale;
+  }
+  if (hilbertTransform2 != NULL)
+  {
+    for (int i = 0; i < numberOfSamples; i++)
+    {
+      hilbertTransform2[i] = imag[i] * scale;
+    }
+  }
+}
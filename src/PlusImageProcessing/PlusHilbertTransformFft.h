@@ -0,0 +1,71 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusHilbertTransformFft_h
+#define __PlusHilbertTransformFft_h
+
+#include "vtkPlusImageProcessingExport.h"
+
+#include <vector>
+
+/*!
+  \class PlusHilbertTransformFft
+  \brief Computes the Hilbert transform of RF scanlines in the frequency domain
+
+  The signal is zero-padded to the next power of two, transformed by a radix-2 FFT, multiplied by
+  -i*sign(frequency), then transformed back. As the Hilbert transform maps real signals to real signals,
+  two scanlines are processed at once by storing them in the real and imaginary part of the same complex signal.
+
+  The FFT stores the real and imaginary parts in separate arrays and each butterfly stage uses a contiguous
+  table of twiddle factors, so that the compiler can vectorize the inner loops.
+
+  The object holds work buffers, therefore each thread must use its own instance.
+
+  \ingroup PlusLibImageProcessingAlgo
+*/
+class vtkPlusImageProcessingExport PlusHilbertTransformFft
+{
+public:
+  PlusHilbertTransformFft();
+
+  /*! Prepare the transform for signals with numberOfSamples samples. Tables are only recomputed if the FFT size changes. */
+  void Initialize(int numberOfSamples);
+
+  /*! Get the number of samples in the input signals */
+  int GetNumberOfSamples() const { return this->NumberOfSamples; }
+
+  /*! Get the size of the zero-padded signal that is used in the FFT */
+  int GetFftSize() const { return this->FftSize; }
+
+  /*!
+    Compute the Hilbert transform of one or two signals of NumberOfSamples samples.
+    \param signal1 First input signal
+    \param signal2 Second input signal, may be NULL if only one signal is processed
+    \param hilbertTransform1 Hilbert transform of the first input signal
+    \param hilbertTransform2 Hilbert transform of the second input signal, may be NULL if signal2 is NULL
+  */
+  void ComputeHilbertTransform(const short* signal1, const short* signal2, double* hilbertTransform1, double* hilbertTransform2);
+
+protected:
+  /*! In-place forward FFT. The inverse FFT is computed by swapping the real and imaginary arrays. */
+  void Fft(double* real, double* imag) const;
+
+  int NumberOfSamples;
+  int FftSize;
+
+  /*! Permutation of the input samples for the iterative FFT */
+  std::vector<int> BitReversedIndices;
+
+  /*! Twiddle factors, the butterfly stage that combines blocks of size N uses the entries [N-1, 2N-2] */
+  std::vector<double> TwiddleReal;
+  std::vector<double> TwiddleImag;
+
+  /*! Work buffers */
+  std::vector<double> Real;
+  std::vector<double> Imag;
+};
+
+#endif
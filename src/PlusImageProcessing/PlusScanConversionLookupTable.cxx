@@ -0,0 +1,455 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusScanConversionLookupTable.h"
+
+#include "vtkType.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define PLUS_SCAN_CONVERSION_X86_SIMD
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#endif
+
+// GCC and Clang only emit instructions of the enabled instruction sets, so the AVX2 kernel
+// has to be marked explicitly (this way the rest of the library does not require AVX2).
+#if defined(PLUS_SCAN_CONVERSION_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  #define PLUS_SCAN_CONVERSION_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define PLUS_SCAN_CONVERSION_TARGET_AVX2
+#endif
+
+namespace
+{
+  const char LOOKUP_TABLE_FILE_SIGNATURE[8] = { 'P', 'L', 'U', 'S', 'S', 'C', 'L', 'T' };
+  const int LOOKUP_TABLE_FILE_VERSION = 1;
+
+  // Gather instructions read 4 bytes for each pixel
+  const int GATHER_READ_SIZE_BYTES = 4;
+
+  //----------------------------------------------------------------------------
+  bool DetectAvx2Support()
+  {
+#if defined(PLUS_SCAN_CONVERSION_X86_SIMD) && defined(_MSC_VER)
+    int cpuInfo[4] = {0};
+    __cpuid(cpuInfo, 0);
+    int maxFunctionId = cpuInfo[0];
+    if (maxFunctionId < 7)
+    {
+      return false;
+    }
+    __cpuid(cpuInfo, 1);
+    bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+    bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+    // AVX registers can only be used if the operating system saves them on context switch
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+      return false;
+    }
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#elif defined(PLUS_SCAN_CONVERSION_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+  }
+
+#ifdef PLUS_SCAN_CONVERSION_X86_SIMD
+  //----------------------------------------------------------------------------
+  // Processes the entries in groups of 8, returns the index of the first entry that has not been processed
+  template<class T>
+  PLUS_SCAN_CONVERSION_TARGET_AVX2 int ApplyAvx2(const T* inputPixels, T* outputPixels, int firstEntry, int afterLastEntry,
+      const int* inputPixelIndices, const int* outputPixelIndices, const unsigned short* const weights[4], int columnOffset, int rowOffset)
+  {
+    const int* gatherBase = reinterpret_cast<const int*>(inputPixels);
+    const __m256i pixelMask = _mm256_set1_epi32(sizeof(T) == 1 ? 0xFF : 0xFFFF);
+    const __m256i rounding = _mm256_set1_epi32(1 << (PlusScanConversionLookupTable::WEIGHT_FRACTION_BITS - 1));
+    const __m256i columnOffsetVec = _mm256_set1_epi32(columnOffset);
+    const __m256i rowOffsetVec = _mm256_set1_epi32(rowOffset);
+
+    int entryIndex = firstEntry;
+    for (; entryIndex + 8 <= afterLastEntry; entryIndex += 8)
+    {
+      __m256i index00 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputPixelIndices + entryIndex));
+      __m256i index01 = _mm256_add_epi32(index00, columnOffsetVec);
+      __m256i index10 = _mm256_add_epi32(index00, rowOffsetVec);
+      __m256i index11 = _mm256_add_epi32(index10, columnOffsetVec);
+
+      __m256i pixel00 = _mm256_and_si256(_mm256_i32gather_epi32(gatherBase, index00, sizeof(T)), pixelMask);
+      __m256i pixel01 = _mm256_and_si256(_mm256_i32gather_epi32(gatherBase, index01, sizeof(T)), pixelMask);
+      __m256i pixel10 = _mm256_and_si256(_mm256_i32gather_epi32(gatherBase, index10, sizeof(T)), pixelMask);
+      __m256i pixel11 = _mm256_and_si256(_mm256_i32gather_epi32(gatherBase, index11, sizeof(T)), pixelMask);
+
+      __m256i weight00 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights[0] + entryIndex)));
+      __m256i weight01 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights[1] + entryIndex)));
+      __m256i weight10 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights[2] + entryIndex)));
+      __m256i weight11 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(weights[3] + entryIndex)));
+
+      // The weights sum up to WEIGHT_ONE, so the sum fits into 32 bits even for unsigned short pixels
+      __m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(pixel00, weight00), _mm256_mullo_epi32(pixel01, weight01));
+      sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(pixel10, weight10));
+      sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(pixel11, weight11));
+      sum = _mm256_srli_epi32(_mm256_add_epi32(sum, rounding), PlusScanConversionLookupTable::WEIGHT_FRACTION_BITS);
+
+      // There is no scatter instruction in AVX2, the output pixels are written one by one
+      int result[8];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(result), sum);
+      const int* outputIndex = outputPixelIndices + entryIndex;
+      for (int i = 0; i < 8; ++i)
+      {
+        outputPixels[outputIndex[i]] = static_cast<T>(result[i]);
+      }
+    }
+    return entryIndex;
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------
+PlusScanConversionLookupTable::PlusScanConversionLookupTable()
+  : NumberOfInputPixels(0)
+  , ColumnOffset(0)
+  , RowOffset(0)
+  , NumberOfGatherSafeEntries(0)
+  , UseSimd(IsAvx2Supported())
+{
+  this->OutputImageSize[0] = 0;
+  this->OutputImageSize[1] = 0;
+}
+
+//----------------------------------------------------------------------------
+PlusScanConversionLookupTable::~PlusScanConversionLookupTable()
+{
+}
+
+//----------------------------------------------------------------------------
+bool PlusScanConversionLookupTable::IsAvx2Supported()
+{
+  static const bool avx2Supported = DetectAvx2Support();
+  return avx2Supported;
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::SetUseSimd(bool useSimd)
+{
+  this->UseSimd = useSimd && IsAvx2Supported();
+}
+
+//----------------------------------------------------------------------------
+bool PlusScanConversionLookupTable::IsScalarTypeSupported(int vtkScalarType)
+{
+  return vtkScalarType == VTK_UNSIGNED_CHAR || vtkScalarType == VTK_UNSIGNED_SHORT;
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::Clear()
+{
+  this->InputPixelIndices.clear();
+  this->OutputPixelIndices.clear();
+  for (int i = 0; i < 4; ++i)
+  {
+    this->Weights[i].clear();
+  }
+  this->NumberOfGatherSafeEntries = 0;
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::Initialize(int numberOfInputPixels, const int outputImageSize[2], int columnOffset, int rowOffset)
+{
+  this->Clear();
+  this->NumberOfInputPixels = numberOfInputPixels;
+  this->OutputImageSize[0] = outputImageSize[0];
+  this->OutputImageSize[1] = outputImageSize[1];
+  this->ColumnOffset = columnOffset;
+  this->RowOffset = rowOffset;
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::AddEntry(int inputPixelIndex, int outputPixelIndex, const double weights[4])
+{
+  int quantizedWeights[4] = {0};
+  int sumOfWeights = 0;
+  int largestWeightIndex = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    quantizedWeights[i] = std::min(std::max(static_cast<int>(floor(weights[i] * WEIGHT_ONE + 0.5)), 0), static_cast<int>(WEIGHT_ONE));
+    sumOfWeights += quantizedWeights[i];
+    if (quantizedWeights[i] > quantizedWeights[largestWeightIndex])
+    {
+      largestWeightIndex = i;
+    }
+  }
+  // Make the weights sum up to exactly 1, so that a uniform input region results in the same output value
+  quantizedWeights[largestWeightIndex] += WEIGHT_ONE - sumOfWeights;
+
+  this->InputPixelIndices.push_back(inputPixelIndex);
+  this->OutputPixelIndices.push_back(outputPixelIndex);
+  for (int i = 0; i < 4; ++i)
+  {
+    this->Weights[i].push_back(static_cast<unsigned short>(quantizedWeights[i]));
+  }
+}
+
+//----------------------------------------------------------------------------
+bool PlusScanConversionLookupTable::IsEntryGatherSafe(int inputPixelIndex) const
+{
+  int lastInputPixelIndex = inputPixelIndex + this->RowOffset + this->ColumnOffset;
+  return inputPixelIndex >= 0 && lastInputPixelIndex + GATHER_READ_SIZE_BYTES <= this->NumberOfInputPixels;
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::Finalize()
+{
+  const int numberOfEntries = this->GetNumberOfEntries();
+  const int outputImageWidth = std::max(this->OutputImageSize[0], 1);
+  const int numberOfTilesX = (outputImageWidth + TILE_SIZE_X - 1) / TILE_SIZE_X;
+
+  // Sort key of each entry: gather-unsafe entries go to the end, the others are ordered by output tile then output pixel
+  std::vector< std::pair<std::pair<int, int>, int> > sortKeys(numberOfEntries);
+  for (int entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+  {
+    int outputPixelIndex = this->OutputPixelIndices[entryIndex];
+    int tileIndex = (outputPixelIndex / outputImageWidth / TILE_SIZE_Y) * numberOfTilesX + (outputPixelIndex % outputImageWidth) / TILE_SIZE_X;
+    if (!IsEntryGatherSafe(this->InputPixelIndices[entryIndex]))
+    {
+      tileIndex = VTK_INT_MAX;
+    }
+    sortKeys[entryIndex] = std::make_pair(std::make_pair(tileIndex, outputPixelIndex), entryIndex);
+  }
+  std::sort(sortKeys.begin(), sortKeys.end());
+
+  std::vector<int> inputPixelIndices(numberOfEntries);
+  std::vector<int> outputPixelIndices(numberOfEntries);
+  std::vector<unsigned short> weights[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    weights[i].resize(numberOfEntries);
+  }
+  this->NumberOfGatherSafeEntries = 0;
+  for (int entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+  {
+    int sourceIndex = sortKeys[entryIndex].second;
+    inputPixelIndices[entryIndex] = this->InputPixelIndices[sourceIndex];
+    outputPixelIndices[entryIndex] = this->OutputPixelIndices[sourceIndex];
+    for (int i = 0; i < 4; ++i)
+    {
+      weights[i][entryIndex] = this->Weights[i][sourceIndex];
+    }
+    if (sortKeys[entryIndex].first.first != VTK_INT_MAX)
+    {
+      this->NumberOfGatherSafeEntries = entryIndex + 1;
+    }
+  }
+  this->InputPixelIndices.swap(inputPixelIndices);
+  this->OutputPixelIndices.swap(outputPixelIndices);
+  for (int i = 0; i < 4; ++i)
+  {
+    this->Weights[i].swap(weights[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::GetEntry(int entryIndex, int& inputPixelIndex, int& outputPixelIndex, double weights[4]) const
+{
+  inputPixelIndex = this->InputPixelIndices[entryIndex];
+  outputPixelIndex = this->OutputPixelIndices[entryIndex];
+  for (int i = 0; i < 4; ++i)
+  {
+    weights[i] = static_cast<double>(this->Weights[i][entryIndex]) / WEIGHT_ONE;
+  }
+}
+
+//----------------------------------------------------------------------------
+template<class T>
+void PlusScanConversionLookupTable::ApplyScalar(const T* inputPixels, T* outputPixels, int firstEntry, int afterLastEntry) const
+{
+  const int columnOffset = this->ColumnOffset;
+  const int rowOffset = this->RowOffset;
+  for (int entryIndex = firstEntry; entryIndex < afterLastEntry; ++entryIndex)
+  {
+    const T* inputPixel = inputPixels + this->InputPixelIndices[entryIndex];
+    unsigned int sum = static_cast<unsigned int>(inputPixel[0]) * this->Weights[0][entryIndex]
+                       + static_cast<unsigned int>(inputPixel[columnOffset]) * this->Weights[1][entryIndex]
+                       + static_cast<unsigned int>(inputPixel[rowOffset]) * this->Weights[2][entryIndex]
+                       + static_cast<unsigned int>(inputPixel[rowOffset + columnOffset]) * this->Weights[3][entryIndex];
+    outputPixels[this->OutputPixelIndices[entryIndex]] = static_cast<T>((sum + (1 << (WEIGHT_FRACTION_BITS - 1))) >> WEIGHT_FRACTION_BITS);
+  }
+}
+
+//----------------------------------------------------------------------------
+template<class T>
+void PlusScanConversionLookupTable::ApplyGeneric(const T* inputPixels, T* outputPixels, int firstEntry, int lastEntry) const
+{
+  int afterLastEntry = std::min(lastEntry + 1, this->GetNumberOfEntries());
+  int entryIndex = std::max(firstEntry, 0);
+#ifdef PLUS_SCAN_CONVERSION_X86_SIMD
+  if (this->UseSimd)
+  {
+    int afterLastSimdEntry = std::min(afterLastEntry, this->NumberOfGatherSafeEntries);
+    if (entryIndex < afterLastSimdEntry)
+    {
+      const unsigned short* const weights[4] = { &this->Weights[0][0], &this->Weights[1][0], &this->Weights[2][0], &this->Weights[3][0] };
+      entryIndex = ApplyAvx2(inputPixels, outputPixels, entryIndex, afterLastSimdEntry,
+                             &this->InputPixelIndices[0], &this->OutputPixelIndices[0], weights, this->ColumnOffset, this->RowOffset);
+    }
+  }
+#endif
+  // Remaining entries (and all entries if SIMD is not used)
+  this->ApplyScalar(inputPixels, outputPixels, entryIndex, afterLastEntry);
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::Apply(const unsigned char* inputPixels, unsigned char* outputPixels, int firstEntry, int lastEntry) const
+{
+  this->ApplyGeneric(inputPixels, outputPixels, firstEntry, lastEntry);
+}
+
+//----------------------------------------------------------------------------
+void PlusScanConversionLookupTable::Apply(const unsigned short* inputPixels, unsigned short* outputPixels, int firstEntry, int lastEntry) const
+{
+  this->ApplyGeneric(inputPixels, outputPixels, firstEntry, lastEntry);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusScanConversionLookupTable::WriteToFile(const std::string& filename, const std::vector<double>& parameters) const
+{
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    LOG_ERROR("Failed to open scan conversion lookup table file for writing: " << filename);
+    return PLUS_FAIL;
+  }
+
+  const int numberOfEntries = this->GetNumberOfEntries();
+  const int numberOfParameters = static_cast<int>(parameters.size());
+  const int header[9] =
+  {
+    LOOKUP_TABLE_FILE_VERSION, numberOfParameters, this->NumberOfInputPixels, this->OutputImageSize[0], this->OutputImageSize[1],
+    this->ColumnOffset, this->RowOffset, numberOfEntries, this->NumberOfGatherSafeEntries
+  };
+  file.write(LOOKUP_TABLE_FILE_SIGNATURE, sizeof(LOOKUP_TABLE_FILE_SIGNATURE));
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  if (numberOfParameters > 0)
+  {
+    file.write(reinterpret_cast<const char*>(&parameters[0]), numberOfParameters * sizeof(double));
+  }
+  if (numberOfEntries > 0)
+  {
+    file.write(reinterpret_cast<const char*>(&this->InputPixelIndices[0]), numberOfEntries * sizeof(int));
+    file.write(reinterpret_cast<const char*>(&this->OutputPixelIndices[0]), numberOfEntries * sizeof(int));
+    for (int i = 0; i < 4; ++i)
+    {
+      file.write(reinterpret_cast<const char*>(&this->Weights[i][0]), numberOfEntries * sizeof(unsigned short));
+    }
+  }
+  if (!file.good())
+  {
+    LOG_ERROR("Failed to write scan conversion lookup table file: " << filename);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusScanConversionLookupTable::ReadFromFile(const std::string& filename, const std::vector<double>& expectedParameters)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open())
+  {
+    LOG_DEBUG("Scan conversion lookup table file cannot be opened: " << filename);
+    return PLUS_FAIL;
+  }
+
+  char signature[sizeof(LOOKUP_TABLE_FILE_SIGNATURE)] = {0};
+  int header[9] = {0};
+  file.read(signature, sizeof(signature));
+  file.read(reinterpret_cast<char*>(header), sizeof(header));
+  if (!file.good() || !std::equal(signature, signature + sizeof(signature), LOOKUP_TABLE_FILE_SIGNATURE) || header[0] != LOOKUP_TABLE_FILE_VERSION)
+  {
+    LOG_WARNING("Invalid scan conversion lookup table file: " << filename);
+    return PLUS_FAIL;
+  }
+
+  const int numberOfParameters = header[1];
+  if (numberOfParameters != static_cast<int>(expectedParameters.size()))
+  {
+    LOG_DEBUG("Scan conversion lookup table in file " << filename << " was computed with different parameters");
+    return PLUS_FAIL;
+  }
+  std::vector<double> parameters(numberOfParameters);
+  if (numberOfParameters > 0)
+  {
+    file.read(reinterpret_cast<char*>(&parameters[0]), numberOfParameters * sizeof(double));
+  }
+  if (!file.good() || parameters != expectedParameters
+      || header[2] != this->NumberOfInputPixels || header[3] != this->OutputImageSize[0] || header[4] != this->OutputImageSize[1]
+      || header[5] != this->ColumnOffset || header[6] != this->RowOffset)
+  {
+    LOG_DEBUG("Scan conversion lookup table in file " << filename << " was computed with different parameters");
+    return PLUS_FAIL;
+  }
+
+  const int numberOfEntries = header[7];
+  const int numberOfGatherSafeEntries = header[8];
+  const int numberOfOutputPixels = this->OutputImageSize[0] * this->OutputImageSize[1];
+  if (numberOfEntries < 0 || numberOfEntries > numberOfOutputPixels || numberOfGatherSafeEntries < 0 || numberOfGatherSafeEntries > numberOfEntries)
+  {
+    LOG_WARNING("Invalid scan conversion lookup table file: " << filename);
+    return PLUS_FAIL;
+  }
+
+  this->Clear();
+  this->InputPixelIndices.resize(numberOfEntries);
+  this->OutputPixelIndices.resize(numberOfEntries);
+  for (int i = 0; i < 4; ++i)
+  {
+    this->Weights[i].resize(numberOfEntries);
+  }
+  if (numberOfEntries > 0)
+  {
+    file.read(reinterpret_cast<char*>(&this->InputPixelIndices[0]), numberOfEntries * sizeof(int));
+    file.read(reinterpret_cast<char*>(&this->OutputPixelIndices[0]), numberOfEntries * sizeof(int));
+    for (int i = 0; i < 4; ++i)
+    {
+      file.read(reinterpret_cast<char*>(&this->Weights[i][0]), numberOfEntries * sizeof(unsigned short));
+    }
+  }
+  if (!file.good())
+  {
+    LOG_WARNING("Scan conversion lookup table file is truncated: " << filename);
+    this->Clear();
+    return PLUS_FAIL;
+  }
+
+  // Make sure that a corrupted file cannot make the scan conversion access memory outside the images
+  for (int entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+  {
+    int inputPixelIndex = this->InputPixelIndices[entryIndex];
+    int outputPixelIndex = this->OutputPixelIndices[entryIndex];
+    int sumOfWeights = this->Weights[0][entryIndex] + this->Weights[1][entryIndex] + this->Weights[2][entryIndex] + this->Weights[3][entryIndex];
+    bool valid = inputPixelIndex >= 0 && inputPixelIndex + this->RowOffset + this->ColumnOffset < this->NumberOfInputPixels
+                 && outputPixelIndex >= 0 && outputPixelIndex < numberOfOutputPixels && sumOfWeights == WEIGHT_ONE
+                 && (entryIndex >= numberOfGatherSafeEntries || IsEntryGatherSafe(inputPixelIndex));
+    if (!valid)
+    {
+      LOG_WARNING("Invalid entry #" << entryIndex << " in scan conversion lookup table file: " << filename);
+      this->Clear();
+      return PLUS_FAIL;
+    }
+  }
+  this->NumberOfGatherSafeEntries = numberOfGatherSafeEntries;
+
+  return PLUS_SUCCESS;
+}
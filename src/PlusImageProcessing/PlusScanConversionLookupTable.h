@@ -0,0 +1,136 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusScanConversionLookupTable_h
+#define __PlusScanConversionLookupTable_h
+
+#include "PlusConfigure.h"
+#include "vtkPlusImageProcessingExport.h"
+
+#include <string>
+#include <vector>
+
+/*!
+  \class PlusScanConversionLookupTable
+  \brief Precomputed table that constructs each scan converted output pixel from 4 input pixels
+
+  Each entry of the table computes one output pixel as the weighted sum of the input pixels at
+  inputPixelIndex, inputPixelIndex+ColumnOffset, inputPixelIndex+RowOffset, and inputPixelIndex+RowOffset+ColumnOffset.
+
+  The table is stored as a structure of arrays, with the weights quantized to 16-bit fixed-point
+  values (WEIGHT_FRACTION_BITS fractional bits, the 4 weights of an entry sum up to exactly WEIGHT_ONE).
+  The entries are ordered by output image tiles, so that the input and output pixels that are
+  accessed by consecutive entries are close to each other in memory.
+
+  The table can be applied to unsigned char and unsigned short images. On CPUs that support AVX2 the
+  input pixels of 8 entries are fetched with gather instructions. The SIMD and scalar code paths compute
+  exactly the same result.
+
+  The table can be saved to a file and loaded later, to avoid recomputing it each time the same probe
+  configuration is used. The file stores the parameters that the table was computed from, and
+  loading fails if they do not match the expected parameters. The file uses the native byte order.
+
+  \ingroup PlusLibImageProcessingAlgo
+*/
+class vtkPlusImageProcessingExport PlusScanConversionLookupTable
+{
+public:
+  /*! Number of fractional bits of the quantized weights */
+  static const int WEIGHT_FRACTION_BITS = 15;
+  /*! Quantized value of weight 1.0 */
+  static const int WEIGHT_ONE = 1 << WEIGHT_FRACTION_BITS;
+
+  /*! Size of the output image tiles that the entries are ordered by (in pixels) */
+  static const int TILE_SIZE_X = 64;
+  static const int TILE_SIZE_Y = 16;
+
+  PlusScanConversionLookupTable();
+  virtual ~PlusScanConversionLookupTable();
+
+  /*!
+    Remove all entries and set the image geometry. Entries can be added by AddEntry then Finalize must be called.
+    \param numberOfInputPixels Number of pixels in the input image (used for preventing reading beyond the input buffer)
+    \param outputImageSize Number of output image columns and rows (used for ordering the entries by tiles)
+    \param columnOffset Offset of the second and fourth input pixel of an entry
+    \param rowOffset Offset of the third and fourth input pixel of an entry
+  */
+  void Initialize(int numberOfInputPixels, const int outputImageSize[2], int columnOffset, int rowOffset);
+
+  /*! Add an entry. The weights are quantized, they are expected to be in the [0,1] range and sum up to 1. */
+  void AddEntry(int inputPixelIndex, int outputPixelIndex, const double weights[4]);
+
+  /*! Order the entries by output tiles and make the table ready for use */
+  void Finalize();
+
+  /*! Remove all entries */
+  void Clear();
+
+  /*! Number of entries in the table */
+  int GetNumberOfEntries() const { return static_cast<int>(this->OutputPixelIndices.size()); }
+
+  /*! Get an entry of the table, with dequantized weights */
+  void GetEntry(int entryIndex, int& inputPixelIndex, int& outputPixelIndex, double weights[4]) const;
+
+  /*! Returns true if the table can be applied to images of the specified VTK scalar type */
+  static bool IsScalarTypeSupported(int vtkScalarType);
+
+  /*! Enable the AVX2 code path if it is supported by the CPU. Enabled by default. */
+  void SetUseSimd(bool useSimd);
+  bool GetUseSimd() const { return this->UseSimd; }
+
+  /*! Returns true if the CPU and the operating system support AVX2 instructions */
+  static bool IsAvx2Supported();
+
+  /*!
+    Compute the output pixels of the [firstEntry, lastEntry] range of the table entries.
+    Output pixels that are not in the table are not modified.
+  */
+  void Apply(const unsigned char* inputPixels, unsigned char* outputPixels, int firstEntry, int lastEntry) const;
+  void Apply(const unsigned short* inputPixels, unsigned short* outputPixels, int firstEntry, int lastEntry) const;
+
+  /*!
+    Save the table to file
+    \param parameters Parameters that the table was computed from
+  */
+  PlusStatus WriteToFile(const std::string& filename, const std::vector<double>& parameters) const;
+
+  /*!
+    Load the table from file
+    \param expectedParameters Loading fails if the table in the file was computed from different parameters
+    Initialize has to be called before loading, loading fails if the image geometry in the file is different.
+  */
+  PlusStatus ReadFromFile(const std::string& filename, const std::vector<double>& expectedParameters);
+
+protected:
+  template<class T> void ApplyScalar(const T* inputPixels, T* outputPixels, int firstEntry, int afterLastEntry) const;
+  template<class T> void ApplyGeneric(const T* inputPixels, T* outputPixels, int firstEntry, int lastEntry) const;
+
+  /*! Returns true if the entry may be processed by gather instructions */
+  bool IsEntryGatherSafe(int inputPixelIndex) const;
+
+  int NumberOfInputPixels;
+  int OutputImageSize[2];
+  int ColumnOffset;
+  int RowOffset;
+
+  /*! Position of the first input pixel of each entry */
+  std::vector<int> InputPixelIndices;
+  /*! Position of the output pixel of each entry */
+  std::vector<int> OutputPixelIndices;
+  /*! Quantized weights of the 4 input pixels of each entry */
+  std::vector<unsigned short> Weights[4];
+
+  /*!
+    Entries before this index can be processed by gather instructions: gather fetches 4 bytes for each pixel,
+    which could read beyond the end of the input buffer for the last few input pixels.
+    These entries are moved to the end of the table.
+  */
+  int NumberOfGatherSafeEntries;
+
+  bool UseSimd;
+};
+
+#endif
@@ -0,0 +1,214 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusRfToBrightnessConvertEnvelopeTest.cxx
+  \brief Compares the output and speed of the envelope detection methods of vtkPlusRfToBrightnessConvert
+
+  The FFT Hilbert transform is checked against the analytic Hilbert transform of a sinusoid.
+  Then synthetic RF_REAL frames are converted to brightness images by both the FIR and the FFT Hilbert transform.
+  The brightness images must be similar (except the first and last samples of each scanline, which are not computed by the FIR method)
+  and the processing time of both methods is reported.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusHilbertTransformFft.h"
+#include "PlusTestingHelpers.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPlusRfToBrightnessConvert.h"
+#include "vtkSmartPointer.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  const double MAX_HILBERT_TRANSFORM_ERROR = 3.0;
+  const double MAX_MEAN_BRIGHTNESS_DIFFERENCE = 2.0;
+}
+
+//----------------------------------------------------------------------------
+/*! Hilbert transform of cos is sin. Two signals are transformed at once, which must give the same result as transforming them separately. */
+int TestHilbertTransformOfSinusoid()
+{
+  const int numberOfSamples = 1000;
+  const double amplitude = 10000.0;
+  const double frequencies[2] = { 0.11, 0.23 }; // cycles per sample
+  std::vector<short> signals(2 * numberOfSamples);
+  for (int i = 0; i < numberOfSamples; i++)
+  {
+    signals[i] = static_cast<short>(floor(amplitude * cos(2 * vtkMath::Pi() * frequencies[0] * i) + 0.5));
+    signals[numberOfSamples + i] = static_cast<short>(floor(amplitude * cos(2 * vtkMath::Pi() * frequencies[1] * i) + 0.5));
+  }
+
+  PlusHilbertTransformFft hilbertTransform;
+  hilbertTransform.Initialize(numberOfSamples);
+  std::vector<double> pairResult(2 * numberOfSamples);
+  std::vector<double> singleResult(2 * numberOfSamples);
+  hilbertTransform.ComputeHilbertTransform(&signals[0], &signals[numberOfSamples], &pairResult[0], &pairResult[numberOfSamples]);
+  hilbertTransform.ComputeHilbertTransform(&signals[0], NULL, &singleResult[0], NULL);
+  hilbertTransform.ComputeHilbertTransform(&signals[numberOfSamples], NULL, &singleResult[numberOfSamples], NULL);
+
+  int numberOfFailures = 0;
+  for (int signalIndex = 0; signalIndex < 2; signalIndex++)
+  {
+    // The signal is not periodic in the FFT window, so the start and end of the signal is not checked
+    double maxError = 0;
+    double maxPairDifference = 0;
+    for (int i = numberOfSamples / 10; i < numberOfSamples * 9 / 10; i++)
+    {
+      double expected = amplitude * sin(2 * vtkMath::Pi() * frequencies[signalIndex] * i);
+      maxError = std::max(maxError, fabs(pairResult[signalIndex * numberOfSamples + i] - expected));
+    }
+    for (int i = 0; i < numberOfSamples; i++)
+    {
+      maxPairDifference = std::max(maxPairDifference, fabs(pairResult[signalIndex * numberOfSamples + i] - singleResult[signalIndex * numberOfSamples + i]));
+    }
+    LOG_INFO("Hilbert transform of sinusoid " << signalIndex << ": max error = " << maxError);
+    if (maxError > MAX_HILBERT_TRANSFORM_ERROR * amplitude / 100.0)
+    {
+      LOG_ERROR("Hilbert transform of sinusoid " << signalIndex << " is inaccurate: max error = " << maxError);
+      numberOfFailures++;
+    }
+    if (maxPairDifference > 1e-6 * amplitude)
+    {
+      LOG_ERROR("Hilbert transform of sinusoid " << signalIndex << " is different if computed with another signal: max difference = " << maxPairDifference);
+      numberOfFailures++;
+    }
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Create RF lines with a few echoes and some noise */
+void CreateRfFrame(vtkImageData* rfFrame, int numberOfSamples, int numberOfLines)
+{
+  rfFrame->SetExtent(0, numberOfSamples - 1, 0, numberOfLines - 1, 0, 0);
+  rfFrame->AllocateScalars(VTK_SHORT, 1);
+  short* rfPixels = static_cast<short*>(rfFrame->GetScalarPointer());
+  PlusTesting::TestRandomGenerator random;
+  const int numberOfEchoes = 12;
+  std::vector<double> echoPositions(numberOfEchoes);
+  std::vector<double> echoAmplitudes(numberOfEchoes);
+  for (int echoIndex = 0; echoIndex < numberOfEchoes; echoIndex++)
+  {
+    echoPositions[echoIndex] = random.Uniform(0, numberOfSamples);
+    echoAmplitudes[echoIndex] = random.Uniform(500, 5000);
+  }
+  for (int line = 0; line < numberOfLines; line++)
+  {
+    for (int sample = 0; sample < numberOfSamples; sample++)
+    {
+      double envelope = random.Uniform(50, 300);
+      for (int echoIndex = 0; echoIndex < numberOfEchoes; echoIndex++)
+      {
+        double distance = (sample - echoPositions[echoIndex] - 0.5 * line) / 15.0;
+        envelope += echoAmplitudes[echoIndex] * exp(-distance * distance);
+      }
+      rfPixels[line * numberOfSamples + sample] = static_cast<short>(envelope * sin(2 * vtkMath::Pi() * 0.15 * sample + 0.1 * line));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Convert the RF frame repeatedly and return the average processing time of a frame in milliseconds */
+double ConvertToBrightness(vtkImageData* rfFrame, vtkPlusRfToBrightnessConvert::EnvelopeDetectionMethodType method, int numberOfIterations, vtkImageData* brightnessImage)
+{
+  vtkSmartPointer<vtkPlusRfToBrightnessConvert> converter = vtkSmartPointer<vtkPlusRfToBrightnessConvert>::New();
+  converter->SetImageType(US_IMG_RF_REAL);
+  converter->SetEnvelopeDetectionMethod(method);
+  converter->SetInputData(rfFrame);
+  double startTime = vtkPlusAccurateTimer::GetSystemTime();
+  for (int i = 0; i < numberOfIterations; i++)
+  {
+    converter->Modified();
+    converter->Update();
+  }
+  double processingTimeMs = (vtkPlusAccurateTimer::GetSystemTime() - startTime) * 1000.0 / numberOfIterations;
+  brightnessImage->DeepCopy(converter->GetOutput());
+  return processingTimeMs;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp = false;
+  int numberOfSamples = 2000;
+  int numberOfLines = 255; // odd number of lines, to test the case when the last line has no pair
+  int numberOfIterations = 5;
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--number-of-samples", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfSamples, "Number of samples in each RF scanline (default: 2000)");
+  args.AddArgument("--number-of-lines", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfLines, "Number of RF scanlines (default: 255)");
+  args.AddArgument("--number-of-iterations", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfIterations, "Number of times each frame is processed for measuring the processing time (default: 5)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = TestHilbertTransformOfSinusoid();
+
+  vtkSmartPointer<vtkImageData> rfFrame = vtkSmartPointer<vtkImageData>::New();
+  CreateRfFrame(rfFrame, numberOfSamples, numberOfLines);
+
+  vtkSmartPointer<vtkImageData> firBrightnessImage = vtkSmartPointer<vtkImageData>::New();
+  vtkSmartPointer<vtkImageData> fftBrightnessImage = vtkSmartPointer<vtkImageData>::New();
+  double firProcessingTimeMs = ConvertToBrightness(rfFrame, vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FIR, numberOfIterations, firBrightnessImage);
+  double fftProcessingTimeMs = ConvertToBrightness(rfFrame, vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FFT, numberOfIterations, fftBrightnessImage);
+  LOG_INFO("Brightness conversion of " << numberOfLines << "x" << numberOfSamples << " RF frame: "
+    << "HILBERT_FIR " << firProcessingTimeMs << " ms, HILBERT_FFT " << fftProcessingTimeMs << " ms (speedup: " << firProcessingTimeMs / fftProcessingTimeMs << "x)");
+
+  // The FIR method does not compute the first and last half filter length of each scanline
+  vtkSmartPointer<vtkPlusRfToBrightnessConvert> defaultConverter = vtkSmartPointer<vtkPlusRfToBrightnessConvert>::New();
+  int margin = defaultConverter->GetNumberOfHilbertFilterCoeffs() / 2 + 1;
+  double sumDifference = 0;
+  int maxDifference = 0;
+  int numberOfComparedPixels = 0;
+  for (int line = 0; line < numberOfLines; line++)
+  {
+    unsigned char* firLine = static_cast<unsigned char*>(firBrightnessImage->GetScalarPointer(0, line, 0));
+    unsigned char* fftLine = static_cast<unsigned char*>(fftBrightnessImage->GetScalarPointer(0, line, 0));
+    for (int sample = margin; sample < numberOfSamples - margin; sample++)
+    {
+      int difference = abs(static_cast<int>(firLine[sample]) - static_cast<int>(fftLine[sample]));
+      sumDifference += difference;
+      maxDifference = std::max(maxDifference, difference);
+      numberOfComparedPixels++;
+    }
+  }
+  double meanDifference = (numberOfComparedPixels > 0 ? sumDifference / numberOfComparedPixels : 0.0);
+  LOG_INFO("Brightness difference between HILBERT_FIR and HILBERT_FFT: mean = " << meanDifference << ", max = " << maxDifference);
+  if (meanDifference > MAX_MEAN_BRIGHTNESS_DIFFERENCE)
+  {
+    LOG_ERROR("Brightness images computed by HILBERT_FIR and HILBERT_FFT are too different: mean difference = " << meanDifference);
+    numberOfFailures++;
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Test failed with " << numberOfFailures << " errors");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
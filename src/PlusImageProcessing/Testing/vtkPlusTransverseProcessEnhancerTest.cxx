@@ -7,6 +7,12 @@ See License.txt for details.
 /*!
 \file vtkPlusTransverseProcessEnhancerTest.cxx
 This is a program meant to test vtkPlusTransverseProcessEnhancer.cxx from the command line.
+
+If --compare-processing-paths is enabled then the frames are also processed by a test subclass that checks that
+- the preallocated pipeline gives exactly the same lines image, thresholded image and output image as the
+  previous pipeline, which created new intermediate images for each frame,
+- the fused kernels give the same result as the VTK filters, for the same input. The smoothed image and the
+  edge image may differ by at most --max-gray-level-difference gray levels, binary images must be identical.
 */
 
 #include "PlusConfigure.h"
@@ -19,7 +25,268 @@ This is a program meant to test vtkPlusTransverseProcessEnhancer.cxx from the co
 
 #include "PlusTrackedFrame.h"
 #include "vtkPlusTrackedFrameList.h"
+#include "vtkPlusUsScanConvert.h"
 #include "vtkImageCast.h"
+#include <vtkImageData.h>
+#include <vtkImageDilateErode3D.h>
+#include <vtkImageGaussianSmooth.h>
+#include <vtkImageIslandRemoval2D.h>
+#include <vtkImageSobel2D.h>
+#include <vtkImageThreshold.h>
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+/*! Returns 1 if the two unsigned char images have different size or any of their pixels differ by more than maxDifference */
+int CompareImages(vtkImageData* image, vtkImageData* referenceImage, int maxDifference, const std::string& imageName, int frameIndex)
+{
+  int dims[3] = { 0, 0, 0 };
+  image->GetDimensions(dims);
+  int referenceDims[3] = { 0, 0, 0 };
+  referenceImage->GetDimensions(referenceDims);
+  if (dims[0] != referenceDims[0] || dims[1] != referenceDims[1] || dims[2] != referenceDims[2])
+  {
+    LOG_ERROR(imageName << " size mismatch in frame " << frameIndex << ": " << dims[0] << "x" << dims[1] << "x" << dims[2]
+      << " (expected: " << referenceDims[0] << "x" << referenceDims[1] << "x" << referenceDims[2] << ")");
+    return 1;
+  }
+  if (image->GetScalarType() != VTK_UNSIGNED_CHAR || referenceImage->GetScalarType() != VTK_UNSIGNED_CHAR
+    || image->GetNumberOfScalarComponents() != referenceImage->GetNumberOfScalarComponents())
+  {
+    LOG_ERROR(imageName << " pixel type mismatch in frame " << frameIndex);
+    return 1;
+  }
+
+  vtkIdType numberOfValues = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2] * image->GetNumberOfScalarComponents();
+  const unsigned char* pixels = static_cast<const unsigned char*>(image->GetScalarPointer());
+  const unsigned char* referencePixels = static_cast<const unsigned char*>(referenceImage->GetScalarPointer());
+  vtkIdType numberOfDifferentPixels = 0;
+  int largestDifference = 0;
+  for (vtkIdType i = 0; i < numberOfValues; ++i)
+  {
+    int difference = abs(static_cast<int>(pixels[i]) - static_cast<int>(referencePixels[i]));
+    if (difference > maxDifference)
+    {
+      ++numberOfDifferentPixels;
+    }
+    largestDifference = std::max(largestDifference, difference);
+  }
+  if (numberOfDifferentPixels > 0)
+  {
+    LOG_ERROR(imageName << " mismatch in frame " << frameIndex << ": " << numberOfDifferentPixels << " pixels differ by more than "
+      << maxDifference << " gray levels (largest difference: " << largestDifference << ")");
+    return 1;
+  }
+  LOG_DEBUG(imageName << " in frame " << frameIndex << " matches (largest difference: " << largestDifference << ")");
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+/*! Gives access to the intermediate images and kernels of vtkPlusTransverseProcessEnhancer */
+class vtkPlusTransverseProcessEnhancerTester : public vtkPlusTransverseProcessEnhancer
+{
+public:
+  static vtkPlusTransverseProcessEnhancerTester* New();
+  vtkTypeMacro(vtkPlusTransverseProcessEnhancerTester, vtkPlusTransverseProcessEnhancer);
+
+  vtkImageData* GetLinesImage() { return this->LinesImage; }
+  vtkImageData* GetThresholdedLinesImage() { return this->ThresholdedLinesImage; }
+
+  /*!
+    Process the frame the way ProcessFrame did before the intermediate images were preallocated:
+    new images are created for each frame and the lines image is sampled and thresholded in separate passes.
+    ProcessFrame has to be called before to allocate the lines image.
+  */
+  void ProcessFrameWithPreviousPipeline(PlusTrackedFrame* inputFrame, vtkImageData* linesImage, vtkImageData* thresholdedImage, vtkImageData* outputImage)
+  {
+    this->BoneAreasInfo.clear();
+
+    vtkImageData* inputImage = inputFrame->GetImageData()->GetImage();
+    this->FillLinesImage(inputImage);
+    linesImage->DeepCopy(this->LinesImage);
+
+    int dimsFan[3] = { 0, 0, 0 };
+    inputImage->GetDimensions(dimsFan);
+    int dimsLines[3] = { 0, 0, 0 };
+    linesImage->GetDimensions(dimsLines);
+    this->SetMmToPixelLinesImage(this->MmToPixelFanImage[0] * ((double)dimsLines[0] / (double)dimsFan[1]), this->MmToPixelFanImage[1] * ((double)dimsLines[1] / (double)dimsFan[0]), this->MmToPixelFanImage[2] * ((double)dimsLines[2] / (double)dimsFan[2]));
+
+    vtkSmartPointer<vtkImageData> intermediateImage = vtkSmartPointer<vtkImageData>::New();
+    intermediateImage->DeepCopy(linesImage);
+    this->ThresholdViaStdDeviation(intermediateImage);
+    thresholdedImage->DeepCopy(intermediateImage);
+
+    this->GaussianSmooth->SetInputData(intermediateImage);
+    this->EdgeDetector->SetInputConnection(this->GaussianSmooth->GetOutputPort());
+    this->EdgeDetector->Update();
+    this->VectorImageToUchar(this->EdgeDetector->GetOutput());
+    this->ImageBinarizer->SetInputData(this->ConversionImage);
+    this->IslandRemover->SetInputConnection(this->ImageBinarizer->GetOutputPort());
+    this->ImageEroder->SetKernelSize(this->ErosionKernelSize[0], this->ErosionKernelSize[1], 1);
+    this->ImageEroder->SetInputConnection(this->IslandRemover->GetOutputPort());
+    this->ImageDialator->SetKernelSize(this->DilationKernelSize[0], this->DilationKernelSize[1], 1);
+    this->ImageDialator->SetInputConnection(this->ImageEroder->GetOutputPort());
+    this->ImageDialator->Update();
+    vtkSmartPointer<vtkImageData> binaryImage = vtkSmartPointer<vtkImageData>::New();
+    binaryImage->DeepCopy(this->ImageDialator->GetOutput());
+
+    this->MarkShadowOutline(binaryImage);
+    this->RemoveOffCameraBones(binaryImage);
+    this->CompareShadowAreas(linesImage, binaryImage);
+
+    vtkSmartPointer<vtkImageData> processedLinesImage = vtkSmartPointer<vtkImageData>::New();
+    processedLinesImage->DeepCopy(this->GaussianSmooth->GetOutput());
+    this->ImageConjunction(processedLinesImage, binaryImage, processedLinesImage);
+
+    this->ScanConverter->SetInputData(processedLinesImage);
+    this->ScanConverter->Update();
+    outputImage->DeepCopy(this->ScanConverter->GetOutput());
+  }
+
+  /*!
+    Run the fused kernels on the input image and compare each of them with the corresponding VTK filter, using the same input.
+    ProcessFrame has to be called before to allocate the intermediate images. Returns the number of failures.
+  */
+  int CompareFusedKernels(vtkImageData* inputImage, int maxGrayLevelDifference, int frameIndex)
+  {
+    int dims[3] = { 0, 0, 0 };
+    this->LinesImage->GetDimensions(dims);
+
+    this->ComputeGaussianKernel();
+    if (inputImage->GetScalarType() == VTK_UNSIGNED_CHAR && inputImage->GetNumberOfScalarComponents() == 1)
+    {
+      this->FillLinesImageAndThreshold(inputImage, true);
+    }
+    else
+    {
+      this->FillLinesImage(inputImage);
+      memcpy(this->ThresholdedLinesImage->GetScalarPointer(), this->LinesImage->GetScalarPointer(), dims[0] * dims[1] * sizeof(unsigned char));
+      this->ThresholdViaStdDeviation(this->ThresholdedLinesImage);
+      const unsigned char* thresholdedPixels = static_cast<const unsigned char*>(this->ThresholdedLinesImage->GetScalarPointer());
+      for (int y = 0; y < dims[1]; ++y)
+      {
+        this->SmoothRowHorizontally(thresholdedPixels + y * dims[0], &this->HorizontalSmoothingBuffer[y * dims[0]]);
+      }
+    }
+    this->ThresholdedLinesImage->Modified();
+
+    // The edge image is only stored if intermediate results are saved
+    bool saveIntermediateResults = this->SaveIntermediateResults;
+    this->SaveIntermediateResults = true;
+    this->SmoothAndDetectEdges();
+    this->SaveIntermediateResults = saveIntermediateResults;
+
+    int numberOfFailures = 0;
+
+    // Gaussian smoothing, the intermediate values are rounded differently
+    this->GaussianSmooth->SetInputData(this->ThresholdedLinesImage);
+    this->GaussianSmooth->Update();
+    numberOfFailures += CompareImages(this->SmoothedLinesImage, this->GaussianSmooth->GetOutput(), maxGrayLevelDifference, "Fused Gaussian smoothing", frameIndex);
+
+    // Edge detection of the same smoothed image
+    vtkSmartPointer<vtkImageData> fusedEdgeImage = vtkSmartPointer<vtkImageData>::New();
+    fusedEdgeImage->DeepCopy(this->ConversionImage);
+    vtkSmartPointer<vtkImageData> smoothedImage = vtkSmartPointer<vtkImageData>::New();
+    smoothedImage->DeepCopy(this->SmoothedLinesImage);
+    this->EdgeDetector->SetInputData(smoothedImage);
+    this->EdgeDetector->Update();
+    this->VectorImageToUchar(this->EdgeDetector->GetOutput());
+    numberOfFailures += CompareImages(fusedEdgeImage, this->ConversionImage, maxGrayLevelDifference, "Fused edge detection", frameIndex);
+
+    // Binarization of the same edge image
+    this->ImageBinarizer->SetInputData(fusedEdgeImage);
+    this->ImageBinarizer->Update();
+    numberOfFailures += CompareImages(this->BinaryImageForMorphology, this->ImageBinarizer->GetOutput(), 0, "Fused binarization", frameIndex);
+
+    // Island removal, erosion and dilation of the same binary images
+    vtkSmartPointer<vtkImageData> binaryImage = vtkSmartPointer<vtkImageData>::New();
+    binaryImage->DeepCopy(this->BinaryImageForMorphology);
+    this->IslandRemover->SetInputData(binaryImage);
+    this->IslandRemover->Update();
+    this->RemoveIslands(this->BinaryImageForMorphology);
+    numberOfFailures += CompareImages(this->BinaryImageForMorphology, this->IslandRemover->GetOutput(), 0, "Fused island removal", frameIndex);
+
+    vtkSmartPointer<vtkImageData> islandRemovedImage = vtkSmartPointer<vtkImageData>::New();
+    islandRemovedImage->DeepCopy(this->BinaryImageForMorphology);
+    this->ImageEroder->SetKernelSize(this->ErosionKernelSize[0], this->ErosionKernelSize[1], 1);
+    this->ImageEroder->SetInputData(islandRemovedImage);
+    this->ImageEroder->Update();
+    this->ErodeDilate(this->BinaryImageForMorphology, this->ErosionKernelSize, 255, 0);
+    numberOfFailures += CompareImages(this->BinaryImageForMorphology, this->ImageEroder->GetOutput(), 0, "Fused erosion", frameIndex);
+
+    vtkSmartPointer<vtkImageData> erodedImage = vtkSmartPointer<vtkImageData>::New();
+    erodedImage->DeepCopy(this->BinaryImageForMorphology);
+    this->ImageDialator->SetKernelSize(this->DilationKernelSize[0], this->DilationKernelSize[1], 1);
+    this->ImageDialator->SetInputData(erodedImage);
+    this->ImageDialator->Update();
+    this->ErodeDilate(this->BinaryImageForMorphology, this->DilationKernelSize, 0, 255);
+    numberOfFailures += CompareImages(this->BinaryImageForMorphology, this->ImageDialator->GetOutput(), 0, "Fused dilation", frameIndex);
+
+    return numberOfFailures;
+  }
+
+protected:
+  vtkPlusTransverseProcessEnhancerTester() {}
+  virtual ~vtkPlusTransverseProcessEnhancerTester() {}
+};
+
+vtkStandardNewMacro(vtkPlusTransverseProcessEnhancerTester);
+
+//----------------------------------------------------------------------------
+/*!
+  Process all frames with the preallocated pipeline, then with the previous pipeline and compare the results.
+  The frames are processed one after the other as in vtkPlusTrackedFrameProcessor::Update, so that missing updates
+  of the reused intermediate images are detected. Then the fused kernels are compared with the VTK filters.
+  Returns the number of failures.
+*/
+int CompareProcessingPaths(vtkXMLDataElement* configElement, vtkPlusTrackedFrameList* trackedFrameList, int maxGrayLevelDifference)
+{
+  vtkSmartPointer<vtkPlusTransverseProcessEnhancerTester> enhancer = vtkSmartPointer<vtkPlusTransverseProcessEnhancerTester>::New();
+  if (enhancer->ReadConfiguration(configElement) == PLUS_FAIL)
+  {
+    LOG_ERROR("Unable to configure the enhancer for comparing the processing paths");
+    return 1;
+  }
+  enhancer->EnableFusedProcessingOff();
+
+  int numberOfFrames = trackedFrameList->GetNumberOfTrackedFrames();
+  std::vector<vtkSmartPointer<vtkImageData> > linesImages;
+  std::vector<vtkSmartPointer<vtkImageData> > thresholdedImages;
+  std::vector<vtkSmartPointer<vtkImageData> > outputImages;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    PlusTrackedFrame outputFrame;
+    if (enhancer->ProcessFrame(trackedFrameList->GetTrackedFrame(frameIndex), &outputFrame) == PLUS_FAIL)
+    {
+      LOG_ERROR("Processing frame " << frameIndex << " failed");
+      return 1;
+    }
+    linesImages.push_back(vtkSmartPointer<vtkImageData>::New());
+    linesImages.back()->DeepCopy(enhancer->GetLinesImage());
+    thresholdedImages.push_back(vtkSmartPointer<vtkImageData>::New());
+    thresholdedImages.back()->DeepCopy(enhancer->GetThresholdedLinesImage());
+    outputImages.push_back(vtkSmartPointer<vtkImageData>::New());
+    outputImages.back()->DeepCopy(outputFrame.GetImageData()->GetImage());
+  }
+
+  int numberOfFailures = 0;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    vtkSmartPointer<vtkImageData> referenceLinesImage = vtkSmartPointer<vtkImageData>::New();
+    vtkSmartPointer<vtkImageData> referenceThresholdedImage = vtkSmartPointer<vtkImageData>::New();
+    vtkSmartPointer<vtkImageData> referenceOutputImage = vtkSmartPointer<vtkImageData>::New();
+    enhancer->ProcessFrameWithPreviousPipeline(trackedFrameList->GetTrackedFrame(frameIndex), referenceLinesImage, referenceThresholdedImage, referenceOutputImage);
+    numberOfFailures += CompareImages(linesImages[frameIndex], referenceLinesImage, 0, "Lines image", frameIndex);
+    numberOfFailures += CompareImages(thresholdedImages[frameIndex], referenceThresholdedImage, 0, "Thresholded lines image", frameIndex);
+    numberOfFailures += CompareImages(outputImages[frameIndex], referenceOutputImage, 0, "Output image", frameIndex);
+  }
+
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    numberOfFailures += enhancer->CompareFusedKernels(trackedFrameList->GetTrackedFrame(frameIndex)->GetImageData()->GetImage(), maxGrayLevelDifference, frameIndex);
+  }
+
+  return numberOfFailures;
+}
 
 
 //----------------------------------------------------------------------------
@@ -35,6 +302,9 @@ int main(int argc, char** argv)
   std::string outputConfigFileName;
   std::string outputFileName;
   bool saveIntermediateResults = false;
+  bool enableFusedProcessing = false;
+  bool compareProcessingPaths = false;
+  int maxGrayLevelDifference = 1;
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
 
   //Get command line arguments
@@ -45,6 +315,9 @@ int main(int argc, char** argv)
   args.AddArgument("--output-config-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &outputConfigFileName, "Optional filename for output config file. Creates new config file with paramaters used during this test");
   args.AddArgument("--output-seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &outputFileName, "The filename to write the processed sequence to.");
   args.AddArgument("--save-intermediate-images", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &saveIntermediateResults, "If intermediate images should be saved to output files");
+  args.AddArgument("--enable-fused-processing", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &enableFusedProcessing, "Use the fused processing kernels instead of the VTK filters (overrides the config file setting if true)");
+  args.AddArgument("--compare-processing-paths", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &compareProcessingPaths, "Compare the preallocated pipeline with the previous pipeline and the fused kernels with the VTK filters");
+  args.AddArgument("--max-gray-level-difference", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &maxGrayLevelDifference, "Maximum allowed difference between the smoothed and edge images of the fused kernels and the VTK filters (default: 1)");
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
 
   if (!args.Parse())
@@ -143,6 +416,10 @@ int main(int argc, char** argv)
 
   // Process the frames for the input file
   enhancer->SetSaveIntermediateResults(saveIntermediateResults);
+  if (enableFusedProcessing)
+  {
+    enhancer->EnableFusedProcessingOn();
+  }
   LOG_INFO("Processing frames...");
 
   if (enhancer->Update() == PLUS_FAIL)
@@ -208,6 +485,18 @@ int main(int argc, char** argv)
     LOG_INFO("Writing to config file finished successfully.");
   }
 
+  if (compareProcessingPaths)
+  {
+    LOG_INFO("Comparing processing paths...");
+    int numberOfFailures = CompareProcessingPaths(elementToUse, trackedFrameList, maxGrayLevelDifference);
+    if (numberOfFailures > 0)
+    {
+      LOG_ERROR("Comparison of processing paths failed: " << numberOfFailures << " mismatches");
+      return EXIT_FAILURE;
+    }
+    LOG_INFO("Comparison of processing paths finished successfully.");
+  }
+
   LOG_INFO("Completed Test Successfully.");
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,294 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+\file vtkPlusUsScanConvertLookupTableTest.cxx
+\brief Checks scan conversion with precomputed lookup tables
+
+Synthetic scanline images are scan converted with and without lookup table. The lookup table result
+may only differ by the quantization error of the weights. The AVX2 code path has to give exactly the same
+result as the scalar code, and a lookup table that is saved to file and loaded again has to give exactly the same result.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusScanConversionLookupTable.h"
+#include "vtkPlusUsScanConvertCurvilinear.h"
+#include "vtkPlusUsScanConvertLinear.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+#include <string.h>
+
+namespace
+{
+  const int NUMBER_OF_SAMPLES = 512;
+  const int NUMBER_OF_LINES = 128;
+}
+
+//----------------------------------------------------------------------------
+void CreateScanLines(vtkImageData* scanLines, int scalarType)
+{
+  scanLines->SetExtent(0, NUMBER_OF_SAMPLES - 1, 0, NUMBER_OF_LINES - 1, 0, 0);
+  scanLines->AllocateScalars(scalarType, 1);
+  double maxValue = (scalarType == VTK_UNSIGNED_CHAR ? 255.0 : 65535.0);
+  // Deterministic pattern with smooth and sharp intensity changes
+  for (int line = 0; line < NUMBER_OF_LINES; line++)
+  {
+    for (int sample = 0; sample < NUMBER_OF_SAMPLES; sample++)
+    {
+      unsigned int hash = (sample * 7919u + line * 104729u) * 2654435761u;
+      double value = ((sample / 16 + line / 8) % 2 == 0) ? 0.25 * maxValue : 0.75 * maxValue;
+      value += ((hash >> 16) % 64) / 64.0 * 0.25 * maxValue;
+      scanLines->SetScalarComponentFromDouble(sample, line, 0, 0, value);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkXMLDataElement> CreateScanConversionConfig(const char* transducerGeometry, bool useLookupTable, const std::string& lookupTableFilename)
+{
+  vtkSmartPointer<vtkXMLDataElement> config = vtkSmartPointer<vtkXMLDataElement>::New();
+  config->SetName("ScanConversion");
+  config->SetAttribute("TransducerGeometry", transducerGeometry);
+  config->SetAttribute("OutputImageSizePixel", "420 360");
+  config->SetAttribute("OutputImageSpacingMmPerPixel", "0.2 0.2");
+  config->SetAttribute("RadiusStartMm", "10");
+  config->SetAttribute("RadiusStopMm", "70");
+  config->SetAttribute("ThetaStartDeg", "-35");
+  config->SetAttribute("ThetaStopDeg", "35");
+  config->SetAttribute("ImagingDepthMm", "60");
+  config->SetAttribute("TransducerWidthMm", "60");
+  config->SetAttribute("UseLookupTable", useLookupTable ? "TRUE" : "FALSE");
+  if (!lookupTableFilename.empty())
+  {
+    config->SetAttribute("LookupTableFilename", lookupTableFilename.c_str());
+  }
+  return config;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus ScanConvert(const char* transducerGeometry, bool useLookupTable, const std::string& lookupTableFilename, vtkImageData* scanLines, vtkImageData* output)
+{
+  vtkSmartPointer<vtkPlusUsScanConvert> scanConverter;
+  if (STRCASECMP(transducerGeometry, "CURVILINEAR") == 0)
+  {
+    scanConverter = vtkSmartPointer<vtkPlusUsScanConvertCurvilinear>::New();
+  }
+  else
+  {
+    scanConverter = vtkSmartPointer<vtkPlusUsScanConvertLinear>::New();
+  }
+  if (scanConverter->ReadConfiguration(CreateScanConversionConfig(transducerGeometry, useLookupTable, lookupTableFilename)) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to configure scan converter");
+    return PLUS_FAIL;
+  }
+  scanConverter->SetInputData(scanLines);
+  scanConverter->Update();
+  output->DeepCopy(scanConverter->GetOutput());
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+/*! Returns the number of pixels that differ by more than the tolerance */
+int CountDifferentPixels(vtkImageData* image1, vtkImageData* image2, double tolerance)
+{
+  int* extent = image1->GetExtent();
+  int numberOfDifferentPixels = 0;
+  for (int y = extent[2]; y <= extent[3]; y++)
+  {
+    for (int x = extent[0]; x <= extent[1]; x++)
+    {
+      double difference = image1->GetScalarComponentAsDouble(x, y, extent[4], 0) - image2->GetScalarComponentAsDouble(x, y, extent[4], 0);
+      if (fabs(difference) > tolerance)
+      {
+        numberOfDifferentPixels++;
+      }
+    }
+  }
+  return numberOfDifferentPixels;
+}
+
+//----------------------------------------------------------------------------
+bool AreImagesIdentical(vtkImageData* image1, vtkImageData* image2)
+{
+  int* extent1 = image1->GetExtent();
+  int* extent2 = image2->GetExtent();
+  for (int i = 0; i < 6; i++)
+  {
+    if (extent1[i] != extent2[i])
+    {
+      return false;
+    }
+  }
+  if (image1->GetScalarType() != image2->GetScalarType())
+  {
+    return false;
+  }
+  return memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), image1->GetNumberOfPoints() * image1->GetScalarSize()) == 0;
+}
+
+//----------------------------------------------------------------------------
+int TestSimdAndScalarResults(vtkImageData* scanLines)
+{
+  PlusScanConversionLookupTable lookupTable;
+  if (!lookupTable.GetUseSimd())
+  {
+    LOG_INFO("The CPU does not support AVX2, only the scalar code is tested");
+    return 0;
+  }
+
+  // Bilinear entries with random positions, including entries at the end of the input buffer
+  int outputImageSize[2] = { 200, 150 };
+  lookupTable.Initialize(NUMBER_OF_SAMPLES * NUMBER_OF_LINES, outputImageSize, 1, NUMBER_OF_SAMPLES);
+  unsigned int state = 12345;
+  for (int outputPixelIndex = 0; outputPixelIndex < outputImageSize[0] * outputImageSize[1]; outputPixelIndex++)
+  {
+    state = state * 1103515245 + 12345;
+    int sample = (state >> 8) % (NUMBER_OF_SAMPLES - 1);
+    state = state * 1103515245 + 12345;
+    int line = (outputPixelIndex % 50 == 0) ? NUMBER_OF_LINES - 2 : (state >> 8) % (NUMBER_OF_LINES - 1);
+    double sampleFraction = ((state >> 4) % 1000) / 1000.0;
+    double lineFraction = ((state >> 12) % 1000) / 1000.0;
+    double weights[4] = { (1 - sampleFraction) * (1 - lineFraction), sampleFraction * (1 - lineFraction), (1 - sampleFraction) * lineFraction, sampleFraction * lineFraction };
+    lookupTable.AddEntry(sample + line * NUMBER_OF_SAMPLES, outputPixelIndex, weights);
+  }
+  lookupTable.Finalize();
+
+  int numberOfFailures = 0;
+  std::vector<unsigned short> simdOutput(outputImageSize[0] * outputImageSize[1], 0);
+  std::vector<unsigned short> scalarOutput(outputImageSize[0] * outputImageSize[1], 0);
+  for (int firstEntry = 0; firstEntry < 3; firstEntry++)
+  {
+    // Different start positions, to test the processing of the remaining entries
+    lookupTable.SetUseSimd(true);
+    lookupTable.Apply(static_cast<unsigned short*>(scanLines->GetScalarPointer()), &simdOutput[0], firstEntry, lookupTable.GetNumberOfEntries() - 1 - firstEntry);
+    lookupTable.SetUseSimd(false);
+    lookupTable.Apply(static_cast<unsigned short*>(scanLines->GetScalarPointer()), &scalarOutput[0], firstEntry, lookupTable.GetNumberOfEntries() - 1 - firstEntry);
+    if (simdOutput != scalarOutput)
+    {
+      LOG_ERROR("AVX2 and scalar lookup table results differ (first entry: " << firstEntry << ")");
+      numberOfFailures++;
+    }
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp = false;
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = 0;
+  const int scalarTypes[2] = { VTK_UNSIGNED_CHAR, VTK_UNSIGNED_SHORT };
+  const char* transducerGeometries[2] = { "CURVILINEAR", "LINEAR" };
+  for (int scalarTypeIndex = 0; scalarTypeIndex < 2; scalarTypeIndex++)
+  {
+    vtkSmartPointer<vtkImageData> scanLines = vtkSmartPointer<vtkImageData>::New();
+    CreateScanLines(scanLines, scalarTypes[scalarTypeIndex]);
+    double maxValue = (scalarTypes[scalarTypeIndex] == VTK_UNSIGNED_CHAR ? 255.0 : 65535.0);
+
+    for (int geometryIndex = 0; geometryIndex < 2; geometryIndex++)
+    {
+      std::string caseName = std::string(transducerGeometries[geometryIndex]) + "/" + vtkImageScalarTypeNameMacro(scalarTypes[scalarTypeIndex]);
+      vtkSmartPointer<vtkImageData> referenceOutput = vtkSmartPointer<vtkImageData>::New();
+      vtkSmartPointer<vtkImageData> lookupTableOutput = vtkSmartPointer<vtkImageData>::New();
+      if (ScanConvert(transducerGeometries[geometryIndex], false, "", scanLines, referenceOutput) != PLUS_SUCCESS
+          || ScanConvert(transducerGeometries[geometryIndex], true, "", scanLines, lookupTableOutput) != PLUS_SUCCESS)
+      {
+        numberOfFailures++;
+        continue;
+      }
+
+      if (geometryIndex == 0)
+      {
+        // Bilinear interpolation: the error of each quantized weight is at most 2/WEIGHT_ONE
+        double tolerance = 1.0 + floor(maxValue * 8.0 / PlusScanConversionLookupTable::WEIGHT_ONE);
+        int numberOfDifferentPixels = CountDifferentPixels(referenceOutput, lookupTableOutput, tolerance);
+        if (numberOfDifferentPixels > 0)
+        {
+          LOG_ERROR(caseName << ": " << numberOfDifferentPixels << " pixels of the lookup table result differ from the reference by more than " << tolerance);
+          numberOfFailures++;
+        }
+      }
+      else
+      {
+        // Nearest neighbor sampling: the result may only differ at the border of the scanned area, where
+        // the input position is halfway between two pixels
+        int numberOfDifferentPixels = CountDifferentPixels(referenceOutput, lookupTableOutput, 0.0);
+        int* extent = referenceOutput->GetExtent();
+        int maxNumberOfDifferentPixels = 2 * (extent[1] - extent[0] + 1 + extent[3] - extent[2] + 1);
+        if (numberOfDifferentPixels > maxNumberOfDifferentPixels)
+        {
+          LOG_ERROR(caseName << ": " << numberOfDifferentPixels << " pixels of the lookup table result differ from the reference");
+          numberOfFailures++;
+        }
+      }
+
+      // The lookup table is saved to file at the first use and loaded at the second use
+      std::string lookupTableFilename = std::string("vtkPlusUsScanConvertLookupTableTest_") + transducerGeometries[geometryIndex] + ".lut";
+      vtksys::SystemTools::RemoveFile(vtkPlusConfig::GetInstance()->GetOutputPath(lookupTableFilename).c_str());
+      vtkSmartPointer<vtkImageData> savedLookupTableOutput = vtkSmartPointer<vtkImageData>::New();
+      vtkSmartPointer<vtkImageData> loadedLookupTableOutput = vtkSmartPointer<vtkImageData>::New();
+      if (ScanConvert(transducerGeometries[geometryIndex], true, lookupTableFilename, scanLines, savedLookupTableOutput) != PLUS_SUCCESS
+          || ScanConvert(transducerGeometries[geometryIndex], true, lookupTableFilename, scanLines, loadedLookupTableOutput) != PLUS_SUCCESS)
+      {
+        numberOfFailures++;
+        continue;
+      }
+      if (!vtksys::SystemTools::FileExists(vtkPlusConfig::GetInstance()->GetOutputPath(lookupTableFilename).c_str(), true))
+      {
+        LOG_ERROR(caseName << ": lookup table file has not been saved");
+        numberOfFailures++;
+      }
+      if (!AreImagesIdentical(lookupTableOutput, savedLookupTableOutput) || !AreImagesIdentical(lookupTableOutput, loadedLookupTableOutput))
+      {
+        LOG_ERROR(caseName << ": result of the lookup table that is loaded from file is different");
+        numberOfFailures++;
+      }
+      LOG_INFO("Compared " << caseName);
+    }
+
+    if (scalarTypes[scalarTypeIndex] == VTK_UNSIGNED_SHORT)
+    {
+      numberOfFailures += TestSimdAndScalarResults(scanLines);
+    }
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Test failed with " << numberOfFailures << " errors");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@ See License.txt for details.
 #include "PlusTrackedFrame.h"
 #include "vtkImageData.h" 
 #include "vtkPlusRfProcessor.h"
+#include "vtkPlusRfToBrightnessConvert.h"
 #include "vtkPlusSequenceIO.h"
 #include "vtkSmartPointer.h"
 #include "vtkPlusTrackedFrameList.h"
@@ -27,6 +28,7 @@ int main(int argc, char **argv)
   std::string inputConfigFileName;
   std::string outputImgFile;
   std::string operation="BRIGHTNESS_SCAN_CONVERT";
+  std::string envelopeDetectionMethod;
   bool useCompression(true);
 
   int verboseLevel=vtkPlusLogger::LOG_LEVEL_UNDEFINED;
@@ -40,6 +42,7 @@ int main(int argc, char **argv)
   args.AddArgument("--output-img-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &outputImgFile, "File name of the generated output brightness image");
   args.AddArgument("--use-compression", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &useCompression, "Use compression when outputting data");
   args.AddArgument("--operation", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &operation, "Processing operation to be applied on the input file (BRIGHTNESS_CONVERT, BRIGHTNESS_SCAN_CONVERT, default: BRIGHTNESS_SCAN_CONVERT");
+  args.AddArgument("--envelope-detection-method", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &envelopeDetectionMethod, "Method of computing the Hilbert transform of RF_REAL data (HILBERT_FIR, HILBERT_FFT). Overrides the value in the configuration file.");
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
 
 
@@ -138,6 +141,23 @@ int main(int argc, char **argv)
       LOG_ERROR("Failed to read conversion parameters from the configuration file"); 
       exit(EXIT_FAILURE); 
     }
+    if (!envelopeDetectionMethod.empty())
+    {
+      vtkPlusRfToBrightnessConvert* brightnessConverter = rfProcessor->GetRfToBrightnessConverter();
+      if (STRCASECMP(envelopeDetectionMethod.c_str(), vtkPlusRfToBrightnessConvert::GetEnvelopeDetectionMethodAsString(vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FIR))==0)
+      {
+        brightnessConverter->SetEnvelopeDetectionMethod(vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FIR);
+      }
+      else if (STRCASECMP(envelopeDetectionMethod.c_str(), vtkPlusRfToBrightnessConvert::GetEnvelopeDetectionMethodAsString(vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FFT))==0)
+      {
+        brightnessConverter->SetEnvelopeDetectionMethod(vtkPlusRfToBrightnessConvert::ENVELOPE_DETECTION_HILBERT_FFT);
+      }
+      else
+      {
+        LOG_ERROR("Unknown envelope detection method: "<<envelopeDetectionMethod);
+        exit(EXIT_FAILURE);
+      }
+    }
 
     // Process the frames
     for (unsigned int j = 0; j < frameList->GetNumberOfTrackedFrames(); j++)
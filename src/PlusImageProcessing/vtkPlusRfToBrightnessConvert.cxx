@@ -7,6 +7,7 @@ See License.txt for details.
 #include "PlusConfigure.h"
 
 #include "vtkPlusRfToBrightnessConvert.h"
+#include "PlusHilbertTransformFft.h"
 
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -28,6 +29,7 @@ vtkPlusRfToBrightnessConvert::vtkPlusRfToBrightnessConvert()
   this->ImageType=US_IMG_TYPE_XX;
   this->BrightnessScale=10.0;
   this->NumberOfHilbertFilterCoeffs=64;
+  this->EnvelopeDetectionMethod=ENVELOPE_DETECTION_HILBERT_FIR;
 }
 
 //----------------------------------------------------------------------------
@@ -239,6 +241,48 @@ void vtkPlusRfToBrightnessConvert::ThreadedRequestData(
       outPtr += outInc2;    
     }
   }
+  else if (this->ImageType==US_IMG_RF_REAL && this->EnvelopeDetectionMethod==ENVELOPE_DETECTION_HILBERT_FFT)
+  {
+    // e.g., Ultrasonix
+    // RF data: IIIII..., IIIII...
+    // Hilbert transform of two scanlines is computed by one FFT
+    PlusHilbertTransformFft hilbertTransform;
+    hilbertTransform.Initialize(numberOfRfSamplesInScanline);
+    std::vector<double> hilbertTransformLines(2*numberOfRfSamplesInScanline);
+    vtkIdType inLineIncrement = numberOfRfSamplesInScanline+inInc1;
+    vtkIdType outLineIncrement = numberOfBmodeSamplesInScanline+outInc1;
+    for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
+    {
+      for (int idx1 = outExt[2]; !this->AbortExecute && idx1 <= outExt[3]; idx1+=2)
+      {
+        if (id==0)
+        {
+          // it is the first thread, report progress
+          if (!(count%target))
+          {
+            this->UpdateProgress(count/(50.0*target));
+          }
+          count++;
+        }
+
+        bool twoLines = (idx1 < outExt[3]);
+        short* secondLinePtr = twoLines ? inPtr+inLineIncrement : NULL;
+        double* secondLineHilbertTransform = twoLines ? &hilbertTransformLines[numberOfRfSamplesInScanline] : NULL;
+        hilbertTransform.ComputeHilbertTransform(inPtr, secondLinePtr, &hilbertTransformLines[0], secondLineHilbertTransform);
+        ComputeAmplitudeILineHilbertLine(outPtr, inPtr, &hilbertTransformLines[0], numberOfRfSamplesInScanline);
+        inPtr += inLineIncrement;
+        outPtr += outLineIncrement;
+        if (twoLines)
+        {
+          ComputeAmplitudeILineHilbertLine(outPtr, secondLinePtr, secondLineHilbertTransform, numberOfRfSamplesInScanline);
+          inPtr += inLineIncrement;
+          outPtr += outLineIncrement;
+        }
+      }
+      inPtr += inInc2;
+      outPtr += outInc2;
+    }
+  }
   else for (int idx2 = outExt[4]; idx2 <= outExt[5]; ++idx2)
   {
     for (int idx1 = outExt[2]; !this->AbortExecute && idx1 <= outExt[3]; ++idx1)    
@@ -308,6 +352,22 @@ void vtkPlusRfToBrightnessConvert::ThreadedRequestData(
 void vtkPlusRfToBrightnessConvert::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "EnvelopeDetectionMethod: " << GetEnvelopeDetectionMethodAsString(this->EnvelopeDetectionMethod) << "\n";
+}
+
+//-----------------------------------------------------------------------------
+const char* vtkPlusRfToBrightnessConvert::GetEnvelopeDetectionMethodAsString(EnvelopeDetectionMethodType method)
+{
+  switch (method)
+  {
+  case ENVELOPE_DETECTION_HILBERT_FIR:
+    return "HILBERT_FIR";
+  case ENVELOPE_DETECTION_HILBERT_FFT:
+    return "HILBERT_FFT";
+  default:
+    LOG_ERROR("Unknown envelope detection method: " << method);
+    return "unknown";
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -317,6 +377,9 @@ PlusStatus vtkPlusRfToBrightnessConvert::ReadConfiguration(vtkXMLDataElement* rf
   XML_VERIFY_ELEMENT(rfToBrightnessElement, "RfToBrightnessConversion");
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfHilbertFilterCoeffs, rfToBrightnessElement);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, BrightnessScale, rfToBrightnessElement);
+  XML_READ_ENUM2_ATTRIBUTE_OPTIONAL(EnvelopeDetectionMethod, rfToBrightnessElement,
+    GetEnvelopeDetectionMethodAsString(ENVELOPE_DETECTION_HILBERT_FIR), ENVELOPE_DETECTION_HILBERT_FIR,
+    GetEnvelopeDetectionMethodAsString(ENVELOPE_DETECTION_HILBERT_FFT), ENVELOPE_DETECTION_HILBERT_FFT);
   return PLUS_SUCCESS;
 }
 
@@ -329,6 +392,7 @@ PlusStatus vtkPlusRfToBrightnessConvert::WriteConfiguration(vtkXMLDataElement* r
 
   rfToBrightnessElement->SetDoubleAttribute("NumberOfHilbertFilterCoeffs", this->NumberOfHilbertFilterCoeffs);
   rfToBrightnessElement->SetDoubleAttribute("BrightnessScale", this->BrightnessScale);
+  rfToBrightnessElement->SetAttribute("EnvelopeDetectionMethod", GetEnvelopeDetectionMethodAsString(this->EnvelopeDetectionMethod));
 
   return PLUS_SUCCESS;
 }
@@ -440,6 +504,19 @@ void vtkPlusRfToBrightnessConvert::ComputeAmplitudeILineQLine(unsigned char *amp
   }
 }
 
+void vtkPlusRfToBrightnessConvert::ComputeAmplitudeILineHilbertLine(unsigned char *ampl, const short *inputSignal, const double *inputSignalHilbertTransformed, int npt)
+{
+  for (int i=0; i<npt; i++)
+  {
+    double xt = inputSignal[i];
+    double xht = inputSignalHilbertTransformed[i];
+    double brightnessValue = sqrt(sqrt(sqrt(xt*xt+xht*xht)))*this->BrightnessScale;
+    if (brightnessValue>MAX_BRIGHTNESS_VALUE) brightnessValue=MAX_BRIGHTNESS_VALUE;
+    if (brightnessValue<MIN_BRIGHTNESS_VALUE) brightnessValue=MIN_BRIGHTNESS_VALUE;
+    ampl[i]=brightnessValue;
+  }
+}
+
 void vtkPlusRfToBrightnessConvert::ComputeAmplitudeIqLine(unsigned char *ampl, short *inputSignal, const int npt)
 {
   int inputIndex=0;
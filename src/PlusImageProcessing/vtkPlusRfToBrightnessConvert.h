@@ -23,6 +23,13 @@ the Euclidean norm of the RF signal (in-phase, I) and a 90deg phase shifted vers
 RF signal (quadrature, Q). The Q signal may be provided by the acquisition system or can be
 computed from the I signal by a Hilbert transform.
 
+The Hilbert transform of RF_REAL data can be computed by two methods (EnvelopeDetectionMethod):
+- HILBERT_FIR: convolution with a truncated Hilbert filter of NumberOfHilbertFilterCoeffs coefficients.
+  Samples that are closer to the start or end of the scanline than half of the filter length are set to 0.
+- HILBERT_FFT: exact Hilbert transform computed in the frequency domain (see PlusHilbertTransformFft).
+  Two scanlines are processed by one FFT and all samples of the scanline are computed. Much faster than the FIR
+  filter if many filter coefficients are used.
+
 Dynamic range compression converts the 16-bit input signal to 8-bit by a non-linear function.
 In this filter the compressedSignal=sqrt(sqrt(envelopeDetected))*BrightnessScale function is used.
 A log function is also frequently used for dynamic range compression. The sqrt(sqrt(.)) function was
@@ -37,6 +44,12 @@ is always VTK_UNSIGNED_CHAR (unsigned 8-bit).
 class vtkPlusImageProcessingExport vtkPlusRfToBrightnessConvert : public vtkThreadedImageAlgorithm
 {
 public:
+  enum EnvelopeDetectionMethodType
+  {
+    ENVELOPE_DETECTION_HILBERT_FIR,
+    ENVELOPE_DETECTION_HILBERT_FFT
+  };
+
   static vtkPlusRfToBrightnessConvert *New();
   vtkTypeMacro(vtkPlusRfToBrightnessConvert,vtkThreadedImageAlgorithm);
   virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
@@ -57,6 +70,13 @@ public:
   vtkSetMacro(BrightnessScale, double);
   vtkGetMacro(BrightnessScale, double);
 
+  /*! Method of computing the Hilbert transform for envelope detection of RF_REAL data */
+  vtkSetMacro(EnvelopeDetectionMethod, EnvelopeDetectionMethodType);
+  vtkGetMacro(EnvelopeDetectionMethod, EnvelopeDetectionMethodType);
+
+  /*! Get the name of the envelope detection method, as it is used in the configuration file */
+  static const char* GetEnvelopeDetectionMethodAsString(EnvelopeDetectionMethodType method);
+
 protected:
   vtkPlusRfToBrightnessConvert();
   ~vtkPlusRfToBrightnessConvert();
@@ -79,6 +99,9 @@ protected:
   
   /*! Compute amplitude from the original and Hilbert transformed RF data. npt is the number of samples in the input signal */
   virtual void ComputeAmplitudeILineQLine(unsigned char *ampl, short *inputSignal, short *inputSignalHilbertTransformed, int npt);
+
+  /*! Compute amplitude of all samples from the original and the FFT Hilbert transformed RF data. npt is the number of samples in the input signal */
+  virtual void ComputeAmplitudeILineHilbertLine(unsigned char *ampl, const short *inputSignal, const double *inputSignalHilbertTransformed, int npt);
   
   /*! Compute amplitude from IQ encoded RF data. npt is the number of IQ pairs * 2. */
   virtual void ComputeAmplitudeIqLine(unsigned char *ampl, short *inputSignal, const int npt);
@@ -92,6 +115,9 @@ protected:
   /*! Coefficients of the Hilbert transform, computed from the NumberOfHilbertFilterCoeffs */
   std::vector<double> HilbertTransformCoeffs;
 
+  /*! Method of computing the Hilbert transform of RF_REAL data */
+  EnvelopeDetectionMethodType EnvelopeDetectionMethod;
+
   /*! Image type (RF_IQ_LINE, RF_I_LINE_Q_LINE, ...) */
   US_IMAGE_TYPE ImageType;
 
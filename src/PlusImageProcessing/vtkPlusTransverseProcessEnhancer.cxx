@@ -26,12 +26,42 @@ See License.txt for details.
 
 #include "vtkImageAlgorithm.h"
 
+#include <algorithm>
 #include <cmath>
-
+#include <string.h>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkPlusTransverseProcessEnhancer);
 
+// Number of scanlines that are smoothed together before edge detection in the fused processing
+static const int EDGE_DETECTION_TILE_SIZE = 8;
+
+//----------------------------------------------------------------------------
+namespace
+{
+  /*! Compute the reciprocal of the sum of the kernel weights that fall inside [0, numberOfPixels-1] for each pixel */
+  void ComputeGaussianNormalization(const std::vector<float>& kernel, int numberOfPixels, std::vector<float>& normalization)
+  {
+    int radius = static_cast<int>(kernel.size()) - 1;
+    normalization.resize(numberOfPixels);
+    for (int i = 0; i < numberOfPixels; i++)
+    {
+      double sum = 0;
+      for (int j = std::max(-radius, -i); j <= std::min(radius, numberOfPixels - 1 - i); j++)
+      {
+        sum += kernel[j < 0 ? -j : j];
+      }
+      normalization[i] = static_cast<float>(1.0 / sum);
+    }
+  }
+
+  /*! Convert a Sobel gradient component to unsigned char the same way as VectorImageToUchar (negative values wrap around) */
+  inline unsigned char GradientToUchar(int sobelSum)
+  {
+    return static_cast<unsigned char>(static_cast<int>(sobelSum * 0.125f));
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkPlusTransverseProcessEnhancer::vtkPlusTransverseProcessEnhancer()
   : ScanConverter(NULL),
@@ -55,10 +85,13 @@ vtkPlusTransverseProcessEnhancer::vtkPlusTransverseProcessEnhancer()
   IslandAreaThreshold(-1),
   BoneOutlineDepthPx(3), //Note: this only changes the apperance/thickness of the 3D model. Different numbers do not change what is or isnt marked as bone.
   BonePushBackPx(9),     //Horisontal distance between where a shadow is located, and where the bone begins
+  EnableFusedProcessing(false),
 
   LinesImage(NULL),
+  ThresholdedLinesImage(NULL),
+  SmoothedLinesImage(NULL),
   ProcessedLinesImage(NULL),
-  UnprocessedLinesImage(NULL),
+  MorphologyBufferImage(NULL),
   FirstFrame(true)
 {
   this->SetMmToPixelFanImage(0, 0, 0);
@@ -102,12 +135,21 @@ vtkPlusTransverseProcessEnhancer::vtkPlusTransverseProcessEnhancer()
   this->ImageDialator->SetDilateValue(255);
 
   this->LinesImage = vtkSmartPointer<vtkImageData>::New();
+  this->ThresholdedLinesImage = vtkSmartPointer<vtkImageData>::New();
+  this->SmoothedLinesImage = vtkSmartPointer<vtkImageData>::New();
   this->ProcessedLinesImage = vtkSmartPointer<vtkImageData>::New();
-  this->UnprocessedLinesImage = vtkSmartPointer<vtkImageData>::New();
+  this->MorphologyBufferImage = vtkSmartPointer<vtkImageData>::New();
 
   this->LinesImage->SetExtent(0, 0, 0, 0, 0, 0);
+  this->ThresholdedLinesImage->SetExtent(0, 0, 0, 0, 0, 0);
+  this->SmoothedLinesImage->SetExtent(0, 0, 0, 0, 0, 0);
   this->ProcessedLinesImage->SetExtent(0, 0, 0, 0, 0, 0);
-  this->UnprocessedLinesImage->SetExtent(0, 0, 0, 0, 0, 0);
+  this->MorphologyBufferImage->SetExtent(0, 0, 0, 0, 0, 0);
+
+  for (int i = 0; i < 6; i++)
+  {
+    this->ScanLineSampleIndicesInputExtent[i] = 0;
+  }
 
   this->IntermediateImageMap.clear();
 }
@@ -124,6 +166,7 @@ vtkPlusTransverseProcessEnhancer::~vtkPlusTransverseProcessEnhancer()
 void vtkPlusTransverseProcessEnhancer::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "EnableFusedProcessing: " << (this->EnableFusedProcessing ? "true" : "false") << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -233,6 +276,7 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ReadConfiguration(vtkSmartPointer<v
   //Read tags relavent to scan lines
   XML_READ_SCALAR_ATTRIBUTE_REQUIRED(int, NumberOfScanLines, processingElement);
   XML_READ_SCALAR_ATTRIBUTE_REQUIRED(int, NumberOfSamplesPerScanLine, processingElement);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableFusedProcessing, processingElement);
 
   int rfImageExtent[6] = { 0, this->NumberOfSamplesPerScanLine - 1, 0, this->NumberOfScanLines - 1, 0, 0 };
   this->ScanConverter->SetInputImageExtent(rfImageExtent);
@@ -250,6 +294,7 @@ PlusStatus vtkPlusTransverseProcessEnhancer::WriteConfiguration(vtkSmartPointer<
   processingElement->SetAttribute("Type", this->GetProcessorTypeName());
   processingElement->SetIntAttribute("NumberOfScanLines", NumberOfScanLines);
   processingElement->SetIntAttribute("NumberOfSamplesPerScanLine", NumberOfSamplesPerScanLine);
+  processingElement->SetAttribute("EnableFusedProcessing", this->EnableFusedProcessing ? "TRUE" : "FALSE");
 
   XML_FIND_NESTED_ELEMENT_CREATE_IF_MISSING(scanConversionElement, processingElement, "ScanConversion");
   this->ScanConverter->WriteConfiguration(scanConversionElement);
@@ -294,9 +339,35 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ProcessImageExtents()
   this->LinesImage->SetExtent(linesImageExtent);
   this->LinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
 
+  // Intermediate images are allocated once and reused for all frames
+  this->ThresholdedLinesImage->SetExtent(linesImageExtent);
+  this->ThresholdedLinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  this->SmoothedLinesImage->SetExtent(linesImageExtent);
+  this->SmoothedLinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  this->ProcessedLinesImage->SetExtent(linesImageExtent);
+  this->ProcessedLinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  this->MorphologyBufferImage->SetExtent(linesImageExtent);
+  this->MorphologyBufferImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  this->ConversionImage->SetExtent(linesImageExtent);
+  this->ConversionImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
   //Set up variables related to image extents
   int dims[3] = { 0, 0, 0 };
   this->LinesImage->GetDimensions(dims);
+  int numberOfPixels = dims[0] * dims[1];
+
+  this->HorizontalSmoothingBuffer.resize(numberOfPixels);
+  this->VerticalSmoothingBuffer.resize(dims[0]);
+  this->MorphologyPrefixCounts.resize((dims[0] + 1) * dims[1]);
+  this->IslandPixelIndices.resize(numberOfPixels);
+  this->IslandVisited.resize(numberOfPixels);
+
+  // There is at most one bone area per scanline
+  this->BoneAreasInfo.reserve(dims[1] + 1);
+  this->CandidateBoneAreas.reserve(dims[1] + 1);
+
+  // Sample indices are computed for the first input image
+  this->ScanLineSampleIndices.clear();
 
   return PLUS_SUCCESS;
 }
@@ -354,6 +425,87 @@ void vtkPlusTransverseProcessEnhancer::FillLinesImage(vtkSmartPointer<vtkImageDa
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::ComputeScanLineSampleIndices(vtkImageData* inputImageData)
+{
+  int* linesImageExtent = this->ScanConverter->GetInputImageExtent();
+  int lineLengthPx = linesImageExtent[1] - linesImageExtent[0] + 1;
+  int numScanLines = linesImageExtent[3] - linesImageExtent[2] + 1;
+
+  int* inputExtent = inputImageData->GetExtent();
+  vtkIdType* inputIncrements = inputImageData->GetIncrements();
+  for (int i = 0; i < 6; i++)
+  {
+    this->ScanLineSampleIndicesInputExtent[i] = inputExtent[i];
+  }
+
+  this->ScanLineSampleIndices.resize(lineLengthPx * numScanLines);
+  vtkIdType* sampleIndex = &this->ScanLineSampleIndices[0];
+
+  // Use the same arithmetic as FillLinesImage to get exactly the same sample positions
+  for (int scanLine = 0; scanLine < numScanLines; ++scanLine)
+  {
+    double start[4] = { 0, 0, 0, 0 };
+    double end[4] = { 0, 0, 0, 0 };
+    ScanConverter->GetScanLineEndPoints(scanLine, start, end);
+
+    double directionVectorX = static_cast<double>(end[0] - start[0]) / (lineLengthPx - 1);
+    double directionVectorY = static_cast<double>(end[1] - start[1]) / (lineLengthPx - 1);
+    for (int pointIndex = 0; pointIndex < lineLengthPx; ++pointIndex, ++sampleIndex)
+    {
+      int pixelCoordX = start[0] + directionVectorX * pointIndex;
+      int pixelCoordY = start[1] + directionVectorY * pointIndex;
+      if (pixelCoordX < inputExtent[0] || pixelCoordX > inputExtent[1]
+        || pixelCoordY < inputExtent[2] || pixelCoordY > inputExtent[3])
+      {
+        *sampleIndex = -1; // outside of the specified extent
+        continue;
+      }
+      *sampleIndex = (pixelCoordX - inputExtent[0]) * inputIncrements[0]
+        + (pixelCoordY - inputExtent[2]) * inputIncrements[1]
+        + (0 - inputExtent[4]) * inputIncrements[2];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Fills the lines image and the thresholded lines image by subsampling the input image along scanlines.
+// Each scanline is thresholded (and optionally smoothed horizontally) while it is still in the cache.
+void vtkPlusTransverseProcessEnhancer::FillLinesImageAndThreshold(vtkImageData* inputImageData, bool horizontalSmoothing)
+{
+  int* inputExtent = inputImageData->GetExtent();
+  if (this->ScanLineSampleIndices.empty()
+    || !std::equal(inputExtent, inputExtent + 6, this->ScanLineSampleIndicesInputExtent))
+  {
+    this->ComputeScanLineSampleIndices(inputImageData);
+  }
+
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);
+
+  const unsigned char* inputPixels = static_cast<const unsigned char*>(inputImageData->GetScalarPointer());
+  unsigned char* linesPixels = static_cast<unsigned char*>(this->LinesImage->GetScalarPointer());
+  unsigned char* thresholdedPixels = static_cast<unsigned char*>(this->ThresholdedLinesImage->GetScalarPointer());
+  const vtkIdType* sampleIndices = &this->ScanLineSampleIndices[0];
+
+  for (int y = dims[1] - 1; y >= 0; --y)
+  {
+    int rowOffset = y * dims[0];
+    for (int x = 0; x < dims[0]; ++x)
+    {
+      vtkIdType sampleIndex = sampleIndices[rowOffset + x];
+      unsigned char value = (sampleIndex < 0 ? 0 : inputPixels[sampleIndex]);
+      linesPixels[rowOffset + x] = value;
+      thresholdedPixels[rowOffset + x] = value;
+    }
+    this->ThresholdRowViaStdDeviation(thresholdedPixels + rowOffset, dims[0]);
+    if (horizontalSmoothing)
+    {
+      this->SmoothRowHorizontally(thresholdedPixels + rowOffset, &this->HorizontalSmoothingBuffer[rowOffset]);
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkPlusTransverseProcessEnhancer::VectorImageToUchar(vtkSmartPointer<vtkImageData> inputImage)
 {
@@ -365,8 +517,6 @@ void vtkPlusTransverseProcessEnhancer::VectorImageToUchar(vtkSmartPointer<vtkIma
 
   int dims[3] = { 0, 0, 0 };
   this->LinesImage->GetDimensions(dims);
-  this->ConversionImage->SetExtent(this->LinesImage->GetExtent());
-  this->ConversionImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
   for (int y = dims[1] - 1; y >= 0; --y)
   {
     // Initialize variables for a new scan line.
@@ -381,6 +531,8 @@ void vtkPlusTransverseProcessEnhancer::VectorImageToUchar(vtkSmartPointer<vtkIma
       *vOutput = (unsigned char)std::max(0, std::min(255, (int)output));
     }
   }
+  // The image is reused for all frames, so the binarizer would not update without this
+  this->ConversionImage->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -396,11 +548,12 @@ void vtkPlusTransverseProcessEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImag
   int keepInfoCounter;
   bool foundBone;
   unsigned char* vOutput;
+  unsigned char* rowPixels;
 
   int lastVistedValue = 0;
 
   //Setup variables for recording bone areas
-  std::map<std::string, int> currentBoneArea;
+  BoneArea currentBoneArea;
   int boneAreaStart = dims[1] - 1;  //The y coordinate of where the bone outline starts
   int boneDepthSum = 0;             //The sum of the x coordinates of each pixel in the bone outline
   int boneMaxDepth = dims[0] - 1;   //The x coordinate of the right-most pixel in the bone outline
@@ -413,10 +566,11 @@ void vtkPlusTransverseProcessEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImag
     //When an image is detected, keep up to this many pixles after it
     keepInfoCounter = this->BoneOutlineDepthPx + this->BonePushBackPx;
     foundBone = false;
+    rowPixels = static_cast<unsigned char*>(inputImage->GetScalarPointer(0, y, 0));
 
     for (int x = dims[0] - 1; x >= 0; --x)
     {
-      vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(x, y, 0));
+      vOutput = rowPixels + x;
 
       //If an image is detected
       if (*vOutput != 0)
@@ -440,13 +594,12 @@ void vtkPlusTransverseProcessEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImag
               if (boneDepthSum != 0)
               {
                 //Save info related to where the bone area
-                currentBoneArea["depth"] = boneDepthSum / (boneAreaStart - y);                  // Store the outline's average x-coordinate
-                currentBoneArea["xMax"] = boneMaxDepth;                                         // Store the outline's maximum x-coordinate (Used for efficiency)
-                currentBoneArea["xMin"] = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0); // Store the outline's minimum x-coordinate (Used for efficiency)
-                currentBoneArea["yMax"] = boneAreaStart;                                        // Store the outline's maximum y-coordinate
-                currentBoneArea["yMin"] = y + 1;                                                // Store the outline's minimum y-coordinate
+                currentBoneArea.Depth = boneDepthSum / (boneAreaStart - y);
+                currentBoneArea.XMax = boneMaxDepth;
+                currentBoneArea.XMin = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0);
+                currentBoneArea.YMax = boneAreaStart;
+                currentBoneArea.YMin = y + 1;
                 this->BoneAreasInfo.push_back(currentBoneArea);
-                currentBoneArea.clear();
               }
               boneAreaStart = y;
               boneDepthSum = 0;
@@ -487,14 +640,13 @@ void vtkPlusTransverseProcessEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImag
       if (boneDepthSum != 0)
       {
         //Save info related to where the bone area
-        currentBoneArea["depth"] = boneDepthSum / (boneAreaStart - y);                  // Store the outline's average x-coordinate
-        currentBoneArea["xMax"] = boneMaxDepth;                                         // Store the outline's maximum x-coordinate (Used for efficiency)
-        currentBoneArea["xMin"] = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0); // Store the outline's minimum x-coordinate (Used for efficiency)
-        currentBoneArea["yMax"] = boneAreaStart;                                        // Store the outline's maximum y-coordinate
-        currentBoneArea["yMin"] = y + 1;                                                // Store the outline's minimum y-coordinate
+        currentBoneArea.Depth = boneDepthSum / (boneAreaStart - y);
+        currentBoneArea.XMax = boneMaxDepth;
+        currentBoneArea.XMin = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0);
+        currentBoneArea.YMax = boneAreaStart;
+        currentBoneArea.YMin = y + 1;
         this->BoneAreasInfo.push_back(currentBoneArea);
         boneDepthSum = 0;
-        currentBoneArea.clear();
       }
       boneMaxDepth = dims[0] - 1;
       boneMinDepth = 0;
@@ -507,13 +659,12 @@ void vtkPlusTransverseProcessEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImag
   if (boneDepthSum != 0)
   {
     //Save info related to where the bone area
-    currentBoneArea["depth"] = boneDepthSum / (boneAreaStart + 1);                  // Store the outline's average x-coordinate
-    currentBoneArea["xMax"] = boneMaxDepth;                                         // Store the outline's maximum x-coordinate (Used for efficiency)
-    currentBoneArea["xMin"] = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0); // Store the outline's minimum x-coordinate (Used for efficiency)
-    currentBoneArea["yMax"] = boneAreaStart;                                        // Store the outline's maximum y-coordinate
-    currentBoneArea["yMin"] = 0;                                                    // Store the outline's minimum y-coordinate
+    currentBoneArea.Depth = boneDepthSum / (boneAreaStart + 1);
+    currentBoneArea.XMax = boneMaxDepth;
+    currentBoneArea.XMin = std::max(boneMinDepth - this->BoneOutlineDepthPx, 0);
+    currentBoneArea.YMax = boneAreaStart;
+    currentBoneArea.YMin = 0;
     this->BoneAreasInfo.push_back(currentBoneArea);
-    currentBoneArea.clear();
   }
 }
 
@@ -528,42 +679,44 @@ void vtkPlusTransverseProcessEnhancer::RemoveOffCameraBones(vtkSmartPointer<vtkI
   inputImage->GetDimensions(dims);
 
   unsigned char* vOutput = 0;
+  unsigned char* rowPixels = 0;
 
   int distanceVerticalBuffer = 10;    //For a bone to be valid, it must be this distance from the transducer
   int distanceHorizontalBuffer = 20;  //For a bone to be valid, it must be this distance from thehorizontal sides of the frame
   int boneMinSize = 10;               //Minimum bone size a bone must have to be valid
-  std::vector<std::map<std::string, int>> boneAreas = this->BoneAreasInfo;
+
+  // Check the areas found so far, valid areas are put back into BoneAreasInfo
+  this->CandidateBoneAreas.swap(this->BoneAreasInfo);
+  this->BoneAreasInfo.clear();
 
   int boneHalfLen;
   bool clearArea;
   bool foundBone;
 
-  this->BoneAreasInfo.clear();
-
-  for (int areaIndex = boneAreas.size() - 1; areaIndex >= 0; --areaIndex)
+  for (int areaIndex = this->CandidateBoneAreas.size() - 1; areaIndex >= 0; --areaIndex)
   {
-    std::map<std::string, int> currentArea = boneAreas.at(areaIndex);
+    const BoneArea& currentArea = this->CandidateBoneAreas[areaIndex];
 
     clearArea = false;
-    boneHalfLen = ((currentArea["yMax"] - currentArea["yMin"]) + 1)  / 2;
+    boneHalfLen = ((currentArea.YMax - currentArea.YMin) + 1)  / 2;
 
     //check if the bone is to close too the scan's edge
-    if (currentArea["yMax"] + distanceVerticalBuffer >= dims[1] - 1 || currentArea["yMin"] - distanceVerticalBuffer <= 0)
+    if (currentArea.YMax + distanceVerticalBuffer >= dims[1] - 1 || currentArea.YMin - distanceVerticalBuffer <= 0)
     {
       clearArea = true;
     }
     //check if given the size, the bone is too close to the scan's edge
-    else if (boneHalfLen + currentArea["yMax"] >= dims[1] - 1 || (currentArea["yMin"] - 1) - boneHalfLen <= 0)
+    else if (boneHalfLen + currentArea.YMax >= dims[1] - 1 || (currentArea.YMin - 1) - boneHalfLen <= 0)
     {
       clearArea = true;
     }
     //check if the bone is too close/far from the transducer 
-    else if (currentArea["depth"] < distanceHorizontalBuffer || currentArea["depth"] > dims[0] - distanceHorizontalBuffer)
+    else if (currentArea.Depth < distanceHorizontalBuffer || currentArea.Depth > dims[0] - distanceHorizontalBuffer)
     {
       clearArea = true;
     }
     //check if the bone is to small
-    else if (currentArea["yMax"] - currentArea["yMin"] <= boneMinSize)
+    else if (currentArea.YMax - currentArea.YMin <= boneMinSize)
     {
       clearArea = true;
     }
@@ -572,21 +725,21 @@ void vtkPlusTransverseProcessEnhancer::RemoveOffCameraBones(vtkSmartPointer<vtkI
     if (clearArea == true)
     {
       //search through the area where the pixels are known to be
-      for (int y = currentArea["yMax"]; y >= currentArea["yMin"]; --y)
+      for (int y = currentArea.YMax; y >= currentArea.YMin; --y)
       {
-        int x = currentArea["xMax"] - this->BonePushBackPx;
+        rowPixels = static_cast<unsigned char*>(inputImage->GetScalarPointer(0, y, 0));
+        int x = currentArea.XMax - this->BonePushBackPx;
         foundBone = false;
-        while (x >= currentArea["xMin"] - this->BonePushBackPx && x >= 0 && foundBone == false)
+        while (x >= currentArea.XMin - this->BonePushBackPx && x >= 0 && foundBone == false)
         {
-          vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(x, y, 0));
+          vOutput = rowPixels + x;
           if (*vOutput != 0)
           {
             //remove all pixels in the outline
             *vOutput = 0;
             for (int removeBonex = std::max(0, x - (this->BoneOutlineDepthPx - 1)); removeBonex < x; ++removeBonex)
             {
-              vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(removeBonex, y, 0));
-              *vOutput = 0;
+              rowPixels[removeBonex] = 0;
             }
 
             foundBone = true;
@@ -600,6 +753,7 @@ void vtkPlusTransverseProcessEnhancer::RemoveOffCameraBones(vtkSmartPointer<vtkI
       this->BoneAreasInfo.push_back(currentArea);
     }
   }
+  this->CandidateBoneAreas.clear();
 }
 
 //----------------------------------------------------------------------------
@@ -614,8 +768,9 @@ void vtkPlusTransverseProcessEnhancer::CompareShadowAreas(vtkSmartPointer<vtkIma
   int dims[3] = { 0, 0, 0 };
   inputImage->GetDimensions(dims);
 
-  float vInput = 0;
+  const unsigned char* originalRowPixels = 0;
   unsigned char* vOutput = 0;
+  unsigned char* rowPixels = 0;
 
   //Variables used for measuring the size and intensity sum for bone, above, and below areas
   int boneLen;
@@ -629,49 +784,49 @@ void vtkPlusTransverseProcessEnhancer::CompareShadowAreas(vtkSmartPointer<vtkIma
   float areaAvgShadow;  //Shadow intensity of the area
   float belowAvgShadow; //Shadow intensity of the below area
 
-  std::map<std::string, int> currentArea;
-  std::vector<std::map<std::string, int>> boneAreas = this->BoneAreasInfo;
+  // Check the areas found so far, valid areas are put back into BoneAreasInfo
+  this->CandidateBoneAreas.swap(this->BoneAreasInfo);
+  this->BoneAreasInfo.clear();
 
   bool foundBone;
-  this->BoneAreasInfo.clear();
 
-  for (int areaIndex = boneAreas.size() - 1; areaIndex >= 0; --areaIndex)
+  for (int areaIndex = this->CandidateBoneAreas.size() - 1; areaIndex >= 0; --areaIndex)
   {
-    currentArea = boneAreas.at(areaIndex);
+    const BoneArea& currentArea = this->CandidateBoneAreas[areaIndex];
 
     aboveSum = 0;
     areaSum = 0;
     belowSum = 0;
 
-    boneLen = (currentArea["yMax"] - currentArea["yMin"]) + 1;
+    boneLen = (currentArea.YMax - currentArea.YMin) + 1;
     boneHalfLen = boneLen / 2;
-    boneArea = boneLen * currentArea["depth"];
+    boneArea = boneLen * currentArea.Depth;
 
     //gather sum of shadow areas from above the area
-    for (int y = currentArea["yMax"] + boneHalfLen; y > currentArea["yMax"]; --y)
+    for (int y = currentArea.YMax + boneHalfLen; y > currentArea.YMax; --y)
     {
-      for (int x = dims[0] - 1; x >= currentArea["depth"]; --x)
+      originalRowPixels = static_cast<const unsigned char*>(originalImage->GetScalarPointer(0, y, 0));
+      for (int x = dims[0] - 1; x >= currentArea.Depth; --x)
       {
-        vInput = (originalImage->GetScalarComponentAsFloat(x, y, 0, 0));
-        aboveSum += vInput;
+        aboveSum += originalRowPixels[x];
       }
     }
     //gather sum of shadow areas from the area
-    for (int y = currentArea["yMax"]; y >= currentArea["yMin"]; --y)
+    for (int y = currentArea.YMax; y >= currentArea.YMin; --y)
     {
-      for (int x = dims[0] - 1; x >= currentArea["depth"]; --x)
+      originalRowPixels = static_cast<const unsigned char*>(originalImage->GetScalarPointer(0, y, 0));
+      for (int x = dims[0] - 1; x >= currentArea.Depth; --x)
       {
-        vInput = (originalImage->GetScalarComponentAsFloat(x, y, 0, 0));
-        areaSum += vInput;
+        areaSum += originalRowPixels[x];
       }
     }
     //gather sum of shadow areas from below the area
-    for (int y = currentArea["yMin"] - boneHalfLen; y < currentArea["yMin"]; ++y)
+    for (int y = currentArea.YMin - boneHalfLen; y < currentArea.YMin; ++y)
     {
-      for (int x = dims[0] - 1; x >= currentArea["depth"]; --x)
+      originalRowPixels = static_cast<const unsigned char*>(originalImage->GetScalarPointer(0, y, 0));
+      for (int x = dims[0] - 1; x >= currentArea.Depth; --x)
       {
-        vInput = (originalImage->GetScalarComponentAsFloat(x, y, 0, 0));
-        belowSum += vInput;
+        belowSum += originalRowPixels[x];
       }
     }
 
@@ -684,14 +839,15 @@ void vtkPlusTransverseProcessEnhancer::CompareShadowAreas(vtkSmartPointer<vtkIma
     if (aboveAvgShadow - areaAvgShadow <= areaAvgShadow / 2 || belowAvgShadow - areaAvgShadow <= areaAvgShadow / 2)
     {
 
-      for (int y = currentArea["yMax"]; y >= currentArea["yMin"]; --y)
+      for (int y = currentArea.YMax; y >= currentArea.YMin; --y)
       {
         //search through the area where the pixels are known to be
-        int x = currentArea["xMax"] - this->BonePushBackPx;
+        rowPixels = static_cast<unsigned char*>(inputImage->GetScalarPointer(0, y, 0));
+        int x = currentArea.XMax - this->BonePushBackPx;
         foundBone = false;
-        while (x >= currentArea["xMin"] - this->BonePushBackPx && x >= 0 && foundBone == false)
+        while (x >= currentArea.XMin - this->BonePushBackPx && x >= 0 && foundBone == false)
         {
-          vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(x, y, 0));
+          vOutput = rowPixels + x;
           if (*vOutput != 0)
           {
             //remove all pixels in the outline
@@ -699,8 +855,7 @@ void vtkPlusTransverseProcessEnhancer::CompareShadowAreas(vtkSmartPointer<vtkIma
 
             for (int removeBonex = std::max(0, x - (this->BoneOutlineDepthPx - 1)); removeBonex < x; ++removeBonex)
             {
-              vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(removeBonex, y, 0));
-              *vOutput = 0;
+              rowPixels[removeBonex] = 0;
             }
             foundBone = true;
           }
@@ -713,105 +868,377 @@ void vtkPlusTransverseProcessEnhancer::CompareShadowAreas(vtkSmartPointer<vtkIma
       this->BoneAreasInfo.push_back(currentArea);
     }
   }
+  this->CandidateBoneAreas.clear();
 }
 
 //----------------------------------------------------------------------------
 //a way of threasholding based on the standard deviation of a row
 void vtkPlusTransverseProcessEnhancer::ThresholdViaStdDeviation(vtkSmartPointer<vtkImageData> inputImage)
+{
+  int dims[3] = { 0, 0, 0 };
+  inputImage->GetDimensions(dims);
+
+  for (int y = dims[1] - 1; y >= 0; --y)
+  {
+    this->ThresholdRowViaStdDeviation(static_cast<unsigned char*>(inputImage->GetScalarPointer(0, y, 0)), dims[0]);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::ThresholdRowViaStdDeviation(unsigned char* row, int rowLength)
 {
   int fatLayerToCut = 20; //The area of fat too close to the transducer should not be considered
 
   float vInput = 0;
   unsigned char* vOutput = 0;
 
-  int dims[3] = { 0, 0, 0 };
-  inputImage->GetDimensions(dims);
-
-  int max;
+  int max = 0;
 
   //values used to calculate the standard deviation
-  int pixelSum;
-  int squearSum;
-  float pixelAverage;
+  int pixelSum = 0;
+  int squearSum = 0;
+  float pixelAverage = 0;
   float meanDiffSum;
   float meanDiffAverage;
   float thresholdValue;
 
-  for (int y = dims[1] - 1; y >= 0; --y)
+  //determine the average, sum, and max of the row
+  for (int x = rowLength - 1; x >= fatLayerToCut; --x)
   {
-    max = 0;
+    vInput = row[x];
+    pixelSum += vInput;
+    squearSum += vInput * vInput;
 
-    pixelSum = 0;
-    squearSum = 0;
-    pixelAverage = 0;
-
-    //determine the average, sum, and max of the row
-    for (int x = dims[0] - 1; x >= fatLayerToCut; --x)
+    if (vInput > max)
     {
-      vInput = inputImage->GetScalarComponentAsFloat(x, y, 0, 0);
-      pixelSum += vInput;
-      squearSum += vInput * vInput;
+      max = vInput;
+    }
+  }
+  pixelAverage = pixelSum / (rowLength - fatLayerToCut);
+
+  //determine the standard deviation of the row
+  meanDiffSum = squearSum + (rowLength - fatLayerToCut) * pixelAverage * pixelAverage + (-2 * pixelAverage * pixelSum);
+  meanDiffAverage = meanDiffSum / (rowLength - fatLayerToCut);
+  thresholdValue = max - 3 * pow(meanDiffAverage, 0.5f);
 
-      if (vInput > max)
+  //if a pixel's value is too low, remove it
+  if (pixelSum != 0)
+  {
+    for (int x = rowLength - 1; x >= 0; --x)
+    {
+      vOutput = row + x;
+      if (*vOutput < thresholdValue && *vOutput != 0)
       {
-        max = vInput;
+        *vOutput = 0;
       }
     }
-    pixelAverage = pixelSum / (dims[0] - fatLayerToCut);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::ComputeGaussianKernel()
+{
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);
+
+  // Same kernel radius as vtkImageGaussianSmooth
+  int radius = static_cast<int>(this->GaussianStdDev * this->GaussianKernelSize);
+  if (this->GaussianStdDev <= 0 || radius < 0)
+  {
+    radius = 0;
+  }
+
+  this->GaussianKernel.resize(radius + 1);
+  this->GaussianKernel[0] = 1.0f;
+  for (int i = 1; i <= radius; i++)
+  {
+    this->GaussianKernel[i] = static_cast<float>(exp(-(i * i) / (2.0 * this->GaussianStdDev * this->GaussianStdDev)));
+  }
+
+  // Near the image boundary the kernel is truncated and renormalized
+  ComputeGaussianNormalization(this->GaussianKernel, dims[0], this->GaussianNormalizationX);
+  ComputeGaussianNormalization(this->GaussianKernel, dims[1], this->GaussianNormalizationY);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::SmoothRowHorizontally(const unsigned char* row, float* smoothedRow)
+{
+  int rowLength = static_cast<int>(this->GaussianNormalizationX.size());
+  int radius = static_cast<int>(this->GaussianKernel.size()) - 1;
+
+  float weight = this->GaussianKernel[0];
+  for (int x = 0; x < rowLength; ++x)
+  {
+    smoothedRow[x] = weight * row[x];
+  }
+  for (int j = 1; j <= radius && j < rowLength; ++j)
+  {
+    weight = this->GaussianKernel[j];
+    for (int x = j; x < rowLength; ++x)
+    {
+      smoothedRow[x] += weight * row[x - j];
+    }
+    for (int x = 0; x < rowLength - j; ++x)
+    {
+      smoothedRow[x] += weight * row[x + j];
+    }
+  }
+  for (int x = 0; x < rowLength; ++x)
+  {
+    smoothedRow[x] *= this->GaussianNormalizationX[x];
+  }
+}
 
-    //determine the standard deviation of the row
-    meanDiffSum = squearSum + (dims[0] - fatLayerToCut) * pixelAverage * pixelAverage + (-2 * pixelAverage * pixelSum);
-    meanDiffAverage = meanDiffSum / (dims[0] - fatLayerToCut);
-    thresholdValue = max - 3 * pow(meanDiffAverage, 0.5f);
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::SmoothAndDetectEdges()
+{
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);
+  int radius = static_cast<int>(this->GaussianKernel.size()) - 1;
 
+  const float* horizontalPixels = &this->HorizontalSmoothingBuffer[0];
+  float* verticalPixels = &this->VerticalSmoothingBuffer[0];
+  unsigned char* smoothedPixels = static_cast<unsigned char*>(this->SmoothedLinesImage->GetScalarPointer());
+  unsigned char* binaryPixels = static_cast<unsigned char*>(this->BinaryImageForMorphology->GetScalarPointer());
+  unsigned char* edgePixels = static_cast<unsigned char*>(this->ConversionImage->GetScalarPointer());
 
-    //if a pixel's value is too low, remove it
-    if (pixelSum != 0)
+  int nextEdgeRow = 0;
+  for (int tileStart = 0; tileStart < dims[1]; tileStart += EDGE_DETECTION_TILE_SIZE)
+  {
+    int tileEnd = std::min(tileStart + EDGE_DETECTION_TILE_SIZE, dims[1]);
+
+    // Vertical smoothing of the scanlines of the tile
+    for (int y = tileStart; y < tileEnd; ++y)
     {
-      for (int x = dims[0] - 1; x >= 0; --x)
+      const float* centerRow = horizontalPixels + y * dims[0];
+      float weight = this->GaussianKernel[0];
+      for (int x = 0; x < dims[0]; ++x)
+      {
+        verticalPixels[x] = weight * centerRow[x];
+      }
+      for (int j = 1; j <= radius; ++j)
       {
-        vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(x, y, 0));
-        if (*vOutput < thresholdValue && *vOutput != 0)
+        weight = this->GaussianKernel[j];
+        if (y - j >= 0)
         {
-          *vOutput = 0;
+          const float* neighborRow = centerRow - j * dims[0];
+          for (int x = 0; x < dims[0]; ++x)
+          {
+            verticalPixels[x] += weight * neighborRow[x];
+          }
         }
+        if (y + j < dims[1])
+        {
+          const float* neighborRow = centerRow + j * dims[0];
+          for (int x = 0; x < dims[0]; ++x)
+          {
+            verticalPixels[x] += weight * neighborRow[x];
+          }
+        }
+      }
+      float normalization = this->GaussianNormalizationY[y];
+      unsigned char* smoothedRow = smoothedPixels + y * dims[0];
+      for (int x = 0; x < dims[0]; ++x)
+      {
+        smoothedRow[x] = static_cast<unsigned char>(std::min(255, static_cast<int>(verticalPixels[x] * normalization)));
       }
     }
+
+    // Edge detection needs the next scanline as well, so it lags one scanline behind the smoothing
+    int edgeRowEnd = (tileEnd == dims[1] ? dims[1] : tileEnd - 1);
+    for (int y = nextEdgeRow; y < edgeRowEnd; ++y)
+    {
+      // Pixels outside of the image are replaced by the nearest pixel, as in vtkImageSobel2D
+      const unsigned char* centerRow = smoothedPixels + y * dims[0];
+      const unsigned char* previousRow = (y > 0 ? centerRow - dims[0] : centerRow);
+      const unsigned char* nextRow = (y < dims[1] - 1 ? centerRow + dims[0] : centerRow);
+      unsigned char* binaryRow = binaryPixels + y * dims[0];
+      unsigned char* edgeRow = edgePixels + y * dims[0];
+      for (int x = 0; x < dims[0]; ++x)
+      {
+        int xm = (x > 0 ? x - 1 : x);
+        int xp = (x < dims[0] - 1 ? x + 1 : x);
+        unsigned char gradientX = GradientToUchar(2 * (centerRow[xp] - centerRow[xm])
+          + previousRow[xp] - previousRow[xm] + nextRow[xp] - nextRow[xm]);
+        unsigned char gradientY = GradientToUchar(2 * (nextRow[x] - previousRow[x])
+          + nextRow[xp] - previousRow[xp] + nextRow[xm] - previousRow[xm]);
+
+        // Same approximation of the gradient magnitude as in VectorImageToUchar
+        float output = (float)(gradientX + gradientY) / (float)2;
+        unsigned char edge = (unsigned char)std::max(0, std::min(255, (int)output));
+        binaryRow[x] = (edge >= 55 ? 255 : 0);
+        if (this->SaveIntermediateResults)
+        {
+          edgeRow[x] = edge;
+        }
+      }
+    }
+    nextEdgeRow = edgeRowEnd;
   }
 }
 
 //----------------------------------------------------------------------------
-// If a pixel in MaskImage is > 0, the corresponding pixel in InputImage will remain unchanged, otherwise it will be set to 0
-void vtkPlusTransverseProcessEnhancer::ImageConjunction(vtkSmartPointer<vtkImageData> InputImage, vtkSmartPointer<vtkImageData> MaskImage)
+void vtkPlusTransverseProcessEnhancer::RemoveIslands(vtkImageData* binaryImage)
 {
-  // Images must be of the same dimension, an should already be, I should check this though
-  unsigned char* inputPixelPointer = 0;
+  if (this->IslandAreaThreshold <= 0)
+  {
+    // Same as vtkImageIslandRemoval2D with zero area threshold: nothing to remove
+    return;
+  }
 
   int dims[3] = { 0, 0, 0 };
-  this->LinesImage->GetDimensions(dims);      // This will be the same as InputImage, as long as InputImage is converted to linesImage previously
+  binaryImage->GetDimensions(dims);
+  int numberOfPixels = dims[0] * dims[1];
 
-  for (int y = dims[1] - 1; y >= 0; --y)
+  unsigned char* pixels = static_cast<unsigned char*>(binaryImage->GetScalarPointer());
+  unsigned char* visited = &this->IslandVisited[0];
+  int* islandPixels = &this->IslandPixelIndices[0];
+  memset(visited, 0, numberOfPixels);
+
+  for (int seedIndex = 0; seedIndex < numberOfPixels; ++seedIndex)
   {
-    // Initialize variables for a new scan line.
+    if (pixels[seedIndex] != 255 || visited[seedIndex])
+    {
+      continue;
+    }
 
-    for (int x = dims[0] - 1; x >= 0; --x)   // Go towards transducer
+    // Collect all pixels of the island (8-connected neighborhood, as vtkImageIslandRemoval2D with SquareNeighborhood)
+    int islandSize = 0;
+    islandPixels[islandSize++] = seedIndex;
+    visited[seedIndex] = 1;
+    for (int queueIndex = 0; queueIndex < islandSize; ++queueIndex)
+    {
+      int pixelIndex = islandPixels[queueIndex];
+      int x = pixelIndex % dims[0];
+      int y = pixelIndex / dims[0];
+      for (int ny = std::max(0, y - 1); ny <= std::min(dims[1] - 1, y + 1); ++ny)
+      {
+        for (int nx = std::max(0, x - 1); nx <= std::min(dims[0] - 1, x + 1); ++nx)
+        {
+          int neighborIndex = ny * dims[0] + nx;
+          if (pixels[neighborIndex] == 255 && !visited[neighborIndex])
+          {
+            visited[neighborIndex] = 1;
+            islandPixels[islandSize++] = neighborIndex;
+          }
+        }
+      }
+    }
+
+    if (islandSize < this->IslandAreaThreshold)
+    {
+      for (int i = 0; i < islandSize; ++i)
+      {
+        pixels[islandPixels[i]] = 0;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTransverseProcessEnhancer::ErodeDilate(vtkImageData* binaryImage, const int kernelSize[2], unsigned char erodeValue, unsigned char dilateValue)
+{
+  int dims[3] = { 0, 0, 0 };
+  binaryImage->GetDimensions(dims);
+
+  // Ellipse shaped kernel, same as in vtkImageDilateErode3D. Each kernel row is stored as a range of x offsets.
+  int kernelMiddle[2] = { kernelSize[0] / 2, kernelSize[1] / 2 };
+  double kernelCenter[2] = { (kernelSize[0] - 1) * 0.5, (kernelSize[1] - 1) * 0.5 };
+  double kernelRadius[2] = { kernelSize[0] * 0.5, kernelSize[1] * 0.5 };
+  this->MorphologyKernelRanges.resize(2 * kernelSize[1]);
+  for (int ky = 0; ky < kernelSize[1]; ++ky)
+  {
+    int dxMin = kernelSize[0];
+    int dxMax = -kernelSize[0];
+    for (int kx = 0; kx < kernelSize[0]; ++kx)
+    {
+      double tx = (kx - kernelCenter[0]) / kernelRadius[0];
+      double ty = (ky - kernelCenter[1]) / kernelRadius[1];
+      if (tx * tx + ty * ty <= 1.0)
+      {
+        dxMin = std::min(dxMin, kx - kernelMiddle[0]);
+        dxMax = std::max(dxMax, kx - kernelMiddle[0]);
+      }
+    }
+    this->MorphologyKernelRanges[2 * ky] = dxMin;
+    this->MorphologyKernelRanges[2 * ky + 1] = dxMax;
+  }
+
+  // Count the dilate value pixels in each row so that any kernel row can be checked in constant time
+  unsigned char* pixels = static_cast<unsigned char*>(binaryImage->GetScalarPointer());
+  int* prefixCounts = &this->MorphologyPrefixCounts[0];
+  for (int y = 0; y < dims[1]; ++y)
+  {
+    const unsigned char* row = pixels + y * dims[0];
+    int* rowCounts = prefixCounts + y * (dims[0] + 1);
+    rowCounts[0] = 0;
+    for (int x = 0; x < dims[0]; ++x)
+    {
+      rowCounts[x + 1] = rowCounts[x] + (row[x] == dilateValue ? 1 : 0);
+    }
+  }
+
+  unsigned char* outputPixels = static_cast<unsigned char*>(this->MorphologyBufferImage->GetScalarPointer());
+  for (int y = 0; y < dims[1]; ++y)
+  {
+    const unsigned char* row = pixels + y * dims[0];
+    unsigned char* outputRow = outputPixels + y * dims[0];
+    for (int x = 0; x < dims[0]; ++x)
     {
-      if (static_cast<unsigned char>(MaskImage->GetScalarComponentAsFloat(x, y, 0, 0)) > 0)
+      outputRow[x] = row[x];
+      if (row[x] != erodeValue)
       {
-        //do nothing
+        continue;
       }
-      else
+      for (int ky = 0; ky < kernelSize[1]; ++ky)
       {
-        inputPixelPointer = static_cast<unsigned char*>(InputImage->GetScalarPointer(x, y, 0));
-        *inputPixelPointer = 0;
+        int ny = y + ky - kernelMiddle[1];
+        int dxMin = this->MorphologyKernelRanges[2 * ky];
+        int dxMax = this->MorphologyKernelRanges[2 * ky + 1];
+        if (ny < 0 || ny >= dims[1] || dxMin > dxMax)
+        {
+          continue;
+        }
+        int nxMin = std::max(0, x + dxMin);
+        int nxMax = std::min(dims[0] - 1, x + dxMax);
+        const int* rowCounts = prefixCounts + ny * (dims[0] + 1);
+        if (nxMin <= nxMax && rowCounts[nxMax + 1] - rowCounts[nxMin] > 0)
+        {
+          outputRow[x] = dilateValue;
+          break;
+        }
       }
     }
   }
+
+  memcpy(pixels, outputPixels, dims[0] * dims[1] * sizeof(unsigned char));
+}
+
+//----------------------------------------------------------------------------
+// If a pixel in MaskImage is > 0, the corresponding pixel in InputImage is copied to OutputImage, otherwise it will be set to 0
+void vtkPlusTransverseProcessEnhancer::ImageConjunction(vtkImageData* inputImage, vtkImageData* maskImage, vtkImageData* outputImage)
+{
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);      // This will be the same as InputImage, as long as InputImage is converted to linesImage previously
+  int numberOfPixels = dims[0] * dims[1];
+
+  const unsigned char* inputPixels = static_cast<const unsigned char*>(inputImage->GetScalarPointer());
+  const unsigned char* maskPixels = static_cast<const unsigned char*>(maskImage->GetScalarPointer());
+  unsigned char* outputPixels = static_cast<unsigned char*>(outputImage->GetScalarPointer());
+  for (int i = 0; i < numberOfPixels; ++i)
+  {
+    outputPixels[i] = (maskPixels[i] > 0 ? inputPixels[i] : 0);
+  }
+  outputImage->Modified();
 }
 
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTransverseProcessEnhancer::ProcessFrame(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame)
 {
+  if (this->ScanConverter.GetPointer() == NULL)
+  {
+    return PLUS_FAIL;
+  }
 
   if (this->FirstFrame == true)
   {
@@ -825,14 +1252,6 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ProcessFrame(PlusTrackedFrame* inpu
   this->BoneAreasInfo.clear();
 
   PlusVideoFrame* inputImage = inputFrame->GetImageData();
-  //an image used to transport output between filters
-  vtkSmartPointer<vtkImageData> intermediateImage = vtkSmartPointer<vtkImageData>::New();
-
-  if (this->ScanConverter.GetPointer() == NULL)
-  {
-    return PLUS_FAIL;
-  }
-
 
   //Convert the image to a readable non-fan image
   this->ScanConverter->SetInputData(inputImage->GetImage());
@@ -841,12 +1260,36 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ProcessFrame(PlusTrackedFrame* inpu
   {
     this->AddIntermediateFromFilter("_01Lines_1PreFillLines", this->ScanConverter);
   }
-  this->FillLinesImage(inputImage->GetImage());
+
+  // The input image is sampled along the scanlines and thresholded in a single pass if the pixel type allows it
+  bool fastPath = (inputImage->GetImage()->GetScalarType() == VTK_UNSIGNED_CHAR
+    && inputImage->GetImage()->GetNumberOfScalarComponents() == 1);
+  bool smoothedWhileFilling = false;
+  if (fastPath)
+  {
+    if (this->EnableFusedProcessing)
+    {
+      this->ComputeGaussianKernel();
+      smoothedWhileFilling = true;
+    }
+    this->FillLinesImageAndThreshold(inputImage->GetImage(), smoothedWhileFilling);
+  }
+  else
+  {
+    this->FillLinesImage(inputImage->GetImage());
+    int dims[3] = { 0, 0, 0 };
+    this->LinesImage->GetDimensions(dims);
+    memcpy(this->ThresholdedLinesImage->GetScalarPointer(), this->LinesImage->GetScalarPointer(), dims[0] * dims[1] * sizeof(unsigned char));
+    //Threashold the image based on the standard deviation of a pixel's columns
+    this->ThresholdViaStdDeviation(this->ThresholdedLinesImage);
+  }
+  // The preallocated images are filled in place, they must be marked as modified for the VTK filters that use them as input
+  this->LinesImage->Modified();
+  this->ThresholdedLinesImage->Modified();
   if (this->SaveIntermediateResults)
   {
     this->AddIntermediateImage("_01Lines_2FilterEnd", this->LinesImage);
   }
-  intermediateImage->DeepCopy(this->LinesImage);
 
   int dimsFan[3] = { 0, 0, 0 };
   inputImage->GetImage()->GetDimensions(dimsFan);
@@ -855,65 +1298,107 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ProcessFrame(PlusTrackedFrame* inpu
 
   this->SetMmToPixelLinesImage(this->MmToPixelFanImage[0] * ((double)dimsLines[0] / (double)dimsFan[1]), this->MmToPixelFanImage[1] * ((double)dimsLines[1] / (double)dimsFan[0]), this->MmToPixelFanImage[2] * ((double)dimsLines[2] / (double)dimsFan[2]));
 
-
-  //Save this image so that it can be used for comparason with the output image
-  vtkSmartPointer<vtkImageData> originalImage = vtkSmartPointer<vtkImageData>::New();
-  originalImage->DeepCopy(intermediateImage);
-
-  //Threashold the image based on the standard deviation of a pixel's columns
-  this->ThresholdViaStdDeviation(intermediateImage);
   if (this->SaveIntermediateResults)
   {
-    this->AddIntermediateImage("_02Threshold_1FilterEnd", intermediateImage);
+    this->AddIntermediateImage("_02Threshold_1FilterEnd", this->ThresholdedLinesImage);
   }
 
-  //Use gaussian smoothing
-  this->GaussianSmooth->SetInputData(intermediateImage);
-  if (this->SaveIntermediateResults)
+  // Smoothed lines image, used for reconverting the binary image to greyscale
+  vtkImageData* smoothedImage = NULL;
+  if (this->EnableFusedProcessing)
   {
-    this->AddIntermediateFromFilter("_03Gaussian_1FilterEnd", this->GaussianSmooth);
-  }
+    if (!smoothedWhileFilling)
+    {
+      this->ComputeGaussianKernel();
+      const unsigned char* thresholdedPixels = static_cast<const unsigned char*>(this->ThresholdedLinesImage->GetScalarPointer());
+      for (int y = 0; y < dimsLines[1]; ++y)
+      {
+        this->SmoothRowHorizontally(thresholdedPixels + y * dimsLines[0], &this->HorizontalSmoothingBuffer[y * dimsLines[0]]);
+      }
+    }
 
-  //Edge detection
-  this->EdgeDetector->SetInputConnection(this->GaussianSmooth->GetOutputPort());
-  this->EdgeDetector->Update();
-  this->VectorImageToUchar(this->EdgeDetector->GetOutput());
-  if (this->SaveIntermediateResults)
-  {
-    this->AddIntermediateImage("_04EdgeDetector_1FilterEnd", this->ConversionImage);
-  }
+    // Smoothing, edge detection and binarization
+    this->SmoothAndDetectEdges();
+    smoothedImage = this->SmoothedLinesImage;
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_03Gaussian_1FilterEnd", this->SmoothedLinesImage);
+      this->AddIntermediateImage("_04EdgeDetector_1FilterEnd", this->ConversionImage);
+      this->AddIntermediateImage("_05BinaryImageForMorphology_1FilterEnd", this->BinaryImageForMorphology);
+    }
 
-  // Since we perform morphological operations, we must binarize the image
-  this->ImageBinarizer->SetInputData(this->ConversionImage);
-  if (this->SaveIntermediateResults)
-  {
-    this->AddIntermediateFromFilter("_05BinaryImageForMorphology_1FilterEnd", this->ImageBinarizer);
-  }
+    //Remove small clusters of pixels
+    this->RemoveIslands(this->BinaryImageForMorphology);
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_06Island_1FilterEnd", this->BinaryImageForMorphology);
+    }
 
-  //Remove small clusters of pixels
-  this->IslandRemover->SetInputConnection(this->ImageBinarizer->GetOutputPort());
-  this->IslandRemover->Update();
-  if (this->SaveIntermediateResults)
-  {
-    this->AddIntermediateImage("_06Island_1FilterEnd", this->IslandRemover->GetOutput());
-  }
+    //Erode the image
+    this->ErodeDilate(this->BinaryImageForMorphology, this->ErosionKernelSize, 255, 0);
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_07Erosion_1FilterEnd", this->BinaryImageForMorphology);
+    }
 
-  //Erode the image
-  this->ImageEroder->SetKernelSize(this->ErosionKernelSize[0], this->ErosionKernelSize[1], 1);
-  this->ImageEroder->SetInputConnection(this->IslandRemover->GetOutputPort());
-  if (this->SaveIntermediateResults)
-  {
-    this->AddIntermediateFromFilter("_07Erosion_1FilterEnd", this->ImageEroder);
+    //Dilate the image
+    this->ErodeDilate(this->BinaryImageForMorphology, this->DilationKernelSize, 0, 255);
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_08Dilation_1FilterEnd", this->BinaryImageForMorphology);
+    }
   }
-
-  //Dilate the image
-  this->ImageDialator->SetKernelSize(this->DilationKernelSize[0], this->DilationKernelSize[1], 1);
-  this->ImageDialator->SetInputConnection(this->ImageEroder->GetOutputPort());
-  this->ImageDialator->Update();
-  this->BinaryImageForMorphology->DeepCopy(this->ImageDialator->GetOutput());
-  if (this->SaveIntermediateResults)
+  else
   {
-    this->AddIntermediateImage("_08Dilation_1FilterEnd", this->BinaryImageForMorphology);
+    //Use gaussian smoothing
+    this->GaussianSmooth->SetInputData(this->ThresholdedLinesImage);
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateFromFilter("_03Gaussian_1FilterEnd", this->GaussianSmooth);
+    }
+
+    //Edge detection
+    this->EdgeDetector->SetInputConnection(this->GaussianSmooth->GetOutputPort());
+    this->EdgeDetector->Update();
+    this->VectorImageToUchar(this->EdgeDetector->GetOutput());
+    smoothedImage = this->GaussianSmooth->GetOutput();
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_04EdgeDetector_1FilterEnd", this->ConversionImage);
+    }
+
+    // Since we perform morphological operations, we must binarize the image
+    this->ImageBinarizer->SetInputData(this->ConversionImage);
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateFromFilter("_05BinaryImageForMorphology_1FilterEnd", this->ImageBinarizer);
+    }
+
+    //Remove small clusters of pixels
+    this->IslandRemover->SetInputConnection(this->ImageBinarizer->GetOutputPort());
+    this->IslandRemover->Update();
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_06Island_1FilterEnd", this->IslandRemover->GetOutput());
+    }
+
+    //Erode the image
+    this->ImageEroder->SetKernelSize(this->ErosionKernelSize[0], this->ErosionKernelSize[1], 1);
+    this->ImageEroder->SetInputConnection(this->IslandRemover->GetOutputPort());
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateFromFilter("_07Erosion_1FilterEnd", this->ImageEroder);
+    }
+
+    //Dilate the image
+    this->ImageDialator->SetKernelSize(this->DilationKernelSize[0], this->DilationKernelSize[1], 1);
+    this->ImageDialator->SetInputConnection(this->ImageEroder->GetOutputPort());
+    this->ImageDialator->Update();
+    this->BinaryImageForMorphology->DeepCopy(this->ImageDialator->GetOutput());
+    if (this->SaveIntermediateResults)
+    {
+      this->AddIntermediateImage("_08Dilation_1FilterEnd", this->BinaryImageForMorphology);
+    }
   }
 
   //Detect each possible bone area, then subject it to various tests to confirm if it is valid
@@ -927,36 +1412,26 @@ PlusStatus vtkPlusTransverseProcessEnhancer::ProcessFrame(PlusTrackedFrame* inpu
   {
     this->AddIntermediateImage("_09PostFilters_2PostRemoveOffCamera", this->BinaryImageForMorphology);
   }
-  this->CompareShadowAreas(originalImage, this->BinaryImageForMorphology);
+  // The lines image is not modified by the processing, so it can be used for comparison with the output image
+  this->CompareShadowAreas(this->LinesImage, this->BinaryImageForMorphology);
   if (this->SaveIntermediateResults)
   {
     this->AddIntermediateImage("_09PostFilters_3PostCompareShadowAreas", this->BinaryImageForMorphology);
   }
 
   //Reconvert the image to greyscale
-  // Currently, inputImage is the output of the edge detector, not original pixels
-  this->UnprocessedLinesImage->DeepCopy(this->GaussianSmooth->GetOutput());
-  this->ImageConjunction(this->UnprocessedLinesImage, this->BinaryImageForMorphology);
+  this->ImageConjunction(smoothedImage, this->BinaryImageForMorphology, this->ProcessedLinesImage);
   if (this->SaveIntermediateResults)
   {
-    this->AddIntermediateImage("_10ReconvertBinaryToGreyscale_1FilterEnd", this->UnprocessedLinesImage);
+    this->AddIntermediateImage("_10ReconvertBinaryToGreyscale_1FilterEnd", this->ProcessedLinesImage);
   }
-  intermediateImage->DeepCopy(this->UnprocessedLinesImage);
-
-  //Setup so that the image can be converted into a fan-image
-  this->ProcessedLinesImage->DeepCopy(intermediateImage);
-  PlusVideoFrame processedVideoFrame;
-  processedVideoFrame.DeepCopyFrom(this->ProcessedLinesImage);
-  PlusTrackedFrame* processedTrackedFrame = inputFrame;
-  processedTrackedFrame->SetImageData(processedVideoFrame);
 
-  //Setup so that the image can be converted into a fan-image
+  //Convert the processed lines image into a fan-image
   PlusVideoFrame* outputImage = outputFrame->GetImageData();
   this->ScanConverter->SetInputData(this->ProcessedLinesImage);
-  this->ScanConverter->SetOutput(intermediateImage);
   this->ScanConverter->Update();
 
-  outputImage->DeepCopyFrom(intermediateImage);
+  outputImage->DeepCopyFrom(this->ScanConverter->GetOutput());
 
   return PLUS_SUCCESS;
 }
@@ -31,6 +31,20 @@ class vtkPlusUsScanConvert;
 /*!
 \class vtkPlusTransverseProcessEnhancer
 \brief Improves bone surface visibility in ultrasound images
+
+All intermediate images and buffers are allocated when the first frame is processed (and when the image size changes),
+and then reused for all subsequent frames.
+
+Sampling of the input image along the scanlines and thresholding by standard deviation are performed in a single pass
+over each scanline, using a precomputed table of the input pixel index of each lines image pixel.
+
+If EnableFusedProcessing is enabled then the smoothing, edge detection, binarization, island removal, erosion and dilation
+are computed by fused kernels instead of the VTK filters: the horizontal Gaussian smoothing is computed together with the
+scanline sampling, then vertical smoothing, Sobel edge detection and binarization are performed on tiles of a few scanlines,
+so that the intermediate data stays in the cache. Island removal, erosion and dilation are computed in place on the
+binary image. The fused kernels implement the same operations as the VTK filters, but the smoothed image may differ by
+one gray level due to the different rounding of intermediate values.
+
 \ingroup PlusLibImageProcessingAlgo
 */
 class vtkPlusImageProcessingExport vtkPlusTransverseProcessEnhancer : public vtkPlusTrackedFrameProcessor
@@ -97,6 +111,11 @@ public:
   vtkSetVector2Macro(DilationKernelSize, int);
   vtkGetVector2Macro(DilationKernelSize, int);
 
+  /*! If enabled then the fused smoothing, edge detection and morphology kernels are used instead of the VTK filters */
+  vtkSetMacro(EnableFusedProcessing, bool);
+  vtkGetMacro(EnableFusedProcessing, bool);
+  vtkBooleanMacro(EnableFusedProcessing, bool);
+
   void ThresholdViaStdDeviation(vtkSmartPointer<vtkImageData> inputImage);
 
   vtkImageData* GetProcessedLinesImage() { return (this->ProcessedLinesImage); }
@@ -119,7 +138,39 @@ protected:
   void FillLinesImage(vtkSmartPointer<vtkImageData> inputImageData);
   void VectorImageToUchar(vtkSmartPointer<vtkImageData> inputImage);
 
-  void ImageConjunction(vtkSmartPointer<vtkImageData> inputImage, vtkSmartPointer<vtkImageData> maskImage);
+  /*!
+    Fill the lines image and the thresholded lines image in one pass over each scanline.
+    If horizontalSmoothing is true then the horizontal Gaussian smoothing of the thresholded lines is computed as well.
+    The input image must have unsigned char pixel type and one component.
+  */
+  void FillLinesImageAndThreshold(vtkImageData* inputImageData, bool horizontalSmoothing);
+
+  /*! Compute for each lines image pixel the index of the input pixel (-1 if it is outside of the input image) */
+  void ComputeScanLineSampleIndices(vtkImageData* inputImageData);
+
+  /*! Threshold one row of the lines image based on its standard deviation. Used by ThresholdViaStdDeviation. */
+  void ThresholdRowViaStdDeviation(unsigned char* row, int rowLength);
+
+  /*! Compute the Gaussian kernel and boundary normalization factors for the fused smoothing */
+  void ComputeGaussianKernel();
+
+  /*! Horizontal Gaussian smoothing of a lines image row into the smoothing buffer */
+  void SmoothRowHorizontally(const unsigned char* row, float* smoothedRow);
+
+  /*! Vertical Gaussian smoothing, Sobel edge detection and binarization, processed in tiles of scanlines */
+  void SmoothAndDetectEdges();
+
+  /*! Replace 8-connected islands of 255 pixels that are smaller than IslandAreaThreshold by 0 */
+  void RemoveIslands(vtkImageData* binaryImage);
+
+  /*!
+    Binary erosion or dilation with an ellipse shaped kernel, equivalent to vtkImageDilateErode3D.
+    Pixels with erodeValue that have a pixel with dilateValue in their neighborhood are set to dilateValue.
+  */
+  void ErodeDilate(vtkImageData* binaryImage, const int kernelSize[2], unsigned char erodeValue, unsigned char dilateValue);
+
+  /*! Copy pixels of InputImage to OutputImage where the MaskImage is > 0, all other OutputImage pixels are set to 0 */
+  void ImageConjunction(vtkImageData* inputImage, vtkImageData* maskImage, vtkImageData* outputImage);
 
   void AddIntermediateImage(char* fileNamePostfix, vtkSmartPointer<vtkImageData> image);
   void AddIntermediateFromFilter(char* fileNamePostfix, vtkImageAlgorithm* imageAlgorithm);
@@ -162,23 +213,63 @@ protected:
   int BoneOutlineDepthPx;
   int BonePushBackPx;
 
+  bool EnableFusedProcessing;
+
   bool SaveIntermediateResults;
 
   std::string IntermediateImageFileName;
 
-  /// Image for pixels (uchar) along scan lines only
+  /// Image for pixels (uchar) along scan lines only. Used to retrieve original pixel values after binarization.
   vtkSmartPointer<vtkImageData> LinesImage;
-  /// Used to retrieve original pixel values from some point before binarization
-  vtkSmartPointer<vtkImageData> UnprocessedLinesImage;
+  /// Lines image after thresholding by standard deviation
+  vtkSmartPointer<vtkImageData> ThresholdedLinesImage;
+  /// Lines image after Gaussian smoothing (only used by the fused processing)
+  vtkSmartPointer<vtkImageData> SmoothedLinesImage;
   /// Pixels (float) store probability of belonging to shadow
   vtkSmartPointer<vtkImageData> ProcessedLinesImage;
+  /// Temporary binary image for erosion and dilation
+  vtkSmartPointer<vtkImageData> MorphologyBufferImage;
+
+  /// Index of the input image pixel for each lines image pixel (-1 if outside of the input image)
+  std::vector<vtkIdType> ScanLineSampleIndices;
+  /// Input image extent that ScanLineSampleIndices were computed for
+  int ScanLineSampleIndicesInputExtent[6];
+
+  /// Gaussian kernel for fused smoothing, element i is the weight of the pixel at distance i
+  std::vector<float> GaussianKernel;
+  /// Reciprocal of the sum of the kernel weights that fall inside the image, for each column and row
+  std::vector<float> GaussianNormalizationX;
+  std::vector<float> GaussianNormalizationY;
+  /// Horizontally smoothed lines image
+  std::vector<float> HorizontalSmoothingBuffer;
+  /// Accumulator for vertical smoothing of a tile of scanlines
+  std::vector<float> VerticalSmoothingBuffer;
+  /// Number of dilate value pixels before each pixel in its row, used by ErodeDilate
+  std::vector<int> MorphologyPrefixCounts;
+  /// Range of x offsets of the kernel in each kernel row, used by ErodeDilate
+  std::vector<int> MorphologyKernelRanges;
+  /// Pixel indices of the island that is currently being filled, used by RemoveIslands
+  std::vector<int> IslandPixelIndices;
+  /// Non-zero for pixels that are already assigned to an island, used by RemoveIslands
+  std::vector<unsigned char> IslandVisited;
 
   /// Image after some of the processing operations have been applied
   std::map<char*, vtkSmartPointer<vtkPlusTrackedFrameList> > IntermediateImageMap;
 
   std::vector<char*> IntermediatePostfixes;
 
-  std::vector<std::map<std::string, int>> BoneAreasInfo;
+  /// Region of a possible bone, found by MarkShadowOutline
+  struct BoneArea
+  {
+    int Depth;  // The outline's average x-coordinate
+    int XMax;   // The outline's maximum x-coordinate (Used for efficiency)
+    int XMin;   // The outline's minimum x-coordinate (Used for efficiency)
+    int YMax;   // The outline's maximum y-coordinate
+    int YMin;   // The outline's minimum y-coordinate
+  };
+  std::vector<BoneArea> BoneAreasInfo;
+  /// Bone areas that are being checked by RemoveOffCameraBones and CompareShadowAreas
+  std::vector<BoneArea> CandidateBoneAreas;
 
 
 private:
@@ -33,6 +33,7 @@ vtkPlusUsScanConvert::vtkPlusUsScanConvert()
   this->TransducerCenterPixelSpecified = false;
   this->TransducerCenterPixel[0] = 0;
   this->TransducerCenterPixel[1] = 0;
+  this->UseLookupTable = false;
 }
 
 //----------------------------------------------------------------------------
@@ -49,6 +50,8 @@ void vtkPlusUsScanConvert::PrintSelf( ostream& os, vtkIndent indent )
      << this->OutputImageExtent[0] << ", " << this->OutputImageExtent[1] << ", "
      << this->OutputImageExtent[2] << ", " << this->OutputImageExtent[3] << ")\n";
   os << indent << "OutputImageSpacing: (" << this->OutputImageSpacing[0] << ", " << this->OutputImageSpacing[1] << ")\n";
+  os << indent << "UseLookupTable: " << ( this->UseLookupTable ? "TRUE" : "FALSE" ) << "\n";
+  os << indent << "LookupTableFilename: " << this->LookupTableFilename << "\n";
 }
 
 //-----------------------------------------------------------------------------
@@ -99,6 +102,9 @@ PlusStatus vtkPlusUsScanConvert::ReadConfiguration( vtkXMLDataElement* scanConve
     this->TransducerCenterPixel[1] = transducerCenterPixel[1];
   }
 
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL( UseLookupTable, scanConversionElement );
+  XML_READ_STRING_ATTRIBUTE_OPTIONAL( LookupTableFilename, scanConversionElement );
+
   return PLUS_SUCCESS;
 }
 
@@ -125,6 +131,12 @@ PlusStatus vtkPlusUsScanConvert::WriteConfiguration( vtkXMLDataElement* scanConv
     scanConversionElement->SetVectorAttribute( "TransducerCenterPixel", 2, this->TransducerCenterPixel );
   }
 
+  scanConversionElement->SetAttribute( "UseLookupTable", this->UseLookupTable ? "TRUE" : "FALSE" );
+  if ( !this->LookupTableFilename.empty() )
+  {
+    scanConversionElement->SetAttribute( "LookupTableFilename", this->LookupTableFilename.c_str() );
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -10,6 +10,8 @@ See License.txt for details.
 #include "vtkPlusImageProcessingExport.h"
 #include "vtkThreadedImageAlgorithm.h"
 
+#include <string>
+
 /*!
 \class vtkPlusUsScanConvert
 \brief This is a base class for defining a common scan conversion algorithm interface for all kinds of probes
@@ -66,6 +68,22 @@ public:
   /*! Get the distance between two sample points in the scanline, in mm. Setting of the input image or at least the input image extent is required before calling this method. */
   virtual double GetDistanceBetweenScanlineSamplePointsMm()=0;
 
+  /*!
+    If enabled then unsigned char and unsigned short images are scan converted using a precomputed lookup table
+    with quantized weights (see PlusScanConversionLookupTable). Disabled by default, as the result may slightly differ
+    from the default scan conversion (by the quantization error of the weights).
+  */
+  vtkSetMacro(UseLookupTable, bool);
+  vtkGetMacro(UseLookupTable, bool);
+  vtkBooleanMacro(UseLookupTable, bool);
+
+  /*!
+    If specified then the lookup table is loaded from this file (if it was computed with the same parameters),
+    otherwise the lookup table is computed and saved to this file. Relative paths are relative to the output directory.
+  */
+  vtkSetStdStringMacro(LookupTableFilename);
+  vtkGetStdStringMacro(LookupTableFilename);
+
 protected:
   vtkPlusUsScanConvert();
   virtual ~vtkPlusUsScanConvert();
@@ -99,6 +117,12 @@ protected:
   */
   int InputImageExtent[6];
 
+  /*! Use precomputed lookup table for scan conversion */
+  bool UseLookupTable;
+
+  /*! File that stores the lookup table between sessions */
+  std::string LookupTableFilename;
+
 private:
   vtkPlusUsScanConvert(const vtkPlusUsScanConvert&);  // Not implemented.
   void operator=(const vtkPlusUsScanConvert&);  // Not implemented.
@@ -67,6 +67,7 @@ vtkPlusUsScanConvertCurvilinear::vtkPlusUsScanConvertCurvilinear()
   this->InterpTransducerCenterPixel[0] = 0.0;
   this->InterpTransducerCenterPixel[1] = 0.0;
   this->InterpIntensityScaling = 0.0;
+  this->InterpUseLookupTable = false;
 }
 
 //----------------------------------------------------------------------------
@@ -89,7 +90,7 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
     {
       modifiedScanConversionParams = true;
     }
-    if ( this->OutputImageExtent[i] != outputImageExtent[i] )
+    if ( this->InterpOutputImageExtent[i] != outputImageExtent[i] )
     {
       modifiedScanConversionParams = true;
     }
@@ -111,6 +112,10 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
   {
     modifiedScanConversionParams = true;
   }
+  if ( this->InterpUseLookupTable != this->UseLookupTable )
+  {
+    modifiedScanConversionParams = true;
+  }
 
   if ( !modifiedScanConversionParams )
   {
@@ -123,7 +128,7 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
   for ( int i = 0; i < 6; i++ )
   {
     this->InterpInputImageExtent[i] = inputImageExtent[i];
-    this->OutputImageExtent[i] = outputImageExtent[i];
+    this->InterpOutputImageExtent[i] = outputImageExtent[i];
   }
   for ( int i = 0; i < 3; i++ )
   {
@@ -136,13 +141,49 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
   this->InterpTransducerCenterPixel[0] = transducerCenterPixel[0];
   this->InterpTransducerCenterPixel[1] = transducerCenterPixel[1];
   this->InterpIntensityScaling = intensityScaling;
-
-  // Compute the interpolated point array now
+  this->InterpUseLookupTable = this->UseLookupTable;
 
   this->InterpolatedPointArray.clear();
 
   int numberOfSamples = inputImageExtent[1] - inputImageExtent[0] + 1;
   int numberOfLines = inputImageExtent[3] - inputImageExtent[2] + 1;
+  int outputImageSizePixels[2] = { outputImageExtent[1] - outputImageExtent[0] + 1, outputImageExtent[3] - outputImageExtent[2] + 1 };
+  this->LookupTable.Initialize( numberOfSamples * numberOfLines, outputImageSizePixels, 1, numberOfSamples );
+
+  // Try to load the lookup table from file
+  std::string lookupTableFilePath;
+  std::vector<double> lookupTableParameters;
+  if ( this->UseLookupTable && !this->LookupTableFilename.empty() )
+  {
+    lookupTableFilePath = vtkPlusConfig::GetInstance()->GetOutputPath( this->LookupTableFilename );
+    lookupTableParameters.assign( inputImageExtent, inputImageExtent + 6 );
+    lookupTableParameters.insert( lookupTableParameters.end(), outputImageExtent, outputImageExtent + 6 );
+    lookupTableParameters.insert( lookupTableParameters.end(), outputImageSpacing, outputImageSpacing + 3 );
+    lookupTableParameters.insert( lookupTableParameters.end(), transducerCenterPixel, transducerCenterPixel + 2 );
+    lookupTableParameters.push_back( radiusStartMm );
+    lookupTableParameters.push_back( radiusStopMm );
+    lookupTableParameters.push_back( thetaStartDeg );
+    lookupTableParameters.push_back( thetaStopDeg );
+    if ( this->LookupTable.ReadFromFile( lookupTableFilePath, lookupTableParameters ) == PLUS_SUCCESS )
+    {
+      LOG_DEBUG( "Scan conversion lookup table is loaded from " << lookupTableFilePath );
+      // The interpolated point array is still needed for image types that the lookup table does not support
+      this->InterpolatedPointArray.resize( this->LookupTable.GetNumberOfEntries() );
+      for ( int entryIndex = 0; entryIndex < this->LookupTable.GetNumberOfEntries(); entryIndex++ )
+      {
+        InterpolatedPoint& ip = this->InterpolatedPointArray[entryIndex];
+        this->LookupTable.GetEntry( entryIndex, ip.inputPixelIndex, ip.outputPixelIndex, ip.weightCoefficients );
+        for ( int i = 0; i < 4; i++ )
+        {
+          ip.weightCoefficients[i] *= intensityScaling;
+        }
+      }
+      return;
+    }
+  }
+
+  // Compute the interpolated point array now
+
   double radiusDeltaMm = ( radiusStopMm - radiusStartMm ) / numberOfSamples;
   double thetaStartRad = vtkMath::RadiansFromDegrees( thetaStartDeg );
   double thetaDeltaRad = 0;
@@ -192,6 +233,13 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
         ip.outputPixelIndex = j + outputImageSizePixelsX * i;
 
         this->InterpolatedPointArray.push_back( ip );
+
+        if ( this->UseLookupTable )
+        {
+          // intensity scaling is not included in the lookup table weights
+          double weights[4] = { ( 1 - samp_val ) * ( 1 - line_val ), samp_val * ( 1 - line_val ), ( 1 - samp_val ) * line_val, samp_val * line_val };
+          this->LookupTable.AddEntry( ip.inputPixelIndex, ip.outputPixelIndex, weights );
+        }
       }
 
       x = x + dx;
@@ -199,6 +247,17 @@ void vtkPlusUsScanConvertCurvilinear::ComputeInterpolatedPointArray(
     z = z + dz;
   }
 
+  if ( this->UseLookupTable )
+  {
+    this->LookupTable.Finalize();
+    if ( !lookupTableFilePath.empty() )
+    {
+      if ( this->LookupTable.WriteToFile( lookupTableFilePath, lookupTableParameters ) == PLUS_SUCCESS )
+      {
+        LOG_INFO( "Scan conversion lookup table is saved to " << lookupTableFilePath );
+      }
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -330,6 +389,24 @@ void vtkPlusUsScanConvertCurvilinear::ThreadedRequestData(
     return;
   }
 
+  // The lookup table contains the same points as the interpolated point array, so the same split of the table can be used
+  if ( this->UseLookupTable && this->InterpIntensityScaling == 1.0
+       && this->LookupTable.GetNumberOfEntries() == static_cast<int>( this->InterpolatedPointArray.size() ) )
+  {
+    switch ( inData[0][0]->GetScalarType() )
+    {
+    case VTK_UNSIGNED_CHAR:
+      this->LookupTable.Apply( static_cast<unsigned char*>( inPtr ), static_cast<unsigned char*>( outPtr ), outExt[0], outExt[1] );
+      return;
+    case VTK_UNSIGNED_SHORT:
+      this->LookupTable.Apply( static_cast<unsigned short*>( inPtr ), static_cast<unsigned short*>( outPtr ), outExt[0], outExt[1] );
+      return;
+    default:
+      // not supported by the lookup table, use the interpolated point array
+      break;
+    }
+  }
+
   switch ( inData[0][0]->GetScalarType() )
   {
     vtkTemplateMacro(
@@ -355,6 +432,7 @@ void vtkPlusUsScanConvertCurvilinear::PrintSelf( ostream& os, vtkIndent indent )
   os << indent << "ThetaStopDeg: " << this->ThetaStopDeg << "\n";
   os << indent << "OutputIntensityScaling: " << this->OutputIntensityScaling << "\n";
   os << indent << "InterpolatedPointArraySize: " << this->InterpolatedPointArray.size() << "\n";
+  os << indent << "LookupTableSize: " << this->LookupTable.GetNumberOfEntries() << "\n";
 
 }
 
@@ -9,6 +9,7 @@ See License.txt for details.
 
 #include "vtkPlusImageProcessingExport.h"
 #include "vtkPlusUsScanConvert.h"
+#include "PlusScanConversionLookupTable.h"
 
 /*!
 \class vtkPlusUsScanConvertCurvilinear
@@ -52,6 +53,12 @@ public:
     return this->InterpolatedPointArray;
   };
 
+  /*! Retrieve the lookup table (used internally by the thread function). It contains the same points as the InterpolatedPointArray. */
+  const PlusScanConversionLookupTable& GetLookupTable()
+  {
+    return this->LookupTable;
+  };
+
   /*! Initialize the parameters used in reconstruction. These are for the cases when video source can obtain them from the hardware */
   vtkSetMacro(RadiusStartMm, double);
   vtkGetMacro(RadiusStartMm, double);
@@ -112,6 +119,9 @@ protected:
   /*! Each element of this array defines the computation of a pixel in the output (scan converted) image.  */
   std::vector<InterpolatedPoint> InterpolatedPointArray;
 
+  /*! Quantized weights of the InterpolatedPointArray, used for unsigned char and unsigned short images if UseLookupTable is enabled */
+  PlusScanConversionLookupTable LookupTable;
+
   int InterpInputImageExtent[6];
   double InterpRadiusStartMm;
   double InterpRadiusStopMm;
@@ -121,6 +131,7 @@ protected:
   double InterpOutputImageSpacing[3];
   double InterpTransducerCenterPixel[2];
   double InterpIntensityScaling;
+  bool InterpUseLookupTable;
 
   /*!
     Computes the InterpolatedPointArray from the method arguments. The array is not recomputed if
@@ -14,6 +14,10 @@ See License.txt for details.
 #include "vtkImageData.h"
 #include "vtkAlgorithmOutput.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
 vtkStandardNewMacro(vtkPlusUsScanConvertLinear);
 
 //----------------------------------------------------------------------------
@@ -23,6 +27,9 @@ vtkPlusUsScanConvertLinear::vtkPlusUsScanConvertLinear()
   this->TransducerWidthMm=38.0;
 
   this->ImageReslice=vtkImageReslice::New();  
+
+  this->LookupTableOutput=vtkImageData::New();
+  this->OutputFromLookupTable=false;
 }
 
 //----------------------------------------------------------------------------
@@ -30,6 +37,9 @@ vtkPlusUsScanConvertLinear::~vtkPlusUsScanConvertLinear()
 {
   this->ImageReslice->Delete();
   this->ImageReslice=NULL;  
+
+  this->LookupTableOutput->Delete();
+  this->LookupTableOutput=NULL;
 }
 
 void vtkPlusUsScanConvertLinear::PrintSelf(ostream& os, vtkIndent indent)
@@ -37,6 +47,7 @@ void vtkPlusUsScanConvertLinear::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
   os << indent << "ImagingDepthMm: "<< this->ImagingDepthMm << "\n";
   os << indent << "TransducerWidthMm: "<< this->TransducerWidthMm << "\n";
+  os << indent << "LookupTableSize: "<< this->LookupTable.GetNumberOfEntries() << "\n";
 }
 
 //-----------------------------------------------------------------------------
@@ -94,12 +105,131 @@ void vtkPlusUsScanConvertLinear::Update()
 
   this->ImageReslice->SetOutputOrigin(-this->TransducerCenterPixel[0]+halfImageWidthPixel,-this->TransducerCenterPixel[1],0);
 
+  if (this->UseLookupTable && PlusScanConversionLookupTable::IsScalarTypeSupported(inputImage->GetScalarType())
+    && inputImage->GetNumberOfScalarComponents()==1)
+  {
+    this->UpdateLookupTable(inputImage);
+
+    this->LookupTableOutput->SetExtent(this->OutputImageExtent);
+    this->LookupTableOutput->SetSpacing(1.0, 1.0, 1.0);
+    this->LookupTableOutput->SetOrigin(this->ImageReslice->GetOutputOrigin());
+    this->LookupTableOutput->AllocateScalars(inputImage->GetScalarType(), 1);
+
+    // Pixels outside the scanned area are not in the lookup table, they are set to zero (same as the vtkImageReslice background)
+    vtkIdType numberOfOutputPixels=this->LookupTableOutput->GetNumberOfPoints();
+    memset(this->LookupTableOutput->GetScalarPointer(), 0, numberOfOutputPixels*this->LookupTableOutput->GetScalarSize());
+    int lastEntry=this->LookupTable.GetNumberOfEntries()-1;
+    if (inputImage->GetScalarType()==VTK_UNSIGNED_CHAR)
+    {
+      this->LookupTable.Apply(static_cast<unsigned char*>(inputImage->GetScalarPointer()), static_cast<unsigned char*>(this->LookupTableOutput->GetScalarPointer()), 0, lastEntry);
+    }
+    else
+    {
+      this->LookupTable.Apply(static_cast<unsigned short*>(inputImage->GetScalarPointer()), static_cast<unsigned short*>(this->LookupTableOutput->GetScalarPointer()), 0, lastEntry);
+    }
+    this->LookupTableOutput->Modified();
+    this->OutputFromLookupTable=true;
+    return;
+  }
+
+  this->OutputFromLookupTable=false;
   this->ImageReslice->Update();
 }
 
+//-----------------------------------------------------------------------------
+void vtkPlusUsScanConvertLinear::UpdateLookupTable(vtkImageData* inputImage)
+{
+  int inputExtent[6]={0,-1,0,-1,0,-1};
+  inputImage->GetExtent(inputExtent);
+  double* inputOrigin=inputImage->GetOrigin();
+  double* inputSpacing=inputImage->GetSpacing();
+  double* outputOrigin=this->ImageReslice->GetOutputOrigin();
+  double resliceAxes[3][3]={{0}};
+  this->ImageReslice->GetResliceAxesDirectionCosines(resliceAxes[0], resliceAxes[1], resliceAxes[2]);
+
+  // Recompute the table only if the sampling geometry has been changed
+  std::vector<double> parameters(inputExtent, inputExtent+6);
+  parameters.insert(parameters.end(), inputOrigin, inputOrigin+3);
+  parameters.insert(parameters.end(), inputSpacing, inputSpacing+3);
+  parameters.insert(parameters.end(), this->OutputImageExtent, this->OutputImageExtent+6);
+  parameters.insert(parameters.end(), outputOrigin, outputOrigin+3);
+  for (int axis=0; axis<3; axis++)
+  {
+    parameters.insert(parameters.end(), resliceAxes[axis], resliceAxes[axis]+3);
+  }
+  if (parameters==this->LookupTableParameters)
+  {
+    return;
+  }
+  this->LookupTableParameters=parameters;
+
+  int inputSize[3]={inputExtent[1]-inputExtent[0]+1, inputExtent[3]-inputExtent[2]+1, inputExtent[5]-inputExtent[4]+1};
+  int outputSize[2]={this->OutputImageExtent[1]-this->OutputImageExtent[0]+1, this->OutputImageExtent[3]-this->OutputImageExtent[2]+1};
+  // Nearest neighbor sampling: all the weight is on the first input pixel, there is no need for neighbor pixels
+  this->LookupTable.Initialize(inputSize[0]*inputSize[1]*inputSize[2], outputSize, 0, 0);
+
+  if (!this->LookupTableFilename.empty())
+  {
+    std::string lookupTableFilePath=vtkPlusConfig::GetInstance()->GetOutputPath(this->LookupTableFilename);
+    if (this->LookupTable.ReadFromFile(lookupTableFilePath, parameters)==PLUS_SUCCESS)
+    {
+      LOG_DEBUG("Scan conversion lookup table is loaded from "<<lookupTableFilePath);
+      return;
+    }
+  }
+
+  const double weights[4]={1.0, 0.0, 0.0, 0.0};
+  double outputPoint[3]={0, 0, outputOrigin[2]+this->OutputImageExtent[4]};
+  for (int outputY=0; outputY<outputSize[1]; outputY++)
+  {
+    // Output spacing is 1, see Update()
+    outputPoint[1]=outputOrigin[1]+this->OutputImageExtent[2]+outputY;
+    for (int outputX=0; outputX<outputSize[0]; outputX++)
+    {
+      outputPoint[0]=outputOrigin[0]+this->OutputImageExtent[0]+outputX;
+      int inputPixelIndex=0;
+      int inputPixelIncrement=1;
+      bool insideInputImage=true;
+      for (int axis=0; axis<3 && insideInputImage; axis++)
+      {
+        double inputPoint=resliceAxes[0][axis]*outputPoint[0]+resliceAxes[1][axis]*outputPoint[1]+resliceAxes[2][axis]*outputPoint[2];
+        double continuousIndex=(inputPoint-inputOrigin[axis])/inputSpacing[axis];
+        // vtkImageReslice extends the input extent by half a pixel (Border is enabled by default)
+        if (continuousIndex<inputExtent[axis*2]-0.5 || continuousIndex>inputExtent[axis*2+1]+0.5)
+        {
+          insideInputImage=false;
+          break;
+        }
+        int index=static_cast<int>(floor(continuousIndex+0.5));
+        index=std::min(std::max(index, inputExtent[axis*2]), inputExtent[axis*2+1]);
+        inputPixelIndex+=(index-inputExtent[axis*2])*inputPixelIncrement;
+        inputPixelIncrement*=inputSize[axis];
+      }
+      if (insideInputImage)
+      {
+        this->LookupTable.AddEntry(inputPixelIndex, outputX+outputY*outputSize[0], weights);
+      }
+    }
+  }
+  this->LookupTable.Finalize();
+
+  if (!this->LookupTableFilename.empty())
+  {
+    std::string lookupTableFilePath=vtkPlusConfig::GetInstance()->GetOutputPath(this->LookupTableFilename);
+    if (this->LookupTable.WriteToFile(lookupTableFilePath, parameters)==PLUS_SUCCESS)
+    {
+      LOG_INFO("Scan conversion lookup table is saved to "<<lookupTableFilePath);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 vtkImageData* vtkPlusUsScanConvertLinear::GetOutput()
 {
+  if (this->OutputFromLookupTable)
+  {
+    return this->LookupTableOutput;
+  }
   return this->ImageReslice->GetOutput();
 }
 
@@ -9,6 +9,9 @@ See License.txt for details.
 
 #include "vtkPlusImageProcessingExport.h"
 #include "vtkPlusUsScanConvert.h"
+#include "PlusScanConversionLookupTable.h"
+
+#include <vector>
 
 class vtkAlgorithmOutput;
 class vtkImageReslice;
@@ -17,6 +20,12 @@ class vtkImageData;
 /*!
 \class vtkPlusUsScanConvertLinear
 \brief This class performs scan conversion from scan lines for curvilinear probes
+
+By default the scan conversion is performed by vtkImageReslice (nearest neighbor interpolation).
+If UseLookupTable is enabled then unsigned char and unsigned short images are scan converted using
+a precomputed lookup table that samples the same input pixels as vtkImageReslice. The result may differ
+from vtkImageReslice only in the pixels at the border of the scanned area, where the input pixel positions
+are exactly halfway between two pixels.
 \ingroup PlusLibImageProcessingAlgo
 */ 
 class vtkPlusImageProcessingExport vtkPlusUsScanConvertLinear : public vtkPlusUsScanConvert
@@ -75,6 +84,21 @@ protected:
   /*! Reslice class that performs the necessary resampling */
   vtkImageReslice* ImageReslice;
 
+  /*! Compute the lookup table from the current parameters of the ImageReslice filter. The table is only recomputed if the parameters have been changed. */
+  void UpdateLookupTable(vtkImageData* inputImage);
+
+  /*! Nearest neighbor sampling of the input image, used instead of ImageReslice if UseLookupTable is enabled */
+  PlusScanConversionLookupTable LookupTable;
+
+  /*! Parameters that the lookup table was computed from */
+  std::vector<double> LookupTableParameters;
+
+  /*! Output image when the scan conversion is performed using the lookup table */
+  vtkImageData* LookupTableOutput;
+
+  /*! True if the last Update computed the output using the lookup table */
+  bool OutputFromLookupTable;
+
 private:
   vtkPlusUsScanConvertLinear(const vtkPlusUsScanConvertLinear&);  // Not implemented.
   void operator=(const vtkPlusUsScanConvertLinear&);  // Not implemented.
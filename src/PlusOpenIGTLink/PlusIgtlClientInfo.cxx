@@ -10,12 +10,22 @@ See License.txt for details.
 
 #include "igtl_header.h"
 
+namespace
+{
+  const int DEFAULT_SEND_QUEUE_MAX_LENGTH = 50;
+  const char* SEND_QUEUE_DROP_POLICY_OLDEST_IMAGE = "DropOldestImage";
+  const char* SEND_QUEUE_DROP_POLICY_OLDEST = "DropOldest";
+}
+
 //----------------------------------------------------------------------------
 PlusIgtlClientInfo::PlusIgtlClientInfo()
   : ClientHeaderVersion(IGTL_HEADER_VERSION_1)
   , Resolution(0)
   , TDATARequested(false)
   , LastTDATASentTimeStamp(-1)
+  , SendQueueMaxLength(DEFAULT_SEND_QUEUE_MAX_LENGTH)
+  , SendQueueDropPolicy(DROP_OLDEST_IMAGE)
+  , TrackedFrameBinaryMetadataSupported(false)
 {
 
 }
@@ -61,6 +71,31 @@ PlusStatus PlusIgtlClientInfo::SetClientInfoFromXmlData(vtkXMLDataElement* xmlda
     xmldata->GetScalarAttribute("Resolution", clientInfo.Resolution);
   }
 
+  if (xmldata->GetAttribute("SendQueueMaxLength") != NULL)
+  {
+    xmldata->GetScalarAttribute("SendQueueMaxLength", clientInfo.SendQueueMaxLength);
+    if (clientInfo.SendQueueMaxLength < 0)
+    {
+      LOG_WARNING("Invalid SendQueueMaxLength: " << clientInfo.SendQueueMaxLength << ". Send queue length will not be limited.");
+      clientInfo.SendQueueMaxLength = 0;
+    }
+  }
+
+  if (xmldata->GetAttribute("SendQueueDropPolicy") != NULL)
+  {
+    if (GetSendQueueDropPolicyFromString(xmldata->GetAttribute("SendQueueDropPolicy"), clientInfo.SendQueueDropPolicy) != PLUS_SUCCESS)
+    {
+      LOG_WARNING("Invalid SendQueueDropPolicy: " << xmldata->GetAttribute("SendQueueDropPolicy") << ". Valid values: "
+                  << SEND_QUEUE_DROP_POLICY_OLDEST_IMAGE << ", " << SEND_QUEUE_DROP_POLICY_OLDEST << ". Using " << SEND_QUEUE_DROP_POLICY_OLDEST_IMAGE << ".");
+      clientInfo.SendQueueDropPolicy = DROP_OLDEST_IMAGE;
+    }
+  }
+
+  if (xmldata->GetAttribute("TrackedFrameBinaryMetadataSupported") != NULL)
+  {
+    clientInfo.TrackedFrameBinaryMetadataSupported = STRCASECMP(xmldata->GetAttribute("TrackedFrameBinaryMetadataSupported"), "TRUE") == 0;
+  }
+
   // Get message types
   vtkXMLDataElement* messageTypes = xmldata->FindNestedElementWithName("MessageTypes");
   if (messageTypes != NULL)
@@ -171,6 +206,9 @@ void PlusIgtlClientInfo::GetClientInfoInXmlData(std::string& strXmlData)
   vtkSmartPointer<vtkXMLDataElement> xmldata = vtkSmartPointer<vtkXMLDataElement>::New();
   xmldata->SetName("ClientInfo");
   xmldata->SetAttribute("TDATARequested", (this->TDATARequested ? "TRUE" : "FALSE"));
+  xmldata->SetIntAttribute("SendQueueMaxLength", this->SendQueueMaxLength);
+  xmldata->SetAttribute("SendQueueDropPolicy", GetSendQueueDropPolicyAsString(this->SendQueueDropPolicy).c_str());
+  xmldata->SetAttribute("TrackedFrameBinaryMetadataSupported", (this->TrackedFrameBinaryMetadataSupported ? "TRUE" : "FALSE"));
 
   vtkSmartPointer<vtkXMLDataElement> messageTypes = vtkSmartPointer<vtkXMLDataElement>::New();
   messageTypes->SetName("MessageTypes");
@@ -311,6 +349,9 @@ void PlusIgtlClientInfo::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << "(none)";
   }
+
+  os << ". Send queue: max length " << this->SendQueueMaxLength << ", drop policy " << GetSendQueueDropPolicyAsString(this->SendQueueDropPolicy);
+  os << ". Tracked frame metadata: " << (this->TrackedFrameBinaryMetadataSupported ? "binary" : "xml");
 }
 
 //----------------------------------------------------------------------------
@@ -324,3 +365,48 @@ void PlusIgtlClientInfo::SetClientHeaderVersion(int version)
 {
   this->ClientHeaderVersion = version;
 }
+
+//----------------------------------------------------------------------------
+bool PlusIgtlClientInfo::IsMessageDroppable(const std::string& messageType) const
+{
+  switch (this->SendQueueDropPolicy)
+  {
+    case DROP_OLDEST:
+      return true;
+    case DROP_OLDEST_IMAGE:
+      return PlusCommon::IsEqualInsensitive(messageType, "IMAGE")
+             || PlusCommon::IsEqualInsensitive(messageType, "VIDEO")
+             || PlusCommon::IsEqualInsensitive(messageType, "USMESSAGE")
+             || PlusCommon::IsEqualInsensitive(messageType, "TRACKEDFRAME");
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+std::string PlusIgtlClientInfo::GetSendQueueDropPolicyAsString(SendQueueDropPolicyType policy)
+{
+  switch (policy)
+  {
+    case DROP_OLDEST:
+      return SEND_QUEUE_DROP_POLICY_OLDEST;
+    case DROP_OLDEST_IMAGE:
+      return SEND_QUEUE_DROP_POLICY_OLDEST_IMAGE;
+  }
+  return "";
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusIgtlClientInfo::GetSendQueueDropPolicyFromString(const std::string& policyName, SendQueueDropPolicyType& policy)
+{
+  if (PlusCommon::IsEqualInsensitive(policyName, SEND_QUEUE_DROP_POLICY_OLDEST_IMAGE))
+  {
+    policy = DROP_OLDEST_IMAGE;
+    return PLUS_SUCCESS;
+  }
+  if (PlusCommon::IsEqualInsensitive(policyName, SEND_QUEUE_DROP_POLICY_OLDEST))
+  {
+    policy = DROP_OLDEST;
+    return PLUS_SUCCESS;
+  }
+  return PLUS_FAIL;
+}
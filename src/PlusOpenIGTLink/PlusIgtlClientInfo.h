@@ -36,6 +36,15 @@ struct vtkPlusOpenIGTLinkExport PlusIgtlClientInfo
     std::string EmbeddedTransformToFrame;
   };
 
+  /*! Determines which messages are discarded when the client cannot keep up with the data stream and its send queue is full */
+  enum SendQueueDropPolicyType
+  {
+    /*! Discard the oldest queued image message (IMAGE, VIDEO, USMESSAGE, TRACKEDFRAME). Tracking and string data are never discarded. */
+    DROP_OLDEST_IMAGE,
+    /*! Discard the oldest queued data message, regardless of its type */
+    DROP_OLDEST
+  };
+
   PlusIgtlClientInfo();
 
   /*! De-serialize client info data from string xml data */
@@ -53,6 +62,15 @@ struct vtkPlusOpenIGTLinkExport PlusIgtlClientInfo
 
   void SetClientHeaderVersion(int version);
 
+  /*! Returns true if a data message of the specified type may be discarded from the send queue according to the drop policy */
+  bool IsMessageDroppable(const std::string& messageType) const;
+
+  /*! Convert drop policy to string (as used in the XML configuration) */
+  static std::string GetSendQueueDropPolicyAsString(SendQueueDropPolicyType policy);
+
+  /*! Convert string to drop policy. Returns PLUS_FAIL if the string is not a valid policy name. */
+  static PlusStatus GetSendQueueDropPolicyFromString(const std::string& policyName, SendQueueDropPolicyType& policy);
+
   /*! IGTL header version supported by the client */
   int ClientHeaderVersion;
 
@@ -78,6 +96,19 @@ struct vtkPlusOpenIGTLinkExport PlusIgtlClientInfo
 
   /*! timestamp of the last sent TDATA message. */
   double LastTDATASentTimeStamp;
+
+  /*!
+    Maximum number of data messages waiting to be sent to the client. If the queue is full then messages are dropped according to SendQueueDropPolicy.
+    0 means that messages are never dropped. Messages that must not be dropped are queued beyond this length, but the server
+    disconnects the client if it is not receiving them at all.
+  */
+  int SendQueueMaxLength;
+
+  /*! Policy for discarding messages when the send queue is full */
+  SendQueueDropPolicyType SendQueueDropPolicy;
+
+  /*! If true then the client can decode binary tracked frame metadata, so TRACKEDFRAME messages are sent with binary metadata instead of XML */
+  bool TrackedFrameBinaryMetadataSupported;
 };
 
 #endif
\ No newline at end of file
@@ -15,6 +15,7 @@ namespace igtl
   //----------------------------------------------------------------------------
   PlusTrackedFrameMessage::PlusTrackedFrameMessage()
     : MessageBase()
+    , m_MetadataEncoding(METADATA_ENCODING_XML)
   {
     this->m_SendMessageType = "TRACKEDFRAME";
   }
@@ -52,7 +53,15 @@ namespace igtl
   {
     this->m_TrackedFrame = trackedFrame;
 
-    if (this->m_TrackedFrame.GetTrackedFrameInXmlData(this->m_TrackedFrameXmlData, requestedTransforms) != PLUS_SUCCESS)
+    if (this->m_MetadataEncoding == METADATA_ENCODING_BINARY)
+    {
+      if (this->m_TrackedFrame.GetTrackedFrameInBinaryData(this->m_TrackedFrameMetadata, requestedTransforms) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to pack Plus TrackedFrame message - unable to get tracked frame in binary data.");
+        return PLUS_FAIL;
+      }
+    }
+    else if (this->m_TrackedFrame.GetTrackedFrameInXmlData(this->m_TrackedFrameMetadata, requestedTransforms) != PLUS_SUCCESS)
     {
       LOG_ERROR("Failed to pack Plus TrackedFrame message - unable to get tracked frame in xml data.");
       return PLUS_FAIL;
@@ -71,7 +80,7 @@ namespace igtl
     this->m_MessageHeader.m_FrameSize[0] = frameSize[0];
     this->m_MessageHeader.m_FrameSize[1] = frameSize[1];
     this->m_MessageHeader.m_FrameSize[2] = frameSize[2];
-    this->m_MessageHeader.m_XmlDataSizeInBytes = this->m_TrackedFrameXmlData.size();
+    this->m_MessageHeader.m_XmlDataSizeInBytes = this->m_TrackedFrameMetadata.size();
     this->m_MessageHeader.m_ScalarType = PlusVideoFrame::GetIGTLScalarPixelTypeFromVTK(this->m_TrackedFrame.GetImageData()->GetVTKScalarPixelType());
     this->m_MessageHeader.m_NumberOfComponents = m_TrackedFrame.GetImageData()->GetNumberOfScalarComponents();
     this->m_MessageHeader.m_ImageType = m_TrackedFrame.GetImageData()->GetImageType();
@@ -141,9 +150,9 @@ namespace igtl
     header->m_ImageOrientation = this->m_MessageHeader.m_ImageOrientation;
     memcpy(header->m_EmbeddedImageTransform, this->m_MessageHeader.m_EmbeddedImageTransform, sizeof(igtl::Matrix4x4));
 
-    // Copy xml data
-    char* xmlData = (char*)(this->m_Content + header->GetMessageHeaderSize());
-    strncpy(xmlData, this->m_TrackedFrameXmlData.c_str(), this->m_TrackedFrameXmlData.size());
+    // Copy xml or binary metadata (binary metadata may contain zero bytes)
+    char* metadata = (char*)(this->m_Content + header->GetMessageHeaderSize());
+    memcpy(metadata, this->m_TrackedFrameMetadata.data(), this->m_TrackedFrameMetadata.size());
     header->m_XmlDataSizeInBytes = this->m_MessageHeader.m_XmlDataSizeInBytes;
 
     // Copy image data
@@ -181,13 +190,27 @@ namespace igtl
     this->m_MessageHeader.m_ImageOrientation = header->m_ImageOrientation;
     memcpy(this->m_MessageHeader.m_EmbeddedImageTransform, header->m_EmbeddedImageTransform, sizeof(igtl::Matrix4x4));
 
-    // Copy xml data
-    char* xmlData = (char*)(this->m_Content + header->GetMessageHeaderSize());
-    this->m_TrackedFrameXmlData.assign(xmlData, header->m_XmlDataSizeInBytes);
-    if (this->m_TrackedFrame.SetTrackedFrameFromXmlData(this->m_TrackedFrameXmlData) != PLUS_SUCCESS)
+    // Copy metadata, binary metadata is recognized from its signature (xml data starts with '<')
+    const char* metadata = (const char*)(this->m_Content + header->GetMessageHeaderSize());
+    if (PlusTrackedFrame::IsBinaryData(metadata, header->m_XmlDataSizeInBytes))
     {
-      LOG_ERROR("Failed to set tracked frame data from xml received in Plus TrackedFrame message");
-      return 0;
+      this->m_MetadataEncoding = METADATA_ENCODING_BINARY;
+      this->m_TrackedFrameMetadata.clear();
+      if (this->m_TrackedFrame.SetTrackedFrameFromBinaryData(metadata, header->m_XmlDataSizeInBytes) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to set tracked frame data from binary metadata received in Plus TrackedFrame message");
+        return 0;
+      }
+    }
+    else
+    {
+      this->m_MetadataEncoding = METADATA_ENCODING_XML;
+      this->m_TrackedFrameMetadata.assign(metadata, header->m_XmlDataSizeInBytes);
+      if (this->m_TrackedFrame.SetTrackedFrameFromXmlData(this->m_TrackedFrameMetadata) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to set tracked frame data from xml received in Plus TrackedFrame message");
+        return 0;
+      }
     }
 
     // Copy image data
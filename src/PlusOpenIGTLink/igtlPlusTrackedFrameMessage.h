@@ -41,6 +41,17 @@ namespace igtl
     igtlTypeMacro(igtl::PlusTrackedFrameMessage, igtl::MessageBase);
     igtlNewMacro(igtl::PlusTrackedFrameMessage);
 
+    /*!
+      Encoding of the tracked frame metadata (custom fields, transforms, segmentation).
+      The receiver detects the encoding from the metadata block, so binary encoding may only be sent to
+      peers that announced that they support it (see PlusIgtlClientInfo::TrackedFrameBinaryMetadataSupported).
+    */
+    enum MetadataEncodingType
+    {
+      METADATA_ENCODING_XML,    /*!< Human readable XML, supported by all Plus versions */
+      METADATA_ENCODING_BINARY  /*!< Compact binary block, see PlusTrackedFrame::GetTrackedFrameInBinaryData */
+    };
+
   public:
     /*! Override clone so that we use the plus igtl factory */
     virtual igtl::MessageBase::Pointer Clone();
@@ -51,6 +62,12 @@ namespace igtl
     /*! Get Plus TrackedFrame */
     PlusTrackedFrame GetTrackedFrame();
 
+    /*! Set the metadata encoding used by SetTrackedFrame. Default is XML. */
+    void SetMetadataEncoding(MetadataEncodingType encoding) { this->m_MetadataEncoding = encoding; }
+
+    /*! Get the metadata encoding that is used for sending or that was detected in the received message */
+    MetadataEncodingType GetMetadataEncoding() const { return this->m_MetadataEncoding; }
+
     /*! Set the embedded transform of the underlying image */
     PlusStatus SetEmbeddedImageTransform(vtkSmartPointer<vtkMatrix4x4> matrix);
 
@@ -87,7 +104,7 @@ namespace igtl
         headersize += sizeof(igtl_uint16);        // m_ImageType
         headersize += sizeof(igtl_uint16) * 3;    // m_FrameSize[3]
         headersize += sizeof(igtl_uint32);        // m_ImageDataSizeInBytes
-        headersize += sizeof(igtl_uint32);        // m_XmlDataSizeInBytes
+        headersize += sizeof(igtl_uint32);        // m_XmlDataSizeInBytes (xml or binary metadata)
         headersize += sizeof(igtl_uint16);        // m_ImageOrientation
         headersize += sizeof(igtl::Matrix4x4);    // m_EmbeddedImageTransform[4][4]
 
@@ -115,7 +132,7 @@ namespace igtl
       igtl_uint16     m_ImageType;              /* image type */
       igtl_uint16     m_FrameSize[3];           /* entire image volume size */
       igtl_uint32     m_ImageDataSizeInBytes;   /* size of the image, in bytes */
-      igtl_uint32     m_XmlDataSizeInBytes;     /* size of the xml data, in bytes */
+      igtl_uint32     m_XmlDataSizeInBytes;     /* size of the xml or binary metadata, in bytes */
       igtl_uint16     m_ImageOrientation;       /* orientation of the image */
       igtl::Matrix4x4 m_EmbeddedImageTransform; /* matrix representing the IJK to world transformation */
     };
@@ -128,7 +145,9 @@ namespace igtl
     ~PlusTrackedFrameMessage();
 
     PlusTrackedFrame m_TrackedFrame;
-    std::string m_TrackedFrameXmlData;
+    /*! Serialized tracked frame metadata, xml or binary depending on m_MetadataEncoding */
+    std::string m_TrackedFrameMetadata;
+    MetadataEncodingType m_MetadataEncoding;
 
     TrackedFrameHeader m_MessageHeader;
   };
@@ -365,6 +365,21 @@ PlusStatus vtkPlusIgtlMessageCommon::UnpackImageMessage(igtl::MessageHeader::Poi
 
   socket->Receive(imgMsg->GetBufferBodyPointer(), imgMsg->GetBufferBodySize());
 
+  return vtkPlusIgtlMessageCommon::UnpackImageMessage(imgMsg, trackedFrame, embeddedTransformName, crccheck);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusIgtlMessageCommon::UnpackImageMessage(igtl::ImageMessage::Pointer imgMsg,
+    PlusTrackedFrame& trackedFrame,
+    const PlusTransformName& embeddedTransformName,
+    int crccheck)
+{
+  if (imgMsg.IsNull())
+  {
+    LOG_ERROR("Unable to unpack image message - image message is NULL!");
+    return PLUS_FAIL;
+  }
+
   int c = imgMsg->Unpack(crccheck);
   if (!(c & igtl::MessageHeader::UNPACK_BODY))
   {
@@ -378,6 +393,22 @@ PlusStatus vtkPlusIgtlMessageCommon::UnpackImageMessage(igtl::MessageHeader::Poi
 
   int imgSize[3] = {0}; // image dimension in pixels
   imgMsg->GetDimensions(imgSize);
+  int subVolumeSize[3] = {0}; // dimension of the sent part of the image in pixels
+  int subVolumeOffset[3] = {0};
+  imgMsg->GetSubVolume(subVolumeSize, subVolumeOffset);
+  bool subVolume = false;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (subVolumeOffset[i] < 0 || subVolumeSize[i] < 0 || subVolumeOffset[i] + subVolumeSize[i] > imgSize[i])
+    {
+      LOG_ERROR("Failed to unpack image message - sub-volume is outside of the image");
+      return PLUS_FAIL;
+    }
+    if (subVolumeOffset[i] != 0 || subVolumeSize[i] != imgSize[i])
+    {
+      subVolume = true;
+    }
+  }
 
   // Set scalar pixel type
   PlusCommon::VTKScalarPixelType pixelType = PlusVideoFrame::GetVTKScalarPixelTypeFromIGTL(imgMsg->GetScalarType());
@@ -395,7 +426,28 @@ PlusStatus vtkPlusIgtlMessageCommon::UnpackImageMessage(igtl::MessageHeader::Poi
   }
 
   // Copy image to buffer
-  memcpy(frame.GetScalarPointer(), imgMsg->GetScalarPointer(), frame.GetFrameSizeInBytes());
+  if (!subVolume)
+  {
+    memcpy(frame.GetScalarPointer(), imgMsg->GetScalarPointer(), frame.GetFrameSizeInBytes());
+  }
+  else
+  {
+    // Only the sub-volume is sent, copy it row by row to its position in the full image
+    frame.FillBlank();
+    const int bytesPerPixel = frame.GetNumberOfBytesPerPixel();
+    const size_t rowSizeInBytes = static_cast<size_t>(subVolumeSize[0]) * bytesPerPixel;
+    const unsigned char* source = static_cast<const unsigned char*>(imgMsg->GetScalarPointer());
+    unsigned char* target = static_cast<unsigned char*>(frame.GetScalarPointer());
+    for (int z = 0; z < subVolumeSize[2]; ++z)
+    {
+      for (int y = 0; y < subVolumeSize[1]; ++y)
+      {
+        size_t targetOffsetInPx = (static_cast<size_t>(subVolumeOffset[2] + z) * imgSize[1] + subVolumeOffset[1] + y) * imgSize[0] + subVolumeOffset[0];
+        memcpy(target + targetOffsetInPx * bytesPerPixel, source, rowSizeInBytes);
+        source += rowSizeInBytes;
+      }
+    }
+  }
 
   trackedFrame.SetImageData(frame);
   trackedFrame.SetTimestamp(igtlTimestamp->GetTimeStamp());
@@ -68,6 +68,12 @@ public:
   /*! Unpack image message to tracked frame */
   static PlusStatus UnpackImageMessage(igtl::MessageHeader::Pointer headerMsg, igtl::Socket* socket, PlusTrackedFrame& trackedFrame, const PlusTransformName& embeddedTransformName, int crccheck);
 
+  /*!
+    Unpack an image message whose body is already received to tracked frame.
+    A sub-volume is copied into a frame of the full image size, pixels outside of the sub-volume are set to zero.
+  */
+  static PlusStatus UnpackImageMessage(igtl::ImageMessage::Pointer imgMsg, PlusTrackedFrame& trackedFrame, const PlusTransformName& embeddedTransformName, int crccheck);
+
   /*! Pack image meta deta message from vtkPlusServer::ImageMetaDataList  */
   static PlusStatus PackImageMetaMessage(igtl::ImageMetaMessage::Pointer imageMetaMessage, PlusCommon::ImageMetaDataList& imageMetaDataList);
 
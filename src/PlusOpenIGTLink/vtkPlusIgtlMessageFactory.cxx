@@ -125,14 +125,40 @@ igtl::MessageBase::Pointer vtkPlusIgtlMessageFactory::CreateSendMessage(const st
   return aMessageBase;
 }
 
+//----------------------------------------------------------------------------
+bool vtkPlusIgtlMessageFactory::AddCachedMessage(PackedMessageCacheType* packedMessageCache, const std::string& cacheKey, std::vector<igtl::MessageBase::Pointer>& igtlMessages)
+{
+  if (packedMessageCache == NULL)
+  {
+    return false;
+  }
+  PackedMessageCacheType::iterator cachedMessage = packedMessageCache->find(cacheKey);
+  if (cachedMessage == packedMessageCache->end())
+  {
+    return false;
+  }
+  igtlMessages.push_back(cachedMessage->second);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusIgtlMessageFactory::AddPackedMessage(PackedMessageCacheType* packedMessageCache, const std::string& cacheKey, igtl::MessageBase* igtlMessage, std::vector<igtl::MessageBase::Pointer>& igtlMessages)
+{
+  igtlMessages.push_back(igtlMessage);
+  if (packedMessageCache != NULL)
+  {
+    (*packedMessageCache)[cacheKey] = igtlMessage;
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& clientInfo, std::vector<igtl::MessageBase::Pointer>& igtlMessages, PlusTrackedFrame& trackedFrame,
-    bool packValidTransformsOnly, vtkPlusTransformRepository* transformRepository/*=NULL*/)
+    bool packValidTransformsOnly, vtkPlusTransformRepository* transformRepository/*=NULL*/, PackedMessageCacheType* packedMessageCache/*=NULL*/)
 {
   int numberOfErrors(0);
   igtlMessages.clear();
 
-  if (transformRepository != NULL)
+  if (transformRepository != NULL && (packedMessageCache == NULL || packedMessageCache->empty()))
   {
     transformRepository->SetTransforms(trackedFrame);
   }
@@ -140,6 +166,11 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
   for (std::vector<std::string>::const_iterator messageTypeIterator = clientInfo.IgtlMessageTypes.begin(); messageTypeIterator != clientInfo.IgtlMessageTypes.end(); ++ messageTypeIterator)
   {
     std::string messageType = (*messageTypeIterator);
+
+    // Messages of clients with the same message type and header version can be shared
+    std::ostringstream cacheKeyPrefix;
+    cacheKeyPrefix << messageType << "|" << clientInfo.ClientHeaderVersion << "|";
+
     igtl::MessageBase::Pointer igtlMessage;
     try
     {
@@ -165,6 +196,12 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
       {
         PlusIgtlClientInfo::ImageStream imageStream = (*imageStreamIterator);
 
+        std::string cacheKey = cacheKeyPrefix.str() + imageStream.Name + "|" + imageStream.EmbeddedTransformToFrame;
+        if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+        {
+          continue;
+        }
+
         //Set transform name to [Name]To[CoordinateFrame]
         PlusTransformName imageTransformName = PlusTransformName(imageStream.Name, imageStream.EmbeddedTransformToFrame);
 
@@ -192,7 +229,7 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
           numberOfErrors++;
           continue;
         }
-        igtlMessages.push_back(imageMessage.GetPointer());
+        AddPackedMessage(packedMessageCache, cacheKey, imageMessage.GetPointer(), igtlMessages);
       }
     }
     // Transform message
@@ -201,6 +238,12 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
       for (std::vector<PlusTransformName>::const_iterator transformNameIterator = clientInfo.TransformNames.begin(); transformNameIterator != clientInfo.TransformNames.end(); ++transformNameIterator)
       {
         PlusTransformName transformName = (*transformNameIterator);
+        std::string cacheKey = cacheKeyPrefix.str() + transformName.GetTransformName();
+        if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+        {
+          continue;
+        }
+
         bool isValid = false;
         transformRepository->GetTransformValid(transformName, isValid);
 
@@ -215,7 +258,7 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
 
         igtl::TransformMessage::Pointer transformMessage = dynamic_cast<igtl::TransformMessage*>(igtlMessage->Clone().GetPointer());
         vtkPlusIgtlMessageCommon::PackTransformMessage(transformMessage, transformName, igtlMatrix, trackedFrame.GetTimestamp());
-        igtlMessages.push_back(transformMessage.GetPointer());
+        AddPackedMessage(packedMessageCache, cacheKey, transformMessage.GetPointer(), igtlMessages);
       }
     }
     // Tracking data message
@@ -223,16 +266,33 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
     {
       if (clientInfo.TDATARequested && clientInfo.LastTDATASentTimeStamp + clientInfo.Resolution < trackedFrame.GetTimestamp())
       {
-        std::map<std::string, vtkSmartPointer<vtkMatrix4x4> > transforms;
+        std::string cacheKey = cacheKeyPrefix.str();
         for (std::vector<PlusTransformName>::const_iterator transformNameIterator = clientInfo.TransformNames.begin(); transformNameIterator != clientInfo.TransformNames.end(); ++transformNameIterator)
         {
-          PlusTransformName transformName = (*transformNameIterator);
+          cacheKey += transformNameIterator->GetTransformName() + "|";
+        }
+        if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+        {
+          continue;
+        }
+
+        // Get all the transforms at once, so that common parts of the transform paths are computed only once
+        std::vector<vtkSmartPointer<vtkMatrix4x4> > matrices;
+        std::vector<vtkMatrix4x4*> matrixPointers;
+        for (std::size_t i = 0; i < clientInfo.TransformNames.size(); ++i)
+        {
+          matrices.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+          matrixPointers.push_back(matrices.back().GetPointer());
+        }
+        std::vector<bool> transformValid;
+        transformRepository->GetTransforms(clientInfo.TransformNames, matrixPointers, &transformValid);
 
-          bool isValid = false;
-          vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-          transformRepository->GetTransform(transformName, mat, &isValid);
+        std::map<std::string, vtkSmartPointer<vtkMatrix4x4> > transforms;
+        for (std::size_t i = 0; i < clientInfo.TransformNames.size(); ++i)
+        {
+          const PlusTransformName& transformName = clientInfo.TransformNames[i];
 
-          if (!isValid && packValidTransformsOnly)
+          if (!transformValid[i] && packValidTransformsOnly)
           {
             LOG_TRACE("Attempted to send invalid transform over IGT Link when server has prevented sending.");
             continue;
@@ -241,12 +301,12 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
           std::string transformNameStr;
           transformName.GetTransformName(transformNameStr);
 
-          transforms[transformNameStr] = mat;
+          transforms[transformNameStr] = matrices[i];
         }
 
         igtl::TrackingDataMessage::Pointer trackingDataMessage = dynamic_cast<igtl::TrackingDataMessage*>(igtlMessage->Clone().GetPointer());
         vtkPlusIgtlMessageCommon::PackTrackingDataMessage(trackingDataMessage, transforms, trackedFrame.GetTimestamp());
-        igtlMessages.push_back(trackingDataMessage.GetPointer());
+        AddPackedMessage(packedMessageCache, cacheKey, trackingDataMessage.GetPointer(), igtlMessages);
       }
     }
     // Position message
@@ -261,6 +321,12 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
           pushing high frame-rate data from tracking devices.
         */
         PlusTransformName transformName = (*transformNameIterator);
+        std::string cacheKey = cacheKeyPrefix.str() + transformName.GetTransformName();
+        if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+        {
+          continue;
+        }
+
         igtl::Matrix4x4 igtlMatrix;
         vtkPlusIgtlMessageCommon::GetIgtlMatrix(igtlMatrix, transformRepository, transformName);
 
@@ -270,21 +336,43 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
 
         igtl::PositionMessage::Pointer positionMessage = dynamic_cast<igtl::PositionMessage*>(igtlMessage->Clone().GetPointer());
         vtkPlusIgtlMessageCommon::PackPositionMessage(positionMessage, transformName, position, quaternion, trackedFrame.GetTimestamp());
-        igtlMessages.push_back(positionMessage.GetPointer());
+        AddPackedMessage(packedMessageCache, cacheKey, positionMessage.GetPointer(), igtlMessages);
       }
     }
     // TRACKEDFRAME message
     else if (typeid(*igtlMessage) == typeid(igtl::PlusTrackedFrameMessage))
     {
+      std::string cacheKey = cacheKeyPrefix.str() + (clientInfo.TrackedFrameBinaryMetadataSupported ? "binary|" : "xml|");
+      if (!clientInfo.ImageStreams.empty())
+      {
+        cacheKey += clientInfo.ImageStreams[0].Name + "|" + clientInfo.ImageStreams[0].EmbeddedTransformToFrame + "|";
+      }
+      for (std::vector<PlusTransformName>::const_iterator transformNameIterator = clientInfo.TransformNames.begin(); transformNameIterator != clientInfo.TransformNames.end(); ++transformNameIterator)
+      {
+        cacheKey += transformNameIterator->GetTransformName() + "|";
+      }
+      if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+      {
+        continue;
+      }
+
       igtl::PlusTrackedFrameMessage::Pointer trackedFrameMessage = dynamic_cast<igtl::PlusTrackedFrameMessage*>(igtlMessage->Clone().GetPointer());
+      trackedFrameMessage->SetMetadataEncoding(clientInfo.TrackedFrameBinaryMetadataSupported ?
+          igtl::PlusTrackedFrameMessage::METADATA_ENCODING_BINARY : igtl::PlusTrackedFrameMessage::METADATA_ENCODING_XML);
 
-      for (auto nameIter = clientInfo.TransformNames.begin(); nameIter != clientInfo.TransformNames.end(); ++nameIter)
+      std::vector<vtkSmartPointer<vtkMatrix4x4> > matrices;
+      std::vector<vtkMatrix4x4*> matrixPointers;
+      for (std::size_t i = 0; i < clientInfo.TransformNames.size(); ++i)
       {
-        bool isValid(false);
-        vtkSmartPointer<vtkMatrix4x4> matrix(vtkSmartPointer<vtkMatrix4x4>::New());
-        transformRepository->GetTransform(*nameIter, matrix, &isValid);
-        trackedFrame.SetCustomFrameTransform(*nameIter, matrix);
-        trackedFrame.SetCustomFrameTransformStatus(*nameIter, isValid ? FIELD_OK : FIELD_INVALID);
+        matrices.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+        matrixPointers.push_back(matrices.back().GetPointer());
+      }
+      std::vector<bool> transformValid;
+      transformRepository->GetTransforms(clientInfo.TransformNames, matrixPointers, &transformValid);
+      for (std::size_t i = 0; i < clientInfo.TransformNames.size(); ++i)
+      {
+        trackedFrame.SetCustomFrameTransform(clientInfo.TransformNames[i], matrices[i]);
+        trackedFrame.SetCustomFrameTransformStatus(clientInfo.TransformNames[i], transformValid[i] ? FIELD_OK : FIELD_INVALID);
       }
 
       vtkSmartPointer<vtkMatrix4x4> imageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
@@ -304,11 +392,17 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
         numberOfErrors++;
         continue;
       }
-      igtlMessages.push_back(trackedFrameMessage.GetPointer());
+      AddPackedMessage(packedMessageCache, cacheKey, trackedFrameMessage.GetPointer(), igtlMessages);
     }
     // USMESSAGE message
     else if (typeid(*igtlMessage) == typeid(igtl::PlusUsMessage))
     {
+      std::string cacheKey = cacheKeyPrefix.str();
+      if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+      {
+        continue;
+      }
+
       igtl::PlusUsMessage::Pointer usMessage = dynamic_cast<igtl::PlusUsMessage*>(igtlMessage->Clone().GetPointer());
       if (vtkPlusIgtlMessageCommon::PackUsMessage(usMessage, trackedFrame) != PLUS_SUCCESS)
       {
@@ -316,7 +410,7 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
         numberOfErrors++;
         continue;
       }
-      igtlMessages.push_back(usMessage.GetPointer());
+      AddPackedMessage(packedMessageCache, cacheKey, usMessage.GetPointer(), igtlMessages);
     }
     // String message
     else if (typeid(*igtlMessage) == typeid(igtl::StringMessage))
@@ -324,6 +418,12 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
       for (std::vector< std::string >::const_iterator stringNameIterator = clientInfo.StringNames.begin(); stringNameIterator != clientInfo.StringNames.end(); ++stringNameIterator)
       {
         const char* stringName = stringNameIterator->c_str();
+        std::string cacheKey = cacheKeyPrefix.str() + (*stringNameIterator);
+        if (AddCachedMessage(packedMessageCache, cacheKey, igtlMessages))
+        {
+          continue;
+        }
+
         const char* stringValue = trackedFrame.GetCustomFrameField(stringName);
         if (stringValue == NULL)
         {
@@ -332,7 +432,7 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(const PlusIgtlClientInfo& cli
         }
         igtl::StringMessage::Pointer stringMessage = dynamic_cast<igtl::StringMessage*>(igtlMessage->Clone().GetPointer());
         vtkPlusIgtlMessageCommon::PackStringMessage(stringMessage, stringName, stringValue, trackedFrame.GetTimestamp());
-        igtlMessages.push_back(stringMessage.GetPointer());
+        AddPackedMessage(packedMessageCache, cacheKey, stringMessage.GetPointer(), igtlMessages);
       }
     }
     else if (typeid(*igtlMessage) == typeid(igtl::CommandMessage))
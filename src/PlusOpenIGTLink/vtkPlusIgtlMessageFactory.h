@@ -15,6 +15,8 @@
 #include "igtlMessageFactory.h"
 #include "PlusIgtlClientInfo.h" 
 
+#include <map>
+
 class vtkXMLDataElement; 
 class PlusTrackedFrame; 
 class vtkPlusTransformRepository;
@@ -37,6 +39,13 @@ public:
   /*! Function pointer for storing New() static methods of igtl::MessageBase classes */ 
   typedef igtl::MessageBase::Pointer (*PointerToMessageBaseNew)(); 
 
+  /*!
+    Messages that have already been packed from the current tracked frame, keyed by message type, header version and content name.
+    Clients that request the same content share the packed message (encoded buffer and CRC) instead of packing it again.
+    A cache must only be used with one tracked frame and one transform repository state.
+  */
+  typedef std::map<std::string, igtl::MessageBase::Pointer> PackedMessageCacheType;
+
   /*! 
   Get pointer to message type new function, or NULL if the message type not registered 
   Usage: igtl::MessageBase::Pointer message = GetMessageTypeNewPointer("IMAGE")(); 
@@ -70,14 +79,22 @@ public:
   \param igtMessages Output list for the generated IGTL messages
   \param trackedFrame Input tracked frame data used for IGTL message generation 
   \param transformRepository Transform repository used for computing the selected transforms 
+  \param packedMessageCache If not NULL then already packed messages are reused from this cache and newly packed messages are added to it.
+    The transform repository is only updated from the tracked frame when the cache is empty.
   */ 
   PlusStatus PackMessages(const PlusIgtlClientInfo& clientInfo, std::vector<igtl::MessageBase::Pointer>& igtMessages, PlusTrackedFrame& trackedFrame, 
-    bool packValidTransformsOnly, vtkPlusTransformRepository* transformRepository=NULL); 
+    bool packValidTransformsOnly, vtkPlusTransformRepository* transformRepository=NULL, PackedMessageCacheType* packedMessageCache=NULL); 
 
 protected:
   vtkPlusIgtlMessageFactory();
   virtual ~vtkPlusIgtlMessageFactory();
 
+  /*! Add the message stored in the cache with the given key to the message list. Returns false if the message is not found in the cache. */
+  static bool AddCachedMessage(PackedMessageCacheType* packedMessageCache, const std::string& cacheKey, std::vector<igtl::MessageBase::Pointer>& igtlMessages);
+
+  /*! Add the message to the message list and to the cache (if the cache is not NULL) */
+  static void AddPackedMessage(PackedMessageCacheType* packedMessageCache, const std::string& cacheKey, igtl::MessageBase* igtlMessage, std::vector<igtl::MessageBase::Pointer>& igtlMessages);
+
   igtl::MessageFactory::Pointer IgtlFactory;
 
 private:
@@ -243,6 +243,16 @@ void vtkPlusCommand::PopCommandResponses(PlusCommandResponseList& responses)
   responses.splice(responses.end(), this->CommandResponseQueue, this->CommandResponseQueue.begin(), this->CommandResponseQueue.end());
 }
 
+//------------------------------------------------------------------------------
+void vtkPlusCommand::ReportProgress(double fraction)
+{
+  if (this->CommandProcessor == NULL)
+  {
+    return;
+  }
+  this->CommandProcessor->SetCommandProgress(this, fraction);
+}
+
 //------------------------------------------------------------------------------
 void vtkPlusCommand::QueueCommandResponse(PlusStatus status, const std::string& message, const std::string& error, const std::map<std::string, std::string>* values)
 {
@@ -31,6 +31,16 @@ public:
   static const std::string DEVICE_NAME_COMMAND;
   static const std::string DEVICE_NAME_REPLY;
 
+  /*!
+    Lanes of command execution. Commands in the fast lane are executed on a dedicated thread of the command processor,
+    so they are not delayed by long-running commands.
+  */
+  enum ExecutionLaneType
+  {
+    EXECUTION_LANE_FAST,
+    EXECUTION_LANE_DEFAULT
+  };
+
   virtual vtkPlusCommand* Clone() = 0;
 
   virtual void PrintSelf(ostream& os, vtkIndent indent);
@@ -41,6 +51,12 @@ public:
   */
   virtual PlusStatus Execute() = 0;
 
+  /*!
+    Returns the lane where the command is executed. Only commands that complete in a few milliseconds and
+    do not wait for devices should be executed in the fast lane.
+  */
+  virtual ExecutionLaneType GetExecutionLane() { return EXECUTION_LANE_DEFAULT; }
+
   /*! Read command parameters from XML */
   virtual PlusStatus ReadConfiguration(vtkXMLDataElement* aConfig);
 
@@ -133,6 +149,12 @@ protected:
   /*! Check if the command name is in the list of command names */
   PlusStatus ValidateName();
 
+  /*!
+    Report the progress of the command execution. Can be called from Execute() of long-running commands.
+    \param fraction Completed fraction of the command execution, between 0 and 1
+  */
+  void ReportProgress(double fraction);
+
   /*! Helper method to add a command response to the response queue */
   void QueueCommandResponse(PlusStatus status, const std::string& message, const std::string& error = "", const std::map<std::string, std::string>* keyValuePairs = NULL);
 
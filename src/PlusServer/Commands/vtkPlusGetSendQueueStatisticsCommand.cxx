@@ -0,0 +1,137 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "vtkPlusCommandProcessor.h"
+#include "vtkPlusGetSendQueueStatisticsCommand.h"
+#include "vtkPlusOpenIGTLinkServer.h"
+
+vtkStandardNewMacro(vtkPlusGetSendQueueStatisticsCommand);
+
+namespace
+{
+  static const std::string GET_SEND_QUEUE_STATISTICS_CMD = "GetSendQueueStatistics";
+}
+
+//----------------------------------------------------------------------------
+vtkPlusGetSendQueueStatisticsCommand::vtkPlusGetSendQueueStatisticsCommand()
+  : AllClients(false)
+{
+  // It handles only one command, set its name by default
+  this->SetName(GET_SEND_QUEUE_STATISTICS_CMD);
+}
+
+//----------------------------------------------------------------------------
+vtkPlusGetSendQueueStatisticsCommand::~vtkPlusGetSendQueueStatisticsCommand()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusGetSendQueueStatisticsCommand::SetNameToGetSendQueueStatistics()
+{
+  this->SetName(GET_SEND_QUEUE_STATISTICS_CMD);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusGetSendQueueStatisticsCommand::GetCommandNames(std::list<std::string>& cmdNames)
+{
+  cmdNames.clear();
+  cmdNames.push_back(GET_SEND_QUEUE_STATISTICS_CMD);
+}
+
+//----------------------------------------------------------------------------
+std::string vtkPlusGetSendQueueStatisticsCommand::GetDescription(const std::string& commandName)
+{
+  std::string desc;
+  if (commandName.empty() || PlusCommon::IsEqualInsensitive(commandName, GET_SEND_QUEUE_STATISTICS_CMD))
+  {
+    desc += GET_SEND_QUEUE_STATISTICS_CMD;
+    desc += ": Request the send queue length and the number of sent and dropped messages. Attributes: AllClients: if TRUE then statistics of all connected clients are returned (default: FALSE, only the requesting client).";
+  }
+  return desc;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusGetSendQueueStatisticsCommand::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "AllClients: " << (this->AllClients ? "TRUE" : "FALSE") << std::endl;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusGetSendQueueStatisticsCommand::ReadConfiguration(vtkXMLDataElement* aConfig)
+{
+  if (vtkPlusCommand::ReadConfiguration(aConfig) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(AllClients, aConfig);
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusGetSendQueueStatisticsCommand::WriteConfiguration(vtkXMLDataElement* aConfig)
+{
+  if (vtkPlusCommand::WriteConfiguration(aConfig) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  XML_WRITE_BOOL_ATTRIBUTE(AllClients, aConfig);
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusGetSendQueueStatisticsCommand::Execute()
+{
+  vtkPlusOpenIGTLinkServer* server = this->CommandProcessor->GetPlusServer();
+  if (server == NULL)
+  {
+    this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", "No server.");
+    return PLUS_FAIL;
+  }
+
+  std::vector<ClientSendQueueStatistics> statistics;
+  server->GetClientSendQueueStatistics(statistics);
+
+  std::ostringstream responseMessage;
+  std::map<std::string, std::string> keyValuePairs;
+  int numberOfReportedClients = 0;
+  for (std::vector<ClientSendQueueStatistics>::iterator it = statistics.begin(); it != statistics.end(); ++it)
+  {
+    if (!this->AllClients && it->ClientId != this->GetClientId())
+    {
+      continue;
+    }
+
+    // Key: Client<id>, value: semicolon separated list of name=value pairs
+    std::ostringstream clientStatistics;
+    clientStatistics << "QueueLength=" << it->QueueLength
+                     << ";PeakQueueLength=" << it->PeakQueueLength
+                     << ";MaxQueueLength=" << it->MaxQueueLength
+                     << ";DropPolicy=" << PlusIgtlClientInfo::GetSendQueueDropPolicyAsString(it->DropPolicy)
+                     << ";SentMessages=" << it->NumberOfSentMessages
+                     << ";DroppedMessages=" << it->NumberOfDroppedMessages;
+    std::ostringstream key;
+    key << "Client" << it->ClientId;
+    keyValuePairs[key.str()] = clientStatistics.str();
+
+    if (numberOfReportedClients > 0)
+    {
+      responseMessage << ", ";
+    }
+    responseMessage << key.str() << ": " << clientStatistics.str();
+    numberOfReportedClients++;
+  }
+
+  if (numberOfReportedClients == 0)
+  {
+    this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", "No matching client found.");
+    return PLUS_FAIL;
+  }
+
+  this->QueueCommandResponse(PLUS_SUCCESS, responseMessage.str(), "", &keyValuePairs);
+  return PLUS_SUCCESS;
+}
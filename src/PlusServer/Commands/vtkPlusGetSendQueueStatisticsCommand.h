@@ -0,0 +1,64 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusGetSendQueueStatisticsCommand_h
+#define __vtkPlusGetSendQueueStatisticsCommand_h
+
+#include "vtkPlusServerExport.h"
+
+#include "vtkPlusCommand.h"
+
+/*!
+  \class vtkPlusGetSendQueueStatisticsCommand
+  \brief This command returns the send queue length and the number of sent and dropped messages of the connected clients
+  \ingroup PlusLibPlusServer
+ */
+class vtkPlusServerExport vtkPlusGetSendQueueStatisticsCommand : public vtkPlusCommand
+{
+public:
+
+  static vtkPlusGetSendQueueStatisticsCommand* New();
+  vtkTypeMacro(vtkPlusGetSendQueueStatisticsCommand, vtkPlusCommand);
+  virtual void PrintSelf(ostream& os, vtkIndent indent);
+  virtual vtkPlusCommand* Clone() { return New(); }
+
+  /*! Executes the command  */
+  virtual PlusStatus Execute();
+
+  /*! Only reads the send queue counters, so it is executed in the fast lane */
+  virtual ExecutionLaneType GetExecutionLane() { return EXECUTION_LANE_FAST; }
+
+  /*! Get all the command names that this class can execute */
+  virtual void GetCommandNames(std::list<std::string>& cmdNames);
+
+  /*! Gets the description for the specified command name. */
+  virtual std::string GetDescription(const std::string& commandName);
+
+  void SetNameToGetSendQueueStatistics();
+
+  /*! Read command parameters from XML */
+  virtual PlusStatus ReadConfiguration(vtkXMLDataElement* aConfig);
+
+  /*! Write command parameters to XML */
+  virtual PlusStatus WriteConfiguration(vtkXMLDataElement* aConfig);
+
+  /*! If true then statistics of all connected clients are returned, otherwise only the statistics of the requesting client */
+  vtkGetMacro(AllClients, bool);
+  vtkSetMacro(AllClients, bool);
+  vtkBooleanMacro(AllClients, bool);
+
+protected:
+  vtkPlusGetSendQueueStatisticsCommand();
+  virtual ~vtkPlusGetSendQueueStatisticsCommand();
+
+  bool AllClients;
+
+private:
+  vtkPlusGetSendQueueStatisticsCommand(const vtkPlusGetSendQueueStatisticsCommand&);
+  void operator=(const vtkPlusGetSendQueueStatisticsCommand&);
+};
+
+#endif
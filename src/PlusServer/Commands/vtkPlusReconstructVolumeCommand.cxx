@@ -265,6 +265,7 @@ PlusStatus vtkPlusReconstructVolumeCommand::Execute()
       return PLUS_FAIL;
     }
     reconstructorDevice->Reset(); // Clear volume
+    this->ReportProgress(0.0);
     vtkSmartPointer<vtkImageData> volumeToSend = vtkSmartPointer<vtkImageData>::New();
     std::string errorMessage;
     if (reconstructorDevice->GetReconstructedVolumeFromFile(this->InputSeqFilename, volumeToSend, errorMessage) != PLUS_SUCCESS)
@@ -272,6 +273,8 @@ PlusStatus vtkPlusReconstructVolumeCommand::Execute()
       this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", baseMessage + " Reconstruction from sequence file failed: " + errorMessage);
       return PLUS_FAIL;
     }
+    // Volume is reconstructed, it is saved and/or sent now
+    this->ReportProgress(0.8);
     std::string statusMessage;
     PlusStatus status = ProcessImageReply(volumeToSend, outputVolFilename, outputVolDeviceName, statusMessage);
     this->QueueCommandResponse(status, std::string("Command ") + std::string((status == PLUS_SUCCESS ? "succeeded." : "failed. See error message.")), baseMessage + " Reconstruction from sequence file completed: " + statusMessage);
@@ -306,6 +309,7 @@ PlusStatus vtkPlusReconstructVolumeCommand::Execute()
 
     LOG_INFO("Volume reconstruction from live frames stopping, device: " << reconstructorDeviceId);
     reconstructorDevice->SetEnableReconstruction(false);
+    this->ReportProgress(0.0);
     vtkSmartPointer<vtkImageData> volumeToSend = vtkSmartPointer<vtkImageData>::New();
     std::string errorMessage;
     if (reconstructorDevice->GetReconstructedVolume(volumeToSend, errorMessage) != PLUS_SUCCESS)
@@ -314,6 +318,8 @@ PlusStatus vtkPlusReconstructVolumeCommand::Execute()
       return PLUS_FAIL;
     }
     reconstructorDevice->Reset(); // Clear volume
+    // Volume is reconstructed, it is saved and/or sent now
+    this->ReportProgress(0.8);
     std::string statusMessage;
     PlusStatus status = ProcessImageReply(volumeToSend, outputVolFilename, outputVolDeviceName, statusMessage);
     this->QueueCommandResponse(status, std::string("Command ") + std::string((status == PLUS_SUCCESS ? "succeeded." : "failed. See error message.")), baseMessage + " Reconstruction from live frames completed: " + statusMessage);
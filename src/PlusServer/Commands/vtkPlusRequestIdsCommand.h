@@ -28,6 +28,9 @@ public:
   /*! Executes the command  */
   virtual PlusStatus Execute();
 
+  /*! Only lists the devices and channels, so it is executed in the fast lane */
+  virtual ExecutionLaneType GetExecutionLane() { return EXECUTION_LANE_FAST; }
+
   /*! Get all the command names that this class can execute */
   virtual void GetCommandNames(std::list<std::string>& cmdNames);
 
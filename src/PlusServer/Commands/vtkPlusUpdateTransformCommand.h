@@ -29,6 +29,9 @@ public:
   /*! Executes the command  */
   virtual PlusStatus Execute();
 
+  /*! Only updates the transform repository, so it is executed in the fast lane */
+  virtual ExecutionLaneType GetExecutionLane() { return EXECUTION_LANE_FAST; }
+
   /*! Read command parameters from XML */
   virtual PlusStatus ReadConfiguration(vtkXMLDataElement* aConfig);
 
@@ -27,6 +27,9 @@ public:
   /*! Executes the command  */
   virtual PlusStatus Execute();
 
+  /*! Executed in the fast lane, as it only returns the protocol version */
+  virtual ExecutionLaneType GetExecutionLane() { return EXECUTION_LANE_FAST; }
+
   /*! Get all the command names that this class can execute */
   virtual void GetCommandNames(std::list<std::string>& cmdNames);
 
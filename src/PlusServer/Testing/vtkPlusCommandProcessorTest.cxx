@@ -0,0 +1,483 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusCommandProcessorTest.cxx
+  \brief Tests the command execution lanes of vtkPlusCommandProcessor with mock commands
+
+  - Default lane commands of a client are executed in the order they were received, while the commands
+    of other clients are executed in parallel.
+  - A default lane command is not started before the fast commands that were received earlier are completed.
+  - Fast commands are executed while a long default lane command is running.
+  - Stop() waits for the running commands and stops all the execution threads. Commands that are still queued
+    are not lost, they can be executed by ExecuteCommands().
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusCommand.h"
+#include "vtkPlusCommandProcessor.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  /*! Executed in the default lane, completes immediately */
+  const std::string MOCK_DEFAULT_CMD = "MockDefault";
+  /*! Executed in the default lane, runs until the long commands are released */
+  const std::string MOCK_LONG_CMD = "MockLong";
+  /*! Executed in the fast lane, completes immediately */
+  const std::string MOCK_FAST_CMD = "MockFast";
+  /*! Executed in the fast lane, runs until the long commands are released */
+  const std::string MOCK_FAST_LONG_CMD = "MockFastLong";
+
+  const int NUMBER_OF_COMMAND_EXECUTION_THREADS = 3;
+  /*! Time after which a command is considered blocked */
+  const double BLOCKING_DETECTION_TIME_SEC = 0.5;
+
+  /*! Execution of a mock command */
+  struct ExecutionRecord
+  {
+    std::string Name;
+    unsigned int ClientId;
+    uint32_t Id;
+    bool Completed;
+  };
+
+  /*! Records the execution of the mock commands, in the order they were started */
+  class ExecutionLog
+  {
+  public:
+    /*! Returns the index of the new record */
+    int Started(const std::string& name, unsigned int clientId, uint32_t id)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      ExecutionRecord record;
+      record.Name = name;
+      record.ClientId = clientId;
+      record.Id = id;
+      record.Completed = false;
+      this->Records.push_back(record);
+      return static_cast<int>(this->Records.size()) - 1;
+    }
+    void Completed(int recordIndex)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Records[recordIndex].Completed = true;
+    }
+    std::vector<ExecutionRecord> GetRecords()
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      return this->Records;
+    }
+    void Clear()
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Records.clear();
+    }
+    /*! Returns true if the command has been started. If completed is not NULL then it is set to true if the command has been completed. */
+    bool IsStarted(unsigned int clientId, uint32_t id, bool* completed = NULL)
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      for (std::vector<ExecutionRecord>::iterator it = this->Records.begin(); it != this->Records.end(); ++it)
+      {
+        if (it->ClientId == clientId && it->Id == id)
+        {
+          if (completed != NULL)
+          {
+            *completed = it->Completed;
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+    bool IsCompleted(unsigned int clientId, uint32_t id)
+    {
+      bool completed(false);
+      return this->IsStarted(clientId, id, &completed) && completed;
+    }
+  private:
+    std::mutex Mutex;
+    std::vector<ExecutionRecord> Records;
+  };
+
+  ExecutionLog MockExecutionLog;
+  /*! The long mock commands run while this flag is set */
+  std::atomic<bool> LongCommandsBlocked(false);
+}
+
+//----------------------------------------------------------------------------
+/*! Command that records its execution. The lane and the duration of the execution depend on the command name. */
+class vtkPlusMockCommand : public vtkPlusCommand
+{
+public:
+  static vtkPlusMockCommand* New();
+  vtkTypeMacro(vtkPlusMockCommand, vtkPlusCommand);
+  virtual vtkPlusCommand* Clone() { return New(); }
+
+  virtual PlusStatus Execute()
+  {
+    int recordIndex = MockExecutionLog.Started(this->GetName(), this->GetClientId(), this->GetId());
+    if (this->GetName() == MOCK_LONG_CMD || this->GetName() == MOCK_FAST_LONG_CMD)
+    {
+      while (LongCommandsBlocked)
+      {
+        vtkPlusAccurateTimer::Delay(0.001);
+      }
+    }
+    MockExecutionLog.Completed(recordIndex);
+    this->QueueCommandResponse(PLUS_SUCCESS, "Success.");
+    return PLUS_SUCCESS;
+  }
+
+  virtual ExecutionLaneType GetExecutionLane()
+  {
+    return (this->GetName() == MOCK_FAST_CMD || this->GetName() == MOCK_FAST_LONG_CMD) ? EXECUTION_LANE_FAST : EXECUTION_LANE_DEFAULT;
+  }
+
+  virtual void GetCommandNames(std::list<std::string>& cmdNames)
+  {
+    cmdNames.clear();
+    cmdNames.push_back(MOCK_DEFAULT_CMD);
+    cmdNames.push_back(MOCK_LONG_CMD);
+    cmdNames.push_back(MOCK_FAST_CMD);
+    cmdNames.push_back(MOCK_FAST_LONG_CMD);
+  }
+
+  virtual std::string GetDescription(const std::string& commandName)
+  {
+    return "Mock command for testing the command processor";
+  }
+
+protected:
+  vtkPlusMockCommand() {}
+};
+
+vtkStandardNewMacro(vtkPlusMockCommand);
+
+//----------------------------------------------------------------------------
+PlusStatus QueueMockCommand(vtkPlusCommandProcessor* processor, const std::string& commandName, unsigned int clientId, uint32_t id)
+{
+  std::ostringstream commandStr;
+  commandStr << "<Command Name=\"" << commandName << "\" />";
+  return processor->QueueCommand(true, clientId, commandName, commandStr.str(), "CMD_" + PlusCommon::ToString<uint32_t>(id), id);
+}
+
+//----------------------------------------------------------------------------
+/*! Create a command processor that can execute the mock commands and start its execution threads */
+vtkSmartPointer<vtkPlusCommandProcessor> StartMockCommandProcessor()
+{
+  MockExecutionLog.Clear();
+  LongCommandsBlocked = false;
+  vtkSmartPointer<vtkPlusCommandProcessor> processor = vtkSmartPointer<vtkPlusCommandProcessor>::New();
+  processor->RegisterPlusCommand(vtkSmartPointer<vtkPlusMockCommand>::New());
+  processor->SetNumberOfCommandExecutionThreads(NUMBER_OF_COMMAND_EXECUTION_THREADS);
+  if (processor->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start command processor");
+  }
+  return processor;
+}
+
+//----------------------------------------------------------------------------
+/*! Release the long commands and stop the processor. Returns the number of failures. */
+int StopMockCommandProcessor(vtkPlusCommandProcessor* processor, int expectedNumberOfResponses)
+{
+  int numberOfFailures = 0;
+  LongCommandsBlocked = false;
+  if (processor->Stop() != PLUS_SUCCESS || processor->IsRunning())
+  {
+    LOG_ERROR("Failed to stop command processor");
+    numberOfFailures++;
+  }
+  PlusCommandResponseList responses;
+  processor->PopCommandResponses(responses);
+  if (static_cast<int>(responses.size()) != expectedNumberOfResponses)
+  {
+    LOG_ERROR("Received " << responses.size() << " command responses, expected " << expectedNumberOfResponses);
+    numberOfFailures++;
+  }
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Default lane commands of a client are executed in order, commands of other clients are not blocked by them */
+int TestClientCommandOrder()
+{
+  LOG_INFO("Test command order of clients");
+  int numberOfFailures = 0;
+  vtkSmartPointer<vtkPlusCommandProcessor> processor = StartMockCommandProcessor();
+  const unsigned int blockedClientId = 1;
+  const unsigned int otherClientId = 2;
+  const uint32_t numberOfCommandsPerClient = 5;
+
+  // The first command of the blocked client runs until it is released
+  LongCommandsBlocked = true;
+  QueueMockCommand(processor, MOCK_LONG_CMD, blockedClientId, 0);
+  for (uint32_t id = 1; id < numberOfCommandsPerClient; id++)
+  {
+    QueueMockCommand(processor, MOCK_DEFAULT_CMD, blockedClientId, id);
+    QueueMockCommand(processor, MOCK_DEFAULT_CMD, otherClientId, id);
+  }
+
+  // The other client's commands are executed meanwhile
+  if (!PlusTesting::WaitForCondition([=]() { return MockExecutionLog.IsCompleted(otherClientId, numberOfCommandsPerClient - 1); }))
+  {
+    LOG_ERROR("Commands of a client are blocked by a long command of another client");
+    numberOfFailures++;
+  }
+  vtkPlusAccurateTimer::Delay(BLOCKING_DETECTION_TIME_SEC);
+  if (MockExecutionLog.IsStarted(blockedClientId, 1))
+  {
+    LOG_ERROR("Command of a client started before its previous command was completed");
+    numberOfFailures++;
+  }
+
+  LongCommandsBlocked = false;
+  if (!PlusTesting::WaitForCondition([=]() { return MockExecutionLog.IsCompleted(blockedClientId, numberOfCommandsPerClient - 1); }))
+  {
+    LOG_ERROR("Commands of the blocked client are not executed after its long command is completed");
+    numberOfFailures++;
+  }
+
+  // Each client's commands are started in the order they were received
+  std::vector<ExecutionRecord> records = MockExecutionLog.GetRecords();
+  unsigned int clientIds[2] = { blockedClientId, otherClientId };
+  for (int clientIndex = 0; clientIndex < 2; clientIndex++)
+  {
+    uint32_t expectedId = (clientIds[clientIndex] == blockedClientId ? 0 : 1);
+    for (std::vector<ExecutionRecord>::iterator it = records.begin(); it != records.end(); ++it)
+    {
+      if (it->ClientId != clientIds[clientIndex])
+      {
+        continue;
+      }
+      if (it->Id != expectedId)
+      {
+        LOG_ERROR("Command " << it->Id << " of client " << it->ClientId << " is executed out of order, expected command " << expectedId);
+        numberOfFailures++;
+      }
+      expectedId = it->Id + 1;
+    }
+    if (expectedId != numberOfCommandsPerClient)
+    {
+      LOG_ERROR("Not all the commands of client " << clientIds[clientIndex] << " are executed");
+      numberOfFailures++;
+    }
+  }
+
+  numberOfFailures += StopMockCommandProcessor(processor, 2 * numberOfCommandsPerClient - 1);
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! A default lane command waits for the fast commands that were received before it */
+int TestDefaultCommandWaitsForEarlierFastCommands()
+{
+  LOG_INFO("Test that default lane commands wait for earlier fast commands");
+  int numberOfFailures = 0;
+  vtkSmartPointer<vtkPlusCommandProcessor> processor = StartMockCommandProcessor();
+
+  LongCommandsBlocked = true;
+  QueueMockCommand(processor, MOCK_FAST_LONG_CMD, 1, 0);
+  // Commands of another client, so only the ordering between the lanes can delay them
+  QueueMockCommand(processor, MOCK_DEFAULT_CMD, 2, 1);
+  QueueMockCommand(processor, MOCK_DEFAULT_CMD, 3, 2);
+  if (!PlusTesting::WaitForCondition([]() { return MockExecutionLog.IsStarted(1, 0); }))
+  {
+    LOG_ERROR("Fast command is not started");
+    numberOfFailures++;
+  }
+  vtkPlusAccurateTimer::Delay(BLOCKING_DETECTION_TIME_SEC);
+  if (MockExecutionLog.IsStarted(2, 1) || MockExecutionLog.IsStarted(3, 2))
+  {
+    LOG_ERROR("Default lane command started before an earlier fast command was completed");
+    numberOfFailures++;
+  }
+
+  LongCommandsBlocked = false;
+  if (!PlusTesting::WaitForCondition([]() { return MockExecutionLog.IsCompleted(2, 1) && MockExecutionLog.IsCompleted(3, 2); }))
+  {
+    LOG_ERROR("Default lane commands are not executed after the earlier fast command is completed");
+    numberOfFailures++;
+  }
+
+  numberOfFailures += StopMockCommandProcessor(processor, 3);
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+/*! Fast commands are executed while a long default lane command is running */
+int TestFastCommandsNotBlockedByLongCommand()
+{
+  LOG_INFO("Test that fast commands are not blocked by a long command");
+  int numberOfFailures = 0;
+  vtkSmartPointer<vtkPlusCommandProcessor> processor = StartMockCommandProcessor();
+  const uint32_t numberOfFastCommands = 10;
+
+  LongCommandsBlocked = true;
+  QueueMockCommand(processor, MOCK_LONG_CMD, 1, 0);
+  if (!PlusTesting::WaitForCondition([]() { return MockExecutionLog.IsStarted(1, 0); }))
+  {
+    LOG_ERROR("Long command is not started");
+    numberOfFailures++;
+  }
+  // Fast commands of the same and of another client
+  for (uint32_t id = 1; id <= numberOfFastCommands; id++)
+  {
+    QueueMockCommand(processor, MOCK_FAST_CMD, 1 + id % 2, id);
+  }
+  if (!PlusTesting::WaitForCondition([=]() { return MockExecutionLog.IsCompleted(1 + numberOfFastCommands % 2, numberOfFastCommands); }))
+  {
+    LOG_ERROR("Fast commands are blocked by a long command");
+    numberOfFailures++;
+  }
+
+  // The last fast command is removed from the running commands right after its execution
+  std::vector<vtkPlusCommandProcessor::CommandExecutionStatus> runningCommands;
+  if (!PlusTesting::WaitForCondition([&]() { processor->GetRunningCommands(runningCommands); return runningCommands.size() == 1; })
+      || runningCommands[0].CommandName != MOCK_LONG_CMD || runningCommands[0].Lane != vtkPlusCommand::EXECUTION_LANE_DEFAULT)
+  {
+    LOG_ERROR("Only the long command is expected to be running, found " << runningCommands.size() << " running commands");
+    numberOfFailures++;
+  }
+  if (MockExecutionLog.IsCompleted(1, 0))
+  {
+    LOG_ERROR("Long command completed before it was released");
+    numberOfFailures++;
+  }
+
+  numberOfFailures += StopMockCommandProcessor(processor, numberOfFastCommands + 1);
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+void* ReleaseLongCommandsThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusAccurateTimer::Delay(BLOCKING_DETECTION_TIME_SEC);
+  LongCommandsBlocked = false;
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+/*! Stop() waits for the running command, stops all the threads and keeps the queued commands */
+int TestStop()
+{
+  LOG_INFO("Test stopping the command processor");
+  int numberOfFailures = 0;
+  vtkSmartPointer<vtkPlusCommandProcessor> processor = StartMockCommandProcessor();
+
+  LongCommandsBlocked = true;
+  QueueMockCommand(processor, MOCK_LONG_CMD, 1, 0);
+  // Waits for the long command of the same client
+  QueueMockCommand(processor, MOCK_DEFAULT_CMD, 1, 1);
+  if (!PlusTesting::WaitForCondition([]() { return MockExecutionLog.IsStarted(1, 0); }))
+  {
+    LOG_ERROR("Long command is not started");
+    numberOfFailures++;
+  }
+
+  // The long command is released by another thread while Stop is waiting for it
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  int releaseThreadId = threader->SpawnThread((vtkThreadFunctionType)&ReleaseLongCommandsThread, NULL);
+  if (processor->Stop() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to stop command processor");
+    numberOfFailures++;
+  }
+  threader->TerminateThread(releaseThreadId);
+  if (!MockExecutionLog.IsCompleted(1, 0))
+  {
+    LOG_ERROR("Stop returned before the running command was completed");
+    numberOfFailures++;
+  }
+  if (processor->IsRunning())
+  {
+    LOG_ERROR("Command execution threads are running after Stop");
+    numberOfFailures++;
+  }
+  if (MockExecutionLog.IsStarted(1, 1))
+  {
+    LOG_ERROR("Queued command is executed by Stop");
+    numberOfFailures++;
+  }
+
+  // Without execution threads all the commands are executed by ExecuteCommands
+  QueueMockCommand(processor, MOCK_FAST_CMD, 2, 2);
+  int numberOfExecutedCommands = processor->ExecuteCommands();
+  if (numberOfExecutedCommands != 2 || !MockExecutionLog.IsCompleted(1, 1) || !MockExecutionLog.IsCompleted(2, 2))
+  {
+    LOG_ERROR("Queued commands are not executed by ExecuteCommands after Stop, executed " << numberOfExecutedCommands << " commands");
+    numberOfFailures++;
+  }
+
+  // The processor can be restarted
+  if (processor->Start() != PLUS_SUCCESS || !processor->IsRunning())
+  {
+    LOG_ERROR("Failed to restart command processor");
+    numberOfFailures++;
+  }
+  QueueMockCommand(processor, MOCK_DEFAULT_CMD, 1, 3);
+  if (!PlusTesting::WaitForCondition([]() { return MockExecutionLog.IsCompleted(1, 3); }))
+  {
+    LOG_ERROR("Command is not executed after the command processor is restarted");
+    numberOfFailures++;
+  }
+
+  numberOfFailures += StopMockCommandProcessor(processor, 4);
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = 0;
+  numberOfFailures += TestClientCommandOrder();
+  numberOfFailures += TestDefaultCommandWaitsForEarlierFastCommands();
+  numberOfFailures += TestFastCommandsNotBlockedByLongCommand();
+  numberOfFailures += TestStop();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("vtkPlusCommandProcessorTest failed with " << numberOfFailures << " failures");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("vtkPlusCommandProcessorTest completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,325 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusOpenIGTLinkServerSendQueueTest.cxx
+  \brief Tests the per-client send queue of the OpenIGTLink server
+
+  - Droppable messages are limited to SendQueueMaxLength, the oldest droppable message is discarded first.
+  - DropOldestImage only discards image messages, DropOldest discards data messages of any type.
+  - Messages that must not be dropped are queued beyond SendQueueMaxLength, but a client that does not receive them
+    at all is reported as stalled, so that the server disconnects it.
+  - Sent, dropped and peak counts are reported in the queue statistics.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusIgtlClientInfo.h"
+#include "vtkPlusOpenIGTLinkServer.h"
+
+// VTK includes
+#include <vtksys/CommandLineArguments.hxx>
+
+// OpenIGTLink includes
+#include <igtlImageMessage.h>
+#include <igtlStatusMessage.h>
+#include <igtlTransformMessage.h>
+
+// STL includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  igtl::MessageBase::Pointer CreateMessage(const std::string& messageType, const std::string& deviceName)
+  {
+    igtl::MessageBase::Pointer message;
+    if (messageType == "IMAGE")
+    {
+      message = igtl::ImageMessage::New().GetPointer();
+    }
+    else if (messageType == "TRANSFORM")
+    {
+      message = igtl::TransformMessage::New().GetPointer();
+    }
+    else
+    {
+      message = igtl::StatusMessage::New().GetPointer();
+    }
+    message->SetDeviceName(deviceName.c_str());
+    return message;
+  }
+
+  //----------------------------------------------------------------------------
+  // Queue a data message the same way as the server does when it sends a tracked frame to the client
+  PlusStatus QueueDataMessage(ClientSendQueue& queue, const PlusIgtlClientInfo& clientInfo, const std::string& messageType, const std::string& deviceName)
+  {
+    igtl::MessageBase::Pointer message = CreateMessage(messageType, deviceName);
+    return queue.QueueMessage(message, clientInfo.IsMessageDroppable(message->GetMessageType()), clientInfo.SendQueueMaxLength);
+  }
+
+  //----------------------------------------------------------------------------
+  // Queue a message that must not be dropped (command reply or status message)
+  PlusStatus QueueReplyMessage(ClientSendQueue& queue, const PlusIgtlClientInfo& clientInfo, const std::string& deviceName)
+  {
+    return queue.QueueMessage(CreateMessage("STATUS", deviceName), false, clientInfo.SendQueueMaxLength);
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns the device names of the queued messages, separated by spaces
+  std::string GetQueuedDeviceNames(ClientSendQueue& queue)
+  {
+    std::lock_guard<std::mutex> queueLock(queue.Mutex);
+    std::ostringstream names;
+    for (std::deque<ClientSendQueue::QueuedMessage>::iterator it = queue.Messages.begin(); it != queue.Messages.end(); ++it)
+    {
+      if (it != queue.Messages.begin())
+      {
+        names << " ";
+      }
+      names << it->Message->GetDeviceName();
+    }
+    return names.str();
+  }
+
+  //----------------------------------------------------------------------------
+  int CheckQueuedDeviceNames(ClientSendQueue& queue, const std::string& expectedNames, const std::string& testCase)
+  {
+    std::string names = GetQueuedDeviceNames(queue);
+    if (names != expectedNames)
+    {
+      LOG_ERROR(testCase << ": unexpected queued messages: [" << names << "], expected: [" << expectedNames << "]");
+      return 1;
+    }
+    return 0;
+  }
+
+  //----------------------------------------------------------------------------
+  int CheckStatistics(ClientSendQueue& queue, unsigned int expectedLength, unsigned int expectedPeakLength,
+                      unsigned long expectedSent, unsigned long expectedDropped, const std::string& testCase)
+  {
+    ClientSendQueueStatistics statistics;
+    queue.GetStatistics(statistics);
+    if (statistics.QueueLength != expectedLength || statistics.PeakQueueLength != expectedPeakLength
+        || statistics.NumberOfSentMessages != expectedSent || statistics.NumberOfDroppedMessages != expectedDropped)
+    {
+      LOG_ERROR(testCase << ": unexpected statistics: length=" << statistics.QueueLength << " (expected " << expectedLength << ")"
+                << ", peak=" << statistics.PeakQueueLength << " (expected " << expectedPeakLength << ")"
+                << ", sent=" << statistics.NumberOfSentMessages << " (expected " << expectedSent << ")"
+                << ", dropped=" << statistics.NumberOfDroppedMessages << " (expected " << expectedDropped << ")");
+      return 1;
+    }
+    return 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// If the queue is full then the oldest droppable message is discarded
+int TestQueueLimit()
+{
+  int numberOfFailures = 0;
+  PlusIgtlClientInfo clientInfo;
+  clientInfo.SendQueueMaxLength = 3;
+  clientInfo.SendQueueDropPolicy = PlusIgtlClientInfo::DROP_OLDEST;
+
+  ClientSendQueue queue;
+  for (int i = 1; i <= 5; i++)
+  {
+    std::ostringstream deviceName;
+    deviceName << "Image" << i;
+    if (QueueDataMessage(queue, clientInfo, "IMAGE", deviceName.str()) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to queue message " << deviceName.str());
+      numberOfFailures++;
+    }
+  }
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Image3 Image4 Image5", "Queue limit");
+  numberOfFailures += CheckStatistics(queue, 3, 3, 0, 2, "Queue limit");
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+// Tracking data is never dropped with the DropOldestImage policy
+int TestDropOldestImagePolicy()
+{
+  int numberOfFailures = 0;
+  PlusIgtlClientInfo clientInfo;
+  clientInfo.SendQueueMaxLength = 3;
+  clientInfo.SendQueueDropPolicy = PlusIgtlClientInfo::DROP_OLDEST_IMAGE;
+
+  ClientSendQueue queue;
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform1");
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image1");
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform2");
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image2");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Transform1 Transform2 Image2", "DropOldestImage, image replaces image");
+
+  // Transforms are queued beyond the maximum length
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform3");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Transform1 Transform2 Image2 Transform3", "DropOldestImage, transform exceeds the limit");
+
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image3");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Transform1 Transform2 Transform3 Image3", "DropOldestImage, oldest image is dropped");
+  numberOfFailures += CheckStatistics(queue, 4, 4, 0, 2, "DropOldestImage");
+
+  // If only messages that must not be dropped are waiting then the new image is discarded
+  clientInfo.SendQueueMaxLength = 2;
+  ClientSendQueue trackingOnlyQueue;
+  QueueDataMessage(trackingOnlyQueue, clientInfo, "TRANSFORM", "Transform1");
+  QueueDataMessage(trackingOnlyQueue, clientInfo, "TRANSFORM", "Transform2");
+  if (QueueDataMessage(trackingOnlyQueue, clientInfo, "IMAGE", "Image1") != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Discarding a new image must not be reported as a failure");
+    numberOfFailures++;
+  }
+  numberOfFailures += CheckQueuedDeviceNames(trackingOnlyQueue, "Transform1 Transform2", "DropOldestImage, new image is dropped");
+  numberOfFailures += CheckStatistics(trackingOnlyQueue, 2, 2, 0, 1, "DropOldestImage, new image is dropped");
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+// Data messages of any type are dropped with the DropOldest policy, replies are never dropped
+int TestDropOldestPolicy()
+{
+  int numberOfFailures = 0;
+  PlusIgtlClientInfo clientInfo;
+  clientInfo.SendQueueMaxLength = 2;
+  clientInfo.SendQueueDropPolicy = PlusIgtlClientInfo::DROP_OLDEST;
+
+  ClientSendQueue queue;
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform1");
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image1");
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform2");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Image1 Transform2", "DropOldest, transform is dropped");
+
+  QueueReplyMessage(queue, clientInfo, "Reply1");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Image1 Transform2 Reply1", "DropOldest, reply exceeds the limit");
+
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform3");
+  QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform4");
+  numberOfFailures += CheckQueuedDeviceNames(queue, "Reply1 Transform3 Transform4", "DropOldest, reply is kept");
+  numberOfFailures += CheckStatistics(queue, 3, 3, 0, 3, "DropOldest");
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+// A client that does not receive the messages that must not be dropped is reported as stalled
+int TestStalledClient()
+{
+  int numberOfFailures = 0;
+  PlusIgtlClientInfo clientInfo;
+  clientInfo.SendQueueMaxLength = 2;
+  clientInfo.SendQueueDropPolicy = PlusIgtlClientInfo::DROP_OLDEST_IMAGE;
+
+  ClientSendQueue queue;
+  const int maxNumberOfQueuedMessages = clientInfo.SendQueueMaxLength + ClientSendQueue::STALLED_CLIENT_EXTRA_QUEUE_LENGTH;
+  int numberOfQueuedMessages = 0;
+  while (numberOfQueuedMessages <= maxNumberOfQueuedMessages
+         && QueueDataMessage(queue, clientInfo, "TRANSFORM", "Transform") == PLUS_SUCCESS)
+  {
+    numberOfQueuedMessages++;
+  }
+  if (numberOfQueuedMessages != maxNumberOfQueuedMessages)
+  {
+    LOG_ERROR("Stalled client: " << numberOfQueuedMessages << " messages were queued before the client was reported stalled, expected " << maxNumberOfQueuedMessages);
+    numberOfFailures++;
+  }
+  numberOfFailures += CheckStatistics(queue, 0, maxNumberOfQueuedMessages, 0, 0, "Stalled client");
+
+  // The client is going to be disconnected, no more messages are accepted
+  if (QueueDataMessage(queue, clientInfo, "IMAGE", "Image1") == PLUS_SUCCESS || QueueReplyMessage(queue, clientInfo, "Reply1") == PLUS_SUCCESS)
+  {
+    LOG_ERROR("Stalled client: messages are still accepted");
+    numberOfFailures++;
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+// Messages are taken from the queue in order, sent messages are counted and a failed send stops the queue
+int TestSendResult()
+{
+  int numberOfFailures = 0;
+  PlusIgtlClientInfo clientInfo;
+  clientInfo.SendQueueMaxLength = 0;
+
+  ClientSendQueue queue;
+  igtl::MessageBase::Pointer message;
+  if (queue.WaitForMessage(message, 10))
+  {
+    LOG_ERROR("Send result: a message was returned from an empty queue");
+    numberOfFailures++;
+  }
+
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image1");
+  QueueDataMessage(queue, clientInfo, "IMAGE", "Image2");
+  QueueReplyMessage(queue, clientInfo, "Reply1");
+  for (int i = 1; i <= 2; i++)
+  {
+    std::ostringstream expectedDeviceName;
+    expectedDeviceName << "Image" << i;
+    if (!queue.WaitForMessage(message, 10) || expectedDeviceName.str() != message->GetDeviceName())
+    {
+      LOG_ERROR("Send result: " << expectedDeviceName.str() << " is expected to be taken from the queue");
+      numberOfFailures++;
+    }
+    queue.ReportSendResult(true);
+  }
+  numberOfFailures += CheckStatistics(queue, 1, 3, 2, 0, "Send result");
+
+  queue.ReportSendResult(false);
+  numberOfFailures += CheckStatistics(queue, 0, 3, 2, 0, "Send result, failed");
+  if (QueueReplyMessage(queue, clientInfo, "Reply2") == PLUS_SUCCESS)
+  {
+    LOG_ERROR("Send result: messages are still accepted after sending failed");
+    numberOfFailures++;
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = 0;
+  numberOfFailures += TestQueueLimit();
+  numberOfFailures += TestDropOldestImagePolicy();
+  numberOfFailures += TestDropOldestPolicy();
+  numberOfFailures += TestStalledClient();
+  numberOfFailures += TestSendResult();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("vtkPlusOpenIGTLinkServerSendQueueTest failed with " << numberOfFailures << " failures");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("vtkPlusOpenIGTLinkServerSendQueueTest completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -44,6 +44,7 @@ int main(int argc, char** argv)
   std::string testingConfigFileName;
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
   double runTimeSec = 0.0;
+  bool asyncLogging(false);
 
   const int numOfTestClientsToConnect = 5; // only if testing is enabled S
 
@@ -54,6 +55,7 @@ int main(int argc, char** argv)
   args.AddArgument("--config-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputConfigFileName, "Name of the input configuration file.");
   args.AddArgument("--running-time", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &runTimeSec, "Server running time period in seconds. If the parameter is not defined or 0 then the server runs infinitely.");
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+  args.AddArgument("--async-logging", vtksys::CommandLineArguments::NO_ARGUMENT, &asyncLogging, "Write log messages from a background thread, so that data acquisition and network threads do not wait for console and file output.");
 
   if (!args.Parse())
   {
@@ -178,6 +180,11 @@ int main(int argc, char** argv)
 
   bool neverStop = (runTimeSec == 0.0);
 
+  if (asyncLogging)
+  {
+    vtkPlusLogger::Instance()->SetAsynchronousLogging(true);
+  }
+
   // Run server until requested
   const double commandQueuePollIntervalSec = 0.010;
   while ((neverStop || (vtkPlusAccurateTimer::GetSystemTime() < startTime + runTimeSec)) && !stopRequested)
@@ -200,6 +207,9 @@ int main(int argc, char** argv)
     (*it)->Stop();
   }
 
+  // Write all queued log messages
+  vtkPlusLogger::Instance()->SetAsynchronousLogging(false);
+
   LOG_INFO("Shutdown successful.");
 
   return EXIT_SUCCESS;
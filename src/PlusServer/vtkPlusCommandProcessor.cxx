@@ -19,6 +19,7 @@ See License.txt for details.
 #include "igtl_header.h"
 #include "vtkPlusGetTransformCommand.h"
 #include "vtkPlusGetPolydataCommand.h"
+#include "vtkPlusGetSendQueueStatisticsCommand.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtkPlusRequestIdsCommand.h"
 #include "vtkPlusSaveConfigCommand.h"
@@ -33,19 +34,30 @@ See License.txt for details.
 #include <vtkObjectFactory.h>
 #include <vtkXMLUtilities.h>
 
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <set>
+
 vtkStandardNewMacro(vtkPlusCommandProcessor);
 
+static const int COMMAND_QUEUE_WAIT_TIMEOUT_MS = 200; // the waiting threads check this often whether they have to stop
+
 //----------------------------------------------------------------------------
 vtkPlusCommandProcessor::vtkPlusCommandProcessor()
   : PlusServer(NULL)
   , Threader(vtkSmartPointer<vtkMultiThreader>::New())
   , Mutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
-  , CommandExecutionActive(std::make_pair(false, false))
-  , CommandExecutionThreadId(-1)
+  , CommandExecutionActive(false)
+  , FastLaneThreadId(-1)
+  , NumberOfCommandExecutionThreads(1)
+  , NextCommandSequenceNumber(0)
 {
   // Register default commands
   RegisterPlusCommand(vtkSmartPointer<vtkPlusGetImageCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusGetPolydataCommand>::New());
+  RegisterPlusCommand(vtkSmartPointer<vtkPlusGetSendQueueStatisticsCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusGetTransformCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusReconstructVolumeCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusRequestIdsCommand>::New());
@@ -65,6 +77,7 @@ vtkPlusCommandProcessor::vtkPlusCommandProcessor()
 //----------------------------------------------------------------------------
 vtkPlusCommandProcessor::~vtkPlusCommandProcessor()
 {
+  this->Stop();
   SetPlusServer(NULL);
 }
 
@@ -77,95 +90,239 @@ void vtkPlusCommandProcessor::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << indent << "  " << iter->first << std::endl;
   }
+  os << indent << "NumberOfCommandExecutionThreads: " << this->NumberOfCommandExecutionThreads << std::endl;
+  std::vector<CommandExecutionStatus> runningCommands;
+  this->GetRunningCommands(runningCommands);
+  os << indent << "Running commands: " << runningCommands.size() << std::endl;
+  for (std::vector<CommandExecutionStatus>::iterator it = runningCommands.begin(); it != runningCommands.end(); ++it)
+  {
+    os << indent << "  " << it->CommandName << " (client: " << it->ClientId << ", id: " << it->Id << ", progress: " << it->Progress << ")" << std::endl;
+  }
 }
 
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusCommandProcessor::Start()
 {
-  if (this->CommandExecutionThreadId < 0)
+  std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+  if (this->CommandExecutionActive)
   {
-    this->CommandExecutionActive.first = true;
-    this->CommandExecutionThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&CommandExecutionThread, this);
+    // already running
+    return PLUS_SUCCESS;
   }
-  return PLUS_SUCCESS;
+  this->CommandExecutionActive = true;
+
+  PlusStatus status = PLUS_SUCCESS;
+  this->FastLaneThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&FastCommandExecutionThread, this);
+  if (this->FastLaneThreadId < 0)
+  {
+    LOG_ERROR("Failed to start fast lane command execution thread");
+    status = PLUS_FAIL;
+  }
+  for (int threadIndex = 0; threadIndex < this->NumberOfCommandExecutionThreads; threadIndex++)
+  {
+    int threadId = this->Threader->SpawnThread((vtkThreadFunctionType)&CommandExecutionThread, this);
+    if (threadId < 0)
+    {
+      LOG_ERROR("Failed to start command execution thread");
+      status = PLUS_FAIL;
+      continue;
+    }
+    this->CommandExecutionThreadIds.push_back(threadId);
+  }
+
+  LOG_DEBUG("Command execution started with " << this->CommandExecutionThreadIds.size() << " default lane threads");
+  return status;
 }
 
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusCommandProcessor::Stop()
 {
-  // Stop the command execution thread
-  if (this->CommandExecutionThreadId >= 0)
+  std::vector<int> threadIds;
   {
-    this->CommandExecutionActive.first = false;
-    while (this->CommandExecutionActive.second)
+    std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+    this->CommandExecutionActive = false;
+    threadIds = this->CommandExecutionThreadIds;
+    if (this->FastLaneThreadId >= 0)
     {
-      // Wait until the thread stops
-      vtkPlusAccurateTimer::Delay(0.2);
+      threadIds.push_back(this->FastLaneThreadId);
     }
-    this->CommandExecutionThreadId = -1;
   }
+  this->CommandQueueChanged.notify_all();
 
-  LOG_DEBUG("Command execution thread stopped");
+  // Wait until the threads complete the commands that they are executing
+  for (std::vector<int>::iterator threadIdIt = threadIds.begin(); threadIdIt != threadIds.end(); ++threadIdIt)
+  {
+    this->Threader->TerminateThread(*threadIdIt);
+  }
+
+  {
+    std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+    this->FastLaneThreadId = -1;
+    this->CommandExecutionThreadIds.clear();
+  }
+
+  LOG_DEBUG("Command execution threads stopped");
 
   return PLUS_SUCCESS;
 }
 
 //----------------------------------------------------------------------------
-void* vtkPlusCommandProcessor::CommandExecutionThread(vtkMultiThreader::ThreadInfo* data)
+void* vtkPlusCommandProcessor::FastCommandExecutionThread(vtkMultiThreader::ThreadInfo* data)
 {
   vtkPlusCommandProcessor* self = (vtkPlusCommandProcessor*)(data->UserData);
+  self->ExecuteLaneCommands(vtkPlusCommand::EXECUTION_LANE_FAST);
+  return NULL;
+}
 
-  self->CommandExecutionActive.second = true;
+//----------------------------------------------------------------------------
+void* vtkPlusCommandProcessor::CommandExecutionThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusCommandProcessor* self = (vtkPlusCommandProcessor*)(data->UserData);
+  self->ExecuteLaneCommands(vtkPlusCommand::EXECUTION_LANE_DEFAULT);
+  return NULL;
+}
 
+//----------------------------------------------------------------------------
+void vtkPlusCommandProcessor::ExecuteLaneCommands(vtkPlusCommand::ExecutionLaneType lane)
+{
   // Execute commands until a stop is requested
-  while (self->CommandExecutionActive.first)
+  std::unique_lock<std::mutex> queueLock(this->CommandQueueMutex);
+  while (this->CommandExecutionActive)
   {
-    self->ExecuteCommands();
-    // no commands in the queue, wait a bit before checking again
-    const double commandQueuePollIntervalSec = 0.010;
-#ifdef _WIN32
-    Sleep(commandQueuePollIntervalSec * 1000);
-#else
-    usleep(commandQueuePollIntervalSec * 1000000);
-#endif
+    QueuedCommand nextCommand;
+    if (!this->PopNextCommand(lane, nextCommand))
+    {
+      // Wait until a command is queued or completed (completion may allow starting a waiting command)
+      this->CommandQueueChanged.wait_for(queueLock, std::chrono::milliseconds(COMMAND_QUEUE_WAIT_TIMEOUT_MS));
+      continue;
+    }
+    queueLock.unlock();
+    this->ExecuteCommand(nextCommand);
+    queueLock.lock();
   }
-
-  // Close thread
-  self->CommandExecutionThreadId = -1;
-  self->CommandExecutionActive.second = false;
-  return NULL;
 }
 
 //----------------------------------------------------------------------------
-int vtkPlusCommandProcessor::ExecuteCommands()
+bool vtkPlusCommandProcessor::PopNextCommand(vtkPlusCommand::ExecutionLaneType lane, QueuedCommand& nextCommand)
 {
-  // Implemented in a while loop to not block the mutex during command execution, only during management of the queue.
-  int numberOfExecutedCommands(0);
-  while (1)
+  if (lane == vtkPlusCommand::EXECUTION_LANE_FAST)
+  {
+    if (this->FastCommandQueue.empty())
+    {
+      return false;
+    }
+    nextCommand = this->FastCommandQueue.front();
+    this->FastCommandQueue.pop_front();
+  }
+  else
   {
-    vtkSmartPointer<vtkPlusCommand> cmd; // next command to be processed
+    // Default lane commands are not started before the fast commands that were received earlier are completed
+    unsigned long firstPendingFastSequenceNumber = ULONG_MAX;
+    if (!this->FastCommandQueue.empty())
     {
-      PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
-      if (this->CommandQueue.empty())
+      firstPendingFastSequenceNumber = this->FastCommandQueue.front().SequenceNumber;
+    }
+    std::set<int> busyClientIds;
+    for (std::list<RunningCommand>::iterator runningIt = this->RunningCommands.begin(); runningIt != this->RunningCommands.end(); ++runningIt)
+    {
+      if (runningIt->Status.Lane == vtkPlusCommand::EXECUTION_LANE_FAST)
       {
-        return numberOfExecutedCommands;
+        firstPendingFastSequenceNumber = std::min(firstPendingFastSequenceNumber, runningIt->Queued.SequenceNumber);
+      }
+      else
+      {
+        busyClientIds.insert(runningIt->Queued.Command->GetClientId());
+      }
+    }
+
+    QueuedCommandList::iterator commandIt = this->CommandQueue.begin();
+    for (; commandIt != this->CommandQueue.end(); ++commandIt)
+    {
+      if (commandIt->SequenceNumber > firstPendingFastSequenceNumber)
+      {
+        // the queue is ordered by sequence number, so all the remaining commands have to wait
+        return false;
       }
-      cmd = this->CommandQueue.front();
-      this->CommandQueue.pop_front();
+      // Commands of a client are executed in the order they were received. Inserting the client id
+      // makes the later commands of the same client wait for this one.
+      if (busyClientIds.insert(commandIt->Command->GetClientId()).second)
+      {
+        break;
+      }
+    }
+    if (commandIt == this->CommandQueue.end())
+    {
+      return false;
     }
+    nextCommand = *commandIt;
+    this->CommandQueue.erase(commandIt);
+  }
+
+  RunningCommand runningCommand;
+  runningCommand.Queued = nextCommand;
+  runningCommand.Status.CommandName = nextCommand.Command->GetName();
+  runningCommand.Status.ClientId = nextCommand.Command->GetClientId();
+  runningCommand.Status.Id = nextCommand.Command->GetId();
+  runningCommand.Status.Lane = lane;
+  runningCommand.Status.StartTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+  runningCommand.Status.Progress = -1.0;
+  this->RunningCommands.push_back(runningCommand);
+  return true;
+}
 
-    LOG_DEBUG("Executing command");
-    if (cmd->Execute() != PLUS_SUCCESS)
+//----------------------------------------------------------------------------
+void vtkPlusCommandProcessor::ExecuteCommand(QueuedCommand& queuedCommand)
+{
+  vtkPlusCommand* cmd = queuedCommand.Command;
+
+  LOG_DEBUG("Executing command: " << cmd->GetName());
+  double startTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+  if (cmd->Execute() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Command execution failed");
+  }
+  LOG_DEBUG("Command " << cmd->GetName() << " executed in " << (vtkPlusAccurateTimer::GetSystemTime() - startTimeSec) * 1000.0 << "ms");
+
+  // move the response objects from the command to the processor's queue
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
+    cmd->PopCommandResponses(this->CommandResponseQueue);
+  }
+
+  {
+    std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+    for (std::list<RunningCommand>::iterator runningIt = this->RunningCommands.begin(); runningIt != this->RunningCommands.end(); ++runningIt)
     {
-      LOG_ERROR("Command execution failed");
+      if (runningIt->Queued.SequenceNumber == queuedCommand.SequenceNumber)
+      {
+        this->RunningCommands.erase(runningIt);
+        break;
+      }
     }
+  }
+  this->CommandQueueChanged.notify_all();
+}
 
-    // move the response objects from the command to the processor's queue
+//----------------------------------------------------------------------------
+int vtkPlusCommandProcessor::ExecuteCommands()
+{
+  // Implemented in a while loop to not block the mutex during command execution, only during management of the queue.
+  int numberOfExecutedCommands(0);
+  while (1)
+  {
+    QueuedCommand nextCommand; // next command to be processed
     {
-      PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
-      cmd->PopCommandResponses(this->CommandResponseQueue);
+      std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+      // Commands of the lanes that are served by execution threads are not executed here
+      bool commandFound = (this->FastLaneThreadId < 0 && this->PopNextCommand(vtkPlusCommand::EXECUTION_LANE_FAST, nextCommand))
+                          || (this->CommandExecutionThreadIds.empty() && this->PopNextCommand(vtkPlusCommand::EXECUTION_LANE_DEFAULT, nextCommand));
+      if (!commandFound)
+      {
+        return numberOfExecutedCommands;
+      }
     }
 
+    this->ExecuteCommand(nextCommand);
     numberOfExecutedCommands++;
   }
 
@@ -173,6 +330,32 @@ int vtkPlusCommandProcessor::ExecuteCommands()
   return numberOfExecutedCommands;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusCommandProcessor::GetRunningCommands(std::vector<CommandExecutionStatus>& runningCommands)
+{
+  runningCommands.clear();
+  std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+  for (std::list<RunningCommand>::iterator runningIt = this->RunningCommands.begin(); runningIt != this->RunningCommands.end(); ++runningIt)
+  {
+    runningCommands.push_back(runningIt->Status);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusCommandProcessor::SetCommandProgress(vtkPlusCommand* cmd, double fraction)
+{
+  std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+  for (std::list<RunningCommand>::iterator runningIt = this->RunningCommands.begin(); runningIt != this->RunningCommands.end(); ++runningIt)
+  {
+    if (runningIt->Queued.Command.GetPointer() == cmd)
+    {
+      runningIt->Status.Progress = fraction;
+      LOG_DEBUG("Command " << runningIt->Status.CommandName << " (client: " << runningIt->Status.ClientId << ", id: " << runningIt->Status.Id << ") progress: " << fraction * 100.0 << "%");
+      return;
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusCommandProcessor::RegisterPlusCommand(vtkPlusCommand* cmd)
 {
@@ -267,9 +450,22 @@ PlusStatus vtkPlusCommandProcessor::QueueCommand(bool respondUsingIGTLCommand, u
   cmd->SetId(uid);
   cmd->SetRespondWithCommandMessage(respondUsingIGTLCommand);
 
-  // Add command to the execution queue
-  PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
-  this->CommandQueue.push_back(cmd);
+  // Add command to the execution queue of its lane
+  {
+    std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+    QueuedCommand queuedCommand;
+    queuedCommand.Command = cmd;
+    queuedCommand.SequenceNumber = this->NextCommandSequenceNumber++;
+    if (cmd->GetExecutionLane() == vtkPlusCommand::EXECUTION_LANE_FAST)
+    {
+      this->FastCommandQueue.push_back(queuedCommand);
+    }
+    else
+    {
+      this->CommandQueue.push_back(queuedCommand);
+    }
+  }
+  this->CommandQueueChanged.notify_all();
 
   return PLUS_SUCCESS;
 }
@@ -329,6 +525,7 @@ void vtkPlusCommandProcessor::PopCommandResponses(PlusCommandResponseList& respo
 //------------------------------------------------------------------------------
 bool vtkPlusCommandProcessor::IsRunning()
 {
-  return this->CommandExecutionActive.second;
+  std::lock_guard<std::mutex> queueLock(this->CommandQueueMutex);
+  return this->FastLaneThreadId >= 0 || !this->CommandExecutionThreadIds.empty();
 }
 
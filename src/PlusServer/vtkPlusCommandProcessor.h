@@ -14,7 +14,12 @@
 #include "vtkPlusCommand.h"
 #include "vtkPlusCommandResponse.h"
 #include "vtkPlusOpenIGTLinkServer.h"
+
+// STL includes
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <vector>
 
 class vtkImageData;
 class vtkMatrix4x4;
@@ -23,9 +28,18 @@ class vtkMatrix4x4;
   \class vtkPlusCommandProcessor
   \brief Creates a PlusCommand from a string.
   If the commands are to be executed on the main thread then call ExecuteCommands() periodically from the main thread.
-  If the commands are to be executed on a separate thread (to allow background processing, but maybe requiring more synchronization) call Start() to start an internal processing thread.
+  If the commands are to be executed on a separate thread (to allow background processing, but maybe requiring more synchronization) call Start() to start internal processing threads.
   Probably one of the processing models would be enough, but at this point it's not clear which one is better.
   TODO: keep only one method and remove the other approach completely once the processing model decision is finalized.
+
+  Commands are executed in two lanes (see vtkPlusCommand::GetExecutionLane()):
+  - Fast lane: short commands (such as GetTransform) are executed one by one on a dedicated thread, so they are not
+    delayed by long-running commands.
+  - Default lane: all other commands are executed by a pool of NumberOfCommandExecutionThreads threads. If the number
+    of threads is 0 then these commands are executed by ExecuteCommands().
+  Commands of the same client in the default lane are executed in the order they were received. A command in the
+  default lane is not started before all the fast commands that were received before it are completed.
+  The execution threads wait on a condition variable, so they start executing a command as soon as it is queued.
   \ingroup PlusLibPlusServer
 */
 class vtkPlusServerExport vtkPlusCommandProcessor : public vtkObject
@@ -35,21 +49,48 @@ public:
   vtkTypeMacro(vtkPlusCommandProcessor, vtkObject);
   virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  /*! Status of a command that is being executed */
+  struct CommandExecutionStatus
+  {
+    std::string CommandName;
+    unsigned int ClientId;
+    uint32_t Id;
+    vtkPlusCommand::ExecutionLaneType Lane;
+    /*! System time when the execution of the command started */
+    double StartTimeSec;
+    /*! Completed fraction of the command execution as reported by the command, negative if it is not reported */
+    double Progress;
+  };
+
   /*!
-    Execute all commands in the queue from the current thread (useful if commands should be executed from the main thread)
+    Execute all commands in the queue from the current thread (useful if commands should be executed from the main thread).
+    Only the commands of lanes that are not served by execution threads are executed.
     \return Number of executed commands
   */
   int ExecuteCommands();
 
-  /*! Start thread for processing the commands in the queue. Must be called from the main thread. */
+  /*! Start threads for processing the commands in the queue. Must be called from the main thread. */
   virtual PlusStatus Start();
 
-  /*! Stop command processing. Must be called from the main thread. */
+  /*! Stop command processing. Waits for the commands that are being executed. Must be called from the main thread. */
   virtual PlusStatus Stop();
 
-  /*! Returns true if the command processing thread is running. Can be called from any thread. */
+  /*! Returns true if any command processing thread is running. Can be called from any thread. */
   virtual bool IsRunning();
 
+  /*!
+    Number of threads that execute the commands of the default lane. If 0 then the default lane commands are executed by ExecuteCommands().
+    It has to be set before Start() is called.
+  */
+  vtkGetMacro(NumberOfCommandExecutionThreads, int);
+  vtkSetMacro(NumberOfCommandExecutionThreads, int);
+
+  /*! Get the status of the commands that are being executed. Can be called from any thread. */
+  virtual void GetRunningCommands(std::vector<CommandExecutionStatus>& runningCommands);
+
+  /*! Set the progress of a command that is being executed. Called by vtkPlusCommand::ReportProgress(). Can be called from any thread. */
+  virtual void SetCommandProgress(vtkPlusCommand* cmd, double fraction);
+
   /*!
     Register custom command. Must be called from the main thread.
     \param cmd It should point to a valid vtkPlusCommand instance. The caller can delete the cmd object after the call.
@@ -84,7 +125,39 @@ public:
 protected:
   vtkPlusCommand* CreatePlusCommand(const std::string& commandName, const std::string& commandStr);
 
-  /*! Thread for client connection handling */
+  /*! Command waiting for execution */
+  struct QueuedCommand
+  {
+    vtkSmartPointer<vtkPlusCommand> Command;
+    /*! Order of the command among all the received commands */
+    unsigned long SequenceNumber;
+  };
+  typedef std::list<QueuedCommand> QueuedCommandList;
+
+  /*! Command that is being executed */
+  struct RunningCommand
+  {
+    QueuedCommand Queued;
+    CommandExecutionStatus Status;
+  };
+
+  /*!
+    Remove the next command that can be executed from the queue of the lane and add it to the running commands.
+    The command queue mutex must be locked by the caller.
+    \return False if no command in the lane can be executed now
+  */
+  bool PopNextCommand(vtkPlusCommand::ExecutionLaneType lane, QueuedCommand& nextCommand);
+
+  /*! Execute a command that was returned by PopNextCommand(), move its responses to the response queue */
+  void ExecuteCommand(QueuedCommand& queuedCommand);
+
+  /*! Thread function of the commands execution threads of a lane */
+  void ExecuteLaneCommands(vtkPlusCommand::ExecutionLaneType lane);
+
+  /*! Thread that executes the commands of the fast lane */
+  static void* FastCommandExecutionThread(vtkMultiThreader::ThreadInfo* data);
+
+  /*! Thread that executes the commands of the default lane */
   static void* CommandExecutionThread(vtkMultiThreader::ThreadInfo* data);
 
   vtkPlusCommandProcessor();
@@ -97,26 +170,42 @@ private:
   /*! vtkMultiThreader instance for controlling threads */
   vtkSmartPointer<vtkMultiThreader> Threader;
 
-  /*! Mutex instance for safe data access */
+  /*! Mutex instance for safe access of the response queue */
   vtkSmartPointer<vtkPlusRecursiveCriticalSection> Mutex;
 
-  // Active flag for threads (first: request, second: respond )
-  std::pair<bool, bool> CommandExecutionActive;
+  /*! Mutex for the command queues, the running commands and the thread states */
+  std::mutex CommandQueueMutex;
+
+  /*! Signaled when a command is queued or completed, or when the threads have to stop */
+  std::condition_variable CommandQueueChanged;
+
+  /*! True while the execution threads are requested to run */
+  bool CommandExecutionActive;
+
+  /*! Thread identifier of the fast lane thread, -1 if not running */
+  int FastLaneThreadId;
+
+  /*! Thread identifiers of the default lane threads */
+  std::vector<int> CommandExecutionThreadIds;
 
-  // Thread identifier
-  int CommandExecutionThreadId;
+  /*! Number of threads that execute the commands of the default lane */
+  int NumberOfCommandExecutionThreads;
+
+  /*! Sequence number of the next received command */
+  unsigned long NextCommandSequenceNumber;
 
   /*! Map command names and the New() static methods of vtkPlusCommand classes */
   std::map<std::string, vtkPlusCommand*> RegisteredCommands;
 
-  /*!
-    This queue contains all the active commands.
-    After a command's execute method is called it may still remain active (remain in the queue),
-    until it signals that it is completed.
-  */
-  //std::list<vtkPlusCommand*> CommandQueue;
-  typedef std::list< vtkSmartPointer<vtkPlusCommand> > PlusCommandList;
-  PlusCommandList CommandQueue;
+  /*! Commands waiting for execution in the fast lane */
+  QueuedCommandList FastCommandQueue;
+
+  /*! Commands waiting for execution in the default lane */
+  QueuedCommandList CommandQueue;
+
+  /*! Commands that are being executed. After the execution a command is removed from this list. */
+  std::list<RunningCommand> RunningCommands;
+
   PlusCommandResponseList CommandResponseQueue;
 
   vtkPlusCommandProcessor(const vtkPlusCommandProcessor&);  // Not implemented.
@@ -13,6 +13,7 @@ See License.txt for details.
 #include "vtkPlusDataCollector.h"
 #include "vtkPlusIgtlMessageCommon.h"
 #include "vtkPlusIgtlMessageFactory.h"
+#include "vtkPlusNewDataNotifier.h"
 #include "vtkPlusOpenIGTLinkServer.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtkPlusTrackedFrameList.h"
@@ -39,6 +40,10 @@ See License.txt for details.
 // OpenIGTLinkIO includes
 #include <igtlioPolyDataConverter.h>
 
+// STL includes
+#include <algorithm>
+#include <chrono>
+
 #if defined(WIN32)
   #include "vtkPlusOpenIGTLinkServerWin32.cxx"
 #elif defined(__APPLE__)
@@ -51,6 +56,8 @@ static const double DELAY_ON_SENDING_ERROR_SEC = 0.02;
 static const double DELAY_ON_NO_NEW_FRAMES_SEC = 0.005;
 static const int NUMBER_OF_RECENT_COMMAND_IDS_STORED = 10;
 static const int IGTL_EMPTY_DATA_SIZE = -1;
+// The client sender threads wake up at least this often to check if they have to stop
+static const int SEND_QUEUE_WAIT_TIMEOUT_MS = 100;
 
 const float vtkPlusOpenIGTLinkServer::CLIENT_SOCKET_TIMEOUT_SEC = 0.5;
 
@@ -89,8 +96,11 @@ vtkPlusOpenIGTLinkServer::vtkPlusOpenIGTLinkServer()
   , DefaultClientReceiveTimeoutSec(CLIENT_SOCKET_TIMEOUT_SEC)
   , IgtlMessageCrcCheckEnabled(0)
   , PlusCommandProcessor(vtkSmartPointer<vtkPlusCommandProcessor>::New())
+  , NumberOfCommandExecutionThreads(0)
   , MessageResponseQueueMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
   , BroadcastChannel(NULL)
+  , BroadcastChannelNotifier(vtkSmartPointer<vtkPlusNewDataNotifier>::New())
+  , LastBroadcastChannelNotificationCount(0)
   , LogWarningOnNoDataAvailable(true)
   , KeepAliveIntervalSec(CLIENT_SOCKET_TIMEOUT_SEC / 2.0)
   , GracePeriodLogLevel(vtkPlusLogger::LOG_LEVEL_DEBUG)
@@ -170,6 +180,12 @@ PlusStatus vtkPlusOpenIGTLinkServer::StartOpenIGTLinkService()
   LOG_DEBUG(ss.str());
 
   this->PlusCommandProcessor->SetPlusServer(this);
+  this->PlusCommandProcessor->SetNumberOfCommandExecutionThreads(this->NumberOfCommandExecutionThreads);
+  if (this->PlusCommandProcessor->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start command execution threads");
+    return PLUS_FAIL;
+  }
 
   this->BroadcastStartTime = vtkPlusAccurateTimer::GetSystemTime();
 
@@ -192,6 +208,9 @@ PlusStatus vtkPlusOpenIGTLinkServer::StopOpenIGTLinkService()
     LOG_DEBUG("ConnectionReceiverThread stopped");
   }
 
+  // Stop command execution threads (waits for the commands that are being executed)
+  this->PlusCommandProcessor->Stop();
+
   // Disconnect clients (stop receiving thread, close socket)
   std::vector< int > clientIds;
   {
@@ -247,6 +266,7 @@ void* vtkPlusOpenIGTLinkServer::ConnectionReceiverThread(vtkMultiThreader::Threa
       client->ClientSocket->SetSendTimeout(self->DefaultClientSendTimeoutSec * 1000);
       client->ClientInfo = self->DefaultClientInfo;
       client->Server = self;
+      client->SendQueue = std::make_shared<ClientSendQueue>();
 
       int port = 0;
       std::string address = "unknown";
@@ -257,6 +277,9 @@ void* vtkPlusOpenIGTLinkServer::ConnectionReceiverThread(vtkMultiThreader::Threa
 
       client->DataReceiverActive.first = true;
       client->DataReceiverThreadId = self->Threader->SpawnThread((vtkThreadFunctionType)&DataReceiverThread, client);
+
+      client->ClientSenderActive.first = true;
+      client->ClientSenderThreadId = self->Threader->SpawnThread((vtkThreadFunctionType)&ClientSenderThread, client);
     }
   }
 
@@ -330,6 +353,9 @@ void* vtkPlusOpenIGTLinkServer::DataSenderThread(vtkMultiThreader::ThreadInfo* d
   if (self->BroadcastChannel)
   {
     self->BroadcastChannel->GetMostRecentTimestamp(self->LastSentTrackedFrameTimestamp);
+    // Wake up as soon as new data is available in the broadcast channel
+    self->BroadcastChannel->AddNewDataNotifier(self->BroadcastChannelNotifier);
+    self->LastBroadcastChannelNotificationCount = self->BroadcastChannelNotifier->GetNotificationCount();
   }
 
   double elapsedTimeSinceLastPacketSentSec = 0;
@@ -364,6 +390,12 @@ void* vtkPlusOpenIGTLinkServer::DataSenderThread(vtkMultiThreader::ThreadInfo* d
     // Send image/tracking/string data
     SendLatestFramesToClients(*self, elapsedTimeSinceLastPacketSentSec);
   }
+
+  if (self->BroadcastChannel)
+  {
+    self->BroadcastChannel->RemoveNewDataNotifier(self->BroadcastChannelNotifier);
+  }
+
   // Close thread
   self->DataSenderThreadId = -1;
   self->DataSenderActive.second = false;
@@ -419,7 +451,15 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendLatestFramesToClients(vtkPlusOpenIGTLin
   // There is no new frame in the buffer
   if (trackedFrameList->GetNumberOfTrackedFrames() == 0)
   {
-    vtkPlusAccurateTimer::Delay(DELAY_ON_NO_NEW_FRAMES_SEC);
+    if (self.BroadcastChannel != NULL)
+    {
+      // Returns as soon as new data is added to the channel (immediately if it was added since the last wait)
+      self.BroadcastChannelNotifier->WaitForNewData(self.LastBroadcastChannelNotificationCount, DELAY_ON_NO_NEW_FRAMES_SEC);
+    }
+    else
+    {
+      vtkPlusAccurateTimer::Delay(DELAY_ON_NO_NEW_FRAMES_SEC);
+    }
     elapsedTimeSinceLastPacketSentSec += vtkPlusAccurateTimer::GetSystemTime() - startTimeSec;
 
     // Send keep alive packet to clients
@@ -460,17 +500,17 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendMessageResponses(vtkPlusOpenIGTLinkServ
     for (ClientIdToMessageListMap::iterator it = self.MessageResponseQueue.begin(); it != self.MessageResponseQueue.end(); ++it)
     {
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self.IgtlClientsMutex);
-      igtl::ClientSocket::Pointer clientSocket = NULL;
+      ClientData* client = NULL;
 
       for (std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin(); clientIterator != self.IgtlClients.end(); ++clientIterator)
       {
         if (clientIterator->ClientId == it->first)
         {
-          clientSocket = clientIterator->ClientSocket;
+          client = &(*clientIterator);
           break;
         }
       }
-      if (clientSocket.IsNull())
+      if (client == NULL)
       {
         LOG_WARNING("Message reply cannot be sent to client " << it->first << ", probably client has been disconnected.");
         continue;
@@ -478,7 +518,7 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendMessageResponses(vtkPlusOpenIGTLinkServ
 
       for (std::vector<igtl::MessageBase::Pointer>::iterator messageIt = it->second.begin(); messageIt != it->second.end(); ++messageIt)
       {
-        clientSocket->Send((*messageIt)->GetBufferPointer(), (*messageIt)->GetBufferSize());
+        self.QueueMessageForSending(*client, *messageIt, false);
       }
     }
     self.MessageResponseQueue.clear();
@@ -507,22 +547,22 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendCommandResponses(vtkPlusOpenIGTLinkServ
       // Only send the response to the client that requested the command
       LOG_DEBUG("Send command reply to client " << (*responseIt)->GetClientId() << ": " << igtlResponseMessage->GetDeviceName());
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self.IgtlClientsMutex);
-      igtl::ClientSocket::Pointer clientSocket = NULL;
+      ClientData* client = NULL;
       for (std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin(); clientIterator != self.IgtlClients.end(); ++clientIterator)
       {
         if (clientIterator->ClientId == (*responseIt)->GetClientId())
         {
-          clientSocket = clientIterator->ClientSocket;
+          client = &(*clientIterator);
           break;
         }
       }
 
-      if (clientSocket.IsNull())
+      if (client == NULL)
       {
         LOG_WARNING("Message reply cannot be sent to client " << (*responseIt)->GetClientId() << ", probably client has been disconnected");
         continue;
       }
-      clientSocket->Send(igtlResponseMessage->GetBufferPointer(), igtlResponseMessage->GetBufferSize());
+      self.QueueMessageForSending(*client, igtlResponseMessage, false);
     }
   }
 
@@ -596,7 +636,14 @@ void* vtkPlusOpenIGTLinkServer::DataReceiverThread(vtkMultiThreader::ThreadInfo*
       igtl::StatusMessage::Pointer replyMsg = dynamic_cast<igtl::StatusMessage*>(bodyMessage.GetPointer());
       replyMsg->SetCode(igtl::StatusMessage::STATUS_OK);
       replyMsg->Pack();
-      clientSocket->Send(replyMsg->GetPackPointer(), replyMsg->GetPackBodySize());
+
+      // The socket is only written by the client's sender thread, so the reply is queued like all other messages
+      PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self->IgtlClientsMutex);
+      if (self->QueueMessageForSending(*client, replyMsg.GetPointer(), false) != PLUS_SUCCESS)
+      {
+        // The client is disconnected by the data sender thread or the next keep alive
+        LOG_DEBUG("Status reply cannot be sent to client " << clientId << " - a previous message could not be sent to the client.");
+      }
     }
     else if (typeid(*bodyMessage) == typeid(igtl::StringMessage)
              && vtkPlusCommand::IsCommandDeviceName(headerMsg->GetDeviceName()))
@@ -815,12 +862,145 @@ void* vtkPlusOpenIGTLinkServer::DataReceiverThread(vtkMultiThreader::ThreadInfo*
     }
   } // ConnectionActive
 
-  // Close thread
-  client->DataReceiverThreadId = -1;
+  // Close thread (the thread id is released by DisconnectClient when it joins the thread)
   client->DataReceiverActive.second = false;
   return NULL;
 }
 
+//----------------------------------------------------------------------------
+void* vtkPlusOpenIGTLinkServer::ClientSenderThread(vtkMultiThreader::ThreadInfo* data)
+{
+  ClientData* client = (ClientData*)(data->UserData);
+  client->ClientSenderActive.second = true;
+  vtkPlusOpenIGTLinkServer* self = client->Server;
+
+  // Make copy of frequently used data to avoid locking of client data
+  igtl::ClientSocket::Pointer clientSocket = client->ClientSocket;
+  std::shared_ptr<ClientSendQueue> sendQueue = client->SendQueue;
+  int clientId = client->ClientId;
+
+  while (client->ClientSenderActive.first)
+  {
+    igtl::MessageBase::Pointer igtlMessage;
+    if (!sendQueue->WaitForMessage(igtlMessage, SEND_QUEUE_WAIT_TIMEOUT_MS))
+    {
+      // Timeout, check if the thread has to be stopped
+      continue;
+    }
+
+    // The socket is only written by this thread, so sending to a slow client only blocks this client's queue
+    int retValue = 0;
+    RETRY_UNTIL_TRUE((retValue = clientSocket->Send(igtlMessage->GetBufferPointer(), igtlMessage->GetBufferSize())) != 0, self->NumberOfRetryAttempts, self->DelayBetweenRetryAttemptsSec);
+    if (retValue == 0)
+    {
+      igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
+      igtlMessage->GetTimeStamp(ts);
+      LOG_INFO("Client " << clientId << " disconnected - could not send " << igtlMessage->GetMessageType() << " message to client (device name: " << igtlMessage->GetDeviceName()
+               << "  Timestamp: " << std::fixed << ts->GetTimeStamp() << ").");
+    }
+    // If sending failed then the client will be disconnected by the server and all pending messages are discarded
+    sendQueue->ReportSendResult(retValue != 0);
+  }
+
+  // Close thread (the thread id is released by DisconnectClient when it joins the thread)
+  client->ClientSenderActive.second = false;
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusOpenIGTLinkServer::QueueMessageForSending(ClientData& client, igtl::MessageBase::Pointer message, bool droppable)
+{
+  if (message.IsNull() || !client.SendQueue)
+  {
+    return PLUS_SUCCESS;
+  }
+  if (client.SendQueue->QueueMessage(message, droppable, client.ClientInfo.SendQueueMaxLength) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus ClientSendQueue::QueueMessage(igtl::MessageBase::Pointer message, bool droppable, int maxQueueLength)
+{
+  {
+    std::lock_guard<std::mutex> queueLock(this->Mutex);
+    if (this->SendFailed)
+    {
+      return PLUS_FAIL;
+    }
+
+    unsigned int maxLength = (maxQueueLength > 0 ? static_cast<unsigned int>(maxQueueLength) : 0);
+    if (droppable && maxLength > 0 && this->Messages.size() >= maxLength)
+    {
+      std::deque<QueuedMessage>::iterator oldestDroppable = std::find_if(this->Messages.begin(), this->Messages.end(),
+          [](const QueuedMessage & item) { return item.Droppable; });
+      this->NumberOfDroppedMessages++;
+      if (oldestDroppable == this->Messages.end())
+      {
+        // Only messages that must not be dropped are waiting, so the new message is discarded
+        return PLUS_SUCCESS;
+      }
+      this->Messages.erase(oldestDroppable);
+    }
+
+    if (this->Messages.size() >= maxLength + STALLED_CLIENT_EXTRA_QUEUE_LENGTH)
+    {
+      // The client does not receive the messages that must not be dropped, stop queuing messages for it
+      LOG_INFO("Client is not receiving data (" << this->Messages.size() << " messages are waiting to be sent), it will be disconnected.");
+      this->SendFailed = true;
+      this->Messages.clear();
+      return PLUS_FAIL;
+    }
+
+    QueuedMessage item;
+    item.Message = message;
+    item.Droppable = droppable;
+    this->Messages.push_back(item);
+    this->PeakLength = std::max<unsigned int>(this->PeakLength, this->Messages.size());
+  }
+  this->MessageQueued.notify_one();
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool ClientSendQueue::WaitForMessage(igtl::MessageBase::Pointer& message, int timeoutMs)
+{
+  std::unique_lock<std::mutex> queueLock(this->Mutex);
+  if (!this->MessageQueued.wait_for(queueLock, std::chrono::milliseconds(timeoutMs), [this]() { return !this->Messages.empty(); }))
+  {
+    return false;
+  }
+  message = this->Messages.front().Message;
+  this->Messages.pop_front();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ClientSendQueue::ReportSendResult(bool sent)
+{
+  std::lock_guard<std::mutex> queueLock(this->Mutex);
+  if (!sent)
+  {
+    this->SendFailed = true;
+    this->Messages.clear();
+    return;
+  }
+  this->NumberOfSentMessages++;
+}
+
+//----------------------------------------------------------------------------
+void ClientSendQueue::GetStatistics(ClientSendQueueStatistics& statistics)
+{
+  std::lock_guard<std::mutex> queueLock(this->Mutex);
+  statistics.QueueLength = this->Messages.size();
+  statistics.PeakQueueLength = this->PeakLength;
+  statistics.NumberOfSentMessages = this->NumberOfSentMessages;
+  statistics.NumberOfDroppedMessages = this->NumberOfDroppedMessages;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusOpenIGTLinkServer::SendTrackedFrame(PlusTrackedFrame& trackedFrame)
 {
@@ -843,22 +1023,23 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendTrackedFrame(PlusTrackedFrame& trackedF
 
   std::vector<int> disconnectedClientIds;
   {
-    // Lock before we send message to the clients
+    // Messages are packed only once for all clients that request the same content, the packed buffers are sent to each client
+    vtkPlusIgtlMessageFactory::PackedMessageCacheType packedMessageCache;
+
+    // Lock before we queue messages for the clients
     PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
     for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
     {
-      igtl::ClientSocket::Pointer clientSocket = (*clientIterator).ClientSocket;
-
       // Create IGT messages
       std::vector<igtl::MessageBase::Pointer> igtlMessages;
       std::vector<igtl::MessageBase::Pointer>::iterator igtlMessageIterator;
 
-      if (this->IgtlMessageFactory->PackMessages(clientIterator->ClientInfo, igtlMessages, trackedFrame, this->SendValidTransformsOnly, this->TransformRepository) != PLUS_SUCCESS)
+      if (this->IgtlMessageFactory->PackMessages(clientIterator->ClientInfo, igtlMessages, trackedFrame, this->SendValidTransformsOnly, this->TransformRepository, &packedMessageCache) != PLUS_SUCCESS)
       {
         LOG_WARNING("Failed to pack all IGT messages");
       }
 
-      // Send all messages to a client
+      // Queue all messages for the client's sender thread
       for (igtlMessageIterator = igtlMessages.begin(); igtlMessageIterator != igtlMessages.end(); ++igtlMessageIterator)
       {
         igtl::MessageBase::Pointer igtlMessage = (*igtlMessageIterator);
@@ -867,15 +1048,11 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendTrackedFrame(PlusTrackedFrame& trackedF
           continue;
         }
 
-        int retValue = 0;
-        RETRY_UNTIL_TRUE((retValue = clientSocket->Send(igtlMessage->GetBufferPointer(), igtlMessage->GetBufferSize())) != 0, this->NumberOfRetryAttempts, this->DelayBetweenRetryAttemptsSec);
-        if (retValue == 0)
+        bool droppable = clientIterator->ClientInfo.IsMessageDroppable(igtlMessage->GetMessageType());
+        if (this->QueueMessageForSending(*clientIterator, igtlMessage, droppable) != PLUS_SUCCESS)
         {
+          // A previous message could not be sent to the client
           disconnectedClientIds.push_back(clientIterator->ClientId);
-          igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
-          igtlMessage->GetTimeStamp(ts);
-          LOG_INFO("Client disconnected - could not send " << igtlMessage->GetMessageType() << " message to client (device name: " << igtlMessage->GetDeviceName()
-                   << "  Timestamp: " << std::fixed << ts->GetTimeStamp() << ").");
           break;
         }
 
@@ -911,17 +1088,26 @@ void vtkPlusOpenIGTLinkServer::DisconnectClient(int clientId)
         continue;
       }
       clientIterator->DataReceiverActive.first = false;
+      clientIterator->ClientSenderActive.first = false;
+      if (clientIterator->SendQueue)
+      {
+        clientIterator->SendQueue->MessageQueued.notify_all();
+      }
       break;
     }
   }
 
-  // Wait for the thread to stop
+  // Wait for the threads to stop
   bool clientDataReceiverThreadStillActive = false;
+  bool clientSenderThreadStillActive = false;
+  int dataReceiverThreadId = -1;
+  int clientSenderThreadId = -1;
   do
   {
     clientDataReceiverThreadStillActive = false;
+    clientSenderThreadStillActive = false;
     {
-      // check if any of the receiver threads are still active
+      // check if any of the client threads are still active
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
       for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
       {
@@ -929,29 +1115,37 @@ void vtkPlusOpenIGTLinkServer::DisconnectClient(int clientId)
         {
           continue;
         }
-        if (clientIterator->DataReceiverThreadId > 0)
+        clientDataReceiverThreadStillActive = (clientIterator->DataReceiverThreadId >= 0 && clientIterator->DataReceiverActive.second);
+        clientSenderThreadStillActive = (clientIterator->ClientSenderThreadId >= 0 && clientIterator->ClientSenderActive.second);
+        if (!clientDataReceiverThreadStillActive && !clientSenderThreadStillActive)
         {
-          if (clientIterator->DataReceiverActive.second)
-          {
-            // thread still running
-            clientDataReceiverThreadStillActive = true;
-          }
-          else
-          {
-            // thread stopped
-            clientIterator->DataReceiverThreadId = -1;
-          }
-          break;
+          // Both threads have finished (or have not started their loop yet), take ownership of the thread ids
+          dataReceiverThreadId = clientIterator->DataReceiverThreadId;
+          clientSenderThreadId = clientIterator->ClientSenderThreadId;
+          clientIterator->DataReceiverThreadId = -1;
+          clientIterator->ClientSenderThreadId = -1;
         }
+        break;
       }
     }
-    if (clientDataReceiverThreadStillActive)
+    if (clientDataReceiverThreadStillActive || clientSenderThreadStillActive)
     {
       // give some time for the threads to finish
       vtkPlusAccurateTimer::DelayWithEventProcessing(0.2);
     }
   }
-  while (clientDataReceiverThreadStillActive);
+  while (clientDataReceiverThreadStillActive || clientSenderThreadStillActive);
+
+  // Join the client threads so that their multithreader slots can be reused by later connections.
+  // The client list lock must not be held here, as the threads may still be waiting for it while they exit.
+  if (dataReceiverThreadId >= 0)
+  {
+    this->Threader->TerminateThread(dataReceiverThreadId);
+  }
+  if (clientSenderThreadId >= 0)
+  {
+    this->Threader->TerminateThread(clientSenderThreadId);
+  }
 
   // Close socket and remove client from the list
   int port = 0;
@@ -986,27 +1180,28 @@ void vtkPlusOpenIGTLinkServer::KeepAlive()
   std::vector< int > disconnectedClientIds;
 
   {
-    // Lock before we send message to the clients
+    // Lock before we queue messages for the clients
     PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
 
     for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
     {
+      {
+        // Keep alive is only needed if the client has nothing else to receive
+        std::lock_guard<std::mutex> queueLock(clientIterator->SendQueue->Mutex);
+        if (!clientIterator->SendQueue->Messages.empty())
+        {
+          continue;
+        }
+      }
+
       igtl::StatusMessage::Pointer replyMsg = igtl::StatusMessage::New();
       replyMsg->SetCode(igtl::StatusMessage::STATUS_OK);
       replyMsg->Pack();
 
-      int retValue = 0;
-      RETRY_UNTIL_TRUE(
-        (retValue = clientIterator->ClientSocket->Send(replyMsg->GetPackPointer(), replyMsg->GetPackSize())) != 0,
-        this->NumberOfRetryAttempts, this->DelayBetweenRetryAttemptsSec);
-      if (retValue == 0)
+      if (this->QueueMessageForSending(*clientIterator, replyMsg.GetPointer(), false) != PLUS_SUCCESS)
       {
+        LOG_DEBUG("Client " << clientIterator->ClientId << " disconnected - a previous message could not be sent to the client.");
         disconnectedClientIds.push_back(clientIterator->ClientId);
-        igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
-        replyMsg->GetTimeStamp(ts);
-
-        LOG_DEBUG("Client disconnected - could not send " << replyMsg->GetMessageType() << " message to client (device name: " << replyMsg->GetDeviceName()
-                  << "  Timestamp: " << std::fixed <<  ts->GetTimeStamp() << ").");
       }
     } // clientIterator
   } // unlock client list
@@ -1042,6 +1237,29 @@ PlusStatus vtkPlusOpenIGTLinkServer::GetClientInfo(unsigned int clientId, PlusIg
   return PLUS_FAIL;
 }
 
+//------------------------------------------------------------------------------
+void vtkPlusOpenIGTLinkServer::GetClientSendQueueStatistics(std::vector<ClientSendQueueStatistics>& outStatistics) const
+{
+  outStatistics.clear();
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+  for (std::list<ClientData>::const_iterator it = this->IgtlClients.begin(); it != this->IgtlClients.end(); ++it)
+  {
+    ClientSendQueueStatistics statistics;
+    statistics.ClientId = it->ClientId;
+    statistics.MaxQueueLength = it->ClientInfo.SendQueueMaxLength;
+    statistics.DropPolicy = it->ClientInfo.SendQueueDropPolicy;
+    statistics.QueueLength = 0;
+    statistics.PeakQueueLength = 0;
+    statistics.NumberOfSentMessages = 0;
+    statistics.NumberOfDroppedMessages = 0;
+    if (it->SendQueue)
+    {
+      it->SendQueue->GetStatistics(statistics);
+    }
+    outStatistics.push_back(statistics);
+  }
+}
+
 //------------------------------------------------------------------------------
 PlusStatus vtkPlusOpenIGTLinkServer::ReadConfiguration(vtkXMLDataElement* serverElement, const std::string& aFilename)
 {
@@ -1062,6 +1280,7 @@ PlusStatus vtkPlusOpenIGTLinkServer::ReadConfiguration(vtkXMLDataElement* server
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfRetryAttempts, serverElement);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, DelayBetweenRetryAttemptsSec, serverElement);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, KeepAliveIntervalSec, serverElement);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfCommandExecutionThreads, serverElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(SendValidTransformsOnly, serverElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(IgtlMessageCrcCheckEnabled, serverElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(LogWarningOnNoDataAvailable, serverElement);
@@ -20,7 +20,10 @@
 #include <vtkSmartPointer.h>
 
 // STL includes
+#include <condition_variable>
 #include <deque>
+#include <memory>
+#include <mutex>
 
 // OS includes
 #if (_MSC_VER == 1500)
@@ -37,9 +40,86 @@ class vtkPlusOpenIGTLinkServer;
 class vtkPlusChannel;
 class vtkPlusCommandProcessor;
 class vtkPlusCommandResponse;
+class vtkPlusNewDataNotifier;
 class vtkPlusRecursiveCriticalSection;
 class vtkPlusTransformRepository;
 
+/*! Snapshot of the state of a client's send queue */
+struct ClientSendQueueStatistics
+{
+  int ClientId;
+  unsigned int QueueLength;
+  unsigned int PeakQueueLength;
+  int MaxQueueLength;
+  PlusIgtlClientInfo::SendQueueDropPolicyType DropPolicy;
+  unsigned long NumberOfSentMessages;
+  unsigned long NumberOfDroppedMessages;
+};
+
+/*!
+  Messages waiting to be sent to a client. The queue is filled by the server threads and emptied by the
+  client's own sender thread, so a slow client cannot delay the data delivery to other clients.
+*/
+struct vtkPlusServerExport ClientSendQueue
+{
+  /*!
+    Number of messages that are allowed to wait in the queue in addition to SendQueueMaxLength.
+    Messages that must not be dropped are queued even if the queue is full, but if this many messages are still
+    waiting then the client is considered stalled and it is disconnected.
+  */
+  enum { STALLED_CLIENT_EXTRA_QUEUE_LENGTH = 500 };
+
+  ClientSendQueue()
+    : PeakLength(0)
+    , NumberOfSentMessages(0)
+    , NumberOfDroppedMessages(0)
+    , SendFailed(false)
+  {
+  }
+
+  /*!
+    Add a packed message to the queue. If the queue already contains maxQueueLength messages then the oldest droppable message
+    is discarded (or the new message, if it is droppable and no queued message is droppable). Messages that are not droppable
+    are queued beyond maxQueueLength, up to STALLED_CLIENT_EXTRA_QUEUE_LENGTH additional messages. 0 means no limit for droppable messages.
+    \return PLUS_FAIL if sending to the client has failed or the client is stalled, so the client should be disconnected
+  */
+  PlusStatus QueueMessage(igtl::MessageBase::Pointer message, bool droppable, int maxQueueLength);
+
+  /*!
+    Remove the oldest message from the queue. Waits at most timeoutMs for a message to arrive.
+    \return false if no message is available
+  */
+  bool WaitForMessage(igtl::MessageBase::Pointer& message, int timeoutMs);
+
+  /*! Called by the sender thread after it tried to send a message. If sending failed then all pending messages are discarded. */
+  void ReportSendResult(bool sent);
+
+  /*! Fill the queue length and counters of the statistics */
+  void GetStatistics(ClientSendQueueStatistics& statistics);
+
+  struct QueuedMessage
+  {
+    igtl::MessageBase::Pointer Message;
+    /// If true then the message may be discarded when the queue is full
+    bool Droppable;
+  };
+
+  /// Protects all members of the queue
+  std::mutex Mutex;
+  /// Signaled when a new message is added to the queue
+  std::condition_variable MessageQueued;
+
+  std::deque<QueuedMessage> Messages;
+
+  /// Statistics
+  unsigned int PeakLength;
+  unsigned long NumberOfSentMessages;
+  unsigned long NumberOfDroppedMessages;
+
+  /// Set by the sender thread if the client did not accept a message. The client is then disconnected by the server.
+  bool SendFailed;
+};
+
 struct ClientData
 {
   ClientData()
@@ -47,6 +127,8 @@ struct ClientData
     , ClientSocket(NULL)
     , DataReceiverActive(std::make_pair(false, false))
     , DataReceiverThreadId(-1)
+    , ClientSenderActive(std::make_pair(false, false))
+    , ClientSenderThreadId(-1)
     , Server(NULL)
   {
   }
@@ -65,6 +147,13 @@ struct ClientData
   std::pair<bool, bool> DataReceiverActive;
   int DataReceiverThreadId;
 
+  /// Active flag for the sender thread (first: request, second: respond )
+  std::pair<bool, bool> ClientSenderActive;
+  int ClientSenderThreadId;
+
+  /// Outgoing messages, shared with the client's sender thread
+  std::shared_ptr<ClientSendQueue> SendQueue;
+
   PlusIgtlClientInfo ClientInfo;
 
   vtkPlusOpenIGTLinkServer* Server;
@@ -142,6 +231,9 @@ public:
     */
   virtual PlusStatus GetClientInfo(unsigned int clientId, PlusIgtlClientInfo& outClientInfo) const;
 
+  /*! Get the current send queue length and drop statistics of all connected clients */
+  virtual void GetClientSendQueueStatistics(std::vector<ClientSendQueueStatistics>& outStatistics) const;
+
   /*! Start server */
   PlusStatus StartOpenIGTLinkService();
 
@@ -153,7 +245,8 @@ public:
   vtkGetMacro(IGTLProtocolVersion, int);
 
   /*!
-    Execute all commands in the queue from the current thread (useful if commands should be executed from the main thread)
+    Execute all commands in the queue from the current thread (useful if commands should be executed from the main thread).
+    Fast commands and, if NumberOfCommandExecutionThreads is positive, all other commands are executed on the threads of the command processor.
     \return Number of executed commands
   */
   int ProcessPendingCommands();
@@ -183,6 +276,15 @@ protected:
   /*! Thread for receiving control data from clients */
   static void* DataReceiverThread(vtkMultiThreader::ThreadInfo* data);
 
+  /*! Thread for sending the queued messages of a client */
+  static void* ClientSenderThread(vtkMultiThreader::ThreadInfo* data);
+
+  /*!
+    Add a packed message to the client's send queue, see ClientSendQueue::QueueMessage. The client list must be locked by the caller.
+    \return PLUS_FAIL if sending to the client has failed or the client is stalled, so the client should be disconnected
+  */
+  PlusStatus QueueMessageForSending(ClientData& client, igtl::MessageBase::Pointer message, bool droppable);
+
   /*! Tracked frame interface, sends the selected message type and data to all clients */
   virtual PlusStatus SendTrackedFrame(PlusTrackedFrame& trackedFrame);
 
@@ -192,7 +294,7 @@ protected:
   /*! Send status message to clients to keep alive the connection */
   virtual void KeepAlive();
 
-  /*! Stops client's data receiving thread, closes the socket, and removes the client from the client list */
+  /*! Stops client's data receiving and sending threads, closes the socket, and removes the client from the client list */
   void DisconnectClient(int clientId);
 
   /*! Set IGTL CRC check flag (0: disabled, 1: enabled) */
@@ -215,6 +317,9 @@ protected:
   vtkSetMacro(KeepAliveIntervalSec, double);
   vtkGetMacroConst(KeepAliveIntervalSec, double);
 
+  vtkSetMacro(NumberOfCommandExecutionThreads, int);
+  vtkGetMacroConst(NumberOfCommandExecutionThreads, int);
+
   vtkSetStdStringMacro(OutputChannelId);
   vtkSetStdStringMacro(ConfigFilename);
 
@@ -295,6 +400,12 @@ private:
   /*! Factory to generate commands that are invoked remotely */
   vtkSmartPointer<vtkPlusCommandProcessor> PlusCommandProcessor;
 
+  /*!
+    Number of threads that execute the long-running (default lane) commands. If 0 then these commands are executed
+    by ProcessPendingCommands(). Fast commands are always executed on a dedicated thread.
+  */
+  int NumberOfCommandExecutionThreads;
+
   /*! List of messages to be sent as replies per client*/
   ClientIdToMessageListMap MessageResponseQueue;
 
@@ -307,6 +418,10 @@ private:
   /*! Channel to use for broadcasting */
   vtkPlusChannel* BroadcastChannel;
 
+  /*! Signaled when new data is added to the broadcast channel, so that the data sender thread does not have to poll */
+  vtkSmartPointer<vtkPlusNewDataNotifier> BroadcastChannelNotifier;
+  unsigned long LastBroadcastChannelNotificationCount;
+
   bool LogWarningOnNoDataAvailable;
 
   double KeepAliveIntervalSec;
@@ -18,7 +18,7 @@ See License.txt for details.
 #include "vtkProbeFilter.h"
 #include "vtkPointData.h"
 #include "vtkIdList.h"
-#include "vtkTriangle.h"
+#include "vtkGenericCell.h"
 
 // If fraction of the transmitted beam intensity is smaller then this value then we consider the beam to be completely absorbed
 const double MINIMUM_BEAM_INTENSITY = 1e-9;
@@ -80,6 +80,7 @@ PlusSpatialModel::PlusSpatialModel(const PlusSpatialModel& model)
   SetModelLocalizer(model.ModelLocalizer);
   SetPolyData(model.PolyData);
   this->ModelFileNeedsUpdate = model.ModelFileNeedsUpdate;
+  this->ThreadModelLocalizers = model.ThreadModelLocalizers;
   this->PrecomputedAttenuations = model.PrecomputedAttenuations;
   this->TransducerSpatialModelMaxOverlapMm = model.TransducerSpatialModelMaxOverlapMm;
 }
@@ -103,6 +104,7 @@ void PlusSpatialModel::operator=(const PlusSpatialModel& model)
   SetModelLocalizer(model.ModelLocalizer);
   SetPolyData(model.PolyData);
   this->ModelFileNeedsUpdate = model.ModelFileNeedsUpdate;
+  this->ThreadModelLocalizers = model.ThreadModelLocalizers;
   this->PrecomputedAttenuations = model.PrecomputedAttenuations;
   this->TransducerSpatialModelMaxOverlapMm = model.TransducerSpatialModelMaxOverlapMm;
 }
@@ -253,18 +255,18 @@ void PlusSpatialModel::CalculateIntensity(std::vector<double>& reflectedIntensit
   }
 
   // Compute attenuation within this model
-  double intensityAttenuationCoefficientdBPerPixel = this->AttenuationCoefficientDbPerCmMhz * (distanceBetweenScanlineSamplePointsMm / 10.0) * this->ImagingFrequencyMhz;
+  // intensityTransmittedFractionPerPixelTwoWay: how big fraction of the intensity is transmitted during traversing through one voxel; takes into account both propagation directions
+  double intensityTransmittedFractionPerPixelTwoWay = GetIntensityTransmittedFractionPerPixelTwoWay(distanceBetweenScanlineSamplePointsMm);
   // intensityAttenuationCoefficientPerPixel: should be close to 1, as it's the ratio of (transmitted beam intensity / incident beam intensity) after traversing through a single pixel
-  double intensityAttenuationCoefficientPerPixel = pow(10.0, -intensityAttenuationCoefficientdBPerPixel / 10.0);
+  double intensityAttenuationCoefficientPerPixel = sqrt(intensityTransmittedFractionPerPixelTwoWay);
   // intensityAttenuatedFractionPerPixel: how big fraction of the intensity is attenuated during traversing through one voxel
   double intensityAttenuatedFractionPerPixel = (1 - intensityAttenuationCoefficientPerPixel);
-  // intensityTransmittedFractionPerPixelTwoWay: how big fraction of the intensity is transmitted during traversing through one voxel; takes into account both propagation directions
-  double intensityTransmittedFractionPerPixelTwoWay = intensityAttenuationCoefficientPerPixel * intensityAttenuationCoefficientPerPixel;
 
   transmittedIntensity = surfaceTransmittedBeamIntensity * intensityTransmittedFractionPerPixelTwoWay;
 
   if ((numberOfFilledPixels > 0 && this->PrecomputedAttenuations.size() < numberOfFilledPixels) || intensityTransmittedFractionPerPixelTwoWay != this->PrecomputedAttenuations[0])
   {
+    // Not thread-safe. When scanlines are simulated in parallel then PrepareForScanlineSimulation precomputes the table, so this is not reached.
     UpdatePrecomputedAttenuations(intensityTransmittedFractionPerPixelTwoWay, numberOfFilledPixels);
   }
 
@@ -314,7 +316,7 @@ void PlusSpatialModel::CalculateIntensity(std::vector<double>& reflectedIntensit
 }
 
 //-----------------------------------------------------------------------------
-void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference)
+void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, int threadIndex /*=0*/)
 {
   UpdateModelFile();
 
@@ -355,9 +357,16 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
   referenceToModelMatrix->MultiplyPoint(searchLineStartPoint_Reference, searchLineStartPoint_Model);
   referenceToModelMatrix->MultiplyPoint(scanLineEndPoint_Reference, scanLineEndPoint_Model);
 
+  vtkModifiedBSPTree* modelLocalizer = GetModelLocalizer(threadIndex);
+  if (modelLocalizer == NULL)
+  {
+    LOG_ERROR("SpatialModel::GetLineIntersections error: no model localizer is available for thread " << threadIndex);
+    return;
+  }
+
   vtkSmartPointer<vtkPoints> intersectionPoints_Model = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkIdList> intersectionCellIds = vtkSmartPointer<vtkIdList>::New();
-  this->ModelLocalizer->IntersectWithLine(searchLineStartPoint_Model, scanLineEndPoint_Model, 0.0, intersectionPoints_Model, intersectionCellIds);
+  modelLocalizer->IntersectWithLine(searchLineStartPoint_Model, scanLineEndPoint_Model, 0.0, intersectionPoints_Model, intersectionCellIds);
 
   if (intersectionPoints_Model->GetNumberOfPoints() < 1)
   {
@@ -411,13 +420,16 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
   referenceToModelMatrix->MultiplyPoint(scanLineDirectionVector_Reference, scanLineDirectionVector_Model);
   vtkMath::Normalize(scanLineDirectionVector_Model);
 
+  // Use a generic cell and copy normals into local buffers, as the shared cell and tuple buffers of the poly data must not be used
+  // when multiple threads compute intersections concurrently
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
   for (; intersectionPointIndex < intersectionPoints_Model->GetNumberOfPoints(); intersectionPointIndex++)
   {
     intersectionPoints_Model->GetPoint(intersectionPointIndex, intersectionPoint_Model);
     modelToReferenceMatrix->MultiplyPoint(intersectionPoint_Model, intersectionPoint_Reference);
     intersectionInfo.IntersectionDistanceFromStartPointMm = sqrt(vtkMath::Distance2BetweenPoints(scanLineStartPoint_Reference, intersectionPoint_Reference));
-    vtkTriangle* cell = vtkTriangle::SafeDownCast(this->PolyData->GetCell(intersectionCellIds->GetId(intersectionPointIndex)));
-    if (cell != NULL && normals_Model != NULL)
+    this->PolyData->GetCell(intersectionCellIds->GetId(intersectionPointIndex), cell);
+    if (cell->GetCellType() == VTK_TRIANGLE && normals_Model != NULL)
     {
       const int NUMBER_OF_POINTS_PER_CELL = 3; // triangle cell
       double pcoords[NUMBER_OF_POINTS_PER_CELL] = {0, 0, 0};
@@ -429,12 +441,8 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
       double interpolatedNormal_Model[3] = {0, 0, 0};
       for (int pointIndex = 0; pointIndex < NUMBER_OF_POINTS_PER_CELL; pointIndex++)
       {
-        double* normalAtCellCorner = normals_Model->GetTuple3(cell->GetPointId(pointIndex));
-        if (normalAtCellCorner == NULL)
-        {
-          LOG_ERROR("SpatialModel::GetLineIntersections error: invalid normal");
-          continue;
-        }
+        double normalAtCellCorner[3] = {0, 0, 0};
+        normals_Model->GetTuple(cell->GetPointId(pointIndex), normalAtCellCorner);
         interpolatedNormal_Model[0] += normalAtCellCorner[0] * weights[pointIndex];
         interpolatedNormal_Model[1] += normalAtCellCorner[1] * weights[pointIndex];
         interpolatedNormal_Model[2] += normalAtCellCorner[2] * weights[pointIndex];
@@ -466,6 +474,7 @@ PlusStatus PlusSpatialModel::UpdateModelFile()
     this->PolyData->Delete();
     this->PolyData = NULL;
   }
+  this->ThreadModelLocalizers.clear();
 
   if (this->ModelFile.empty())
   {
@@ -542,6 +551,68 @@ void PlusSpatialModel::UpdatePrecomputedAttenuations(double intensityTransmitted
   }
 }
 
+//-----------------------------------------------------------------------------
+double PlusSpatialModel::GetIntensityTransmittedFractionPerPixelTwoWay(double distanceBetweenScanlineSamplePointsMm)
+{
+  double intensityAttenuationCoefficientdBPerPixel = this->AttenuationCoefficientDbPerCmMhz * (distanceBetweenScanlineSamplePointsMm / 10.0) * this->ImagingFrequencyMhz;
+  double intensityAttenuationCoefficientPerPixel = pow(10.0, -intensityAttenuationCoefficientdBPerPixel / 10.0);
+  return intensityAttenuationCoefficientPerPixel * intensityAttenuationCoefficientPerPixel;
+}
+
+//-----------------------------------------------------------------------------
+vtkModifiedBSPTree* PlusSpatialModel::GetModelLocalizer(int threadIndex)
+{
+  if (threadIndex == 0)
+  {
+    return this->ModelLocalizer;
+  }
+  if (threadIndex < 0 || threadIndex > static_cast<int>(this->ThreadModelLocalizers.size()))
+  {
+    return NULL;
+  }
+  return this->ThreadModelLocalizers[threadIndex - 1];
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus PlusSpatialModel::PrepareForScanlineSimulation(double distanceBetweenScanlineSamplePointsMm, unsigned int numberOfSamplesPerScanline, int numberOfThreads)
+{
+  if (UpdateModelFile() != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  double intensityTransmittedFractionPerPixelTwoWay = GetIntensityTransmittedFractionPerPixelTwoWay(distanceBetweenScanlineSamplePointsMm);
+  if (numberOfSamplesPerScanline > 0
+      && (this->PrecomputedAttenuations.size() < numberOfSamplesPerScanline || intensityTransmittedFractionPerPixelTwoWay != this->PrecomputedAttenuations[0]))
+  {
+    UpdatePrecomputedAttenuations(intensityTransmittedFractionPerPixelTwoWay, numberOfSamplesPerScanline);
+  }
+
+  if (this->ModelFile.empty())
+  {
+    // background model, no localizer is needed
+    return PLUS_SUCCESS;
+  }
+  if (this->PolyData == NULL)
+  {
+    LOG_ERROR("SpatialModel " << this->Name << " surface model is not available, scanline intersections cannot be computed");
+    return PLUS_FAIL;
+  }
+
+  // Thread 0 uses the main localizer, all the other threads need their own
+  while (static_cast<int>(this->ThreadModelLocalizers.size()) < numberOfThreads - 1)
+  {
+    vtkSmartPointer<vtkModifiedBSPTree> threadModelLocalizer = vtkSmartPointer<vtkModifiedBSPTree>::New();
+    threadModelLocalizer->SetDataSet(this->PolyData);
+    threadModelLocalizer->SetMaxLevel(this->ModelLocalizer->GetMaxLevel());
+    threadModelLocalizer->SetNumberOfCellsPerNode(this->ModelLocalizer->GetNumberOfCellsPerNode());
+    threadModelLocalizer->BuildLocator();
+    this->ThreadModelLocalizers.push_back(threadModelLocalizer);
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //-----------------------------------------------------------------------------
 void PlusSpatialModel::SetModelToObjectTransform(double* matrixElements)
 {
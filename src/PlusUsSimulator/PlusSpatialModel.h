@@ -8,8 +8,10 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "vtkPlusUsSimulatorExport.h"
+#include "vtkSmartPointer.h"
 
 class vtkMatrix4x4;
 class vtkModifiedBSPTree;
@@ -69,8 +71,17 @@ public:
     The results are appended to the lineIntersections structure.
     If the line starts inside the model then the first intersection position is 0.
     The unit of the reference coordinate system must be in mm.
+    \param threadIndex Index of the calling simulation thread, selects the model localizer that is used for the intersection search.
+      Localizers for threadIndex>0 are only available after PrepareForScanlineSimulation was called with a sufficient numberOfThreads.
   */
-  void GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference);
+  void GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, int threadIndex = 0);
+
+  /*!
+    Loads the model file (if needed), builds one model localizer for each simulation thread and precomputes the attenuation table
+    for the given sample spacing. After this method succeeded GetLineIntersections and CalculateIntensity do not modify the model,
+    therefore they can be called concurrently from numberOfThreads threads (as long as numberOfFilledPixels <= numberOfSamplesPerScanline).
+  */
+  PlusStatus PrepareForScanlineSimulation(double distanceBetweenScanlineSamplePointsMm, unsigned int numberOfSamplesPerScanline, int numberOfThreads);
 
   double GetAcousticImpedanceMegarayls();
 
@@ -101,6 +112,12 @@ protected:
   PlusStatus UpdateModelFile();
   void UpdatePrecomputedAttenuations(double intensityTransmittedFractionPerPixelTwoWay, int numberOfElements);
 
+  /*! Returns the fraction of the intensity that remains after traversing through one voxel, taking into account both propagation directions */
+  double GetIntensityTransmittedFractionPerPixelTwoWay(double distanceBetweenScanlineSamplePointsMm);
+
+  /*! Returns the model localizer that the specified simulation thread may use. Returns NULL if no localizer is available for that thread. */
+  vtkModifiedBSPTree* GetModelLocalizer(int threadIndex);
+
 protected:
   //PlusStatus LoadModel(const std::string& absoluteImagePath);
 
@@ -186,6 +203,12 @@ protected:
 
   vtkModifiedBSPTree* ModelLocalizer;
 
+  /*!
+    Additional model localizers for simulation threads 1, 2, ... (thread 0 uses ModelLocalizer).
+    Line intersection search modifies internal state of the localizer, therefore each thread needs its own instance.
+  */
+  std::vector< vtkSmartPointer<vtkModifiedBSPTree> > ThreadModelLocalizers;
+
   /*! Surface mesh. Points are stored in the Model coordinate system (as in the input file) */
   vtkPolyData* PolyData;
 
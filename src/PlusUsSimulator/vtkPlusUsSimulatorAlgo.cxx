@@ -69,6 +69,9 @@ vtkPlusUsSimulatorAlgo::vtkPlusUsSimulatorAlgo()
   this->NoisePhase[1] = 0;
   this->NoisePhase[2] = 0;
 
+  this->Threader = vtkMultiThreader::New();
+  this->NumberOfThreads = 0; // 0 means not set, the default number of threads will be used
+
   // this->TransducerSpatialModel doesn't have to be initialized, as the default parameters of SpatialModel
   // are for soft tissue that should match the transducer material in acoustic impedance
 }
@@ -83,6 +86,11 @@ vtkPlusUsSimulatorAlgo::~vtkPlusUsSimulatorAlgo()
     this->RfProcessor->Delete();
     this->RfProcessor = NULL;
   }
+  if ( this->Threader != NULL )
+  {
+    this->Threader->Delete();
+    this->Threader = NULL;
+  }
   this->SetTransformRepository( NULL );
 }
 
@@ -90,6 +98,15 @@ vtkPlusUsSimulatorAlgo::~vtkPlusUsSimulatorAlgo()
 void vtkPlusUsSimulatorAlgo::PrintSelf( ostream& os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
+  os << indent << "NumberOfThreads: ";
+  if ( this->NumberOfThreads > 0 )
+  {
+    os << this->NumberOfThreads << "\n";
+  }
+  else
+  {
+    os << "default\n";
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -112,6 +129,22 @@ inline double fastPow( double a, double b )
   return u.d;
 }
 
+//-----------------------------------------------------------------------------
+namespace
+{
+  struct SimulateScanLinesThreadFunctionInfoStruct
+  {
+    vtkPlusUsSimulatorAlgo* Self;
+    vtkPlusUsScanConvert* ScanConverter;
+    vtkMatrix4x4* ImageToReferenceMatrix;
+    double DistanceBetweenScanlineSamplePointsMm;
+    unsigned char* ScanLinesPixelBuffer;
+    int NumberOfScanlines;
+    /*! Result of each thread, written only by the thread that owns the element */
+    std::vector<PlusStatus> ThreadStatus;
+  };
+}
+
 //-----------------------------------------------------------------------------
 int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector )
 {
@@ -134,9 +167,6 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
   scanLines->SetExtent( 0, this->NumberOfSamplesPerScanline - 1, 0, this->NumberOfScanlines - 1, 0, 0 );
   scanLines->AllocateScalars( VTK_UNSIGNED_CHAR, 1 );
 
-  // Create BSPTree for fast scanline-model intersection computation
-  vtkSmartPointer<vtkPoints> scanLineIntersectionWithModel = vtkSmartPointer<vtkPoints>::New();
-
   vtkPlusUsScanConvert* scanConverter = this->RfProcessor->GetScanConverter();
   if ( scanConverter == NULL )
   {
@@ -152,18 +182,6 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
 
   double distanceBetweenScanlineSamplePointsMm = scanConverter->GetDistanceBetweenScanlineSamplePointsMm();
 
-  // Initialize noise generator
-  vtkSmartPointer<vtkLineSource> noiseSamplerLine_Reference = vtkSmartPointer<vtkLineSource>::New();
-  vtkSmartPointer<vtkPerlinNoise> noiseFunction = vtkSmartPointer<vtkPerlinNoise>::New();
-  double samplePointPosition_Reference[3] = {0, 0, 0};
-  if ( this->NoiseAmplitude > 0 )
-  {
-    noiseSamplerLine_Reference->SetResolution( this->NumberOfSamplesPerScanline - 1 );
-    noiseFunction->SetAmplitude( this->NoiseAmplitude );
-    noiseFunction->SetFrequency( this->NoiseFrequency );
-    noiseFunction->SetPhase( this->NoisePhase );
-  }
-
   PlusTransformName imageToReferenceTransformName( this->GetImageCoordinateFrame(), this->GetReferenceCoordinateFrame() );
   vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   if ( this->TransformRepository->GetTransform( imageToReferenceTransformName, imageToReferenceMatrix ) != PLUS_SUCCESS )
@@ -183,18 +201,6 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
 
     return 0;
   }
-  vtkSmartPointer<vtkMatrix4x4> referenceToImageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-  vtkMatrix4x4::Invert( imageToReferenceMatrix, referenceToImageMatrix );
-
-  // Create a few variables outside the loop to avoid reallocations and to make the code easier to read
-  vtkPoints* samplePointPositions_Reference = 0;
-  // Create a buffer outside the for loop to allow reusing it
-  std::vector<double> intensities;
-  // scanline start/end positions in Image and Reference coordinate systems
-  double scanLineStartPoint_Image[4] = {0, 0, 0, 1};
-  double scanLineEndPoint_Image[4] = {0, 0, 0, 1};
-  double scanLineStartPoint_Reference[4] = {0, 0, 0, 1};
-  double scanLineEndPoint_Reference[4] = {0, 0, 0, 1};
 
   for ( std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt )
   {
@@ -212,7 +218,105 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
     spatialModelIt->SetReferenceToObjectTransform( referenceToObjectMatrix );
   }
 
-  for( int scanLineIndex = 0; scanLineIndex < this->NumberOfScanlines; scanLineIndex++ )
+  // Scanlines are simulated in parallel, each thread computes a contiguous range of scanlines
+  int numberOfThreads = ( this->NumberOfThreads > 0 ? this->NumberOfThreads : vtkMultiThreader::GetGlobalDefaultNumberOfThreads() );
+  numberOfThreads = std::max( 1, std::min( numberOfThreads, this->NumberOfScanlines ) );
+  this->Threader->SetNumberOfThreads( numberOfThreads );
+
+  // Threads only read the spatial models, so everything that is computed on demand (model loading,
+  // per-thread localizers, attenuation tables) must be prepared here
+  for ( std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt )
+  {
+    if ( spatialModelIt->PrepareForScanlineSimulation( distanceBetweenScanlineSamplePointsMm, this->NumberOfSamplesPerScanline, numberOfThreads ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( "Failed to prepare " << spatialModelIt->GetName() << " SpatialModel for simulation" );
+      return 0;
+    }
+  }
+
+  SimulateScanLinesThreadFunctionInfoStruct str;
+  str.Self = this;
+  str.ScanConverter = scanConverter;
+  str.ImageToReferenceMatrix = imageToReferenceMatrix;
+  str.DistanceBetweenScanlineSamplePointsMm = distanceBetweenScanlineSamplePointsMm;
+  str.ScanLinesPixelBuffer = static_cast<unsigned char*>( scanLines->GetScalarPointer() );
+  str.NumberOfScanlines = this->NumberOfScanlines;
+  str.ThreadStatus.assign( numberOfThreads, PLUS_SUCCESS );
+
+  this->Threader->SetSingleMethod( SimulateScanLinesThreadFunction, &str );
+  this->Threader->SingleMethodExecute();
+
+  for ( int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++ )
+  {
+    if ( str.ThreadStatus[threadIndex] != PLUS_SUCCESS )
+    {
+      return 0;
+    }
+  }
+
+  vtkImageData* simulatedUsImage = vtkImageData::SafeDownCast( outInfo->Get( vtkDataObject::DATA_OBJECT() ) );
+  if ( simulatedUsImage == NULL )
+  {
+    LOG_ERROR( "vtkPlusUsSimulatorAlgo output type is invalid" );
+    return 0;
+  }
+  this->RfProcessor->SetRfFrame( scanLines, US_IMG_BRIGHTNESS );
+  simulatedUsImage->DeepCopy( this->RfProcessor->GetBrightnessScanConvertedImage() );
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusUsSimulatorAlgo::SimulateScanLinesThreadFunction( void* arg )
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>( arg );
+  SimulateScanLinesThreadFunctionInfoStruct* str = static_cast<SimulateScanLinesThreadFunctionInfoStruct*>( threadInfo->UserData );
+
+  // Compute which scanlines will be processed by this thread (contiguous ranges, to keep each thread writing its own memory region)
+  int threadId = threadInfo->ThreadID;
+  int threadCount = threadInfo->NumberOfThreads;
+  int scanLinesPerThread = ( str->NumberOfScanlines + threadCount - 1 ) / threadCount;
+  int firstScanLineIndex = threadId * scanLinesPerThread;
+  int lastScanLineIndex = std::min( firstScanLineIndex + scanLinesPerThread, str->NumberOfScanlines ) - 1;
+  if ( firstScanLineIndex > lastScanLineIndex )
+  {
+    // no scanlines are left for this thread
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  str->ThreadStatus[threadId] = str->Self->SimulateScanLines( firstScanLineIndex, lastScanLineIndex, threadId, str->ScanConverter,
+                                str->ImageToReferenceMatrix, str->DistanceBetweenScanlineSamplePointsMm, str->ScanLinesPixelBuffer );
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusUsSimulatorAlgo::SimulateScanLines( int firstScanLineIndex, int lastScanLineIndex, int threadIndex, vtkPlusUsScanConvert* scanConverter,
+    vtkMatrix4x4* imageToReferenceMatrix, double distanceBetweenScanlineSamplePointsMm, unsigned char* scanLinesPixelBuffer )
+{
+  // Initialize noise generator (each thread has its own, as the line source output is overwritten for each scanline)
+  vtkSmartPointer<vtkLineSource> noiseSamplerLine_Reference = vtkSmartPointer<vtkLineSource>::New();
+  vtkSmartPointer<vtkPerlinNoise> noiseFunction = vtkSmartPointer<vtkPerlinNoise>::New();
+  double samplePointPosition_Reference[3] = {0, 0, 0};
+  if ( this->NoiseAmplitude > 0 )
+  {
+    noiseSamplerLine_Reference->SetResolution( this->NumberOfSamplesPerScanline - 1 );
+    noiseFunction->SetAmplitude( this->NoiseAmplitude );
+    noiseFunction->SetFrequency( this->NoiseFrequency );
+    noiseFunction->SetPhase( this->NoisePhase );
+  }
+
+  // Create a few variables outside the loop to avoid reallocations and to make the code easier to read
+  vtkPoints* samplePointPositions_Reference = 0;
+  // Create buffers outside the for loop to allow reusing them
+  std::vector<double> intensities( this->NumberOfSamplesPerScanline );
+  std::deque<PlusSpatialModel::LineIntersectionInfo> lineIntersectionsWithModels;
+  // scanline start/end positions in Image and Reference coordinate systems
+  double scanLineStartPoint_Image[4] = {0, 0, 0, 1};
+  double scanLineEndPoint_Image[4] = {0, 0, 0, 1};
+  double scanLineStartPoint_Reference[4] = {0, 0, 0, 1};
+  double scanLineEndPoint_Reference[4] = {0, 0, 0, 1};
+
+  for( int scanLineIndex = firstScanLineIndex; scanLineIndex <= lastScanLineIndex; scanLineIndex++ )
   {
     scanConverter->GetScanLineEndPoints( scanLineIndex, scanLineStartPoint_Image, scanLineEndPoint_Image );
     imageToReferenceMatrix->MultiplyPoint( scanLineStartPoint_Image, scanLineStartPoint_Reference );
@@ -227,24 +331,23 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
     }
 
     // Get model intersection positions along the scanline for all the models
-    std::deque<PlusSpatialModel::LineIntersectionInfo> lineIntersectionsWithModels;
+    lineIntersectionsWithModels.clear();
     for ( std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt )
     {
       // Append line intersections found with this model to lineIntersectionsWithModels
-      spatialModelIt->GetLineIntersections( lineIntersectionsWithModels, scanLineStartPoint_Reference, scanLineEndPoint_Reference );
+      spatialModelIt->GetLineIntersections( lineIntersectionsWithModels, scanLineStartPoint_Reference, scanLineEndPoint_Reference, threadIndex );
     }
 
     ConvertLineModelIntersectionsToSegmentDescriptor( lineIntersectionsWithModels );
 
     int currentPixelIndex = 0;
-    int scanLineExtent[6] = {0, this->NumberOfSamplesPerScanline - 1, scanLineIndex, scanLineIndex, 0, 0};
-    unsigned char* dstPixelAddress = ( unsigned char* )scanLines->GetScalarPointerForExtent( scanLineExtent );
+    unsigned char* dstPixelAddress = scanLinesPixelBuffer + scanLineIndex * this->NumberOfSamplesPerScanline;
     double incomingBeamIntensity = this->IncomingIntensityMwPerCm2 * 1000;
     int numIntersectionPoints = lineIntersectionsWithModels.size();
     if ( numIntersectionPoints < 1 )
     {
       LOG_ERROR( "No intersections with any SpatialObjects. Probably no background object is specified." );
-      return 0;
+      return PLUS_FAIL;
     }
     PlusSpatialModel* previousModel = &this->TransducerSpatialModel;
     for( vtkIdType intersectionIndex = 0; ( intersectionIndex <= numIntersectionPoints ) && ( currentPixelIndex < this->NumberOfSamplesPerScanline ); intersectionIndex++ )
@@ -313,17 +416,10 @@ int vtkPlusUsSimulatorAlgo::RequestData( vtkInformation* request, vtkInformation
     }
   }
 
-  vtkImageData* simulatedUsImage = vtkImageData::SafeDownCast( outInfo->Get( vtkDataObject::DATA_OBJECT() ) );
-  if ( simulatedUsImage == NULL )
-  {
-    LOG_ERROR( "vtkPlusUsSimulatorAlgo output type is invalid" );
-    return 0;
-  }
-  this->RfProcessor->SetRfFrame( scanLines, US_IMG_BRIGHTNESS );
-  simulatedUsImage->DeepCopy( this->RfProcessor->GetBrightnessScanConvertedImage() );
-  return 1;
+  return PLUS_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
 bool lineIntersectionLessThan( PlusSpatialModel::LineIntersectionInfo a, PlusSpatialModel::LineIntersectionInfo b )
 {
   return a.IntersectionDistanceFromStartPointMm < b.IntersectionDistanceFromStartPointMm;
@@ -405,6 +501,7 @@ PlusStatus vtkPlusUsSimulatorAlgo::ReadConfiguration( vtkXMLDataElement* config
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL( double, NoiseAmplitude, usSimulatorAlgoElement );
   XML_READ_VECTOR_ATTRIBUTE_OPTIONAL( double, 3, NoiseFrequency, usSimulatorAlgoElement );
   XML_READ_VECTOR_ATTRIBUTE_OPTIONAL( double, 3, NoisePhase, usSimulatorAlgoElement );
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL( int, NumberOfThreads, usSimulatorAlgoElement );
   XML_READ_CSTRING_ATTRIBUTE_REQUIRED( ImageCoordinateFrame, usSimulatorAlgoElement );
   XML_READ_CSTRING_ATTRIBUTE_REQUIRED( ReferenceCoordinateFrame, usSimulatorAlgoElement );
 
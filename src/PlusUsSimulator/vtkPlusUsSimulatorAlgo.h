@@ -10,6 +10,7 @@
 #include "vtkPlusUsSimulatorExport.h"
 
 #include "vtkImageAlgorithm.h"
+#include "vtkMultiThreader.h"
 
 #include "PlusSpatialModel.h"
 #include "vtkPlusTransformRepository.h"
@@ -19,6 +20,7 @@ class vtkTriangleFilter;
 class vtkStripper;
 class vtkModifiedBSPTree;
 class vtkPlusRfProcessor;
+class vtkPlusUsScanConvert;
 
 /*!
   \class vtkPlusUsSimulatorAlgo
@@ -89,6 +91,11 @@ public:
   vtkSetVector3Macro( NoiseFrequency, double );
   vtkSetVector3Macro( NoisePhase, double );
 
+  /*! Set number of threads used for simulating scanlines. If 0 (default) then the number of available processors is used. */
+  vtkSetMacro( NumberOfThreads, int );
+  /*! Get number of threads used for simulating scanlines */
+  vtkGetMacro( NumberOfThreads, int );
+
 protected:
   virtual int FillOutputPortInformation( int port, vtkInformation* info );
   virtual int RequestData( vtkInformation* request,
@@ -97,6 +104,17 @@ protected:
 
   void ConvertLineModelIntersectionsToSegmentDescriptor( std::deque<PlusSpatialModel::LineIntersectionInfo>& lineIntersectionsWithModels );
 
+  /*! Thread function that simulates a contiguous range of scanlines. Each thread only writes its own rows of the scanline image. */
+  static VTK_THREAD_RETURN_TYPE SimulateScanLinesThreadFunction( void* arg );
+
+  /*!
+    Simulate scanlines [firstScanLineIndex, lastScanLineIndex] and write the pixel values into the corresponding rows of scanLinesPixelBuffer.
+    Spatial models must be prepared by PrepareForScanlineSimulation before calling this method.
+    All the temporary buffers are allocated by the caller thread, so this method can be called concurrently for non-overlapping scanline ranges.
+  */
+  PlusStatus SimulateScanLines( int firstScanLineIndex, int lastScanLineIndex, int threadIndex, vtkPlusUsScanConvert* scanConverter,
+                                vtkMatrix4x4* imageToReferenceMatrix, double distanceBetweenScanlineSamplePointsMm, unsigned char* scanLinesPixelBuffer );
+
 protected:
   vtkPlusUsSimulatorAlgo();
   ~vtkPlusUsSimulatorAlgo();
@@ -146,6 +164,12 @@ private:
   double NoiseAmplitude;
   double NoiseFrequency[3];
   double NoisePhase[3];
+
+  /*! Multithreader used for simulating scanlines in parallel */
+  vtkMultiThreader* Threader;
+
+  /*! Number of threads used for simulating scanlines. 0 means the number of available processors. */
+  int NumberOfThreads;
 };
 
 #endif // __vtkPlusUsSimulatorAlgo_h
@@ -0,0 +1,262 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+
+#include "PlusBrickedVolume.h"
+
+#include "vtkAbstractArray.h"
+#include "vtkImageData.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+//----------------------------------------------------------------------------
+PlusBrickedVolume::PlusBrickedVolume()
+  : ScalarType(VTK_UNSIGNED_CHAR)
+  , NumberOfScalarComponents(1)
+  , TotalNumberOfBricks(0)
+  , BrickScalarsSizeInBytes(0)
+  , BrickSizeInBytes(0)
+  , Bricks(NULL)
+  , DiscardBrick(NULL)
+  , NumberOfAllocatedBricks(0)
+  , NumberOfFailedBrickAllocations(0)
+{
+  for (int i = 0; i < 3; i++)
+  {
+    this->Extent[i * 2] = 0;
+    this->Extent[i * 2 + 1] = -1;
+    this->NumberOfBricks[i] = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+PlusBrickedVolume::~PlusBrickedVolume()
+{
+  this->Release();
+}
+
+//----------------------------------------------------------------------------
+void PlusBrickedVolume::Release()
+{
+  if (this->Bricks != NULL)
+  {
+    for (vtkIdType brickIndex = 0; brickIndex < this->TotalNumberOfBricks; brickIndex++)
+    {
+      free(this->Bricks[brickIndex].load());
+    }
+    delete[] this->Bricks;
+    this->Bricks = NULL;
+  }
+  free(this->DiscardBrick);
+  this->DiscardBrick = NULL;
+  this->TotalNumberOfBricks = 0;
+  this->NumberOfAllocatedBricks = 0;
+  this->NumberOfFailedBrickAllocations = 0;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusBrickedVolume::Allocate(const int extent[6], int scalarType, int numberOfScalarComponents)
+{
+  this->Release();
+
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+  {
+    LOG_ERROR("PlusBrickedVolume::Allocate failed: invalid extent ["
+              << extent[0] << ", " << extent[1] << ", " << extent[2] << ", " << extent[3] << ", " << extent[4] << ", " << extent[5] << "]");
+    return PLUS_FAIL;
+  }
+  int scalarSize = vtkAbstractArray::GetDataTypeSize(scalarType);
+  if (scalarSize <= 0 || numberOfScalarComponents < 1)
+  {
+    LOG_ERROR("PlusBrickedVolume::Allocate failed: invalid scalar type (" << scalarType << ") or number of components (" << numberOfScalarComponents << ")");
+    return PLUS_FAIL;
+  }
+
+  this->ScalarType = scalarType;
+  this->NumberOfScalarComponents = numberOfScalarComponents;
+  this->TotalNumberOfBricks = 1;
+  for (int i = 0; i < 3; i++)
+  {
+    this->Extent[i * 2] = extent[i * 2];
+    this->Extent[i * 2 + 1] = extent[i * 2 + 1];
+    this->NumberOfBricks[i] = (extent[i * 2 + 1] - extent[i * 2] + BRICK_SIZE) / BRICK_SIZE;
+    this->TotalNumberOfBricks *= this->NumberOfBricks[i];
+  }
+
+  // The accumulation buffer block follows the voxel scalars. The scalars block size is a multiple of BRICK_NUMBER_OF_VOXELS,
+  // so the accumulation buffer values are always properly aligned.
+  this->BrickScalarsSizeInBytes = size_t(BRICK_NUMBER_OF_VOXELS) * numberOfScalarComponents * scalarSize;
+  this->BrickSizeInBytes = this->BrickScalarsSizeInBytes + size_t(BRICK_NUMBER_OF_VOXELS) * sizeof(unsigned short);
+
+  this->Bricks = new std::atomic<unsigned char*>[this->TotalNumberOfBricks];
+  for (vtkIdType brickIndex = 0; brickIndex < this->TotalNumberOfBricks; brickIndex++)
+  {
+    this->Bricks[brickIndex].store(NULL);
+  }
+  this->DiscardBrick = static_cast<unsigned char*>(calloc(1, this->BrickSizeInBytes));
+  if (this->DiscardBrick == NULL)
+  {
+    LOG_ERROR("PlusBrickedVolume::Allocate failed: out of memory");
+    this->Release();
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+unsigned char* PlusBrickedVolume::AllocateBrick(vtkIdType brickIndex)
+{
+  unsigned char* newBrick = static_cast<unsigned char*>(calloc(1, this->BrickSizeInBytes));
+  if (newBrick == NULL)
+  {
+    ++this->NumberOfFailedBrickAllocations;
+    return this->DiscardBrick;
+  }
+  unsigned char* existingBrick = NULL;
+  if (!this->Bricks[brickIndex].compare_exchange_strong(existingBrick, newBrick, std::memory_order_acq_rel, std::memory_order_acquire))
+  {
+    // another thread has allocated the brick in the meantime
+    free(newBrick);
+    return existingBrick;
+  }
+  ++this->NumberOfAllocatedBricks;
+  return newBrick;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusBrickedVolume::ExportToImageData(const int extent[6], vtkImageData* volume, vtkImageData* accumulationBuffer)
+{
+  if (this->Bricks == NULL)
+  {
+    LOG_ERROR("PlusBrickedVolume::ExportToImageData failed: volume is not allocated");
+    return PLUS_FAIL;
+  }
+  if (volume != NULL && (volume->GetScalarType() != this->ScalarType || volume->GetNumberOfScalarComponents() != this->NumberOfScalarComponents))
+  {
+    LOG_ERROR("PlusBrickedVolume::ExportToImageData failed: volume scalar type or number of components does not match");
+    return PLUS_FAIL;
+  }
+  if (accumulationBuffer != NULL && (accumulationBuffer->GetScalarType() != VTK_UNSIGNED_SHORT || accumulationBuffer->GetNumberOfScalarComponents() != 1))
+  {
+    LOG_ERROR("PlusBrickedVolume::ExportToImageData failed: accumulation buffer must have unsigned short scalar type and 1 component");
+    return PLUS_FAIL;
+  }
+  vtkImageData* images[2] = { volume, accumulationBuffer };
+  for (int imageIndex = 0; imageIndex < 2; imageIndex++)
+  {
+    if (images[imageIndex] == NULL)
+    {
+      continue;
+    }
+    int* imageExtent = images[imageIndex]->GetExtent();
+    if (!std::equal(imageExtent, imageExtent + 6, this->Extent))
+    {
+      LOG_ERROR("PlusBrickedVolume::ExportToImageData failed: image extent does not match the volume extent");
+      return PLUS_FAIL;
+    }
+  }
+
+  // Voxel index range to export, relative to the extent minimum
+  int minId[3] = { 0 };
+  int maxId[3] = { 0 };
+  for (int i = 0; i < 3; i++)
+  {
+    minId[i] = std::max(extent[i * 2], this->Extent[i * 2]) - this->Extent[i * 2];
+    maxId[i] = std::min(extent[i * 2 + 1], this->Extent[i * 2 + 1]) - this->Extent[i * 2];
+    if (minId[i] > maxId[i])
+    {
+      // empty extent
+      return PLUS_SUCCESS;
+    }
+  }
+
+  const size_t voxelSizeInBytes = this->BrickScalarsSizeInBytes / BRICK_NUMBER_OF_VOXELS;
+  unsigned char* volumePtr = (volume != NULL ? static_cast<unsigned char*>(volume->GetScalarPointer()) : NULL);
+  unsigned short* accPtr = (accumulationBuffer != NULL ? static_cast<unsigned short*>(accumulationBuffer->GetScalarPointer()) : NULL);
+  const vtkIdType dimX = this->Extent[1] - this->Extent[0] + 1;
+  const vtkIdType dimY = this->Extent[3] - this->Extent[2] + 1;
+
+  // Copy row segments, one brick at a time
+  for (int brickZ = minId[2] >> BRICK_SIZE_BITS; brickZ <= maxId[2] >> BRICK_SIZE_BITS; brickZ++)
+  {
+    for (int brickY = minId[1] >> BRICK_SIZE_BITS; brickY <= maxId[1] >> BRICK_SIZE_BITS; brickY++)
+    {
+      for (int brickX = minId[0] >> BRICK_SIZE_BITS; brickX <= maxId[0] >> BRICK_SIZE_BITS; brickX++)
+      {
+        vtkIdType brickIndex = brickX + brickY * this->NumberOfBricks[0] + vtkIdType(brickZ) * this->NumberOfBricks[0] * this->NumberOfBricks[1];
+        const unsigned char* brick = this->Bricks[brickIndex].load(std::memory_order_acquire);
+        int startX = std::max(minId[0], brickX << BRICK_SIZE_BITS);
+        int endX = std::min(maxId[0], ((brickX + 1) << BRICK_SIZE_BITS) - 1);
+        size_t rowLength = endX - startX + 1;
+        for (int idZ = std::max(minId[2], brickZ << BRICK_SIZE_BITS); idZ <= std::min(maxId[2], ((brickZ + 1) << BRICK_SIZE_BITS) - 1); idZ++)
+        {
+          for (int idY = std::max(minId[1], brickY << BRICK_SIZE_BITS); idY <= std::min(maxId[1], ((brickY + 1) << BRICK_SIZE_BITS) - 1); idY++)
+          {
+            vtkIdType imageVoxelIndex = startX + idY * dimX + idZ * dimX * dimY;
+            int brickVoxelIndex = (startX & (BRICK_SIZE - 1))
+                                  | ((idY & (BRICK_SIZE - 1)) << BRICK_SIZE_BITS)
+                                  | ((idZ & (BRICK_SIZE - 1)) << (2 * BRICK_SIZE_BITS));
+            if (volumePtr != NULL)
+            {
+              if (brick != NULL)
+              {
+                memcpy(volumePtr + imageVoxelIndex * voxelSizeInBytes, brick + brickVoxelIndex * voxelSizeInBytes, rowLength * voxelSizeInBytes);
+              }
+              else
+              {
+                memset(volumePtr + imageVoxelIndex * voxelSizeInBytes, 0, rowLength * voxelSizeInBytes);
+              }
+            }
+            if (accPtr != NULL)
+            {
+              if (brick != NULL)
+              {
+                memcpy(accPtr + imageVoxelIndex, reinterpret_cast<const unsigned short*>(brick + this->BrickScalarsSizeInBytes) + brickVoxelIndex, rowLength * sizeof(unsigned short));
+              }
+              else
+              {
+                memset(accPtr + imageVoxelIndex, 0, rowLength * sizeof(unsigned short));
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (volume != NULL)
+  {
+    volume->Modified();
+  }
+  if (accumulationBuffer != NULL)
+  {
+    accumulationBuffer->Modified();
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType PlusBrickedVolume::GetNumberOfAllocatedBricks() const
+{
+  return this->NumberOfAllocatedBricks.load();
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 PlusBrickedVolume::GetAllocatedMemorySize() const
+{
+  return vtkTypeUInt64(this->NumberOfAllocatedBricks.load()) * this->BrickSizeInBytes
+         + vtkTypeUInt64(this->TotalNumberOfBricks) * sizeof(std::atomic<unsigned char*>);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType PlusBrickedVolume::GetNumberOfFailedBrickAllocations() const
+{
+  return this->NumberOfFailedBrickAllocations.load();
+}
@@ -0,0 +1,136 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusBrickedVolume_h
+#define __PlusBrickedVolume_h
+
+#include "PlusConfigure.h"
+#include "vtkPlusVolumeReconstructionExport.h"
+
+#include <atomic>
+
+class vtkImageData;
+
+/*!
+  \class PlusBrickedVolume
+  \brief Sparse storage of a reconstructed volume and its accumulation buffer
+
+  The volume is divided into bricks of BRICK_SIZE x BRICK_SIZE x BRICK_SIZE voxels. Memory for a brick
+  is only allocated when a voxel of the brick is first accessed for writing. A freehand sweep only touches
+  a thin sheet of the bounding box of all the frames, so most of the bricks are never allocated.
+  Each brick stores the voxel scalars followed by the accumulation buffer values of the same voxels,
+  therefore pasting a pixel only touches one cache-friendly memory block.
+
+  Bricks may be allocated concurrently from multiple threads. Accessing the same voxel from multiple threads
+  is not synchronized (same as in a dense vtkImageData volume).
+
+  \sa vtkPlusPasteSliceIntoVolume
+  \ingroup PlusLibVolumeReconstruction
+*/
+class vtkPlusVolumeReconstructionExport PlusBrickedVolume
+{
+public:
+  /*! Number of bits in the voxel index within a brick */
+  static const int BRICK_SIZE_BITS = 4;
+  /*! Number of voxels along each axis of a brick */
+  static const int BRICK_SIZE = 1 << BRICK_SIZE_BITS;
+  /*! Number of voxels in a brick */
+  static const int BRICK_NUMBER_OF_VOXELS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+  PlusBrickedVolume();
+  virtual ~PlusBrickedVolume();
+
+  /*!
+    Set up the brick table for the volume. All previously allocated bricks are released,
+    all voxels (and accumulation buffer values) are considered to be 0.
+    \param extent Extent of the volume (voxel indices are relative to the extent minimum)
+    \param scalarType VTK scalar type of the volume voxels
+    \param numberOfScalarComponents Number of scalar components of the volume voxels
+  */
+  PlusStatus Allocate(const int extent[6], int scalarType, int numberOfScalarComponents);
+
+  /*! Release all bricks and the brick table */
+  void Release();
+
+  /*! Returns true if the brick table has been allocated */
+  bool IsAllocated() const { return this->Bricks != NULL; }
+
+  /*! Get the VTK scalar type of the volume voxels */
+  int GetScalarType() const { return this->ScalarType; }
+
+  /*!
+    Get pointers to a voxel (first scalar component) and to its accumulation buffer value.
+    The brick containing the voxel is allocated if it has not been allocated yet.
+    Voxel indices are relative to the extent minimum and must be inside the volume.
+    T must match the scalar type specified in Allocate.
+  */
+  template <class T>
+  inline void GetVoxelPointers(int idX, int idY, int idZ, T*& voxelPtr, unsigned short*& accPtr)
+  {
+    vtkIdType brickIndex = (idX >> BRICK_SIZE_BITS) + (idY >> BRICK_SIZE_BITS) * this->NumberOfBricks[0]
+                           + vtkIdType(idZ >> BRICK_SIZE_BITS) * this->NumberOfBricks[0] * this->NumberOfBricks[1];
+    unsigned char* brick = this->Bricks[brickIndex].load(std::memory_order_acquire);
+    if (brick == NULL)
+    {
+      brick = this->AllocateBrick(brickIndex);
+    }
+    int voxelIndex = (idX & (BRICK_SIZE - 1))
+                     | ((idY & (BRICK_SIZE - 1)) << BRICK_SIZE_BITS)
+                     | ((idZ & (BRICK_SIZE - 1)) << (2 * BRICK_SIZE_BITS));
+    voxelPtr = reinterpret_cast<T*>(brick) + voxelIndex * this->NumberOfScalarComponents;
+    accPtr = reinterpret_cast<unsigned short*>(brick + this->BrickScalarsSizeInBytes) + voxelIndex;
+  }
+
+  /*!
+    Copy the voxels in the specified extent into dense images. Voxels of bricks that have not been allocated are set to 0.
+    The volume and accumulation buffer images must be allocated already: the volume with the scalar type and number of components
+    specified in Allocate, the accumulation buffer with unsigned short scalar type and 1 component, both with the volume extent.
+    Either image may be NULL, if it is not needed.
+  */
+  PlusStatus ExportToImageData(const int extent[6], vtkImageData* volume, vtkImageData* accumulationBuffer);
+
+  /*! Get the number of bricks that have been allocated */
+  vtkIdType GetNumberOfAllocatedBricks() const;
+
+  /*! Get the memory used by the allocated bricks, in bytes */
+  vtkTypeUInt64 GetAllocatedMemorySize() const;
+
+  /*!
+    Get the number of times a brick could not be allocated since the last Allocate call.
+    Voxels in such bricks are discarded.
+  */
+  vtkIdType GetNumberOfFailedBrickAllocations() const;
+
+protected:
+  /*! Allocate a zero-filled brick and store it in the brick table (if another thread allocated it in the meantime then that brick is returned) */
+  unsigned char* AllocateBrick(vtkIdType brickIndex);
+
+  int Extent[6];
+  int ScalarType;
+  int NumberOfScalarComponents;
+  int NumberOfBricks[3];
+  vtkIdType TotalNumberOfBricks;
+
+  /*! Size of the voxel scalars block of a brick, the accumulation buffer block follows it */
+  size_t BrickScalarsSizeInBytes;
+  /*! Size of a brick (voxel scalars and accumulation buffer) */
+  size_t BrickSizeInBytes;
+
+  /*! Brick table, NULL for bricks that have not been allocated yet */
+  std::atomic<unsigned char*>* Bricks;
+
+  /*! Voxels are written here if memory could not be allocated for a brick, the content is not used */
+  unsigned char* DiscardBrick;
+
+  std::atomic<vtkIdType> NumberOfAllocatedBricks;
+  std::atomic<vtkIdType> NumberOfFailedBrickAllocations;
+
+private:
+  PlusBrickedVolume(const PlusBrickedVolume&);
+  void operator=(const PlusBrickedVolume&);
+};
+
+#endif
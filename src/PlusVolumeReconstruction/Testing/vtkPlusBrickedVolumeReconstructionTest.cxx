@@ -0,0 +1,357 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusBrickedVolumeReconstructionTest.cxx
+  \brief Checks that volume reconstruction with bricked storage gives exactly the same volume as dense storage
+
+  Synthetic frames are inserted in several batches into a reconstructor that uses bricked storage and into one
+  that uses dense storage. After each batch the dense output is exported from the bricks (only the modified region
+  is copied if the dense output is still allocated) and compared voxel by voxel to the dense reconstruction.
+  The test also checks that the dense output is released after a snapshot of a bricked volume reconstructor,
+  and that the output is cleared when the reconstruction is reset in the middle of the sweep.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "PlusTrackedFrame.h"
+#include "vtkImageData.h"
+#include "vtkMatrix4x4.h"
+#include "vtkPlusPasteSliceIntoVolume.h"
+#include "vtkPlusVolumeReconstructor.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+#include "vtkXMLDataElement.h"
+#include "vtkXMLUtilities.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+#include <sstream>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  const int FRAME_SIZE_X = 64;
+  const int FRAME_SIZE_Y = 48;
+  const int NUMBER_OF_FRAMES = 24;
+  const int NUMBER_OF_FRAMES_PER_BATCH = 6;
+  /*! The reconstruction is reset after this batch */
+  const int RESET_AFTER_BATCH = 1;
+}
+
+//----------------------------------------------------------------------------
+void CreateTestData(std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  PlusTesting::TestRandomGenerator random;
+  for ( int frameIndex = 0; frameIndex < NUMBER_OF_FRAMES; frameIndex++ )
+  {
+    vtkSmartPointer<vtkImageData> frame = vtkSmartPointer<vtkImageData>::New();
+    frame->SetExtent( 0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0 );
+    frame->AllocateScalars( VTK_UNSIGNED_CHAR, 1 );
+    unsigned char* pixelPtr = static_cast<unsigned char*>( frame->GetScalarPointer() );
+    for ( int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++ )
+    {
+      // avoid 0 so that all inserted pixels are distinguishable from empty voxels
+      pixelPtr[i] = static_cast<unsigned char>( 1 + random.Next() % 255 );
+    }
+    frames.push_back( frame );
+
+    // Sparse sweep that covers only part of the volume, so that many bricks remain unallocated.
+    // Every second slice is at the other end of the volume, so that consecutive batches modify different bricks.
+    int slicePosition = ( frameIndex % 2 == 0 ) ? frameIndex / 2 : NUMBER_OF_FRAMES - 1 - frameIndex / 2;
+    vtkSmartPointer<vtkTransform> imageToReference = vtkSmartPointer<vtkTransform>::New();
+    imageToReference->Translate( 1.0 + random.Uniform( -0.3, 0.3 ), 1.0 + random.Uniform( -0.3, 0.3 ), 1.0 + slicePosition * 1.2 + random.Uniform( -0.2, 0.2 ) );
+    imageToReference->RotateX( random.Uniform( -10.0, 10.0 ) );
+    imageToReference->RotateY( random.Uniform( -10.0, 10.0 ) );
+    imageToReference->Scale( 0.4, 0.4, 0.4 );
+    vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    imageToReference->GetMatrix( imageToReferenceMatrix );
+    imageToReferenceTransforms.push_back( imageToReferenceMatrix );
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Checks that the voxels of the image are released but its geometry is kept */
+bool IsImageReleased(vtkImageData* image, const int expectedExtent[6])
+{
+  if ( image->GetPointData()->GetScalars() != NULL )
+  {
+    LOG_ERROR( "Image voxels are not released" );
+    return false;
+  }
+  int* extent = image->GetExtent();
+  for ( int i = 0; i < 6; i++ )
+  {
+    if ( extent[i] != expectedExtent[i] )
+    {
+      LOG_ERROR( "Image geometry is not kept when the voxels are released" );
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ConfigurePasteSlice(vtkPlusPasteSliceIntoVolume* reconstructor, bool brickedStorage)
+{
+  reconstructor->SetOutputOrigin( 0.0, 0.0, 0.0 );
+  reconstructor->SetOutputSpacing( 0.5, 0.5, 0.5 );
+  reconstructor->SetOutputExtent( 0, 59, 0, 49, 0, 59 );
+  reconstructor->SetOptimization( vtkPlusPasteSliceIntoVolume::FULL_OPTIMIZATION );
+  reconstructor->SetInterpolationMode( vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION );
+  reconstructor->SetCompoundingMode( vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE );
+  // the result depends on the order of pixel insertion, so it is only reproducible with one thread
+  reconstructor->SetNumberOfThreads( 1 );
+  reconstructor->SetEnableBrickedStorage( brickedStorage );
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Test the export of the bricked volume to the dense output (UpdateDenseOutputFromBricks),
+  the release of the dense output and the reset of the bricked output (ResetBrickedOutput).
+*/
+int TestPasteSliceDenseExport(std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  LOG_INFO( "Test dense export of the bricked volume" );
+  int numberOfFailures = 0;
+
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> brickedReconstructor = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  ConfigurePasteSlice( brickedReconstructor, true );
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> denseReconstructor = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  ConfigurePasteSlice( denseReconstructor, false );
+  if ( brickedReconstructor->ResetOutput() != PLUS_SUCCESS || denseReconstructor->ResetOutput() != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to reset reconstructor output" );
+    return 1;
+  }
+  int outputExtent[6] = { 0 };
+  brickedReconstructor->GetOutputExtent( outputExtent );
+
+  for ( int batchIndex = 0; batchIndex * NUMBER_OF_FRAMES_PER_BATCH < NUMBER_OF_FRAMES; batchIndex++ )
+  {
+    int firstFrameIndex = batchIndex * NUMBER_OF_FRAMES_PER_BATCH;
+    int lastFrameIndex = firstFrameIndex + NUMBER_OF_FRAMES_PER_BATCH - 1;
+    for ( int frameIndex = firstFrameIndex; frameIndex <= lastFrameIndex; frameIndex++ )
+    {
+      if ( brickedReconstructor->InsertSlice( frames[frameIndex], imageToReferenceTransforms[frameIndex] ) != PLUS_SUCCESS
+           || denseReconstructor->InsertSlice( frames[frameIndex], imageToReferenceTransforms[frameIndex] ) != PLUS_SUCCESS )
+      {
+        LOG_ERROR( "Failed to insert slice " << frameIndex );
+        return numberOfFailures + 1;
+      }
+    }
+
+    // After the first batch the dense output is already allocated, so only the modified region is exported
+    if ( !PlusTesting::AreVolumesEqual( denseReconstructor->GetReconstructedVolume(), brickedReconstructor->GetReconstructedVolume() ) )
+    {
+      LOG_ERROR( "Reconstructed volume exported from the bricks differs from the dense volume after batch " << batchIndex );
+      numberOfFailures++;
+    }
+    if ( !PlusTesting::AreVolumesEqual( denseReconstructor->GetAccumulationBuffer(), brickedReconstructor->GetAccumulationBuffer() ) )
+    {
+      LOG_ERROR( "Accumulation buffer exported from the bricks differs from the dense buffer after batch " << batchIndex );
+      numberOfFailures++;
+    }
+
+    if ( batchIndex % 2 == 1 )
+    {
+      // Release the dense output, the next export has to copy the whole volume from the bricks
+      vtkImageData* exportedVolume = brickedReconstructor->GetReconstructedVolume();
+      vtkImageData* exportedAccumulation = brickedReconstructor->GetAccumulationBuffer();
+      if ( !brickedReconstructor->ReleaseDenseOutput() )
+      {
+        LOG_ERROR( "Dense output of the bricked reconstructor is not released" );
+        numberOfFailures++;
+      }
+      if ( !IsImageReleased( exportedVolume, outputExtent ) || !IsImageReleased( exportedAccumulation, outputExtent ) )
+      {
+        numberOfFailures++;
+      }
+      // In dense storage mode the volume is the only copy of the voxels, so it must not be released
+      if ( denseReconstructor->ReleaseDenseOutput() || denseReconstructor->GetReconstructedVolume()->GetPointData()->GetScalars() == NULL )
+      {
+        LOG_ERROR( "Output of the dense reconstructor is released" );
+        numberOfFailures++;
+      }
+    }
+
+    if ( batchIndex == RESET_AFTER_BATCH )
+    {
+      if ( brickedReconstructor->ResetOutput() != PLUS_SUCCESS || denseReconstructor->ResetOutput() != PLUS_SUCCESS )
+      {
+        LOG_ERROR( "Failed to reset reconstructor output" );
+        return numberOfFailures + 1;
+      }
+      if ( !PlusTesting::IsVolumeEmpty( brickedReconstructor->GetReconstructedVolume() ) || !PlusTesting::IsVolumeEmpty( brickedReconstructor->GetAccumulationBuffer() ) )
+      {
+        LOG_ERROR( "Bricked output is not cleared by reset" );
+        numberOfFailures++;
+      }
+    }
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus ConfigureReconstructor(vtkPlusVolumeReconstructor* reconstructor, bool brickedStorage, bool fillHoles)
+{
+  std::ostringstream configStr;
+  configStr << "<PlusConfiguration>"
+            << "  <VolumeReconstruction OutputSpacing=\"0.5 0.5 0.5\" OutputOrigin=\"0 0 0\" OutputExtent=\"0 59 0 49 0 59\""
+            << "    Interpolation=\"LINEAR\" CompoundingMode=\"MEAN\" Optimization=\"FULL\""
+            // the result depends on the order of pixel insertion, so it is only reproducible with one thread
+            << "    NumberOfThreads=\"1\" EnableBrickedStorage=\"" << ( brickedStorage ? "TRUE" : "FALSE" ) << "\""
+            << "    FillHoles=\"" << ( fillHoles ? "ON" : "OFF" ) << "\">"
+            << "    <HoleFilling>"
+            << "      <HoleFillingElement Type=\"GAUSSIAN\" Size=\"3\" Stdev=\"0.6667\" MinimumKnownVoxelsRatio=\"0.50001\" />"
+            << "      <HoleFillingElement Type=\"STICK\" StickLengthLimit=\"6\" NumberOfSticksToUse=\"1\" />"
+            << "      <HoleFillingElement Type=\"NEAREST_NEIGHBOR\" Size=\"7\" MinimumKnownVoxelsRatio=\"0.001\" />"
+            << "    </HoleFilling>"
+            << "  </VolumeReconstruction>"
+            << "</PlusConfiguration>";
+  vtkSmartPointer<vtkXMLDataElement> config = vtkSmartPointer<vtkXMLDataElement>::Take( vtkXMLUtilities::ReadElementFromString( configStr.str().c_str() ) );
+  if ( config.GetPointer() == NULL )
+  {
+    LOG_ERROR( "Failed to parse volume reconstruction configuration" );
+    return PLUS_FAIL;
+  }
+  if ( reconstructor->ReadConfiguration( config ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to read volume reconstruction configuration" );
+    return PLUS_FAIL;
+  }
+  reconstructor->Reset();
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus InsertFrames(vtkPlusVolumeReconstructor* reconstructor, int firstFrameIndex, int lastFrameIndex,
+                        std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  for ( int frameIndex = firstFrameIndex; frameIndex <= lastFrameIndex; frameIndex++ )
+  {
+    PlusTrackedFrame trackedFrame;
+    trackedFrame.GetImageData()->DeepCopyFrom( frames[frameIndex] );
+    if ( reconstructor->InsertTrackedFrame( &trackedFrame, imageToReferenceTransforms[frameIndex] ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( "Failed to insert frame " << frameIndex );
+      return PLUS_FAIL;
+    }
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+/*! Test live snapshots (the dense output is released after each one) of a bricked volume reconstructor */
+int TestReconstructorSnapshots(bool fillHoles, std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  std::string testName = fillHoles ? "with hole filling" : "without hole filling";
+  LOG_INFO( "Test bricked volume reconstructor snapshots " << testName );
+  int numberOfFailures = 0;
+
+  vtkSmartPointer<vtkPlusVolumeReconstructor> brickedReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
+  vtkSmartPointer<vtkPlusVolumeReconstructor> denseReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
+  if ( ConfigureReconstructor( brickedReconstructor, true, fillHoles ) != PLUS_SUCCESS
+       || ConfigureReconstructor( denseReconstructor, false, fillHoles ) != PLUS_SUCCESS )
+  {
+    return 1;
+  }
+
+  for ( int batchIndex = 0; batchIndex * NUMBER_OF_FRAMES_PER_BATCH < NUMBER_OF_FRAMES; batchIndex++ )
+  {
+    int firstFrameIndex = batchIndex * NUMBER_OF_FRAMES_PER_BATCH;
+    int lastFrameIndex = firstFrameIndex + NUMBER_OF_FRAMES_PER_BATCH - 1;
+    if ( InsertFrames( brickedReconstructor, firstFrameIndex, lastFrameIndex, frames, imageToReferenceTransforms ) != PLUS_SUCCESS
+         || InsertFrames( denseReconstructor, firstFrameIndex, lastFrameIndex, frames, imageToReferenceTransforms ) != PLUS_SUCCESS )
+    {
+      return numberOfFailures + 1;
+    }
+
+    vtkSmartPointer<vtkImageData> denseVolume = vtkSmartPointer<vtkImageData>::New();
+    vtkSmartPointer<vtkImageData> denseAccumulation = vtkSmartPointer<vtkImageData>::New();
+    if ( denseReconstructor->GetReconstructedVolume( denseVolume ) != PLUS_SUCCESS
+         || denseReconstructor->ExtractAccumulation( denseAccumulation ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( testName << ": failed to get dense volume after batch " << batchIndex );
+      return numberOfFailures + 1;
+    }
+
+    // Each snapshot releases the dense output, so the second snapshot without new frames has to export it again
+    for ( int snapshotIndex = 0; snapshotIndex < 2; snapshotIndex++ )
+    {
+      vtkSmartPointer<vtkImageData> brickedVolume = vtkSmartPointer<vtkImageData>::New();
+      vtkSmartPointer<vtkImageData> brickedAccumulation = vtkSmartPointer<vtkImageData>::New();
+      if ( brickedReconstructor->GetReconstructedVolume( brickedVolume ) != PLUS_SUCCESS
+           || brickedReconstructor->ExtractAccumulation( brickedAccumulation ) != PLUS_SUCCESS )
+      {
+        LOG_ERROR( testName << ": failed to get bricked volume after batch " << batchIndex );
+        return numberOfFailures + 1;
+      }
+      if ( !PlusTesting::AreVolumesEqual( denseVolume, brickedVolume ) )
+      {
+        LOG_ERROR( testName << ": bricked volume snapshot " << snapshotIndex << " differs from the dense volume after batch " << batchIndex );
+        numberOfFailures++;
+      }
+      if ( !PlusTesting::AreVolumesEqual( denseAccumulation, brickedAccumulation ) )
+      {
+        LOG_ERROR( testName << ": bricked accumulation snapshot " << snapshotIndex << " differs from the dense buffer after batch " << batchIndex );
+        numberOfFailures++;
+      }
+    }
+
+    if ( batchIndex == RESET_AFTER_BATCH )
+    {
+      brickedReconstructor->Reset();
+      denseReconstructor->Reset();
+    }
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  bool printHelp( false );
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize( argc, argv );
+  args.AddArgument( "--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help." );
+  args.AddArgument( "--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)" );
+
+  if ( !args.Parse() )
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit( EXIT_FAILURE );
+  }
+  if ( printHelp )
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit( EXIT_SUCCESS );
+  }
+  vtkPlusLogger::Instance()->SetLogLevel( verboseLevel );
+
+  std::vector<vtkSmartPointer<vtkImageData> > frames;
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > imageToReferenceTransforms;
+  CreateTestData( frames, imageToReferenceTransforms );
+
+  int numberOfFailures = 0;
+  numberOfFailures += TestPasteSliceDenseExport( frames, imageToReferenceTransforms );
+  numberOfFailures += TestReconstructorSnapshots( false, frames, imageToReferenceTransforms );
+  numberOfFailures += TestReconstructorSnapshots( true, frames, imageToReferenceTransforms );
+
+  if ( numberOfFailures > 0 )
+  {
+    LOG_ERROR( "vtkPlusBrickedVolumeReconstructionTest failed with " << numberOfFailures << " failures" );
+    return EXIT_FAILURE;
+  }
+  LOG_INFO( "vtkPlusBrickedVolumeReconstructionTest completed successfully" );
+  return EXIT_SUCCESS;
+}
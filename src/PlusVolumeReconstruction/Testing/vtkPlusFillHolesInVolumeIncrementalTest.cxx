@@ -0,0 +1,241 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusFillHolesInVolumeIncrementalTest.cxx
+  \brief Checks that incremental hole filling gives exactly the same volume as hole filling the whole volume
+
+  Synthetic frames are inserted in several batches and the hole filled volume is requested after each batch,
+  so that only the modified region of the volume is hole filled. Each result is compared voxel by voxel to a volume
+  that is reconstructed from the same frames and hole filled in one pass. The reconstruction is reset between
+  two batches to check that the whole volume is updated after a reset.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "PlusTrackedFrame.h"
+#include "vtkImageData.h"
+#include "vtkMatrix4x4.h"
+#include "vtkPlusVolumeReconstructor.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+#include "vtkXMLDataElement.h"
+#include "vtkXMLUtilities.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+#include <sstream>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  const int FRAME_SIZE_X = 64;
+  const int FRAME_SIZE_Y = 48;
+  const int NUMBER_OF_FRAMES = 24;
+  const int NUMBER_OF_FRAMES_PER_BATCH = 6;
+  /*! The reconstruction is reset after this batch */
+  const int RESET_AFTER_BATCH = 1;
+}
+
+//----------------------------------------------------------------------------
+void CreateTestData(std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  PlusTesting::TestRandomGenerator random;
+  for ( int frameIndex = 0; frameIndex < NUMBER_OF_FRAMES; frameIndex++ )
+  {
+    vtkSmartPointer<vtkImageData> frame = vtkSmartPointer<vtkImageData>::New();
+    frame->SetExtent( 0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0 );
+    frame->AllocateScalars( VTK_UNSIGNED_CHAR, 1 );
+    unsigned char* pixelPtr = static_cast<unsigned char*>( frame->GetScalarPointer() );
+    for ( int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++ )
+    {
+      // avoid 0 so that all inserted pixels are distinguishable from empty voxels
+      pixelPtr[i] = static_cast<unsigned char>( 1 + random.Next() % 255 );
+    }
+    frames.push_back( frame );
+
+    // Sparse sweep (a few voxels between the slices), so that there are holes of various sizes.
+    // Every second slice is at the other end of the volume, so that consecutive batches modify different regions.
+    int slicePosition = ( frameIndex % 2 == 0 ) ? frameIndex / 2 : NUMBER_OF_FRAMES - 1 - frameIndex / 2;
+    vtkSmartPointer<vtkTransform> imageToReference = vtkSmartPointer<vtkTransform>::New();
+    imageToReference->Translate( 1.0 + random.Uniform( -0.3, 0.3 ), 1.0 + random.Uniform( -0.3, 0.3 ), 1.0 + slicePosition * 1.2 + random.Uniform( -0.2, 0.2 ) );
+    imageToReference->RotateX( random.Uniform( -10.0, 10.0 ) );
+    imageToReference->RotateY( random.Uniform( -10.0, 10.0 ) );
+    imageToReference->Scale( 0.4, 0.4, 0.4 );
+    vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    imageToReference->GetMatrix( imageToReferenceMatrix );
+    imageToReferenceTransforms.push_back( imageToReferenceMatrix );
+  }
+}
+
+//----------------------------------------------------------------------------
+PlusStatus ConfigureReconstructor(vtkPlusVolumeReconstructor* reconstructor, const std::string& interpolation, const std::string& compounding, bool fillHoles)
+{
+  std::ostringstream configStr;
+  configStr << "<PlusConfiguration>"
+            << "  <VolumeReconstruction OutputSpacing=\"0.5 0.5 0.5\" OutputOrigin=\"0 0 0\" OutputExtent=\"0 59 0 49 0 59\""
+            << "    Interpolation=\"" << interpolation << "\" CompoundingMode=\"" << compounding << "\" Optimization=\"FULL\""
+            // the result depends on the order of pixel insertion, so it is only reproducible with one thread
+            << "    NumberOfThreads=\"1\" FillHoles=\"" << ( fillHoles ? "ON" : "OFF" ) << "\">"
+            << "    <HoleFilling>"
+            << "      <HoleFillingElement Type=\"GAUSSIAN\" Size=\"3\" Stdev=\"0.6667\" MinimumKnownVoxelsRatio=\"0.50001\" />"
+            << "      <HoleFillingElement Type=\"STICK\" StickLengthLimit=\"6\" NumberOfSticksToUse=\"1\" />"
+            << "      <HoleFillingElement Type=\"GAUSSIAN_ACCUMULATION\" Size=\"5\" Stdev=\"1.0\" MinimumKnownVoxelsRatio=\"0.1\" />"
+            << "      <HoleFillingElement Type=\"NEAREST_NEIGHBOR\" Size=\"7\" MinimumKnownVoxelsRatio=\"0.001\" />"
+            << "    </HoleFilling>"
+            << "  </VolumeReconstruction>"
+            << "</PlusConfiguration>";
+  vtkSmartPointer<vtkXMLDataElement> config = vtkSmartPointer<vtkXMLDataElement>::Take( vtkXMLUtilities::ReadElementFromString( configStr.str().c_str() ) );
+  if ( config.GetPointer() == NULL )
+  {
+    LOG_ERROR( "Failed to parse volume reconstruction configuration" );
+    return PLUS_FAIL;
+  }
+  if ( reconstructor->ReadConfiguration( config ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to read volume reconstruction configuration" );
+    return PLUS_FAIL;
+  }
+  reconstructor->Reset();
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus InsertFrames(vtkPlusVolumeReconstructor* reconstructor, int firstFrameIndex, int lastFrameIndex,
+                        std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  for ( int frameIndex = firstFrameIndex; frameIndex <= lastFrameIndex; frameIndex++ )
+  {
+    PlusTrackedFrame trackedFrame;
+    trackedFrame.GetImageData()->DeepCopyFrom( frames[frameIndex] );
+    if ( reconstructor->InsertTrackedFrame( &trackedFrame, imageToReferenceTransforms[frameIndex] ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( "Failed to insert frame " << frameIndex );
+      return PLUS_FAIL;
+    }
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int TestIncrementalHoleFilling(const std::string& interpolation, const std::string& compounding,
+                               std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms)
+{
+  std::string testName = interpolation + "/" + compounding;
+  LOG_INFO( "Test incremental hole filling: " << testName );
+  int numberOfFailures = 0;
+
+  vtkSmartPointer<vtkPlusVolumeReconstructor> incrementalReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
+  if ( ConfigureReconstructor( incrementalReconstructor, interpolation, compounding, true ) != PLUS_SUCCESS )
+  {
+    return 1;
+  }
+
+  int firstFrameSinceReset = 0;
+  for ( int batchIndex = 0; batchIndex * NUMBER_OF_FRAMES_PER_BATCH < NUMBER_OF_FRAMES; batchIndex++ )
+  {
+    int firstFrameIndex = batchIndex * NUMBER_OF_FRAMES_PER_BATCH;
+    int lastFrameIndex = firstFrameIndex + NUMBER_OF_FRAMES_PER_BATCH - 1;
+    if ( InsertFrames( incrementalReconstructor, firstFrameIndex, lastFrameIndex, frames, imageToReferenceTransforms ) != PLUS_SUCCESS )
+    {
+      return numberOfFailures + 1;
+    }
+    vtkSmartPointer<vtkImageData> incrementalVolume = vtkSmartPointer<vtkImageData>::New();
+    if ( incrementalReconstructor->GetReconstructedVolume( incrementalVolume ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( testName << ": failed to get incrementally hole filled volume after batch " << batchIndex );
+      return numberOfFailures + 1;
+    }
+
+    // Reference: all the frames since the last reset, hole filled in one pass
+    vtkSmartPointer<vtkPlusVolumeReconstructor> fullReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
+    vtkSmartPointer<vtkImageData> fullVolume = vtkSmartPointer<vtkImageData>::New();
+    if ( ConfigureReconstructor( fullReconstructor, interpolation, compounding, true ) != PLUS_SUCCESS
+         || InsertFrames( fullReconstructor, firstFrameSinceReset, lastFrameIndex, frames, imageToReferenceTransforms ) != PLUS_SUCCESS
+         || fullReconstructor->GetReconstructedVolume( fullVolume ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( testName << ": failed to reconstruct reference volume for batch " << batchIndex );
+      return numberOfFailures + 1;
+    }
+    if ( !PlusTesting::AreVolumesEqual( fullVolume, incrementalVolume ) )
+    {
+      LOG_ERROR( testName << ": incrementally hole filled volume differs from the reference after batch " << batchIndex );
+      numberOfFailures++;
+    }
+
+    if ( batchIndex == 0 )
+    {
+      // Make sure that the test is meaningful: hole filling has to change the volume
+      vtkSmartPointer<vtkPlusVolumeReconstructor> noHoleFillingReconstructor = vtkSmartPointer<vtkPlusVolumeReconstructor>::New();
+      vtkSmartPointer<vtkImageData> volumeWithHoles = vtkSmartPointer<vtkImageData>::New();
+      if ( ConfigureReconstructor( noHoleFillingReconstructor, interpolation, compounding, false ) != PLUS_SUCCESS
+           || InsertFrames( noHoleFillingReconstructor, firstFrameIndex, lastFrameIndex, frames, imageToReferenceTransforms ) != PLUS_SUCCESS
+           || noHoleFillingReconstructor->GetReconstructedVolume( volumeWithHoles ) != PLUS_SUCCESS )
+      {
+        LOG_ERROR( testName << ": failed to reconstruct volume without hole filling" );
+        return numberOfFailures + 1;
+      }
+      int oldVerboseLevel = vtkPlusLogger::Instance()->GetLogLevel();
+      vtkPlusLogger::Instance()->SetLogLevel( vtkPlusLogger::LOG_LEVEL_ERROR - 1 ); // the volumes are expected to differ
+      bool holesFilled = !PlusTesting::AreVolumesEqual( volumeWithHoles, incrementalVolume );
+      vtkPlusLogger::Instance()->SetLogLevel( oldVerboseLevel );
+      if ( !holesFilled )
+      {
+        LOG_ERROR( testName << ": hole filling did not change the volume, the test data has no holes" );
+        numberOfFailures++;
+      }
+    }
+
+    if ( batchIndex == RESET_AFTER_BATCH )
+    {
+      incrementalReconstructor->Reset();
+      firstFrameSinceReset = lastFrameIndex + 1;
+    }
+  }
+
+  return numberOfFailures;
+}
+
+//----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  bool printHelp( false );
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize( argc, argv );
+  args.AddArgument( "--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help." );
+  args.AddArgument( "--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)" );
+
+  if ( !args.Parse() )
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit( EXIT_FAILURE );
+  }
+  if ( printHelp )
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit( EXIT_SUCCESS );
+  }
+  vtkPlusLogger::Instance()->SetLogLevel( verboseLevel );
+
+  std::vector<vtkSmartPointer<vtkImageData> > frames;
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > imageToReferenceTransforms;
+  CreateTestData( frames, imageToReferenceTransforms );
+
+  int numberOfFailures = 0;
+  numberOfFailures += TestIncrementalHoleFilling( "NEAREST_NEIGHBOR", "LATEST", frames, imageToReferenceTransforms );
+  numberOfFailures += TestIncrementalHoleFilling( "LINEAR", "MEAN", frames, imageToReferenceTransforms );
+
+  if ( numberOfFailures > 0 )
+  {
+    LOG_ERROR( "vtkPlusFillHolesInVolumeIncrementalTest failed with " << numberOfFailures << " failures" );
+    return EXIT_FAILURE;
+  }
+  LOG_INFO( "vtkPlusFillHolesInVolumeIncrementalTest completed successfully" );
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusPasteSliceIntoVolumeSimdTest.cxx
+  \brief Checks that slice insertion with SIMD kernels gives exactly the same result as the scalar code
+
+  Synthetic frames are pasted into a volume with each interpolation and compounding mode,
+  using all the SIMD instruction sets that the CPU supports. The reconstructed volumes and
+  accumulation buffers are compared bit-by-bit to the result of the scalar code.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTestingHelpers.h"
+#include "vtkImageData.h"
+#include "vtkMatrix4x4.h"
+#include "vtkPlusPasteSliceIntoVolume.h"
+#include "vtkSmartPointer.h"
+#include "vtkTransform.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  const int FRAME_SIZE_X = 160;
+  const int FRAME_SIZE_Y = 120;
+  const int NUMBER_OF_FRAMES = 24;
+  const double PIXEL_REJECTION_THRESHOLD = 10.0;
+}
+
+//----------------------------------------------------------------------------
+void CreateTestData(std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms, vtkImageData* importanceMask)
+{
+  PlusTesting::TestRandomGenerator random;
+  for ( int frameIndex = 0; frameIndex < NUMBER_OF_FRAMES; frameIndex++ )
+  {
+    vtkSmartPointer<vtkImageData> frame = vtkSmartPointer<vtkImageData>::New();
+    frame->SetExtent( 0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0 );
+    frame->AllocateScalars( VTK_UNSIGNED_CHAR, 1 );
+    unsigned char* pixelPtr = static_cast<unsigned char*>( frame->GetScalarPointer() );
+    for ( int i = 0; i < FRAME_SIZE_X * FRAME_SIZE_Y; i++ )
+    {
+      pixelPtr[i] = static_cast<unsigned char>( random.Next() & 0xff );
+    }
+    frames.push_back( frame );
+
+    // Tilted sweep with slightly irregular spacing, so that all kinds of fractional voxel positions occur
+    // and many pixels are pasted into the same voxel
+    vtkSmartPointer<vtkTransform> imageToReference = vtkSmartPointer<vtkTransform>::New();
+    imageToReference->Translate( 2.0 + random.Uniform( -0.3, 0.3 ), 2.0 + random.Uniform( -0.3, 0.3 ), 4.0 + frameIndex * 1.3 + random.Uniform( -0.2, 0.2 ) );
+    imageToReference->RotateX( -20.0 + frameIndex * 1.5 + random.Uniform( -1.0, 1.0 ) );
+    imageToReference->RotateY( random.Uniform( -15.0, 15.0 ) );
+    imageToReference->RotateZ( random.Uniform( -10.0, 10.0 ) );
+    imageToReference->Scale( 0.23, 0.23, 0.23 );
+    vtkSmartPointer<vtkMatrix4x4> imageToReferenceMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    imageToReference->GetMatrix( imageToReferenceMatrix );
+    imageToReferenceTransforms.push_back( imageToReferenceMatrix );
+  }
+
+  importanceMask->SetExtent( 0, FRAME_SIZE_X - 1, 0, FRAME_SIZE_Y - 1, 0, 0 );
+  importanceMask->AllocateScalars( VTK_UNSIGNED_CHAR, 1 );
+  unsigned char* importancePtr = static_cast<unsigned char*>( importanceMask->GetScalarPointer() );
+  for ( int y = 0; y < FRAME_SIZE_Y; y++ )
+  {
+    for ( int x = 0; x < FRAME_SIZE_X; x++ )
+    {
+      // importance decreases towards the image edges, the outermost columns are ignored
+      int distanceFromEdge = std::min( x, FRAME_SIZE_X - 1 - x );
+      importancePtr[y * FRAME_SIZE_X + x] = static_cast<unsigned char>( std::min( distanceFromEdge * 8, 255 ) );
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+PlusStatus ReconstructVolume(vtkPlusPasteSliceIntoVolume::SimdInstructionSetType simdInstructionSet,
+                             vtkPlusPasteSliceIntoVolume::InterpolationType interpolationMode,
+                             vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
+                             bool pixelRejection, bool brickedStorage,
+                             std::vector<vtkSmartPointer<vtkImageData> >& frames, std::vector<vtkSmartPointer<vtkMatrix4x4> >& imageToReferenceTransforms,
+                             vtkImageData* importanceMask, vtkImageData* reconstructedVolume, vtkImageData* accumulationBuffer)
+{
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> reconstructor = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  reconstructor->SetOutputOrigin( 0.0, 0.0, 0.0 );
+  reconstructor->SetOutputSpacing( 0.5, 0.5, 0.5 );
+  reconstructor->SetOutputExtent( 0, 99, 0, 99, 0, 99 );
+  reconstructor->SetOptimization( vtkPlusPasteSliceIntoVolume::FULL_OPTIMIZATION );
+  reconstructor->SetSimdInstructionSet( simdInstructionSet );
+  reconstructor->SetInterpolationMode( interpolationMode );
+  reconstructor->SetCompoundingMode( compoundingMode );
+  // the result depends on the order of pixel insertion, so it is only reproducible with one thread
+  reconstructor->SetNumberOfThreads( 1 );
+  reconstructor->SetEnableBrickedStorage( brickedStorage );
+  if ( pixelRejection )
+  {
+    reconstructor->SetPixelRejectionThreshold( PIXEL_REJECTION_THRESHOLD );
+  }
+  if ( compoundingMode == vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE )
+  {
+    reconstructor->SetImportanceMask( importanceMask );
+  }
+
+  if ( reconstructor->ResetOutput() != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to reset reconstructor output" );
+    return PLUS_FAIL;
+  }
+  for ( unsigned int frameIndex = 0; frameIndex < frames.size(); frameIndex++ )
+  {
+    if ( reconstructor->InsertSlice( frames[frameIndex], imageToReferenceTransforms[frameIndex] ) != PLUS_SUCCESS )
+    {
+      LOG_ERROR( "Failed to insert slice " << frameIndex );
+      return PLUS_FAIL;
+    }
+  }
+
+  reconstructedVolume->DeepCopy( reconstructor->GetReconstructedVolume() );
+  accumulationBuffer->DeepCopy( reconstructor->GetAccumulationBuffer() );
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+/*! Returns true if the two images have exactly the same geometry and content */
+bool AreImagesIdentical(vtkImageData* image1, vtkImageData* image2)
+{
+  int extent1[6] = {0};
+  int extent2[6] = {0};
+  image1->GetExtent( extent1 );
+  image2->GetExtent( extent2 );
+  for ( int i = 0; i < 6; i++ )
+  {
+    if ( extent1[i] != extent2[i] )
+    {
+      return false;
+    }
+  }
+  if ( image1->GetScalarType() != image2->GetScalarType() || image1->GetNumberOfScalarComponents() != image2->GetNumberOfScalarComponents() )
+  {
+    return false;
+  }
+  size_t imageSizeBytes = static_cast<size_t>( image1->GetNumberOfPoints() ) * image1->GetNumberOfScalarComponents() * image1->GetScalarSize();
+  return memcmp( image1->GetScalarPointer(), image2->GetScalarPointer(), imageSizeBytes ) == 0;
+}
+
+//----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  bool printHelp( false );
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize( argc, argv );
+  args.AddArgument( "--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help." );
+  args.AddArgument( "--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)" );
+
+  if ( !args.Parse() )
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit( EXIT_FAILURE );
+  }
+
+  if ( printHelp )
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit( EXIT_SUCCESS );
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel( verboseLevel );
+
+  vtkPlusPasteSliceIntoVolume::SimdInstructionSetType supportedSimdInstructionSet = vtkPlusPasteSliceIntoVolume::GetSupportedSimdInstructionSet();
+  if ( supportedSimdInstructionSet == vtkPlusPasteSliceIntoVolume::SIMD_NONE )
+  {
+    LOG_INFO( "The CPU does not support any of the SIMD instruction sets, only the scalar code is used" );
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<vtkSmartPointer<vtkImageData> > frames;
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > imageToReferenceTransforms;
+  vtkSmartPointer<vtkImageData> importanceMask = vtkSmartPointer<vtkImageData>::New();
+  CreateTestData( frames, imageToReferenceTransforms, importanceMask );
+
+  const vtkPlusPasteSliceIntoVolume::InterpolationType interpolationModes[] =
+  {
+    vtkPlusPasteSliceIntoVolume::NEAREST_NEIGHBOR_INTERPOLATION,
+    vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION
+  };
+  const vtkPlusPasteSliceIntoVolume::CompoundingType compoundingModes[] =
+  {
+    vtkPlusPasteSliceIntoVolume::LATEST_COMPOUNDING_MODE,
+    vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE,
+    vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE,
+    vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE
+  };
+
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> namingHelper = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  int numberOfFailures = 0;
+  for ( int interpolationIndex = 0; interpolationIndex < 2; interpolationIndex++ )
+  {
+    for ( int compoundingIndex = 0; compoundingIndex < 4; compoundingIndex++ )
+    {
+      // pixel rejection and bricked storage use different code paths, test them in alternating combinations
+      bool pixelRejection = ( compoundingIndex % 2 == 1 );
+      bool brickedStorage = ( interpolationIndex == 1 && compoundingIndex >= 2 );
+
+      vtkSmartPointer<vtkImageData> referenceVolume = vtkSmartPointer<vtkImageData>::New();
+      vtkSmartPointer<vtkImageData> referenceAccumulationBuffer = vtkSmartPointer<vtkImageData>::New();
+      if ( ReconstructVolume( vtkPlusPasteSliceIntoVolume::SIMD_NONE, interpolationModes[interpolationIndex], compoundingModes[compoundingIndex],
+                              pixelRejection, brickedStorage, frames, imageToReferenceTransforms, importanceMask, referenceVolume, referenceAccumulationBuffer ) != PLUS_SUCCESS )
+      {
+        numberOfFailures++;
+        continue;
+      }
+
+      for ( int simdInstructionSet = vtkPlusPasteSliceIntoVolume::SIMD_SSE41; simdInstructionSet <= supportedSimdInstructionSet; simdInstructionSet++ )
+      {
+        vtkPlusPasteSliceIntoVolume::SimdInstructionSetType simdType = static_cast<vtkPlusPasteSliceIntoVolume::SimdInstructionSetType>( simdInstructionSet );
+        std::string caseName = std::string( namingHelper->GetInterpolationModeAsString( interpolationModes[interpolationIndex] ) )
+                               + "/" + namingHelper->GetCompoundingModeAsString( compoundingModes[compoundingIndex] )
+                               + "/" + namingHelper->GetSimdInstructionSetAsString( simdType );
+
+        vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+        vtkSmartPointer<vtkImageData> accumulationBuffer = vtkSmartPointer<vtkImageData>::New();
+        if ( ReconstructVolume( simdType, interpolationModes[interpolationIndex], compoundingModes[compoundingIndex],
+                                pixelRejection, brickedStorage, frames, imageToReferenceTransforms, importanceMask, volume, accumulationBuffer ) != PLUS_SUCCESS )
+        {
+          numberOfFailures++;
+          continue;
+        }
+        if ( !AreImagesIdentical( referenceVolume, volume ) )
+        {
+          LOG_ERROR( "Reconstructed volume differs from the scalar reference: " << caseName );
+          numberOfFailures++;
+        }
+        if ( !AreImagesIdentical( referenceAccumulationBuffer, accumulationBuffer ) )
+        {
+          LOG_ERROR( "Accumulation buffer differs from the scalar reference: " << caseName );
+          numberOfFailures++;
+        }
+        LOG_INFO( "Compared " << caseName );
+      }
+    }
+  }
+
+  if ( numberOfFailures > 0 )
+  {
+    LOG_ERROR( "Test failed with " << numberOfFailures << " errors" );
+    return EXIT_FAILURE;
+  }
+  LOG_INFO( "Test completed successfully" );
+  return EXIT_SUCCESS;
+}
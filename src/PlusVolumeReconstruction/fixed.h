@@ -181,6 +181,9 @@ public:
   inline int round() const { return (i + (1<<(point()-1)))>>point(); };
   inline int floor() const { return i >> point(); };
   inline int ceil() const { return (i + ((1<<point())-1))>>point(); };
+
+  /*! Number of bits after the fixed point (for code that directly operates on the integer container, such as SIMD kernels) */
+  static inline int fraction_bits() { return point(); };
 };
 
 inline const fixed& operator+(const fixed& x) {
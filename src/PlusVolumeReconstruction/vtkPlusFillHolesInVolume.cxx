@@ -54,7 +54,9 @@ POSSIBILITY OF SUCH DAMAGES.
 #include "vtkPointData.h"
 #include "vtkImageExtractComponents.h"
 #include "vtkMetaImageWriter.h"
+#include "vtkMultiThreader.h"
 
+#include <algorithm>
 #include <math.h>
 
 static const int INPUT_PORT_RECONSTRUCTED_VOLUME=0;
@@ -66,9 +68,11 @@ vtkStandardNewMacro(vtkPlusFillHolesInVolume);
 
 struct FillHoleThreadFunctionInfoStruct
 {
+  vtkPlusFillHolesInVolume* Filter;
   vtkImageData* ReconstructedVolume;
   vtkImageData* Accumulator;
-  int Compounding;
+  vtkImageData* OutputVolume;
+  int Extent[6];
 };
 
 //----------------------------------------------------------------------------
@@ -688,6 +692,7 @@ vtkPlusFillHolesInVolume::vtkPlusFillHolesInVolume()
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(1);
   this->Compounding=0;
+  NumHFElements = 0;
   HFElements = NULL;
 }
 
@@ -883,6 +888,120 @@ void vtkPlusFillHolesInVolume::ThreadedRequestData(vtkInformation *request,
     }
 }
 
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusFillHolesInVolume::FillHoleThreadFunction( void *arg )
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  FillHoleThreadFunctionInfoStruct* str = static_cast<FillHoleThreadFunctionInfoStruct*>(threadInfo->UserData);
+
+  int threadExtent[6] = {0, -1, 0, -1, 0, -1};
+  int totalUsedThreads = str->Filter->SplitExtent(threadExtent, str->Extent, threadInfo->ThreadID, threadInfo->NumberOfThreads);
+  if (threadInfo->ThreadID >= totalUsedThreads)
+  {
+    // this thread is not needed
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  void *outVolPtr = str->OutputVolume->GetScalarPointer();
+  void *inVolPtr = str->ReconstructedVolume->GetScalarPointer();
+  void *inAccPtr = str->Accumulator->GetScalarPointer();
+
+  switch (str->ReconstructedVolume->GetScalarType())
+    {
+      vtkTemplateMacro(
+      str->Filter->vtkPlusFillHolesInVolumeExecute(
+                                       str->ReconstructedVolume, static_cast<VTK_TT *>(inVolPtr),
+                                       str->Accumulator, static_cast<unsigned short *>(inAccPtr),
+                                       str->OutputVolume,
+                                       static_cast<VTK_TT *>(outVolPtr), threadExtent,
+                                       threadInfo->ThreadID));
+    default:
+      LOG_ERROR("FillHoleThreadFunction: Unknown ScalarType");
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusFillHolesInVolume::FillHolesInExtent(vtkImageData* outputVolume, const int extent[6])
+{
+  vtkImageData* inVolData = vtkImageData::SafeDownCast(this->GetInputDataObject(INPUT_PORT_RECONSTRUCTED_VOLUME, 0));
+  vtkImageData* inAccData = vtkImageData::SafeDownCast(this->GetInputDataObject(INPUT_PORT_ACCUMULATION_BUFFER, 0));
+  if (inVolData == NULL || inAccData == NULL || outputVolume == NULL)
+  {
+    LOG_ERROR("vtkPlusFillHolesInVolume::FillHolesInExtent failed: reconstructed volume, accumulation buffer, or output volume is not set");
+    return PLUS_FAIL;
+  }
+
+  int* inExtent = inVolData->GetExtent();
+  int* outExtent = outputVolume->GetExtent();
+  int* accExtent = inAccData->GetExtent();
+  for (int i = 0; i < 6; i++)
+  {
+    if (inExtent[i] != outExtent[i] || inExtent[i] != accExtent[i])
+    {
+      LOG_ERROR("vtkPlusFillHolesInVolume::FillHolesInExtent failed: extent of the reconstructed volume, accumulation buffer, and output volume must match");
+      return PLUS_FAIL;
+    }
+  }
+  if (inVolData->GetScalarType() != outputVolume->GetScalarType()
+    || inVolData->GetNumberOfScalarComponents() != outputVolume->GetNumberOfScalarComponents())
+  {
+    LOG_ERROR("vtkPlusFillHolesInVolume::FillHolesInExtent failed: output volume scalar type (" << outputVolume->GetScalarType()
+      << ") or number of components (" << outputVolume->GetNumberOfScalarComponents() << ") does not match the reconstructed volume");
+    return PLUS_FAIL;
+  }
+
+  FillHoleThreadFunctionInfoStruct str;
+  str.Filter = this;
+  str.ReconstructedVolume = inVolData;
+  str.Accumulator = inAccData;
+  str.OutputVolume = outputVolume;
+  for (int i = 0; i < 3; i++)
+  {
+    // clip to the volume
+    str.Extent[i * 2] = std::max(extent[i * 2], inExtent[i * 2]);
+    str.Extent[i * 2 + 1] = std::min(extent[i * 2 + 1], inExtent[i * 2 + 1]);
+    if (str.Extent[i * 2] > str.Extent[i * 2 + 1])
+    {
+      // empty extent, nothing to do
+      return PLUS_SUCCESS;
+    }
+  }
+
+  this->Threader->SetNumberOfThreads(this->NumberOfThreads);
+  this->Threader->SetSingleMethod(FillHoleThreadFunction, &str);
+  this->Threader->SingleMethodExecute();
+
+  outputVolume->Modified();
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusFillHolesInVolume::GetKernelMargin()
+{
+  int margin = 0;
+  if (HFElements == NULL)
+  {
+    return margin;
+  }
+  for (int k = 0; k < NumHFElements; k++)
+  {
+    int elementMargin = 0;
+    switch (HFElements[k].type)
+    {
+    case FillHolesInVolumeElement::HFTYPE_STICK:
+      elementMargin = HFElements[k].stickLengthLimit;
+      break;
+    default:
+      elementMargin = (HFElements[k].size - 1) / 2;
+      break;
+    }
+    margin = std::max(margin, elementMargin);
+  }
+  return margin;
+}
+
 //--------------------------------------------------------------------------------------
 void vtkPlusFillHolesInVolume::SetHFElement(int index, FillHolesInVolumeElement& element) {
   // universal
@@ -250,6 +250,21 @@ public:
   /*! Read hole filling parameter form a HoleFilling XML element */
   virtual PlusStatus ReadConfiguration( vtkXMLDataElement* holeFillingConfig); 
 
+  /*!
+    Get the largest distance (in voxels) from which the kernels read input voxels.
+    A hole filled voxel only depends on the input voxels within this margin.
+  */
+  int GetKernelMargin();
+
+  /*!
+    Compute hole filling only in the specified extent and write the result into the provided volume.
+    The inputs (reconstructed volume and accumulation buffer) must be set already. The output volume must
+    have the same extent, scalar type, and number of components as the input reconstructed volume.
+    Voxels outside the extent are not modified. This allows updating the hole filled volume incrementally,
+    after only a small part of the reconstructed volume has changed.
+  */
+  PlusStatus FillHolesInExtent(vtkImageData* outputVolume, const int extent[6]);
+
 protected:
   vtkPlusFillHolesInVolume();
   ~vtkPlusFillHolesInVolume();
@@ -50,10 +50,15 @@ POSSIBILITY OF SUCH DAMAGES.
 #include "vtkXMLUtilities.h"
 #include "vtkXMLDataElement.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "PlusBrickedVolume.h"
 #include "vtkPlusPasteSliceIntoVolume.h"
 #include "vtkPlusPasteSliceIntoVolumeHelperCommon.h"
 #include "vtkPlusPasteSliceIntoVolumeHelperUnoptimized.h"
 #include "vtkPlusPasteSliceIntoVolumeHelperOptimized.h"
+#include "vtkPlusPasteSliceIntoVolumeHelperSimd.h"
 
 vtkStandardNewMacro( vtkPlusPasteSliceIntoVolume );
 
@@ -63,8 +68,11 @@ struct InsertSliceThreadFunctionInfoStruct
   vtkMatrix4x4* TransformImageToReference;
   vtkImageData* OutputVolume;
   vtkImageData* Accumulator;
+  PlusBrickedVolume* BrickedVolume;
+  int OutputScalarType;
   vtkImageData* ImportanceImage;
   vtkPlusPasteSliceIntoVolume::OptimizationType Optimization;
+  vtkPlusPasteSliceIntoVolume::SimdInstructionSetType SimdInstructionSet;
   vtkPlusPasteSliceIntoVolume::InterpolationType InterpolationMode;
   vtkPlusPasteSliceIntoVolume::CompoundingType CompoundingMode;
   double PixelRejectionThreshold;
@@ -103,6 +111,17 @@ vtkPlusPasteSliceIntoVolume::vtkPlusPasteSliceIntoVolume()
   this->OutputExtent[4] = 0;
   this->OutputExtent[5] = 0;
 
+  this->ResetModifiedExtent();
+
+  this->EnableBrickedStorage = false;
+  this->BrickedVolume = new PlusBrickedVolume;
+  this->DenseOutputAllocated = false;
+  for ( int i = 0; i < 3; i++ )
+  {
+    this->DenseOutputModifiedExtent[i * 2] = 0;
+    this->DenseOutputModifiedExtent[i * 2 + 1] = -1;
+  }
+
   this->ClipRectangleOrigin[0] = 0;
   this->ClipRectangleOrigin[1] = 0;
   this->ClipRectangleSize[0] = 0;
@@ -121,6 +140,7 @@ vtkPlusPasteSliceIntoVolume::vtkPlusPasteSliceIntoVolume()
   // reconstruction options
   this->InterpolationMode = NEAREST_NEIGHBOR_INTERPOLATION;
   this->Optimization = FULL_OPTIMIZATION;
+  this->SimdInstructionSet = GetSupportedSimdInstructionSet();
   this->CompoundingMode = UNDEFINED_COMPOUNDING_MODE;
 
   this->NumberOfThreads = 0; // 0 means not set, the default number of threads will be used
@@ -148,6 +168,8 @@ vtkPlusPasteSliceIntoVolume::~vtkPlusPasteSliceIntoVolume()
     this->AccumulationBuffer = NULL;
   }
   this->SetImportanceMask(NULL);
+  delete this->BrickedVolume;
+  this->BrickedVolume = NULL;
   if ( this->Threader )
   {
     this->Threader->Delete();
@@ -195,6 +217,12 @@ void vtkPlusPasteSliceIntoVolume::PrintSelf( ostream& os, vtkIndent indent )
   os << indent << "InterpolationMode: " << this->GetInterpolationModeAsString( this->InterpolationMode ) << "\n";
   os << indent << "CompoundingMode: " << this->GetCompoundingModeAsString( this->CompoundingMode ) << "\n";
   os << indent << "Optimization: " << this->GetOptimizationModeAsString( this->Optimization ) << "\n";
+  os << indent << "SimdInstructionSet: " << this->GetSimdInstructionSetAsString( this->SimdInstructionSet ) << "\n";
+  os << indent << "EnableBrickedStorage: " << ( this->EnableBrickedStorage ? "true" : "false" ) << "\n";
+  if ( this->BrickedVolume->IsAllocated() )
+  {
+    os << indent << "NumberOfAllocatedBricks: " << this->BrickedVolume->GetNumberOfAllocatedBricks() << "\n";
+  }
   os << indent << "NumberOfThreads: ";
   if ( this->NumberOfThreads > 0 )
   {
@@ -210,19 +238,118 @@ void vtkPlusPasteSliceIntoVolume::PrintSelf( ostream& os, vtkIndent indent )
 //----------------------------------------------------------------------------
 vtkImageData* vtkPlusPasteSliceIntoVolume::GetReconstructedVolume()
 {
+  if ( this->BrickedVolume->IsAllocated() )
+  {
+    this->UpdateDenseOutputFromBricks();
+  }
   return this->ReconstructedVolume;
 }
 
 //----------------------------------------------------------------------------
 vtkImageData* vtkPlusPasteSliceIntoVolume::GetAccumulationBuffer()
 {
+  if ( this->BrickedVolume->IsAllocated() )
+  {
+    this->UpdateDenseOutputFromBricks();
+  }
   return this->AccumulationBuffer;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusPasteSliceIntoVolume::UpdateDenseOutputFromBricks()
+{
+  if ( !this->DenseOutputAllocated )
+  {
+    this->ReconstructedVolume->AllocateScalars( this->BrickedVolume->GetScalarType(), 1 );
+    this->AccumulationBuffer->AllocateScalars( VTK_UNSIGNED_SHORT, 1 );
+    this->DenseOutputAllocated = true;
+    // all the voxels have to be exported
+    for ( int i = 0; i < 6; i++ )
+    {
+      this->DenseOutputModifiedExtent[i] = this->ReconstructedVolume->GetExtent()[i];
+    }
+  }
+
+  if ( this->DenseOutputModifiedExtent[0] > this->DenseOutputModifiedExtent[1]
+       || this->DenseOutputModifiedExtent[2] > this->DenseOutputModifiedExtent[3]
+       || this->DenseOutputModifiedExtent[4] > this->DenseOutputModifiedExtent[5] )
+  {
+    // dense output is up-to-date
+    return PLUS_SUCCESS;
+  }
+
+  if ( this->BrickedVolume->ExportToImageData( this->DenseOutputModifiedExtent, this->ReconstructedVolume, this->AccumulationBuffer ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to update reconstructed volume from bricks" );
+    return PLUS_FAIL;
+  }
+
+  for ( int i = 0; i < 3; i++ )
+  {
+    this->DenseOutputModifiedExtent[i * 2] = 0;
+    this->DenseOutputModifiedExtent[i * 2 + 1] = -1;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::InitializeDenseOutputGeometry()
+{
+  vtkImageData* images[2] = { this->ReconstructedVolume, this->AccumulationBuffer };
+  for ( int i = 0; i < 2; i++ )
+  {
+    images[i]->Initialize();
+    images[i]->SetExtent( this->OutputExtent );
+    images[i]->SetOrigin( this->OutputOrigin );
+    images[i]->SetSpacing( this->OutputSpacing );
+  }
+  this->DenseOutputAllocated = false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusPasteSliceIntoVolume::ReleaseDenseOutput()
+{
+  if ( !this->BrickedVolume->IsAllocated() )
+  {
+    // dense storage, the output volume is the only copy of the voxels
+    return false;
+  }
+  this->InitializeDenseOutputGeometry();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusPasteSliceIntoVolume::ResetBrickedOutput()
+{
+  // Only set the geometry of the dense output, voxels are allocated when the dense output is requested
+  this->InitializeDenseOutputGeometry();
+
+  if ( this->BrickedVolume->Allocate( this->OutputExtent, this->OutputScalarMode, 1 ) != PLUS_SUCCESS )
+  {
+    LOG_ERROR( "Failed to allocate bricked output volume" );
+    return PLUS_FAIL;
+  }
+
+  // The whole volume has been changed
+  for ( int i = 0; i < 6; i++ )
+  {
+    this->ModifiedExtent[i] = this->OutputExtent[i];
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 // Clear the output volume and the accumulation buffer
 PlusStatus vtkPlusPasteSliceIntoVolume::ResetOutput()
 {
+  if ( this->EnableBrickedStorage )
+  {
+    return this->ResetBrickedOutput();
+  }
+  this->BrickedVolume->Release();
+  this->DenseOutputAllocated = false;
+
   // Allocate memory for accumulation buffer and set all pixels to 0
   // Start with this buffer because if no compunding is needed then we release memory before allocating memory for the reconstructed image.
 
@@ -285,9 +412,129 @@ PlusStatus vtkPlusPasteSliceIntoVolume::ResetOutput()
                          outData->GetScalarSize()*outData->GetNumberOfScalarComponents() ) );
   }
 
+  // The whole volume has been changed
+  for ( int i = 0; i < 6; i++ )
+  {
+    this->ModifiedExtent[i] = this->OutputExtent[i];
+  }
+
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::ResetModifiedExtent()
+{
+  this->ModifiedExtent[0] = 0;
+  this->ModifiedExtent[1] = -1;
+  this->ModifiedExtent[2] = 0;
+  this->ModifiedExtent[3] = -1;
+  this->ModifiedExtent[4] = 0;
+  this->ModifiedExtent[5] = -1;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::GetImagePixToVolumePixMatrix( vtkImageData* image, vtkMatrix4x4* imageToReference, vtkImageData* volume, vtkMatrix4x4* imagePixToVolumePix )
+{
+  // Transform chain:
+  // ImagePixToVolumePix =
+  //  = VolumePixFromImagePix
+  //  = VolumePixFromRef * RefFromImage * ImageFromImagePix
+
+  vtkSmartPointer<vtkTransform> tVolumePixFromRef = vtkSmartPointer<vtkTransform>::New();
+  tVolumePixFromRef->Translate( volume->GetOrigin() );
+  tVolumePixFromRef->Scale( volume->GetSpacing() );
+  tVolumePixFromRef->Inverse();
+
+  vtkSmartPointer<vtkTransform> tRefFromImage = vtkSmartPointer<vtkTransform>::New();
+  tRefFromImage->SetMatrix( imageToReference );
+
+  vtkSmartPointer<vtkTransform> tImageFromImagePix = vtkSmartPointer<vtkTransform>::New();
+  tImageFromImagePix->Scale( image->GetSpacing() );
+
+  vtkSmartPointer<vtkTransform> tImagePixToVolumePix = vtkSmartPointer<vtkTransform>::New();
+  tImagePixToVolumePix->Concatenate( tVolumePixFromRef );
+  tImagePixToVolumePix->Concatenate( tRefFromImage );
+  tImagePixToVolumePix->Concatenate( tImageFromImagePix );
+
+  tImagePixToVolumePix->GetMatrix( imagePixToVolumePix );
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::AddSliceToModifiedExtent( vtkImageData* image, vtkMatrix4x4* imageToReference, const double clipRectangleOrigin[2], const double clipRectangleSize[2] )
+{
+  vtkSmartPointer<vtkMatrix4x4> mImagePixToVolumePix = vtkSmartPointer<vtkMatrix4x4>::New();
+  GetImagePixToVolumePixMatrix( image, imageToReference, this->ReconstructedVolume, mImagePixToVolumePix );
+
+  // Bounding box of the pasted region in image pixel coordinates.
+  // Add half a pixel on each side, as the interpolation may spread a pixel value to the neighbor voxels.
+  int* imageExtent = image->GetExtent();
+  double imageBounds[6] =
+  {
+    std::max<double>( clipRectangleOrigin[0], imageExtent[0] ) - 0.5,
+    std::min<double>( clipRectangleOrigin[0] + clipRectangleSize[0], imageExtent[1] ) + 0.5,
+    std::max<double>( clipRectangleOrigin[1], imageExtent[2] ) - 0.5,
+    std::min<double>( clipRectangleOrigin[1] + clipRectangleSize[1], imageExtent[3] ) + 0.5,
+    imageExtent[4] - 0.5,
+    imageExtent[5] + 0.5
+  };
+
+  double volumeBounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+  for ( int corner = 0; corner < 8; corner++ )
+  {
+    double imagePix[4] = { imageBounds[corner & 1], imageBounds[2 + ( ( corner >> 1 ) & 1 )], imageBounds[4 + ( ( corner >> 2 ) & 1 )], 1.0 };
+    double volumePix[4] = { 0, 0, 0, 1 };
+    mImagePixToVolumePix->MultiplyPoint( imagePix, volumePix );
+    for ( int axis = 0; axis < 3; axis++ )
+    {
+      volumeBounds[axis * 2] = std::min( volumeBounds[axis * 2], volumePix[axis] );
+      volumeBounds[axis * 2 + 1] = std::max( volumeBounds[axis * 2 + 1], volumePix[axis] );
+    }
+  }
+
+  // Linear interpolation modifies the voxels around the transformed point, so include one more voxel on each side
+  int sliceExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  for ( int axis = 0; axis < 3; axis++ )
+  {
+    // clamp in floating-point to avoid integer overflow for slices that are far from the volume
+    double extentMin = std::floor( volumeBounds[axis * 2] ) - 1;
+    double extentMax = std::ceil( volumeBounds[axis * 2 + 1] ) + 1;
+    if ( extentMin > this->OutputExtent[axis * 2 + 1] || extentMax < this->OutputExtent[axis * 2] )
+    {
+      // the slice is completely outside the volume
+      return;
+    }
+    sliceExtent[axis * 2] = std::max( this->OutputExtent[axis * 2], static_cast<int>( extentMin ) );
+    sliceExtent[axis * 2 + 1] = std::min( this->OutputExtent[axis * 2 + 1], static_cast<int>( extentMax ) );
+  }
+
+  UnionExtent( this->ModifiedExtent, sliceExtent );
+  UnionExtent( this->DenseOutputModifiedExtent, sliceExtent );
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::UnionExtent( int extent[6], const int extentToAdd[6] )
+{
+  if ( extentToAdd[0] > extentToAdd[1] || extentToAdd[2] > extentToAdd[3] || extentToAdd[4] > extentToAdd[5] )
+  {
+    // nothing to add
+    return;
+  }
+  bool extentEmpty = ( extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5] );
+  for ( int axis = 0; axis < 3; axis++ )
+  {
+    if ( extentEmpty )
+    {
+      extent[axis * 2] = extentToAdd[axis * 2];
+      extent[axis * 2 + 1] = extentToAdd[axis * 2 + 1];
+    }
+    else
+    {
+      extent[axis * 2] = std::min( extent[axis * 2], extentToAdd[axis * 2] );
+      extent[axis * 2 + 1] = std::max( extent[axis * 2 + 1], extentToAdd[axis * 2 + 1] );
+    }
+  }
+}
+
 //****************************************************************************
 // RECONSTRUCTION - OPTIMIZED
 //****************************************************************************
@@ -312,10 +559,14 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
   str.TransformImageToReference = transformImageToReference;
   str.OutputVolume = this->ReconstructedVolume;
   str.Accumulator = this->AccumulationBuffer;
+  // bricked storage is used if it was enabled when the output was reset
+  str.BrickedVolume = ( this->BrickedVolume->IsAllocated() ? this->BrickedVolume : NULL );
+  str.OutputScalarType = ( this->BrickedVolume->IsAllocated() ? this->BrickedVolume->GetScalarType() : this->ReconstructedVolume->GetScalarType() );
   str.ImportanceImage = this->ImportanceMask;
   str.InterpolationMode = this->InterpolationMode;
   str.CompoundingMode = this->CompoundingMode;
   str.Optimization = this->Optimization;
+  str.SimdInstructionSet = this->SimdInstructionSet;
   if ( this->ClipRectangleSize[0] > 0 && this->ClipRectangleSize[1] > 0 )
   {
     // ClipRectangle specified
@@ -355,9 +606,13 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
     str.AccumulationBufferSaturationErrors.push_back( 0 );
   }
 
+  vtkIdType failedBrickAllocationsBefore = this->BrickedVolume->GetNumberOfFailedBrickAllocations();
+
   this->Threader->SetSingleMethod( InsertSliceThreadFunction, &str );
   this->Threader->SingleMethodExecute();
 
+  this->AddSliceToModifiedExtent( image, transformImageToReference, str.ClipRectangleOrigin, str.ClipRectangleSize );
+
   // sum up str.AccumulationBufferSaturationErrors
   unsigned int sumAccOverflowErrors( 0 );
   for ( int i = 0; i < numThreads; i++ )
@@ -373,6 +628,13 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
   this->AccumulationBuffer->Modified();
   this->Modified();
 
+  if ( this->BrickedVolume->GetNumberOfFailedBrickAllocations() > failedBrickAllocationsBefore )
+  {
+    LOG_ERROR( "Failed to insert slice into the volume: out of memory (" << this->BrickedVolume->GetNumberOfAllocatedBricks() << " bricks, "
+               << this->BrickedVolume->GetAllocatedMemorySize() / 1024 / 1024 << " MB allocated). Try to reduce the size or increase spacing of the output volume." );
+    return PLUS_FAIL;
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -437,10 +699,10 @@ VTK_THREAD_RETURN_TYPE vtkPlusPasteSliceIntoVolume::InsertSliceThreadFunction( v
   }
 
   // this filter expects that input is the same type as output.
-  if ( str->InputFrameImage->GetScalarType() != str->OutputVolume->GetScalarType() )
+  if ( str->InputFrameImage->GetScalarType() != str->OutputScalarType )
   {
     LOG_ERROR( "OptimizedInsertSlice: input ScalarType (" << str->InputFrameImage->GetScalarType() << ") "
-               << " must match out ScalarType (" << str->OutputVolume->GetScalarType() << ")" );
+               << " must match out ScalarType (" << str->OutputScalarType << ")" );
     return VTK_THREAD_RETURN_VALUE;
   }
 
@@ -451,47 +713,32 @@ VTK_THREAD_RETURN_TYPE vtkPlusPasteSliceIntoVolume::InsertSliceThreadFunction( v
   // Get output volume extent and pointer
   vtkImageData* outData = str->OutputVolume;
   int* outExt = outData->GetExtent();
-  void* outPtr = outData->GetScalarPointerForExtent( outExt );
-
-  if (str->Accumulator->GetScalarType() != VTK_UNSIGNED_SHORT || str->Accumulator->GetNumberOfScalarComponents() != 1)
+  void* outPtr = NULL;
+  unsigned short* accPtr = NULL;
+  if ( str->BrickedVolume == NULL )
   {
-    LOG_ERROR( "OptimizedInsertSlice: accumulator must have unsigned short scalar type and 1 component");
-    return VTK_THREAD_RETURN_VALUE;
+    // dense output
+    outPtr = outData->GetScalarPointerForExtent( outExt );
+    if (str->Accumulator->GetScalarType() != VTK_UNSIGNED_SHORT || str->Accumulator->GetNumberOfScalarComponents() != 1)
+    {
+      LOG_ERROR( "OptimizedInsertSlice: accumulator must have unsigned short scalar type and 1 component");
+      return VTK_THREAD_RETURN_VALUE;
+    }
+    accPtr = static_cast<unsigned short*>(str->Accumulator->GetScalarPointerForExtent(outExt));
   }
-  unsigned short* accPtr = static_cast<unsigned short*>(str->Accumulator->GetScalarPointerForExtent(outExt));
 
   // count the number of accumulation buffer overflow instances in the memory address here:
   unsigned int* accumulationBufferSaturationErrorsThread = &( str->AccumulationBufferSaturationErrors[threadId] );
 
-  // Transform chain:
-  // ImagePixToVolumePix =
-  //  = VolumePixFromImagePix
-  //  = VolumePixFromRef * RefFromImage * ImageFromImagePix
-
-  vtkSmartPointer<vtkTransform> tVolumePixFromRef = vtkSmartPointer<vtkTransform>::New();
-  tVolumePixFromRef->Translate( str->OutputVolume->GetOrigin() );
-  tVolumePixFromRef->Scale( str->OutputVolume->GetSpacing() );
-  tVolumePixFromRef->Inverse();
-
-  vtkSmartPointer<vtkTransform> tRefFromImage = vtkSmartPointer<vtkTransform>::New();
-  tRefFromImage->SetMatrix( str->TransformImageToReference );
-
-  vtkSmartPointer<vtkTransform> tImageFromImagePix = vtkSmartPointer<vtkTransform>::New();
-  tImageFromImagePix->Scale( str->InputFrameImage->GetSpacing() );
-
-  vtkSmartPointer<vtkTransform> tImagePixToVolumePix = vtkSmartPointer<vtkTransform>::New();
-  tImagePixToVolumePix->Concatenate( tVolumePixFromRef );
-  tImagePixToVolumePix->Concatenate( tRefFromImage );
-  tImagePixToVolumePix->Concatenate( tImageFromImagePix );
-
   vtkSmartPointer<vtkMatrix4x4> mImagePixToVolumePix = vtkSmartPointer<vtkMatrix4x4>::New();
-  tImagePixToVolumePix->GetMatrix( mImagePixToVolumePix );
+  GetImagePixToVolumePixMatrix( str->InputFrameImage, str->TransformImageToReference, str->OutputVolume, mImagePixToVolumePix );
 
 
   // set up all the info for passing into the appropriate insertSlice function
   vtkPlusPasteSliceIntoVolumeInsertSliceParams insertionParams;
   insertionParams.accOverflowCount = accumulationBufferSaturationErrorsThread;
   insertionParams.accPtr = accPtr;
+  insertionParams.brickedVolume = str->BrickedVolume;
   insertionParams.importanceMask = str->ImportanceImage;
   insertionParams.importancePtr = importancePtr;
   insertionParams.compoundingMode = str->CompoundingMode;
@@ -508,6 +755,7 @@ VTK_THREAD_RETURN_TYPE vtkPlusPasteSliceIntoVolume::InsertSliceThreadFunction( v
   insertionParams.outData = outData;
   insertionParams.outPtr = outPtr;
   insertionParams.pixelRejectionThreshold = str->PixelRejectionThreshold;
+  insertionParams.simdInstructionSet = str->SimdInstructionSet;
   // the matrix will be set once we know more about the optimization level
 
   if ( str->Optimization == FULL_OPTIMIZATION )
@@ -829,6 +1077,49 @@ const char* vtkPlusPasteSliceIntoVolume::GetOptimizationModeAsString( Optimizati
   }
 }
 
+//----------------------------------------------------------------------------
+const char* vtkPlusPasteSliceIntoVolume::GetSimdInstructionSetAsString( SimdInstructionSetType type )
+{
+  switch ( type )
+  {
+  case SIMD_AVX2:
+    return "AVX2";
+  case SIMD_SSE41:
+    return "SSE4.1";
+  case SIMD_NONE:
+    return "NONE";
+  default:
+    LOG_ERROR( "Unknown SIMD instruction set: " << type );
+    return "unknown";
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkPlusPasteSliceIntoVolume::SimdInstructionSetType vtkPlusPasteSliceIntoVolume::GetSupportedSimdInstructionSet()
+{
+  // CPU features do not change while the application is running, so detect them only once
+  static const SimdInstructionSetType supportedSimdInstructionSet = vtkGetSupportedSimdInstructionSet();
+  return supportedSimdInstructionSet;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::SetSimdInstructionSet( SimdInstructionSetType simdInstructionSet )
+{
+  SimdInstructionSetType supportedSimdInstructionSet = GetSupportedSimdInstructionSet();
+  if ( simdInstructionSet > supportedSimdInstructionSet )
+  {
+    LOG_WARNING( "SIMD instruction set " << GetSimdInstructionSetAsString( simdInstructionSet ) << " is not supported by the CPU, use "
+                 << GetSimdInstructionSetAsString( supportedSimdInstructionSet ) << " instead" );
+    simdInstructionSet = supportedSimdInstructionSet;
+  }
+  if ( this->SimdInstructionSet == simdInstructionSet )
+  {
+    return;
+  }
+  this->SimdInstructionSet = simdInstructionSet;
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 bool vtkPlusPasteSliceIntoVolume::FanClippingApplied()
 {
@@ -45,6 +45,7 @@ POSSIBILITY OF SUCH DAMAGES.
 
 #include "vtkPlusVolumeReconstructionExport.h"
 
+class PlusBrickedVolume;
 class PlusTrackedFrame;
 class vtkImageData;
 class vtkMatrix4x4;
@@ -85,6 +86,13 @@ public:
     FULL_OPTIMIZATION
   };
 
+  enum SimdInstructionSetType
+  {
+    SIMD_NONE,
+    SIMD_SSE41,
+    SIMD_AVX2
+  };
+
   enum CompoundingType
   {
     UNDEFINED_COMPOUNDING_MODE,
@@ -157,6 +165,7 @@ public:
     (the output is the reconstruction volume, the second component
     is the alpha component that stores whether or not a voxel has
     been touched by the reconstruction)
+    If bricked storage is enabled then the volume is created (or updated) from the bricks.
   */
   virtual vtkImageData *GetReconstructedVolume();
 
@@ -164,12 +173,23 @@ public:
     Get the accumulation buffer
     Accumulation buffer is for compounding, there is a voxel in
     the accumulation buffer for each voxel in the output.
+    If bricked storage is enabled then the buffer is created (or updated) from the bricks.
   */
   virtual vtkImageData *GetAccumulationBuffer();
 
   /*! Creates the and clears all necessary image buffers */
   virtual PlusStatus ResetOutput();
 
+  /*!
+    Get the extent of the output volume that has been modified since the last ResetModifiedExtent call.
+    Voxels outside this extent are unchanged. If nothing has been modified then the extent is empty (min > max).
+    ResetOutput sets it to the full output extent.
+  */
+  vtkGetVector6Macro(ModifiedExtent, int);
+
+  /*! Clear the modified extent (e.g., after the changes have been processed by the hole filler) */
+  void ResetModifiedExtent();
+
   /*!
     Set the clip rectangle origin to apply to the image in pixel coordinates.
     Pixels outside the clip rectangle will not be pasted into the volume.
@@ -264,6 +284,23 @@ public:
   /*! Get the name of an optimization method from a type id */
   const char* GetOptimizationModeAsString(OptimizationType type);
 
+  /*!
+    Set the SIMD instruction set that is used for computing output voxel indices and interpolation weights
+    in FULL_OPTIMIZATION mode. The results are the same (bit-exact) for all instruction sets.
+    By default the best instruction set that the CPU supports is used. If an instruction set is requested
+    that the CPU does not support then the best supported instruction set is used instead.
+    SIMD_NONE: scalar code
+    SIMD_SSE41: 4 pixels are processed at once
+    SIMD_AVX2: 8 pixels are processed at once
+  */
+  void SetSimdInstructionSet(SimdInstructionSetType simdInstructionSet);
+  /*! Get the SIMD instruction set that is used for pasting slices */
+  vtkGetMacro(SimdInstructionSet, SimdInstructionSetType);
+  /*! Get the best SIMD instruction set that is supported by the CPU */
+  static SimdInstructionSetType GetSupportedSimdInstructionSet();
+  /*! Get the name of a SIMD instruction set from a type id */
+  const char* GetSimdInstructionSetAsString(SimdInstructionSetType type);
+
   /*!
     Set the interpolation mode
     LINEAR:           Each pixel is distributed into the surrounding eight voxels using trilinear interpolation weights.
@@ -306,6 +343,25 @@ public:
   /*! Get number of threads used for processing the data */
   vtkGetMacro(NumberOfThreads,int);
 
+  /*!
+    Store the output volume and accumulation buffer in bricks that are allocated when a slice is first pasted into them.
+    It greatly reduces the memory usage if the slices cover only a small part of the output volume
+    (e.g., large field of view reconstructed at fine spacing).
+    The dense reconstructed volume and accumulation buffer are only created (and updated) when they are
+    requested by GetReconstructedVolume or GetAccumulationBuffer.
+    The value is applied when ResetOutput is called.
+  */
+  vtkSetMacro(EnableBrickedStorage, bool);
+  vtkGetMacro(EnableBrickedStorage, bool);
+  vtkBooleanMacro(EnableBrickedStorage, bool);
+
+  /*!
+    Release the voxels of the dense reconstructed volume and accumulation buffer if the output is stored in bricks.
+    The geometry is kept and the dense output is recreated from the bricks when it is requested again.
+    Returns false (and keeps the dense output) if the output is not stored in bricks.
+  */
+  bool ReleaseDenseOutput();
+
   /*! DEPRECATED - use CompoundingMode instead! */
   vtkSetMacro(Compounding,int);
   /*! DEPRECATED - use CompoundingMode instead! */
@@ -342,6 +398,24 @@ protected:
   */
   static int SplitSliceExtent(int splitExt[6], int fullExt[6], int threadId, int requestedNumberOfThreads);
 
+  /*! Compute the transform that maps image pixel indices to volume voxel indices */
+  static void GetImagePixToVolumePixMatrix(vtkImageData* image, vtkMatrix4x4* imageToReference, vtkImageData* volume, vtkMatrix4x4* imagePixToVolumePix);
+
+  /*! Extend ModifiedExtent with the volume region that may be affected by pasting the image (clip rectangle) into the volume */
+  void AddSliceToModifiedExtent(vtkImageData* image, vtkMatrix4x4* imageToReference, const double clipRectangleOrigin[2], const double clipRectangleSize[2]);
+
+  /*! Extend an extent to include another extent. Empty extents (min > max) are ignored. */
+  static void UnionExtent(int extent[6], const int extentToAdd[6]);
+
+  /*! Creates the bricked output (only the geometry of the dense reconstructed volume and accumulation buffer is set) */
+  PlusStatus ResetBrickedOutput();
+
+  /*! Update the dense reconstructed volume and accumulation buffer from the bricks (only the modified region is copied) */
+  PlusStatus UpdateDenseOutputFromBricks();
+
+  /*! Remove the voxels of the dense reconstructed volume and accumulation buffer, only their geometry is set */
+  void InitializeDenseOutputGeometry();
+
   vtkImageData *ReconstructedVolume;
   vtkImageData *AccumulationBuffer;
   vtkImageData *ImportanceMask;
@@ -350,6 +424,17 @@ protected:
   double OutputOrigin[3];
   double OutputSpacing[3];
   int OutputExtent[6];
+
+  /*! Region of the output volume that has been modified since the last ResetModifiedExtent call */
+  int ModifiedExtent[6];
+
+  // Bricked storage
+  bool EnableBrickedStorage;
+  PlusBrickedVolume* BrickedVolume;
+  /*! True if the dense reconstructed volume and accumulation buffer are allocated (in bricked storage mode) */
+  bool DenseOutputAllocated;
+  /*! Region of the bricked volume that has been modified since the dense output was last updated */
+  int DenseOutputModifiedExtent[6];
   
   // Clipping parameters
   int ClipRectangleOrigin[2];
@@ -362,6 +447,7 @@ protected:
   // Reconstruction options
   InterpolationType InterpolationMode;
   OptimizationType Optimization;
+  SimdInstructionSetType SimdInstructionSet;
   CompoundingType CompoundingMode;
   int OutputScalarMode;
   // deprecated
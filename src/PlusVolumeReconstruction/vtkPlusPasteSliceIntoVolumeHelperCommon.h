@@ -88,6 +88,7 @@ afterward. This resulted in unwanted and clearly-wrong artifacts.
 
 #include "PlusConfigure.h"
 
+#include "PlusBrickedVolume.h"
 #include "PlusMath.h"
 #include "fixed.h"
 #include "float.h" // for DBL_MAX
@@ -120,6 +121,7 @@ struct vtkPlusPasteSliceIntoVolumeInsertSliceParams
   vtkImageData* outData;            // the output volume
   void* outPtr;                     // scalar pointer to the output volume over the output extent
   unsigned short* accPtr;           // scalar pointer to the accumulation buffer over the output extent
+  PlusBrickedVolume* brickedVolume; // if not NULL then the output voxels and accumulation buffer are stored in bricks (outPtr and accPtr are not used)
   vtkImageData* importanceMask;
   unsigned char* importancePtr;     // scalar pointer to the importance mask over the output extent
   vtkImageData* inData;             // input slice
@@ -144,34 +146,99 @@ struct vtkPlusPasteSliceIntoVolumeInsertSliceParams
   double fanRadiusStop; // in the input image physical coordinate system
 
   double pixelRejectionThreshold;
+
+  int simdInstructionSet; // vtkPlusPasteSliceIntoVolume::SimdInstructionSetType, used for fixed-point math only
 };
 
 
 /*!
-  Implements trilinear interpolation
+  Get pointers to an output voxel (first scalar component) and to its accumulation buffer value.
+  The voxel indices are relative to the output extent minimum.
+  If brickedVolume is specified then the voxel is looked up in the bricked volume (the brick
+  is allocated on first access), otherwise the dense outPtr and accPtr buffers are used.
+*/
+template <class T>
+static inline void vtkGetOutputVoxelPointers(int outIdX, int outIdY, int outIdZ,
+                                             T* outPtr,
+                                             unsigned short* accPtr,
+                                             vtkIdType* outInc,
+                                             PlusBrickedVolume* brickedVolume,
+                                             T*& outVoxelPtr,
+                                             unsigned short*& accVoxelPtr)
+{
+  if (brickedVolume != NULL)
+  {
+    brickedVolume->GetVoxelPointers(outIdX, outIdY, outIdZ, outVoxelPtr, accVoxelPtr);
+    return;
+  }
+  vtkIdType inc = outIdX * outInc[0] + outIdY * outInc[1] + outIdZ * outInc[2];
+  outVoxelPtr = outPtr + inc;
+  // divide by outInc[0] to accomodate for the difference
+  // in the number of scalar pointers between the output
+  // and the accumulation buffer
+  accVoxelPtr = accPtr + (inc / outInc[0]);
+}
 
-  Does reverse trilinear interpolation. Trilinear interpolation would use
-  the pixel values to interpolate something in the middle we have the
-  something in the middle and want to spread it to the discrete pixel
-  values around it, in an interpolated way
+/*!
+  Compute the voxel indices and weights for trilinear interpolation at the 'point'.
+  outId0 is the floor and outId1 is the ceiling of the point coordinates.
+  Bits of the weight index select the corner: bit 2 for x, bit 1 for y, bit 0 for z
+  (0 means outId0, 1 means outId1 along that axis).
+*/
+template <class F>
+static inline void vtkComputeTrilinearWeights(const F* point, int outId0[3], int outId1[3], F fdx[8])
+{
+  F fx, fy, fz;
 
-  Do trilinear interpolation of the input data 'inPtr' of extent 'inExt'
-  at the 'point'.  The result is placed at 'outPtr'.
-  If the lookup data is beyond the extent 'inExt', set 'outPtr' to
-  the background color 'background'.
-  The number of scalar components in the data is 'numscalars'
+  // convert point[0] into integer component and a fraction
+  outId0[0] = PlusMath::Floor(point[0], fx);
+  // point[0] is unchanged, outId0[0] is the integer (floor), fx is the float
+  outId0[1] = PlusMath::Floor(point[1], fy);
+  outId0[2] = PlusMath::Floor(point[2], fz);
+
+  outId1[0] = outId0[0] + (fx != 0); // ceiling
+  outId1[1] = outId0[1] + (fy != 0);
+  outId1[2] = outId0[2] + (fz != 0);
+
+  // remainders from the fractional components - difference between the fractional value and the ceiling
+  F rx = 1 - fx;
+  F ry = 1 - fy;
+  F rz = 1 - fz;
+
+  F ryrz = ry * rz;
+  F ryfz = ry * fz;
+  F fyrz = fy * rz;
+  F fyfz = fy * fz;
+
+  // fdx is the weight towards the corner
+  fdx[0] = rx * ryrz;
+  fdx[1] = rx * ryfz;
+  fdx[2] = rx * fyrz;
+  fdx[3] = rx * fyfz;
+  fdx[4] = fx * ryrz;
+  fdx[5] = fx * ryfz;
+  fdx[6] = fx * fyrz;
+  fdx[7] = fx * fyfz;
+}
+
+/*!
+  Implements trilinear interpolation with precomputed voxel indices and weights
+  (see vtkComputeTrilinearWeights and vtkTrilinearInterpolation)
 */
 template <class F, class T>
-static int vtkTrilinearInterpolation(F* point,
-                                     T* inPtr,
-                                     T* outPtr,
-                                     unsigned short* accPtr,
-                                     unsigned char* importancePtr,
-                                     int numscalars,
-                                     vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
-                                     int outExt[6],
-                                     vtkIdType outInc[3],
-                                     unsigned int* accOverflowCount)
+static int vtkTrilinearInterpolationWithWeights(const int outId0[3],
+                                                const int outId1[3],
+                                                const F fdx[8],
+                                                T* inPtr,
+                                                T* outPtr,
+                                                unsigned short* accPtr,
+                                                unsigned char* importancePtr,
+                                                int numscalars,
+                                                vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
+                                                int outExt[6],
+                                                vtkIdType outInc[3],
+                                                PlusBrickedVolume* brickedVolume,
+                                                unsigned int* accOverflowCount)
 {
   // Determine if the output is a floating point or integer type. If floating point type then we don't round
   // the interpolated value.
@@ -183,20 +250,12 @@ static int vtkTrilinearInterpolation(F* point,
     roundOutput = false;
   }
 
-  F fx, fy, fz;
-
-  // convert point[0] into integer component and a fraction
-  int outIdX0 = PlusMath::Floor(point[0], fx);
-  // point[0] is unchanged, outIdX0 is the integer (floor), fx is the float
-  int outIdY0 = PlusMath::Floor(point[1], fy);
-  int outIdZ0 = PlusMath::Floor(point[2], fz);
-
-  int outIdX1 = outIdX0 + (fx != 0); // ceiling
-  int outIdY1 = outIdY0 + (fy != 0);
-  int outIdZ1 = outIdZ0 + (fz != 0);
-
-  // at this point in time we have the floor (outIdX0), the ceiling (outIdX1)
-  // and the fractional component (fx) for x, y and z
+  int outIdX0 = outId0[0];
+  int outIdY0 = outId0[1];
+  int outIdZ0 = outId0[2];
+  int outIdX1 = outId1[0];
+  int outIdY1 = outId1[1];
+  int outIdZ1 = outId1[2];
 
   // bounds check
   if ((outIdX0 | (outExt[1] - outExt[0] - outIdX1) |
@@ -227,26 +286,6 @@ static int vtkTrilinearInterpolation(F* point,
     idx[6] = factX1 + factY1Z0;
     idx[7] = factX1 + factY1Z1;
 
-    // remainders from the fractional components - difference between the fractional value and the ceiling
-    F rx = 1 - fx;
-    F ry = 1 - fy;
-    F rz = 1 - fz;
-
-    F ryrz = ry * rz;
-    F ryfz = ry * fz;
-    F fyrz = fy * rz;
-    F fyfz = fy * fz;
-
-    F fdx[8]; // fdx is the weight towards the corner
-    fdx[0] = rx * ryrz;
-    fdx[1] = rx * ryfz;
-    fdx[2] = rx * fyrz;
-    fdx[3] = rx * fyfz;
-    fdx[4] = fx * ryrz;
-    fdx[5] = fx * ryfz;
-    fdx[6] = fx * fyrz;
-    fdx[7] = fx * fyfz;
-
     F f, r, a;
     T* inPtrTmp, *outPtrTmp;
 
@@ -262,8 +301,16 @@ static int vtkTrilinearInterpolation(F* point,
         continue;
       }
       inPtrTmp = inPtr;
-      outPtrTmp = outPtr + idx[j];
-      accPtrTmp = accPtr + ((idx[j] / outInc[0]));
+      if (brickedVolume != NULL)
+      {
+        // bits of j select the corner: bit 2 for x, bit 1 for y, bit 0 for z (same as the order of idx)
+        brickedVolume->GetVoxelPointers((j & 4) ? outIdX1 : outIdX0, (j & 2) ? outIdY1 : outIdY0, (j & 1) ? outIdZ1 : outIdZ0, outPtrTmp, accPtrTmp);
+      }
+      else
+      {
+        outPtrTmp = outPtr + idx[j];
+        accPtrTmp = accPtr + ((idx[j] / outInc[0]));
+      }
       a = *accPtrTmp;
 
       int i = numscalars;
@@ -370,6 +417,41 @@ static int vtkTrilinearInterpolation(F* point,
   return 0;
 }
 
+/*!
+  Implements trilinear interpolation
+
+  Does reverse trilinear interpolation. Trilinear interpolation would use
+  the pixel values to interpolate something in the middle we have the
+  something in the middle and want to spread it to the discrete pixel
+  values around it, in an interpolated way
+
+  Do trilinear interpolation of the input data 'inPtr' of extent 'inExt'
+  at the 'point'.  The result is placed at 'outPtr'.
+  If the lookup data is beyond the extent 'inExt', set 'outPtr' to
+  the background color 'background'.
+  The number of scalar components in the data is 'numscalars'
+*/
+template <class F, class T>
+static int vtkTrilinearInterpolation(F* point,
+                                     T* inPtr,
+                                     T* outPtr,
+                                     unsigned short* accPtr,
+                                     unsigned char* importancePtr,
+                                     int numscalars,
+                                     vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
+                                     int outExt[6],
+                                     vtkIdType outInc[3],
+                                     PlusBrickedVolume* brickedVolume,
+                                     unsigned int* accOverflowCount)
+{
+  int outId0[3];
+  int outId1[3];
+  F fdx[8];
+  vtkComputeTrilinearWeights(point, outId0, outId1, fdx);
+  return vtkTrilinearInterpolationWithWeights(outId0, outId1, fdx, inPtr, outPtr, accPtr, importancePtr, numscalars,
+    compoundingMode, outExt, outInc, brickedVolume, accOverflowCount);
+}
+
 
 //----------------------------------------------------------------------------
 /*!
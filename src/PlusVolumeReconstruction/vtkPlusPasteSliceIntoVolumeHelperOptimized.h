@@ -54,8 +54,11 @@ POSSIBILITY OF SUCH DAMAGES.
 #define __vtkPlusPasteSliceIntoVolumeHelperOptimized_h
 
 #include "vtkPlusPasteSliceIntoVolumeHelperCommon.h"
+#include "vtkPlusPasteSliceIntoVolumeHelperSimd.h"
 #include "fixed.h"
 
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 /*! 
   Find approximate intersection of line with the plane
@@ -493,7 +496,10 @@ static void vtkUltraFindExtent(int& xIntersectionPixStart, int& xIntersectionPix
 
 
 //----------------------------------------------------------------------------
-/*! Optimized nearest neighbor interpolation, without integer mathematics */
+/*!
+  Optimized nearest neighbor interpolation, without integer mathematics
+  (simdInstructionSet is ignored, SIMD kernels are only implemented for fixed point mathematics)
+*/
 template<class T>
 static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
                                                  int xIntersectionPixEnd,
@@ -507,9 +513,11 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
                                                  int numscalars,
                                                  vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode, 
                                                  unsigned short *accPtr,
+                                                 PlusBrickedVolume *brickedVolume,
                                                  unsigned char *&importancePtr,
                                                  unsigned int *accOverflowCount,
-                                                 double pixelRejectionThreshold)
+                                                 double pixelRejectionThreshold,
+                                                 int simdInstructionSet)
 {
   bool pixelRejectionEnabled = PixelRejectionEnabled(pixelRejectionThreshold);
   double pixelRejectionThresholdSumAllComponents = 0;
@@ -544,12 +552,9 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
       int outIdY = PlusMath::Round(outPoint[1]) - outExt[2];
       int outIdZ = PlusMath::Round(outPoint[2]) - outExt[4];
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]); // removed cast to unsigned short because it might cause loss in larger numbers
+      T *outPtr1 = NULL;
+      unsigned short *accPtr1 = NULL;
+      vtkGetOutputVoxelPointers(outIdX, outIdY, outIdZ, outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
 
       if (*accPtr1 <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
 
@@ -605,12 +610,9 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
       int outIdY = PlusMath::Round(outPoint[1]) - outExt[2];
       int outIdZ = PlusMath::Round(outPoint[2]) - outExt[4];
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]); // removed cast to unsigned short because it might cause loss in larger numbers
+      T *outPtr1 = NULL;
+      unsigned short *accPtr1 = NULL;
+      vtkGetOutputVoxelPointers(outIdX, outIdY, outIdZ, outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
 
       if (*accPtr1 <= ACCUMULATION_THRESHOLD)
       {
@@ -677,12 +679,9 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
       int outIdY = PlusMath::Round(outPoint[1]) - outExt[2];
       int outIdZ = PlusMath::Round(outPoint[2]) - outExt[4];
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]); // removed cast to unsigned short because it might cause loss in larger numbers
+      T *outPtr1 = NULL;
+      unsigned short *accPtr1 = NULL;
+      vtkGetOutputVoxelPointers(outIdX, outIdY, outIdZ, outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
       int i = numscalars;
       do 
       {
@@ -723,12 +722,9 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
       int outIdY = PlusMath::Round(outPoint[1]) - outExt[2];
       int outIdZ = PlusMath::Round(outPoint[2]) - outExt[4];
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]); // removed cast to unsigned short because it might cause loss in larger numbers
+      T *outPtr1 = NULL;
+      unsigned short *accPtr1 = NULL;
+      vtkGetOutputVoxelPointers(outIdX, outIdY, outIdZ, outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
       int i = numscalars;
       do 
       {
@@ -751,7 +747,9 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
 //----------------------------------------------------------------------------
 /*! 
   Optimized nearest neighbor interpolation, specifically optimized for fixed
-  point (i.e. integer) mathematics
+  point (i.e. integer) mathematics.
+  The row is processed in chunks: output voxel indices of a chunk are computed by a SIMD kernel
+  then the pixels are pasted into the voxels one by one.
 */
 template <class T>
 static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
@@ -766,9 +764,11 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
                                                  int numscalars,
                                                  vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
                                                  unsigned short *accPtr,
+                                                 PlusBrickedVolume *brickedVolume,
                                                  unsigned char *&importancePtr,
                                                  unsigned int *accOverflowCount,
-                                                 double pixelRejectionThreshold)
+                                                 double pixelRejectionThreshold,
+                                                 int simdInstructionSet)
 {
   bool pixelRejectionEnabled = PixelRejectionEnabled(pixelRejectionThreshold);
   double pixelRejectionThresholdSumAllComponents = 0;
@@ -781,198 +781,312 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
   outPoint[1] = outPoint1[1] + xIntersectionPixStart*xAxis[1] - outExt[2];
   outPoint[2] = outPoint1[2] + xIntersectionPixStart*xAxis[2] - outExt[4];
 
-  switch (compoundingMode) {
-  case  vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE :
-    // Nearest-Neighbor, no extent checks, with accumulation
-    for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++)
-    {
-      if (pixelRejectionEnabled)
+  int outIdXChunk[SIMD_CHUNK_SIZE];
+  int outIdYChunk[SIMD_CHUNK_SIZE];
+  int outIdZChunk[SIMD_CHUNK_SIZE];
+
+  for (int chunkStart = xIntersectionPixStart; chunkStart <= xIntersectionPixEnd; chunkStart += SIMD_CHUNK_SIZE)
+  {
+    int chunkLength = std::min(SIMD_CHUNK_SIZE, xIntersectionPixEnd - chunkStart + 1);
+    vtkComputeNearestVoxelIndices(simdInstructionSet, outPoint, xAxis, chunkLength, outIdXChunk, outIdYChunk, outIdZChunk);
+    outPoint[0] += chunkLength*xAxis[0];
+    outPoint[1] += chunkLength*xAxis[1];
+    outPoint[2] += chunkLength*xAxis[2];
+
+    switch (compoundingMode) {
+    case  vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE :
+      // Nearest-Neighbor, no extent checks, with accumulation
+      for (int k = 0; k < chunkLength; k++)
       {
-        double inPixelSumAllComponents = 0;
-        for (int i = numscalars-1; i>=0; i--)
-        {
-          inPixelSumAllComponents+=inPtr[i];
-        }
-        if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+        if (pixelRejectionEnabled)
         {
-          // too dark, skip this pixel
-          inPtr += numscalars;
-          outPoint[0] += xAxis[0];
-          outPoint[1] += xAxis[1];
-          outPoint[2] += xAxis[2];
-          continue;
+          double inPixelSumAllComponents = 0;
+          for (int i = numscalars-1; i>=0; i--)
+          {
+            inPixelSumAllComponents+=inPtr[i];
+          }
+          if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+          {
+            // too dark, skip this pixel
+            inPtr += numscalars;
+            continue;
+          }
         }
-      }
 
-      int outIdX = PlusMath::Round(outPoint[0]);
-      int outIdY = PlusMath::Round(outPoint[1]);
-      int outIdZ = PlusMath::Round(outPoint[2]);
+        T *outPtr1 = NULL;
+        unsigned short *accPtr1 = NULL;
+        vtkGetOutputVoxelPointers(outIdXChunk[k], outIdYChunk[k], outIdZChunk[k], outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]);
+        if (*accPtr1 <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
 
-      if (*accPtr1 <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
+          unsigned short newa = *accPtr1 + ((unsigned short)(ACCUMULATION_MULTIPLIER));
 
-        unsigned short newa = *accPtr1 + ((unsigned short)(ACCUMULATION_MULTIPLIER));
+          if (newa > ACCUMULATION_THRESHOLD)
+            (*accOverflowCount) += 1;
 
-        if (newa > ACCUMULATION_THRESHOLD)
-          (*accOverflowCount) += 1;
-
-        int i = numscalars;
-        do 
-        {
-          i--;
-          *outPtr1 = ((*inPtr++)*ACCUMULATION_MULTIPLIER + (*outPtr1)*(*accPtr1))/newa;
-          outPtr1++;
-        }
-        while (i);
+          int i = numscalars;
+          do 
+          {
+            i--;
+            *outPtr1 = ((*inPtr++)*ACCUMULATION_MULTIPLIER + (*outPtr1)*(*accPtr1))/newa;
+            outPtr1++;
+          }
+          while (i);
 
-        *accPtr1 = ACCUMULATION_MAXIMUM;
-        if (newa < ACCUMULATION_MAXIMUM)
-        {
-          *accPtr1 = newa;
+          *accPtr1 = ACCUMULATION_MAXIMUM;
+          if (newa < ACCUMULATION_MAXIMUM)
+          {
+            *accPtr1 = newa;
+          }
+        } else { // overflow, use recursive filtering with 255/256 and 1/256 as the weights, since 255 voxels have been inserted so far
+          // TODO : This doesn't iterate through the scalars, this could be a problem
+          *outPtr1 = (T)( (*inPtr++)*fraction1_256 + (*outPtr1)*fraction255_256 );
         }
-      } else { // overflow, use recursive filtering with 255/256 and 1/256 as the weights, since 255 voxels have been inserted so far
-        // TODO : This doesn't iterate through the scalars, this could be a problem
-        *outPtr1 = (T)( (*inPtr++)*fraction1_256 + (*outPtr1)*fraction255_256 );
       }
-
-      outPoint[0] += xAxis[0];
-      outPoint[1] += xAxis[1];
-      outPoint[2] += xAxis[2];
-    }
-    break;
-  case  vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE :
-    // Nearest-Neighbor, no extent checks, with accumulation
-    for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++)
-    {
-      if (pixelRejectionEnabled)
+      break;
+    case  vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE :
+      // Nearest-Neighbor, no extent checks, with accumulation
+      for (int k = 0; k < chunkLength; k++)
       {
-        double inPixelSumAllComponents = 0;
-        for (int i = numscalars-1; i>=0; i--)
+        if (pixelRejectionEnabled)
         {
-          inPixelSumAllComponents+=inPtr[i];
-        }
-        if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
-        {
-          // too dark, skip this pixel
-          inPtr += numscalars;
-          outPoint[0] += xAxis[0];
-          outPoint[1] += xAxis[1];
-          outPoint[2] += xAxis[2];
-          importancePtr++;
-          continue;
+          double inPixelSumAllComponents = 0;
+          for (int i = numscalars-1; i>=0; i--)
+          {
+            inPixelSumAllComponents+=inPtr[i];
+          }
+          if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+          {
+            // too dark, skip this pixel
+            inPtr += numscalars;
+            importancePtr++;
+            continue;
+          }
         }
-      }
 
-      int outIdX = PlusMath::Round(outPoint[0]);
-      int outIdY = PlusMath::Round(outPoint[1]);
-      int outIdZ = PlusMath::Round(outPoint[2]);
+        T *outPtr1 = NULL;
+        unsigned short *accPtr1 = NULL;
+        vtkGetOutputVoxelPointers(outIdXChunk[k], outIdYChunk[k], outIdZChunk[k], outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]);
+        if (*accPtr1 <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
 
-      if (*accPtr1 <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
+          if (*importancePtr == 0)
+          {
+            //nothing to do, the rest of the row is skipped
+            return;
+          }
+          unsigned short newa = *accPtr1 + *importancePtr;
 
-        if (*importancePtr == 0)
+          if (newa > ACCUMULATION_THRESHOLD)
+          {
+            (*accOverflowCount) += 1;
+          }
+
+          int i = numscalars;
+          do 
+          {
+            i--;
+            *outPtr1 = ((*inPtr++)*(*importancePtr) + (*outPtr1)*(*accPtr1))/newa;
+            outPtr1++;
+          }
+          while (i);
+          importancePtr++;
+
+          *accPtr1 = ACCUMULATION_MAXIMUM;
+          if (newa < ACCUMULATION_MAXIMUM)
+          {
+            *accPtr1 = newa;
+          }
+        }
+        else
         {
-          //nothing to do
-          break;
+          // overflow, use recursive filtering with 255/256 and 1/256 as the weights, since 255 voxels have been inserted so far
+          // TODO : This doesn't iterate through the scalars, this could be a problem
+          *outPtr1 = (T)( (*inPtr++)*fraction1_256 + (*outPtr1)*fraction255_256 );
         }
-        unsigned short newa = *accPtr1 + *importancePtr;
-
-        if (newa > ACCUMULATION_THRESHOLD)
+      }
+      break;
+    case  vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE :
+      for (int k = 0; k < chunkLength; k++)
+      {
+        if (pixelRejectionEnabled)
         {
-          (*accOverflowCount) += 1;
+          double inPixelSumAllComponents = 0;
+          for (int i = numscalars-1; i>=0; i--)
+          {
+            inPixelSumAllComponents+=inPtr[i];
+          }
+          if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+          {
+            // too dark, skip this pixel
+            inPtr += numscalars;
+            continue;
+          }
         }
 
+        T *outPtr1 = NULL;
+        unsigned short *accPtr1 = NULL;
+        vtkGetOutputVoxelPointers(outIdXChunk[k], outIdYChunk[k], outIdZChunk[k], outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
         int i = numscalars;
         do 
         {
           i--;
-          *outPtr1 = ((*inPtr++)*(*importancePtr) + (*outPtr1)*(*accPtr1))/newa;
+          if (*outPtr1 < *inPtr)
+            *outPtr1 = *inPtr;
           outPtr1++;
+          inPtr++;
         }
         while (i);
-        importancePtr++;
 
-        *accPtr1 = ACCUMULATION_MAXIMUM;
-        if (newa < ACCUMULATION_MAXIMUM)
-        {
-          *accPtr1 = newa;
-        }
-      }
-      else
-      {
-        // overflow, use recursive filtering with 255/256 and 1/256 as the weights, since 255 voxels have been inserted so far
-        // TODO : This doesn't iterate through the scalars, this could be a problem
-        *outPtr1 = (T)( (*inPtr++)*fraction1_256 + (*outPtr1)*fraction255_256 );
+        *accPtr1 = (unsigned short)ACCUMULATION_MULTIPLIER;
       }
-
-      outPoint[0] += xAxis[0];
-      outPoint[1] += xAxis[1];
-      outPoint[2] += xAxis[2];
-    }
-    break;
-  case  vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE :
-    for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++)
-    {
-      if (pixelRejectionEnabled)
+      break;
+    case  vtkPlusPasteSliceIntoVolume::LATEST_COMPOUNDING_MODE :
+      for (int k = 0; k < chunkLength; k++)
       {
-        double inPixelSumAllComponents = 0;
-        for (int i = numscalars-1; i>=0; i--)
+        if (pixelRejectionEnabled)
         {
-          inPixelSumAllComponents+=inPtr[i];
+          double inPixelSumAllComponents = 0;
+          for (int i = numscalars-1; i>=0; i--)
+          {
+            inPixelSumAllComponents+=inPtr[i];
+          }
+          if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+          {
+            // too dark, skip this pixel
+            inPtr += numscalars;
+            continue;
+          }
         }
-        if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+
+        T *outPtr1 = NULL;
+        unsigned short *accPtr1 = NULL;
+        vtkGetOutputVoxelPointers(outIdXChunk[k], outIdYChunk[k], outIdZChunk[k], outPtr, accPtr, outInc, brickedVolume, outPtr1, accPtr1);
+        int i = numscalars;
+        do 
         {
-          // too dark, skip this pixel
-          inPtr += numscalars;
-          outPoint[0] += xAxis[0];
-          outPoint[1] += xAxis[1];
-          outPoint[2] += xAxis[2];
-          continue;
+          i--;
+          *outPtr1 = *inPtr;
+          outPtr1++;
+          inPtr++;
         }
+        while (i);
+
+        *accPtr1 = (unsigned short)ACCUMULATION_MULTIPLIER;
       }
+      break;
+    default:
+      LOG_ERROR("Unknown Compounding operator detected, value " << compoundingMode << ". Leaving value as-is.");
+      return;
+    }
+  }
+}
 
-      int outIdX = PlusMath::Round(outPoint[0]);
-      int outIdY = PlusMath::Round(outPoint[1]);
-      int outIdZ = PlusMath::Round(outPoint[2]);
+//----------------------------------------------------------------------------
+/*!
+  Optimized trilinear interpolation, without integer mathematics
+  (simdInstructionSet is ignored, SIMD kernels are only implemented for fixed point mathematics)
+*/
+template <class T>
+static inline void vtkFreehand2OptimizedLinearHelper(int xIntersectionPixStart,
+                                                     int xIntersectionPixEnd,
+                                                     double *outPoint1,
+                                                     double *xAxis,
+                                                     T *&inPtr,
+                                                     T *outPtr,
+                                                     int *outExt,
+                                                     vtkIdType *outInc,
+                                                     int numscalars,
+                                                     vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
+                                                     unsigned short *accPtr,
+                                                     PlusBrickedVolume *brickedVolume,
+                                                     unsigned char *&importancePtr,
+                                                     unsigned int *accOverflowCount,
+                                                     double pixelRejectionThreshold,
+                                                     int simdInstructionSet)
+{
+  bool pixelRejectionEnabled = PixelRejectionEnabled(pixelRejectionThreshold);
+  double pixelRejectionThresholdSumAllComponents = 0;
+  if (pixelRejectionEnabled)
+  {
+    pixelRejectionThresholdSumAllComponents = pixelRejectionThreshold * numscalars;
+  }
 
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]);
-      int i = numscalars;
-      do 
+  double outPoint[3];
+  for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++) // for all of the x pixels within the fan
+  {
+    if (pixelRejectionEnabled)
+    {
+      double inPixelSumAllComponents = 0;
+      for (int i = numscalars-1; i>=0; i--)
       {
-        i--;
-        if (*outPtr1 < *inPtr)
-          *outPtr1 = *inPtr;
-        outPtr1++;
-        inPtr++;
+        inPixelSumAllComponents+=inPtr[i];
       }
-      while (i);
+      if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
+      {
+        // too dark, skip this pixel
+        inPtr += numscalars; // go to the next x pixel
+        importancePtr++;
+        continue;
+      }
+    }
 
-      *accPtr1 = (unsigned short)ACCUMULATION_MULTIPLIER;
+    outPoint[0] = outPoint1[0] + idX*xAxis[0];
+    outPoint[1] = outPoint1[1] + idX*xAxis[1];
+    outPoint[2] = outPoint1[2] + idX*xAxis[2];
+    vtkTrilinearInterpolation(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, brickedVolume, accOverflowCount); // hit is either 1 or 0
+    inPtr += numscalars; // go to the next x pixel
+    importancePtr++;
+  }
+}
 
-      outPoint[0] += xAxis[0];
-      outPoint[1] += xAxis[1];
-      outPoint[2] += xAxis[2];
-    }
-    break;
-  case  vtkPlusPasteSliceIntoVolume::LATEST_COMPOUNDING_MODE :
-    for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++)
+//----------------------------------------------------------------------------
+/*! 
+  Optimized trilinear interpolation, specifically optimized for fixed
+  point (i.e. integer) mathematics.
+  The row is processed in chunks: output voxel indices and interpolation weights of a chunk are computed
+  by a SIMD kernel then the pixels are pasted into the voxels one by one.
+*/
+template <class T>
+static inline void vtkFreehand2OptimizedLinearHelper(int xIntersectionPixStart,
+                                                     int xIntersectionPixEnd,
+                                                     fixed *outPoint1,
+                                                     fixed *xAxis,
+                                                     T *&inPtr,
+                                                     T *outPtr,
+                                                     int *outExt,
+                                                     vtkIdType *outInc,
+                                                     int numscalars,
+                                                     vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
+                                                     unsigned short *accPtr,
+                                                     PlusBrickedVolume *brickedVolume,
+                                                     unsigned char *&importancePtr,
+                                                     unsigned int *accOverflowCount,
+                                                     double pixelRejectionThreshold,
+                                                     int simdInstructionSet)
+{
+  bool pixelRejectionEnabled = PixelRejectionEnabled(pixelRejectionThreshold);
+  double pixelRejectionThresholdSumAllComponents = 0;
+  if (pixelRejectionEnabled)
+  {
+    pixelRejectionThresholdSumAllComponents = pixelRejectionThreshold * numscalars;
+  }
+
+  vtkPlusTrilinearWeightsChunk weightsChunk;
+  fixed outPoint[3];
+  int outId0[3];
+  int outId1[3];
+  fixed fdx[8];
+
+  for (int chunkStart = xIntersectionPixStart; chunkStart <= xIntersectionPixEnd; chunkStart += SIMD_CHUNK_SIZE)
+  {
+    int chunkLength = std::min(SIMD_CHUNK_SIZE, xIntersectionPixEnd - chunkStart + 1);
+    outPoint[0] = outPoint1[0] + chunkStart*xAxis[0];
+    outPoint[1] = outPoint1[1] + chunkStart*xAxis[1];
+    outPoint[2] = outPoint1[2] + chunkStart*xAxis[2];
+    vtkComputeTrilinearWeightsChunk(simdInstructionSet, outPoint, xAxis, chunkLength, weightsChunk);
+
+    for (int k = 0; k < chunkLength; k++)
     {
       if (pixelRejectionEnabled)
       {
@@ -984,44 +1098,26 @@ static inline void vtkFreehand2OptimizedNNHelper(int xIntersectionPixStart,
         if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
         {
           // too dark, skip this pixel
-          inPtr += numscalars;
-          outPoint[0] += xAxis[0];
-          outPoint[1] += xAxis[1];
-          outPoint[2] += xAxis[2];
+          inPtr += numscalars; // go to the next x pixel
+          importancePtr++;
           continue;
         }
       }
 
-      int outIdX = PlusMath::Round(outPoint[0]);
-      int outIdY = PlusMath::Round(outPoint[1]);
-      int outIdZ = PlusMath::Round(outPoint[2]);
-
-      int inc = outIdX*outInc[0] + outIdY*outInc[1] + outIdZ*outInc[2];
-      T *outPtr1 = outPtr + inc;
-      // divide by outInc[0] to accomodate for the difference
-      // in the number of scalar pointers between the output
-      // and the accumulation buffer
-      unsigned short *accPtr1 = accPtr + (inc/outInc[0]);
-      int i = numscalars;
-      do 
+      outId0[0] = weightsChunk.OutIdX0[k];
+      outId0[1] = weightsChunk.OutIdY0[k];
+      outId0[2] = weightsChunk.OutIdZ0[k];
+      outId1[0] = weightsChunk.OutIdX1[k];
+      outId1[1] = weightsChunk.OutIdY1[k];
+      outId1[2] = weightsChunk.OutIdZ1[k];
+      for (int j = 0; j < 8; j++)
       {
-        i--;
-        *outPtr1 = *inPtr;
-        outPtr1++;
-        inPtr++;
+        fdx[j].i = weightsChunk.Weights[j][k];
       }
-      while (i);
-
-      *accPtr1 = (unsigned short)ACCUMULATION_MULTIPLIER;
-
-      outPoint[0] += xAxis[0];
-      outPoint[1] += xAxis[1];
-      outPoint[2] += xAxis[2];
+      vtkTrilinearInterpolationWithWeights(outId0, outId1, fdx, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, brickedVolume, accOverflowCount);
+      inPtr += numscalars; // go to the next x pixel
+      importancePtr++;
     }
-    break;
-  default:
-    LOG_ERROR("Unknown Compounding operator detected, value " << compoundingMode << ". Leaving value as-is.");
-    break;
   }
 }
 
@@ -1034,6 +1130,7 @@ static void vtkOptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSliceParams
   vtkImageData* outData = insertionParams->outData;
   T* outPtr = reinterpret_cast<T*>(insertionParams->outPtr);
   unsigned short* accPtr = insertionParams->accPtr;
+  PlusBrickedVolume* brickedVolume = insertionParams->brickedVolume;
   unsigned char* importancePtr = insertionParams->importancePtr;
   vtkImageData* inData = insertionParams->inData;
   T* inPtr = reinterpret_cast<T*>(insertionParams->inPtr);
@@ -1051,6 +1148,7 @@ static void vtkOptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSliceParams
   // details specified by the user RE: how the voxels should be computed
   vtkPlusPasteSliceIntoVolume::InterpolationType interpolationMode = insertionParams->interpolationMode;   // linear or nearest neighbor
   vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode = insertionParams->compoundingMode;         // weighted average or maximum
+  int simdInstructionSet = insertionParams->simdInstructionSet;   // used for computing voxel indices and weights with fixed-point math
 
   // parameters for clipping
   double* clipRectangleOrigin = insertionParams->clipRectangleOrigin; // array size 2
@@ -1147,13 +1245,6 @@ static void vtkOptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSliceParams
 
   bool fanClippingEnabled = (fanLinePixelRatioLeft != 0 || fanLinePixelRatioRight != 0);
 
-  bool pixelRejectionEnabled = PixelRejectionEnabled(insertionParams->pixelRejectionThreshold);
-  double pixelRejectionThresholdSumAllComponents = 0;
-  if (pixelRejectionEnabled)
-  {
-    pixelRejectionThresholdSumAllComponents = insertionParams->pixelRejectionThreshold * numscalars;
-  }
-
   int xIntersectionPixStart,xIntersectionPixEnd;
 
   // Loop through INPUT pixels - remember this is a 3D cube represented by the input extent
@@ -1297,86 +1388,23 @@ static void vtkOptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSliceParams
       { 
         if (skipMiddleSegment)
         {
-          for (int idX = xIntersectionPixStart; idX < xSkipMiddleSegmentPixStart; idX++) // for all of the x pixels within the fan before the skipped middle section
-          {
-            if (pixelRejectionEnabled)
-            {
-              double inPixelSumAllComponents = 0;
-              for (int i = numscalars-1; i>=0; i--)
-              {
-                inPixelSumAllComponents+=inPtr[i];
-              }
-              if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
-              {
-                // too dark, skip this pixel
-                inPtr += numscalars; // go to the next x pixel
-                importancePtr++;
-                continue;
-              }
-            }
-
-            outPoint[0] = outPoint1[0] + idX*xAxis[0];
-            outPoint[1] = outPoint1[1] + idX*xAxis[1];
-            outPoint[2] = outPoint1[2] + idX*xAxis[2];
-            vtkTrilinearInterpolation(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, accOverflowCount); // hit is either 1 or 0
-            inPtr += numscalars; // go to the next x pixel
-            importancePtr++;
-          }
+          // for all of the x pixels within the fan before the skipped middle section
+          vtkFreehand2OptimizedLinearHelper(xIntersectionPixStart, xSkipMiddleSegmentPixStart-1, outPoint1, xAxis,
+            inPtr, outPtr, outExt, outInc,
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
           inPtr += numscalars * (xSkipMiddleSegmentPixEnd-xSkipMiddleSegmentPixStart+1);
           importancePtr += xSkipMiddleSegmentPixEnd - xSkipMiddleSegmentPixStart + 1;
-          for (int idX = xSkipMiddleSegmentPixEnd+1; idX <= xIntersectionPixEnd; idX++) // for all of the x pixels within the fan after the skipped middle section
-          {
-            if (pixelRejectionEnabled)
-            {
-              double inPixelSumAllComponents = 0;
-              for (int i = numscalars-1; i>=0; i--)
-              {
-                inPixelSumAllComponents+=inPtr[i];
-              }
-              if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
-              {
-                // too dark, skip this pixel
-                inPtr += numscalars; // go to the next x pixel
-                importancePtr++;
-                continue;
-              }
-            }
-
-            outPoint[0] = outPoint1[0] + idX*xAxis[0];
-            outPoint[1] = outPoint1[1] + idX*xAxis[1];
-            outPoint[2] = outPoint1[2] + idX*xAxis[2];
-            vtkTrilinearInterpolation(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, accOverflowCount); // hit is either 1 or 0
-            inPtr += numscalars; // go to the next x pixel
-            importancePtr++;
-          }
+          // for all of the x pixels within the fan after the skipped middle section
+          vtkFreehand2OptimizedLinearHelper(xSkipMiddleSegmentPixEnd+1, xIntersectionPixEnd, outPoint1, xAxis,
+            inPtr, outPtr, outExt, outInc,
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
         }
         else
         {
-          for (int idX = xIntersectionPixStart; idX <= xIntersectionPixEnd; idX++) // for all of the x pixels within the fan
-          {
-            if (pixelRejectionEnabled)
-            {
-              double inPixelSumAllComponents = 0;
-              for (int i = numscalars-1; i>=0; i--)
-              {
-                inPixelSumAllComponents+=inPtr[i];
-              }
-              if (inPixelSumAllComponents<pixelRejectionThresholdSumAllComponents)
-              {
-                // too dark, skip this pixel
-                inPtr += numscalars; // go to the next x pixel
-                importancePtr++;
-                continue;
-              }
-            }
-
-            outPoint[0] = outPoint1[0] + idX*xAxis[0];
-            outPoint[1] = outPoint1[1] + idX*xAxis[1];
-            outPoint[2] = outPoint1[2] + idX*xAxis[2];
-            vtkTrilinearInterpolation(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, accOverflowCount); // hit is either 1 or 0
-            inPtr += numscalars; // go to the next x pixel
-            importancePtr++;
-          }
+          // for all of the x pixels within the fan
+          vtkFreehand2OptimizedLinearHelper(xIntersectionPixStart, xIntersectionPixEnd, outPoint1, xAxis,
+            inPtr, outPtr, outExt, outInc,
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
         }
       }      
       else 
@@ -1386,18 +1414,18 @@ static void vtkOptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSliceParams
         {
           vtkFreehand2OptimizedNNHelper(xIntersectionPixStart, xSkipMiddleSegmentPixStart-1, outPoint, outPoint1, xAxis, 
             inPtr, outPtr, outExt, outInc,
-            numscalars, compoundingMode, accPtr, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold);
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
           inPtr += numscalars * (xSkipMiddleSegmentPixEnd-xSkipMiddleSegmentPixStart+1);
           importancePtr += (xSkipMiddleSegmentPixEnd - xSkipMiddleSegmentPixStart + 1);;
           vtkFreehand2OptimizedNNHelper(xSkipMiddleSegmentPixEnd+1, xIntersectionPixEnd, outPoint, outPoint1, xAxis, 
             inPtr, outPtr, outExt, outInc,
-            numscalars, compoundingMode, accPtr, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold);
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
         }
         else
         {
           vtkFreehand2OptimizedNNHelper(xIntersectionPixStart, xIntersectionPixEnd, outPoint, outPoint1, xAxis, 
             inPtr, outPtr, outExt, outInc,
-            numscalars, compoundingMode, accPtr, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold);
+            numscalars, compoundingMode, accPtr, brickedVolume, importancePtr, accOverflowCount, insertionParams->pixelRejectionThreshold, simdInstructionSet);
         }
       }
 
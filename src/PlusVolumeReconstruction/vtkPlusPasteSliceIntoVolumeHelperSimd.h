@@ -0,0 +1,444 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusPasteSliceIntoVolumeHelperSimd.h
+  \brief SIMD kernels for pasting slice into volume with fixed-point math
+
+  Computes the output voxel indices (nearest neighbor interpolation) and the output voxel indices and
+  weights (trilinear interpolation) for a run of consecutive pixels of an input image row.
+  SSE4.1 and AVX2 implementations are provided, the instruction set is selected at runtime.
+  The kernels use integer arithmetic only, therefore their results are bit-exact with the scalar code.
+
+  Compounding is not vectorized: consecutive pixels are often pasted into the same voxel, so the voxel
+  updates have to be done sequentially, in the order of the pixels.
+
+  \sa vtkPlusPasteSliceIntoVolume, vtkPlusPasteSliceIntoVolumeHelperOptimized
+  \ingroup PlusLibVolumeReconstruction
+*/
+
+#ifndef __vtkPlusPasteSliceIntoVolumeHelperSimd_h
+#define __vtkPlusPasteSliceIntoVolumeHelperSimd_h
+
+#include "vtkPlusPasteSliceIntoVolumeHelperCommon.h"
+#include "PlusMath.h"
+#include "fixed.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define PLUS_PASTE_SLICE_X86_SIMD
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#endif
+
+// GCC and Clang only emit instructions of the enabled instruction sets, so the SIMD kernels
+// have to be marked explicitly (this way the rest of the library does not require SSE4.1 or AVX2).
+#if defined(PLUS_PASTE_SLICE_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  #define PLUS_SIMD_TARGET_SSE41 __attribute__((target("sse4.1")))
+  #define PLUS_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define PLUS_SIMD_TARGET_SSE41
+  #define PLUS_SIMD_TARGET_AVX2
+#endif
+
+// Number of pixels that are processed by one call of a SIMD kernel (size of the temporary buffers)
+#define SIMD_CHUNK_SIZE 128
+
+/*!
+  Output voxel indices and trilinear interpolation weights for SIMD_CHUNK_SIZE pixels.
+  Arrays are indexed by the pixel index within the chunk (structure of arrays layout, so that
+  the SIMD kernels can store full registers).
+*/
+struct vtkPlusTrilinearWeightsChunk
+{
+  int OutIdX0[SIMD_CHUNK_SIZE]; // floor
+  int OutIdY0[SIMD_CHUNK_SIZE];
+  int OutIdZ0[SIMD_CHUNK_SIZE];
+  int OutIdX1[SIMD_CHUNK_SIZE]; // ceiling
+  int OutIdY1[SIMD_CHUNK_SIZE];
+  int OutIdZ1[SIMD_CHUNK_SIZE];
+  int Weights[8][SIMD_CHUNK_SIZE]; // fixed::i of the weight towards each corner, same corner order as in vtkComputeTrilinearWeights
+};
+
+//----------------------------------------------------------------------------
+/*! Get the best SIMD instruction set that is supported by the CPU and the operating system */
+static inline vtkPlusPasteSliceIntoVolume::SimdInstructionSetType vtkGetSupportedSimdInstructionSet()
+{
+#if defined(PLUS_PASTE_SLICE_X86_SIMD) && defined(_MSC_VER)
+  int cpuInfo[4] = {0};
+  __cpuid(cpuInfo, 0);
+  int maxFunctionId = cpuInfo[0];
+  if (maxFunctionId < 1)
+  {
+    return vtkPlusPasteSliceIntoVolume::SIMD_NONE;
+  }
+  __cpuid(cpuInfo, 1);
+  bool sse41 = (cpuInfo[2] & (1 << 19)) != 0;
+  bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+  bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+  if (!sse41)
+  {
+    return vtkPlusPasteSliceIntoVolume::SIMD_NONE;
+  }
+  // AVX registers can only be used if the operating system saves them on context switch
+  if (osxsave && avx && maxFunctionId >= 7 && (_xgetbv(0) & 0x6) == 0x6)
+  {
+    __cpuidex(cpuInfo, 7, 0);
+    if ((cpuInfo[1] & (1 << 5)) != 0)
+    {
+      return vtkPlusPasteSliceIntoVolume::SIMD_AVX2;
+    }
+  }
+  return vtkPlusPasteSliceIntoVolume::SIMD_SSE41;
+#elif defined(PLUS_PASTE_SLICE_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return vtkPlusPasteSliceIntoVolume::SIMD_AVX2;
+  }
+  if (__builtin_cpu_supports("sse4.1"))
+  {
+    return vtkPlusPasteSliceIntoVolume::SIMD_SSE41;
+  }
+  return vtkPlusPasteSliceIntoVolume::SIMD_NONE;
+#else
+  return vtkPlusPasteSliceIntoVolume::SIMD_NONE;
+#endif
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Compute nearest voxel indices for count consecutive pixels, scalar implementation.
+  The output point of the first pixel is startPoint, the output point of each subsequent pixel
+  is computed by adding xAxis to the previous one.
+*/
+static inline void vtkComputeNearestVoxelIndicesScalar(const fixed* startPoint, const fixed* xAxis, int count,
+                                                       int* outIdX, int* outIdY, int* outIdZ)
+{
+  fixed outPoint[3] = {startPoint[0], startPoint[1], startPoint[2]};
+  for (int k = 0; k < count; k++)
+  {
+    outIdX[k] = PlusMath::Round(outPoint[0]);
+    outIdY[k] = PlusMath::Round(outPoint[1]);
+    outIdZ[k] = PlusMath::Round(outPoint[2]);
+    outPoint[0] += xAxis[0];
+    outPoint[1] += xAxis[1];
+    outPoint[2] += xAxis[2];
+  }
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Compute the trilinear interpolation voxel indices and weights of the pixel at index k within the chunk,
+  scalar implementation
+*/
+static inline void vtkComputeTrilinearWeightsScalar(const fixed* outPoint, int k, vtkPlusTrilinearWeightsChunk& chunk)
+{
+  int outId0[3] = {0};
+  int outId1[3] = {0};
+  fixed fdx[8];
+  vtkComputeTrilinearWeights(outPoint, outId0, outId1, fdx);
+  chunk.OutIdX0[k] = outId0[0];
+  chunk.OutIdY0[k] = outId0[1];
+  chunk.OutIdZ0[k] = outId0[2];
+  chunk.OutIdX1[k] = outId1[0];
+  chunk.OutIdY1[k] = outId1[1];
+  chunk.OutIdZ1[k] = outId1[2];
+  for (int j = 0; j < 8; j++)
+  {
+    chunk.Weights[j][k] = fdx[j].i;
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Compute trilinear interpolation voxel indices and weights for count consecutive pixels, scalar implementation */
+static inline void vtkComputeTrilinearWeightsChunkScalar(const fixed* startPoint, const fixed* xAxis, int firstIndex, int count,
+                                                         vtkPlusTrilinearWeightsChunk& chunk)
+{
+  fixed outPoint[3] = {startPoint[0], startPoint[1], startPoint[2]};
+  for (int k = firstIndex; k < count; k++)
+  {
+    vtkComputeTrilinearWeightsScalar(outPoint, k, chunk);
+    outPoint[0] += xAxis[0];
+    outPoint[1] += xAxis[1];
+    outPoint[2] += xAxis[2];
+  }
+}
+
+#ifdef PLUS_PASTE_SLICE_X86_SIMD
+
+//----------------------------------------------------------------------------
+/*! Compute nearest voxel indices for count consecutive pixels, SSE4.1 implementation */
+PLUS_SIMD_TARGET_SSE41
+static void vtkComputeNearestVoxelIndicesSse41(const fixed* startPoint, const fixed* xAxis, int count,
+                                               int* outIdX, int* outIdY, int* outIdZ)
+{
+  const int point = fixed::fraction_bits();
+  const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i half = _mm_set1_epi32(1 << (point - 1));
+  __m128i axisX = _mm_set1_epi32(xAxis[0].i);
+  __m128i axisY = _mm_set1_epi32(xAxis[1].i);
+  __m128i axisZ = _mm_set1_epi32(xAxis[2].i);
+  __m128i pointX = _mm_add_epi32(_mm_set1_epi32(startPoint[0].i), _mm_mullo_epi32(laneIndex, axisX));
+  __m128i pointY = _mm_add_epi32(_mm_set1_epi32(startPoint[1].i), _mm_mullo_epi32(laneIndex, axisY));
+  __m128i pointZ = _mm_add_epi32(_mm_set1_epi32(startPoint[2].i), _mm_mullo_epi32(laneIndex, axisZ));
+  __m128i stepX = _mm_slli_epi32(axisX, 2);
+  __m128i stepY = _mm_slli_epi32(axisY, 2);
+  __m128i stepZ = _mm_slli_epi32(axisZ, 2);
+
+  int k = 0;
+  for (; k + 4 <= count; k += 4)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outIdX + k), _mm_srai_epi32(_mm_add_epi32(pointX, half), point));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outIdY + k), _mm_srai_epi32(_mm_add_epi32(pointY, half), point));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outIdZ + k), _mm_srai_epi32(_mm_add_epi32(pointZ, half), point));
+    pointX = _mm_add_epi32(pointX, stepX);
+    pointY = _mm_add_epi32(pointY, stepY);
+    pointZ = _mm_add_epi32(pointZ, stepZ);
+  }
+
+  if (k < count)
+  {
+    fixed remainingStartPoint[3];
+    remainingStartPoint[0].i = _mm_cvtsi128_si32(pointX);
+    remainingStartPoint[1].i = _mm_cvtsi128_si32(pointY);
+    remainingStartPoint[2].i = _mm_cvtsi128_si32(pointZ);
+    vtkComputeNearestVoxelIndicesScalar(remainingStartPoint, xAxis, count - k, outIdX + k, outIdY + k, outIdZ + k);
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Compute nearest voxel indices for count consecutive pixels, AVX2 implementation */
+PLUS_SIMD_TARGET_AVX2
+static void vtkComputeNearestVoxelIndicesAvx2(const fixed* startPoint, const fixed* xAxis, int count,
+                                              int* outIdX, int* outIdY, int* outIdZ)
+{
+  const int point = fixed::fraction_bits();
+  const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i half = _mm256_set1_epi32(1 << (point - 1));
+  __m256i axisX = _mm256_set1_epi32(xAxis[0].i);
+  __m256i axisY = _mm256_set1_epi32(xAxis[1].i);
+  __m256i axisZ = _mm256_set1_epi32(xAxis[2].i);
+  __m256i pointX = _mm256_add_epi32(_mm256_set1_epi32(startPoint[0].i), _mm256_mullo_epi32(laneIndex, axisX));
+  __m256i pointY = _mm256_add_epi32(_mm256_set1_epi32(startPoint[1].i), _mm256_mullo_epi32(laneIndex, axisY));
+  __m256i pointZ = _mm256_add_epi32(_mm256_set1_epi32(startPoint[2].i), _mm256_mullo_epi32(laneIndex, axisZ));
+  __m256i stepX = _mm256_slli_epi32(axisX, 3);
+  __m256i stepY = _mm256_slli_epi32(axisY, 3);
+  __m256i stepZ = _mm256_slli_epi32(axisZ, 3);
+
+  int k = 0;
+  for (; k + 8 <= count; k += 8)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(outIdX + k), _mm256_srai_epi32(_mm256_add_epi32(pointX, half), point));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(outIdY + k), _mm256_srai_epi32(_mm256_add_epi32(pointY, half), point));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(outIdZ + k), _mm256_srai_epi32(_mm256_add_epi32(pointZ, half), point));
+    pointX = _mm256_add_epi32(pointX, stepX);
+    pointY = _mm256_add_epi32(pointY, stepY);
+    pointZ = _mm256_add_epi32(pointZ, stepZ);
+  }
+
+  if (k < count)
+  {
+    fixed remainingStartPoint[3];
+    remainingStartPoint[0].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(pointX));
+    remainingStartPoint[1].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(pointY));
+    remainingStartPoint[2].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(pointZ));
+    vtkComputeNearestVoxelIndicesScalar(remainingStartPoint, xAxis, count - k, outIdX + k, outIdY + k, outIdZ + k);
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Fixed-point multiplication of 4 values, same result as fixed::fast_multiply */
+PLUS_SIMD_TARGET_SSE41
+static inline __m128i vtkFixedMultiplySse41(__m128i x, __m128i y)
+{
+  return _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(x, y), _mm_set1_epi32(1 << (fixed::fraction_bits() - 1))), fixed::fraction_bits());
+}
+
+//----------------------------------------------------------------------------
+/*! Compute trilinear interpolation voxel indices and weights for count consecutive pixels, SSE4.1 implementation */
+PLUS_SIMD_TARGET_SSE41
+static void vtkComputeTrilinearWeightsChunkSse41(const fixed* startPoint, const fixed* xAxis, int count,
+                                                 vtkPlusTrilinearWeightsChunk& chunk)
+{
+  const int point = fixed::fraction_bits();
+  const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i fractionMask = _mm_set1_epi32((1 << point) - 1);
+  const __m128i fixedOne = _mm_set1_epi32(1 << point);
+  const __m128i intOne = _mm_set1_epi32(1);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i axis[3];
+  __m128i outPoint[3];
+  __m128i step[3];
+  for (int i = 0; i < 3; i++)
+  {
+    axis[i] = _mm_set1_epi32(xAxis[i].i);
+    outPoint[i] = _mm_add_epi32(_mm_set1_epi32(startPoint[i].i), _mm_mullo_epi32(laneIndex, axis[i]));
+    step[i] = _mm_slli_epi32(axis[i], 2);
+  }
+  int* outId0[3] = {chunk.OutIdX0, chunk.OutIdY0, chunk.OutIdZ0};
+  int* outId1[3] = {chunk.OutIdX1, chunk.OutIdY1, chunk.OutIdZ1};
+
+  int k = 0;
+  for (; k + 4 <= count; k += 4)
+  {
+    __m128i f[3]; // fraction
+    __m128i r[3]; // remainder (1 - fraction)
+    for (int i = 0; i < 3; i++)
+    {
+      __m128i idFloor = _mm_srai_epi32(outPoint[i], point);
+      f[i] = _mm_and_si128(outPoint[i], fractionMask);
+      r[i] = _mm_sub_epi32(fixedOne, f[i]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(outId0[i] + k), idFloor);
+      // ceiling: floor+1 if there is a fractional part (comparison result is -1 if the fraction is zero)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(outId1[i] + k), _mm_add_epi32(_mm_add_epi32(idFloor, intOne), _mm_cmpeq_epi32(f[i], zero)));
+      outPoint[i] = _mm_add_epi32(outPoint[i], step[i]);
+    }
+    __m128i ryrz = vtkFixedMultiplySse41(r[1], r[2]);
+    __m128i ryfz = vtkFixedMultiplySse41(r[1], f[2]);
+    __m128i fyrz = vtkFixedMultiplySse41(f[1], r[2]);
+    __m128i fyfz = vtkFixedMultiplySse41(f[1], f[2]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[0] + k), vtkFixedMultiplySse41(r[0], ryrz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[1] + k), vtkFixedMultiplySse41(r[0], ryfz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[2] + k), vtkFixedMultiplySse41(r[0], fyrz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[3] + k), vtkFixedMultiplySse41(r[0], fyfz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[4] + k), vtkFixedMultiplySse41(f[0], ryrz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[5] + k), vtkFixedMultiplySse41(f[0], ryfz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[6] + k), vtkFixedMultiplySse41(f[0], fyrz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(chunk.Weights[7] + k), vtkFixedMultiplySse41(f[0], fyfz));
+  }
+
+  if (k < count)
+  {
+    fixed remainingStartPoint[3];
+    remainingStartPoint[0].i = _mm_cvtsi128_si32(outPoint[0]);
+    remainingStartPoint[1].i = _mm_cvtsi128_si32(outPoint[1]);
+    remainingStartPoint[2].i = _mm_cvtsi128_si32(outPoint[2]);
+    vtkComputeTrilinearWeightsChunkScalar(remainingStartPoint, xAxis, k, count, chunk);
+  }
+}
+
+//----------------------------------------------------------------------------
+/*! Fixed-point multiplication of 8 values, same result as fixed::fast_multiply */
+PLUS_SIMD_TARGET_AVX2
+static inline __m256i vtkFixedMultiplyAvx2(__m256i x, __m256i y)
+{
+  return _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(x, y), _mm256_set1_epi32(1 << (fixed::fraction_bits() - 1))), fixed::fraction_bits());
+}
+
+//----------------------------------------------------------------------------
+/*! Compute trilinear interpolation voxel indices and weights for count consecutive pixels, AVX2 implementation */
+PLUS_SIMD_TARGET_AVX2
+static void vtkComputeTrilinearWeightsChunkAvx2(const fixed* startPoint, const fixed* xAxis, int count,
+                                                vtkPlusTrilinearWeightsChunk& chunk)
+{
+  const int point = fixed::fraction_bits();
+  const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i fractionMask = _mm256_set1_epi32((1 << point) - 1);
+  const __m256i fixedOne = _mm256_set1_epi32(1 << point);
+  const __m256i intOne = _mm256_set1_epi32(1);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i axis[3];
+  __m256i outPoint[3];
+  __m256i step[3];
+  for (int i = 0; i < 3; i++)
+  {
+    axis[i] = _mm256_set1_epi32(xAxis[i].i);
+    outPoint[i] = _mm256_add_epi32(_mm256_set1_epi32(startPoint[i].i), _mm256_mullo_epi32(laneIndex, axis[i]));
+    step[i] = _mm256_slli_epi32(axis[i], 3);
+  }
+  int* outId0[3] = {chunk.OutIdX0, chunk.OutIdY0, chunk.OutIdZ0};
+  int* outId1[3] = {chunk.OutIdX1, chunk.OutIdY1, chunk.OutIdZ1};
+
+  int k = 0;
+  for (; k + 8 <= count; k += 8)
+  {
+    __m256i f[3]; // fraction
+    __m256i r[3]; // remainder (1 - fraction)
+    for (int i = 0; i < 3; i++)
+    {
+      __m256i idFloor = _mm256_srai_epi32(outPoint[i], point);
+      f[i] = _mm256_and_si256(outPoint[i], fractionMask);
+      r[i] = _mm256_sub_epi32(fixedOne, f[i]);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(outId0[i] + k), idFloor);
+      // ceiling: floor+1 if there is a fractional part (comparison result is -1 if the fraction is zero)
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(outId1[i] + k), _mm256_add_epi32(_mm256_add_epi32(idFloor, intOne), _mm256_cmpeq_epi32(f[i], zero)));
+      outPoint[i] = _mm256_add_epi32(outPoint[i], step[i]);
+    }
+    __m256i ryrz = vtkFixedMultiplyAvx2(r[1], r[2]);
+    __m256i ryfz = vtkFixedMultiplyAvx2(r[1], f[2]);
+    __m256i fyrz = vtkFixedMultiplyAvx2(f[1], r[2]);
+    __m256i fyfz = vtkFixedMultiplyAvx2(f[1], f[2]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[0] + k), vtkFixedMultiplyAvx2(r[0], ryrz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[1] + k), vtkFixedMultiplyAvx2(r[0], ryfz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[2] + k), vtkFixedMultiplyAvx2(r[0], fyrz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[3] + k), vtkFixedMultiplyAvx2(r[0], fyfz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[4] + k), vtkFixedMultiplyAvx2(f[0], ryrz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[5] + k), vtkFixedMultiplyAvx2(f[0], ryfz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[6] + k), vtkFixedMultiplyAvx2(f[0], fyrz));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk.Weights[7] + k), vtkFixedMultiplyAvx2(f[0], fyfz));
+  }
+
+  if (k < count)
+  {
+    fixed remainingStartPoint[3];
+    remainingStartPoint[0].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(outPoint[0]));
+    remainingStartPoint[1].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(outPoint[1]));
+    remainingStartPoint[2].i = _mm_cvtsi128_si32(_mm256_castsi256_si128(outPoint[2]));
+    vtkComputeTrilinearWeightsChunkScalar(remainingStartPoint, xAxis, k, count, chunk);
+  }
+}
+
+#endif // PLUS_PASTE_SLICE_X86_SIMD
+
+//----------------------------------------------------------------------------
+/*!
+  Compute nearest voxel indices for count (at most SIMD_CHUNK_SIZE) consecutive pixels,
+  using the requested instruction set
+*/
+static inline void vtkComputeNearestVoxelIndices(int simdInstructionSet, const fixed* startPoint, const fixed* xAxis, int count,
+                                                 int* outIdX, int* outIdY, int* outIdZ)
+{
+#ifdef PLUS_PASTE_SLICE_X86_SIMD
+  if (simdInstructionSet == vtkPlusPasteSliceIntoVolume::SIMD_AVX2)
+  {
+    vtkComputeNearestVoxelIndicesAvx2(startPoint, xAxis, count, outIdX, outIdY, outIdZ);
+    return;
+  }
+  if (simdInstructionSet == vtkPlusPasteSliceIntoVolume::SIMD_SSE41)
+  {
+    vtkComputeNearestVoxelIndicesSse41(startPoint, xAxis, count, outIdX, outIdY, outIdZ);
+    return;
+  }
+#endif
+  vtkComputeNearestVoxelIndicesScalar(startPoint, xAxis, count, outIdX, outIdY, outIdZ);
+}
+
+//----------------------------------------------------------------------------
+/*!
+  Compute trilinear interpolation voxel indices and weights for count (at most SIMD_CHUNK_SIZE)
+  consecutive pixels, using the requested instruction set
+*/
+static inline void vtkComputeTrilinearWeightsChunk(int simdInstructionSet, const fixed* startPoint, const fixed* xAxis, int count,
+                                                   vtkPlusTrilinearWeightsChunk& chunk)
+{
+#ifdef PLUS_PASTE_SLICE_X86_SIMD
+  if (simdInstructionSet == vtkPlusPasteSliceIntoVolume::SIMD_AVX2)
+  {
+    vtkComputeTrilinearWeightsChunkAvx2(startPoint, xAxis, count, chunk);
+    return;
+  }
+  if (simdInstructionSet == vtkPlusPasteSliceIntoVolume::SIMD_SSE41)
+  {
+    vtkComputeTrilinearWeightsChunkSse41(startPoint, xAxis, count, chunk);
+    return;
+  }
+#endif
+  vtkComputeTrilinearWeightsChunkScalar(startPoint, xAxis, 0, count, chunk);
+}
+
+#endif
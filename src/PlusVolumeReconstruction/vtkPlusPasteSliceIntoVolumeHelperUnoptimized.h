@@ -89,6 +89,7 @@ static int vtkNearestNeighborInterpolation(F *point,
                                            vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode,
                                            int outExt[6],
                                            vtkIdType outInc[3],
+                                           PlusBrickedVolume *brickedVolume,
                                            unsigned int* accOverflowCount)
 {
   int i;
@@ -104,14 +105,11 @@ static int vtkNearestNeighborInterpolation(F *point,
        outIdY | (outExt[3]-outExt[2] - outIdY) |
        outIdZ | (outExt[5]-outExt[4] - outIdZ)) >= 0)
   {
-    int inc = outIdX*outInc[0]+outIdY*outInc[1]+outIdZ*outInc[2];
-    outPtr += inc;
+    vtkGetOutputVoxelPointers(outIdX, outIdY, outIdZ, outPtr, accPtr, outInc, brickedVolume, outPtr, accPtr);
     switch (compoundingMode)
     {
     case (vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE):
       {
-        accPtr += inc/outInc[0];
-
         int newa = *accPtr + ACCUMULATION_MULTIPLIER;
         if (newa > ACCUMULATION_THRESHOLD)
           (*accOverflowCount) += 1;
@@ -134,7 +132,6 @@ static int vtkNearestNeighborInterpolation(F *point,
       }
     case (vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE):
       {
-        accPtr += inc/outInc[0];
         if (*accPtr <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
 
           int newa = *accPtr + ACCUMULATION_MULTIPLIER;
@@ -160,7 +157,6 @@ static int vtkNearestNeighborInterpolation(F *point,
       }
     case (vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE):
       {
-        accPtr += inc/outInc[0];
         if (*accPtr <= ACCUMULATION_THRESHOLD) { // no overflow, act normally
 
           if (*importancePtr == 0)
@@ -197,8 +193,6 @@ static int vtkNearestNeighborInterpolation(F *point,
       }
     case (vtkPlusPasteSliceIntoVolume::LATEST_COMPOUNDING_MODE):
       {
-        accPtr += inc/outInc[0];
-
         int newa = *accPtr + ACCUMULATION_MULTIPLIER;
         if (newa > ACCUMULATION_THRESHOLD)
           (*accOverflowCount) += 1;
@@ -326,7 +320,7 @@ static void vtkUnoptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSlicePara
   }
 
   // Set interpolation method - nearest neighbor or trilinear  
-  int (*interpolate)(F *, T *, T *, unsigned short *, unsigned char *, int, vtkPlusPasteSliceIntoVolume::CompoundingType, int a[6], vtkIdType b[3], unsigned int *)=NULL; // pointer to the nearest neighbor or trilinear interpolation function  
+  int (*interpolate)(F *, T *, T *, unsigned short *, unsigned char *, int, vtkPlusPasteSliceIntoVolume::CompoundingType, int a[6], vtkIdType b[3], PlusBrickedVolume *, unsigned int *)=NULL; // pointer to the nearest neighbor or trilinear interpolation function  
   switch (interpolationMode)
   {
   case vtkPlusPasteSliceIntoVolume::NEAREST_NEIGHBOR_INTERPOLATION:
@@ -421,7 +415,7 @@ static void vtkUnoptimizedInsertSlice(vtkPlusPasteSliceIntoVolumeInsertSlicePara
         outPoint[3] = 1;
 
         // interpolation functions return 1 if the interpolation was successful, 0 otherwise
-        interpolate(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, accOverflowCount);
+        interpolate(outPoint, inPtr, outPtr, accPtr, importancePtr, numscalars, compoundingMode, outExt, outInc, insertionParams->brickedVolume, accOverflowCount);
       }
     }
   }
@@ -46,6 +46,7 @@ vtkPlusVolumeReconstructor::vtkPlusVolumeReconstructor()
   , EnableFanAnglesAutoDetect(false)
   , SkipInterval(1)
   , ReconstructedVolumeUpdatedTime(0)
+  , HoleFilledVolumeValid(false)
 {
   this->FanAnglesDeg[0] = 0.0;
   this->FanAnglesDeg[1] = 0.0;
@@ -131,6 +132,7 @@ PlusStatus vtkPlusVolumeReconstructor::ReadConfiguration(vtkXMLDataElement* conf
                                     this->Reconstructor->GetCompoundingModeAsString(vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE), vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE);
 
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfThreads, reconConfig);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableBrickedStorage, reconConfig);
 
   XML_READ_ENUM2_ATTRIBUTE_OPTIONAL(FillHoles, reconConfig, "ON", true, "OFF", false);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableFanAnglesAutoDetect, reconConfig);
@@ -145,6 +147,8 @@ PlusStatus vtkPlusVolumeReconstructor::ReadConfiguration(vtkXMLDataElement* conf
       return PLUS_FAIL;
     }
   }
+  // kernels may have been changed, hole filling has to be recomputed for the whole volume
+  this->HoleFilledVolumeValid = false;
 
   // ==== Warn if using DEPRECATED XML tags (2014-08-15, #923) ====
   XML_READ_WARNING_DEPRECATED_CSTRING_REPLACED(Compounding, reconConfig, CompoundingMode);
@@ -251,6 +255,15 @@ PlusStatus vtkPlusVolumeReconstructor::WriteConfiguration(vtkXMLDataElement* con
     XML_REMOVE_ATTRIBUTE(reconConfig, "NumberOfThreads");
   }
 
+  if (this->GetEnableBrickedStorage())
+  {
+    XML_WRITE_BOOL_ATTRIBUTE(EnableBrickedStorage, reconConfig);
+  }
+  else
+  {
+    XML_REMOVE_ATTRIBUTE(reconConfig, "EnableBrickedStorage");
+  }
+
   XML_WRITE_STRING_ATTRIBUTE_REMOVE_IF_EMPTY(ImportanceMaskFilename, reconConfig);
 
   if (this->Reconstructor->IsPixelRejectionEnabled())
@@ -477,15 +490,6 @@ PlusStatus vtkPlusVolumeReconstructor::AddTrackedFrame(PlusTrackedFrame* frame,
     return PLUS_FAIL;
   }
 
-  if (this->Reconstructor->GetCompoundingMode() == vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE)
-  {
-    if (UpdateImportanceMask() == PLUS_FAIL)
-    {
-      LOG_ERROR("Failed to get importance mask");
-      return PLUS_FAIL;
-    }
-  }
-
   bool isMatrixValid(false);
   vtkSmartPointer<vtkMatrix4x4> imageToReferenceTransformMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   if (transformRepository->GetTransform(imageToReferenceTransformName, imageToReferenceTransformMatrix, &isMatrixValid) != PLUS_SUCCESS)
@@ -510,6 +514,27 @@ PlusStatus vtkPlusVolumeReconstructor::AddTrackedFrame(PlusTrackedFrame* frame,
     return PLUS_SUCCESS;
   }
 
+  return InsertTrackedFrame(frame, imageToReferenceTransformMatrix);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVolumeReconstructor::InsertTrackedFrame(PlusTrackedFrame* frame, vtkMatrix4x4* imageToReferenceTransformMatrix)
+{
+  if (frame == NULL || imageToReferenceTransformMatrix == NULL)
+  {
+    LOG_ERROR("Failed to insert tracked frame into volume - input frame or transform is NULL");
+    return PLUS_FAIL;
+  }
+
+  if (this->Reconstructor->GetCompoundingMode() == vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE)
+  {
+    if (UpdateImportanceMask() == PLUS_FAIL)
+    {
+      LOG_ERROR("Failed to get importance mask");
+      return PLUS_FAIL;
+    }
+  }
+
   vtkImageData* frameImage = frame->GetImageData()->GetImage();
   bool isImageEmpty = false;
   UpdateFanAnglesFromImage(frameImage, isImageEmpty);
@@ -546,7 +571,10 @@ PlusStatus vtkPlusVolumeReconstructor::UpdateReconstructedVolume()
   }
   else
   {
-    this->ReconstructedVolume->DeepCopy(this->Reconstructor->GetReconstructedVolume());
+    // No processing is needed, so just share the voxels of the reconstructor
+    // (the volume is copied when it is retrieved by GetReconstructedVolume or ExtractGrayLevels)
+    this->ReconstructedVolume->ShallowCopy(this->Reconstructor->GetReconstructedVolume());
+    this->HoleFilledVolumeValid = false;
   }
 
   this->ReconstructedVolumeUpdatedTime = this->GetMTime();
@@ -564,20 +592,85 @@ PlusStatus vtkPlusVolumeReconstructor::GetReconstructedVolume(vtkImageData* volu
   }
 
   volume->DeepCopy(this->ReconstructedVolume);
+  this->ReleaseDenseOutputIfBricked();
 
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusVolumeReconstructor::ReleaseDenseOutputIfBricked()
+{
+  if (!this->Reconstructor->ReleaseDenseOutput())
+  {
+    // dense storage, the volume is kept so that it can be updated incrementally
+    return;
+  }
+  // The hole filled volume and the filter output may share voxels with the released dense output
+  this->ReconstructedVolume->Initialize();
+  this->HoleFiller->GetOutput()->Initialize();
+  this->HoleFilledVolumeValid = false;
+  // force re-export at the next retrieval even if no frames are added
+  this->ReconstructedVolumeUpdatedTime = 0;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusVolumeReconstructor::GenerateHoleFilledVolume()
 {
-  LOG_INFO("Hole Filling has begun");
-  this->HoleFiller->SetReconstructedVolume(this->Reconstructor->GetReconstructedVolume());
+  vtkImageData* volumeWithHoles = this->Reconstructor->GetReconstructedVolume();
+  this->HoleFiller->SetReconstructedVolume(volumeWithHoles);
   this->HoleFiller->SetAccumulationBuffer(this->Reconstructor->GetAccumulationBuffer());
+
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->Reconstructor->GetModifiedExtent(modifiedExtent);
+  this->Reconstructor->ResetModifiedExtent();
+
+  // Incremental update is only possible if the previous hole filled volume is compatible with the current reconstructed volume
+  bool incrementalUpdate = this->HoleFilledVolumeValid
+                           && this->ReconstructedVolume->GetScalarType() == volumeWithHoles->GetScalarType()
+                           && this->ReconstructedVolume->GetNumberOfScalarComponents() == volumeWithHoles->GetNumberOfScalarComponents();
+  int* holeFilledExtent = this->ReconstructedVolume->GetExtent();
+  int* volumeExtent = volumeWithHoles->GetExtent();
+  for (int i = 0; i < 6 && incrementalUpdate; i++)
+  {
+    incrementalUpdate = (holeFilledExtent[i] == volumeExtent[i]);
+  }
+
+  if (incrementalUpdate)
+  {
+    if (modifiedExtent[0] > modifiedExtent[1] || modifiedExtent[2] > modifiedExtent[3] || modifiedExtent[4] > modifiedExtent[5])
+    {
+      // no voxels have been changed
+      return PLUS_SUCCESS;
+    }
+    // Hole filled voxels depend on the input voxels within the kernel size, therefore
+    // all voxels that are within the kernel margin of a modified voxel has to be updated
+    int margin = this->HoleFiller->GetKernelMargin();
+    for (int i = 0; i < 3; i++)
+    {
+      modifiedExtent[i * 2] -= margin;
+      modifiedExtent[i * 2 + 1] += margin;
+    }
+    LOG_DEBUG("Hole filling in extent [" << modifiedExtent[0] << ", " << modifiedExtent[1] << ", " << modifiedExtent[2] << ", "
+              << modifiedExtent[3] << ", " << modifiedExtent[4] << ", " << modifiedExtent[5] << "]");
+    if (this->HoleFiller->FillHolesInExtent(this->ReconstructedVolume, modifiedExtent) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to update hole filled volume");
+      this->HoleFilledVolumeValid = false;
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  LOG_INFO("Hole Filling has begun");
+  // make sure the filter is executed even if only the configuration has changed
+  this->HoleFiller->Modified();
   this->HoleFiller->Update();
   LOG_INFO("Hole Filling has finished");
 
-  this->ReconstructedVolume->DeepCopy(HoleFiller->GetOutput());
+  // Take over the filter output without copying the voxels. The filter allocates a new output buffer
+  // at next execution because the current one is referenced by ReconstructedVolume.
+  this->ReconstructedVolume->ShallowCopy(this->HoleFiller->GetOutput());
+  this->HoleFilledVolumeValid = true;
 
   return PLUS_SUCCESS;
 }
@@ -598,6 +691,7 @@ PlusStatus vtkPlusVolumeReconstructor::ExtractGrayLevels(vtkImageData* reconstru
   extract->Update();
 
   reconstructedVolume->DeepCopy(extract->GetOutput());
+  this->ReleaseDenseOutputIfBricked();
 
   return PLUS_SUCCESS;
 }
@@ -618,6 +712,7 @@ PlusStatus vtkPlusVolumeReconstructor::ExtractAccumulation(vtkImageData* accumul
   extract->Update();
 
   accumulationBuffer->DeepCopy(extract->GetOutput());
+  this->ReleaseDenseOutputIfBricked();
 
   return PLUS_SUCCESS;
 }
@@ -706,6 +801,8 @@ int* vtkPlusVolumeReconstructor::GetClipRectangleSize()
 void vtkPlusVolumeReconstructor::Reset()
 {
   this->Reconstructor->ResetOutput();
+  // the reconstructed volume has to be updated even if no frames are added after the reset
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -758,6 +855,18 @@ void vtkPlusVolumeReconstructor::SetNumberOfThreads(int numberOfThreads)
   this->HoleFiller->SetNumberOfThreads(numberOfThreads);
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusVolumeReconstructor::SetEnableBrickedStorage(bool enable)
+{
+  this->Reconstructor->SetEnableBrickedStorage(enable);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusVolumeReconstructor::GetEnableBrickedStorage()
+{
+  return this->Reconstructor->GetEnableBrickedStorage();
+}
+
 //----------------------------------------------------------------------------
 void vtkPlusVolumeReconstructor::SetClipRectangleOrigin(int* origin)
 {
@@ -13,6 +13,7 @@
 #include "vtkImageAlgorithm.h"
 
 class PlusTrackedFrame;
+class vtkMatrix4x4;
 class vtkPlusFanAngleDetectorAlgo;
 class vtkPlusFillHolesInVolume;
 class vtkPlusTrackedFrameList;
@@ -73,6 +74,12 @@ public:
   */
   virtual PlusStatus AddTrackedFrame(PlusTrackedFrame* frame, vtkPlusTransformRepository* transformRepository, bool* insertedIntoVolume = NULL);
 
+  /*!
+    Inserts the tracked frame into the volume using an already computed ImageToReference transform.
+    It allows resolving the transforms of a frame in a different thread than the one that pastes the slice into the volume.
+  */
+  virtual PlusStatus InsertTrackedFrame(PlusTrackedFrame* frame, vtkMatrix4x4* imageToReferenceTransformMatrix);
+
   /*!
     Makes the reconstructed volume ready to be retrieved.
     The slices are pasted into the volume immediately, but hole filling is performed only when this method is called.
@@ -82,7 +89,10 @@ public:
   /*! Load the reconstructed volume into the volume pointer */
   virtual PlusStatus GetReconstructedVolume(vtkImageData* volume);
 
-  /*! Apply hole filling to the reconstructed image, is called by UpdateReconstructedVolume so an explicit call is not needed */
+  /*!
+    Apply hole filling to the reconstructed image, is called by UpdateReconstructedVolume so an explicit call is not needed.
+    If the hole filled volume is already available then only the region that has been modified since the last call is recomputed.
+  */
   virtual PlusStatus GenerateHoleFilledVolume();
 
   /*! Returns the reconstructed volume gray levels from the provided volume */
@@ -147,6 +157,13 @@ public:
   /*! Set the number of threads used for volume reconstruction and hole filling */
   void SetNumberOfThreads(int numberOfThreads);
 
+  /*!
+    Store the reconstructed volume in bricks that are allocated on first use, see vtkPlusPasteSliceIntoVolume::SetEnableBrickedStorage.
+    Recommended for large output volumes with fine spacing. Applied when the output volume is reset.
+  */
+  void SetEnableBrickedStorage(bool enable);
+  bool GetEnableBrickedStorage();
+
   /*! Set the fan-shaped clipping region for curvilinear probes. */
   void SetFanAnglesDeg(double* fanAngles);
   /*! Set the fan-shaped clipping region for curvilinear probes. */
@@ -211,6 +228,13 @@ protected:
   /*! Construct ImageToReference transform name from the image and reference coordinate frame member variables */
   PlusStatus GetImageToReferenceTransformName(PlusTransformName& imageToReferenceTransformName);
 
+  /*!
+    Release the dense copies of the reconstructed volume after it has been retrieved, if the reconstructor stores the volume in bricks.
+    The next retrieval exports the whole volume from the bricks again (and fills the holes in the whole volume),
+    but between retrievals only the bricks are kept in memory.
+  */
+  void ReleaseDenseOutputIfBricked();
+
 protected:
   vtkPlusPasteSliceIntoVolume* Reconstructor;
   vtkPlusFillHolesInVolume* HoleFiller;
@@ -240,6 +264,12 @@ protected:
   /*! Modified time when reconstructing. This is used to determine whether re-reconstruction is necessary */
   vtkMTimeType ReconstructedVolumeUpdatedTime;
 
+  /*!
+    True if ReconstructedVolume contains a hole filled volume that can be updated incrementally.
+    If false then hole filling is computed for the whole volume at the next update.
+  */
+  bool HoleFilledVolumeValid;
+
   /*!
     If EnableFanAnglesAutoDetect is enabled then actually used fan angles will be computed from each frame (these angles define the maximum range.
     If EnableFanAnglesAutoDetect is disabled then these values will be used as fan angles.